@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "memory/memory_tracker.h"
+#include "sysmon/memory_stats.h"
+
+
+// Summary statistics of a set of samples
+struct SampleStats {
+	size_t count = 0;
+	f64    mean  = 0.0;
+	f64    min   = 0.0;
+	f64    p50   = 0.0;
+	f64    p90   = 0.0;
+	f64    p99   = 0.0;
+	f64    max   = 0.0;
+};
+
+
+// Compute the statistics of a set of samples. Percentiles use the nearest-rank method.
+[[nodiscard]]
+inline SampleStats ComputeStats(std::vector<f64> samples) {
+	SampleStats stats;
+	if (samples.empty())
+		return stats;
+
+	std::ranges::sort(samples);
+
+	const auto percentile = [&samples](f64 p) {
+		const auto rank = static_cast<size_t>(std::ceil(p * static_cast<f64>(samples.size())));
+		return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+	};
+
+	f64 total = 0.0;
+	for (const f64 sample : samples)
+		total += sample;
+
+	stats.count = samples.size();
+	stats.mean  = total / static_cast<f64>(samples.size());
+	stats.min   = samples.front();
+	stats.p50   = percentile(0.50);
+	stats.p90   = percentile(0.90);
+	stats.p99   = percentile(0.99);
+	stats.max   = samples.back();
+
+	return stats;
+}
+
+
+//----------------------------------------------------------------------------------
+// BenchmarkReport
+//----------------------------------------------------------------------------------
+//
+// The results of a benchmark run, written as JSON. Each series holds one sample per
+// measured tick. Zones are the profiler zones entered during a tick, identified by
+// their name and depth, and are listed in the order they were first entered.
+//
+//----------------------------------------------------------------------------------
+struct BenchmarkReport {
+
+	// A profiler zone's time in each tick (ms). Ticks the zone wasn't entered in count as 0.
+	struct Zone {
+		std::string      name;
+		u32              depth = 0;
+		std::vector<f64> samples;
+	};
+
+	// Add a sample to a zone, creating the zone if it doesn't exist yet. Zones created after the
+	// first tick are back-filled with zeros.
+	void addZoneSample(std::string_view name, u32 depth, f64 time, size_t tick) {
+		auto it = std::ranges::find_if(zones, [&](const Zone& zone) {
+			return (zone.depth == depth) and (zone.name == name);
+		});
+
+		if (it == zones.end()) {
+			it = zones.insert(zones.end(), Zone{std::string{name}, depth, {}});
+		}
+
+		it->samples.resize(tick + 1, 0.0);
+		it->samples[tick] += time;
+	}
+
+	// Pad the zones that weren't entered in the last ticks with zeros
+	void finalize(size_t tick_count) {
+		for (auto& zone : zones)
+			zone.samples.resize(tick_count, 0.0);
+	}
+
+	void writeJSON(std::ostream& stream) const {
+		stream << "{\n";
+
+		stream << "\t\"config\": {";
+		for (size_t i = 0; i < config.size(); ++i) {
+			stream << (i ? ", " : "") << '"' << config[i].first << "\": " << config[i].second;
+		}
+		stream << "},\n";
+
+		stream << "\t\"entities\": " << entity_count << ",\n";
+		stream << "\t\"ticks\": " << tick_times.size() << ",\n";
+		stream << "\t\"checksum\": \"" << FormatHex(checksum) << "\",\n";
+		stream << "\t\"setup_ms\": " << setup_time << ",\n";
+
+		stream << "\t\"tick_ms\": ";
+		WriteStats(stream, ComputeStats(tick_times));
+		stream << ",\n";
+
+		stream << "\t\"allocations_per_tick\": ";
+		WriteStats(stream, ComputeStats(allocation_counts));
+		stream << ",\n";
+
+		stream << "\t\"allocated_bytes_per_tick\": ";
+		WriteStats(stream, ComputeStats(allocation_bytes));
+		stream << ",\n";
+
+		stream << "\t\"process_memory\": {"
+		       << "\"physical\": " << process_memory.process_physical
+		       << ", \"physical_peak\": " << process_memory.process_physical_peak
+		       << ", \"private\": " << process_memory.process_private << "},\n";
+
+		stream << "\t\"memory\": [";
+		for (size_t i = 0; i < memory.size(); ++i) {
+			stream << (i ? ",\n" : "\n") << "\t\t{\"tag\": ";
+			WriteString(stream, memory[i].name);
+			stream << ", \"bytes\": " << memory[i].bytes
+			       << ", \"peak_bytes\": " << memory[i].peak_bytes
+			       << ", \"allocations\": " << memory[i].allocations
+			       << ", \"total_allocations\": " << memory[i].total_allocations << '}';
+		}
+		stream << "\n\t],\n";
+
+		stream << "\t\"zones\": [";
+		for (size_t i = 0; i < zones.size(); ++i) {
+			stream << (i ? ",\n" : "\n") << "\t\t{\"name\": ";
+			WriteString(stream, zones[i].name);
+			stream << ", \"depth\": " << zones[i].depth << ", \"ms\": ";
+			WriteStats(stream, ComputeStats(zones[i].samples));
+			stream << '}';
+		}
+		stream << "\n\t]\n";
+
+		stream << "}\n";
+	}
+
+
+	// The benchmark's parameters, as pre-formatted JSON values
+	std::vector<std::pair<std::string, std::string>> config;
+
+	size_t entity_count = 0;
+	u64    checksum     = 0;
+	f64    setup_time   = 0.0; //ms
+
+	// One sample per tick
+	std::vector<f64>  tick_times; //ms
+	std::vector<f64>  allocation_counts;
+	std::vector<f64>  allocation_bytes;
+	std::vector<Zone> zones;
+
+	// Memory at the end of the run. The tag peaks cover the whole run.
+	MemoryStats                 process_memory;
+	std::vector<MemoryTagStats> memory;
+
+private:
+
+	static void WriteStats(std::ostream& stream, const SampleStats& stats) {
+		stream << "{\"mean\": " << stats.mean
+		       << ", \"min\": " << stats.min
+		       << ", \"p50\": " << stats.p50
+		       << ", \"p90\": " << stats.p90
+		       << ", \"p99\": " << stats.p99
+		       << ", \"max\": " << stats.max << '}';
+	}
+
+	static void WriteString(std::ostream& stream, std::string_view str) {
+		stream << '"';
+		for (const char c : str) {
+			if ((c == '"') or (c == '\\'))
+				stream << '\\' << c;
+			else if (static_cast<unsigned char>(c) < 0x20)
+				stream << ' ';
+			else
+				stream << c;
+		}
+		stream << '"';
+	}
+
+	[[nodiscard]]
+	static std::string FormatHex(u64 value) {
+		char buffer[17];
+		std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+		return buffer;
+	}
+};
@@ -0,0 +1,382 @@
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "datatypes/types.h"
+#include "io/io.h"
+#include "memory/memory_tracker.h"
+#include "profiler/profiler.h"
+#include "sysmon/memory_stats.h"
+
+#include "directx/d3d11.h"
+
+#include "imgui.h"
+#include "imgui_impl_dx11.h"
+
+#include "benchmark_report.h"
+
+import exception;
+import rendering;
+import window;
+import benchmark_scene;
+
+
+//----------------------------------------------------------------------------------
+// Allocation Tracking
+//----------------------------------------------------------------------------------
+//
+// The global allocation functions are replaced to count the allocations made by
+// each tick. The nothrow, array and sized forms all forward to these by default.
+//
+//----------------------------------------------------------------------------------
+namespace {
+std::atomic<u64> allocation_count = 0;
+std::atomic<u64> allocation_bytes = 0;
+}
+
+void* operator new(size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (void* ptr = _aligned_malloc(size ? size : 1, static_cast<size_t>(alignment)))
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	_aligned_free(ptr);
+}
+
+
+
+//----------------------------------------------------------------------------------
+// Arguments
+//----------------------------------------------------------------------------------
+namespace {
+
+struct BenchmarkArgs {
+	BenchmarkSceneConfig scene;
+
+	u32 ticks    = 600;
+	u32 warmup   = 60;
+	f64 timestep = 1.0 / 60.0; //seconds
+	u32 render   = 1;          //render each tick if non-zero
+
+	fs::path output; //stdout if empty
+	fs::path trace;  //no trace if empty
+};
+
+constexpr std::string_view usage =
+	"Usage: Benchmark [options]\n"
+	"  --entities <n>      Number of entities with a model (default 1000)\n"
+	"  --depth <n>         Entities in each parented chain (default 1)\n"
+	"  --point-lights <n>  Number of point lights (default 16)\n"
+	"  --spot-lights <n>   Number of spot lights (default 4)\n"
+	"  --churn <f>         Fraction of chains that move each tick (default 0.1)\n"
+	"  --seed <n>          Scene generation seed (default 1)\n"
+	"  --ticks <n>         Number of measured ticks (default 600)\n"
+	"  --warmup <n>        Number of unmeasured ticks run first (default 60)\n"
+	"  --timestep <f>      Fixed tick length in seconds (default 1/60)\n"
+	"  --render <0|1>      Render each tick to a hidden window (default 1)\n"
+	"  --output <file>     Write the JSON report to a file instead of stdout\n"
+	"  --trace <file>      Capture the measured ticks to a Chrome trace file\n";
+
+template<typename T>
+[[nodiscard]]
+bool ParseValue(std::string_view str, T& out) {
+	const auto [ptr, error] = std::from_chars(str.data(), str.data() + str.size(), out);
+	return (error == std::errc{}) and (ptr == str.data() + str.size());
+}
+
+[[nodiscard]]
+bool ParseArgs(int argc, char* argv[], BenchmarkArgs& args) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+
+		if ((arg == "--help") or (i + 1 >= argc))
+			return false;
+
+		const std::string_view value = argv[++i];
+		bool valid = true;
+
+		if      (arg == "--entities")     valid = ParseValue(value, args.scene.entity_count);
+		else if (arg == "--depth")        valid = ParseValue(value, args.scene.hierarchy_depth);
+		else if (arg == "--point-lights") valid = ParseValue(value, args.scene.point_lights);
+		else if (arg == "--spot-lights")  valid = ParseValue(value, args.scene.spot_lights);
+		else if (arg == "--churn")        valid = ParseValue(value, args.scene.churn);
+		else if (arg == "--seed")         valid = ParseValue(value, args.scene.seed);
+		else if (arg == "--ticks")        valid = ParseValue(value, args.ticks);
+		else if (arg == "--warmup")       valid = ParseValue(value, args.warmup);
+		else if (arg == "--timestep")     valid = ParseValue(value, args.timestep) and (args.timestep > 0.0);
+		else if (arg == "--render")       valid = ParseValue(value, args.render) and (args.render <= 1);
+		else if (arg == "--output")       args.output = value;
+		else if (arg == "--trace")        args.trace = value;
+		else                              valid = false;
+
+		if (not valid) {
+			std::cerr << "Invalid argument: " << arg << ' ' << value << '\n';
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} //namespace
+
+
+
+//----------------------------------------------------------------------------------
+// GPU Sync
+//----------------------------------------------------------------------------------
+namespace {
+
+// Wait for the device to finish the submitted work. Called between ticks, outside of the
+// measured time, so the work queued by the renderer doesn't build up over the run.
+void WaitForGPU(ID3D11Device& device, ID3D11DeviceContext& device_context) {
+	D3D11_QUERY_DESC desc = {};
+	desc.Query = D3D11_QUERY_EVENT;
+
+	ComPtr<ID3D11Query> query;
+	ThrowIfFailed(device.CreateQuery(&desc, query.GetAddressOf()),
+	              "Failed to create the event query");
+
+	device_context.End(query.Get());
+
+	BOOL done = FALSE;
+	while (device_context.GetData(query.Get(), &done, sizeof(done), 0) == S_FALSE) {
+		std::this_thread::yield();
+	}
+}
+
+} //namespace
+
+
+
+//----------------------------------------------------------------------------------
+// Main
+//----------------------------------------------------------------------------------
+//
+// Generates a synthetic scene and runs it with a fixed time step. The rendering layer
+// is backed by a WARP (software) device, so the benchmark runs the same on machines
+// without a GPU. Each tick steps the simulation (the systems, the transform hierarchy,
+// and the model buffer updates), then renders the scene to a hidden window, so the
+// renderer's passes are reported as zones next to the simulation's. The GPU is waited
+// on between ticks, so the tick times are the CPU's.
+//
+//----------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+	using clock = std::chrono::steady_clock;
+	using ms    = std::chrono::duration<f64, std::milli>;
+
+	BenchmarkArgs args;
+	if (not ParseArgs(argc, argv, args)) {
+		std::cerr << usage;
+		return 1;
+	}
+
+	Profiler::setThreadName("Main");
+
+	ThrowIfFailed(CoInitializeEx(NULL, COINIT_MULTITHREADED),
+	              "Failed to initialize the COM library");
+
+	// Create a software device
+	ComPtr<ID3D11Device>        device;
+	ComPtr<ID3D11DeviceContext> device_context;
+	ThrowIfFailed(D3D11CreateDevice(nullptr,
+	                                D3D_DRIVER_TYPE_WARP,
+	                                nullptr,
+	                                0,
+	                                nullptr,
+	                                0,
+	                                D3D11_SDK_VERSION,
+	                                device.GetAddressOf(),
+	                                nullptr,
+	                                device_context.GetAddressOf()),
+	              "D3D11CreateDevice Failed");
+
+	// The display config is only used for the size and format of the back buffer
+	render::DisplayConfig   display_config{render::AAType::None, false, true};
+	render::RenderingConfig rendering_config;
+	display_config.setNearestDisplayDesc(u32_2{1280, 720});
+
+	BenchmarkReport report;
+	{
+		render::ResourceMgr resource_mgr{*device.Get(), *device_context.Get()};
+		BenchmarkScene scene;
+
+		// The window is never shown
+		std::unique_ptr<Window>            window;
+		std::unique_ptr<render::SwapChain> swap_chain;
+		std::unique_ptr<render::Renderer>  renderer;
+
+		// Generate the scene
+		const auto setup_begin = clock::now();
+		scene.generate(args.scene, *device.Get(), *device_context.Get(), resource_mgr);
+
+		if (args.render) {
+			auto window_class = std::make_shared<WindowClass>(gsl::make_not_null(GetModuleHandle(nullptr)), L"Benchmark");
+			window = std::make_unique<Window>(window_class, L"Benchmark", display_config.getDisplayResolution());
+
+			swap_chain = std::make_unique<render::SwapChain>(gsl::make_not_null(window->getHandle()),
+			                                                 display_config,
+			                                                 *device.Get(),
+			                                                 *device_context.Get());
+
+			renderer = std::make_unique<render::Renderer>(display_config,
+			                                              rendering_config,
+			                                              *device.Get(),
+			                                              *device_context.Get(),
+			                                              *swap_chain,
+			                                              resource_mgr);
+
+			scene.addCamera(*device.Get(), display_config.getDisplayResolution());
+
+			// The renderer draws the ImGui data every frame. There's no platform backend, so
+			// the display size and time step are set here.
+			ImGui::CreateContext();
+			ImGui_ImplDX11_Init(device.Get(), device_context.Get());
+
+			auto& io = ImGui::GetIO();
+			io.DisplaySize = ImVec2{static_cast<f32>(display_config.getDisplayWidth()),
+			                        static_cast<f32>(display_config.getDisplayHeight())};
+			io.DeltaTime   = static_cast<f32>(args.timestep);
+		}
+
+		resource_mgr.update();
+		report.setup_time = ms{clock::now() - setup_begin}.count();
+
+		const auto timestep = std::chrono::duration<f64>{args.timestep};
+
+		const auto tick = [&] {
+			PROFILE_ZONE("Tick");
+			resource_mgr.update();
+			scene.step(timestep);
+
+			if (renderer) {
+				ImGui_ImplDX11_NewFrame();
+				ImGui::NewFrame();
+
+				static constexpr f32 color[4] = { 0.39f, 0.39f, 0.39f, 1.0f };
+				swap_chain->clear(color);
+
+				renderer->extract(scene);
+				renderer->render(timestep);
+
+				PROFILE_ZONE("Flush");
+				device_context->Flush();
+			}
+			else {
+				scene.extract();
+			}
+		};
+
+		const auto end_tick = [&] {
+			if (renderer)
+				WaitForGPU(*device.Get(), *device_context.Get());
+		};
+
+		// Warm up
+		for (u32 i = 0; i < args.warmup; ++i) {
+			tick();
+			Profiler::endFrame();
+			end_tick();
+		}
+
+		if (not args.trace.empty())
+			Profiler::beginCapture();
+
+		// Run the measured ticks
+		for (u32 i = 0; i < args.ticks; ++i) {
+			const u64  count_begin = allocation_count.load(std::memory_order_relaxed);
+			const u64  bytes_begin = allocation_bytes.load(std::memory_order_relaxed);
+			const auto time_begin  = clock::now();
+
+			tick();
+
+			report.tick_times.push_back(ms{clock::now() - time_begin}.count());
+			report.allocation_counts.push_back(static_cast<f64>(allocation_count.load(std::memory_order_relaxed) - count_begin));
+			report.allocation_bytes.push_back(static_cast<f64>(allocation_bytes.load(std::memory_order_relaxed) - bytes_begin));
+
+			Profiler::endFrame();
+			for (const auto& stats : Profiler::getFrameStats()) {
+				report.addZoneSample(stats.zone->name, stats.depth, stats.time, i);
+			}
+
+			end_tick();
+		}
+
+		report.finalize(args.ticks);
+
+		if (not args.trace.empty()) {
+			Profiler::endCapture();
+			if (not Profiler::writeChromeTrace(args.trace))
+				std::cerr << "Failed to write trace file: " << args.trace.string() << '\n';
+		}
+
+		report.entity_count = scene.getECS().count<handle64>();
+		report.checksum     = scene.checksum();
+
+		const auto breakdown = MemoryTracker::getBreakdown();
+		report.memory.assign(breakdown.begin(), breakdown.end());
+		if (not QueryMemoryStats(report.process_memory))
+			std::cerr << "Failed to query the process memory stats\n";
+
+		if (renderer) {
+			ImGui_ImplDX11_Shutdown();
+			ImGui::DestroyContext();
+		}
+	}
+
+	CoUninitialize();
+
+	// Write the report
+	report.config = {
+		{"entities",     std::to_string(args.scene.entity_count)},
+		{"depth",        std::to_string(args.scene.hierarchy_depth)},
+		{"point_lights", std::to_string(args.scene.point_lights)},
+		{"spot_lights",  std::to_string(args.scene.spot_lights)},
+		{"churn",        std::to_string(args.scene.churn)},
+		{"seed",         std::to_string(args.scene.seed)},
+		{"ticks",        std::to_string(args.ticks)},
+		{"warmup",       std::to_string(args.warmup)},
+		{"timestep",     std::to_string(args.timestep)},
+		{"render",       std::to_string(args.render)},
+		{"resolution",   std::to_string(display_config.getDisplayWidth()) + 'x' + std::to_string(display_config.getDisplayHeight())},
+	};
+
+	if (args.output.empty()) {
+		report.writeJSON(std::cout);
+	}
+	else {
+		std::ofstream file{args.output};
+		if (not file) {
+			std::cerr << "Failed to open output file: " << args.output.string() << '\n';
+			return 1;
+		}
+		report.writeJSON(file);
+	}
+
+	return 0;
+}
@@ -0,0 +1,289 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include <DirectXMath.h>
+
+#include "datatypes/types.h"
+#include "memory/handle/handle.h"
+#include "profiler/profiler.h"
+
+#include "directx/d3d11.h"
+
+export module benchmark_scene;
+
+import ecs;
+import math.directxmath;
+import rendering;
+
+// Components
+import components.benchmark.motion;
+
+// Systems
+import systems.benchmark.motion;
+
+using namespace DirectX;
+
+
+// The size and makeup of a generated scene
+export struct BenchmarkSceneConfig {
+	// Number of entities with a model
+	u32 entity_count = 1000;
+
+	// Number of model entities in each chain of parented entities. 1 means every model is a root.
+	u32 hierarchy_depth = 1;
+
+	u32 point_lights = 16;
+	u32 spot_lights  = 4;
+
+	// Fraction of the chains whose root moves every tick
+	f32 churn = 0.1f;
+
+	u64 seed = 1;
+};
+
+
+//----------------------------------------------------------------------------------
+// BenchmarkScene
+//----------------------------------------------------------------------------------
+//
+// A synthetic scene for benchmarking. The scene is generated from a config and a
+// seed, so the same config always produces the same scene and the same results.
+//
+// The scene isn't loaded by an engine. It adds the core systems that don't need a
+// window itself, and is stepped with a fixed time step. A camera can be added to
+// render the scene with a Renderer.
+//
+//----------------------------------------------------------------------------------
+export class BenchmarkScene : public render::Scene {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	BenchmarkScene() : Scene("Benchmark Scene") {
+	}
+
+	BenchmarkScene(const BenchmarkScene&) = delete;
+	BenchmarkScene(BenchmarkScene&&) = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructors
+	//----------------------------------------------------------------------------------
+	~BenchmarkScene() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	BenchmarkScene& operator=(const BenchmarkScene&) = delete;
+	BenchmarkScene& operator=(BenchmarkScene&&) = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Add the systems and generate the scene contents
+	void generate(const BenchmarkSceneConfig& config,
+	              ID3D11Device& device,
+	              ID3D11DeviceContext& device_context,
+	              render::ResourceMgr& resource_mgr) {
+
+		using namespace render;
+		using namespace EntityTemplates;
+
+		auto& ecs = getECS();
+		rng.seed(config.seed);
+		context   = &device_context;
+
+		//----------------------------------------------------------------------------------
+		// Add systems
+		//----------------------------------------------------------------------------------
+
+		ecs.add<systems::TransformSystem>();
+		ecs.add<systems::HierarchySystem>();
+		ecs.add<systems::ModelSystem>(device_context);
+		ecs.add<MotionSystem>();
+
+
+		//----------------------------------------------------------------------------------
+		// Models
+		//----------------------------------------------------------------------------------
+
+		ModelConfig<VertexPositionNormalTexture> model_config;
+		model_config.flip_winding = false;
+		model_config.flip_uv      = false;
+
+		const std::shared_ptr<ModelBlueprint> blueprints[] = {
+			BlueprintFactory::CreateCube(resource_mgr, model_config, 1.0f),
+			BlueprintFactory::CreateSphere(resource_mgr, model_config, 1.0f),
+			BlueprintFactory::CreateCylinder(resource_mgr, model_config, 1.0f, 1.0f),
+		};
+
+		const u32 depth      = std::max(config.hierarchy_depth, 1u);
+		const u32 chains     = (config.entity_count + depth - 1) / depth;
+		extent               = 2.0f * std::sqrt(static_cast<f32>(chains));
+		const u64 churn_max  = static_cast<u64>(std::clamp(config.churn, 0.0f, 1.0f) * 1024.0f);
+
+		u32 remaining = config.entity_count;
+		for (u32 chain = 0; chain < chains; ++chain) {
+			handle64 parent = handle64::invalid_handle();
+
+			for (u32 level = 0; (level < depth) and (remaining > 0); ++level, --remaining) {
+				const auto entity = createEntity<HierarchyT>();
+				auto& transform   = ecs.get<Transform>(entity);
+
+				if (parent == handle64::invalid_handle()) {
+					const f32_3 position{random(-extent, extent), random(0.0f, 4.0f), random(-extent, extent)};
+					transform.setPosition(position);
+					transform.setRotation(f32_3{0.0f, random(0.0f, XM_2PI), 0.0f});
+
+					if ((rng() % 1024) < churn_max) {
+						ecs.add<Motion>(entity,
+						                position,
+						                random(0.5f, 2.0f),
+						                random(-1.0f, 1.0f),
+						                f32_3{0.0f, random(-2.0f, 2.0f), 0.0f},
+						                random(0.0f, XM_2PI));
+					}
+				}
+				else {
+					transform.setPosition(f32_3{0.0f, 1.25f, 0.0f});
+					transform.setRotation(f32_3{0.0f, random(0.0f, XM_2PI), 0.0f});
+					transform.setScale(f32_3{0.8f});
+					ecs.get<Hierarchy>(parent).addChild(ecs, entity);
+				}
+
+				importModel(entity, device, blueprints[rng() % std::size(blueprints)]);
+				parent = entity;
+			}
+		}
+
+
+		//----------------------------------------------------------------------------------
+		// Lights
+		//----------------------------------------------------------------------------------
+
+		for (u32 i = 0; i < config.point_lights; ++i) {
+			const auto entity = createEntity();
+			ecs.get<Transform>(entity).setPosition(f32_3{random(-extent, extent), random(2.0f, 8.0f), random(-extent, extent)});
+
+			auto& light = ecs.add<PointLight>(entity);
+			light.setBaseColor(f32_3{random(0.5f, 1.0f), random(0.5f, 1.0f), random(0.5f, 1.0f)});
+			light.setIntensity(random(2.0f, 8.0f));
+			light.setAttenuation(f32_3{0.0f, 0.1f, 0.1f});
+			light.setRange(random(5.0f, 20.0f));
+		}
+
+		for (u32 i = 0; i < config.spot_lights; ++i) {
+			const auto entity = createEntity();
+			auto& transform = ecs.get<Transform>(entity);
+			transform.setPosition(f32_3{random(-extent, extent), random(4.0f, 10.0f), random(-extent, extent)});
+			transform.setRotation(f32_3{XM_PIDIV2, 0.0f, 0.0f});
+
+			auto& light = ecs.add<SpotLight>(entity);
+			light.setBaseColor(f32_3{random(0.5f, 1.0f), random(0.5f, 1.0f), random(0.5f, 1.0f)});
+			light.setIntensity(random(4.0f, 10.0f));
+			light.setAttenuation(f32_3{0.0f, 0.1f, 0.1f});
+			light.setRange(random(10.0f, 30.0f));
+			light.setUmbraAngle(XM_PI / 6.0f);
+			light.setPenumbraAngle(XM_PI / 4.0f);
+		}
+	}
+
+	// Add a camera above the scene, looking down over it. Must be called after generate().
+	void addCamera(ID3D11Device& device, u32_2 viewport_size) {
+		auto& ecs = getECS();
+
+		camera = createEntity();
+		auto& transform = ecs.get<Transform>(camera);
+		transform.setPosition(f32_3{0.0f, 0.5f * extent + 10.0f, -1.5f * extent});
+		transform.setRotation(f32_3{XM_PI / 6.0f, 0.0f, 0.0f});
+
+		ecs.add<PerspectiveCamera>(camera, device, viewport_size);
+	}
+
+	// Advance the scene by a fixed amount of time. Each step is followed by a frame update, as if
+	// a frame was rendered after every step, so the model and camera buffer updates are measured too.
+	void step(std::chrono::duration<f64> dt) {
+		PROFILE_ZONE("Scene Tick");
+		getECS().update(dt);
+		getECS().frameUpdate(1.0f);
+
+		// Upload the camera buffer, like the CameraSystem (which needs a RenderingMgr)
+		if (camera != handle64::invalid_handle()) {
+			const auto& transform = getECS().get<Transform>(camera);
+			getECS().get<PerspectiveCamera>(camera).updateBuffer(*context,
+			                                                     transform.getRenderObjectToWorldMatrix(),
+			                                                     transform.getRenderWorldToObjectMatrix());
+		}
+	}
+
+	// Extract a render snapshot without a renderer, so the extraction is measured when the
+	// scene isn't rendered
+	void extract() {
+		render::ExtractRenderSnapshot(getECS(), lod_settings, snapshot);
+	}
+
+	// Hash the world matrices of every transform. Two runs with the same config and the same
+	// number of steps should give the same checksum.
+	[[nodiscard]]
+	u64 checksum() {
+		u64 hash = 14695981039346656037ull;
+
+		getECS().forEach<Transform>([&hash](Transform& transform) {
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world, transform.getObjectToWorldMatrix());
+
+			for (const auto& row : world.m) {
+				for (const f32 value : row) {
+					hash ^= std::bit_cast<u32>(value);
+					hash *= 1099511628211ull;
+				}
+			}
+		});
+
+		return hash;
+	}
+
+protected:
+
+	void initialize(render::Engine& engine) override {
+	}
+
+	void update(render::Engine& engine) override {
+	}
+
+private:
+
+	// A random value in [min, max). Doesn't use the standard distributions, whose results
+	// differ between implementations.
+	[[nodiscard]]
+	f32 random(f32 min, f32 max) {
+		const f64 unit = static_cast<f64>(rng() >> 11) * 0x1.0p-53;
+		return min + static_cast<f32>(unit * static_cast<f64>(max - min));
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::mt19937_64 rng;
+
+	ID3D11DeviceContext* context = nullptr;
+
+	// The half size of the area the chains are placed in
+	f32 extent = 0.0f;
+
+	handle64 camera = handle64::invalid_handle();
+
+	// The snapshot is reused between steps, like the renderer's
+	render::LODSettings    lod_settings;
+	render::RenderSnapshot snapshot;
+};
@@ -0,0 +1,58 @@
+module;
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+export module components.benchmark.motion;
+
+import ecs;
+
+// Moves an entity around a circle while spinning it. Used to generate transform
+// changes in benchmark scenes.
+export class Motion final : public ecs::Component {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	Motion() = default;
+
+	Motion(const f32_3& center, f32 radius, f32 orbit_speed, const f32_3& spin_speed, f32 phase)
+		: center(center)
+		, radius(radius)
+		, orbit_speed(orbit_speed)
+		, spin_speed(spin_speed)
+		, phase(phase) {
+	}
+
+	Motion(const Motion&) = delete;
+	Motion(Motion&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructors
+	//----------------------------------------------------------------------------------
+	~Motion() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	Motion& operator=(const Motion&) = delete;
+	Motion& operator=(Motion&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// The circle the entity moves around, in the XZ plane
+	f32_3 center = {0.0f, 0.0f, 0.0f};
+	f32   radius = 1.0f;
+
+	// Radians per second
+	f32   orbit_speed = 1.0f;
+	f32_3 spin_speed  = {0.0f, 1.0f, 0.0f};
+
+	// The current angle around the circle
+	f32 phase = 0.0f;
+};
@@ -0,0 +1,67 @@
+module;
+
+#include <cmath>
+
+#include "datatypes/types.h"
+#include "memory/handle/handle.h"
+
+export module systems.benchmark.motion;
+
+import ecs;
+import rendering;
+
+import components.benchmark.motion;
+
+
+export class MotionSystem final : public ecs::System {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	MotionSystem(ecs::ECS& ecs) : System(ecs) {
+	}
+
+	MotionSystem(const MotionSystem&) = delete;
+	MotionSystem(MotionSystem&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~MotionSystem() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	MotionSystem& operator=(const MotionSystem&) = delete;
+	MotionSystem& operator=(MotionSystem&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	void update() override {
+		auto& ecs = this->getECS();
+		const auto dt = static_cast<f32>(dtSinceLastUpdate().count());
+
+		ecs.forEach<Transform, Motion>([&](handle64 entity) {
+			auto& transform = ecs.get<Transform>(entity);
+			auto& motion    = ecs.get<Motion>(entity);
+
+			motion.phase = std::fmod(motion.phase + (motion.orbit_speed * dt), 6.28318531f);
+
+			transform.setPosition(f32_3{
+				motion.center[0] + (motion.radius * std::cos(motion.phase)),
+				motion.center[1],
+				motion.center[2] + (motion.radius * std::sin(motion.phase))
+			});
+
+			transform.rotate(f32_3{
+				motion.spin_speed[0] * dt,
+				motion.spin_speed[1] * dt,
+				motion.spin_speed[2] * dt
+			});
+		});
+	}
+};
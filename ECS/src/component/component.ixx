@@ -10,12 +10,14 @@ module;
 
 #include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
+#include "memory/memory_tracker.h"
 #include "memory/resource_pool.h"
 
 export module ecs:component;
 
 import log;
 import :event_mgr;
+import :events;
 
 
 template<typename T>
@@ -127,6 +129,11 @@ private:
 //
 //----------------------------------------------------------------------------------
 class ComponentMgr final {
+
+	// The pool that components of a type are stored in
+	template<typename ComponentT>
+	using pool_type = ResourcePool<handle64::value_type, ComponentT, TrackedAllocator<ComponentT, MemoryTag::Components>>;
+
 public:
 	//----------------------------------------------------------------------------------
 	// Constructors
@@ -160,7 +167,7 @@ public:
 	requires std::derived_from<ComponentT, Component> && std::constructible_from<ComponentT, ArgsT...>
 	[[nodiscard]]
 	ComponentT& add(handle64 entity, ArgsT&&... args) {
-		using pool_t = ResourcePool<handle64::value_type, ComponentT>;
+		using pool_t = pool_type<ComponentT>;
 
 		// Get or create the component pool
 		auto it = component_pools.find(get_type_index<ComponentT>());
@@ -175,6 +182,8 @@ public:
 		// Setup the component
 		component.setOwner(entity);
 
+		event_mgr.get().send<ComponentAdded<ComponentT>>(entity, component);
+
 		return component;
 	}
 
@@ -243,7 +252,7 @@ public:
 	template<typename ComponentT>
 	[[nodiscard]]
 	bool has(handle64 entity) const noexcept {
-		using pool_t = ResourcePool<handle64::value_type, ComponentT>;
+		using pool_t = pool_type<ComponentT>;
 
 		if (const auto it = component_pools.find(get_type_index<ComponentT>()); it != component_pools.end()) {
 			auto& pool = *static_cast<pool_t*>(it->second.get());
@@ -263,7 +272,7 @@ public:
 	template<typename ComponentT>
 	[[nodiscard]]
 	const ComponentT& get(handle64 entity) const {
-		using pool_t = ResourcePool<handle64::value_type, ComponentT>;
+		using pool_t = pool_type<ComponentT>;
 
 		const auto& pool = *static_cast<const pool_t*>(component_pools.at(get_type_index<ComponentT>()).get());
 		return pool.get(entity.index);
@@ -282,7 +291,7 @@ public:
 	template<typename ComponentT>
 	[[nodiscard]]
 	const ComponentT* tryGet(handle64 entity) const {
-		using pool_t = ResourcePool<handle64::value_type, ComponentT>;
+		using pool_t = pool_type<ComponentT>;
 
 		if (const auto it = component_pools.find(get_type_index<ComponentT>()); it != component_pools.end()) {
 			const auto& pool = *static_cast<const pool_t*>(it->second.get());
@@ -335,7 +344,7 @@ public:
 		}
 
 		// Apply the action to each component
-		using pool_t = ResourcePool<handle64::value_type, ComponentT>;
+		using pool_t = pool_type<ComponentT>;
 		auto& pool = *static_cast<pool_t*>(it->second.get());
 		for (const ComponentT& component : pool) {
 			act(component);
@@ -57,7 +57,7 @@ public:
 	// Member Functions - Update
 	//----------------------------------------------------------------------------------
 
-	// Update the systems. Should be called once per iteration of the main program loop.
+	// Update the systems. Should be called once per step of the simulation.
 	void update(std::chrono::duration<f64> dt) {
 		system_mgr->update(dt);
 		event_mgr->dispatch();
@@ -65,6 +65,13 @@ public:
 		//component_mgr->removeExpiredComponents();
 	}
 
+	// Run the systems' per-frame work. Should be called once per rendered frame, after the
+	// frame's updates. alpha is how far the frame is between the last two updates.
+	void frameUpdate(f32 alpha) {
+		system_mgr->frameUpdate(alpha);
+		event_mgr->dispatch();
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - Entities
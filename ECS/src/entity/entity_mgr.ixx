@@ -5,6 +5,7 @@ module;
 
 #include "memory/handle/handle.h"
 #include "memory/handle/handle_map.h"
+#include "memory/memory_tracker.h"
 
 export module ecs:entity_mgr;
 
@@ -115,7 +116,7 @@ private:
 	std::reference_wrapper<EventMgr> event_mgr;
 
 	// Handle map. Stores valid handles in a ResourceMap, allowing for quick iteration over valid entities.
-	HandleMap<handle64, handle64> entity_map;
+	HandleMap<handle64, handle64, TrackedAllocator<handle64, MemoryTag::Entities>> entity_map;
 
 	// A container of entities that need to be deleted
 	std::vector<handle64> expired_entities;
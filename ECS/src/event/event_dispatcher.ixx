@@ -5,6 +5,7 @@ module;
 #include <vector>
 
 #include "datatypes/scalar_types.h"
+#include "memory/memory_tracker.h"
 
 export module ecs:event_dispatcher;
 
@@ -249,7 +250,7 @@ private:
 	//----------------------------------------------------------------------------------
 	std::vector<std::function<void(const EventT&)>> event_callbacks;
 
-	std::array<std::vector<EventT>, 2> events;
+	std::array<std::vector<EventT, TrackedAllocator<EventT, MemoryTag::Events>>, 2> events;
 	u8 current_queue = 0;
 };
 
@@ -28,4 +28,13 @@ export namespace ecs {
 		handle64 entity;
 	};
 
+	// Sent just after a component is added to an entity
+	template<typename ComponentT>
+	struct ComponentAdded {
+	public:
+		ComponentAdded(handle64 entity, ComponentT& component) : entity(entity), component(component) {}
+		handle64 entity;
+		ComponentT& component;
+	};
+
 } // namespace ecs
\ No newline at end of file
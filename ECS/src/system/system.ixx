@@ -12,6 +12,7 @@ module;
 #include <vector>
 
 #include "datatypes/scalar_types.h"
+#include "profiler/profiler.h"
 #include "time/time.h"
 
 export module ecs:system;
@@ -135,6 +136,11 @@ public:
 	// Actions taken after all systems have executed their main update
 	virtual void postUpdate() {}
 
+	// Called once per rendered frame, after any number of fixed updates. Used for work that
+	// must happen exactly once per frame, such as per-frame input, GPU uploads, and UI.
+	// alpha is how far the frame is between the last two updates, in [0, 1].
+	virtual void frameUpdate(f32 alpha) {}
+
 protected:
 
 	// Retrieve the total time passed since the last update.
@@ -178,6 +184,10 @@ private:
 	// updated if the system is inactive.
 	std::chrono::duration<f64> time_since_last_update{FLT_MAX};
 	bool needs_update = true;
+
+	// The profiler zone the system's updates are recorded in. Named after the system's type
+	// by the System Manager.
+	ProfileZone profile_zone;
 };
 
 
@@ -209,6 +219,8 @@ public:
 	// Member Functions
 	//----------------------------------------------------------------------------------
 	void update(std::chrono::duration<f64> dt) {
+		PROFILE_ZONE("ECS Update");
+
 		//----------------------------------------------------------------------------------
 		// Pre Update
 		//----------------------------------------------------------------------------------
@@ -222,6 +234,7 @@ public:
 				}
 
 				if (system.needs_update) {
+					const ProfileScope scope{system.profile_zone};
 					system.preUpdate();
 				}
 			}
@@ -232,6 +245,7 @@ public:
 		//----------------------------------------------------------------------------------
 		for (System& system : system_queue) {
 			if (system.isActive() and system.needs_update) {
+				const ProfileScope scope{system.profile_zone};
 				system.update();
 			}
 		}
@@ -241,13 +255,27 @@ public:
 		//----------------------------------------------------------------------------------
 		for (System& system : system_queue) {
 			if (system.isActive() and system.needs_update) {
-				system.postUpdate();
+				{
+					const ProfileScope scope{system.profile_zone};
+					system.postUpdate();
+				}
 				system.needs_update = false;
 				system.time_since_last_update = 0.0s;
 			}
 		}
 	}
 
+	void frameUpdate(f32 alpha) {
+		PROFILE_ZONE("ECS Frame Update");
+
+		for (System& system : system_queue) {
+			if (system.isActive()) {
+				const ProfileScope scope{system.profile_zone};
+				system.frameUpdate(alpha);
+			}
+		}
+	}
+
 	template<typename SystemT, typename... ArgsT>
 	requires std::derived_from<SystemT, System> and std::constructible_from<SystemT, ArgsT...>
 	SystemT& add(ArgsT&&... args) {
@@ -260,6 +288,7 @@ public:
 		// Create the system
 		auto  pair   = systems.try_emplace(get_type_index<SystemT>(), std::make_unique<SystemT>(std::forward<ArgsT>(args)...));
 		auto& system = static_cast<SystemT&>(*(pair.first->second));
+		system.profile_zone = ProfileZone{typeid(SystemT).name(), __FILE__, __LINE__};
 
 		// Add the system to the queue and sort it
 		system_queue.push_back(std::ref(system));
@@ -0,0 +1,198 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+export module math.geometry:cascades;
+
+import math.directxmath;
+import :bounding_volume;
+
+using namespace DirectX;
+
+export {
+
+//----------------------------------------------------------------------------------
+// ComputeCascadeSplits
+//----------------------------------------------------------------------------------
+//
+// Split the depth range [z_near, z_far] into splits.size()-1 cascades. The split
+// distances are a blend of a logarithmic and a uniform distribution, where lambda=1
+// is fully logarithmic and lambda=0 is fully uniform. splits[0] will be z_near and
+// splits.back() will be z_far.
+//
+//----------------------------------------------------------------------------------
+void ComputeCascadeSplits(f32 z_near, f32 z_far, f32 lambda, std::span<f32> splits) {
+	if (splits.empty())
+		return;
+
+	z_near = std::max(z_near, 0.0001f);
+	z_far  = std::max(z_far, z_near);
+	lambda = std::clamp(lambda, 0.0f, 1.0f);
+
+	const auto count = static_cast<f32>(splits.size() - 1);
+	const f32  ratio = z_far / z_near;
+	const f32  range = z_far - z_near;
+
+	for (size_t i = 0; i < splits.size(); ++i) {
+		const f32 p       = static_cast<f32>(i) / std::max(count, 1.0f);
+		const f32 log     = z_near * std::pow(ratio, p);
+		const f32 uniform = z_near + (range * p);
+
+		splits[i] = (lambda * log) + ((1.0f - lambda) * uniform);
+	}
+
+	// Avoid any drift from the floating point math at the ends
+	splits.front() = z_near;
+	splits.back()  = z_far;
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeFrustumSliceCorners
+//----------------------------------------------------------------------------------
+//
+//  projection_to_world: the inverse of the camera's world-to-projection matrix
+//              z_depth: the camera's near and far plane distances
+// slice_near/slice_far: the view space depth range of the slice
+//
+// Returns the 8 world space corners of the slice. The first 4 are on the near
+// plane of the slice and the last 4 are on the far plane.
+//
+//----------------------------------------------------------------------------------
+[[nodiscard]]
+std::array<XMVECTOR, 8> XM_CALLCONV ComputeFrustumSliceCorners(FXMMATRIX projection_to_world,
+                                                               const f32_2& z_depth,
+                                                               f32 slice_near,
+                                                               f32 slice_far) {
+	static constexpr f32 ndc_corners[4][2] = {
+		{-1.0f,  1.0f},
+		{ 1.0f,  1.0f},
+		{ 1.0f, -1.0f},
+		{-1.0f, -1.0f}
+	};
+
+	// View space depth varies linearly along the edges of the frustum, so the slice
+	// corners can be found by interpolating between the near and far corners.
+	const f32 range  = std::max(z_depth[1] - z_depth[0], 0.0001f);
+	const f32 t_near = (slice_near - z_depth[0]) / range;
+	const f32 t_far  = (slice_far - z_depth[0]) / range;
+
+	std::array<XMVECTOR, 8> corners;
+	for (size_t i = 0; i < 4; ++i) {
+		const auto near_corner = XMVector3TransformCoord(XMVectorSet(ndc_corners[i][0], ndc_corners[i][1], 0.0f, 1.0f), projection_to_world);
+		const auto far_corner  = XMVector3TransformCoord(XMVectorSet(ndc_corners[i][0], ndc_corners[i][1], 1.0f, 1.0f), projection_to_world);
+
+		corners[i]     = XMVectorLerp(near_corner, far_corner, t_near);
+		corners[i + 4] = XMVectorLerp(near_corner, far_corner, t_far);
+	}
+
+	return corners;
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCascadeBounds
+//----------------------------------------------------------------------------------
+//
+// Compute a bounding sphere around the corners of a frustum slice. The radius only
+// depends on the shape of the slice, so it stays constant as the camera rotates. It
+// is rounded up to avoid small changes caused by floating point error.
+//
+//----------------------------------------------------------------------------------
+[[nodiscard]]
+BoundingSphere ComputeCascadeBounds(std::span<const XMVECTOR, 8> corners) {
+	XMVECTOR center = XMVectorZero();
+	for (const auto& corner : corners) {
+		center += corner;
+	}
+	center /= 8.0f;
+
+	f32 radius = 0.0f;
+	for (const auto& corner : corners) {
+		radius = std::max(radius, XMVectorGetX(XMVector3Length(corner - center)));
+	}
+	radius = std::ceil(radius * 16.0f) / 16.0f;
+
+	return BoundingSphere{center, radius};
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCasterNear
+//----------------------------------------------------------------------------------
+//
+//  world_to_light: the light's view matrix
+//   caster_bounds: the world space bounds of every shadow caster
+//
+// Returns the light space z of the nearest point of the bounds, which is the nearest
+// any shadow caster can be to the light.
+//
+//----------------------------------------------------------------------------------
+[[nodiscard]]
+f32 XM_CALLCONV ComputeCasterNear(FXMMATRIX world_to_light, const AABB& caster_bounds) {
+	const auto min = caster_bounds.min();
+	const auto max = caster_bounds.max();
+
+	f32 z_near = std::numeric_limits<f32>::max();
+	for (u32 i = 0; i < 8; ++i) {
+		const auto corner = XMVectorSelect(min, max, XMVectorSelectControl(i & 1, (i >> 1) & 1, (i >> 2) & 1, 0));
+		z_near = std::min(z_near, XMVectorGetZ(XMVector3TransformCoord(corner, world_to_light)));
+	}
+
+	return z_near;
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCascadeProjection
+//----------------------------------------------------------------------------------
+//
+//  world_to_light: the light's view matrix
+//          bounds: the world space bounds of the cascade (see ComputeCascadeBounds)
+//      resolution: the width/height of the cascade's shadow map in texels
+//     caster_near: the light space z of the nearest possible shadow caster
+//
+// Returns an orthographic light-to-projection matrix that encloses the bounds. The
+// projection is snapped to texel sized increments in light space so that the shadow
+// map doesn't shimmer as the camera moves.
+//
+//----------------------------------------------------------------------------------
+[[nodiscard]]
+XMMATRIX XM_CALLCONV ComputeCascadeProjection(FXMMATRIX world_to_light,
+                                              const BoundingSphere& bounds,
+                                              u32 resolution,
+                                              f32 caster_near) {
+	const f32 radius     = bounds.radius();
+	const f32 texel_size = (2.0f * radius) / static_cast<f32>(std::max(resolution, 1u));
+
+	f32_3 center;
+	XMStore(&center, XMVector3TransformCoord(bounds.center(), world_to_light));
+
+	// Snap the center to the texel grid
+	if (texel_size > 0.0f) {
+		center[0] = std::floor(center[0] / texel_size) * texel_size;
+		center[1] = std::floor(center[1] / texel_size) * texel_size;
+	}
+
+	// Include every caster between the light and the cascade
+	const f32 z_near = std::min(caster_near, center[2] - radius);
+	const f32 z_far  = std::max(center[2] + radius, z_near + 0.001f);
+
+	return XMMatrixOrthographicOffCenterLH(center[0] - radius,
+	                                       center[0] + radius,
+	                                       center[1] - radius,
+	                                       center[1] + radius,
+	                                       z_near,
+	                                       z_far);
+}
+
+} //export
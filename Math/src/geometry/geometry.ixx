@@ -7,6 +7,7 @@ module;
 export module math.geometry;
 
 export import :bounding_volume;
+export import :cascades;
 export import :frustum;
 export import :transform_3d;
 export import :shapes;
@@ -6,6 +6,8 @@ module;
 #include "datatypes/pointer_types.h"
 #include "datatypes/scalar_types.h"
 #include "datatypes/vector_types.h"
+#include "memory/memory_tracker.h"
+#include "profiler/profiler.h"
 
 #include "directx/d3d11.h"
 
@@ -49,6 +51,7 @@ RenderingMgr::RenderingMgr(gsl::not_null<HWND> window,
 
 	// Create the resource manager
 	resource_mgr = std::make_unique<ResourceMgr>(direct3D->getDevice(), direct3D->getDeviceContext());
+	resource_mgr->setHotReload(rendering_config->isHotReloadEnabled());
 
 
 	// Create the renderer
@@ -60,7 +63,11 @@ RenderingMgr::RenderingMgr(gsl::not_null<HWND> window,
 											*resource_mgr);
 
 
-	// Initialize ImGui
+	// Initialize ImGui. Its allocations are counted under the UI memory tag.
+	ImGui::SetAllocatorFunctions(
+		[](size_t size, void*) { return MemoryTracker::allocate(MemoryTag::UI, size); },
+		[](void* ptr, void*) { MemoryTracker::deallocate(MemoryTag::UI, ptr); }
+	);
 	ImGui::CreateContext();
 	ImGui_ImplWin32_Init(window);
 	ImGui_ImplDX11_Init(&direct3D->getDevice(), &direct3D->getDeviceContext());
@@ -83,6 +90,9 @@ void RenderingMgr::onResize() const {
 }
 
 void RenderingMgr::beginFrame() const {
+	// Finish the resources that were loaded asynchronously
+	resource_mgr->update();
+
 	// Start a new ImGui frame
 	ImGui_ImplDX11_NewFrame();
 	ImGui_ImplWin32_NewFrame();
@@ -94,12 +104,18 @@ void RenderingMgr::beginFrame() const {
 }
 
 void RenderingMgr::endFrame() const {
+	PROFILE_ZONE("Present");
+
 	// Present the final frame
 	swap_chain->present();
 }
 
-void RenderingMgr::render(Scene& scene, std::chrono::duration<f32> delta_time) const {
-	renderer->render(scene, delta_time);
+void RenderingMgr::extract(Scene& scene) const {
+	renderer->extract(scene);
+}
+
+void RenderingMgr::render(std::chrono::duration<f32> delta_time) const {
+	renderer->render(delta_time);
 }
 
 DisplayConfig& RenderingMgr::getDisplayConfig() {
@@ -138,4 +154,8 @@ const GPUProfiler& RenderingMgr::getProfiler() const {
 	return renderer->getProfiler();
 }
 
+const PipelineBindStats& RenderingMgr::getBindStats() const {
+	return renderer->getBindStats();
+}
+
 } //namespace render
@@ -4,6 +4,8 @@ module;
 
 #include "datatypes/types.h"
 
+#include "hlsl.h"
+
 export module rendering:buffer_types;
 
 using namespace DirectX;
@@ -59,6 +61,13 @@ struct LightBuffer {
 
 	f32_3 ambient = {};
 	f32   pad2    = 0;
+
+	// Light clusters. Clustering is disabled if the dimensions are 0.
+	u32_3 cluster_dims    = {};
+	f32   pad3;
+	f32   cluster_z_scale = 0.0f;
+	f32   cluster_z_bias  = 0.0f;
+	f32_2 pad4;
 };
 
 
@@ -71,6 +80,15 @@ struct DirectionalLightBuffer {
 };
 
 
+struct ShadowedDirectionalLightBuffer {
+	DirectionalLightBuffer light_buffer;
+	u32   num_cascades = 0;
+	f32_3 pad0;
+	XMMATRIX cascade_world_to_projection[MAX_SHADOW_CASCADES] = {};
+	f32_4 smap_tiles[MAX_SHADOW_CASCADES] = {}; //uv offset (xy) and scale (zw) of each cascade's shadow atlas tile
+};
+
+
 struct PointLightBuffer {
 	f32_3 intensity   = {};
 	f32   pad0;
@@ -104,6 +122,7 @@ struct SpotLightBuffer {
 struct ShadowedSpotLightBuffer {
 	SpotLightBuffer light_buffer;
 	XMMATRIX world_to_projection = XMMatrixIdentity();
+	f32_4 smap_tile = {0.0f, 0.0f, 1.0f, 1.0f}; //uv offset (xy) and scale (zw) of the shadow atlas tile
 };
 
 
@@ -135,4 +154,14 @@ struct AltCameraBuffer {
 	XMMATRIX camera_to_projection = XMMatrixIdentity();
 };
 
+
+//----------------------------------------------------------------------------------
+// Hi-Z Buffer
+//----------------------------------------------------------------------------------
+
+struct HiZBuffer {
+	u32_2 input_size  = {};
+	u32_2 output_size = {};
+};
+
 } // namespace render
@@ -70,6 +70,11 @@ public:
 		StageT::bindConstantBuffer(device_context, slot, buffer.Get());
 	}
 
+	[[nodiscard]]
+	ID3D11Buffer* get() const noexcept {
+		return buffer.Get();
+	}
+
 
 private:
 
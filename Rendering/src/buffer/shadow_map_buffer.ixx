@@ -61,6 +61,38 @@ public:
 		}
 	}
 
+	// Clear a single DSV
+	void clear(ID3D11DeviceContext& device_context, size_t index) const {
+		Pipeline::OM::clearDSV(device_context, dsvs[index].Get());
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Static Cache
+	//----------------------------------------------------------------------------------
+
+	// Returns true if the buffer has a second set of maps used to cache static shadows
+	[[nodiscard]]
+	bool hasStaticCache() const noexcept {
+		return not static_dsvs.empty();
+	}
+
+	// Bind the depth stencil view for the static copy of a shadow map
+	void bindStaticDSV(ID3D11DeviceContext& device_context, size_t index) const {
+		Pipeline::OM::bindRTVsAndDSV(device_context, {}, static_dsvs[index].Get());
+	}
+
+	// Clear the static copy of a shadow map
+	void clearStatic(ID3D11DeviceContext& device_context, size_t index) const {
+		Pipeline::OM::clearDSV(device_context, static_dsvs[index].Get());
+	}
+
+	// Overwrite a shadow map with its static copy. Neither map can be bound when this is called.
+	void restoreStatic(ID3D11DeviceContext& device_context, size_t index) const {
+		const auto subresource = static_cast<u32>(index);
+		device_context.CopySubresourceRegion(depth_map.Get(), subresource, 0, 0, 0, static_depth_map.Get(), subresource, nullptr);
+	}
+
 	// Get the number of shadow maps in this buffer
 	[[nodiscard]]
 	size_t getMapCount() const noexcept {
@@ -112,6 +144,32 @@ protected:
 	                  f32 slope_scaled_depth_bias,
 	                  f32 depth_bias_clamp) = 0;
 
+	// Create a texture identical to the depth map, along with a DSV for each map in it
+	void createStaticCache(ID3D11Device& device) {
+		D3D11_TEXTURE2D_DESC tex_desc = {};
+		depth_map->GetDesc(&tex_desc);
+
+		ThrowIfFailed(device.CreateTexture2D(&tex_desc, nullptr, static_depth_map.GetAddressOf()),
+		              "Failed to create the static depth map texture for a shadow map buffer");
+
+		D3D11_DEPTH_STENCIL_VIEW_DESC dsv_desc = {};
+		dsv_desc.Flags                         = 0;
+		dsv_desc.Format                        = DXGI_FORMAT_D16_UNORM;
+		dsv_desc.ViewDimension                 = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		dsv_desc.Texture2DArray.MipSlice       = 0;
+		dsv_desc.Texture2DArray.ArraySize      = 1;
+
+		static_dsvs.clear();
+		static_dsvs.resize(tex_desc.ArraySize);
+
+		for (size_t i = 0; i < tex_desc.ArraySize; ++i) {
+			dsv_desc.Texture2DArray.FirstArraySlice = static_cast<u32>(i);
+
+			ThrowIfFailed(device.CreateDepthStencilView(static_depth_map.Get(), &dsv_desc, static_dsvs[i].GetAddressOf()),
+			              "Failed to create a static depth stencil view for a shadow map buffer");
+		}
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Member Variables
@@ -119,8 +177,13 @@ protected:
 	Viewport viewport;
 	ComPtr<ID3D11RasterizerState> raster_state;
 
+	ComPtr<ID3D11Texture2D> depth_map;
 	std::vector<ComPtr<ID3D11DepthStencilView>> dsvs;
 	ComPtr<ID3D11ShaderResourceView> srv;
+
+	// Copy of the depth maps containing only static shadow casters (optional)
+	ComPtr<ID3D11Texture2D> static_depth_map;
+	std::vector<ComPtr<ID3D11DepthStencilView>> static_dsvs;
 };
 
 
@@ -134,8 +197,11 @@ public:
 	                u32 resolution,
 	                i32 depth_bias,
 	                f32 slope_scaled_depth_bias,
-	                f32 depth_bias_clamp) {
+	                f32 depth_bias_clamp,
+	                bool static_cache = false) {
 		init(device, map_count, resolution, depth_bias, slope_scaled_depth_bias, depth_bias_clamp);
+		if (static_cache)
+			createStaticCache(device);
 	}
 
 	ShadowMapBuffer(const ShadowMapBuffer& buffer) = delete;
@@ -201,7 +267,7 @@ private:
 		tex_desc.CPUAccessFlags       = 0;
 		tex_desc.MiscFlags            = 0;
 
-		ComPtr<ID3D11Texture2D> depth_map;
+		depth_map.Reset();
 		ThrowIfFailed(device.CreateTexture2D(&tex_desc, nullptr, depth_map.GetAddressOf()),
 					  "Failed to create the depth map texture for a shadow map buffer");
 
@@ -239,6 +305,149 @@ private:
 };
 
 
+// A single shadow map that is divided into tiles. Each tile is rendered by binding a
+// viewport that covers it.
+class ShadowAtlasBuffer final : public IShadowMapBuffer {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	ShadowAtlasBuffer(ID3D11Device& device,
+	                  u32 resolution,
+	                  i32 depth_bias,
+	                  f32 slope_scaled_depth_bias,
+	                  f32 depth_bias_clamp,
+	                  bool static_cache = false) {
+		init(device, 1, resolution, depth_bias, slope_scaled_depth_bias, depth_bias_clamp);
+		if (static_cache) {
+			createStaticCache(device);
+			createStaticSRV(device);
+		}
+	}
+
+	ShadowAtlasBuffer(const ShadowAtlasBuffer& buffer) = delete;
+	ShadowAtlasBuffer(ShadowAtlasBuffer&& buffer) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~ShadowAtlasBuffer() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	ShadowAtlasBuffer& operator=(const ShadowAtlasBuffer& buffer) = delete;
+	ShadowAtlasBuffer& operator=(ShadowAtlasBuffer&& buffer) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Depth buffers can only be copied in their entirety, so a single tile is restored from the
+	// static copy of the atlas by reading this SRV in a pixel shader
+	[[nodiscard]]
+	ID3D11ShaderResourceView* const* getStaticSRVAddress() const noexcept {
+		return static_srv.GetAddressOf();
+	}
+
+private:
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	void init(ID3D11Device& device,
+	          u32 /*map_count*/,
+	          u32 resolution,
+	          i32 depth_bias,
+	          f32 slope_scaled_depth_bias,
+	          f32 depth_bias_clamp) override {
+		ThrowIfFailed(resolution != 0, "ShadowAtlasBuffer resolution must be greater than 0");
+
+		// Create the raster state
+		D3D11_RASTERIZER_DESC raster_desc = {};
+		raster_desc.CullMode              = D3D11_CULL_BACK;
+		raster_desc.FillMode              = D3D11_FILL_SOLID;
+		raster_desc.DepthBias             = depth_bias;
+		raster_desc.SlopeScaledDepthBias  = slope_scaled_depth_bias;
+		raster_desc.DepthBiasClamp        = depth_bias_clamp;
+		raster_desc.DepthClipEnable       = TRUE;
+		raster_desc.MultisampleEnable     = TRUE;
+
+		ThrowIfFailed(device.CreateRasterizerState(&raster_desc, raster_state.GetAddressOf()),
+					  "Failed to create the raster state for a shadow atlas buffer");
+
+
+		// Define the viewport
+		viewport.setTopLeft(0, 0);
+		viewport.setSize(resolution, resolution);
+		viewport.setDepth(0.0f, 1.0f);
+
+
+		// Create the depth map texture
+		D3D11_TEXTURE2D_DESC tex_desc = {};
+		tex_desc.Width                = resolution;
+		tex_desc.Height               = resolution;
+		tex_desc.MipLevels            = 1;
+		tex_desc.ArraySize            = 1;
+		tex_desc.Format               = DXGI_FORMAT_R16_TYPELESS;
+		tex_desc.SampleDesc.Count     = 1;
+		tex_desc.SampleDesc.Quality   = 0;
+		tex_desc.Usage                = D3D11_USAGE_DEFAULT;
+		tex_desc.BindFlags            = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+		tex_desc.CPUAccessFlags       = 0;
+		tex_desc.MiscFlags            = 0;
+
+		depth_map.Reset();
+		ThrowIfFailed(device.CreateTexture2D(&tex_desc, nullptr, depth_map.GetAddressOf()),
+					  "Failed to create the depth map texture for a shadow atlas buffer");
+
+
+		// Create the depth stencil view
+		D3D11_DEPTH_STENCIL_VIEW_DESC dsv_desc = {};
+		dsv_desc.Flags                         = 0;
+		dsv_desc.Format                        = DXGI_FORMAT_D16_UNORM;
+		dsv_desc.ViewDimension                 = D3D11_DSV_DIMENSION_TEXTURE2D;
+		dsv_desc.Texture2D.MipSlice            = 0;
+
+		dsvs.clear();
+		dsvs.resize(1);
+
+		ThrowIfFailed(device.CreateDepthStencilView(depth_map.Get(), &dsv_desc, dsvs[0].GetAddressOf()),
+					  "Failed to create the depth stencil view for a shadow atlas buffer");
+
+
+		// Create the shader resource view
+		D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+		srv_desc.Format                          = DXGI_FORMAT_R16_UNORM;
+		srv_desc.ViewDimension                   = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srv_desc.Texture2D.MipLevels             = tex_desc.MipLevels;
+		srv_desc.Texture2D.MostDetailedMip       = 0;
+
+		ThrowIfFailed(device.CreateShaderResourceView(depth_map.Get(), &srv_desc, srv.GetAddressOf()),
+					  "Failed to create the shader resource view for a shadow atlas buffer");
+	}
+
+	void createStaticSRV(ID3D11Device& device) {
+		D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+		srv->GetDesc(&srv_desc);
+
+		ThrowIfFailed(device.CreateShaderResourceView(static_depth_map.Get(), &srv_desc, static_srv.GetAddressOf()),
+		              "Failed to create the static shader resource view for a shadow atlas buffer");
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// SRV of the static copy of the atlas (only exists with the static cache)
+	ComPtr<ID3D11ShaderResourceView> static_srv;
+};
+
+
 class ShadowCubeMapBuffer final : public IShadowMapBuffer {
 public:
 	//----------------------------------------------------------------------------------
@@ -249,8 +458,11 @@ public:
 	                    u32 resolution,
 	                    i32 depth_bias,
 	                    f32 slope_scaled_depth_bias,
-	                    f32 depth_bias_clamp) {
+	                    f32 depth_bias_clamp,
+	                    bool static_cache = false) {
 		init(device, cube_map_count, resolution, depth_bias, slope_scaled_depth_bias, depth_bias_clamp);
+		if (static_cache)
+			createStaticCache(device);
 	}
 
 	ShadowCubeMapBuffer(const ShadowCubeMapBuffer& buffer) = delete;
@@ -327,7 +539,7 @@ private:
 		tex_desc.MiscFlags            = D3D11_RESOURCE_MISC_TEXTURECUBE;
 		tex_desc.CPUAccessFlags       = 0;
 
-		ComPtr<ID3D11Texture2D> depth_map;
+		depth_map.Reset();
 		ThrowIfFailed(device.CreateTexture2D(&tex_desc, nullptr, depth_map.GetAddressOf()),
 					  "Failed to create the depth map texture for a shadow cube map buffer");
 
@@ -1,5 +1,8 @@
 module;
 
+#include <algorithm>
+#include <span>
+
 #include "datatypes/types.h"
 
 #include "directx/directxtk.h"
@@ -44,29 +47,50 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
+	// Update the buffer's contents
+	void updateData(ID3D11Device& device,
+	                ID3D11DeviceContext& device_context,
+	                std::span<const DataT> data) {
+
+		const auto new_size = static_cast<u32>(data.size());
+		updateData(device, device_context, data, 0, new_size);
+	}
+
+
+	// Update the buffer's contents. Only the elements in the range [first, last) have
+	// changed since the previous update, so only that range is uploaded. The whole array
+	// is uploaded if the buffer has to be recreated.
 	void updateData(ID3D11Device& device,
 	                ID3D11DeviceContext& device_context,
-	                const std::vector<DataT>& data) {
-		// Set the number of elements used
-		current_size = static_cast<u32>(data.size());
+	                std::span<const DataT> data,
+	                u32 first,
+	                u32 last) {
 
-		if (data.size() == 0) return;
+		const auto new_size = static_cast<u32>(data.size());
 
-		// Recreate the buffer if the array of data being fed to it is larger than the buffer
-		if (current_size > reserved_size) {
-			reserved_size = current_size;
+		// Recreate the buffer if the array of data being fed to it is larger than the buffer.
+		// The capacity grows geometrically so a slowly growing array doesn't recreate it often.
+		if (new_size > reserved_size) {
+			reserved_size = std::max(new_size, reserved_size * 2);
 			createBuffer(device);
+			first = 0;
+			last  = new_size;
 		}
 
-		// Map the buffer and update the data
-		D3D11_MAPPED_SUBRESOURCE mapped_data = {};
+		current_size = new_size;
 
-		ThrowIfFailed(device_context.Map(buffer.Get(), NULL, D3D11_MAP_WRITE_DISCARD, NULL, &mapped_data),
-					  "Failed to std::map structured buffer");
+		last = std::min(last, new_size);
+		if (first >= last)
+			return;
 
-		memcpy(mapped_data.pData, data.data(), sizeof(DataT) * current_size);
+		// Upload the changed range
+		D3D11_BOX box = {};
+		box.left   = static_cast<u32>(sizeof(DataT)) * first;
+		box.right  = static_cast<u32>(sizeof(DataT)) * last;
+		box.bottom = 1;
+		box.back   = 1;
 
-		device_context.Unmap(buffer.Get(), NULL);
+		device_context.UpdateSubresource(buffer.Get(), 0, &box, &data[first], 0, 0);
 	}
 
 
@@ -96,9 +120,9 @@ private:
 		D3D11_BUFFER_DESC desc = {};
 
 		desc.BindFlags           = D3D11_BIND_SHADER_RESOURCE;
-		desc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+		desc.CPUAccessFlags      = 0;
 		desc.MiscFlags           = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-		desc.Usage               = D3D11_USAGE_DYNAMIC;
+		desc.Usage               = D3D11_USAGE_DEFAULT;
 		desc.ByteWidth           = sizeof(DataT) * reserved_size;
 		desc.StructureByteStride = sizeof(DataT);
 
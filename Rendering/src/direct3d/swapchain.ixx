@@ -179,9 +179,17 @@ private:
 		fullscreen_desc.Windowed         = TRUE;
 
 
-		// Get the DXGI factory
+		// Get the DXGI factory that created the device's adapter, which may not be the display
+		// config's adapter (e.g. a WARP device)
+		ComPtr<IDXGIDevice>  dxgi_device;
+		ComPtr<IDXGIAdapter> dxgi_adapter;
+		ThrowIfFailed(device.QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(dxgi_device.GetAddressOf())),
+					  "Failed to get the dxgiDevice");
+		ThrowIfFailed(dxgi_device->GetAdapter(dxgi_adapter.GetAddressOf()),
+					  "Failed to get the device's adapter");
+
 		ComPtr<IDXGIFactory2> dxgi_factory;
-		ThrowIfFailed(display_config.getAdapter()->GetParent(__uuidof(IDXGIFactory2), reinterpret_cast<void**>(dxgi_factory.GetAddressOf())),
+		ThrowIfFailed(dxgi_adapter->GetParent(__uuidof(IDXGIFactory2), reinterpret_cast<void**>(dxgi_factory.GetAddressOf())),
 					  "Failed to get parent of dxgiFactory");
 
 		dxgi_factory->MakeWindowAssociation(window, DXGI_MWA_NO_WINDOW_CHANGES | DXGI_MWA_NO_ALT_ENTER);
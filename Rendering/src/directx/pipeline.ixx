@@ -1,6 +1,11 @@
 module;
 
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <optional>
 #include <span>
+#include <utility>
 #include <d3d11.h>
 
 #include "datatypes/scalar_types.h"
@@ -11,11 +16,323 @@ export module rendering:pipeline;
 
 export namespace render {
 
+// The number of binds made through the Pipeline that were sent to the device context, and
+// the number that were dropped because the state was already bound
+struct BindCounts {
+	u32 issued  = 0;
+	u32 skipped = 0;
+};
+
+struct PipelineBindStats {
+	[[nodiscard]]
+	BindCounts getTotal() const noexcept {
+		BindCounts total;
+		for (const auto* counts : {&shaders, &constant_buffers, &srvs, &samplers, &states, &input_assembler, &output_merger}) {
+			total.issued  += counts->issued;
+			total.skipped += counts->skipped;
+		}
+		return total;
+	}
+
+	BindCounts shaders;
+	BindCounts constant_buffers;
+	BindCounts srvs;
+	BindCounts samplers;
+	BindCounts states;          //blend, depth stencil, and rasterizer states
+	BindCounts input_assembler; //vertex and index buffers, input layout, and topology
+	BindCounts output_merger;   //render targets and UAVs. Always issued.
+};
+
+
+//----------------------------------------------------------------------------------
+// PipelineStateCache
+//----------------------------------------------------------------------------------
+//
+// A shadow copy of the state bound to a device context. When a context has a cache
+// (see Pipeline::setStateCache), the Pipeline drops the binds of shaders, constant
+// buffers, SRVs, samplers, and fixed function states that are already bound, and
+// trims multi-slot binds to the slots that changed.
+//
+// Bound objects are compared by address. A device context holds a reference to each
+// object bound to it, so an address can't be reused while the cache says it's bound.
+// That only holds if every bind goes through the Pipeline. Code that binds to the
+// context directly (e.g. SpriteBatch, ImGui) must be followed by invalidate().
+//
+// Binding a render target or UAV makes the context unbind the SRVs of the same
+// resource, so those binds forget the bound SRVs of every stage.
+//
+//----------------------------------------------------------------------------------
+class PipelineStateCache final {
+	friend class Pipeline;
+
+public:
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Forget the bound state, so the next bind of each slot is issued
+	void invalidate() noexcept {
+		for (auto& stage : stages) {
+			stage.invalidate();
+		}
+		vertex_buffers.invalidate();
+		index_buffer.reset();
+		input_layout.reset();
+		topology.reset();
+		blend_state.reset();
+		depth_stencil_state.reset();
+		rasterizer_state.reset();
+	}
+
+	// The bind counts since the last reset
+	[[nodiscard]]
+	const PipelineBindStats& getStats() const noexcept {
+		return stats;
+	}
+
+	// Reset the bind counts, and return the counts since the last reset
+	PipelineBindStats resetStats() noexcept {
+		return std::exchange(stats, PipelineBindStats{});
+	}
+
+private:
+
+	template<typename T, size_t N>
+	struct SlotState {
+		void invalidate() noexcept {
+			known.reset();
+		}
+
+		// Record the value of a slot. Returns false if it was already bound.
+		[[nodiscard]]
+		bool update(size_t slot, const T& value) noexcept {
+			if (known[slot] and (bound[slot] == value))
+				return false;
+			bound[slot] = value;
+			known.set(slot);
+			return true;
+		}
+
+		// Record a bind to a range of slots, and trim the range to the slots that changed.
+		// Returns false if every slot was already bound.
+		[[nodiscard]]
+		bool update(u32& start_slot, std::span<const T>& values) noexcept {
+			if ((start_slot >= N) or (values.size() > N - start_slot)) {
+				invalidate();
+				return true;
+			}
+
+			size_t first = values.size();
+			size_t last  = 0;
+			for (size_t i = 0; i < values.size(); ++i) {
+				if (update(start_slot + i, values[i])) {
+					first = std::min(first, i);
+					last  = i + 1;
+				}
+			}
+
+			if (first == values.size())
+				return false;
+
+			start_slot += static_cast<u32>(first);
+			values      = values.subspan(first, last - first);
+			return true;
+		}
+
+		std::array<T, N> bound = {};
+		std::bitset<N>   known;
+	};
+
+	struct StageState {
+		void invalidate() noexcept {
+			shader.reset();
+			constant_buffers.invalidate();
+			srvs.invalidate();
+			samplers.invalidate();
+		}
+
+		std::optional<ID3D11DeviceChild*> shader;
+		SlotState<ID3D11Buffer*, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT>         constant_buffers;
+		SlotState<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> srvs;
+		SlotState<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT>              samplers;
+	};
+
+	struct VertexBuffer {
+		bool operator==(const VertexBuffer&) const noexcept = default;
+
+		ID3D11Buffer* buffer = nullptr;
+		u32           stride = 0;
+		u32           offset = 0;
+	};
+
+	struct IndexBuffer {
+		bool operator==(const IndexBuffer&) const noexcept = default;
+
+		ID3D11Buffer* buffer = nullptr;
+		DXGI_FORMAT   format = DXGI_FORMAT_UNKNOWN;
+		u32           offset = 0;
+	};
+
+	struct BlendState {
+		bool operator==(const BlendState&) const noexcept = default;
+
+		ID3D11BlendState*  state = nullptr;
+		std::array<f32, 4> blend_factor = {};
+		u32                sample_mask  = 0;
+	};
+
+	struct DepthStencilState {
+		bool operator==(const DepthStencilState&) const noexcept = default;
+
+		ID3D11DepthStencilState* state       = nullptr;
+		u32                      stencil_ref = 0;
+	};
+
+
+	// Record a bind of a single value. Returns false if it was already bound.
+	template<typename T>
+	[[nodiscard]]
+	static bool update(std::optional<T>& bound, const T& value, BindCounts& counts) noexcept {
+		if (bound == value) {
+			++counts.skipped;
+			return false;
+		}
+		bound = value;
+		++counts.issued;
+		return true;
+	}
+
+	// Record a bind to a range of slots. Returns false if it was already bound.
+	template<typename T, size_t N>
+	[[nodiscard]]
+	static bool update(SlotState<T, N>& slots, u32& start_slot, std::span<const T>& values, BindCounts& counts) noexcept {
+		if (slots.update(start_slot, values)) {
+			++counts.issued;
+			return true;
+		}
+		++counts.skipped;
+		return false;
+	}
+
+	[[nodiscard]]
+	bool updateShader(u32 stage, ID3D11DeviceChild* shader, std::span<ID3D11ClassInstance* const> instances) noexcept {
+		// Class instances aren't tracked
+		if (not instances.empty()) {
+			stages[stage].shader.reset();
+			++stats.shaders.issued;
+			return true;
+		}
+		return update(stages[stage].shader, shader, stats.shaders);
+	}
+
+	[[nodiscard]]
+	bool updateConstantBuffers(u32 stage, u32& start_slot, std::span<ID3D11Buffer* const>& buffers) noexcept {
+		return update(stages[stage].constant_buffers, start_slot, buffers, stats.constant_buffers);
+	}
+
+	[[nodiscard]]
+	bool updateSRVs(u32 stage, u32& start_slot, std::span<ID3D11ShaderResourceView* const>& srvs) noexcept {
+		return update(stages[stage].srvs, start_slot, srvs, stats.srvs);
+	}
+
+	[[nodiscard]]
+	bool updateSamplers(u32 stage, u32& start_slot, std::span<ID3D11SamplerState* const>& samplers) noexcept {
+		return update(stages[stage].samplers, start_slot, samplers, stats.samplers);
+	}
+
+	[[nodiscard]]
+	bool updateVertexBuffers(u32& start_slot,
+	                         std::span<ID3D11Buffer* const>& buffers,
+	                         const u32*& strides,
+	                         const u32*& offsets) noexcept {
+
+		constexpr size_t slot_count = D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+
+		if (not strides or not offsets or (start_slot >= slot_count) or (buffers.size() > slot_count - start_slot)) {
+			vertex_buffers.invalidate();
+			++stats.input_assembler.issued;
+			return true;
+		}
+
+		size_t first = buffers.size();
+		size_t last  = 0;
+		for (size_t i = 0; i < buffers.size(); ++i) {
+			if (vertex_buffers.update(start_slot + i, VertexBuffer{buffers[i], strides[i], offsets[i]})) {
+				first = std::min(first, i);
+				last  = i + 1;
+			}
+		}
+
+		if (first == buffers.size()) {
+			++stats.input_assembler.skipped;
+			return false;
+		}
+
+		start_slot += static_cast<u32>(first);
+		buffers     = buffers.subspan(first, last - first);
+		strides    += first;
+		offsets    += first;
+		++stats.input_assembler.issued;
+		return true;
+	}
+
+	// Binding a render target or UAV unbinds the SRVs of the same resource
+	void updateOutput() noexcept {
+		for (auto& stage : stages) {
+			stage.srvs.invalidate();
+		}
+		++stats.output_merger.issued;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// Indexed by the stage index of the Pipeline's stages (CS, DS, GS, HS, PS, VS)
+	std::array<StageState, 6> stages;
+
+	SlotState<VertexBuffer, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> vertex_buffers;
+	std::optional<IndexBuffer>              index_buffer;
+	std::optional<ID3D11InputLayout*>       input_layout;
+	std::optional<D3D11_PRIMITIVE_TOPOLOGY> topology;
+
+	std::optional<BlendState>             blend_state;
+	std::optional<DepthStencilState>      depth_stencil_state;
+	std::optional<ID3D11RasterizerState*> rasterizer_state;
+
+	PipelineBindStats stats;
+};
+
+
 class Pipeline final {
 public:
 	Pipeline() = delete;
 	~Pipeline() = delete;
 
+	// Filter the binds made on a device context through its state cache. Only one context
+	// can have a cache at a time. Pass a null cache to remove it. Binds to other contexts are
+	// always issued. Must not be called while another thread is binding through the Pipeline.
+	static void setStateCache(ID3D11DeviceContext& device_context, PipelineStateCache* cache) noexcept {
+		cached_context = cache ? &device_context : nullptr;
+		state_cache    = cache;
+		if (cache)
+			cache->invalidate();
+	}
+
+	// The state cache of a device context, or null if it doesn't have one
+	[[nodiscard]]
+	static PipelineStateCache* getStateCache(const ID3D11DeviceContext& device_context) noexcept {
+		return (&device_context == cached_context) ? state_cache : nullptr;
+	}
+
+	// Forget the state bound to a device context. Must be called after code that binds to the
+	// context without going through the Pipeline.
+	static void invalidateState(const ID3D11DeviceContext& device_context) noexcept {
+		if (auto* cache = getStateCache(device_context))
+			cache->invalidate();
+	}
+
 	// Bind a sampler to every stage
 	static void bindSampler(ID3D11DeviceContext& device_context,
 	                        u32 start_slot,
@@ -135,6 +452,14 @@ public:
 		                                    instance_start);
 	}
 
+	static void dispatch(ID3D11DeviceContext& device_context,
+	                     u32 group_count_x,
+	                     u32 group_count_y,
+	                     u32 group_count_z = 1) {
+
+		device_context.Dispatch(group_count_x, group_count_y, group_count_z);
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Input Assembler
@@ -145,6 +470,11 @@ public:
 		                            DXGI_FORMAT format,
 		                            u32 offset) {
 
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->update(cache->index_buffer, {buffer, format, offset}, cache->stats.input_assembler))
+					return;
+			}
+
 			device_context.IASetIndexBuffer(buffer, format, offset);
 		}
 
@@ -165,16 +495,31 @@ public:
 		                              const u32* strides,
 		                              const u32* offsets) {
 
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->updateVertexBuffers(start_slot, buffers, strides, offsets))
+					return;
+			}
+
 			device_context.IASetVertexBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data(), strides, offsets);
 		}
 
 		static void bindInputLayout(ID3D11DeviceContext& device_context,
 		                            ID3D11InputLayout* layout) {
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->update(cache->input_layout, layout, cache->stats.input_assembler))
+					return;
+			}
+
 			device_context.IASetInputLayout(layout);
 		}
 
 		static void bindPrimitiveTopology(ID3D11DeviceContext& device_context,
 		                                  D3D11_PRIMITIVE_TOPOLOGY topology) {
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->update(cache->topology, topology, cache->stats.input_assembler))
+					return;
+			}
+
 			device_context.IASetPrimitiveTopology(topology);
 		}
 	};
@@ -189,6 +534,16 @@ public:
 		                           const f32 blend_factor[4],
 		                           u32 sample_mask) {
 
+			if (auto* cache = getStateCache(device_context)) {
+				// A null blend factor is the same as a factor of 1
+				PipelineStateCache::BlendState blend{state, {1.0f, 1.0f, 1.0f, 1.0f}, sample_mask};
+				if (blend_factor)
+					std::copy_n(blend_factor, 4, blend.blend_factor.begin());
+
+				if (not cache->update(cache->blend_state, blend, cache->stats.states))
+					return;
+			}
+
 			device_context.OMSetBlendState(state, blend_factor, sample_mask);
 		}
 
@@ -196,6 +551,11 @@ public:
 		                                  ID3D11DepthStencilState* state,
 		                                  u32 stencil_ref) {
 
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->update(cache->depth_stencil_state, {state, stencil_ref}, cache->stats.states))
+					return;
+			}
+
 			device_context.OMSetDepthStencilState(state, stencil_ref);
 		}
 
@@ -216,6 +576,8 @@ public:
 		                           std::span<ID3D11RenderTargetView* const> rtvs,
 		                           ID3D11DepthStencilView* dsv) {
 
+			filterOutput(device_context);
+
 			device_context.OMSetRenderTargets(static_cast<UINT>(rtvs.size()), rtvs.data(), dsv);
 		}
 
@@ -226,6 +588,8 @@ public:
 		                            std::span<ID3D11UnorderedAccessView* const> uavs,
 		                            u32 initial_counts) {
 
+			filterOutput(device_context);
+
 			device_context.OMSetRenderTargetsAndUnorderedAccessViews(static_cast<UINT>(rtvs.size()),
 			                                                         rtvs.data(),
 			                                                         dsv,
@@ -261,10 +625,15 @@ public:
 	// Compute Stage
 	//----------------------------------------------------------------------------------
 	struct CS {
+		static constexpr u32 index = 0;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11ComputeShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.CSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -280,6 +649,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.CSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -295,6 +667,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.CSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -310,6 +685,9 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.CSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 
@@ -327,6 +705,8 @@ public:
 		                     std::span<ID3D11UnorderedAccessView* const> uavs,
 		                     const u32* initial_counts = nullptr) {
 
+			filterOutput(device_context);
+
 			device_context.CSSetUnorderedAccessViews(start_slot, static_cast<UINT>(uavs.size()), uavs.data(), initial_counts);
 		}
 	};
@@ -336,10 +716,15 @@ public:
 	// Domain Stage
 	//----------------------------------------------------------------------------------
 	struct DS {
+		static constexpr u32 index = 1;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11DomainShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.DSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -355,6 +740,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.DSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -370,6 +758,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.DSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -385,6 +776,9 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.DSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 	};
@@ -394,10 +788,15 @@ public:
 	// Geometry Stage
 	//----------------------------------------------------------------------------------
 	struct GS {
+		static constexpr u32 index = 2;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11GeometryShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.GSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -413,6 +812,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.GSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -428,6 +830,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.GSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -443,6 +848,9 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.GSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 	};
@@ -452,10 +860,15 @@ public:
 	// Hull Stage
 	//----------------------------------------------------------------------------------
 	struct HS {
+		static constexpr u32 index = 3;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11HullShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.HSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -471,6 +884,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.HSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -486,6 +902,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.HSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -501,6 +920,9 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.HSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 	};
@@ -510,10 +932,15 @@ public:
 	// Pixel Stage
 	//----------------------------------------------------------------------------------
 	struct PS {
+		static constexpr u32 index = 4;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11PixelShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.PSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -529,6 +956,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.PSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -544,6 +974,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.PSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -559,6 +992,9 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.PSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 	};
@@ -577,6 +1013,11 @@ public:
 		static void bindState(ID3D11DeviceContext& device_context,
 		                      ID3D11RasterizerState* state) {
 
+			if (auto* cache = getStateCache(device_context)) {
+				if (not cache->update(cache->rasterizer_state, state, cache->stats.states))
+					return;
+			}
+
 			device_context.RSSetState(state);
 		}
 
@@ -592,10 +1033,15 @@ public:
 	// Vertex Stage
 	//----------------------------------------------------------------------------------
 	struct VS {
+		static constexpr u32 index = 5;
+
 		static void bindShader(ID3D11DeviceContext& device_context,
 		                       ID3D11VertexShader* shader,
 		                       std::span<ID3D11ClassInstance* const> instances) {
 
+			if (not filterShader(device_context, index, shader, instances))
+				return;
+
 			device_context.VSSetShader(shader, instances.data(), static_cast<UINT>(instances.size()));
 		}
 
@@ -611,6 +1057,9 @@ public:
 		                         u32 start_slot,
 		                         std::span<ID3D11SamplerState* const> samplers) {
 
+			if (not filterSamplers(device_context, index, start_slot, samplers))
+				return;
+
 			device_context.VSSetSamplers(start_slot, static_cast<UINT>(samplers.size()), samplers.data());
 		}
 
@@ -626,6 +1075,9 @@ public:
 		                                u32 start_slot,
 		                                std::span<ID3D11Buffer* const> buffers) {
 
+			if (not filterConstantBuffers(device_context, index, start_slot, buffers))
+				return;
+
 			device_context.VSSetConstantBuffers(start_slot, static_cast<UINT>(buffers.size()), buffers.data());
 		}
 
@@ -641,9 +1093,77 @@ public:
 		                     u32 start_slot,
 		                     std::span<ID3D11ShaderResourceView* const> srvs) {
 
+			if (not filterSRVs(device_context, index, start_slot, srvs))
+				return;
+
 			device_context.VSSetShaderResources(start_slot, static_cast<UINT>(srvs.size()), srvs.data());
 		}
 	};
+
+private:
+
+	//----------------------------------------------------------------------------------
+	// State Cache
+	//----------------------------------------------------------------------------------
+
+	// Each filter records a bind in the device context's state cache, and returns false if
+	// the bind is redundant. Ranges are trimmed to the slots that changed. Binds are always
+	// issued if the context doesn't have a cache.
+
+	[[nodiscard]]
+	static bool filterShader(ID3D11DeviceContext& device_context,
+	                         u32 stage,
+	                         ID3D11DeviceChild* shader,
+	                         std::span<ID3D11ClassInstance* const> instances) noexcept {
+
+		auto* cache = getStateCache(device_context);
+		return cache ? cache->updateShader(stage, shader, instances) : true;
+	}
+
+	[[nodiscard]]
+	static bool filterConstantBuffers(ID3D11DeviceContext& device_context,
+	                                  u32 stage,
+	                                  u32& start_slot,
+	                                  std::span<ID3D11Buffer* const>& buffers) noexcept {
+
+		auto* cache = getStateCache(device_context);
+		return cache ? cache->updateConstantBuffers(stage, start_slot, buffers) : true;
+	}
+
+	[[nodiscard]]
+	static bool filterSRVs(ID3D11DeviceContext& device_context,
+	                       u32 stage,
+	                       u32& start_slot,
+	                       std::span<ID3D11ShaderResourceView* const>& srvs) noexcept {
+
+		auto* cache = getStateCache(device_context);
+		return cache ? cache->updateSRVs(stage, start_slot, srvs) : true;
+	}
+
+	[[nodiscard]]
+	static bool filterSamplers(ID3D11DeviceContext& device_context,
+	                           u32 stage,
+	                           u32& start_slot,
+	                           std::span<ID3D11SamplerState* const>& samplers) noexcept {
+
+		auto* cache = getStateCache(device_context);
+		return cache ? cache->updateSamplers(stage, start_slot, samplers) : true;
+	}
+
+	// Render target and UAV binds are always issued
+	static void filterOutput(ID3D11DeviceContext& device_context) noexcept {
+		if (auto* cache = getStateCache(device_context))
+			cache->updateOutput();
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// The device context with a state cache, and its cache
+	static inline const ID3D11DeviceContext* cached_context = nullptr;
+	static inline PipelineStateCache*        state_cache    = nullptr;
 };
 
 } //namespace render
@@ -4,6 +4,7 @@ module;
 
 #include "datatypes/types.h"
 #include "directx/d3d11.h"
+#include "profiler/profiler.h"
 
 module rendering;
 
@@ -12,6 +13,14 @@ import log;
 using namespace std::chrono_literals;
 
 
+namespace {
+
+// The zone that spans the whole frame
+constexpr ProfileZone frame_zone{"Frame", __FILE__, __LINE__};
+
+}
+
+
 namespace render {
 
 GPUProfiler::GPUProfiler(ID3D11Device& device, ID3D11DeviceContext& device_context)
@@ -19,68 +28,74 @@ GPUProfiler::GPUProfiler(ID3D11Device& device, ID3D11DeviceContext& device_conte
     , device_context(device_context) {
 
 	static constexpr D3D11_QUERY_DESC disjoint_desc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
-	for (auto& ptr : timestamp_disjoint) {
-		HRESULT hr = device.CreateQuery(&disjoint_desc, ptr.GetAddressOf());
+	for (auto& frame : frames) {
+		const HRESULT hr = device.CreateQuery(&disjoint_desc, frame.disjoint.GetAddressOf());
+		if (FAILED(hr))
+			Logger::log(LogLevel::err, "Failed to create GPU profiler disjoint query");
 	}
 }
 
 
-void GPUProfiler::registerTimestampID(const std::string& identifier) {
-	static constexpr D3D11_QUERY_DESC timestamp_desc = {D3D11_QUERY_TIMESTAMP, 0};
+void GPUProfiler::beginFrame() {
+	auto& frame = frames[query_frame];
+	frame.records.clear();
+	frame.cpu_begin = Profiler::now();
+	open_zones.clear();
+
+	device_context.Begin(frame.disjoint.Get());
+	beginZone(frame_zone);
+}
 
-	// Create the begin/end queries for the stage
-	HRESULT hr1, hr2;
-	for (u8 i = 0; i < buffer_size; ++i) {
-		auto result = timestamps[i].try_emplace(identifier); //result = pair<iterator, bool>
-		auto& query_pair = result.first->second;
-		hr1 = device.CreateQuery(&timestamp_desc, query_pair.first.GetAddressOf());
-		hr2 = device.CreateQuery(&timestamp_desc, query_pair.second.GetAddressOf());
-	}
 
-	if (FAILED(hr1) || FAILED(hr2)) {
-		Logger::log(LogLevel::err, "Failed to register timestamp ID: {}", identifier);
-	} else {
-		timestamp_ids.push_back(identifier); //add the ID to the list of registered IDs
+void GPUProfiler::endFrame() {
+	// End any zones left open, then the frame zone
+	while (not open_zones.empty()) {
+		endZone();
 	}
+
+	device_context.End(frames[query_frame].disjoint.Get());
+	query_frame += 1;
+	if (query_frame >= buffer_size) query_frame = 0;
 }
 
 
-const std::vector<std::string>& GPUProfiler::getTimestampIDs() const noexcept {
-	return timestamp_ids;
-}
+void GPUProfiler::beginZone(const ProfileZone& zone) {
+	auto& frame = frames[query_frame];
 
+	// Each zone entered in a frame gets its own queries. Create more if this frame has used them all.
+	const auto index = static_cast<u32>(frame.records.size());
+	if (index >= frame.queries.size()) {
+		static constexpr D3D11_QUERY_DESC timestamp_desc = {D3D11_QUERY_TIMESTAMP, 0};
 
-void GPUProfiler::beginFrame() {
-	device_context.Begin(timestamp_disjoint[query_frame].Get());
-	beginTimestamp("Frame");
-}
+		QueryPair pair;
+		const HRESULT hr1 = device.CreateQuery(&timestamp_desc, pair.begin.GetAddressOf());
+		const HRESULT hr2 = device.CreateQuery(&timestamp_desc, pair.end.GetAddressOf());
+		if (FAILED(hr1) or FAILED(hr2)) {
+			Logger::log(LogLevel::err, "Failed to create timestamp queries for zone: {}", zone.name);
+			open_zones.push_back(std::numeric_limits<u32>::max());
+			return;
+		}
+		frame.queries.push_back(std::move(pair));
+	}
 
+	device_context.End(frame.queries[index].begin.Get());
 
-void GPUProfiler::endFrame() {
-	endTimestamp("Frame");
-	device_context.End(timestamp_disjoint[query_frame].Get());
-	query_frame += 1;
-	if (query_frame >= buffer_size) query_frame = 0;
+	frame.records.push_back(ZoneRecord{&zone, static_cast<u32>(open_zones.size()), index});
+	open_zones.push_back(index);
 }
 
 
-void GPUProfiler::beginTimestamp(const std::string& identifier) {
-	if (const auto it = timestamps[query_frame].find(identifier); it != timestamps[query_frame].end()) {
-		device_context.End(it->second.first.Get());
-	}
-	else {
-		registerTimestampID(identifier);
+void GPUProfiler::endZone() {
+	if (open_zones.empty()) {
+		Logger::log(LogLevel::warn, "GPUProfiler::endZone() - No zone is open");
+		return;
 	}
-}
 
+	const u32 index = open_zones.back();
+	open_zones.pop_back();
 
-void GPUProfiler::endTimestamp(const std::string& identifier) {
-	if (auto it = timestamps[query_frame].find(identifier); it != timestamps[query_frame].end()) {
-		device_context.End(it->second.second.Get());
-	}
-	else {
-		Logger::log(LogLevel::warn, "GPUProfiler::endTimestamp() - Unknown timestamp identifier: \"{}\"", identifier);
-	}
+	if (index != std::numeric_limits<u32>::max())
+		device_context.End(frames[query_frame].queries[index].end.Get());
 }
 
 
@@ -102,15 +117,25 @@ void GPUProfiler::update() {
 	else
 		read_frame += 1;
 
-	/* Wait for data to be ready?
-	while (device_context.GetData(timestamp_disjoint[frame].Get(), nullptr, 0, 0) == S_FALSE) {
-		Sleep(1);
+	readFrame(frames[frame]);
+
+	// Update the average times if enough time has passed
+	if (timer.totalTime() >= 500ms) {
+		for (size_t i = 0; i < zone_stats.size(); ++i) {
+			zone_stats[i].average_time = (frame_count > 0) ? (total_zone_times[i] / static_cast<f32>(frame_count)) : 0.0f;
+			total_zone_times[i] = 0.0f;
+		}
+		frame_count = 0;
+		timer.reset();
 	}
-	*/
+}
+
+
+void GPUProfiler::readFrame(FrameQueries& frame) {
 
 	// Get the disjoint timestamp data
 	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint_ts;
-	if (device_context.GetData(timestamp_disjoint[frame].Get(), &disjoint_ts, sizeof(disjoint_ts), 0) != S_OK) {
+	if (device_context.GetData(frame.disjoint.Get(), &disjoint_ts, sizeof(disjoint_ts), 0) != S_OK) {
 		Logger::log(LogLevel::debug, "Failed to read disjoint timestamp data");
 		return;
 	}
@@ -121,62 +146,76 @@ void GPUProfiler::update() {
 		return;
 	}
 
-	// Calculate the elapsed time for each stage
-	for (auto& id : timestamp_ids) {
+	for (auto& stats : zone_stats) {
+		stats.delta_time = 0.0f;
+	}
+
+	const f64 frequency = static_cast<f64>(disjoint_ts.Frequency);
+	const bool capturing = Profiler::isCapturing();
+
+	std::vector<ProfileEvent> events;
+	UINT64 frame_begin_ts = 0;
+
+	// Calculate the elapsed time for each zone
+	for (const auto& record : frame.records) {
 		UINT64 begin_ts = 0;
 		UINT64 end_ts = 0;
 
-		// Get the stage begin time
-		if (device_context.GetData(timestamps[frame][id].first.Get(), &begin_ts, sizeof(begin_ts), 0) != S_OK) {
-			//Logger::log(LogLevel::debug, "Failed to read \"{}\" begin timestamp data", id);
+		const auto& queries = frame.queries[record.query];
+		if ((device_context.GetData(queries.begin.Get(), &begin_ts, sizeof(begin_ts), 0) != S_OK)
+		    or (device_context.GetData(queries.end.Get(), &end_ts, sizeof(end_ts), 0) != S_OK)
+		    or (end_ts < begin_ts)) {
+			continue;
 		}
 
-		// Get the stage end time
-		if (device_context.GetData(timestamps[frame][id].second.Get(), &end_ts, sizeof(end_ts), 0) != S_OK) {
-			//Logger::log(LogLevel::debug, "Failed to read \"{}\" end timestamp data", id);
+		// The frame zone is always the first record
+		if (record.zone == &frame_zone)
+			frame_begin_ts = begin_ts;
+
+		const f32 time = static_cast<f32>(static_cast<f64>(end_ts - begin_ts) / frequency);
+
+		// Merge with the stats of the same zone at the same depth, or add new stats
+		auto it = std::ranges::find_if(zone_stats, [&record](const GPUZoneStats& stats) {
+			return (stats.zone == record.zone) and (stats.depth == record.depth);
+		});
+		if (it == zone_stats.end()) {
+			it = zone_stats.insert(zone_stats.end(), GPUZoneStats{record.zone, record.depth});
+			total_zone_times.push_back(0.0f);
 		}
 
-		f32 time = static_cast<f32>(end_ts - begin_ts) / static_cast<f32>(disjoint_ts.Frequency);
-		stage_times[id] = time;
-		total_stage_times[id] += time;
-	}
+		it->delta_time += time;
+		total_zone_times[static_cast<size_t>(it - zone_stats.begin())] += time;
 
-	// Update the elapsed time and frame count, and update the avg times if enough time has passed.
-	++frame_count;
-	if (timer.totalTime() >= 500ms) {
-		for (auto& id : timestamp_ids) {
-			avg_stage_times[id] = total_stage_times[id] / static_cast<f32>(frame_count);
-			total_stage_times[id] = 0.0f;
+		// Map the zone onto the CPU timeline
+		if (capturing and (frame_begin_ts != 0) and (begin_ts >= frame_begin_ts)) {
+			const auto to_ns = [&](UINT64 ts) {
+				return frame.cpu_begin + static_cast<u64>(static_cast<f64>(ts - frame_begin_ts) * 1e9 / frequency);
+			};
+			events.push_back(ProfileEvent{record.zone, to_ns(begin_ts), to_ns(end_ts), record.depth});
 		}
-		frame_count = 0;
-		timer.reset();
 	}
-}
 
+	++frame_count;
 
-f32 GPUProfiler::deltaTime(const std::string& id) const {
-	if (auto it = stage_times.find(id); it != stage_times.end()) {
-		return it->second;
-	}
-	return 0.0f;
+	if (not events.empty())
+		Profiler::submitGPUZones(events);
 }
 
 
-f32 GPUProfiler::averageTime(const std::string& id) const {
-	if (auto it = avg_stage_times.find(id); it != avg_stage_times.end()) {
-		return it->second;
-	}
-	return 0.0f;
+const std::vector<GPUZoneStats>& GPUProfiler::getZones() const noexcept {
+	return zone_stats;
 }
 
 
-const std::unordered_map<std::string, f32>& GPUProfiler::getDeltaTimes() const noexcept {
-	return stage_times;
+f32 GPUProfiler::frameDeltaTime() const noexcept {
+	const auto it = std::ranges::find(zone_stats, &frame_zone, &GPUZoneStats::zone);
+	return (it != zone_stats.end()) ? it->delta_time : 0.0f;
 }
 
 
-const std::unordered_map<std::string, f32>& GPUProfiler::getAverageTimes() const noexcept {
-	return avg_stage_times;
+f32 GPUProfiler::frameAverageTime() const noexcept {
+	const auto it = std::ranges::find(zone_stats, &frame_zone, &GPUZoneStats::zone);
+	return (it != zone_stats.end()) ? it->average_time : 0.0f;
 }
 
 } //namespace render
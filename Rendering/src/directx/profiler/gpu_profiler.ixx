@@ -2,6 +2,7 @@ module;
 
 #include "datatypes/types.h"
 #include "directx/d3d11.h"
+#include "profiler/profiler.h"
 #include "time/stopwatch.h"
 
 export module rendering:gpu_profiler;
@@ -10,13 +11,80 @@ import log;
 
 export namespace render {
 
+// The GPU time spent in a zone. Zones that were entered more than once at the same depth
+// in a frame are merged.
+struct GPUZoneStats {
+	const ProfileZone* zone         = nullptr;
+	u32                depth        = 0;
+	f32                delta_time   = 0.0f; //seconds, last frame
+	f32                average_time = 0.0f; //seconds
+};
+
+
+//----------------------------------------------------------------------------------
+// GPUProfiler
+//----------------------------------------------------------------------------------
+//
+// Measures the GPU time of profiler zones with timestamp queries. Queries are read
+// back a few frames later, to avoid stalling the CPU. Zones are identified by their
+// ProfileZone, which is normally declared with the PROFILE_GPU_ZONE macro so that
+// the zone is recorded on the CPU as well.
+//
+// While the CPU profiler is capturing, the measured zones are mapped onto the CPU
+// timeline (relative to the time the frame began on the CPU) and submitted to it.
+//
+//----------------------------------------------------------------------------------
 class GPUProfiler {
 
 	// Number of frames to buffer before reading data. Must be 2 or more.
 	static constexpr u8 buffer_size = 8;
 
+	// The timestamp queries of a zone
+	struct QueryPair {
+		ComPtr<ID3D11Query> begin;
+		ComPtr<ID3D11Query> end;
+	};
+
+	// A zone that was entered in a frame
+	struct ZoneRecord {
+		const ProfileZone* zone  = nullptr;
+		u32                depth = 0;
+		u32                query = 0;
+	};
+
+	// The queries issued during a frame
+	struct FrameQueries {
+		ComPtr<ID3D11Query>     disjoint;
+		std::vector<QueryPair>  queries;
+		std::vector<ZoneRecord> records;
+		u64                     cpu_begin = 0; //Profiler::now() when the frame began
+	};
+
 public:
 
+	// Ends a GPU zone when destroyed
+	class Scope final {
+		friend class GPUProfiler;
+
+		explicit Scope(GPUProfiler* profiler) noexcept : profiler(profiler) {}
+
+	public:
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+
+		~Scope() {
+			if (profiler)
+				profiler->endZone();
+		}
+
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+
+	private:
+		GPUProfiler* profiler;
+	};
+
+
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
@@ -42,46 +110,43 @@ public:
 	// Member Functions
 	//----------------------------------------------------------------------------------
 
-	// Get the list of timestamp IDs
-	[[nodiscard]]
-	const std::vector<std::string>& getTimestampIDs() const noexcept;
-
 	// Begin profiling a new GPU frame
 	void beginFrame();
 
 	// End the current GPU frame
 	void endFrame();
 
-	// Mark the beginning of the stage
-	void beginTimestamp(const std::string& identifier);
+	// Mark the beginning of a zone. Zones must be ended in the reverse order they begin.
+	void beginZone(const ProfileZone& zone);
 
-	// Mark the end of the stage
-	void endTimestamp(const std::string& identifier);
+	// Mark the end of the innermost zone
+	void endZone();
+
+	// Begin a zone that ends when the returned scope is destroyed
+	[[nodiscard]]
+	Scope scope(const ProfileZone& zone) {
+		beginZone(zone);
+		return Scope{this};
+	}
 
 	// Get the data from the earliest frame
 	void update();
 
-	// Get the last frame's time to render the stage represented by the provided ID
-	[[nodiscard]]
-	f32 deltaTime(const std::string& id) const;
-
-	// Get the average time to render the stage represented by the provided ID
+	// Get the zones that have been measured, in the order they were first entered
 	[[nodiscard]]
-	f32 averageTime(const std::string& id) const;
+	const std::vector<GPUZoneStats>& getZones() const noexcept;
 
-	// Get the map of timestamp IDs to delta times
+	// Get the whole frame's GPU time. Last frame and average.
 	[[nodiscard]]
-	const std::unordered_map<std::string, f32>& getDeltaTimes() const noexcept;
+	f32 frameDeltaTime() const noexcept;
 
-	// Get the map of timestamp IDs to average times
 	[[nodiscard]]
-	const std::unordered_map<std::string, f32>& getAverageTimes() const noexcept;
+	f32 frameAverageTime() const noexcept;
 
 
 private:
 
-	// Register a new timestamp ID
-	void registerTimestampID(const std::string& identifier);
+	void readFrame(FrameQueries& frame);
 
 
 	//----------------------------------------------------------------------------------
@@ -92,23 +157,18 @@ private:
 	ID3D11Device&        device;
 	ID3D11DeviceContext& device_context;
 
-	// A timer used for averaging the stage times
+	// A timer used for averaging the zone times
 	Stopwatch<> timer;
 
-	// The disjoint time stamp, which indicates valid timestamps and the GPU frequency
-	std::array<ComPtr<ID3D11Query>, buffer_size> timestamp_disjoint;
-
-	// The registered timestamp IDs
-	std::vector<std::string> timestamp_ids;
+	// The queries of each buffered frame
+	std::array<FrameQueries, buffer_size> frames;
 
-	// An array of id_string->timestamp maps. Array size depends on the amount of buffering.
-	using timestamp_map = std::unordered_map<std::string, std::pair<ComPtr<ID3D11Query>, ComPtr<ID3D11Query>>>;
-	std::array<timestamp_map, buffer_size> timestamps;
+	// The records of the zones that haven't ended yet in the current frame
+	std::vector<u32> open_zones;
 
-	// Render times for each timestamp ID. Single frame and average times.
-	std::unordered_map<std::string, f32> stage_times;
-	std::unordered_map<std::string, f32> total_stage_times;
-	std::unordered_map<std::string, f32> avg_stage_times;
+	// Measured times for each zone. Single frame and average times.
+	std::vector<GPUZoneStats> zone_stats;
+	std::vector<f32>          total_zone_times;
 	u32 frame_count = 0;
 
 	// The buffer frame to query data into
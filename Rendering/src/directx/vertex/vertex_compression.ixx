@@ -0,0 +1,143 @@
+module;
+
+#include <algorithm>
+#include <cmath>
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+export module rendering:vertex_compression;
+
+import math.directxmath;
+import math.geometry;
+
+using namespace DirectX;
+
+
+//----------------------------------------------------------------------------------
+// Vertex Compression
+//----------------------------------------------------------------------------------
+//
+// Encoding and decoding of compact vertex attributes:
+//   - Positions are quantized to 16-bit unorm values relative to the mesh's AABB.
+//     The GPU reads them as [0, 1], and the dequantization is applied as part of
+//     the model's object-to-world matrix.
+//   - Unit vectors (normals, tangents) are octahedral encoded into two 16-bit snorm
+//     values, and decoded in the vertex shader.
+//   - Texture coordinates are stored as half floats, which the GPU converts on load.
+//
+//----------------------------------------------------------------------------------
+export namespace render {
+
+// Maps quantized positions in [0, 1] back to object space: position = offset + (q * scale)
+struct VertexQuantization {
+	[[nodiscard]]
+	static VertexQuantization fromAABB(const AABB& aabb) noexcept {
+		VertexQuantization quantization;
+		XMStore(&quantization.offset, aabb.min());
+
+		const auto extent = XMVectorSubtract(aabb.max(), aabb.min());
+		XMStore(&quantization.scale, extent);
+
+		// Flat meshes have no extent on some axis. Keep the scale invertible.
+		for (u32 i = 0; i < 3; ++i) {
+			if (not (quantization.scale[i] > 0.0f))
+				quantization.scale[i] = 1.0f;
+		}
+
+		return quantization;
+	}
+
+	[[nodiscard]]
+	u16_4 encode(const f32_3& position) const noexcept {
+		u16_4 out;
+		for (u32 i = 0; i < 3; ++i) {
+			const f32 normalized = std::clamp((position[i] - offset[i]) / scale[i], 0.0f, 1.0f);
+			out[i] = static_cast<u16>(std::lround(normalized * 65535.0f));
+		}
+		out[3] = 65535; //w = 1
+		return out;
+	}
+
+	[[nodiscard]]
+	f32_3 decode(const u16_4& position) const noexcept {
+		f32_3 out;
+		for (u32 i = 0; i < 3; ++i) {
+			out[i] = offset[i] + ((static_cast<f32>(position[i]) / 65535.0f) * scale[i]);
+		}
+		return out;
+	}
+
+	// The transform applied to quantized positions on the GPU
+	[[nodiscard]]
+	XMMATRIX XM_CALLCONV getTransform() const noexcept {
+		return XMMatrixScaling(scale[0], scale[1], scale[2]) * XMMatrixTranslation(offset[0], offset[1], offset[2]);
+	}
+
+	f32_3 offset = {0.0f, 0.0f, 0.0f};
+	f32_3 scale  = {1.0f, 1.0f, 1.0f};
+};
+
+
+[[nodiscard]]
+inline i16 EncodeSnorm16(f32 value) noexcept {
+	return static_cast<i16>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+[[nodiscard]]
+inline f32 DecodeSnorm16(i16 value) noexcept {
+	return std::max(static_cast<f32>(value) / 32767.0f, -1.0f);
+}
+
+
+// Encode a unit vector by projecting it onto an octahedron, which is unfolded onto a square
+[[nodiscard]]
+inline i16_2 EncodeOctahedral(const f32_3& v) noexcept {
+	const f32 l1 = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+	if (l1 == 0.0f)
+		return i16_2{i16{0}, i16{0}};
+
+	f32 x = v[0] / l1;
+	f32 y = v[1] / l1;
+
+	// Fold the lower hemisphere over the diagonals
+	if (v[2] < 0.0f) {
+		const f32 folded_x = (1.0f - std::abs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+		const f32 folded_y = (1.0f - std::abs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+		x = folded_x;
+		y = folded_y;
+	}
+
+	return i16_2{EncodeSnorm16(x), EncodeSnorm16(y)};
+}
+
+[[nodiscard]]
+inline f32_3 DecodeOctahedral(const i16_2& encoded) noexcept {
+	f32 x = DecodeSnorm16(encoded[0]);
+	f32 y = DecodeSnorm16(encoded[1]);
+	const f32 z = 1.0f - std::abs(x) - std::abs(y);
+
+	// Unfold the lower hemisphere
+	const f32 t = std::max(-z, 0.0f);
+	x += (x >= 0.0f) ? -t : t;
+	y += (y >= 0.0f) ? -t : t;
+
+	const f32 length = std::sqrt((x * x) + (y * y) + (z * z));
+	return f32_3{x / length, y / length, z / length};
+}
+
+
+[[nodiscard]]
+inline u16_2 EncodeHalf2(const f32_2& v) noexcept {
+	return u16_2{PackedVector::XMConvertFloatToHalf(v[0]), PackedVector::XMConvertFloatToHalf(v[1])};
+}
+
+[[nodiscard]]
+inline f32_2 DecodeHalf2(const u16_2& v) noexcept {
+	return f32_2{PackedVector::XMConvertHalfToFloat(v[0]), PackedVector::XMConvertHalfToFloat(v[1])};
+}
+
+} //namespace render
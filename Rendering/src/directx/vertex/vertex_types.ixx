@@ -43,6 +43,7 @@ struct VertexPosition final {
 	static constexpr bool hasNormal() noexcept { return false; }
 	static constexpr bool hasColor() noexcept { return false; }
 	static constexpr bool hasTexture() noexcept { return false; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -97,6 +98,7 @@ struct VertexPositionColor final {
 	static constexpr bool hasNormal() noexcept { return false; }
 	static constexpr bool hasColor() noexcept { return true; }
 	static constexpr bool hasTexture() noexcept { return false; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -153,6 +155,7 @@ struct VertexPositionTexture final {
 	static constexpr bool hasNormal() noexcept { return false; }
 	static constexpr bool hasColor() noexcept { return false; }
 	static constexpr bool hasTexture() noexcept { return true; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -168,7 +171,7 @@ struct VertexPositionTexture final {
 	};
 };
 
-static_assert(sizeof(VertexPositionColor) == 28, "Vertex struct/layout mismatch");
+static_assert(sizeof(VertexPositionTexture) == 20, "Vertex struct/layout mismatch");
 
 
 
@@ -209,6 +212,7 @@ struct VertexPositionNormal final {
 	static constexpr bool hasNormal() noexcept { return true; }
 	static constexpr bool hasColor() noexcept { return false; }
 	static constexpr bool hasTexture() noexcept { return false; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -268,6 +272,7 @@ struct VertexPositionNormalColor final {
 	static constexpr bool hasNormal() noexcept { return true; }
 	static constexpr bool hasColor() noexcept { return true; }
 	static constexpr bool hasTexture() noexcept { return false; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -329,6 +334,7 @@ struct VertexPositionNormalTexture final {
 	static constexpr bool hasNormal() noexcept { return true; }
 	static constexpr bool hasColor() noexcept { return false; }
 	static constexpr bool hasTexture() noexcept { return true; }
+	static constexpr bool isQuantized() noexcept { return false; }
 
 
 	//----------------------------------------------------------------------------------
@@ -348,4 +354,72 @@ struct VertexPositionNormalTexture final {
 
 static_assert(sizeof(VertexPositionNormalTexture) == 32, "Vertex struct/layout mismatch");
 
+
+
+
+//----------------------------------------------------------------------------------
+// Position/Normal/Texture (Compact)
+//----------------------------------------------------------------------------------
+//
+// Half the size of VertexPositionNormalTexture. The position is quantized relative to
+// the mesh's AABB, the normal is octahedral encoded, and the texture coordinates are
+// half floats (see :vertex_compression).
+//
+//----------------------------------------------------------------------------------
+struct VertexPositionNormalTextureCompact final {
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	constexpr VertexPositionNormalTextureCompact() noexcept = default;
+	constexpr VertexPositionNormalTextureCompact(const VertexPositionNormalTextureCompact& vertex) noexcept = default;
+	constexpr VertexPositionNormalTextureCompact(VertexPositionNormalTextureCompact&& vertex) noexcept = default;
+
+	constexpr VertexPositionNormalTextureCompact(const u16_4& position,
+	                                             const i16_2& normal,
+	                                             const u16_2& texCoord) noexcept
+		: position(position)
+		, normal(normal)
+		, texCoord(texCoord) {
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~VertexPositionNormalTextureCompact() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	constexpr VertexPositionNormalTextureCompact& operator=(const VertexPositionNormalTextureCompact& vertex) noexcept = default;
+	constexpr VertexPositionNormalTextureCompact& operator=(VertexPositionNormalTextureCompact&& vertex) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	static constexpr bool hasNormal() noexcept { return true; }
+	static constexpr bool hasColor() noexcept { return false; }
+	static constexpr bool hasTexture() noexcept { return true; }
+	static constexpr bool isQuantized() noexcept { return true; }
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	u16_4 position; //unorm, relative to the mesh's AABB
+	i16_2 normal;   //snorm, octahedral encoded
+	u16_2 texCoord; //half
+
+	static constexpr u32 input_element_count = 3;
+	static constexpr D3D11_INPUT_ELEMENT_DESC input_elements[input_element_count] = {
+		{"POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+	};
+};
+
+static_assert(sizeof(VertexPositionNormalTextureCompact) == 16, "Vertex struct/layout mismatch");
+
 } //export
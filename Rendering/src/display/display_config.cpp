@@ -25,19 +25,22 @@ void DisplayConfig::init() {
 	// Get the default adapter and output
 	ComPtr<IDXGIOutput> output;
 	factory->EnumAdapters1(0, adapter.ReleaseAndGetAddressOf());
-	adapter->EnumOutputs(0, output.GetAddressOf());
-	output.As(&adapter_out);
 
-	// Get the number of display modes
-	u32 mode_count;
-	adapter_out->GetDisplayModeList(DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &mode_count, nullptr);
+	// Get the display modes. An adapter may not have an output (e.g. on a headless machine).
+	std::vector<DXGI_MODE_DESC> display_modes;
+	u32 mode_count = 0;
 
-	// Get the display modes
-	std::vector<DXGI_MODE_DESC> display_modes(mode_count);
-	adapter_out->GetDisplayModeList(DXGI_FORMAT_R8G8B8A8_UNORM,
-	                                DXGI_ENUM_MODES_INTERLACED,
-	                                &mode_count,
-	                                display_modes.data());
+	if (SUCCEEDED(adapter->EnumOutputs(0, output.GetAddressOf())) and SUCCEEDED(output.As(&adapter_out))) {
+		// Get the number of display modes
+		adapter_out->GetDisplayModeList(DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &mode_count, nullptr);
+
+		// Get the display modes
+		display_modes.resize(mode_count);
+		adapter_out->GetDisplayModeList(DXGI_FORMAT_R8G8B8A8_UNORM,
+		                                DXGI_ENUM_MODES_INTERLACED,
+		                                &mode_count,
+		                                display_modes.data());
+	}
 
 
 	// Discard the display modes that are below 800px wide or
@@ -51,6 +54,17 @@ void DisplayConfig::init() {
 		display_desc_list.push_back(display_modes[i]);
 	}
 
+	// Fall back to a windowed 1280x720 mode if there's no output to get the modes from
+	if (display_desc_list.empty()) {
+		DXGI_MODE_DESC desc = {};
+		desc.Width       = 1280;
+		desc.Height      = 720;
+		desc.RefreshRate = {60, 1};
+		desc.Format      = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+		display_desc_list.push_back(desc);
+	}
+
 
 	// Get the highest refresh rate display mode for the current resolution
 	for (size_t i = 0; i < display_desc_list.size(); ++i) {
@@ -211,6 +225,7 @@ void to_json(nl::json& j, const DisplayConfig& cfg) {
 	j[ConfigTokens::display_height] = res[1];
 	j[ConfigTokens::refresh]        = cfg.getRoundedDisplayRefreshRate();
 	j[ConfigTokens::vsync]          = cfg.isVsync();
+	j[ConfigTokens::frame_limit]    = cfg.getFrameRateLimit();
 	j[ConfigTokens::fullscreen]     = cfg.isFullscreen();
 	j[ConfigTokens::aa_type]        = cfg.getAAType();
 }
@@ -236,6 +251,11 @@ void from_json(const nl::json& j, DisplayConfig& cfg) {
 		cfg.setVsync(vsync);
 	}
 
+	if (j.contains(ConfigTokens::frame_limit)) {
+		const auto limit = j.at(ConfigTokens::frame_limit).get<u32>();
+		cfg.setFrameRateLimit(limit);
+	}
+
 	if (j.contains(ConfigTokens::fullscreen)) {
 		const auto fullscreen = j.at(ConfigTokens::fullscreen).get<bool>();
 		cfg.setFullscreen(fullscreen);
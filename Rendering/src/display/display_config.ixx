@@ -194,6 +194,30 @@ public:
 	}
 
 
+	//----------------------------------------------------------------------------------
+	// Member Functions - Frame Rate Limit
+	//----------------------------------------------------------------------------------
+
+	// Set the frame rate the engine is paced to when vsync is off. 0 uses the display's refresh rate.
+	void setFrameRateLimit(u32 fps) noexcept {
+		frame_rate_limit = fps;
+	}
+
+	[[nodiscard]]
+	u32 getFrameRateLimit() const noexcept {
+		return frame_rate_limit;
+	}
+
+	// Get the frame rate the engine should be paced to, or 0 if it shouldn't be paced. Presenting
+	// with vsync already waits for the display.
+	[[nodiscard]]
+	u32 getTargetFrameRate() const noexcept {
+		if (vsync)
+			return 0;
+		return (frame_rate_limit != 0) ? frame_rate_limit : getRoundedDisplayRefreshRate();
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Functions - Adapter/Output
 	//----------------------------------------------------------------------------------
@@ -237,6 +261,8 @@ private:
 	AAType anti_aliasing = AAType::None;
 	bool   fullscreen    = false;
 	bool   vsync         = false;
+
+	u32 frame_rate_limit = 0;
 };
 
 } //namespace render
@@ -13,15 +13,27 @@ namespace ConfigTokens {
 	constexpr gsl::czstring display_height = "Height";
 	constexpr gsl::czstring refresh        = "RefreshRate";
 	constexpr gsl::czstring vsync          = "VSync";
+	constexpr gsl::czstring frame_limit    = "FrameRateLimit";
 	constexpr gsl::czstring fullscreen     = "Fullscreen";
 	constexpr gsl::czstring aa_type        = "AntiAliasing";
 
 	// Rendering config tokens
 	constexpr gsl::czstring render_config                = "rendering";
 	constexpr gsl::czstring smap_res                     = "ShadowMapResolution";
+    constexpr gsl::czstring smap_atlas_res               = "ShadowMapAtlasResolution";
+    constexpr gsl::czstring smap_cube_map_count          = "ShadowMapCubeMapCount";
+    constexpr gsl::czstring smap_cascade_count           = "ShadowMapCascadeCount";
+    constexpr gsl::czstring smap_cascade_lambda          = "ShadowMapCascadeLambda";
+    constexpr gsl::czstring smap_cascade_distance        = "ShadowMapCascadeDistance";
     constexpr gsl::czstring smap_depth_bias              = "ShadowMapDepthBias";
     constexpr gsl::czstring smap_slope_scaled_depth_bias = "ShadowMapSlopeScaledDepthBias";
     constexpr gsl::czstring smap_depth_bias_clamp        = "ShadowMapDepthBiasClamp";
+    constexpr gsl::czstring smap_caching                 = "ShadowMapCaching";
+    constexpr gsl::czstring smap_static_cache            = "ShadowMapStaticCache";
+    constexpr gsl::czstring lod_pixel_error              = "LODPixelError";
+    constexpr gsl::czstring lod_hysteresis               = "LODHysteresis";
+    constexpr gsl::czstring depth_prepass                = "DepthPrepass";
+    constexpr gsl::czstring hot_reload                   = "HotReload";
 
 	// Input config tokens
     constexpr gsl::czstring key_config = "input";
@@ -11,6 +11,7 @@ module;
 #include "directx/directxtk.h"
 #include "io/io.h"
 #include "json/nlohmann_json.h"
+#include "profiler/profiler.h"
 #include "string/string.h"
 
 #include "config/config_tokens.h"
@@ -149,6 +150,10 @@ void Engine::quit() {
 
 	Logger::log(LogLevel::info, "Shutting down...");
 
+	// Finish the steps in flight before destroying the scene
+	waitForSimulation();
+	simulation_thread.reset();
+
 	// Explicity delete the scene before the rendering manager.
 	// This prevents D3D from potentially reporting live resources
 	// that are going to be deleted right after the report.
@@ -212,9 +217,8 @@ void Engine::init(std::wstring title,
 			rendering_mgr->onResize();
 
 			const u32_2 size = window->getClientSize();
-			if (scene) {
-				scene->getECS().send<events::WindowResizeEvent>(size);
-			}
+			resize_event_pending = true;
+			resize_event_size    = size;
 			Logger::log(LogLevel::info, "Window resized to {}x{}", size[0], size[1]);
 		};
 
@@ -235,6 +239,9 @@ void Engine::init(std::wstring title,
 	    std::move(rendering_config)
 	);
 
+	// Simulation Thread
+	simulation_thread = std::make_unique<ThreadPool>(1, "Simulation");
+
 	// Bind exit key if not bound
 	bool save_config = false;
 	if (key_config.tryBindKey("Exit", Keyboard::Escape)) {
@@ -253,6 +260,8 @@ void Engine::init(std::wstring title,
 
 void Engine::loadScene(std::unique_ptr<Scene>&& new_scene) {
 
+	waitForSimulation();
+
 	if (scene) {
 		auto name = scene->getName();
 		scene.reset();
@@ -266,6 +275,7 @@ void Engine::loadScene(std::unique_ptr<Scene>&& new_scene) {
 		scene->load(*this);
 		Logger::log(LogLevel::info, "Scene loaded: {}", scene->getName());
 		timer.reset();
+		fixed_timestep.reset();
 	}
 }
 
@@ -274,28 +284,46 @@ void Engine::run() {
 
 	Logger::log(LogLevel::info, "Begin main loop");
 
+	Profiler::setThreadName("Main");
+
 	// Show the window
 	window->show(SW_SHOWNORMAL);
 
 	// Main loop
 	MSG msg = {};
-	while (msg.message != WM_QUIT && !exit_requested) {
+	while (!exit_requested) {
 
-		if (PeekMessage(&msg, nullptr, NULL, NULL, PM_REMOVE)) {
+		// Process all pending messages
+		while (PeekMessage(&msg, nullptr, NULL, NULL, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) {
+				requestExit();
+				break;
+			}
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
-		else {
-			// Process frame
-			tick();
+		if (exit_requested)
+			break;
 
-			// Process input
-			processInput();
+		// Process frame
+		tick();
 
-			// Quit if escape is pressed
-			if (input->isKeyDown(key_config.getKey("Exit"))) {
-				requestExit();
-			}
+		// Process input
+		processInput();
+
+		// Quit if escape is pressed
+		if (input->isKeyDown(key_config.getKey("Exit"))) {
+			requestExit();
+		}
+
+		// Collect the frame's profiler zones
+		Profiler::endFrame();
+
+		// Wait for the next frame. The target is re-read since the display config can change at runtime.
+		{
+			PROFILE_ZONE("Frame Pacing");
+			frame_pacer.setTargetFrameRate(rendering_mgr->getDisplayConfig().getTargetFrameRate());
+			frame_pacer.wait();
 		}
 	}
 
@@ -304,14 +332,24 @@ void Engine::run() {
 
 
 void Engine::tick() {
+	PROFILE_ZONE("Frame");
 
+	// The simulation is idle until beginSimulation(). The scene's frame update and the
+	// extraction of its render state happen here.
 	updateSystem();
 	updateRendering();
+	prepareFrame();
+
+	// Render the extracted state while the simulation runs the next steps. The frame shows
+	// the scene as of the previous frame's steps.
+	beginSimulation();
 	renderFrame();
+	waitForSimulation();
 }
 
 
 void Engine::updateSystem() {
+	PROFILE_ZONE("Update System");
 
 	system_monitor.tick();
 	timer.tick();
@@ -320,6 +358,7 @@ void Engine::updateSystem() {
 
 
 void Engine::updateRendering() {
+	PROFILE_ZONE("Update Rendering");
 
 	auto& swap_chain = rendering_mgr->getSwapChain();
 	const bool lost_mode = swap_chain.lostMode();
@@ -340,17 +379,61 @@ void Engine::updateRendering() {
 }
 
 
-void Engine::renderFrame() {
+void Engine::prepareFrame() {
+	PROFILE_ZONE("Prepare Frame");
 
 	// Begin a new frame
 	rendering_mgr->beginFrame();
 
-	// Draw a frame
-	if (scene) {
-		scene->tick(*this);
-		rendering_mgr->render(*scene, timer.deltaTime());
+	if (not scene)
+		return;
+
+	if (resize_event_pending) {
+		scene->getECS().send<events::WindowResizeEvent>(resize_event_size);
+		resize_event_pending = false;
 	}
 
+	// Interpolate between the last two steps, and extract the state to be rendered
+	scene->frameUpdate(fixed_timestep.getAlpha());
+	rendering_mgr->extract(*scene);
+}
+
+
+void Engine::beginSimulation() {
+
+	// Run the steps that fit in the time elapsed since the last frame
+	const u32 steps = fixed_timestep.advance(timer.deltaTime());
+
+	if (not scene or steps == 0)
+		return;
+
+	simulation = simulation_thread->enqueue([this, steps] {
+		PROFILE_ZONE("Update Simulation");
+		for (u32 i = 0; i < steps; ++i) {
+			scene->tick(*this, fixed_timestep.getTimestep());
+		}
+	});
+}
+
+
+void Engine::waitForSimulation() {
+	if (not simulation.valid())
+		return;
+
+	PROFILE_ZONE("Wait for Simulation");
+
+	// Rethrows an exception thrown by the scene
+	simulation.get();
+}
+
+
+void Engine::renderFrame() {
+	PROFILE_ZONE("Render Frame");
+
+	// Draw the extracted frame
+	if (scene)
+		rendering_mgr->render(timer.deltaTime());
+
 	// Present the frame
 	rendering_mgr->endFrame();
 }
@@ -1,9 +1,14 @@
 module;
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 
+#include "datatypes/vector_types.h"
+#include "thread/thread_pool.h"
+#include "time/fixed_timestep.h"
+#include "time/frame_pacer.h"
 #include "time/stopwatch.h"
 #include "key_config.h"
 
@@ -136,7 +141,8 @@ public:
 	// Member Functions - Scene
 	//----------------------------------------------------------------------------------
 
-	// Unload the active scene (if applicable) and apply a new scene
+	// Unload the active scene (if applicable) and apply a new scene. Must not be called from
+	// the scene's update(), which runs on the simulation thread.
 	void loadScene(std::unique_ptr<Scene>&& new_scene);
 
 	[[nodiscard]]
@@ -189,6 +195,17 @@ public:
 		return timer;
 	}
 
+	// The scene is simulated in fixed steps. The timestep's settings can be changed by the scene.
+	[[nodiscard]]
+	FixedTimestep& getFixedTimestep() {
+		return fixed_timestep;
+	}
+
+	[[nodiscard]]
+	const FixedTimestep& getFixedTimestep() const {
+		return fixed_timestep;
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - System Monitor
@@ -237,6 +254,9 @@ private:
 	void tick();
 	void updateSystem();
 	void updateRendering();
+	void prepareFrame();
+	void beginSimulation();
+	void waitForSimulation();
 	void renderFrame();
 	void processInput() const;
 
@@ -254,17 +274,28 @@ private:
 	std::unique_ptr<RenderingMgr> rendering_mgr;
 	std::unique_ptr<Scene> scene;
 
+	// The scene's steps run on the simulation thread while the previous frame is rendered
+	std::unique_ptr<ThreadPool> simulation_thread;
+	std::future<void> simulation;
+
 	// Input
 	std::unique_ptr<Input> input;
 	KeyConfig key_config;
 
 	// Utility
 	Stopwatch<> timer;
+	FixedTimestep fixed_timestep;
+	FramePacer frame_pacer;
 	SystemMonitor system_monitor;
 
 	bool exit_requested    = false;
 	bool resize_requested  = false;
 	bool toggle_fullscreen = false;
+
+	// The window can be resized while the simulation is running, so the scene's resize
+	// event is sent at the start of the next frame
+	bool  resize_event_pending = false;
+	u32_2 resize_event_size    = {};
 };
 
 
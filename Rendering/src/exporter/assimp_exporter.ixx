@@ -15,6 +15,7 @@ import :mesh;
 import :model_blueprint;
 import :texture;
 import :exporter.texture_exporter;
+import :vertex_compression;
 import :vertex_types;
 
 
@@ -87,7 +88,7 @@ void ReadMeshData(ID3D11Device& device,
 	// Index buffer
 	//----------------------------------------------------------------------------------
 	ib_desc.Usage = D3D11_USAGE_STAGING;
-	ib_desc.ByteWidth = sizeof(u32) * mesh.getIndexCount();
+	ib_desc.ByteWidth = mesh.getIndexSize() * mesh.getIndexCount();
 	ib_desc.BindFlags = 0;
 	ib_desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
 	ib_desc.MiscFlags = 0;
@@ -123,13 +124,21 @@ void ReadMeshData(ID3D11Device& device,
 		return;
 	}
 
-	// Copy indices
+	// Copy the indices of the full detail mesh. The lower levels of detail are generated again on import.
 	hr = device_context.Map(index_buffer.Get(), NULL, D3D11_MAP_READ, NULL, &mapped_resource);
 	if (SUCCEEDED(hr)) {
-		const auto* buffer_data = static_cast<u32*>(mapped_resource.pData);
-		for (size_t i = 0; i < mesh.getVertexCount(); ++i) {
-			indices.push_back(buffer_data[i]);
-		}
+		const auto& lod = mesh.getLOD(0);
+		const auto copy_indices = [&](const auto* buffer_data) {
+			for (size_t i = 0; i < lod.index_count; ++i) {
+				indices.push_back(static_cast<u32>(buffer_data[lod.index_offset + i]));
+			}
+		};
+
+		if (mesh.getIndexFormat() == DXGI_FORMAT_R16_UINT)
+			copy_indices(static_cast<const u16*>(mapped_resource.pData));
+		else
+			copy_indices(static_cast<const u32*>(mapped_resource.pData));
+
 		device_context.Unmap(index_buffer.Get(), NULL);
 	}
 	else {
@@ -164,8 +173,8 @@ void ProcessMesh(ID3D11Device& device,
 	//----------------------------------------------------------------------------------
 	// Create faces
 	//----------------------------------------------------------------------------------
-	ai_mesh.mFaces = new aiFace[vertices.size() / 3];
-	ai_mesh.mNumFaces = static_cast<unsigned int>(vertices.size() / 3);
+	ai_mesh.mFaces = new aiFace[indices.size() / 3];
+	ai_mesh.mNumFaces = static_cast<unsigned int>(indices.size() / 3);
 
 	for (size_t i = 0; i < (indices.size() / 3); ++i) {
 		ai_mesh.mFaces[i].mIndices = new unsigned int[3];
@@ -194,26 +203,38 @@ void ProcessMesh(ID3D11Device& device,
 	}
 
 	for (size_t i = 0; i < vertices.size(); ++i) {
-		ai_mesh.mVertices[i].x = vertices[i].position[0];
-		ai_mesh.mVertices[i].y = vertices[i].position[1];
-		ai_mesh.mVertices[i].z = vertices[i].position[2];
-
-		if constexpr (VertexT::hasColor()) {
-			ai_mesh.mColors[0][i].r = vertices[i].color[0];
-			ai_mesh.mColors[0][i].g = vertices[i].color[1];
-			ai_mesh.mColors[0][i].b = vertices[i].color[2];
-			ai_mesh.mColors[0][i].a = vertices[i].color[3];
+		// Quantized vertices are decoded back to full precision
+		if constexpr (VertexT::isQuantized()) {
+			const auto position = bp_mesh.getQuantization().decode(vertices[i].position);
+			const auto normal   = render::DecodeOctahedral(vertices[i].normal);
+			const auto texCoord = render::DecodeHalf2(vertices[i].texCoord);
+
+			ai_mesh.mVertices[i]         = aiVector3D{position[0], position[1], position[2]};
+			ai_mesh.mNormals[i]          = aiVector3D{normal[0], normal[1], normal[2]};
+			ai_mesh.mTextureCoords[0][i] = aiVector3D{texCoord[0], texCoord[1], 0.0f};
 		}
-
-		if constexpr (VertexT::hasNormal()) {
-			ai_mesh.mNormals[i].x = vertices[i].normal[0];
-			ai_mesh.mNormals[i].y = vertices[i].normal[1];
-			ai_mesh.mNormals[i].z = vertices[i].normal[2];
-		}
-
-		if constexpr (VertexT::hasTexture()) {
-			ai_mesh.mTextureCoords[0][i].x = vertices[i].texCoord[0];
-			ai_mesh.mTextureCoords[0][i].y = vertices[i].texCoord[1];
+		else {
+			ai_mesh.mVertices[i].x = vertices[i].position[0];
+			ai_mesh.mVertices[i].y = vertices[i].position[1];
+			ai_mesh.mVertices[i].z = vertices[i].position[2];
+
+			if constexpr (VertexT::hasColor()) {
+				ai_mesh.mColors[0][i].r = vertices[i].color[0];
+				ai_mesh.mColors[0][i].g = vertices[i].color[1];
+				ai_mesh.mColors[0][i].b = vertices[i].color[2];
+				ai_mesh.mColors[0][i].a = vertices[i].color[3];
+			}
+
+			if constexpr (VertexT::hasNormal()) {
+				ai_mesh.mNormals[i].x = vertices[i].normal[0];
+				ai_mesh.mNormals[i].y = vertices[i].normal[1];
+				ai_mesh.mNormals[i].z = vertices[i].normal[2];
+			}
+
+			if constexpr (VertexT::hasTexture()) {
+				ai_mesh.mTextureCoords[0][i].x = vertices[i].texCoord[0];
+				ai_mesh.mTextureCoords[0][i].y = vertices[i].texCoord[1];
+			}
 		}
 	}
 }
@@ -252,6 +273,9 @@ void ProcessMeshes(ID3D11Device& device,
 		if (vertex_type == typeid(VertexPositionNormalTexture)) {
 			ProcessMesh<VertexPositionNormalTexture>(device, device_context, *scene.mMeshes[i], bp.meshes[i], bp.mat_indices[i]);
 		}
+		if (vertex_type == typeid(VertexPositionNormalTextureCompact)) {
+			ProcessMesh<VertexPositionNormalTextureCompact>(device, device_context, *scene.mMeshes[i], bp.meshes[i], bp.mat_indices[i]);
+		}
 	}
 }
 
@@ -309,7 +333,7 @@ void ProcessMaterials(ID3D11Device& device,
 		scene.mMaterials[i] = new aiMaterial();
 
 		aiMaterial& ai_mat = *scene.mMaterials[i];
-		const render::Material& bp_mat = bp.materials[i];
+		const render::Material& bp_mat = *bp.materials[i];
 
 		//----------------------------------------------------------------------------------
 		// Set material name
@@ -4,6 +4,15 @@ module;
 #include "datatypes/vector_types.h"
 #include "io/io.h"
 
+#include <algorithm>
+#include <cstring>
+#include <execution>
+#include <functional>
+#include <future>
+#include <memory>
+#include <span>
+#include <type_traits>
+
 #include <assimp/scene.h>
 #include <assimp/pbrmaterial.h>
 #include <assimp/postprocess.h>
@@ -13,25 +22,46 @@ export module rendering:importer.assimp_importer;
 
 import log;
 import :resource_mgr;
+import :importer.texture_importer;
+import :material;
 import :material_factory;
 import :model_output;
+import :texture;
 
 using namespace render;
 
-ModelOutput AssimpLoad(ResourceMgr& resource_mgr,
-                       const fs::path& file,
+ModelOutput AssimpLoad(const fs::path& file,
                        bool flip_winding,
-                       bool flip_uv);
+                       bool flip_uv,
+                       const Material& default_material,
+                       const TextureLoader& load_texture);
 
 
 export namespace render::importer::detail {
+
+// Import a model without touching the device. Materials start as a copy of the default
+// material, and the textures they reference are requested through the texture loader.
+[[nodiscard]]
+ModelOutput AssimpImport(const fs::path& file,
+                         bool flip_winding,
+                         bool flip_uv,
+                         const Material& default_material,
+                         const TextureLoader& load_texture) {
+
+	return AssimpLoad(file, flip_winding, flip_uv, default_material, load_texture);
+}
+
 [[nodiscard]]
 ModelOutput AssimpImport(ResourceMgr& resource_mgr,
 	                     const fs::path& file,
 	                     bool flip_winding,
 	                     bool flip_uv) {
 
-	return AssimpLoad(resource_mgr, file, flip_winding, flip_uv);
+	const auto load_texture = [&resource_mgr](const fs::path& texture, TextureRole role, const std::shared_ptr<Texture>&) {
+		return resource_mgr.getOrCreate<Texture>(texture.wstring(), role);
+	};
+
+	return AssimpLoad(file, flip_winding, flip_uv, MaterialFactory::CreateDefaultMaterial(resource_mgr), load_texture);
 }
 } //namespace render::importer::detail
 
@@ -50,67 +80,86 @@ void ProcessNodes(const aiNode* node, ModelOutput::Node& out) {
 }
 
 
-void ProcessMeshes(const aiScene* scene, ModelOutput& model_out) {
+// Copy an array of Assimp vectors into a vector of the same layout
+template<typename T, typename AiT>
+void CopyArray(const AiT* in, u32 count, std::vector<T>& out) {
+	static_assert(sizeof(T) == sizeof(AiT) and std::is_trivially_copyable_v<T> and std::is_trivially_copyable_v<AiT>);
+	out.resize(count);
+	std::memcpy(out.data(), in, count * sizeof(T));
+}
 
-	for (u32 i = 0; i < scene->mNumMeshes; ++i) {
 
-		const auto* mesh = scene->mMeshes[i];
+void ProcessMesh(const aiMesh* mesh, ModelOutput::MeshData& out_mesh) {
 
-		ModelOutput::MeshData out_mesh;
-		out_mesh.name           = mesh->mName.C_Str();
-		out_mesh.material_index = mesh->mMaterialIndex;
+	out_mesh.name           = mesh->mName.C_Str();
+	out_mesh.material_index = mesh->mMaterialIndex;
 
-		//----------------------------------------------------------------------------------
-		// Process index data
-		//----------------------------------------------------------------------------------
-		if (mesh->HasFaces()) {
-			// The mesh should be triangulated when the model is imported
-			for (u32 j = 0; j < mesh->mNumFaces; ++j) {
-				out_mesh.indices.push_back(mesh->mFaces[j].mIndices[0]);
-				out_mesh.indices.push_back(mesh->mFaces[j].mIndices[1]);
-				out_mesh.indices.push_back(mesh->mFaces[j].mIndices[2]);
-			}
-		}
+	const u32 vertex_count = mesh->mNumVertices;
 
-		//----------------------------------------------------------------------------------
-		// Process vertex data
-		//----------------------------------------------------------------------------------
-		for (u32 j = 0; j < mesh->mNumVertices; ++j) {
-			if (mesh->HasPositions()) {
-				const auto& position = mesh->mVertices[j];
-				out_mesh.positions.emplace_back(position[0], position[1], position[2]);
-			}
-
-			if (mesh->HasNormals()) {
-				const auto& normal = mesh->mNormals[j];
-				out_mesh.normals.emplace_back(normal[0], normal[1], normal[2]);
-			}
-
-			if (mesh->HasTangentsAndBitangents()) {
-				const auto& tangent = mesh->mTangents[j];
-				const auto& bitangent = mesh->mBitangents[j];
-				out_mesh.tangents.emplace_back(tangent[0], tangent[1], tangent[2]);
-				out_mesh.bitangents.emplace_back(bitangent[0], bitangent[1], bitangent[2]);
-			}
-
-			//TODO: support multiple texture coords per vertex?k
-			if (mesh->HasTextureCoords(0)) {
-				const auto& tex = mesh->mTextureCoords[0][j];
-				out_mesh.texture_coords.emplace_back(tex[0], tex[1]/*, tex[2]*/);
-			}
-
-			//TODO: support vertex color sets?
-			if (mesh->HasVertexColors(0)) {
-				const auto& color = mesh->mColors[0][j];
-				out_mesh.colors.emplace_back(color.r, color.g, color.b);
-			}
+	//----------------------------------------------------------------------------------
+	// Process index data
+	//----------------------------------------------------------------------------------
+	if (mesh->HasFaces()) {
+		// The mesh should be triangulated when the model is imported
+		out_mesh.indices.resize(static_cast<size_t>(mesh->mNumFaces) * 3);
+
+		u32* indices = out_mesh.indices.data();
+		for (u32 j = 0; j < mesh->mNumFaces; ++j) {
+			const auto* face_indices = mesh->mFaces[j].mIndices;
+			indices[0] = face_indices[0];
+			indices[1] = face_indices[1];
+			indices[2] = face_indices[2];
+			indices += 3;
 		}
+	}
 
-		model_out.meshes.push_back(out_mesh);
+	//----------------------------------------------------------------------------------
+	// Process vertex data
+	//----------------------------------------------------------------------------------
+	if (mesh->HasPositions())
+		CopyArray(mesh->mVertices, vertex_count, out_mesh.positions);
+
+	if (mesh->HasNormals())
+		CopyArray(mesh->mNormals, vertex_count, out_mesh.normals);
+
+	if (mesh->HasTangentsAndBitangents()) {
+		CopyArray(mesh->mTangents, vertex_count, out_mesh.tangents);
+		CopyArray(mesh->mBitangents, vertex_count, out_mesh.bitangents);
+	}
+
+	//TODO: support multiple texture coords per vertex?
+	if (mesh->HasTextureCoords(0)) {
+		const auto* tex = mesh->mTextureCoords[0];
+		out_mesh.texture_coords.resize(vertex_count);
+		std::transform(tex, tex + vertex_count, out_mesh.texture_coords.begin(), [](const aiVector3D& uv) {
+			return f32_2{uv.x, uv.y};
+		});
+	}
+
+	//TODO: support vertex color sets?
+	if (mesh->HasVertexColors(0)) {
+		const auto* colors = mesh->mColors[0];
+		out_mesh.colors.resize(vertex_count);
+		std::transform(colors, colors + vertex_count, out_mesh.colors.begin(), [](const aiColor4D& color) {
+			return f32_3{color.r, color.g, color.b};
+		});
 	}
 }
 
 
+// Convert the meshes in parallel. Each mesh is written to its own slot of the output.
+void ProcessMeshes(const aiScene* scene, ModelOutput& model_out) {
+
+	model_out.meshes.resize(scene->mNumMeshes);
+
+	const auto meshes = std::span{scene->mMeshes, scene->mNumMeshes};
+	std::for_each(std::execution::par, meshes.begin(), meshes.end(), [&](aiMesh* const& mesh) {
+		const auto index = static_cast<size_t>(&mesh - meshes.data());
+		ProcessMesh(mesh, model_out.meshes[index]);
+	});
+}
+
+
 // Get a scalar value from a material
 template<typename T>
 bool GetScalar(const aiMaterial* mat, const char* key, unsigned int type, unsigned int idx, T& out) {
@@ -133,7 +182,7 @@ bool GetColor(const aiMaterial* mat, const char* key, unsigned int type, unsigne
 
 
 // Get a texture from a material
-bool GetMap(const aiMaterial* mat, aiTextureType type, unsigned int idx, ResourceMgr& resource_mgr, const fs::path& parent_path, std::shared_ptr<Texture>& out) {
+bool GetMap(const aiMaterial* mat, aiTextureType type, unsigned int idx, TextureRole role, const TextureLoader& load_texture, const fs::path& parent_path, std::shared_ptr<Texture>& out) {
 	aiString         path;
 	aiTextureMapping mapping;
 	unsigned int     uvindex;
@@ -150,7 +199,7 @@ bool GetMap(const aiMaterial* mat, aiTextureType type, unsigned int idx, Resourc
 			Logger::log(LogLevel::info, "Embedded texture found in model");
 		}
 		else {
-			out = resource_mgr.getOrCreate<Texture>(parent_path / path.C_Str());
+			out = load_texture(parent_path / path.C_Str(), role, out);
 		}
 		return true;
 	}
@@ -158,11 +207,11 @@ bool GetMap(const aiMaterial* mat, aiTextureType type, unsigned int idx, Resourc
 };
 
 
-void ProcessMaterials(const aiScene* scene, fs::path parent_path, ResourceMgr& resource_mgr, ModelOutput& model_out) {
+void ProcessMaterials(const aiScene* scene, fs::path parent_path, const Material& default_material, const TextureLoader& load_texture, ModelOutput& model_out) {
 
 	for (u32 i = 0; i < scene->mNumMaterials; ++i) {
 		// Create output material struct
-		Material out_mat = MaterialFactory::CreateDefaultMaterial(resource_mgr);
+		Material out_mat = default_material;
 
 		// Get current material
 		const auto* mat = scene->mMaterials[i];
@@ -194,38 +243,39 @@ void ProcessMaterials(const aiScene* scene, fs::path parent_path, ResourceMgr& r
 
 		// Base color map
 		{
-			const bool base_color = GetMap(mat, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_BASE_COLOR_TEXTURE, resource_mgr, parent_path, out_mat.maps.base_color);
+			const bool base_color = GetMap(mat, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_BASE_COLOR_TEXTURE, TextureRole::BaseColor, load_texture, parent_path, out_mat.maps.base_color);
 
 			// Fallback to basic diffuse map
 			if (!base_color)
-				GetMap(mat, aiTextureType_DIFFUSE, 0, resource_mgr, parent_path, out_mat.maps.base_color);
+				GetMap(mat, aiTextureType_DIFFUSE, 0, TextureRole::BaseColor, load_texture, parent_path, out_mat.maps.base_color);
 		}
 
 		// Normal map
 		{
-			const bool normal = GetMap(mat, aiTextureType_NORMALS, 0, resource_mgr, parent_path, out_mat.maps.normal);
+			const bool normal = GetMap(mat, aiTextureType_NORMALS, 0, TextureRole::Normal, load_texture, parent_path, out_mat.maps.normal);
 
 			//Sometimes normal map will be stored in height maps section
 			if (!normal)
-				GetMap(mat, aiTextureType_HEIGHT, 0, resource_mgr, parent_path, out_mat.maps.normal);
+				GetMap(mat, aiTextureType_HEIGHT, 0, TextureRole::Normal, load_texture, parent_path, out_mat.maps.normal);
 			
 		}
 
 		// Emissive map
-		GetMap(mat, aiTextureType_EMISSIVE, 0, resource_mgr, parent_path, out_mat.maps.emissive);
+		GetMap(mat, aiTextureType_EMISSIVE, 0, TextureRole::Emissive, load_texture, parent_path, out_mat.maps.emissive);
 
 		// Metallic/roughness map
-		GetMap(mat, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, resource_mgr, parent_path, out_mat.maps.material_params);
+		GetMap(mat, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, TextureRole::MaterialParams, load_texture, parent_path, out_mat.maps.material_params);
 
 		model_out.materials.push_back(out_mat);
 	}
 }
 
 
-ModelOutput AssimpLoad(ResourceMgr& resource_mgr,
-                       const fs::path& file,
+ModelOutput AssimpLoad(const fs::path& file,
                        bool flip_winding,
-                       bool flip_uv) {
+                       bool flip_uv,
+                       const Material& default_material,
+                       const TextureLoader& load_texture) {
 
 	Assimp::Importer importer;
 
@@ -264,9 +314,14 @@ ModelOutput AssimpLoad(ResourceMgr& resource_mgr,
 	model_out.name = file.filename().string();
 	model_out.file = file;
 
+	// Convert the meshes on other threads while the materials are processed on this one, so
+	// the texture loader is always called from the importing thread
+	auto meshes_done = std::async(std::launch::async, [&] { ProcessMeshes(scene, model_out); });
+
 	ProcessNodes(scene->mRootNode, model_out.root);
-	ProcessMeshes(scene, model_out);
-	ProcessMaterials(scene, file.parent_path(), resource_mgr, model_out);
+	ProcessMaterials(scene, file.parent_path(), default_material, load_texture, model_out);
+
+	meshes_done.get();
 
 	return model_out;
 }
@@ -0,0 +1,112 @@
+module;
+
+#include <algorithm>
+#include <cwctype>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "time/stopwatch.h"
+
+export module rendering:importer.import_benchmark;
+
+import log;
+import :importer.assimp_importer;
+import :material;
+import :model_output;
+import :texture;
+
+
+export namespace render::importer {
+
+struct ImportBenchmarkResult {
+	[[nodiscard]]
+	f64 getVerticesPerSecond() const noexcept {
+		return (seconds > 0.0) ? (static_cast<f64>(vertex_count) / seconds) : 0.0;
+	}
+
+	u32 file_count   = 0;
+	u32 failed_count = 0;
+	u64 vertex_count = 0;
+	u64 index_count  = 0;
+	f64 seconds      = 0.0;
+};
+
+// Import every model file (glTF, OBJ, FBX) in a directory through Assimp, and report the
+// import throughput. The model cache is bypassed and no textures are loaded, so only file
+// parsing and mesh conversion are measured. Each file is imported the given number of times.
+[[nodiscard]]
+ImportBenchmarkResult BenchmarkModelImport(const fs::path& corpus, u32 iterations = 1) {
+	iterations = std::max(iterations, 1u);
+
+	static constexpr const wchar_t* extensions[] = {L".gltf", L".glb", L".obj", L".fbx"};
+
+	// Gather the model files
+	std::vector<fs::path> files;
+	for (const auto& entry : fs::recursive_directory_iterator(corpus)) {
+		if (not entry.is_regular_file())
+			continue;
+
+		auto extension = entry.path().extension().wstring();
+		std::ranges::transform(extension, extension.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+
+		if (std::ranges::find(extensions, extension) != std::ranges::end(extensions))
+			files.push_back(entry.path());
+	}
+	std::ranges::sort(files);
+
+	const Material default_material;
+	const auto no_textures = [](const fs::path&, const std::shared_ptr<Texture>& placeholder) {
+		return placeholder;
+	};
+
+	ImportBenchmarkResult result;
+
+	for (const auto& file : files) {
+		Stopwatch<> stopwatch;
+		u64 vertices = 0;
+		u64 indices  = 0;
+
+		for (u32 i = 0; i < iterations; ++i) {
+			const auto out = detail::AssimpImport(file, false, false, default_material, no_textures);
+			for (const auto& mesh : out.meshes) {
+				vertices += mesh.positions.size();
+				indices  += mesh.indices.size();
+			}
+		}
+
+		stopwatch.tick();
+		const f64 seconds = stopwatch.totalTime().count();
+
+		++result.file_count;
+		if (vertices == 0) {
+			++result.failed_count;
+			continue;
+		}
+
+		result.vertex_count += vertices;
+		result.index_count  += indices;
+		result.seconds      += seconds;
+
+		Logger::log(LogLevel::info,
+		            "Import benchmark: {} - {} vertices in {:.3f}ms ({:.0f} vertices/s)",
+		            file.filename().string(),
+		            vertices / iterations,
+		            (seconds * 1000.0) / iterations,
+		            static_cast<f64>(vertices) / seconds);
+	}
+
+	Logger::log(LogLevel::info,
+	            "Import benchmark: {} files ({} failed), {} vertices in {:.3f}s ({:.0f} vertices/s)",
+	            result.file_count,
+	            result.failed_count,
+	            result.vertex_count,
+	            result.seconds,
+	            result.getVerticesPerSecond());
+
+	return result;
+}
+
+} //namespace render::importer
@@ -0,0 +1,471 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+module rendering;
+
+import :importer.mesh_optimizer;
+import :model_output;
+
+
+namespace {
+
+//----------------------------------------------------------------------------------
+// Vertex cache optimization
+//----------------------------------------------------------------------------------
+
+// The size of the cache modelled by the vertex scores
+constexpr u32 max_cache_size = 32;
+
+constexpr f32 cache_decay_power   = 1.5f;
+constexpr f32 last_tri_score      = 0.75f;
+constexpr f32 valence_boost_scale = 2.0f;
+constexpr f32 valence_boost_power = 0.5f;
+
+constexpr u32 invalid_index = std::numeric_limits<u32>::max();
+
+
+[[nodiscard]]
+f32 VertexScore(i32 cache_position, u32 live_triangles) {
+	// The vertex isn't used by any remaining triangles
+	if (live_triangles == 0)
+		return -1.0f;
+
+	f32 score = 0.0f;
+
+	// The three vertices of the last triangle get a fixed score, so the next triangle doesn't
+	// depend on the order they were added to the cache
+	if (cache_position >= 0) {
+		if (cache_position < 3) {
+			score = last_tri_score;
+		}
+		else {
+			constexpr f32 scale = 1.0f / static_cast<f32>(max_cache_size - 3);
+			score = std::pow(1.0f - (static_cast<f32>(cache_position - 3) * scale), cache_decay_power);
+		}
+	}
+
+	// Boost vertices with few remaining triangles, so lone triangles aren't left behind
+	score += valence_boost_scale * std::pow(static_cast<f32>(live_triangles), -valence_boost_power);
+
+	return score;
+}
+
+
+//----------------------------------------------------------------------------------
+// Vertex cache simulation
+//----------------------------------------------------------------------------------
+
+// A FIFO cache simulated with timestamps. A vertex is in the cache if it was added within
+// the last cache_size misses.
+class FIFOCache {
+public:
+	FIFOCache(u32 vertex_count, u32 cache_size)
+		: timestamps(vertex_count, 0)
+		, cache_size(cache_size)
+		, time(cache_size) {
+	}
+
+	// Returns true if the vertex missed the cache
+	bool access(u32 vertex) {
+		if ((time - timestamps[vertex]) < cache_size)
+			return false;
+
+		// Stamped after advancing, so the vertex stays cached for cache_size misses including
+		// its own
+		timestamps[vertex] = ++time;
+		return true;
+	}
+
+	void reset() {
+		// Advancing the time by the cache size evicts every vertex
+		time += cache_size;
+	}
+
+private:
+	std::vector<u32> timestamps;
+	u32 cache_size;
+	u32 time;
+};
+
+
+// Count the cache misses of a triangle
+[[nodiscard]]
+u32 AccessTriangle(FIFOCache& cache, const u32* triangle) {
+	return static_cast<u32>(cache.access(triangle[0])) + static_cast<u32>(cache.access(triangle[1])) + static_cast<u32>(cache.access(triangle[2]));
+}
+
+
+//----------------------------------------------------------------------------------
+// Overdraw optimization
+//----------------------------------------------------------------------------------
+
+// The cache used to find cluster boundaries
+constexpr u32 cluster_cache_size = 16;
+
+// Split the triangles into clusters. A hard boundary starts where a triangle misses the
+// cache on every vertex. Hard clusters are split again where the ACMR of the triangles since
+// the last split is within the threshold of the cluster's ACMR.
+[[nodiscard]]
+std::vector<u32> FindClusters(std::span<const u32> indices, u32 vertex_count, f32 threshold) {
+	const u32 tri_count = static_cast<u32>(indices.size() / 3);
+
+	// Hard boundaries
+	std::vector<u32> hard_clusters;
+	{
+		FIFOCache cache{vertex_count, cluster_cache_size};
+		for (u32 i = 0; i < tri_count; ++i) {
+			if (AccessTriangle(cache, &indices[i * 3]) == 3)
+				hard_clusters.push_back(i);
+		}
+	}
+
+	// Soft boundaries
+	std::vector<u32> clusters;
+	for (size_t c = 0; c < hard_clusters.size(); ++c) {
+		const u32 start = hard_clusters[c];
+		const u32 end   = (c + 1 < hard_clusters.size()) ? hard_clusters[c + 1] : tri_count;
+
+		FIFOCache cache{vertex_count, cluster_cache_size};
+
+		u32 cluster_misses = 0;
+		for (u32 i = start; i < end; ++i) {
+			cluster_misses += AccessTriangle(cache, &indices[i * 3]);
+		}
+		const f32 cluster_acmr = static_cast<f32>(cluster_misses) / static_cast<f32>(end - start);
+
+		cache.reset();
+		clusters.push_back(start);
+
+		u32 split_start = start;
+		u32 misses      = 0;
+		for (u32 i = start; i < end; ++i) {
+			misses += AccessTriangle(cache, &indices[i * 3]);
+
+			const f32 acmr = static_cast<f32>(misses) / static_cast<f32>(i + 1 - split_start);
+			if ((i + 1 < end) and (acmr <= cluster_acmr * threshold)) {
+				split_start = i + 1;
+				misses      = 0;
+				clusters.push_back(split_start);
+				cache.reset();
+			}
+		}
+	}
+
+	return clusters;
+}
+
+} //namespace
+
+
+namespace render::importer {
+
+VertexCacheStats AnalyzeVertexCache(std::span<const u32> indices, u32 vertex_count, u32 cache_size, VertexCacheType type) {
+	VertexCacheStats stats;
+	if ((indices.size() < 3) or (vertex_count == 0))
+		return stats;
+
+	if (type == VertexCacheType::fifo) {
+		FIFOCache cache{vertex_count, cache_size};
+		for (const u32 index : indices) {
+			stats.transformed_vertices += static_cast<u32>(cache.access(index));
+		}
+	}
+	else {
+		// The most recently used vertex is at the front of the cache
+		std::vector<u32> cache;
+		cache.reserve(cache_size + 1);
+
+		for (const u32 index : indices) {
+			const auto it = std::ranges::find(cache, index);
+			if (it == cache.end()) {
+				++stats.transformed_vertices;
+				cache.insert(cache.begin(), index);
+				if (cache.size() > cache_size)
+					cache.pop_back();
+			}
+			else {
+				std::rotate(cache.begin(), it, it + 1);
+			}
+		}
+	}
+
+	const auto misses = static_cast<f32>(stats.transformed_vertices);
+	stats.acmr     = misses / static_cast<f32>(indices.size() / 3);
+	stats.atvr     = misses / static_cast<f32>(vertex_count);
+	stats.hit_rate = 1.0f - (misses / static_cast<f32>(indices.size()));
+	return stats;
+}
+
+
+void OptimizeVertexCache(std::span<u32> indices, u32 vertex_count) {
+	const u32 tri_count = static_cast<u32>(indices.size() / 3);
+	if ((tri_count == 0) or (vertex_count == 0))
+		return;
+
+	//----------------------------------------------------------------------------------
+	// Build the vertex-triangle adjacency
+	//----------------------------------------------------------------------------------
+	std::vector<u32> live_triangles(vertex_count, 0);
+	for (const u32 index : indices) {
+		++live_triangles[index];
+	}
+
+	std::vector<u32> adjacency_offsets(vertex_count + 1, 0);
+	std::inclusive_scan(live_triangles.begin(), live_triangles.end(), adjacency_offsets.begin() + 1);
+
+	std::vector<u32> adjacency(indices.size());
+	{
+		std::vector<u32> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (u32 i = 0; i < tri_count * 3; ++i) {
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	// Initial scores
+	//----------------------------------------------------------------------------------
+	std::vector<i32> cache_positions(vertex_count, -1);
+	std::vector<f32> vertex_scores(vertex_count);
+	for (u32 v = 0; v < vertex_count; ++v) {
+		vertex_scores[v] = VertexScore(-1, live_triangles[v]);
+	}
+
+	std::vector<f32> triangle_scores(tri_count);
+	std::vector<bool> emitted(tri_count, false);
+	for (u32 t = 0; t < tri_count; ++t) {
+		const u32* tri = &indices[t * 3];
+		triangle_scores[t] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+	}
+
+	//----------------------------------------------------------------------------------
+	// Emit triangles
+	//----------------------------------------------------------------------------------
+	std::vector<u32> output;
+	output.reserve(indices.size());
+
+	// The cache holds up to 3 extra vertices while a triangle is being added
+	std::array<u32, max_cache_size + 3> cache;
+	std::array<u32, max_cache_size + 3> new_cache;
+	u32 cache_count = 0;
+
+	u32 best_triangle = static_cast<u32>(std::ranges::max_element(triangle_scores) - triangle_scores.begin());
+	u32 input_cursor  = 0;
+
+	for (u32 emitted_count = 0; emitted_count < tri_count; ++emitted_count) {
+
+		// If no triangle in the cache has a score, continue from the next unemitted triangle
+		if (best_triangle == invalid_index) {
+			while (emitted[input_cursor]) {
+				++input_cursor;
+			}
+			best_triangle = input_cursor;
+		}
+
+		const u32 tri[3] = {indices[best_triangle * 3], indices[best_triangle * 3 + 1], indices[best_triangle * 3 + 2]};
+		output.insert(output.end(), std::begin(tri), std::end(tri));
+		emitted[best_triangle] = true;
+
+		// Remove the triangle from its vertices' adjacency lists
+		for (const u32 v : tri) {
+			const auto begin = adjacency.begin() + adjacency_offsets[v];
+			const auto end   = begin + live_triangles[v];
+			const auto it    = std::find(begin, end, best_triangle);
+			std::iter_swap(it, end - 1);
+			--live_triangles[v];
+		}
+
+		// Put the triangle's vertices at the front of the cache
+		u32 new_count = 0;
+		for (const u32 v : tri) {
+			new_cache[new_count++] = v;
+		}
+		for (u32 i = 0; i < cache_count; ++i) {
+			const u32 v = cache[i];
+			if ((v != tri[0]) and (v != tri[1]) and (v != tri[2]))
+				new_cache[new_count++] = v;
+		}
+
+		// Vertices pushed out of the cache lose their cache score
+		for (u32 i = max_cache_size; i < new_count; ++i) {
+			const u32 v = new_cache[i];
+			cache_positions[v] = -1;
+			vertex_scores[v]   = VertexScore(-1, live_triangles[v]);
+		}
+
+		cache_count = std::min(new_count, max_cache_size);
+		std::copy_n(new_cache.begin(), cache_count, cache.begin());
+
+		// Update the scores of the vertices in the cache, and their triangles
+		for (u32 i = 0; i < cache_count; ++i) {
+			const u32 v = cache[i];
+			cache_positions[v] = static_cast<i32>(i);
+			vertex_scores[v]   = VertexScore(static_cast<i32>(i), live_triangles[v]);
+		}
+
+		best_triangle = invalid_index;
+		f32 best_score = -1.0f;
+
+		for (u32 i = 0; i < cache_count; ++i) {
+			const u32 v = cache[i];
+			const u32 offset = adjacency_offsets[v];
+
+			for (u32 j = 0; j < live_triangles[v]; ++j) {
+				const u32  t = adjacency[offset + j];
+				const u32* t_indices = &indices[t * 3];
+
+				const f32 score = vertex_scores[t_indices[0]] + vertex_scores[t_indices[1]] + vertex_scores[t_indices[2]];
+				triangle_scores[t] = score;
+
+				if (score > best_score) {
+					best_score    = score;
+					best_triangle = t;
+				}
+			}
+		}
+	}
+
+	std::ranges::copy(output, indices.begin());
+}
+
+
+void OptimizeOverdraw(std::span<u32> indices, std::span<const f32_3> positions, f32 threshold) {
+	const u32 tri_count = static_cast<u32>(indices.size() / 3);
+	if ((tri_count == 0) or positions.empty())
+		return;
+
+	const auto clusters = FindClusters(indices, static_cast<u32>(positions.size()), threshold);
+	if (clusters.size() <= 1)
+		return;
+
+	// The area weighted centroid of the mesh
+	f32_3 mesh_centroid = {0.0f, 0.0f, 0.0f};
+	f32   mesh_area     = 0.0f;
+
+	struct Cluster {
+		u32   start;
+		u32   end;
+		f32_3 centroid;
+		f32_3 normal;
+		f32   area;
+		f32   sort_key;
+	};
+
+	std::vector<Cluster> cluster_data(clusters.size());
+
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		auto& cluster = cluster_data[c];
+		cluster.start    = clusters[c];
+		cluster.end      = (c + 1 < clusters.size()) ? clusters[c + 1] : tri_count;
+		cluster.centroid = {0.0f, 0.0f, 0.0f};
+		cluster.normal   = {0.0f, 0.0f, 0.0f};
+		cluster.area     = 0.0f;
+
+		for (u32 t = cluster.start; t < cluster.end; ++t) {
+			const auto& p0 = positions[indices[t * 3]];
+			const auto& p1 = positions[indices[t * 3 + 1]];
+			const auto& p2 = positions[indices[t * 3 + 2]];
+
+			const f32_3 e1 = p1 - p0;
+			const f32_3 e2 = p2 - p0;
+			const f32_3 n  = {(e1[1] * e2[2]) - (e1[2] * e2[1]), (e1[2] * e2[0]) - (e1[0] * e2[2]), (e1[0] * e2[1]) - (e1[1] * e2[0])};
+			const f32   area = std::sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+
+			// The cross product's length is twice the triangle's area, which cancels out below
+			cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+			cluster.normal   += n;
+			cluster.area     += area;
+		}
+
+		mesh_centroid += cluster.centroid;
+		mesh_area     += cluster.area;
+
+		if (cluster.area > 0.0f)
+			cluster.centroid /= cluster.area;
+
+		const f32 length = std::sqrt((cluster.normal[0] * cluster.normal[0]) + (cluster.normal[1] * cluster.normal[1]) + (cluster.normal[2] * cluster.normal[2]));
+		if (length > 0.0f)
+			cluster.normal /= length;
+	}
+
+	if (mesh_area > 0.0f)
+		mesh_centroid /= mesh_area;
+
+	// Clusters that face away from the center of the mesh are likely to occlude other clusters
+	for (auto& cluster : cluster_data) {
+		const f32_3 offset = cluster.centroid - mesh_centroid;
+		cluster.sort_key = (offset[0] * cluster.normal[0]) + (offset[1] * cluster.normal[1]) + (offset[2] * cluster.normal[2]);
+	}
+
+	std::ranges::stable_sort(cluster_data, std::greater{}, &Cluster::sort_key);
+
+	std::vector<u32> output;
+	output.reserve(indices.size());
+	for (const auto& cluster : cluster_data) {
+		output.insert(output.end(), indices.begin() + (cluster.start * 3), indices.begin() + (cluster.end * 3));
+	}
+
+	std::ranges::copy(output, indices.begin());
+}
+
+
+void OptimizeVertexFetch(ModelOutput::MeshData& mesh) {
+	const size_t vertex_count = mesh.positions.size();
+	if (vertex_count == 0)
+		return;
+
+	// Map each vertex to the order it's first referenced in
+	std::vector<u32> remap(vertex_count, invalid_index);
+	u32 next_vertex = 0;
+
+	for (u32& index : mesh.indices) {
+		if (remap[index] == invalid_index)
+			remap[index] = next_vertex++;
+		index = remap[index];
+	}
+
+	const auto reorder = [&](auto& attribute) {
+		if (attribute.size() != vertex_count)
+			return;
+
+		std::remove_cvref_t<decltype(attribute)> out(next_vertex);
+		for (size_t v = 0; v < vertex_count; ++v) {
+			if (remap[v] != invalid_index)
+				out[remap[v]] = attribute[v];
+		}
+		attribute = std::move(out);
+	};
+
+	reorder(mesh.positions);
+	reorder(mesh.normals);
+	reorder(mesh.tangents);
+	reorder(mesh.bitangents);
+	reorder(mesh.texture_coords);
+	reorder(mesh.colors);
+}
+
+
+std::pair<VertexCacheStats, VertexCacheStats> OptimizeMesh(ModelOutput::MeshData& mesh) {
+	const u32 vertex_count = static_cast<u32>(mesh.positions.size());
+	const auto before = AnalyzeVertexCache(mesh.indices, vertex_count);
+
+	OptimizeVertexCache(mesh.indices, vertex_count);
+	OptimizeOverdraw(mesh.indices, mesh.positions);
+	OptimizeVertexFetch(mesh);
+
+	const auto after = AnalyzeVertexCache(mesh.indices, static_cast<u32>(mesh.positions.size()));
+	return {before, after};
+}
+
+} //namespace render::importer
@@ -0,0 +1,66 @@
+module;
+
+#include <span>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+export module rendering:importer.mesh_optimizer;
+
+import :model_output;
+
+
+//----------------------------------------------------------------------------------
+// Mesh Optimizer
+//----------------------------------------------------------------------------------
+//
+// Reorders the triangles and vertices of a mesh for faster rendering:
+//   - Vertex cache: triangles are reordered to reuse recently transformed vertices
+//     (Tom Forsyth's linear-speed vertex cache optimization).
+//   - Overdraw: the cache-optimized triangles are split into clusters, which are
+//     sorted so outward-facing clusters are drawn first (after Sander et al.).
+//   - Vertex fetch: vertices are reordered in the order they're first referenced.
+//
+// The result can be measured without a GPU with AnalyzeVertexCache, which simulates
+// a post-transform vertex cache.
+//
+//----------------------------------------------------------------------------------
+export namespace render::importer {
+
+enum class VertexCacheType {
+	fifo,
+	lru,
+};
+
+struct VertexCacheStats {
+	u32 transformed_vertices = 0;
+	f32 acmr     = 0.0f; //average cache miss ratio: vertices transformed per triangle (0.5 - 3.0)
+	f32 atvr     = 0.0f; //average transform to vertex ratio: vertices transformed per vertex (>= 1.0)
+	f32 hit_rate = 0.0f; //the fraction of indices that hit the cache
+};
+
+// Simulate a post-transform vertex cache on a triangle list
+[[nodiscard]]
+VertexCacheStats AnalyzeVertexCache(std::span<const u32> indices,
+                                    u32 vertex_count,
+                                    u32 cache_size = 16,
+                                    VertexCacheType type = VertexCacheType::fifo);
+
+// Reorder triangles to reduce the number of vertex cache misses
+void OptimizeVertexCache(std::span<u32> indices, u32 vertex_count);
+
+// Reorder clusters of cache-optimized triangles to reduce overdraw. The indices should
+// already be optimized with OptimizeVertexCache. A cluster may be split where the ACMR of
+// its first part is at most threshold times the ACMR of the whole cluster, so a higher
+// threshold trades vertex cache efficiency for more freedom to reduce overdraw.
+void OptimizeOverdraw(std::span<u32> indices, std::span<const f32_3> positions, f32 threshold = 1.05f);
+
+// Reorder a mesh's vertices in the order they're first referenced by its indices.
+// Vertices that aren't referenced are removed.
+void OptimizeVertexFetch(ModelOutput::MeshData& mesh);
+
+// Run every optimization on a mesh. Returns the vertex cache stats before and after.
+std::pair<VertexCacheStats, VertexCacheStats> OptimizeMesh(ModelOutput::MeshData& mesh);
+
+} //namespace render::importer
@@ -0,0 +1,406 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+module rendering;
+
+import math.geometry;
+import :importer.mesh_optimizer;
+import :importer.mesh_simplifier;
+import :mesh_lod;
+import :model_output;
+
+
+namespace {
+
+using Vec3 = std::array<f64, 3>;
+
+[[nodiscard]]
+Vec3 Sub(const Vec3& a, const Vec3& b) noexcept {
+	return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+[[nodiscard]]
+Vec3 Cross(const Vec3& a, const Vec3& b) noexcept {
+	return {(a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0])};
+}
+
+[[nodiscard]]
+f64 Dot(const Vec3& a, const Vec3& b) noexcept {
+	return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+
+//----------------------------------------------------------------------------------
+// Quadric
+//----------------------------------------------------------------------------------
+
+// The sum of the squared distances to a set of weighted planes: Q(v) = v'Av + 2b'v + c
+struct Quadric {
+	void addPlane(const Vec3& n, f64 d, f64 weight) noexcept {
+		a00 += weight * n[0] * n[0];
+		a01 += weight * n[0] * n[1];
+		a02 += weight * n[0] * n[2];
+		a11 += weight * n[1] * n[1];
+		a12 += weight * n[1] * n[2];
+		a22 += weight * n[2] * n[2];
+		b0  += weight * n[0] * d;
+		b1  += weight * n[1] * d;
+		b2  += weight * n[2] * d;
+		c   += weight * d * d;
+		w   += weight;
+	}
+
+	Quadric& operator+=(const Quadric& q) noexcept {
+		a00 += q.a00; a01 += q.a01; a02 += q.a02;
+		a11 += q.a11; a12 += q.a12; a22 += q.a22;
+		b0  += q.b0;  b1  += q.b1;  b2  += q.b2;
+		c   += q.c;
+		w   += q.w;
+		return *this;
+	}
+
+	// The weighted mean squared distance of a point to the planes
+	[[nodiscard]]
+	f64 error(const Vec3& v) const noexcept {
+		const f64 rx = (a00 * v[0]) + (a01 * v[1]) + (a02 * v[2]);
+		const f64 ry = (a01 * v[0]) + (a11 * v[1]) + (a12 * v[2]);
+		const f64 rz = (a02 * v[0]) + (a12 * v[1]) + (a22 * v[2]);
+		const f64 e  = (v[0] * rx) + (v[1] * ry) + (v[2] * rz) + (2.0 * ((b0 * v[0]) + (b1 * v[1]) + (b2 * v[2]))) + c;
+		return (w > 0.0) ? std::max(e / w, 0.0) : 0.0;
+	}
+
+	f64 a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+	f64 b0 = 0.0, b1 = 0.0, b2 = 0.0;
+	f64 c = 0.0;
+	f64 w = 0.0;
+};
+
+
+//----------------------------------------------------------------------------------
+// Topology
+//----------------------------------------------------------------------------------
+
+// Mark the vertices of every edge without a matching edge in the opposite direction. These
+// are the mesh's borders, and the seams where a vertex was split by its attributes.
+[[nodiscard]]
+std::vector<bool> FindLockedVertices(std::span<const u32> indices, size_t vertex_count) {
+	const auto make_key = [](u32 a, u32 b) {
+		return (static_cast<u64>(a) << 32) | b;
+	};
+
+	std::vector<u64> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (u32 e = 0; e < 3; ++e)
+			edges.push_back(make_key(indices[i + e], indices[i + ((e + 1) % 3)]));
+	}
+	std::ranges::sort(edges);
+
+	std::vector<bool> locked(vertex_count, false);
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (u32 e = 0; e < 3; ++e) {
+			const u32 a = indices[i + e];
+			const u32 b = indices[i + ((e + 1) % 3)];
+			if (not std::ranges::binary_search(edges, make_key(b, a))) {
+				locked[a] = true;
+				locked[b] = true;
+			}
+		}
+	}
+
+	return locked;
+}
+
+// The triangles adjacent to each vertex, in compressed rows
+struct Adjacency {
+	Adjacency(std::span<const u32> indices, size_t vertex_count)
+		: offsets(vertex_count + 1, 0)
+		, triangles(indices.size()) {
+
+		for (const u32 index : indices)
+			++offsets[index + 1];
+		for (size_t v = 0; v < vertex_count; ++v)
+			offsets[v + 1] += offsets[v];
+
+		std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+			triangles[fill[indices[i]]++] = static_cast<u32>(i / 3);
+	}
+
+	[[nodiscard]]
+	std::span<const u32> operator[](u32 vertex) const noexcept {
+		return std::span{triangles}.subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+	}
+
+	std::vector<u32> offsets;
+	std::vector<u32> triangles;
+};
+
+
+//----------------------------------------------------------------------------------
+// Collapse
+//----------------------------------------------------------------------------------
+
+struct Collapse {
+	u32 src;
+	u32 dst;
+	f64 error;
+};
+
+// Check that moving src onto dst doesn't flip any of the triangles around src
+[[nodiscard]]
+bool FlipsTriangles(std::span<const u32> indices,
+                    std::span<const Vec3> positions,
+                    const Adjacency& adjacency,
+                    u32 src,
+                    u32 dst) {
+
+	for (const u32 triangle : adjacency[src]) {
+		const u32* tri = &indices[triangle * 3];
+
+		// Triangles on the collapsed edge are removed
+		if ((tri[0] == dst) or (tri[1] == dst) or (tri[2] == dst))
+			continue;
+
+		const Vec3& p0 = positions[tri[0]];
+		const Vec3& p1 = positions[tri[1]];
+		const Vec3& p2 = positions[tri[2]];
+		const Vec3 before = Cross(Sub(p1, p0), Sub(p2, p0));
+
+		const Vec3& q0 = positions[(tri[0] == src) ? dst : tri[0]];
+		const Vec3& q1 = positions[(tri[1] == src) ? dst : tri[1]];
+		const Vec3& q2 = positions[(tri[2] == src) ? dst : tri[2]];
+		const Vec3 after = Cross(Sub(q1, q0), Sub(q2, q0));
+
+		if (Dot(before, after) <= 0.0)
+			return true;
+	}
+
+	return false;
+}
+
+} //namespace
+
+
+namespace render::importer {
+
+std::vector<u32> SimplifyMesh(std::span<const u32> indices,
+                              std::span<const f32_3> positions,
+                              size_t target_index_count,
+                              f32 target_error,
+                              f32* result_error) {
+
+	std::vector<u32> result(indices.begin(), indices.end());
+	if (result_error)
+		*result_error = 0.0f;
+
+	if ((indices.size() < 3) or (indices.size() <= target_index_count))
+		return result;
+
+	const size_t vertex_count = positions.size();
+
+	// Normalize the positions to a unit cube, so the error threshold doesn't depend on the mesh's scale
+	Vec3 min{std::numeric_limits<f64>::max(), std::numeric_limits<f64>::max(), std::numeric_limits<f64>::max()};
+	Vec3 max{std::numeric_limits<f64>::lowest(), std::numeric_limits<f64>::lowest(), std::numeric_limits<f64>::lowest()};
+	for (const auto& p : positions) {
+		for (u32 i = 0; i < 3; ++i) {
+			min[i] = std::min(min[i], static_cast<f64>(p[i]));
+			max[i] = std::max(max[i], static_cast<f64>(p[i]));
+		}
+	}
+	const f64 extent = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2]});
+	const f64 scale  = (extent > 0.0) ? (1.0 / extent) : 1.0;
+
+	std::vector<Vec3> points(vertex_count);
+	for (size_t v = 0; v < vertex_count; ++v) {
+		for (u32 i = 0; i < 3; ++i)
+			points[v][i] = (static_cast<f64>(positions[v][i]) - min[i]) * scale;
+	}
+
+	const f64 max_error = static_cast<f64>(target_error) * scale;
+	const auto locked   = FindLockedVertices(indices, vertex_count);
+
+	// Accumulate the area-weighted plane of each triangle into its vertices
+	std::vector<Quadric> quadrics(vertex_count);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		const Vec3& p0 = points[result[i]];
+		const Vec3& p1 = points[result[i + 1]];
+		const Vec3& p2 = points[result[i + 2]];
+
+		Vec3 normal = Cross(Sub(p1, p0), Sub(p2, p0));
+		const f64 length = std::sqrt(Dot(normal, normal));
+		if (length == 0.0)
+			continue;
+
+		normal = {normal[0] / length, normal[1] / length, normal[2] / length};
+		const f64 d    = -Dot(normal, p0);
+		const f64 area = length * 0.5;
+
+		for (u32 v = 0; v < 3; ++v)
+			quadrics[result[i + v]].addPlane(normal, d, area);
+	}
+
+	std::vector<Collapse> collapses;
+	std::vector<u32>      remap(vertex_count);
+	std::vector<bool>     touched(vertex_count);
+	f64 error = 0.0;
+
+	while (result.size() > target_index_count) {
+		// Find the cheapest direction to collapse each edge
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (u32 e = 0; e < 3; ++e) {
+				const u32 a = result[i + e];
+				const u32 b = result[i + ((e + 1) % 3)];
+
+				// Interior edges are shared by two triangles, so only consider them once
+				if ((a > b) and not locked[a] and not locked[b])
+					continue;
+
+				Quadric q = quadrics[a];
+				q += quadrics[b];
+
+				const f64 a_to_b = locked[a] ? std::numeric_limits<f64>::max() : q.error(points[b]);
+				const f64 b_to_a = locked[b] ? std::numeric_limits<f64>::max() : q.error(points[a]);
+
+				if (a_to_b <= b_to_a) {
+					if (not locked[a])
+						collapses.push_back(Collapse{a, b, a_to_b});
+				}
+				else {
+					collapses.push_back(Collapse{b, a, b_to_a});
+				}
+			}
+		}
+
+		if (collapses.empty())
+			break;
+
+		std::ranges::sort(collapses, {}, &Collapse::error);
+
+		const Adjacency adjacency(result, vertex_count);
+
+		// Each collapse removes about two triangles
+		const size_t triangles_to_remove = (result.size() - target_index_count) / 3;
+		const size_t max_collapses       = (triangles_to_remove / 2) + 1;
+
+		for (size_t v = 0; v < vertex_count; ++v)
+			remap[v] = static_cast<u32>(v);
+		std::ranges::fill(touched, false);
+
+		size_t collapse_count = 0;
+
+		for (const auto& collapse : collapses) {
+			if (collapse_count >= max_collapses)
+				break;
+
+			const f64 collapse_error = std::sqrt(collapse.error);
+			if (collapse_error > max_error)
+				break;
+
+			if (touched[collapse.src] or touched[collapse.dst])
+				continue;
+
+			if (FlipsTriangles(result, points, adjacency, collapse.src, collapse.dst))
+				continue;
+
+			// Don't collapse around vertices that have already moved this pass, so the
+			// flip check above only ever sees the positions at the start of the pass
+			for (const u32 triangle : adjacency[collapse.src]) {
+				for (u32 v = 0; v < 3; ++v)
+					touched[result[(triangle * 3) + v]] = true;
+			}
+
+			remap[collapse.src] = collapse.dst;
+			quadrics[collapse.dst] += quadrics[collapse.src];
+			error = std::max(error, collapse_error);
+			++collapse_count;
+		}
+
+		// Stop once every remaining collapse would pass the error limit. Collapses that were
+		// skipped because their vertices moved this pass are tried again in the next one.
+		if (collapse_count == 0)
+			break;
+
+		// Apply the collapses and remove the triangles that became degenerate
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const u32 a = remap[result[i]];
+			const u32 b = remap[result[i + 1]];
+			const u32 c = remap[result[i + 2]];
+			if ((a == b) or (b == c) or (c == a))
+				continue;
+
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	if (result_error)
+		*result_error = static_cast<f32>(error / scale);
+
+	return result;
+}
+
+
+void GenerateLODs(ModelOutput::MeshData& mesh, u32 lod_count, f32 reduction, f32 max_error) {
+	mesh.lods.clear();
+	if ((lod_count <= 1) or (mesh.indices.size() < 3) or mesh.positions.empty())
+		return;
+
+	const u32 vertex_count = static_cast<u32>(mesh.positions.size());
+	const f32 radius       = BoundingSphere::createFromVertices(mesh.positions).radius();
+	if (radius <= 0.0f)
+		return;
+
+	mesh.lods.push_back(MeshLOD{0, static_cast<u32>(mesh.indices.size()), 0.0f});
+
+	// Simplify each level from the previous one, which is faster than simplifying the full
+	// mesh each time. The errors of the levels add up, so the sum bounds the total error.
+	std::vector<u32> previous = mesh.indices;
+	f32 total_error = 0.0f;
+
+	while (mesh.lods.size() < lod_count) {
+		const size_t target = (static_cast<size_t>(static_cast<f32>(previous.size() / 3) * reduction)) * 3;
+		const f32 remaining_error = (max_error - total_error) * radius;
+		if ((target < 3) or (remaining_error <= 0.0f))
+			break;
+
+		f32 error = 0.0f;
+		auto lod_indices = SimplifyMesh(previous, mesh.positions, target, remaining_error, &error);
+
+		// Stop if the level isn't meaningfully smaller than the previous one
+		if (lod_indices.empty() or (lod_indices.size() > (previous.size() * 9) / 10))
+			break;
+
+		OptimizeVertexCache(lod_indices, vertex_count);
+
+		total_error += error / radius;
+
+		MeshLOD lod;
+		lod.index_offset = static_cast<u32>(mesh.indices.size());
+		lod.index_count  = static_cast<u32>(lod_indices.size());
+		lod.error        = total_error;
+		mesh.lods.push_back(lod);
+
+		mesh.indices.insert(mesh.indices.end(), lod_indices.begin(), lod_indices.end());
+		previous = std::move(lod_indices);
+	}
+
+	// A single level doesn't need to be stored
+	if (mesh.lods.size() == 1)
+		mesh.lods.clear();
+}
+
+} //namespace render::importer
@@ -0,0 +1,47 @@
+module;
+
+#include <span>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+export module rendering:importer.mesh_simplifier;
+
+import :model_output;
+
+
+//----------------------------------------------------------------------------------
+// Mesh Simplifier
+//----------------------------------------------------------------------------------
+//
+// Reduces the triangle count of a mesh with quadric error metric edge collapses
+// (after Garland and Heckbert). Each vertex accumulates the area-weighted planes of
+// its triangles, and edges are collapsed in order of the distance the surface moves.
+//
+// A vertex is only ever collapsed onto one of its neighbours, so no new vertices are
+// created and every level of detail shares the mesh's vertex buffer. Vertices on the
+// border of the mesh or on an attribute seam (e.g. a UV split) are never moved.
+//
+//----------------------------------------------------------------------------------
+export namespace render::importer {
+
+// Simplify a triangle list until it has at most target_index_count indices, or until the
+// next collapse would move the surface further than target_error. Returns the simplified
+// indices. If result_error isn't null, it receives the largest error introduced, in the
+// same units as the positions.
+[[nodiscard]]
+std::vector<u32> SimplifyMesh(std::span<const u32> indices,
+                              std::span<const f32_3> positions,
+                              size_t target_index_count,
+                              f32 target_error,
+                              f32* result_error = nullptr);
+
+// Generate a chain of levels of detail for a mesh. Each level is simplified from the previous
+// one to the given fraction of its triangles, and its indices are appended to the mesh's index
+// buffer. Generation stops early when a level can't be reduced further, or when its error
+// relative to the mesh's bounding sphere radius would pass max_error. The mesh's vertices are
+// expected to have already been optimized.
+void GenerateLODs(ModelOutput::MeshData& mesh, u32 lod_count, f32 reduction = 0.5f, f32 max_error = 0.05f);
+
+} //namespace render::importer
@@ -0,0 +1,669 @@
+module;
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+#include "io/io.h"
+#include "io/mapped_file.h"
+#include "string/string.h"
+
+module rendering;
+
+import log;
+import math.geometry;
+import math.directxmath;
+import :importer.model_cache;
+import :importer.texture_importer;
+import :material;
+import :mesh_lod;
+import :model_output;
+import :texture;
+
+using namespace DirectX;
+
+
+//----------------------------------------------------------------------------------
+// File Layout
+//----------------------------------------------------------------------------------
+//
+// FileHeader
+// MeshRecord[mesh_count]
+// NodeRecord[node_count]        (depth first, each node followed by its children)
+// u32[node_mesh_count]          (the mesh indices of every node, in node order)
+// MaterialRecord[material_count]
+// LODRecord[lod_count]          (the levels of detail of every mesh, in mesh order)
+// char[]                        (string data)
+// std::byte[]                   (interleaved vertex data of every mesh)
+// u32[]                         (index data of every mesh, each mesh's levels of detail one after another)
+//
+// Every section starts on a 16 byte boundary.
+//
+//----------------------------------------------------------------------------------
+namespace {
+
+constexpr u32 cache_magic   = 0x4C444D48; //"HMDL"
+constexpr u32 cache_version = 2;
+constexpr u64 section_alignment = 16;
+
+struct StringRef {
+	u32 offset = 0;
+	u32 size   = 0;
+};
+
+struct Section {
+	u64 offset = 0;
+	u64 size   = 0;
+};
+
+struct FileHeader {
+	u32 magic   = cache_magic;
+	u32 version = cache_version;
+	render::importer::ModelCacheKey key;
+	u32 padding = 0;
+
+	// The size and write time of the source file
+	u64 source_size = 0;
+	i64 source_time = 0;
+
+	StringRef name;
+	u32 mesh_count      = 0;
+	u32 node_count      = 0;
+	u32 node_mesh_count = 0;
+	u32 material_count  = 0;
+	u32 lod_count       = 0;
+	u32 reserved        = 0;
+
+	Section meshes;
+	Section nodes;
+	Section node_meshes;
+	Section materials;
+	Section lods;
+	Section strings;
+	Section vertices;
+	Section indices;
+};
+
+struct MeshRecord {
+	StringRef name;
+	u32   material_index = 0;
+	u32   vertex_count   = 0;
+	u32   index_count    = 0;
+	u32   first_lod      = 0; //index of the mesh's first level in the LOD section
+	u32   lod_count      = 0; //0 if the mesh has a single level
+	u32   padding        = 0;
+	u64   vertex_offset  = 0; //byte offset into the vertex section
+	u64   index_offset   = 0; //byte offset into the index section
+	f32_3 aabb_min;
+	f32_3 aabb_max;
+	f32_3 sphere_center;
+	f32   sphere_radius = 0.0f;
+};
+
+struct NodeRecord {
+	StringRef name;
+	u32 first_mesh  = 0; //index of the node's first mesh index in the node mesh section
+	u32 mesh_count  = 0;
+	u32 child_count = 0;
+};
+
+struct LODRecord {
+	u32 index_offset = 0; //offset from the mesh's first index
+	u32 index_count  = 0;
+	f32 error        = 0.0f;
+};
+
+struct MaterialRecord {
+	StringRef name;
+	f32_4     base_color;
+	f32       metalness = 0.0f;
+	f32       roughness = 0.0f;
+	f32_3     emissive;
+	StringRef maps[4]; //base color, material params, normal, emissive
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<MeshRecord>);
+static_assert(std::is_trivially_copyable_v<NodeRecord>);
+static_assert(std::is_trivially_copyable_v<LODRecord>);
+static_assert(std::is_trivially_copyable_v<MaterialRecord>);
+
+
+[[nodiscard]]
+constexpr u64 AlignUp(u64 value, u64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+// Zero a record, including any padding, before its fields are set so the bytes written
+// to the file never depend on uninitialized memory
+template<typename RecordT>
+[[nodiscard]]
+RecordT MakeZeroedRecord() noexcept {
+	RecordT record;
+	std::memset(&record, 0, sizeof(RecordT));
+	return record;
+}
+
+
+//----------------------------------------------------------------------------------
+// Writing
+//----------------------------------------------------------------------------------
+
+class StringTable {
+public:
+	[[nodiscard]]
+	StringRef add(std::string_view str) {
+		const StringRef ref{static_cast<u32>(data.size()), static_cast<u32>(str.size())};
+		data.insert(data.end(), str.begin(), str.end());
+		return ref;
+	}
+
+	[[nodiscard]]
+	const std::vector<char>& getData() const noexcept {
+		return data;
+	}
+
+private:
+	std::vector<char> data;
+};
+
+
+void FlattenNodes(const render::ModelOutput::Node& node,
+                  StringTable& strings,
+                  std::vector<NodeRecord>& nodes,
+                  std::vector<u32>& node_meshes) {
+
+	auto record = MakeZeroedRecord<NodeRecord>();
+	record.name        = strings.add(node.name);
+	record.first_mesh  = static_cast<u32>(node_meshes.size());
+	record.mesh_count  = static_cast<u32>(node.mesh_indices.size());
+	record.child_count = static_cast<u32>(node.child_nodes.size());
+
+	nodes.push_back(record);
+	node_meshes.insert(node_meshes.end(), node.mesh_indices.begin(), node.mesh_indices.end());
+
+	for (const auto& child : node.child_nodes) {
+		FlattenNodes(child, strings, nodes, node_meshes);
+	}
+}
+
+
+// Only textures loaded from a file are written. Other textures (e.g. the default material's
+// generated textures) are restored from the default material when the cache is read.
+[[nodiscard]]
+StringRef AddMap(StringTable& strings, const std::shared_ptr<render::Texture>& texture) {
+	return (texture and texture->isFileGUID()) ? strings.add(texture->getGUID()) : StringRef{};
+}
+
+
+// This function template is only called from within this translation unit so it can be defined here as well
+template<typename T>
+void WriteSection(std::ostream& stream, const Section& section, std::span<const T> data) {
+	// Pad up to the start of the section
+	static constexpr char zeros[section_alignment] = {};
+	const auto position = static_cast<u64>(stream.tellp());
+	if (section.offset > position)
+		stream.write(zeros, static_cast<std::streamsize>(section.offset - position));
+
+	stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+}
+
+
+//----------------------------------------------------------------------------------
+// Reading
+//----------------------------------------------------------------------------------
+
+// This function template is only called from within this translation unit so it can be defined here as well
+template<typename T>
+[[nodiscard]]
+bool GetSection(std::span<const std::byte> data, const Section& section, u64 count, std::span<const T>& out) {
+	if ((section.offset % section_alignment) != 0)
+		return false;
+	if ((section.offset > data.size()) or (section.size > (data.size() - section.offset)))
+		return false;
+	if ((count * sizeof(T)) > section.size)
+		return false;
+
+	out = std::span{reinterpret_cast<const T*>(data.data() + section.offset), static_cast<size_t>(count)};
+	return true;
+}
+
+
+[[nodiscard]]
+bool GetString(std::span<const char> strings, const StringRef& ref, std::string& out) {
+	if ((ref.offset > strings.size()) or (ref.size > (strings.size() - ref.offset)))
+		return false;
+
+	out.assign(strings.data() + ref.offset, ref.size);
+	return true;
+}
+
+
+[[nodiscard]]
+bool ReadNode(std::span<const NodeRecord> nodes,
+              std::span<const u32> node_meshes,
+              std::span<const char> strings,
+              u32& index,
+              render::ModelOutput::Node& out) {
+
+	if (index >= nodes.size())
+		return false;
+
+	const auto& record = nodes[index++];
+
+	if (not GetString(strings, record.name, out.name))
+		return false;
+
+	if ((record.first_mesh > node_meshes.size()) or (record.mesh_count > (node_meshes.size() - record.first_mesh)))
+		return false;
+
+	const auto meshes = node_meshes.subspan(record.first_mesh, record.mesh_count);
+	out.mesh_indices.assign(meshes.begin(), meshes.end());
+
+	// Each child consumes at least one of the remaining records
+	if (record.child_count > (nodes.size() - index))
+		return false;
+
+	out.child_nodes.resize(record.child_count);
+	for (auto& child : out.child_nodes) {
+		if (not ReadNode(nodes, node_meshes, strings, index, child))
+			return false;
+	}
+
+	return true;
+}
+
+
+[[nodiscard]]
+bool ReadMap(const render::TextureLoader& load_texture,
+             std::span<const char> strings,
+             const StringRef& ref,
+             render::TextureRole role,
+             std::shared_ptr<render::Texture>& out) {
+
+	if (ref.size == 0)
+		return true;
+
+	std::string path;
+	if (not GetString(strings, ref, path))
+		return false;
+
+	// The texture must still exist for the cached material to be valid
+	if (not fs::is_regular_file(path))
+		return false;
+
+	out = load_texture(fs::path{StrToWstr(path)}, role, out);
+	return true;
+}
+
+
+[[nodiscard]]
+bool GetSourceInfo(const fs::path& file, u64& size, i64& time) {
+	std::error_code ec;
+
+	size = fs::file_size(file, ec);
+	if (ec)
+		return false;
+
+	time = fs::last_write_time(file, ec).time_since_epoch().count();
+	return not ec;
+}
+
+} //namespace
+
+
+
+
+namespace render::importer {
+
+fs::path GetModelCachePath(const fs::path& file) {
+	auto path = file;
+	path += ".hmdl";
+	return path;
+}
+
+
+std::optional<ModelOutput> ReadModelCache(const fs::path& cache_file,
+                                          const fs::path& source_file,
+                                          const ModelCacheKey& key,
+                                          const Material& default_material,
+                                          const TextureLoader& load_texture) {
+
+	if (not fs::exists(cache_file))
+		return std::nullopt;
+
+	auto mapping = std::make_shared<MappedFile>();
+	if (not mapping->open(cache_file)) {
+		Logger::log(LogLevel::warn, "Failed to map model cache: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	const auto data = mapping->getData();
+
+	//----------------------------------------------------------------------------------
+	// Validate the header
+	//----------------------------------------------------------------------------------
+	if (data.size() < sizeof(FileHeader))
+		return std::nullopt;
+
+	FileHeader header;
+	std::memcpy(&header, data.data(), sizeof(FileHeader));
+
+	if ((header.magic != cache_magic) or (header.version != cache_version) or (header.key != key)) {
+		Logger::log(LogLevel::info, "Model cache does not match the import settings: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	u64 source_size = 0;
+	i64 source_time = 0;
+	if (not GetSourceInfo(source_file, source_size, source_time)
+	    or (header.source_size != source_size)
+	    or (header.source_time != source_time)) {
+
+		Logger::log(LogLevel::info, "Model cache is out of date: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Get the sections
+	//----------------------------------------------------------------------------------
+	std::span<const MeshRecord>     meshes;
+	std::span<const NodeRecord>     nodes;
+	std::span<const u32>            node_meshes;
+	std::span<const MaterialRecord> materials;
+	std::span<const LODRecord>      lods;
+	std::span<const char>           strings;
+	std::span<const std::byte>      vertices;
+	std::span<const u32>            indices;
+
+	const bool valid = GetSection(data, header.meshes, header.mesh_count, meshes)
+	               and GetSection(data, header.nodes, header.node_count, nodes)
+	               and GetSection(data, header.node_meshes, header.node_mesh_count, node_meshes)
+	               and GetSection(data, header.materials, header.material_count, materials)
+	               and GetSection(data, header.lods, header.lod_count, lods)
+	               and GetSection(data, header.strings, header.strings.size, strings)
+	               and GetSection(data, header.vertices, header.vertices.size, vertices)
+	               and GetSection(data, header.indices, header.indices.size / sizeof(u32), indices)
+	               and (header.node_count > 0);
+
+	if (not valid) {
+		Logger::log(LogLevel::warn, "Model cache is corrupt: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Build the output
+	//----------------------------------------------------------------------------------
+	ModelOutput out;
+	out.file    = source_file;
+	out.storage = mapping;
+
+	if (not GetString(strings, header.name, out.name)) {
+		Logger::log(LogLevel::warn, "Model cache is corrupt: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	// Meshes. The vertex and index data is referenced directly from the mapped file.
+	out.meshes.reserve(meshes.size());
+	for (const auto& record : meshes) {
+		const u64 vertex_bytes = static_cast<u64>(record.vertex_count) * key.vertex_size;
+
+		const bool valid_mesh = (record.vertex_offset <= vertices.size())
+		                    and (vertex_bytes <= (vertices.size() - record.vertex_offset))
+		                    and (record.index_offset % sizeof(u32) == 0)
+		                    and ((record.index_offset / sizeof(u32)) <= indices.size())
+		                    and (record.index_count <= (indices.size() - (record.index_offset / sizeof(u32))))
+		                    and (record.first_lod <= lods.size())
+		                    and (record.lod_count <= (lods.size() - record.first_lod));
+
+		auto& mesh = out.meshes.emplace_back();
+		if (not valid_mesh or not GetString(strings, record.name, mesh.name)) {
+			Logger::log(LogLevel::warn, "Model cache is corrupt: {}", cache_file.string());
+			return std::nullopt;
+		}
+
+		mesh.material_index = record.material_index;
+
+		// Each level must lie within the mesh's indices
+		mesh.lods.reserve(record.lod_count);
+		for (const auto& lod : lods.subspan(record.first_lod, record.lod_count)) {
+			if ((lod.index_offset > record.index_count) or (lod.index_count > (record.index_count - lod.index_offset))) {
+				Logger::log(LogLevel::warn, "Model cache is corrupt: {}", cache_file.string());
+				return std::nullopt;
+			}
+			mesh.lods.push_back(MeshLOD{lod.index_offset, lod.index_count, lod.error});
+		}
+
+		ModelOutput::PackedData packed;
+		packed.vertices      = vertices.subspan(record.vertex_offset, vertex_bytes);
+		packed.indices       = indices.subspan(record.index_offset / sizeof(u32), record.index_count);
+		packed.vertex_stride = key.vertex_size;
+		packed.aabb          = AABB{record.aabb_min, record.aabb_max};
+		packed.sphere        = BoundingSphere{record.sphere_center, record.sphere_radius};
+		mesh.packed = packed;
+	}
+
+	// Nodes
+	u32 node_index = 0;
+	if (not ReadNode(nodes, node_meshes, strings, node_index, out.root)) {
+		Logger::log(LogLevel::warn, "Model cache is corrupt: {}", cache_file.string());
+		return std::nullopt;
+	}
+
+	// Materials
+	out.materials.reserve(materials.size());
+	for (const auto& record : materials) {
+		auto& mat = out.materials.emplace_back(default_material);
+
+		mat.params.base_color = record.base_color;
+		mat.params.metalness  = record.metalness;
+		mat.params.roughness  = record.roughness;
+		mat.params.emissive   = record.emissive;
+
+		const bool valid_mat = GetString(strings, record.name, mat.name)
+		                   and ReadMap(load_texture, strings, record.maps[0], TextureRole::BaseColor, mat.maps.base_color)
+		                   and ReadMap(load_texture, strings, record.maps[1], TextureRole::MaterialParams, mat.maps.material_params)
+		                   and ReadMap(load_texture, strings, record.maps[2], TextureRole::Normal, mat.maps.normal)
+		                   and ReadMap(load_texture, strings, record.maps[3], TextureRole::Emissive, mat.maps.emissive);
+
+		if (not valid_mat) {
+			Logger::log(LogLevel::info, "Model cache references a missing texture: {}", cache_file.string());
+			return std::nullopt;
+		}
+	}
+
+	return out;
+}
+
+
+
+
+namespace detail {
+
+bool WriteModelCache(const ModelOutput& model,
+                     const fs::path& cache_file,
+                     const ModelCacheKey& key,
+                     const VertexWriter& write_vertices) {
+
+	auto header    = MakeZeroedRecord<FileHeader>();
+	header.magic   = cache_magic;
+	header.version = cache_version;
+	header.key     = key;
+
+	if (not GetSourceInfo(model.file, header.source_size, header.source_time))
+		return false;
+
+	//----------------------------------------------------------------------------------
+	// Build the tables
+	//----------------------------------------------------------------------------------
+	StringTable strings;
+	header.name = strings.add(model.name);
+
+	// Meshes
+	std::vector<MeshRecord> meshes;
+	meshes.reserve(model.meshes.size());
+
+	std::vector<LODRecord> lods;
+
+	u64 vertex_bytes = 0;
+	u64 index_bytes  = 0;
+
+	for (const auto& mesh : model.meshes) {
+		if (mesh.packed)
+			return false; //only processed meshes with separate attributes can be written
+
+		auto record = MakeZeroedRecord<MeshRecord>();
+		record.name           = strings.add(mesh.name);
+		record.material_index = mesh.material_index;
+		record.vertex_count   = static_cast<u32>(mesh.positions.size());
+		record.index_count    = static_cast<u32>(mesh.indices.size());
+		record.vertex_offset  = vertex_bytes;
+		record.index_offset   = index_bytes;
+		record.first_lod      = static_cast<u32>(lods.size());
+		record.lod_count      = static_cast<u32>(mesh.lods.size());
+
+		for (const auto& lod : mesh.lods) {
+			auto& lod_record = lods.emplace_back(MakeZeroedRecord<LODRecord>());
+			lod_record.index_offset = lod.index_offset;
+			lod_record.index_count  = lod.index_count;
+			lod_record.error        = lod.error;
+		}
+
+		if (not mesh.positions.empty()) {
+			const auto aabb   = AABB::createFromVertices(mesh.positions);
+			const auto sphere = BoundingSphere::createFromVertices(mesh.positions);
+			XMStore(&record.aabb_min, aabb.min());
+			XMStore(&record.aabb_max, aabb.max());
+			XMStore(&record.sphere_center, sphere.center());
+			record.sphere_radius = sphere.radius();
+		}
+
+		vertex_bytes += static_cast<u64>(record.vertex_count) * key.vertex_size;
+		index_bytes  += static_cast<u64>(record.index_count) * sizeof(u32);
+
+		meshes.push_back(record);
+	}
+
+	// Nodes
+	std::vector<NodeRecord> nodes;
+	std::vector<u32> node_meshes;
+	FlattenNodes(model.root, strings, nodes, node_meshes);
+
+	// Materials
+	std::vector<MaterialRecord> materials;
+	materials.reserve(model.materials.size());
+
+	for (const auto& mat : model.materials) {
+		auto record = MakeZeroedRecord<MaterialRecord>();
+		record.name       = strings.add(mat.name);
+		record.base_color = mat.params.base_color;
+		record.metalness  = mat.params.metalness;
+		record.roughness  = mat.params.roughness;
+		record.emissive   = mat.params.emissive;
+		record.maps[0]    = AddMap(strings, mat.maps.base_color);
+		record.maps[1]    = AddMap(strings, mat.maps.material_params);
+		record.maps[2]    = AddMap(strings, mat.maps.normal);
+		record.maps[3]    = AddMap(strings, mat.maps.emissive);
+
+		materials.push_back(record);
+	}
+
+	//----------------------------------------------------------------------------------
+	// Lay out the sections
+	//----------------------------------------------------------------------------------
+	header.mesh_count      = static_cast<u32>(meshes.size());
+	header.node_count      = static_cast<u32>(nodes.size());
+	header.node_mesh_count = static_cast<u32>(node_meshes.size());
+	header.material_count  = static_cast<u32>(materials.size());
+	header.lod_count       = static_cast<u32>(lods.size());
+
+	u64 offset = sizeof(FileHeader);
+	const auto place = [&offset](Section& section, u64 size) {
+		section.offset = AlignUp(offset, section_alignment);
+		section.size   = size;
+		offset = section.offset + size;
+	};
+
+	place(header.meshes,      meshes.size() * sizeof(MeshRecord));
+	place(header.nodes,       nodes.size() * sizeof(NodeRecord));
+	place(header.node_meshes, node_meshes.size() * sizeof(u32));
+	place(header.materials,   materials.size() * sizeof(MaterialRecord));
+	place(header.lods,        lods.size() * sizeof(LODRecord));
+	place(header.strings,     strings.getData().size());
+	place(header.vertices,    vertex_bytes);
+	place(header.indices,     index_bytes);
+
+	//----------------------------------------------------------------------------------
+	// Write the file
+	//----------------------------------------------------------------------------------
+
+	// Write to a temporary file first so a partially written cache is never read. The name
+	// is unique to the thread, so models loaded concurrently never share a temporary file.
+	auto temp_file = cache_file;
+	temp_file += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	{
+		std::ofstream stream(temp_file, std::ios::binary | std::ios::trunc);
+		if (not stream) {
+			Logger::log(LogLevel::warn, "Failed to create model cache: {}", cache_file.string());
+			return false;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+		WriteSection(stream, header.meshes, std::span<const MeshRecord>{meshes});
+		WriteSection(stream, header.nodes, std::span<const NodeRecord>{nodes});
+		WriteSection(stream, header.node_meshes, std::span<const u32>{node_meshes});
+		WriteSection(stream, header.materials, std::span<const MaterialRecord>{materials});
+		WriteSection(stream, header.lods, std::span<const LODRecord>{lods});
+		WriteSection(stream, header.strings, std::span<const char>{strings.getData()});
+
+		WriteSection(stream, header.vertices, std::span<const std::byte>{});
+		for (const auto& mesh : model.meshes) {
+			write_vertices(mesh, stream);
+		}
+
+		WriteSection(stream, header.indices, std::span<const u32>{});
+		for (const auto& mesh : model.meshes) {
+			stream.write(reinterpret_cast<const char*>(mesh.indices.data()), static_cast<std::streamsize>(mesh.indices.size() * sizeof(u32)));
+		}
+
+		const bool complete = stream.good() and (static_cast<u64>(stream.tellp()) == offset);
+		stream.close();
+
+		if (not complete) {
+			Logger::log(LogLevel::warn, "Failed to write model cache: {}", cache_file.string());
+			std::error_code ec;
+			fs::remove(temp_file, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	fs::rename(temp_file, cache_file, ec);
+	if (ec) {
+		Logger::log(LogLevel::warn, "Failed to write model cache: {}", cache_file.string());
+		fs::remove(temp_file, ec);
+		return false;
+	}
+
+	Logger::log(LogLevel::info, "Wrote model cache: {}", cache_file.string());
+	return true;
+}
+
+} //namespace detail
+
+} //namespace render::importer
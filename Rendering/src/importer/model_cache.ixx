@@ -0,0 +1,95 @@
+module;
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <span>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+
+export module rendering:importer.model_cache;
+
+import :material;
+import :model_config;
+import :model_output;
+
+
+//----------------------------------------------------------------------------------
+// Model Cache
+//----------------------------------------------------------------------------------
+//
+// A binary file containing a processed ModelOutput: the node tree, materials, mesh
+// bounding volumes, and the vertex and index data of every mesh, already interleaved
+// into the vertex type the model was imported with.
+//
+// A cache is read by mapping it into memory. The meshes of the returned ModelOutput
+// point directly into the mapping, so a cache hit does no per-vertex work.
+//
+// A cache is only used if it was written for the same vertex layout and import
+// flags, and the source file hasn't changed since the cache was written.
+//
+//----------------------------------------------------------------------------------
+export namespace render::importer {
+
+// The properties of an import that must match for a cache to be used
+struct ModelCacheKey {
+	[[nodiscard]]
+	bool operator==(const ModelCacheKey& other) const noexcept = default;
+
+	u32 vertex_size = 0;
+	u32 attributes  = 0;  //bit 0: normal, bit 1: texture, bit 2: color, bit 3: quantized
+	u32 flags       = 0;  //bit 0: flip winding, bit 1: flip uv, bit 2: optimize meshes, bits 8-15: LOD count
+};
+
+template<typename VertexT>
+[[nodiscard]]
+constexpr ModelCacheKey MakeModelCacheKey(const ModelConfig<VertexT>& config) noexcept {
+	ModelCacheKey key;
+	key.vertex_size = sizeof(VertexT);
+	key.attributes  = (VertexT::hasNormal() ? 0x1 : 0) | (VertexT::hasTexture() ? 0x2 : 0) | (VertexT::hasColor() ? 0x4 : 0)
+	                  | (VertexT::isQuantized() ? 0x8 : 0);
+	key.flags       = (config.flip_winding ? 0x1 : 0) | (config.flip_uv ? 0x2 : 0) | (config.optimize_meshes ? 0x4 : 0)
+	                  | (std::min(config.lod_count, 0xFFu) << 8);
+	return key;
+}
+
+// Get the path of the cache file for a model file
+[[nodiscard]]
+fs::path GetModelCachePath(const fs::path& file);
+
+// Read a model cache. Returns nullopt if the cache doesn't exist, is out of date, or was
+// written with a different key. Materials start as a copy of the default material, and the
+// texture files they reference are requested through the texture loader.
+[[nodiscard]]
+std::optional<ModelOutput> ReadModelCache(const fs::path& cache_file,
+                                          const fs::path& source_file,
+                                          const ModelCacheKey& key,
+                                          const Material& default_material,
+                                          const TextureLoader& load_texture);
+
+namespace detail {
+
+// Writes the interleaved vertices of a mesh to a stream
+using VertexWriter = std::function<void(const ModelOutput::MeshData&, std::ostream&)>;
+
+bool WriteModelCache(const ModelOutput& model,
+                     const fs::path& cache_file,
+                     const ModelCacheKey& key,
+                     const VertexWriter& write_vertices);
+
+} //namespace detail
+
+// Write a model cache. Returns false if the cache couldn't be written.
+template<typename VertexT>
+bool WriteModelCache(const ModelOutput& model, const fs::path& cache_file, const ModelConfig<VertexT>& config) {
+	const auto write_vertices = [](const ModelOutput::MeshData& mesh, std::ostream& stream) {
+		const auto vertices = BuildVertices<VertexT>(mesh);
+		stream.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(VertexT)));
+	};
+
+	return detail::WriteModelCache(model, cache_file, MakeModelCacheKey(config), write_vertices);
+}
+
+} //namespace render::importer
@@ -1,5 +1,12 @@
 module;
 
+#include <algorithm>
+#include <execution>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
 #include "io/io.h"
 
 export module rendering:importer.model_importer;
@@ -7,21 +14,106 @@ export module rendering:importer.model_importer;
 import log;
 
 import :importer.assimp_importer;
+import :importer.mesh_optimizer;
+import :importer.mesh_simplifier;
+import :importer.model_cache;
+import :importer.texture_importer;
+import :material;
+import :material_factory;
 import :model_output;
 import :model_config;
 import :resource_mgr;
+import :texture;
 
 
 export namespace render::importer {
 
+namespace detail {
+
+// Optimize the meshes of a model in parallel, and log the change in vertex cache efficiency
+void OptimizeMeshes(ModelOutput& model) {
+	std::vector<std::pair<VertexCacheStats, VertexCacheStats>> stats(model.meshes.size());
+
+	std::for_each(std::execution::par, model.meshes.begin(), model.meshes.end(), [&](ModelOutput::MeshData& mesh) {
+		const auto index = static_cast<size_t>(&mesh - model.meshes.data());
+		stats[index] = OptimizeMesh(mesh);
+	});
+
+	// Weight each mesh's ACMR by its triangle count
+	f64 triangles = 0.0;
+	f64 before    = 0.0;
+	f64 after     = 0.0;
+	for (size_t i = 0; i < model.meshes.size(); ++i) {
+		const auto count = static_cast<f64>(model.meshes[i].indices.size() / 3);
+		triangles += count;
+		before    += stats[i].first.acmr * count;
+		after     += stats[i].second.acmr * count;
+	}
+
+	if (triangles > 0.0)
+		Logger::log(LogLevel::info, "Optimized meshes of {}: ACMR {:.3f} -> {:.3f}", model.name, before / triangles, after / triangles);
+}
+
+// Generate the levels of detail of every mesh in parallel
+void GenerateLODs(ModelOutput& model, u32 lod_count) {
+	std::for_each(std::execution::par, model.meshes.begin(), model.meshes.end(), [lod_count](ModelOutput::MeshData& mesh) {
+		importer::GenerateLODs(mesh, lod_count);
+	});
+
+	size_t lods = 0;
+	for (const auto& mesh : model.meshes) {
+		lods += mesh.lods.size();
+	}
+
+	Logger::log(LogLevel::info, "Generated {} levels of detail for {} meshes of {}", lods, model.meshes.size(), model.name);
+}
+
+} //namespace detail
+
+
+// Import a model file without touching the device. A cache of the processed model is written
+// next to the file on the first import, and is loaded instead of the file on subsequent imports.
+// Materials start as a copy of the default material, and the textures they reference are
+// requested through the texture loader.
 template<typename VertexT>
 [[nodiscard]]
-ModelOutput ImportModel(ResourceMgr& resource_mgr, const fs::path& file, const ModelConfig<VertexT>& config) {
+ModelOutput ImportModel(const fs::path& file,
+                        const ModelConfig<VertexT>& config,
+                        const Material& default_material,
+                        const TextureLoader& load_texture) {
+
+	const auto cache_file = GetModelCachePath(file);
+
+	if (auto cached = ReadModelCache(cache_file, file, MakeModelCacheKey(config), default_material, load_texture)) {
+		Logger::log(LogLevel::info, "Loaded model from cache: {}", file.string());
+		return std::move(*cached);
+	}
 
 	Logger::log(LogLevel::info, "Loading model: {}", file.string());
-	auto out = detail::AssimpImport(resource_mgr, file, config.flip_winding, config.flip_uv);
+	auto out = detail::AssimpImport(file, config.flip_winding, config.flip_uv, default_material, load_texture);
 	Logger::log(LogLevel::info, "Loaded model: {}", file.string());
+
+	if (config.optimize_meshes)
+		detail::OptimizeMeshes(out);
+
+	if (config.lod_count > 1)
+		detail::GenerateLODs(out, config.lod_count);
+
+	if (not out.meshes.empty())
+		WriteModelCache(out, cache_file, config);
+
 	return out;
 }
 
-} //namespace render::importer
+// Import a model file, loading its textures synchronously
+template<typename VertexT>
+[[nodiscard]]
+ModelOutput ImportModel(ResourceMgr& resource_mgr, const fs::path& file, const ModelConfig<VertexT>& config) {
+	const auto load_texture = [&resource_mgr](const fs::path& texture, TextureRole role, const std::shared_ptr<Texture>&) {
+		return resource_mgr.getOrCreate<Texture>(texture.wstring(), role);
+	};
+
+	return ImportModel(file, config, MaterialFactory::CreateDefaultMaterial(resource_mgr), load_texture);
+}
+
+} //namespace render::importer
\ No newline at end of file
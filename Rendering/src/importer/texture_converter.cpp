@@ -0,0 +1,380 @@
+#include "texture_converter.h"
+
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+
+namespace {
+
+[[nodiscard]]
+bool IsCompressedRole(render::TextureConverter::TextureRole role) noexcept {
+	return role != render::TextureConverter::TextureRole::Generic;
+}
+
+[[nodiscard]]
+HRESULT GenerateMips(ScratchImage& image) {
+	const auto& metadata = image.GetMetadata();
+	if ((metadata.mipLevels > 1) or ((metadata.width <= 1) and (metadata.height <= 1)))
+		return S_OK;
+
+	ScratchImage mip_chain;
+	const HRESULT hr = GenerateMipMaps(image.GetImages(), image.GetImageCount(), metadata, TEX_FILTER_DEFAULT, 0, mip_chain);
+	if (SUCCEEDED(hr))
+		image = std::move(mip_chain);
+
+	return hr;
+}
+
+[[nodiscard]]
+HRESULT CompressImage(ScratchImage& image, DXGI_FORMAT format) {
+	auto flags = TEX_COMPRESS_DEFAULT;
+#ifdef _OPENMP
+	flags |= TEX_COMPRESS_PARALLEL;
+#endif
+
+	ScratchImage compressed;
+	const HRESULT hr = Compress(image.GetImages(), image.GetImageCount(), image.GetMetadata(), format, flags, TEX_THRESHOLD_DEFAULT, compressed);
+	if (SUCCEEDED(hr))
+		image = std::move(compressed);
+
+	return hr;
+}
+
+
+//----------------------------------------------------------------------------------
+// BMP Decoding
+//----------------------------------------------------------------------------------
+//
+// A portable decoder for uncompressed 16, 24 and 32-bit bitmaps, with or without
+// channel masks. These are the variants image editors write by default. Palettized
+// and RLE bitmaps return E_NOTIMPL.
+//
+//----------------------------------------------------------------------------------
+
+constexpr size_t bmp_file_header_size = 14;
+constexpr size_t bmp_info_header_size = 40; //BITMAPINFOHEADER
+
+constexpr u32 bmp_rgb             = 0; //BI_RGB
+constexpr u32 bmp_bitfields       = 3; //BI_BITFIELDS
+constexpr u32 bmp_alpha_bitfields = 6; //BI_ALPHABITFIELDS
+
+// Larger dimensions are rejected before computing the image size
+constexpr u32 bmp_max_dimension = 1u << 16;
+
+[[nodiscard]]
+u16 ReadU16(const std::vector<u8>& data, size_t offset) noexcept {
+	u16 value;
+	std::memcpy(&value, data.data() + offset, sizeof(value));
+	return value;
+}
+
+[[nodiscard]]
+u32 ReadU32(const std::vector<u8>& data, size_t offset) noexcept {
+	u32 value;
+	std::memcpy(&value, data.data() + offset, sizeof(value));
+	return value;
+}
+
+// The position of a color channel within a pixel
+struct ChannelMask {
+	u32 mask  = 0;
+	u32 shift = 0;
+	u32 max   = 0; //the largest value of the channel
+};
+
+// Returns std::nullopt if the mask isn't a contiguous run of at most 16 bits
+[[nodiscard]]
+std::optional<ChannelMask> GetChannelMask(u32 mask) noexcept {
+	if (mask == 0)
+		return ChannelMask{};
+
+	const auto shift = static_cast<u32>(std::countr_zero(mask));
+	const auto bits  = static_cast<u32>(std::popcount(mask));
+	if ((bits > 16) or ((mask >> shift) != ((1u << bits) - 1)))
+		return std::nullopt;
+
+	return ChannelMask{mask, shift, (1u << bits) - 1};
+}
+
+// Scale a channel to 8 bits. Returns the fallback value if the bitmap doesn't store the channel.
+[[nodiscard]]
+u8 ReadChannel(u32 pixel, const ChannelMask& channel, u8 fallback) noexcept {
+	if (channel.mask == 0)
+		return fallback;
+
+	const u32 value = (pixel & channel.mask) >> channel.shift;
+	return static_cast<u8>(((value * 255u) + (channel.max / 2)) / channel.max);
+}
+
+[[nodiscard]]
+HRESULT DecodeBMP(const fs::path& filename, ScratchImage& image) {
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (not file)
+		return E_FAIL;
+
+	std::vector<u8> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (not file)
+		return E_FAIL;
+
+	if ((data.size() < bmp_file_header_size + bmp_info_header_size) or (data[0] != 'B') or (data[1] != 'M'))
+		return E_FAIL;
+
+	const u32 pixel_offset = ReadU32(data, 10);
+	const u32 header_size  = ReadU32(data, 14);
+	const i32 width        = static_cast<i32>(ReadU32(data, 18));
+	const i32 height       = static_cast<i32>(ReadU32(data, 22));
+	const u16 bit_count    = ReadU16(data, 28);
+	const u32 compression  = ReadU32(data, 30);
+
+	if ((header_size < bmp_info_header_size) or (width <= 0) or (height == 0))
+		return E_FAIL;
+
+	// A negative height means the rows are stored top-down
+	const bool top_down = height < 0;
+	const u64  rows     = top_down ? static_cast<u64>(-static_cast<i64>(height)) : static_cast<u64>(height);
+	const u64  columns  = static_cast<u64>(width);
+
+	if ((columns > bmp_max_dimension) or (rows > bmp_max_dimension))
+		return E_FAIL;
+
+	// The red, green, blue and alpha masks. Bitmaps without masks have fixed masks, and no alpha.
+	u32 masks[4] = {};
+	if (compression == bmp_rgb) {
+		if (bit_count == 16) {
+			masks[0] = 0x7C00;
+			masks[1] = 0x03E0;
+			masks[2] = 0x001F;
+		}
+		else if ((bit_count == 24) or (bit_count == 32)) {
+			masks[0] = 0xFF0000;
+			masks[1] = 0x00FF00;
+			masks[2] = 0x0000FF;
+		}
+		else {
+			return E_NOTIMPL;
+		}
+	}
+	else if ((compression == bmp_bitfields) or (compression == bmp_alpha_bitfields)) {
+		if ((bit_count != 16) and (bit_count != 32))
+			return E_NOTIMPL;
+
+		// The masks follow the BITMAPINFOHEADER, whether they're part of a larger header or not.
+		// Only the larger headers and BI_ALPHABITFIELDS have an alpha mask.
+		const size_t mask_offset = bmp_file_header_size + bmp_info_header_size;
+		const size_t mask_count  = ((header_size >= 56) or (compression == bmp_alpha_bitfields)) ? 4 : 3;
+		if (data.size() < mask_offset + (mask_count * sizeof(u32)))
+			return E_FAIL;
+
+		for (size_t i = 0; i < mask_count; ++i) {
+			masks[i] = ReadU32(data, mask_offset + (i * sizeof(u32)));
+		}
+	}
+	else {
+		return E_NOTIMPL;
+	}
+
+	ChannelMask channels[4];
+	for (size_t i = 0; i < 4; ++i) {
+		const auto channel = GetChannelMask(masks[i]);
+		if (not channel)
+			return E_NOTIMPL;
+		channels[i] = *channel;
+	}
+
+	// Each row is padded to a multiple of 4 bytes
+	const u64 row_pitch = (((columns * bit_count) + 31) / 32) * 4;
+	if ((pixel_offset > data.size()) or ((row_pitch * rows) > (data.size() - pixel_offset)))
+		return E_FAIL;
+
+	const HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, static_cast<size_t>(columns), static_cast<size_t>(rows), 1, 1);
+	if (FAILED(hr))
+		return hr;
+
+	const Image* out             = image.GetImage(0, 0, 0);
+	const size_t bytes_per_pixel = bit_count / 8;
+
+	for (u64 y = 0; y < rows; ++y) {
+		const u64 src_row = top_down ? y : (rows - 1 - y);
+		const u8* src     = data.data() + pixel_offset + (src_row * row_pitch);
+		u8*       dest    = out->pixels + (y * out->rowPitch);
+
+		for (u64 x = 0; x < columns; ++x) {
+			u32 pixel = 0;
+			std::memcpy(&pixel, src + (x * bytes_per_pixel), bytes_per_pixel);
+
+			dest[(x * 4) + 0] = ReadChannel(pixel, channels[0], 0);
+			dest[(x * 4) + 1] = ReadChannel(pixel, channels[1], 0);
+			dest[(x * 4) + 2] = ReadChannel(pixel, channels[2], 0);
+			dest[(x * 4) + 3] = ReadChannel(pixel, channels[3], 255);
+		}
+	}
+
+	return S_OK;
+}
+
+
+// Write a cache entry through a temporary file, so a concurrent reader never sees a partial entry
+void WriteCacheEntry(const ScratchImage& image, const fs::path& cache_file) {
+	std::error_code error;
+	fs::create_directories(cache_file.parent_path(), error);
+	if (error)
+		return;
+
+	auto temp_file = cache_file;
+	temp_file += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	const HRESULT hr = SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DDS_FLAGS_NONE, temp_file.wstring().c_str());
+	if (FAILED(hr)) {
+		fs::remove(temp_file, error);
+		return;
+	}
+
+	fs::rename(temp_file, cache_file, error);
+	if (error)
+		fs::remove(temp_file, error);
+}
+
+} //namespace
+
+
+namespace render::TextureConverter {
+
+DXGI_FORMAT GetCompressedFormat(TextureRole role, bool has_alpha) noexcept {
+	switch (role) {
+		case TextureRole::BaseColor:      return has_alpha ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+		case TextureRole::Normal:         return DXGI_FORMAT_BC5_UNORM;
+		case TextureRole::MaterialParams: return DXGI_FORMAT_BC7_UNORM;
+		case TextureRole::Emissive:       return DXGI_FORMAT_BC1_UNORM;
+		default:                          return DXGI_FORMAT_UNKNOWN;
+	}
+}
+
+
+u64 HashFile(const fs::path& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (not file)
+		return 0;
+
+	u64 hash = 0xcbf29ce484222325ull;
+
+	std::vector<char> buffer(64 * 1024);
+	while (file) {
+		file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		const auto count = static_cast<size_t>(file.gcount());
+		for (size_t i = 0; i < count; ++i) {
+			hash ^= static_cast<u8>(buffer[i]);
+			hash *= 0x100000001b3ull;
+		}
+	}
+
+	return (hash == 0) ? 1 : hash;
+}
+
+
+fs::path GetCachePath(const fs::path& cache_dir, u64 content_hash, TextureRole role) {
+	return cache_dir / std::format("{:016x}_{}_v{}.dds", content_hash, static_cast<u32>(role), converter_version);
+}
+
+
+HRESULT DecodeImage(const fs::path& filename, ScratchImage& image) {
+	const auto extension = filename.extension();
+
+	if ((extension == ".dds") or (extension == ".DDS"))
+		return LoadFromDDSFile(filename.wstring().c_str(), DDS_FLAGS_NONE, nullptr, image);
+
+	if ((extension == ".tga") or (extension == ".TGA"))
+		return LoadFromTGAFile(filename.wstring().c_str(), nullptr, image);
+
+	if ((extension == ".hdr") or (extension == ".HDR"))
+		return LoadFromHDRFile(filename.wstring().c_str(), nullptr, image);
+
+	// Bitmaps are decoded the same way on every platform, so the converted texture doesn't
+	// depend on where it was converted. WIC decodes the variants DecodeBMP doesn't support.
+	if ((extension == ".bmp") or (extension == ".BMP")) {
+		const HRESULT hr = DecodeBMP(filename, image);
+#ifdef _WIN32
+		if (hr == E_NOTIMPL)
+			return LoadFromWICFile(filename.wstring().c_str(), WIC_FLAGS_NONE, nullptr, image);
+#endif
+		return hr;
+	}
+
+	// PNG, JPEG and other formats
+#ifdef _WIN32
+	return LoadFromWICFile(filename.wstring().c_str(), WIC_FLAGS_NONE, nullptr, image);
+#else
+	return E_NOTIMPL;
+#endif
+}
+
+
+HRESULT ConvertImage(ScratchImage& image, TextureRole role) {
+	// Compressed images can't be filtered, so they're used as they are
+	if (IsCompressed(image.GetMetadata().format))
+		return S_OK;
+
+	HRESULT hr = GenerateMips(image);
+	if (FAILED(hr))
+		return hr;
+
+	const auto& metadata = image.GetMetadata();
+	const auto  format   = GetCompressedFormat(role, not image.IsAlphaAllOpaque());
+	if (format == DXGI_FORMAT_UNKNOWN)
+		return S_OK;
+
+	// Direct3D requires the top level of a block compressed texture to be a whole number of blocks
+	if (((metadata.width % 4) != 0) or ((metadata.height % 4) != 0))
+		return S_OK;
+
+	return CompressImage(image, format);
+}
+
+
+HRESULT LoadConvertedTexture(const fs::path& filename,
+                             TextureRole role,
+                             const fs::path& cache_dir,
+                             ScratchImage& image,
+                             u64 content_hash) {
+
+	const bool use_cache = IsCompressedRole(role) and not cache_dir.empty();
+
+	fs::path cache_file;
+	if (use_cache) {
+		if (content_hash == 0)
+			content_hash = HashFile(filename);
+
+		if (content_hash != 0) {
+			cache_file = GetCachePath(cache_dir, content_hash, role);
+
+			if (fs::exists(cache_file)) {
+				if (SUCCEEDED(LoadFromDDSFile(cache_file.wstring().c_str(), DDS_FLAGS_NONE, nullptr, image)))
+					return S_OK;
+			}
+		}
+	}
+
+	HRESULT hr = DecodeImage(filename, image);
+	if (FAILED(hr))
+		return hr;
+
+	// The decoded image is still usable if it couldn't be converted, but isn't cached
+	if (FAILED(ConvertImage(image, role)))
+		return S_FALSE;
+
+	if (not cache_file.empty())
+		WriteCacheEntry(image, cache_file);
+
+	return S_OK;
+}
+
+} //namespace render::TextureConverter
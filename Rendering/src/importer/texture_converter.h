@@ -0,0 +1,82 @@
+#pragma once
+
+#include <DirectXTex.h>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+
+
+//----------------------------------------------------------------------------------
+// Texture Converter
+//----------------------------------------------------------------------------------
+//
+// Converts texture files into the form they're uploaded to the GPU in: a full mip
+// chain, block compressed according to how the texture is used by a material.
+//
+//   Base color      - BC1, or BC3 if the texture has transparency
+//   Normal          - BC5 (the shaders reconstruct z)
+//   Material params - BC7
+//   Emissive        - BC1
+//   Generic         - uncompressed, mips only
+//
+// Converted textures are written to a content-addressed disk cache. A cache entry is
+// named after the hash of the source file's contents, so an entry is valid for as long
+// as it exists, and identical files share an entry.
+//
+// This code only depends on DirectXTex and the standard library, and isn't part of
+// the rendering module, so it can be built on its own for offline conversion. DDS,
+// TGA, HDR and uncompressed BMP files can be decoded on any platform. Other formats,
+// including PNG and JPEG, are decoded with WIC, which is only available on Windows.
+// Off Windows, those files can't be converted until a portable decoder is added.
+//
+//----------------------------------------------------------------------------------
+namespace render::TextureConverter {
+
+// Bump when the output of ConvertImage changes, to invalidate existing cache entries
+inline constexpr u32 converter_version = 1;
+
+enum class TextureRole : u8 {
+	Generic,
+	BaseColor,
+	Normal,
+	MaterialParams,
+	Emissive,
+};
+
+// The format a texture with the given role is compressed to. Returns DXGI_FORMAT_UNKNOWN
+// for roles that aren't compressed.
+[[nodiscard]]
+DXGI_FORMAT GetCompressedFormat(TextureRole role, bool has_alpha) noexcept;
+
+// Hash the contents of a file (64-bit FNV-1a). Returns 0 if the file can't be read.
+[[nodiscard]]
+u64 HashFile(const fs::path& filename);
+
+// The path of a converted texture in the cache: the content hash, role and converter version
+[[nodiscard]]
+fs::path GetCachePath(const fs::path& cache_dir, u64 content_hash, TextureRole role);
+
+// Decode an image file into system memory. On Windows, COM must be initialized on the
+// calling thread to decode WIC formats. Returns E_NOTIMPL if the format can't be decoded on
+// this platform.
+[[nodiscard]]
+HRESULT DecodeImage(const fs::path& filename, DirectX::ScratchImage& image);
+
+// Generate a full mip chain for an image that doesn't have one, then block compress it for
+// its role. Images that are already compressed are left as they are, as are images whose
+// size isn't a multiple of the 4x4 block size.
+[[nodiscard]]
+HRESULT ConvertImage(DirectX::ScratchImage& image, TextureRole role);
+
+// Decode and convert a texture file. Compressed roles are read from the cache if it has an
+// entry for the file, or written to it otherwise. An empty cache directory disables the cache.
+// The file is hashed if its content hash isn't given. Returns S_FALSE if the file was decoded
+// but couldn't be converted.
+[[nodiscard]]
+HRESULT LoadConvertedTexture(const fs::path& filename,
+                             TextureRole role,
+                             const fs::path& cache_dir,
+                             DirectX::ScratchImage& image,
+                             u64 content_hash = 0);
+
+} //namespace render::TextureConverter
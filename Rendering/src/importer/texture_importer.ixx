@@ -8,6 +8,13 @@ module;
 
 #include <DirectXTex.h>
 
+#include <algorithm>
+#include <cwctype>
+#include <optional>
+#include <string>
+
+#include "texture_converter.h"
+
 export module rendering:importer.texture_importer;
 
 import exception;
@@ -84,8 +91,138 @@ void HandleLoaderError(ID3D11Device& device, const std::string& msg, ID3D11Shade
 }
 
 
+// WIC decoding requires COM to be initialized on the calling thread
+void InitializeCOMForThread() {
+	thread_local const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	(void)hr; //RPC_E_CHANGED_MODE means COM was already initialized by the thread
+}
+
+
+export namespace render {
+using TextureConverter::TextureRole;
+}
+
 export namespace render::importer {
 
+// Create the checkerboard texture used in place of textures that fail to load
+void ImportErrorTexture(ID3D11Device& device, ID3D11ShaderResourceView** srv_out) {
+	CreateErrorTexture(device, srv_out);
+}
+
+// Decode a texture file (jpg, png, dds, etc...) into system memory, generate its mip chain if
+// it doesn't have one, and compress it for its role. Compressed textures are cached in the
+// cache directory (see TextureConverter). No device is required, so this can be called from
+// any thread.
+[[nodiscard]]
+std::optional<ScratchImage> DecodeTexture(const fs::path& filename,
+                                          TextureRole role = TextureRole::Generic,
+                                          const fs::path& cache_dir = {},
+                                          u64 content_hash = 0) {
+	if (not fs::exists(filename)) {
+		Logger::log(LogLevel::err, "Error loading texture (file not found): {}", filename.string());
+		return std::nullopt;
+	}
+
+	InitializeCOMForThread();
+
+	ScratchImage image;
+	const HRESULT hr = TextureConverter::LoadConvertedTexture(filename, role, cache_dir, image, content_hash);
+
+	if (hr == E_NOTIMPL) {
+		Logger::log(LogLevel::err, "Texture format isn't supported on this platform: {}", filename.string());
+		return std::nullopt;
+	}
+	if (FAILED(hr)) {
+		Logger::log(LogLevel::err, "Failed to decode texture: {}", filename.string());
+		return std::nullopt;
+	}
+	if (hr == S_FALSE) {
+		Logger::log(LogLevel::warn, "Failed to convert texture, using it uncompressed: {}", filename.string());
+	}
+
+	return image;
+}
+
+// Estimate the memory a texture file will use once it's decoded by DecodeTexture, from the
+// file's header. Returns 0 if the header can't be read.
+[[nodiscard]]
+u64 EstimateTextureMemoryUsage(const fs::path& filename) {
+	HRESULT hr;
+	TexMetadata metadata = {};
+
+	if (filename.extension() == L".dds") {
+		hr = GetMetadataFromDDSFile(filename.c_str(), DDS_FLAGS_NONE, metadata);
+	}
+	else if (filename.extension() == L".tga") {
+		hr = GetMetadataFromTGAFile(filename.c_str(), metadata);
+	}
+	else {
+		InitializeCOMForThread();
+		hr = GetMetadataFromWICFile(filename.c_str(), WIC_FLAGS_NONE, metadata);
+	}
+
+	if (FAILED(hr))
+		return 0;
+
+	size_t row_pitch   = 0;
+	size_t slice_pitch = 0;
+	if (FAILED(ComputePitch(metadata.format, metadata.width, metadata.height, row_pitch, slice_pitch)))
+		return 0;
+
+	// A full mip chain adds about a third to the size of the top level
+	const bool has_mips = (metadata.mipLevels > 1) or not IsCompressed(metadata.format);
+	const u64  size     = static_cast<u64>(slice_pitch) * metadata.arraySize * metadata.depth;
+	return has_mips ? (size * 4) / 3 : size;
+}
+
+// Get the key a texture file is identified by. Different relative paths to the same file give
+// the same key. Paths are case insensitive on Windows, so the key is lowercase.
+[[nodiscard]]
+std::wstring GetCanonicalTexturePath(const fs::path& filename) {
+	std::error_code error;
+	auto path = fs::weakly_canonical(filename, error);
+	if (error)
+		path = filename.lexically_normal();
+
+	auto key = path.make_preferred().wstring();
+	std::ranges::transform(key, key.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+	return key;
+}
+
+// Hash the contents of a texture file. Textures with the same hash are assumed to be
+// identical. Returns 0 if the file can't be read.
+[[nodiscard]]
+u64 HashTextureFile(const fs::path& filename) {
+	return TextureConverter::HashFile(filename);
+}
+
+// Create a texture SRV from an image decoded with DecodeTexture. An error texture is created
+// if the image is missing or the texture can't be created.
+void ImportTexture(ID3D11Device& device,
+                   const std::optional<ScratchImage>& image,
+                   const fs::path& filename,
+                   ID3D11ShaderResourceView** srv_out) {
+
+	if (not image) {
+		CreateErrorTexture(device, srv_out);
+		return;
+	}
+
+	const HRESULT hr = CreateShaderResourceView(&device,
+	                                            image->GetImages(),
+	                                            image->GetImageCount(),
+	                                            image->GetMetadata(),
+	                                            srv_out);
+	if (FAILED(hr)) {
+		HandleLoaderError(device, "Failed to create texture: " + filename.string(), srv_out);
+		return;
+	}
+
+	SetDebugObjectName(*srv_out, "importer Texture");
+	Logger::log(LogLevel::debug, "Loaded texture: {}", filename.string());
+}
+
+
 // Load a texture from a file (jpg, png, etc...)
 void ImportTexture(ID3D11Device& device,
 	               ID3D11DeviceContext& device_context,
@@ -244,6 +244,16 @@ void OutputMgr::bindEnd(ID3D11DeviceContext& device_context) const {
 }
 
 
+void OutputMgr::bindBeginDepth(ID3D11DeviceContext& device_context) const {
+	Pipeline::OM::bindRTVAndDSV(device_context, nullptr, dsv.Get());
+}
+
+
+void OutputMgr::bindEndDepth(ID3D11DeviceContext& device_context) const {
+	Pipeline::OM::bindRTVAndDSV(device_context, nullptr, nullptr);
+}
+
+
 void OutputMgr::bindBeginForward(ID3D11DeviceContext& device_context) const {
 	Pipeline::OM::bindRTVAndDSV(device_context, swap_chain.getRTV(), dsv.Get());
 }
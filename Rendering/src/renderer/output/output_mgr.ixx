@@ -71,9 +71,19 @@ public:
 
 	void resizeBuffers();
 
+	// The depth buffer. Can only be bound for reading between a bindEnd* and the next bindBegin*.
+	[[nodiscard]]
+	ID3D11ShaderResourceView* getDepthSRV() const noexcept {
+		return get(SRV::GBufferDepth);
+	}
+
 	void bindBegin(ID3D11DeviceContext& device_context) const;
 	void bindEnd(ID3D11DeviceContext& device_context) const;
 
+	// Binds the depth buffer without a render target, for the depth pre-pass
+	void bindBeginDepth(ID3D11DeviceContext& device_context) const;
+	void bindEndDepth(ID3D11DeviceContext& device_context) const;
+
 	void bindBeginForward(ID3D11DeviceContext& device_context) const;
 	void bindEndForward(ID3D11DeviceContext& device_context) const;
 
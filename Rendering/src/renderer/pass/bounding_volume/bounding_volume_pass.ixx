@@ -5,27 +5,19 @@ module;
 #include <DirectXMath.h>
 
 #include "datatypes/vector_types.h"
-#include "memory/handle/handle.h"
 
 #include "hlsl.h"
 #include "directx/d3d11.h"
 
 export module rendering:pass.bounding_volume_pass;
 
-import ecs;
-import :components.light.directional_light;
-import :components.light.point_light;
-import :components.light.spot_light;
-import :components.model;
-import :components.transform;
-
 import math.geometry;
 
 import :constant_buffer;
 import :pipeline;
+import :render_snapshot;
 import :render_state_mgr;
 import :resource_mgr;
-import :scene;
 import :shader;
 import :shader_factory;
 
@@ -67,51 +59,27 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void XM_CALLCONV render(const ecs::ECS& ecs, FXMMATRIX world_to_projection, const f32_4& color) const {
+	void XM_CALLCONV render(const RenderSnapshot& snapshot, FXMMATRIX world_to_projection, const f32_4& color) const {
 		// Bind the render states
 		bindRenderStates();
 
 		color_buffer.updateData(device_context, color);
 
-		ecs.forEach<Transform, DirectionalLight>([&](handle64 entity) {
-			const auto& transform = ecs.get<Transform>(entity);
-			const auto& light     = ecs.get<DirectionalLight>(entity);
-
-			if (not light.isActive())
-				return;
-
-			renderAABB(light.getAABB(), transform, world_to_projection);
-		});
-
-		ecs.forEach<Transform, PointLight>([&](handle64 entity) {
-			const auto& transform = ecs.get<Transform>(entity);
-			const auto& light     = ecs.get<PointLight>(entity);
-
-			if (not light.isActive())
-				return;
-
-			renderAABB(light.getAABB(), transform, world_to_projection);
-		});
-
-		ecs.forEach<Transform, SpotLight>([&](handle64 entity) {
-			const auto& transform = ecs.get<Transform>(entity);
-			const auto& light     = ecs.get<SpotLight>(entity);
-
-			if (not light.isActive())
-				return;
-
-			renderAABB(light.getAABB(), transform, world_to_projection);
-		});
+		for (const auto& light : snapshot.directional_lights) {
+			renderAABB(light.aabb, light.light_to_world, world_to_projection);
+		}
 
-		ecs.forEach<Transform, Model>([&](handle64 entity) {
-			const auto& transform = ecs.get<Transform>(entity);
-			const auto& model     = ecs.get<Model>(entity);
+		for (const auto& light : snapshot.point_lights) {
+			renderAABB(light.aabb, light.light_to_world, world_to_projection);
+		}
 
-			if (not model.isActive())
-				return;
+		for (const auto& light : snapshot.spot_lights) {
+			renderAABB(light.aabb, light.light_to_world, world_to_projection);
+		}
 
-			renderAABB(model.getAABB(), transform, world_to_projection);
-		});
+		for (const auto& model : snapshot.models) {
+			renderAABB(model.getAABB(), model.object_to_world, world_to_projection);
+		}
 	}
 
 
@@ -139,8 +107,7 @@ private:
 		render_state_mgr.bind(device_context, RasterStates::CullCounterClockwise);
 	}
 
-	void XM_CALLCONV renderAABB(const AABB& aabb, const Transform& transform, FXMMATRIX world_to_projection) const {
-		const auto object_to_world = transform.getObjectToWorldMatrix();
+	void XM_CALLCONV renderAABB(const AABB& aabb, FXMMATRIX object_to_world, CXMMATRIX world_to_projection) const {
 		const auto object_to_projection = object_to_world * world_to_projection;
 
 		if (not Frustum(object_to_projection).contains(aabb))
@@ -1,24 +1,24 @@
 module;
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include <DirectXMath.h>
 
 #include "datatypes/types.h"
-#include "memory/handle/handle.h"
 
 #include "hlsl.h"
 #include "directx/d3d11.h"
 
 export module rendering:pass.depth_pass;
 
-import ecs;
-
 import math.geometry;
 
-import :components.model;
-import :components.transform;
 import :buffer_types;
 import :constant_buffer;
 import :pipeline;
+import :render_snapshot;
 import :render_state_mgr;
 import :resource_mgr;
 import :shader_factory;
@@ -27,6 +27,14 @@ using namespace DirectX;
 
 namespace render {
 
+// Selects which shadow casters are rendered by DepthPass::renderShadows
+export enum class ShadowCasters {
+	All,
+	Static,
+	Dynamic
+};
+
+
 export class DepthPass final {
 public:
 	//----------------------------------------------------------------------------------
@@ -40,9 +48,11 @@ public:
 		, render_state_mgr(render_state_mgr)
 		, alt_cam_buffer(device) {
 
-		opaque_vs      = ShaderFactory::CreateDepthVS(resource_mgr);
-		transparent_vs = ShaderFactory::CreateDepthTransparentVS(resource_mgr);
-		transparent_ps = ShaderFactory::CreateDepthTransparentPS(resource_mgr);
+		opaque_vs                = ShaderFactory::CreateDepthVS(resource_mgr);
+		opaque_quantized_vs      = ShaderFactory::CreateDepthVS(resource_mgr, true);
+		transparent_vs           = ShaderFactory::CreateDepthTransparentVS(resource_mgr);
+		transparent_quantized_vs = ShaderFactory::CreateDepthTransparentVS(resource_mgr, true);
+		transparent_ps           = ShaderFactory::CreateDepthTransparentPS(resource_mgr);
 	}
 
 	DepthPass(const DepthPass&) = delete;
@@ -66,6 +76,9 @@ public:
 	// Member Functions
 	//----------------------------------------------------------------------------------
 	void bindState() const {
+		// Bind topology
+		Pipeline::IA::bindPrimitiveTopology(device_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
 		// Bind null shaders
 		Pipeline::HS::bindShader(device_context, nullptr, {});
 		Pipeline::DS::bindShader(device_context, nullptr, {});
@@ -76,7 +89,7 @@ public:
 		render_state_mgr.bind(device_context, DepthStencilStates::LessEqRW);
 	}
 
-	void XM_CALLCONV render(const ecs::ECS& ecs,
+	void XM_CALLCONV render(const RenderView& view,
 	                        FXMMATRIX world_to_camera,
 	                        CXMMATRIX camera_to_projection) const {
 		// Update and bind the camera buffer
@@ -90,18 +103,13 @@ public:
 		// Draw each opaque model
 		//----------------------------------------------------------------------------------
 
-		ecs.forEach<Model, Transform>([&](handle64 entity) {
-			const auto& model     = ecs.get<Model>(entity);
-			const auto& transform = ecs.get<Transform>(entity);
-
-			if (not model.isActive())
-				return;
-
+		bindOpaqueShaders();
+		view.forEachModel([&](const ModelProxy& model, u32 lod) {
 			const auto& mat = model.getMaterial();
 			if (mat.params.base_color[3] <= ALPHA_MAX)
 				return;
 
-			renderModel(model, transform, world_to_proj);
+			renderModel(model, lod, world_to_proj);
 		});
 
 
@@ -109,45 +117,80 @@ public:
 		// Draw each transparent model
 		//----------------------------------------------------------------------------------
 
-		ecs.forEach<Model, Transform>([&](handle64 entity) {
-			const auto& model     = ecs.get<Model>(entity);
-			const auto& transform = ecs.get<Transform>(entity);
-
-			if (not model.isActive())
-				return;
-		
+		bindTransparentShaders();
+		view.forEachModel([&](const ModelProxy& model, u32 lod) {
 			const auto& mat = model.getMaterial();
 			if (mat.params.base_color[3] < ALPHA_MIN || mat.params.base_color[3] > ALPHA_MAX)
 				return;
 
-			renderModel(model, transform, world_to_proj);
+			renderModel(model, lod, world_to_proj);
 		});
 	}
 
-	void XM_CALLCONV renderShadows(const ecs::ECS& ecs,
+	// Render the depth of the opaque models that the forward pass shades with its own
+	// shaders, nearest first, so that hidden surfaces fail the depth test early. Models
+	// with an overrided shader may discard pixels, so they're left to the shading pass.
+	void XM_CALLCONV renderPrepass(const RenderView& view,
 	                               FXMMATRIX world_to_camera,
 	                               CXMMATRIX camera_to_projection) const {
 		updateCamera(world_to_camera, camera_to_projection);
 
 		const auto world_to_proj = world_to_camera * camera_to_projection;
 
+		// Gather the visible models with the view space depth of their bounds' center
+		prepass_models.clear();
+		view.forEachModel([&](const ModelProxy& model, u32 lod) {
+			const auto& mat = model.getMaterial();
+			if (mat.shader || mat.params.base_color[3] <= ALPHA_MAX)
+				return;
+
+			if (not Frustum(model.object_to_world * world_to_proj).contains(model.getAABB()))
+				return;
+
+			const auto center = XMVector3TransformCoord(model.getBoundingSphere().center(), model.object_to_world);
+			const f32  depth  = XMVectorGetZ(XMVector3TransformCoord(center, world_to_camera));
+			prepass_models.push_back(PrepassModel{&model, lod, depth});
+		});
+
+		std::ranges::sort(prepass_models, std::less{}, &PrepassModel::depth);
+
+		bindOpaqueShaders();
+		for (const auto& entry : prepass_models) {
+			drawModel(*entry.model, entry.lod);
+		}
+	}
+
+	// Render the depth of the shadow casters. Shadow maps don't depend on the camera, so
+	// each caster is drawn with the snapshot's shadow level of detail.
+	void XM_CALLCONV renderShadows(const RenderSnapshot& snapshot,
+	                               FXMMATRIX world_to_camera,
+	                               CXMMATRIX camera_to_projection,
+	                               ShadowCasters casters = ShadowCasters::All) const {
+		updateCamera(world_to_camera, camera_to_projection);
+
+		const auto world_to_proj = world_to_camera * camera_to_projection;
+
+		const auto is_selected = [casters](const ModelProxy& model) {
+			switch (casters) {
+				case ShadowCasters::Static:  return model.static_shadows;
+				case ShadowCasters::Dynamic: return not model.static_shadows;
+				default:                     return true;
+			}
+		};
+
 		//----------------------------------------------------------------------------------
 		// Draw each opaque model
 		//----------------------------------------------------------------------------------
 
 		bindOpaqueShaders();
-		ecs.forEach<Model, Transform>([&](handle64 entity) {
-			const auto& model     = ecs.get<Model>(entity);
-			const auto& transform = ecs.get<Transform>(entity);
-
-			if (not model.isActive()) return;
-			if (not model.castsShadows()) return;
+		snapshot.forEachShadowCaster([&](const ModelProxy& model, u32 lod) {
+			if (not is_selected(model)) return;
 
 			const auto& mat = model.getMaterial();
 			if (mat.params.base_color[3] <= ALPHA_MAX)
 				return;
 
-			renderModel(model, transform, world_to_proj);
+			renderModel(model, lod, world_to_proj);
 		});
 
 
@@ -156,33 +199,44 @@ public:
 		//----------------------------------------------------------------------------------
 
 		bindTransparentShaders();
-		ecs.forEach<Model, Transform>([&](handle64 entity) {
-			const auto& model     = ecs.get<Model>(entity);
-			const auto& transform = ecs.get<Transform>(entity);
-
-			if (not model.isActive()) return;
-			if (not model.castsShadows()) return;
+		snapshot.forEachShadowCaster([&](const ModelProxy& model, u32 lod) {
+			if (not is_selected(model)) return;
 
 			const auto& mat = model.getMaterial();
 			if (mat.params.base_color[3] < ALPHA_MIN || mat.params.base_color[3] > ALPHA_MAX)
 				return;
 
-			renderModel(model, transform, world_to_proj);
+			renderModel(model, lod, world_to_proj);
 		});
 	}
 
 private:
 
 	void bindOpaqueShaders() const {
-		opaque_vs->bind(device_context);
+		transparent_shaders = false;
+		bound_vs            = nullptr;
+		bindVertexShader(false);
 		Pipeline::PS::bindShader(device_context, nullptr, {});
 	}
 
 	void bindTransparentShaders() const {
-		transparent_vs->bind(device_context);
+		transparent_shaders = true;
+		bound_vs            = nullptr;
+		bindVertexShader(false);
 		transparent_ps->bind(device_context);
 	}
 
+	// Bind the vertex shader matching a model's vertex format, if it isn't already bound
+	void bindVertexShader(bool quantized) const {
+		const auto& shader = transparent_shaders ? (quantized ? transparent_quantized_vs : transparent_vs)
+		                                         : (quantized ? opaque_quantized_vs : opaque_vs);
+		if (shader.get() == bound_vs)
+			return;
+
+		shader->bind(device_context);
+		bound_vs = shader.get();
+	}
+
 	void XM_CALLCONV updateCamera(FXMMATRIX world_to_camera, CXMMATRIX camera_to_projection) const {
 		AltCameraBuffer buffer;
 		buffer.world_to_camera      = XMMatrixTranspose(world_to_camera);
@@ -192,14 +246,18 @@ private:
 		alt_cam_buffer.bind<Pipeline::VS>(device_context, SLOT_CBUFFER_CAMERA_ALT);
 	}
 
-	void XM_CALLCONV renderModel(const Model& model, const Transform& transform, FXMMATRIX world_to_projection) const {
-		const auto model_to_world      = transform.getObjectToWorldMatrix();
-		const auto model_to_projection = model_to_world * world_to_projection;
+	void XM_CALLCONV renderModel(const ModelProxy& model, u32 lod, FXMMATRIX world_to_projection) const {
+		const auto model_to_projection = model.object_to_world * world_to_projection;
 
 		if (not Frustum(model_to_projection).contains(model.getAABB()))
 			return;
 
+		drawModel(model, lod);
+	}
+
+	void drawModel(const ModelProxy& model, u32 lod) const {
 		model.bindMesh(device_context);
+		bindVertexShader(model.hasQuantizedVertices());
 		model.bindBuffer<Pipeline::PS>(device_context, SLOT_CBUFFER_MODEL);
 		model.bindBuffer<Pipeline::VS>(device_context, SLOT_CBUFFER_MODEL);
 
@@ -207,7 +265,10 @@ private:
 		if (mat.maps.base_color)
 			mat.maps.base_color->bind<Pipeline::PS>(device_context, SLOT_SRV_BASE_COLOR);
 
-		Pipeline::drawIndexed(device_context, model.getIndexCount(), 0);
+		// Draw the level of detail selected by the caller. The depth pre-pass must match the
+		// forward pass exactly.
+		const auto& range = model.getLODRange(lod);
+		Pipeline::drawIndexed(device_context, range.index_count, range.index_offset);
 
 		Pipeline::PS::bindSRV(device_context, SLOT_SRV_BASE_COLOR, nullptr);
 	}
@@ -222,11 +283,26 @@ private:
 
 	// Shaders
 	std::shared_ptr<VertexShader> opaque_vs;
+	std::shared_ptr<VertexShader> opaque_quantized_vs;
 	std::shared_ptr<VertexShader> transparent_vs;
+	std::shared_ptr<VertexShader> transparent_quantized_vs;
 	std::shared_ptr<PixelShader>  transparent_ps;
 
+	// The shader set selected by bindOpaqueShaders/bindTransparentShaders, and the vertex
+	// shader bound by the last model
+	mutable bool                transparent_shaders = false;
+	mutable const VertexShader* bound_vs            = nullptr;
+
 	// Buffers
 	ConstantBuffer<AltCameraBuffer> alt_cam_buffer;
+
+	// The models drawn by the last pre-pass. Kept to reuse its capacity.
+	struct PrepassModel {
+		const ModelProxy* model;
+		u32               lod;
+		f32               depth;
+	};
+	mutable std::vector<PrepassModel> prepass_models;
 };
 
 } //namespace render
@@ -0,0 +1,138 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "datatypes/types.h"
+
+#include "directx/d3d11.h"
+#include "directx/directxtk.h"
+#include "hlsl.h"
+
+module rendering;
+
+import :pipeline;
+import :shader_factory;
+
+
+namespace render {
+
+HiZPass::HiZPass(ID3D11Device& device,
+                 ID3D11DeviceContext& device_context,
+                 ResourceMgr& resource_mgr)
+	: device(device)
+	, device_context(device_context)
+	, hi_z_buffer(device) {
+
+	hi_z_shader = ShaderFactory::CreateHiZCS(resource_mgr);
+}
+
+
+void HiZPass::createMipChain(u32_2 resolution) {
+	chain_resolution = resolution;
+	mip_srvs.clear();
+	mip_uavs.clear();
+
+	//----------------------------------------------------------------------------------
+	// Texture
+	//----------------------------------------------------------------------------------
+	ComPtr<ID3D11Texture2D> texture;
+
+	D3D11_TEXTURE2D_DESC texture_desc = {};
+	texture_desc.Width            = resolution[0];
+	texture_desc.Height           = resolution[1];
+	texture_desc.MipLevels        = static_cast<u32>(std::bit_width(std::max(resolution[0], resolution[1])));
+	texture_desc.ArraySize        = 1;
+	texture_desc.Format           = DXGI_FORMAT_R32_FLOAT;
+	texture_desc.SampleDesc.Count = 1;
+	texture_desc.Usage            = D3D11_USAGE_DEFAULT;
+	texture_desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+
+	ThrowIfFailed(device.CreateTexture2D(&texture_desc,
+	                                     nullptr,
+	                                     texture.ReleaseAndGetAddressOf()),
+	              "Failed to create Hi-Z Texture2D");
+
+	//----------------------------------------------------------------------------------
+	// Shader Resource View (full chain)
+	//----------------------------------------------------------------------------------
+	D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+	srv_desc.Format                    = texture_desc.Format;
+	srv_desc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srv_desc.Texture2D.MostDetailedMip = 0;
+	srv_desc.Texture2D.MipLevels       = texture_desc.MipLevels;
+
+	ThrowIfFailed(device.CreateShaderResourceView(texture.Get(), &srv_desc, srv.ReleaseAndGetAddressOf()),
+	              "Failed to create Hi-Z Shader Resource View");
+
+	SetDebugObjectName(srv.Get(), "HiZPass SRV");
+
+	//----------------------------------------------------------------------------------
+	// Views of each mip
+	//----------------------------------------------------------------------------------
+	for (u32 mip = 0; mip < texture_desc.MipLevels; ++mip) {
+		srv_desc.Texture2D.MostDetailedMip = mip;
+		srv_desc.Texture2D.MipLevels       = 1;
+
+		ThrowIfFailed(device.CreateShaderResourceView(texture.Get(), &srv_desc, mip_srvs.emplace_back().GetAddressOf()),
+		              "Failed to create Hi-Z mip Shader Resource View");
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc = {};
+		uav_desc.Format             = texture_desc.Format;
+		uav_desc.ViewDimension      = D3D11_UAV_DIMENSION_TEXTURE2D;
+		uav_desc.Texture2D.MipSlice = mip;
+
+		ThrowIfFailed(device.CreateUnorderedAccessView(texture.Get(), &uav_desc, mip_uavs.emplace_back().GetAddressOf()),
+		              "Failed to create Hi-Z mip Unordered Access View");
+
+		SetDebugObjectName(mip_srvs.back().Get(), "HiZPass Mip SRV");
+		SetDebugObjectName(mip_uavs.back().Get(), "HiZPass Mip UAV");
+	}
+}
+
+
+void HiZPass::render(ID3D11ShaderResourceView* depth_srv, u32_2 resolution) {
+	if ((resolution[0] == 0) or (resolution[1] == 0))
+		return;
+
+	// The chain is about to be written, so it can't stay bound for reading
+	Pipeline::PS::bindSRV(device_context, SLOT_SRV_HI_Z, nullptr);
+	Pipeline::CS::bindSRV(device_context, SLOT_SRV_HI_Z, nullptr);
+
+	if (resolution != chain_resolution)
+		createMipChain(resolution);
+
+	hi_z_shader->bind(device_context);
+	hi_z_buffer.bind<Pipeline::CS>(device_context, SLOT_CBUFFER_HI_Z);
+
+	u32_2 input_size = resolution;
+	for (size_t mip = 0; mip < mip_uavs.size(); ++mip) {
+		const u32_2 output_size = {
+			std::max(resolution[0] >> mip, 1u),
+			std::max(resolution[1] >> mip, 1u)
+		};
+
+		hi_z_buffer.updateData(device_context, HiZBuffer{input_size, output_size});
+
+		// Bind the output before the input, so the previous mip is no longer bound for
+		// writing when it's bound for reading
+		Pipeline::CS::bindUAV(device_context, SLOT_UAV_HI_Z, mip_uavs[mip].Get());
+		Pipeline::CS::bindSRV(device_context, SLOT_SRV_DEPTH, (mip == 0) ? depth_srv : mip_srvs[mip - 1].Get());
+
+		Pipeline::dispatch(device_context,
+		                   (output_size[0] + HI_Z_GROUP_SIZE - 1) / HI_Z_GROUP_SIZE,
+		                   (output_size[1] + HI_Z_GROUP_SIZE - 1) / HI_Z_GROUP_SIZE);
+
+		input_size = output_size;
+	}
+
+	// Unbind the views, and bind the chain for the passes that test against it
+	Pipeline::CS::bindSRV(device_context, SLOT_SRV_DEPTH, nullptr);
+	Pipeline::CS::bindUAV(device_context, SLOT_UAV_HI_Z, nullptr);
+
+	Pipeline::PS::bindSRV(device_context, SLOT_SRV_HI_Z, srv.Get());
+	Pipeline::CS::bindSRV(device_context, SLOT_SRV_HI_Z, srv.Get());
+}
+
+} //namespace render
@@ -0,0 +1,103 @@
+module;
+
+#include <memory>
+#include <vector>
+
+#include "datatypes/types.h"
+#include "directx/d3d11.h"
+
+export module rendering:pass.hi_z_pass;
+
+import :buffer_types;
+import :constant_buffer;
+import :resource_mgr;
+import :shader;
+
+namespace render {
+
+//----------------------------------------------------------------------------------
+// HiZPass
+//----------------------------------------------------------------------------------
+//
+// Builds a hierarchical depth (Hi-Z) mip chain from the depth buffer. The first mip
+// is a copy of the depth buffer, and each texel of the following mips holds the
+// farthest depth of the texels it covers in the previous mip. A surface whose nearest
+// depth is farther than the Hi-Z texels covering its screen bounds is hidden, so an
+// occlusion test only needs a few texel reads at a coarse enough mip.
+//
+// Once built, the mip chain is bound to SLOT_SRV_HI_Z of the pixel and compute stages.
+//
+//----------------------------------------------------------------------------------
+export class HiZPass final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	HiZPass(ID3D11Device& device,
+	        ID3D11DeviceContext& device_context,
+	        ResourceMgr& resource_mgr);
+
+	HiZPass(const HiZPass&) = delete;
+	HiZPass(HiZPass&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~HiZPass() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	HiZPass& operator=(const HiZPass&) = delete;
+	HiZPass& operator=(HiZPass&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Build the mip chain from a depth buffer with the given resolution. The depth buffer
+	// must not be bound for output. The mip chain is recreated if the resolution changed.
+	void render(ID3D11ShaderResourceView* depth_srv, u32_2 resolution);
+
+	// The SRV of the full mip chain. Null until the first render.
+	[[nodiscard]]
+	ID3D11ShaderResourceView* getSRV() const noexcept {
+		return srv.Get();
+	}
+
+	[[nodiscard]]
+	u32 getMipCount() const noexcept {
+		return static_cast<u32>(mip_uavs.size());
+	}
+
+private:
+
+	void createMipChain(u32_2 resolution);
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// Dependency References
+	ID3D11Device&        device;
+	ID3D11DeviceContext& device_context;
+
+	// Shaders
+	std::shared_ptr<ComputeShader> hi_z_shader;
+
+	// Buffers
+	ConstantBuffer<HiZBuffer> hi_z_buffer;
+
+	// The resolution of the mip chain, the SRV of the whole chain, and an SRV and UAV of
+	// each mip
+	u32_2                                          chain_resolution = {};
+	ComPtr<ID3D11ShaderResourceView>               srv;
+	std::vector<ComPtr<ID3D11ShaderResourceView>>  mip_srvs;
+	std::vector<ComPtr<ID3D11UnorderedAccessView>> mip_uavs;
+};
+
+} //namespace render
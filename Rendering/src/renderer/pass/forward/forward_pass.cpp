@@ -2,20 +2,15 @@ module;
 
 #include <DirectXMath.h>
 
-#include "memory/handle/handle.h"
-
 #include "hlsl.h"
 #include "directx/d3d11.h"
 
 module rendering;
 
-import ecs;
-import :components.model;
-import :components.transform;
-
 import math.geometry;
 
 import :pipeline;
+import :render_snapshot;
 import :rendering_options;
 import :render_state_mgr;
 import :resource_mgr;
@@ -34,12 +29,13 @@ ForwardPass::ForwardPass(ID3D11Device& device,
     , resource_mgr(resource_mgr)
     , color_buffer(device) {
 
-	vertex_shader  = ShaderFactory::CreateForwardVS(resource_mgr);
-	gbuffer_shader = ShaderFactory::CreateGBufferPS(resource_mgr);
+	vertex_shader           = ShaderFactory::CreateForwardVS(resource_mgr);
+	quantized_vertex_shader = ShaderFactory::CreateForwardVS(resource_mgr, true);
+	gbuffer_shader          = ShaderFactory::CreateGBufferPS(resource_mgr);
 }
 
 
-void ForwardPass::bindOpaqueState() const {
+void ForwardPass::bindOpaqueState(DepthStencilStates depth_state) const {
 
 	// Bind topology
 	Pipeline::IA::bindPrimitiveTopology(device_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -50,11 +46,12 @@ void ForwardPass::bindOpaqueState() const {
 	Pipeline::HS::bindShader(device_context, nullptr, {});
 
 	// Bind shaders
-	vertex_shader->bind(device_context);
+	bound_vertex_shader = nullptr;
+	bindVertexShader(false);
 
 	// Bind render states
 	render_state_mgr.bind(device_context, BlendStates::Opaque);
-	render_state_mgr.bind(device_context, DepthStencilStates::LessEqRW);
+	render_state_mgr.bind(device_context, depth_state);
 	render_state_mgr.bind(device_context, RasterStates::CullCounterClockwise);
 }
 
@@ -70,7 +67,8 @@ void ForwardPass::bindTransparentState() const {
 	Pipeline::HS::bindShader(device_context, nullptr, {});
 
 	// Bind shaders
-	vertex_shader->bind(device_context);
+	bound_vertex_shader = nullptr;
+	bindVertexShader(false);
 
 	// Bind render states
 	render_state_mgr.bind(device_context, BlendStates::NonPremultiplied);
@@ -92,7 +90,8 @@ void ForwardPass::bindWireframeState() const {
 	color_buffer.bind<Pipeline::PS>(device_context, SLOT_CBUFFER_COLOR);
 
 	// Bind shaders
-	vertex_shader->bind(device_context);
+	bound_vertex_shader = nullptr;
+	bindVertexShader(false);
 
 	// Bind render states
 	render_state_mgr.bind(device_context, BlendStates::Opaque);
@@ -101,13 +100,25 @@ void ForwardPass::bindWireframeState() const {
 }
 
 
-void XM_CALLCONV ForwardPass::renderOpaque(const ecs::ECS& ecs,
+void ForwardPass::bindVertexShader(bool quantized) const {
+	const auto& shader = quantized ? quantized_vertex_shader : vertex_shader;
+	if (shader.get() == bound_vertex_shader)
+		return;
+
+	shader->bind(device_context);
+	bound_vertex_shader = shader.get();
+}
+
+
+void XM_CALLCONV ForwardPass::renderOpaque(const RenderView& view,
                                            FXMMATRIX world_to_projection,
                                            const Texture* env_map,
-                                           BRDF brdf) const {
+                                           BRDF brdf,
+                                           bool depth_prepass) const {
 
-	// Bind the vertex shader, render states, etc
-	bindOpaqueState();
+	// Bind the vertex shader, render states, etc. The depth was already written by the
+	// pre-pass, so only the nearest surface of each pixel passes an equal test.
+	bindOpaqueState(depth_prepass ? DepthStencilStates::EqualR : DepthStencilStates::LessEqRW);
 
 	// Bind the skybox texture as the environment map
 	if (env_map) env_map->bind<Pipeline::PS>(device_context, SLOT_SRV_ENV_MAP);
@@ -117,23 +128,17 @@ void XM_CALLCONV ForwardPass::renderOpaque(const ecs::ECS& ecs,
 	pixel_shader->bind(device_context);
 
 	// Render models
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model     = ecs.get<Model>(entity);
-		const auto& transform = ecs.get<Transform>(entity);
-
-		if (not model.isActive())
-			return;
-
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
 		const auto& mat = model.getMaterial();
 		if (mat.shader || mat.params.base_color[3] <= ALPHA_MAX)
 			return;
 
-		renderModel(model, transform, world_to_projection);
+		renderModel(model, lod, world_to_projection);
 	});
 }
 
 
-void XM_CALLCONV ForwardPass::renderTransparent(const ecs::ECS& ecs,
+void XM_CALLCONV ForwardPass::renderTransparent(const RenderView& view,
                                                 FXMMATRIX world_to_projection,
                                                 const Texture* env_map,
                                                 BRDF brdf) const {
@@ -149,40 +154,31 @@ void XM_CALLCONV ForwardPass::renderTransparent(const ecs::ECS& ecs,
 	pixel_shader->bind(device_context);
 
 	// Render models
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model     = ecs.get<Model>(entity);
-		const auto& transform = ecs.get<Transform>(entity);
-
-		if (not model.isActive())
-			return;
-
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
 		const auto& mat = model.getMaterial();
 		if (mat.shader ||
 		    mat.params.base_color[3] < ALPHA_MIN || mat.params.base_color[3] > ALPHA_MAX)
 			return;
 
-		renderModel(model, transform, world_to_projection);
+		renderModel(model, lod, world_to_projection);
 	});
 }
 
 
-void XM_CALLCONV ForwardPass::renderOverrided(const ecs::ECS& ecs, FXMMATRIX world_to_projection, const Texture* env_map) const {
+void XM_CALLCONV ForwardPass::renderOverrided(const RenderView& view, FXMMATRIX world_to_projection, const Texture* env_map) const {
 
 	//----------------------------------------------------------------------------------
 	// Sort models by shader type
 	//----------------------------------------------------------------------------------
-	std::unordered_map<PixelShader*, std::vector<const Model*>> sorted_models;
+	std::unordered_map<PixelShader*, std::vector<std::pair<const ModelProxy*, u32>>> sorted_models;
 
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model = ecs.get<Model>(entity);
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
 		auto& mat = model.getMaterial();
 
-		if (not model.isActive())
-			return;
 		if (not mat.shader)
 			return;
 
-		sorted_models[mat.shader.get()].push_back(&model);
+		sorted_models[mat.shader.get()].emplace_back(&model, lod);
 	});
 
 
@@ -200,14 +196,13 @@ void XM_CALLCONV ForwardPass::renderOverrided(const ecs::ECS& ecs, FXMMATRIX wor
 	for (auto& [shader, model_vec] : sorted_models) {
 		shader->bind(device_context);
 
-		for (const auto* model : model_vec) {
-			const auto& transform = ecs.get<Transform>(model->getOwner());
+		for (const auto [model, lod] : model_vec) {
 			const auto& mat = model->getMaterial();
 
 			if (mat.params.base_color[3] <= ALPHA_MAX)
 				continue;
 
-			renderModel(*model, transform, world_to_projection);
+			renderModel(*model, lod, world_to_projection);
 		}
 	}
 
@@ -219,20 +214,19 @@ void XM_CALLCONV ForwardPass::renderOverrided(const ecs::ECS& ecs, FXMMATRIX wor
 	for (auto& [shader, model_vec] : sorted_models) {
 		shader->bind(device_context);
 
-		for (const auto* model : model_vec) {
-			const auto& transform = ecs.get<Transform>(model->getOwner());
+		for (const auto [model, lod] : model_vec) {
 			const auto& mat = model->getMaterial();
 
 			if (mat.params.base_color[3] < ALPHA_MIN || mat.params.base_color[3] > ALPHA_MAX)
 				continue;
 
-			renderModel(*model, transform, world_to_projection);
+			renderModel(*model, lod, world_to_projection);
 		}
 	}
 }
 
 
-void ForwardPass::renderFalseColor(const ecs::ECS& ecs,
+void ForwardPass::renderFalseColor(const RenderView& view,
                                    FXMMATRIX world_to_projection,
                                    FalseColor color) const {
 
@@ -241,17 +235,13 @@ void ForwardPass::renderFalseColor(const ecs::ECS& ecs,
 	auto pixel_shader = ShaderFactory::CreateFalseColorPS(resource_mgr, color);
 	pixel_shader->bind(device_context);
 
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model     = ecs.get<Model>(entity);
-		const auto& transform = ecs.get<Transform>(entity);
-
-		if (model.isActive())
-			renderModel(model, transform, world_to_projection);
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
+		renderModel(model, lod, world_to_projection);
 	});
 }
 
 
-void ForwardPass::renderWireframe(const ecs::ECS& ecs, FXMMATRIX world_to_projection, const f32_4& color) const {
+void ForwardPass::renderWireframe(const RenderView& view, FXMMATRIX world_to_projection, const f32_4& color) const {
 
 	bindWireframeState();
 
@@ -260,48 +250,38 @@ void ForwardPass::renderWireframe(const ecs::ECS& ecs, FXMMATRIX world_to_projec
 	auto pixel_shader = ShaderFactory::CreateFalseColorPS(resource_mgr, FalseColor::Static);
 	pixel_shader->bind(device_context);
 
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model     = ecs.get<Model>(entity);
-		const auto& transform = ecs.get<Transform>(entity);
-
-		if (model.isActive())
-			renderModel(model, transform, world_to_projection);
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
+		renderModel(model, lod, world_to_projection);
 	});
 }
 
 
-void XM_CALLCONV ForwardPass::renderGBuffer(const ecs::ECS& ecs, FXMMATRIX world_to_projection) const {
+void XM_CALLCONV ForwardPass::renderGBuffer(const RenderView& view, FXMMATRIX world_to_projection) const {
 
 	bindOpaqueState();
 
 	gbuffer_shader->bind(device_context);
 
-	ecs.forEach<Model, Transform>([&](handle64 entity) {
-		const auto& model     = ecs.get<Model>(entity);
-		const auto& transform = ecs.get<Transform>(entity);
-
-		if (not model.isActive())
-			return;
-
+	view.forEachModel([&](const ModelProxy& model, u32 lod) {
 		const auto& mat = model.getMaterial();
 		if (mat.shader || mat.params.base_color[3] <= ALPHA_MAX)
 			return;
 
-		renderModel(model, transform, world_to_projection);
+		renderModel(model, lod, world_to_projection);
 	});
 }
 
 
-void XM_CALLCONV ForwardPass::renderModel(const Model& model, const Transform& transform, FXMMATRIX world_to_projection) const {
-	const auto model_to_world = transform.getObjectToWorldMatrix();
-	const auto model_to_proj = model_to_world * world_to_projection;
+void XM_CALLCONV ForwardPass::renderModel(const ModelProxy& model, u32 lod, FXMMATRIX world_to_projection) const {
+	const auto model_to_proj = model.object_to_world * world_to_projection;
 
 	// Cull the model if it isn't on screen
 	if (not Frustum(model_to_proj).contains(model.getAABB()))
 		return;
 
-	// Bind the model's mesh
+	// Bind the model's mesh, and the vertex shader for its vertex format
 	model.bindMesh(device_context);
+	bindVertexShader(model.hasQuantizedVertices());
 
 	// Get the model's material
 	const auto& mat = model.getMaterial();
@@ -316,8 +296,9 @@ void XM_CALLCONV ForwardPass::renderModel(const Model& model, const Transform& t
 	if (mat.maps.normal) mat.maps.normal->bind<Pipeline::PS>(device_context, SLOT_SRV_NORMAL);
 	if (mat.maps.emissive) mat.maps.emissive->bind<Pipeline::PS>(device_context, SLOT_SRV_EMISSIVE);
 
-	// Draw the model
-	Pipeline::drawIndexed(device_context, model.getIndexCount(), 0);
+	// Draw the level of detail selected for the camera
+	const auto& range = model.getLODRange(lod);
+	Pipeline::drawIndexed(device_context, range.index_count, range.index_offset);
 
 	// Unbind the SRVs
 	Pipeline::PS::bindSRV(device_context, SLOT_SRV_BASE_COLOR, nullptr);
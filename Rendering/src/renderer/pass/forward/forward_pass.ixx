@@ -7,11 +7,9 @@ module;
 
 export module rendering:pass.forward_pass;
 
-import ecs;
-import :components.model;
-import :components.transform;
 import :constant_buffer;
 import :pipeline;
+import :render_snapshot;
 import :render_state_mgr;
 import :rendering_options;
 import :resource_mgr;
@@ -53,25 +51,28 @@ public:
 	// Member Functions - Render With Specified Mode
 	//----------------------------------------------------------------------------------
 
-	// Render all (opaque) models with a given BRDF
-	void XM_CALLCONV renderOpaque(const ecs::ECS& ecs,
+	// Render all (opaque) models with a given BRDF. If depth_prepass is true, the depth
+	// buffer already holds the depth of these models (DepthPass::renderPrepass), and only
+	// the surfaces with an equal depth are shaded.
+	void XM_CALLCONV renderOpaque(const RenderView& view,
 	                              FXMMATRIX world_to_projection,
 	                              const Texture* env_map,
-	                              BRDF brdf) const;
+	                              BRDF brdf,
+	                              bool depth_prepass = false) const;
 
 	// Render all (transparent) models with a given BRDF
-	void XM_CALLCONV renderTransparent(const ecs::ECS& ecs,
+	void XM_CALLCONV renderTransparent(const RenderView& view,
 	                                   FXMMATRIX world_to_projection,
 	                                   const Texture* env_map,
 	                                   BRDF brdf) const;
 
 	// Render all models with the given false color mode
-	void XM_CALLCONV renderFalseColor(const ecs::ECS& ecs,
+	void XM_CALLCONV renderFalseColor(const RenderView& view,
 	                                  FXMMATRIX world_to_projection,
 	                                  FalseColor color) const;
 
 	// Render all models as a wireframe
-	void XM_CALLCONV renderWireframe(const ecs::ECS& ecs,
+	void XM_CALLCONV renderWireframe(const RenderView& view,
 	                                 FXMMATRIX world_to_projection,
 	                                 const f32_4& color) const;
 
@@ -82,7 +83,7 @@ public:
 
 	// Sorts by shader type all models with overrided shaders, then renders them.
 	// Renders opaque models, then transparent. Call between opaque and transparent render passes.
-	void XM_CALLCONV renderOverrided(const ecs::ECS& ecs,
+	void XM_CALLCONV renderOverrided(const RenderView& view,
 	                                 FXMMATRIX world_to_projection,
 	                                 const Texture* env_map) const;
 
@@ -90,22 +91,25 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions - Render to GBuffer
 	//----------------------------------------------------------------------------------
-	void XM_CALLCONV renderGBuffer(const ecs::ECS& ecs, FXMMATRIX world_to_projection) const;
+	void XM_CALLCONV renderGBuffer(const RenderView& view, FXMMATRIX world_to_projection) const;
 
 private:
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - Bind State
 	//----------------------------------------------------------------------------------
-	void bindOpaqueState() const;
+	void bindOpaqueState(DepthStencilStates depth_state = DepthStencilStates::LessEqRW) const;
 	void bindTransparentState() const;
 	void bindWireframeState() const;
 
+	// Bind the vertex shader matching a model's vertex format, if it isn't already bound
+	void bindVertexShader(bool quantized) const;
+
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - Render Model
 	//----------------------------------------------------------------------------------
-	void XM_CALLCONV renderModel(const Model& model, const Transform& transform, FXMMATRIX world_to_projection) const;
+	void XM_CALLCONV renderModel(const ModelProxy& model, u32 lod, FXMMATRIX world_to_projection) const;
 
 
 	//----------------------------------------------------------------------------------
@@ -119,8 +123,12 @@ private:
 
 	// Shaders
 	std::shared_ptr<VertexShader> vertex_shader;
+	std::shared_ptr<VertexShader> quantized_vertex_shader;
 	std::shared_ptr<PixelShader>  gbuffer_shader;
 
+	// The vertex shader bound by the last model. Reset when the pass state is bound.
+	mutable const VertexShader* bound_vertex_shader = nullptr;
+
 	// Buffers
 	ConstantBuffer<f32_4> color_buffer;
 };
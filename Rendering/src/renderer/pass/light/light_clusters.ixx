@@ -0,0 +1,329 @@
+module;
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/types.h"
+
+export module rendering:pass.light_clusters;
+
+import math.geometry;
+import math.directxmath;
+
+using namespace DirectX;
+
+namespace render {
+
+//----------------------------------------------------------------------------------
+// LightClusters
+//----------------------------------------------------------------------------------
+//
+// Divides a camera's view frustum into a 3D grid of clusters (screen space tiles,
+// split into exponentially distributed depth slices) and builds a compact list of
+// the point and spot lights that affect each cluster. The shaders find the cluster
+// a point is in and only iterate over its lights.
+//
+// Lights are binned by their world space bounding sphere. For each depth slice the
+// sphere overlaps, the sphere's cross section within the slice is projected to
+// find the range of tiles it covers.
+//
+// This class only builds the cluster data and has no GPU resources.
+//
+//----------------------------------------------------------------------------------
+export class LightClusters final {
+public:
+	// Matches the uint2 read by the shaders
+	struct Cluster {
+		// The index of the cluster's first light in the light index list
+		u32 offset = 0;
+
+		// The number of point lights (low 16 bits) and spot lights (high 16 bits) in
+		// the cluster. The point light indices are listed before the spot light indices.
+		u32 counts = 0;
+	};
+
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	LightClusters(const u32_3& dimensions) {
+		setDimensions(dimensions);
+	}
+
+	LightClusters(const LightClusters&) = default;
+	LightClusters(LightClusters&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~LightClusters() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	LightClusters& operator=(const LightClusters&) = default;
+	LightClusters& operator=(LightClusters&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Set the number of tiles along the x and y axes, and the number of depth slices
+	void setDimensions(const u32_3& new_dimensions) {
+		dimensions = {
+			std::max(new_dimensions[0], 1u),
+			std::max(new_dimensions[1], 1u),
+			std::max(new_dimensions[2], 1u)
+		};
+		clusters.assign(getClusterCount(), Cluster{});
+		light_indices.clear();
+	}
+
+	//  world_to_camera/camera_to_projection: the matrices of the camera being clustered
+	//                               z_depth: the camera's near and far plane distances
+	//              point_lights/spot_lights: the world space bounds of the lights. The
+	//                                        index of a light in its span is the index
+	//                                        written to the light index list.
+	void XM_CALLCONV update(FXMMATRIX world_to_camera,
+	                        CXMMATRIX camera_to_projection,
+	                        const f32_2& z_depth,
+	                        std::span<const BoundingSphere> point_lights,
+	                        std::span<const BoundingSphere> spot_lights) {
+
+		// Exponential depth slicing: slice = log(z) * z_scale + z_bias
+		z_near = std::max(z_depth[0], 0.0001f);
+		z_far  = std::max(z_depth[1], z_near + 0.001f);
+
+		const f32 log_ratio = std::log(z_far / z_near);
+		z_scale = static_cast<f32>(dimensions[2]) / log_ratio;
+		z_bias  = -static_cast<f32>(dimensions[2]) * std::log(z_near) / log_ratio;
+
+		// Find the clusters each light overlaps
+		point_spans.clear();
+		spot_spans.clear();
+
+		for (u32 i = 0; i < point_lights.size(); ++i) {
+			binLight(i, world_to_camera, camera_to_projection, point_lights[i], point_spans);
+		}
+		for (u32 i = 0; i < spot_lights.size(); ++i) {
+			binLight(i, world_to_camera, camera_to_projection, spot_lights[i], spot_spans);
+		}
+
+		// Count the lights in each cluster
+		const u32 cluster_count = getClusterCount();
+		point_counts.assign(cluster_count, 0);
+		spot_counts.assign(cluster_count, 0);
+
+		for (const auto& span : point_spans) {
+			forEachCluster(span, [this](u32 cluster) { ++point_counts[cluster]; });
+		}
+		for (const auto& span : spot_spans) {
+			forEachCluster(span, [this](u32 cluster) { ++spot_counts[cluster]; });
+		}
+
+		// Lay out the light index list. The counts are reused as write cursors. The shader
+		// reads 16-bit counts, so a cluster's lights past 0xFFFF of either type are dropped
+		// before the offsets are computed.
+		u32 offset = 0;
+		for (u32 i = 0; i < cluster_count; ++i) {
+			const u32 num_points = std::min(point_counts[i], 0xFFFFu);
+			const u32 num_spots  = std::min(spot_counts[i], 0xFFFFu);
+
+			clusters[i].offset = offset;
+			clusters[i].counts = num_points | (num_spots << 16);
+
+			point_counts[i] = offset;
+			spot_counts[i]  = offset + num_points;
+			offset += num_points + num_spots;
+		}
+
+		// Write the light indices. A cursor stops at the end of its cluster's clamped range.
+		light_indices.resize(offset);
+
+		for (const auto& span : point_spans) {
+			forEachCluster(span, [this, &span](u32 cluster) {
+				const auto& c   = clusters[cluster];
+				const u32   end = c.offset + (c.counts & 0xFFFFu);
+				if (point_counts[cluster] < end)
+					light_indices[point_counts[cluster]++] = span.light;
+			});
+		}
+		for (const auto& span : spot_spans) {
+			forEachCluster(span, [this, &span](u32 cluster) {
+				const auto& c   = clusters[cluster];
+				const u32   end = c.offset + (c.counts & 0xFFFFu) + (c.counts >> 16);
+				if (spot_counts[cluster] < end)
+					light_indices[spot_counts[cluster]++] = span.light;
+			});
+		}
+	}
+
+	[[nodiscard]]
+	const u32_3& getDimensions() const noexcept {
+		return dimensions;
+	}
+
+	[[nodiscard]]
+	u32 getClusterCount() const noexcept {
+		return dimensions[0] * dimensions[1] * dimensions[2];
+	}
+
+	// Get the index of the cluster at the specified tile and depth slice
+	[[nodiscard]]
+	u32 getClusterIndex(u32 x, u32 y, u32 slice) const noexcept {
+		return (((slice * dimensions[1]) + y) * dimensions[0]) + x;
+	}
+
+	// Get the depth slice that contains a camera space depth
+	[[nodiscard]]
+	u32 getSlice(f32 depth) const noexcept {
+		const f32 slice = std::floor((std::log(std::max(depth, z_near)) * z_scale) + z_bias);
+		return static_cast<u32>(std::clamp(slice, 0.0f, static_cast<f32>(dimensions[2] - 1)));
+	}
+
+	// Get the camera space depth of the near plane of a depth slice
+	[[nodiscard]]
+	f32 getSliceDepth(u32 slice) const noexcept {
+		return z_near * std::pow(z_far / z_near, static_cast<f32>(slice) / static_cast<f32>(dimensions[2]));
+	}
+
+	// The scale and bias that map log(depth) to a depth slice
+	[[nodiscard]]
+	f32 getZScale() const noexcept {
+		return z_scale;
+	}
+
+	[[nodiscard]]
+	f32 getZBias() const noexcept {
+		return z_bias;
+	}
+
+	[[nodiscard]]
+	const std::vector<Cluster>& getClusters() const noexcept {
+		return clusters;
+	}
+
+	[[nodiscard]]
+	const std::vector<u32>& getLightIndices() const noexcept {
+		return light_indices;
+	}
+
+private:
+
+	// A range of tiles within a single depth slice that a light overlaps
+	struct Span {
+		u32   light = 0;
+		u32   slice = 0;
+		u32_2 min_tile = {};
+		u32_2 max_tile = {};
+	};
+
+	template<typename FunctionT>
+	void forEachCluster(const Span& span, FunctionT&& func) const {
+		for (u32 y = span.min_tile[1]; y <= span.max_tile[1]; ++y) {
+			for (u32 x = span.min_tile[0]; x <= span.max_tile[0]; ++x) {
+				func(getClusterIndex(x, y, span.slice));
+			}
+		}
+	}
+
+	void XM_CALLCONV binLight(u32 light,
+	                          FXMMATRIX world_to_camera,
+	                          CXMMATRIX camera_to_projection,
+	                          const BoundingSphere& sphere,
+	                          std::vector<Span>& spans) const {
+		f32_3 center;
+		XMStore(&center, XMVector3TransformCoord(sphere.center(), world_to_camera));
+		const f32 radius = sphere.radius();
+
+		// The part of the sphere's depth range within the view
+		const f32 z_min = std::max(center[2] - radius, z_near);
+		const f32 z_max = std::min(center[2] + radius, z_far);
+		if (z_min > z_max)
+			return;
+
+		const u32 first_slice = getSlice(z_min);
+		const u32 last_slice  = getSlice(z_max);
+
+		for (u32 slice = first_slice; slice <= last_slice; ++slice) {
+			// The part of the sphere's depth range within the slice
+			const f32 slab_near = std::max(getSliceDepth(slice), z_min);
+			const f32 slab_far  = std::max(std::min(getSliceDepth(slice + 1), z_max), slab_near);
+
+			// The radius of the sphere's largest cross section within the slice
+			const f32 dist = std::max({slab_near - center[2], center[2] - slab_far, 0.0f});
+			const f32 r    = std::sqrt(std::max((radius * radius) - (dist * dist), 0.0f));
+
+			// Project the box around the cross section. The box is in front of the near
+			// plane, so its projection is bounded by the projection of its corners.
+			XMVECTOR ndc_min = XMVectorReplicate(FLT_MAX);
+			XMVECTOR ndc_max = XMVectorReplicate(-FLT_MAX);
+
+			for (u32 i = 0; i < 8; ++i) {
+				const auto corner = XMVectorSet(center[0] + ((i & 1) ? r : -r),
+				                                center[1] + ((i & 2) ? r : -r),
+				                                (i & 4) ? slab_far : slab_near,
+				                                1.0f);
+				const auto ndc = XMVector3TransformCoord(corner, camera_to_projection);
+
+				ndc_min = XMVectorMin(ndc_min, ndc);
+				ndc_max = XMVectorMax(ndc_max, ndc);
+			}
+
+			f32_2 lo;
+			f32_2 hi;
+			XMStore(&lo, ndc_min);
+			XMStore(&hi, ndc_max);
+
+			if ((lo[0] > 1.0f) or (hi[0] < -1.0f) or (lo[1] > 1.0f) or (hi[1] < -1.0f))
+				continue;
+
+			// Convert to tiles. NDC y points up, while the tile rows go down the screen.
+			const auto to_tile = [](f32 uv, u32 count) {
+				return static_cast<u32>(std::clamp(uv * static_cast<f32>(count), 0.0f, static_cast<f32>(count - 1)));
+			};
+
+			Span span;
+			span.light    = light;
+			span.slice    = slice;
+			span.min_tile = {to_tile((lo[0] * 0.5f) + 0.5f, dimensions[0]), to_tile(0.5f - (hi[1] * 0.5f), dimensions[1])};
+			span.max_tile = {to_tile((hi[0] * 0.5f) + 0.5f, dimensions[0]), to_tile(0.5f - (lo[1] * 0.5f), dimensions[1])};
+
+			spans.push_back(span);
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// The number of tiles along the x and y axes, and the number of depth slices
+	u32_3 dimensions = {};
+
+	// The depth range being clustered, and the log(depth) to slice mapping
+	f32 z_near  = 0.1f;
+	f32 z_far   = 1.0f;
+	f32 z_scale = 0.0f;
+	f32 z_bias  = 0.0f;
+
+	// The output cluster data
+	std::vector<Cluster> clusters;
+	std::vector<u32>     light_indices;
+
+	// Scratch buffers (kept to avoid reallocating every frame)
+	std::vector<Span> point_spans;
+	std::vector<Span> spot_spans;
+	std::vector<u32>  point_counts;
+	std::vector<u32>  spot_counts;
+};
+
+} //namespace render
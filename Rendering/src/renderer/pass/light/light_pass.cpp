@@ -1,6 +1,13 @@
 module;
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 #include <DirectXMath.h>
 
@@ -14,13 +21,6 @@ module;
 
 module rendering;
 
-import ecs;
-import :components.transform;
-import :components.light.ambient_light;
-import :components.light.directional_light;
-import :components.light.point_light;
-import :components.light.spot_light;
-
 import math.geometry;
 import math.directxmath;
 
@@ -28,16 +28,81 @@ import :buffer_types;
 import :constant_buffer;
 import :pass.depth_pass;
 import :pipeline;
+import :render_snapshot;
 import :render_state_mgr;
 import :rendering_config;
 import :resource_mgr;
+import :shader;
+import :shader_factory;
 import :shadow_map_buffer;
+import :pass.shadow_atlas;
+import :pass.light_clusters;
 import :structured_buffer;
+import :viewport;
 
 using namespace DirectX;
 
 namespace render {
 
+[[nodiscard]]
+bool XM_CALLCONV MatrixEqual(FXMMATRIX a, CXMMATRIX b) noexcept {
+	return XMVector4Equal(a.r[0], b.r[0])
+	       and XMVector4Equal(a.r[1], b.r[1])
+	       and XMVector4Equal(a.r[2], b.r[2])
+	       and XMVector4Equal(a.r[3], b.r[3]);
+}
+
+// Transform an object space bounding sphere to world space
+[[nodiscard]]
+BoundingSphere XM_CALLCONV TransformBoundingSphere(FXMMATRIX object_to_world, const BoundingSphere& sphere) {
+	const auto center    = XMVector3TransformCoord(sphere.center(), object_to_world);
+	const auto scale_sqr = XMVectorMax(XMVectorMax(XMVector3LengthSq(object_to_world.r[0]),
+	                                               XMVector3LengthSq(object_to_world.r[1])),
+	                                   XMVector3LengthSq(object_to_world.r[2]));
+
+	return BoundingSphere{center, sphere.radius() * XMVectorGetX(XMVectorSqrt(scale_sqr))};
+}
+
+// Estimate the fraction of the screen's height covered by a world space bounding sphere
+[[nodiscard]]
+f32 XM_CALLCONV ScreenCoverage(FXMMATRIX world_to_projection, const BoundingSphere& sphere) {
+	const f32 w = XMVectorGetW(XMVector3Transform(sphere.center(), world_to_projection));
+	const f32 r = sphere.radius();
+
+	// The camera is inside the sphere
+	if (w <= r)
+		return 1.0f;
+
+	// The projection's scale factor is the length of the y column of the world-to-projection matrix
+	const auto projection_to_world = XMMatrixTranspose(world_to_projection);
+	const f32  scale               = XMVectorGetX(XMVector3Length(projection_to_world.r[1]));
+
+	return std::clamp((r * scale) / w, 0.0f, 1.0f);
+}
+
+// The relative luminance of a light's color and intensity
+[[nodiscard]]
+constexpr f32 Luminance(const f32_3& intensity) noexcept {
+	return (0.2126f * intensity[0]) + (0.7152f * intensity[1]) + (0.0722f * intensity[2]);
+}
+
+// Create a viewport that covers a tile of the shadow atlas
+[[nodiscard]]
+Viewport TileViewport(const ShadowAtlas::Tile& tile, f32 min_depth, f32 max_depth) noexcept {
+	Viewport viewport;
+	viewport.setTopLeft(tile.position);
+	viewport.setSize(tile.size, tile.size);
+	viewport.setDepth(min_depth, max_depth);
+	return viewport;
+}
+
+// The smallest tile a light can be given in the shadow atlas
+constexpr u32 min_smap_tile_size = 64;
+
+// The number of light cluster tiles along the x and y axes, and the number of depth slices
+constexpr u32_3 light_cluster_dims = {16, 9, 24};
+
+
 LightPass::LightPass(const RenderingConfig& rendering_config,
                      ID3D11Device& device,
 	                 ID3D11DeviceContext& device_context,
@@ -45,6 +110,7 @@ LightPass::LightPass(const RenderingConfig& rendering_config,
 	                 ResourceMgr& resource_mgr)
 	: device(device)
 	, device_context(device_context)
+	, render_state_mgr(render_state_mgr)
 	, rendering_config(rendering_config)
 
 	, light_buffer(device)
@@ -54,51 +120,95 @@ LightPass::LightPass(const RenderingConfig& rendering_config,
 
 	, shadowed_directional_lights(device, 1)
 	, shadowed_point_lights(device, 1)
-	, shadowed_spot_lights(device, 1) {
+	, shadowed_spot_lights(device, 1)
+
+	, light_clusters(light_cluster_dims)
+	, light_cluster_buffer(device, light_cluster_dims[0] * light_cluster_dims[1] * light_cluster_dims[2])
+	, light_index_buffer(device, 1024)
+
+	, smap_atlas_layout(rendering_config.getShadowMapAtlasRes(), min_smap_tile_size) {
 
 	depth_pass = std::make_unique<DepthPass>(device, device_context, render_state_mgr, resource_mgr);
+	clear_vs   = ShaderFactory::CreateFullscreenQuadVS(resource_mgr);
+	restore_ps = ShaderFactory::CreateDepthRestorePS(resource_mgr);
 
-	directional_light_smaps =
-		std::make_unique<ShadowMapBuffer>(device,
-		                                  1,
-	                                      rendering_config.getShadowMapRes(),
-	                                      rendering_config.getShadowMapDepthBias(),
-	                                      rendering_config.getShadowMapSlopeScaledDepthBias(),
-	                                      rendering_config.getShadowMapDepthBiasClamp());
+	smap_atlas =
+	    std::make_unique<ShadowAtlasBuffer>(device,
+	                                        rendering_config.getShadowMapAtlasRes(),
+	                                        rendering_config.getShadowMapDepthBias(),
+	                                        rendering_config.getShadowMapSlopeScaledDepthBias(),
+	                                        rendering_config.getShadowMapDepthBiasClamp(),
+	                                        rendering_config.isShadowMapStaticCacheEnabled());
 
 	point_light_smaps =
 	    std::make_unique<ShadowCubeMapBuffer>(device,
-	                                          1,
+	                                          std::max(rendering_config.getShadowMapCubeMapCount(), 1u),
 	                                          rendering_config.getShadowMapRes(),
 	                                          rendering_config.getShadowMapDepthBias(),
 	                                          rendering_config.getShadowMapSlopeScaledDepthBias(),
-	                                          rendering_config.getShadowMapDepthBiasClamp());
-
-	spot_light_smaps =
-	    std::make_unique<ShadowMapBuffer>(device,
-	                                      1,
-	                                      rendering_config.getShadowMapRes(),
-	                                      rendering_config.getShadowMapDepthBias(),
-	                                      rendering_config.getShadowMapSlopeScaledDepthBias(),
-	                                      rendering_config.getShadowMapDepthBiasClamp());
+	                                          rendering_config.getShadowMapDepthBiasClamp(),
+	                                          rendering_config.isShadowMapStaticCacheEnabled());
+
+	point_light_smap_states.resize(point_light_smaps->getMapCount());
 }
 
 
-void XM_CALLCONV LightPass::render(const ecs::ECS& ecs, FXMMATRIX world_to_projection) {
+void LightPass::beginFrame(const RenderSnapshot& snapshot) {
 
-	// Update light buffers
-	updateDirectionalLightData(ecs, world_to_projection);
-	updatePointLightData(ecs, world_to_projection);
-	updateSpotLightData(ecs, world_to_projection);
+	++frame;
+
+	// The shadow maps are about to be rendered, so they can't be bound as SRVs
+	unbindShadowMaps();
 
-	// Update the shadow map sizes
+	// Recreate the shadow maps if the config changed
 	updateShadowMaps();
 
-	// Render the shadow maps
-	renderShadowMaps(ecs);
+	// Find the world-space bounds of the point and spot lights
+	updateLightBounds(snapshot);
+
+	// Decide which lights cast shadows this frame, and the size of their shadow maps
+	updateShadowAllocations(snapshot);
+
+	// Find the shadow casters that changed since the last frame
+	updateShadowCasters(snapshot);
+
+	// Render the point and spot light shadow maps. They're shared by every view.
+	updateShadowCameras(snapshot);
+
+	depth_pass->bindState();
+	renderShadowAtlas(snapshot, spot_light_cameras);
+	renderShadowMaps(snapshot, *point_light_smaps, point_light_cameras, point_light_smap_states);
+}
+
+
+void XM_CALLCONV LightPass::render(const RenderView& view,
+                                   FXMMATRIX world_to_camera,
+                                   CXMMATRIX camera_to_projection,
+                                   const f32_2& z_depth,
+                                   bool cluster_lights) {
+
+	const auto world_to_projection = world_to_camera * camera_to_projection;
+
+	// Find the point and spot lights that are visible to the camera
+	updateLightVisibility(world_to_projection);
+
+	// Update light buffers
+	updateDirectionalLightData(view, world_to_projection, z_depth);
+	updatePointLightData(view.snapshot);
+	updateSpotLightData(view.snapshot);
+
+	// Assign the point and spot lights to clusters
+	lights_clustered = cluster_lights;
+	if (cluster_lights)
+		updateLightClusters(world_to_camera, camera_to_projection, z_depth);
+
+	// Render the directional light cascades fitted to this view
+	unbindShadowMaps();
+	depth_pass->bindState();
+	renderShadowAtlas(view.snapshot, directional_light_cameras);
 
 	// Update light info buffer
-	updateData(ecs);
+	updateData(view.snapshot);
 
 	// Bind the buffers
 	bindBuffers();
@@ -123,15 +233,18 @@ void LightPass::bindBuffers() {
 	shadowed_point_lights.bind<Pipeline::PS>(device_context, SLOT_SRV_POINT_LIGHTS_SHADOW);
 	shadowed_spot_lights.bind<Pipeline::PS>(device_context, SLOT_SRV_SPOT_LIGHTS_SHADOW);
 
+	light_cluster_buffer.bind<Pipeline::PS>(device_context, SLOT_SRV_LIGHT_CLUSTERS);
+	light_index_buffer.bind<Pipeline::PS>(device_context, SLOT_SRV_LIGHT_INDICES);
+
 
-	// Bind the shadow buffer SRVs
-	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS, std::span{directional_light_smaps->getSRVAddress(), 1});
+	// Bind the shadow buffer SRVs. Directional and spot lights share the atlas.
+	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS, std::span{smap_atlas->getSRVAddress(), 1});
 	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_POINT_LIGHT_SHADOW_MAPS,       std::span{point_light_smaps->getSRVAddress(), 1});
-	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_SPOT_LIGHT_SHADOW_MAPS,        std::span{spot_light_smaps->getSRVAddress(), 1});
+	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_SPOT_LIGHT_SHADOW_MAPS,        std::span{smap_atlas->getSRVAddress(), 1});
 }
 
 
-void LightPass::updateData(const ecs::ECS& ecs) const {
+void LightPass::updateData(const RenderSnapshot& snapshot) const {
 
 	LightBuffer light_data;
 
@@ -143,17 +256,19 @@ void LightPass::updateData(const ecs::ECS& ecs) const {
 	light_data.num_shadow_point_lights       = static_cast<u32>(shadowed_point_lights.size());
 	light_data.num_shadow_spot_lights        = static_cast<u32>(shadowed_spot_lights.size());
 
-	ecs.forEach<AmbientLight>([&light_data](const AmbientLight& light) {
-		if (not light.isActive())
-			return;
-		light_data.ambient += light.getColor();
-	});
+	if (lights_clustered) {
+		light_data.cluster_dims    = light_clusters.getDimensions();
+		light_data.cluster_z_scale = light_clusters.getZScale();
+		light_data.cluster_z_bias  = light_clusters.getZBias();
+	}
+
+	light_data.ambient = snapshot.ambient_light;
 
 	light_buffer.updateData(device_context, light_data);
 }
 
 
-void LightPass::updateShadowMaps() {
+void LightPass::unbindShadowMaps() {
 
 	// Ensure the slot #defines are consecutive numbers
 	static_assert(SLOT_SRV_POINT_LIGHT_SHADOW_MAPS == SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS + 1);
@@ -162,317 +277,764 @@ void LightPass::updateShadowMaps() {
 	// Clear SRVs
 	ID3D11ShaderResourceView* const srvs[3] = {};
 	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS, std::span{srvs});
+}
+
+
+void LightPass::updateShadowMaps() {
 
 	// Get current shadow map config values
 	const auto config_res = rendering_config.getShadowMapRes();
+	const auto config_atlas_res = rendering_config.getShadowMapAtlasRes();
+	const auto config_cube_count = std::max(rendering_config.getShadowMapCubeMapCount(), 1u);
 	const auto config_db = rendering_config.getShadowMapDepthBias();
 	const auto config_ssdb = rendering_config.getShadowMapSlopeScaledDepthBias();
 	const auto config_dbc = rendering_config.getShadowMapDepthBiasClamp();
+	const auto config_static = rendering_config.isShadowMapStaticCacheEnabled();
+
+	// The buffers have a fixed size, and are only recreated when the config changes. Lights
+	// that don't fit in them are rendered without shadows.
 
-	// Directional Lights
+	// Shadow Atlas (directional and spot lights)
 	{
-		const size_t size      = shadowed_directional_lights.size();
-		const size_t available = directional_light_smaps->getMapCount();
-
-		const auto curr_res  = directional_light_smaps->getMapRes();
-		const auto curr_db   = directional_light_smaps->getDepthBias();
-		const auto curr_ssdb = directional_light_smaps->getSlopeScaledDepthBias();
-		const auto curr_dbc  = directional_light_smaps->getDepthBiasClamp();
-
-		if (size > available         ||
-		    curr_res  != config_res  ||
-		    curr_db   != config_db   ||
-		    curr_ssdb != config_ssdb ||
-		    curr_dbc  != config_dbc) {
-
-			const u32 count = size ? static_cast<u32>(size) : 1;
-			directional_light_smaps =
-			    std::make_unique<ShadowMapBuffer>(device, count, config_res, config_db, config_ssdb, config_dbc);
+		const auto curr_res  = smap_atlas->getMapRes();
+		const auto curr_db   = smap_atlas->getDepthBias();
+		const auto curr_ssdb = smap_atlas->getSlopeScaledDepthBias();
+		const auto curr_dbc  = smap_atlas->getDepthBiasClamp();
+
+		if (curr_res  != config_atlas_res ||
+		    curr_db   != config_db        ||
+		    curr_ssdb != config_ssdb      ||
+		    curr_dbc  != config_dbc       ||
+		    smap_atlas->hasStaticCache() != config_static) {
+
+			smap_atlas =
+			    std::make_unique<ShadowAtlasBuffer>(device, config_atlas_res, config_db, config_ssdb, config_dbc, config_static);
+
+			// The new atlas has no valid contents
+			smap_atlas_layout.reset(config_atlas_res, min_smap_tile_size);
+			smap_atlas_states.clear();
 		}
-
-		directional_light_smaps->clear(device_context);
 	}
 
 	// Point Lights
 	{
-		const size_t size      = shadowed_point_lights.size();
-		const size_t available = point_light_smaps->getCubeMapCount();
+		const size_t count = point_light_smaps->getCubeMapCount();
 
 		const auto curr_res  = point_light_smaps->getMapRes();
 		const auto curr_db   = point_light_smaps->getDepthBias();
 		const auto curr_ssdb = point_light_smaps->getSlopeScaledDepthBias();
 		const auto curr_dbc  = point_light_smaps->getDepthBiasClamp();
 
-		if (size > available         ||
-		    curr_res  != config_res  ||
-		    curr_db   != config_db   ||
-		    curr_ssdb != config_ssdb ||
-		    curr_dbc  != config_dbc) {
+		if (count     != config_cube_count ||
+		    curr_res  != config_res        ||
+		    curr_db   != config_db         ||
+		    curr_ssdb != config_ssdb       ||
+		    curr_dbc  != config_dbc        ||
+		    point_light_smaps->hasStaticCache() != config_static) {
 
-			const u32 count = size ? static_cast<u32>(size) : 1;
 			point_light_smaps =
-			    std::make_unique<ShadowCubeMapBuffer>(device, count, config_res, config_db, config_ssdb, config_dbc);
+			    std::make_unique<ShadowCubeMapBuffer>(device, config_cube_count, config_res, config_db, config_ssdb, config_dbc, config_static);
+
+			// The new maps have no valid contents
+			point_light_smap_states.assign(point_light_smaps->getMapCount(), {});
 		}
+	}
+}
+
+
+void LightPass::updateShadowAllocations(const RenderSnapshot& snapshot) {
+
+	const u32  max_res       = rendering_config.getShadowMapRes();
+	const u32  cascade_count = std::max(rendering_config.getShadowMapCascadeCount(), 1u);
+	const bool cascaded      = rendering_config.getShadowMapCascadeCount() > 0;
+
+	smap_requests.clear();
+	point_light_coverage.assign(point_light_entries.size(), 0.0f);
+	spot_light_coverage.assign(spot_light_entries.size(), 0.0f);
 
-		point_light_smaps->clear(device_context);
+	// The shadow maps are assigned once for every view. Each view requests the cascades
+	// fitted to it, and a point or spot light uses its largest coverage of any view.
+	for (const auto& camera : snapshot.cameras) {
+		if (camera.settings.getRenderMode() == RenderMode::FalseColor)
+			continue;
+
+		const auto    world_to_projection = camera.getWorldToProjectionMatrix();
+		const Frustum frustum{world_to_projection};
+
+		// Directional lights affect the entire screen, and always request the maximum resolution
+		// for each cascade. They are prioritized over spot lights, whose priority is at most 1,
+		// and nearer cascades are prioritized over farther ones. Without cascades, the light's
+		// own projection is shared by every view.
+		for (const auto& light : snapshot.directional_lights) {
+			if (not light.shadows)
+				continue;
+
+			const auto light_to_projection = light.light_to_world * world_to_projection;
+			if (not Frustum(light_to_projection).contains(light.aabb))
+				continue;
+
+			const handle64 view = cascaded ? camera.entity : handle64{};
+
+			for (u32 i = 0; i < cascade_count; ++i) {
+				const ShadowMapKey key{light.entity, i, view};
+				if (not cascaded and std::ranges::contains(smap_requests, key, &ShadowAtlas::Request::key))
+					continue;
+
+				const f32 priority = 2.0f - (static_cast<f32>(i) / MAX_SHADOW_CASCADES);
+				smap_requests.push_back(ShadowAtlas::Request{key, max_res, priority});
+			}
+		}
+
+		const auto update_coverage = [&](const std::vector<LightEntry>& lights, std::vector<f32>& coverage) {
+			for (size_t i = 0; i < lights.size(); ++i) {
+				if (frustum.contains(lights[i].bounds))
+					coverage[i] = std::max(coverage[i], ScreenCoverage(world_to_projection, lights[i].bounds));
+			}
+		};
+
+		update_coverage(point_light_entries, point_light_coverage);
+		update_coverage(spot_light_entries, spot_light_coverage);
 	}
 
-	// Spot Lights
-	{
-		const size_t size      = shadowed_spot_lights.size();
-		const size_t available = spot_light_smaps->getMapCount();
-
-		const auto curr_res  = spot_light_smaps->getMapRes();
-		const auto curr_db   = spot_light_smaps->getDepthBias();
-		const auto curr_ssdb = spot_light_smaps->getSlopeScaledDepthBias();
-		const auto curr_dbc  = spot_light_smaps->getDepthBiasClamp();
-
-		if (size > available         ||
-		    curr_res  != config_res  ||
-		    curr_db   != config_db   ||
-		    curr_ssdb != config_ssdb ||
-		    curr_dbc  != config_dbc) {
-
-			const u32 count = size ? static_cast<u32>(size) : 1;
-			spot_light_smaps =
-			    std::make_unique<ShadowMapBuffer>(device, count, config_res, config_db, config_ssdb, config_dbc);
+	// A light's importance is its luminance relative to the brightest shadowed light of its type,
+	// so a dim light that covers the screen doesn't take a shadow map from a bright one.
+	const auto max_luminance = [](const auto& lights) {
+		f32 result = 0.0f;
+		for (const auto& light : lights) {
+			if (light.shadows)
+				result = std::max(result, Luminance(light.intensity));
 		}
+		return result;
+	};
+
+	const auto importance = [](const auto& light, f32 max_lum) {
+		return (max_lum > 0.0f) ? std::clamp(Luminance(light.intensity) / max_lum, 0.0f, 1.0f) : 0.0f;
+	};
 
-		spot_light_smaps->clear(device_context);
+	// Spot lights request a resolution proportional to their screen coverage, and are
+	// prioritized by their coverage and importance
+	const f32 max_spot_luminance = max_luminance(snapshot.spot_lights);
+
+	for (size_t i = 0; i < spot_light_entries.size(); ++i) {
+		const auto& entry    = spot_light_entries[i];
+		const auto& light    = snapshot.spot_lights[entry.index];
+		const f32   coverage = spot_light_coverage[i];
+
+		if (not light.shadows or (coverage <= 0.0f))
+			continue;
+
+		const u32 size     = static_cast<u32>(coverage * static_cast<f32>(max_res));
+		const f32 priority = coverage * importance(light, max_spot_luminance);
+		smap_requests.push_back(ShadowAtlas::Request{ShadowMapKey{entry.entity, 0}, size, priority});
+	}
+
+	smap_atlas_layout.update(smap_requests);
+
+	for (auto& entry : spot_light_entries) {
+		entry.shadowed = snapshot.spot_lights[entry.index].shadows
+		                 and (smap_atlas_layout.getTile(ShadowMapKey{entry.entity, 0}) != nullptr);
+	}
+
+	// Forget the states of the shadow maps that no longer have a tile
+	std::erase_if(smap_atlas_states, [this](const auto& pair) {
+		return smap_atlas_layout.getTile(pair.first) == nullptr;
+	});
+
+	// Point lights are given a cube map in order of their screen coverage and importance
+	point_light_priorities.clear();
+	cube_mapped_point_lights.clear();
+
+	const f32 max_point_luminance = max_luminance(snapshot.point_lights);
+
+	for (size_t i = 0; i < point_light_entries.size(); ++i) {
+		const auto& light = snapshot.point_lights[point_light_entries[i].index];
+		if (light.shadows and (point_light_coverage[i] > 0.0f))
+			point_light_priorities.emplace_back(point_light_coverage[i] * importance(light, max_point_luminance), static_cast<u32>(i));
 	}
+
+	std::ranges::stable_sort(point_light_priorities, std::greater{}, [](const auto& pair) { return pair.first; });
+
+	const size_t cube_count = std::min<size_t>(point_light_priorities.size(), point_light_smaps->getCubeMapCount());
+	for (size_t i = 0; i < cube_count; ++i) {
+		const u32 entry = point_light_priorities[i].second;
+		cube_mapped_point_lights.push_back(entry);
+		point_light_entries[entry].shadowed = true;
+	}
+}
+
+
+void LightPass::updateLightBounds(const RenderSnapshot& snapshot) {
+
+	gatherLights(snapshot.point_lights, point_light_states, point_light_entries);
+	gatherLights(snapshot.spot_lights, spot_light_states, spot_light_entries);
+}
+
+
+void XM_CALLCONV LightPass::updateLightVisibility(FXMMATRIX world_to_projection) {
+
+	visible_point_lights.clear();
+	visible_spot_lights.clear();
+
+	// Test all of the lights against the camera's frustum in a single pass
+	const Frustum frustum{world_to_projection};
+	const auto is_visible = [&frustum](const LightEntry& light) {
+		return frustum.contains(light.bounds);
+	};
+
+	std::ranges::copy_if(point_light_entries, std::back_inserter(visible_point_lights), is_visible);
+	std::ranges::copy_if(spot_light_entries, std::back_inserter(visible_spot_lights), is_visible);
 }
 
 
-void XM_CALLCONV LightPass::updateDirectionalLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection) {
+// This function template is only called from within this translation unit so it can be defined here as well
+template<typename LightProxyT>
+void LightPass::gatherLights(const std::vector<LightProxyT>& proxies,
+                             std::unordered_map<handle64, LightBoundsState>& states,
+                             std::vector<LightEntry>& lights) {
+	lights.clear();
 
-	// Temporary buffers
-	std::vector<DirectionalLightBuffer> buffers;
-	buffers.reserve(directional_lights.size());
+	// The world-space bounds are cached, and are only recomputed for lights whose
+	// transform or parameters changed.
+	for (u32 i = 0; i < proxies.size(); ++i) {
+		const auto& light = proxies[i];
 
-	std::vector<DirectionalLightBuffer> shadow_buffers;
-	buffers.reserve(shadowed_directional_lights.size());
+		auto [it, inserted] = states.try_emplace(light.entity);
+		auto& state = it->second;
+		state.last_seen = frame;
 
-	// Clear the cameras
+		if (inserted or (state.revision != light.revision) or (state.light_revision != light.light_revision)) {
+			state.bounds         = TransformBoundingSphere(light.light_to_world, light.bounds);
+			state.revision       = light.revision;
+			state.light_revision = light.light_revision;
+		}
+
+		lights.push_back(LightEntry{light.entity, i, state.bounds});
+	}
+
+	// Forget the lights that no longer exist or are inactive
+	std::erase_if(states, [this](const auto& pair) {
+		return pair.second.last_seen != frame;
+	});
+}
+
+
+void XM_CALLCONV LightPass::updateDirectionalLightData(const RenderView& view, FXMMATRIX world_to_projection, const f32_2& z_depth) {
+
+	// Clear the light data and cameras
+	directional_light_data.clear();
+	shadowed_directional_light_data.clear();
 	directional_light_cameras.clear();
 
-	ecs.forEach<Transform, DirectionalLight>([&](handle64 entity) {
-		const auto& transform = ecs.get<Transform>(entity);
-		const auto& light     = ecs.get<DirectionalLight>(entity);
+	// Split the part of the view that receives shadows into cascades. Without cascades, the
+	// light's own projection is used as a single cascade.
+	const u32 cascade_count = rendering_config.getShadowMapCascadeCount();
+	const auto projection_to_world = XMMatrixInverse(nullptr, world_to_projection);
 
-		if (not light.isActive())
-			return;
+	f32 splits[MAX_SHADOW_CASCADES + 1] = {};
+	if (cascade_count > 0) {
+		const f32 shadow_distance = std::min(z_depth[1], rendering_config.getShadowMapCascadeDistance());
+		ComputeCascadeSplits(z_depth[0], shadow_distance, rendering_config.getShadowMapCascadeLambda(), std::span{splits, cascade_count + 1});
+	}
 
-		const auto light_to_world      = transform.getObjectToWorldMatrix();
-		const auto light_to_projection = light_to_world * world_to_projection;
+	// Cascades are fitted to this view, so their tiles belong to its camera
+	const handle64 shadow_view = (cascade_count > 0) ? view.camera.entity : handle64{};
 
-		if (not Frustum(light_to_projection).contains(light.getAABB()))
-			return;
+	for (const auto& light : view.snapshot.directional_lights) {
+		const auto light_to_projection = light.light_to_world * world_to_projection;
 
-		const auto world_to_light       = transform.getWorldToObjectMatrix();
-		const auto light_to_lprojection = light.getLightToProjectionMatrix();
-		const auto world_to_lprojection = world_to_light * light_to_lprojection;
+		if (not Frustum(light_to_projection).contains(light.aabb))
+			continue;
 
-		DirectionalLightBuffer buffer;
-		XMStore(&buffer.direction, transform.getWorldAxisZ());
-		buffer.intensity           = light.getBaseColor() * light.getIntensity();
+		const auto& world_to_light       = light.world_to_light;
+		const auto& light_to_lprojection = light.light_to_projection;
+		const auto  world_to_lprojection = world_to_light * light_to_lprojection;
+
+		// Cascades extend toward the light to the nearest shadow caster, so casters outside
+		// of the view still cast shadows into it
+		const f32 caster_near = tracked_casters.empty() ? std::numeric_limits<f32>::max()
+		                                                : ComputeCasterNear(world_to_light, shadow_caster_bounds);
+
+		DirectionalLightBuffer buffer = {};
+		XMStore(&buffer.direction, XMVector3Normalize(light.light_to_world.r[2]));
+		buffer.intensity           = light.intensity;
 		buffer.world_to_projection = XMMatrixTranspose(world_to_lprojection);
 
-		if (light.castsShadows()) {
+		if (not light.shadows) {
+			directional_light_data.push_back(std::move(buffer));
+			continue;
+		}
+
+		ShadowedDirectionalLightBuffer shadow_buffer = {};
+		shadow_buffer.light_buffer = buffer;
+
+		// Create a camera for each cascade that was given a tile in the shadow atlas
+		for (u32 i = 0; i < std::max(cascade_count, 1u); ++i) {
+			const ShadowMapKey key{light.entity, i, shadow_view};
+
+			const auto* tile = smap_atlas_layout.getTile(key);
+			if (not tile)
+				continue;
+
+			auto light_to_cprojection = light_to_lprojection;
+			if (cascade_count > 0) {
+				const auto corners = ComputeFrustumSliceCorners(projection_to_world, z_depth, splits[i], splits[i + 1]);
+				const auto bounds  = ComputeCascadeBounds(corners);
+				light_to_cprojection = ComputeCascadeProjection(world_to_light, bounds, tile->size, caster_near);
+			}
+
+			const u32 cascade = shadow_buffer.num_cascades++;
+			shadow_buffer.cascade_world_to_projection[cascade] = XMMatrixTranspose(world_to_light * light_to_cprojection);
+			shadow_buffer.smap_tiles[cascade]                  = smap_atlas_layout.getTileTransform(*tile);
+
 			LightCamera cam;
+			cam.key            = key;
 			cam.world_to_light = world_to_light;
-			cam.light_to_proj  = light_to_lprojection;
+			cam.light_to_proj  = light_to_cprojection;
+			cam.tile           = *tile;
 
 			directional_light_cameras.push_back(std::move(cam));
-			shadow_buffers.push_back(std::move(buffer));
+		}
+
+		// The light only casts shadows if at least one cascade was given a tile
+		if (shadow_buffer.num_cascades > 0)
+			shadowed_directional_light_data.push_back(std::move(shadow_buffer));
+		else
+			directional_light_data.push_back(std::move(buffer));
+	}
+
+	// Update the buffers
+	directional_lights.updateData(device, device_context, directional_light_data);
+	shadowed_directional_lights.updateData(device, device_context, shadowed_directional_light_data);
+}
+
+
+void LightPass::updatePointLightData(const RenderSnapshot& snapshot) {
+
+	// Start writing the light data, and clear the bounds
+	point_light_data.begin();
+	shadowed_point_light_data.begin();
+	point_light_bounds.clear();
+
+	const auto make_buffer = [](const PointLightProxy& light) {
+		PointLightBuffer buffer = {};
+		XMStore(&buffer.position, light.light_to_world.r[3]);
+		buffer.intensity   = light.intensity;
+		buffer.attenuation = light.attenuation;
+		buffer.range       = light.range;
+		return buffer;
+	};
+
+	const auto make_key = [](const PointLightProxy& light) {
+		return LightKey{light.entity, light.revision, light.light_revision};
+	};
+
+	// The shadowed lights are in the order of their cube maps, so each is uploaded whether
+	// or not this view can see it
+	for (const u32 entry : cube_mapped_point_lights) {
+		const auto& light = snapshot.point_lights[point_light_entries[entry].index];
+
+		shadowed_point_light_data.write(make_key(light), [&] {
+			const auto& light_to_lprojection = light.light_to_projection;
+
+			ShadowedPointLightBuffer buffer = {};
+			buffer.light_buffer   = make_buffer(light);
+			buffer.world_to_light = XMMatrixTranspose(light.world_to_light);
+
+			const f32_2 proj_values = {
+				XMVectorGetZ(light_to_lprojection.r[2]),
+				XMVectorGetZ(light_to_lprojection.r[3])
+			};
+			buffer.projection_values = proj_values;
+
+			return buffer;
+		});
+	}
+
+	for (const auto& [entity, index, bounds, shadowed] : visible_point_lights) {
+		if (shadowed)
+			continue;
+
+		const auto& light = snapshot.point_lights[index];
+		point_light_data.write(make_key(light), [&] { return make_buffer(light); });
+		point_light_bounds.push_back(bounds);
+	}
+
+	// Upload the changed light data
+	point_light_data.upload(device, device_context, point_lights);
+	shadowed_point_light_data.upload(device, device_context, shadowed_point_lights);
+}
+
+
+void LightPass::updateSpotLightData(const RenderSnapshot& snapshot) {
+
+	// Start writing the light data, and clear the bounds
+	spot_light_data.begin();
+	shadowed_spot_light_data.begin();
+	spot_light_bounds.clear();
+
+	for (const auto& [entity, index, bounds, shadowed] : visible_spot_lights) {
+		const auto& light = snapshot.spot_lights[index];
+
+		const auto make_buffer = [&light] {
+			SpotLightBuffer light_buffer = {};
+			XMStore(&light_buffer.position, light.light_to_world.r[3]);
+			XMStore(&light_buffer.direction, XMVector3Normalize(light.light_to_world.r[2]));
+			light_buffer.intensity     = light.intensity;
+			light_buffer.attenuation   = light.attenuation;
+			light_buffer.cos_umbra     = light.cos_umbra;
+			light_buffer.cos_penumbra  = light.cos_penumbra;
+			light_buffer.range         = light.range;
+			return light_buffer;
+		};
+
+		LightKey key{entity, light.revision, light.light_revision};
+
+		// The light only casts shadows if it was given a tile in the shadow atlas. The tile
+		// is part of the key, since the buffer holds its position in the atlas.
+		if (shadowed) {
+			key.tile = *smap_atlas_layout.getTile(ShadowMapKey{entity, 0});
+
+			shadowed_spot_light_data.write(key, [&] {
+				ShadowedSpotLightBuffer buffer = {};
+				buffer.light_buffer        = make_buffer();
+				buffer.world_to_projection = XMMatrixTranspose(light.world_to_light * light.light_to_projection);
+				buffer.smap_tile           = smap_atlas_layout.getTileTransform(key.tile);
+				return buffer;
+			});
 		}
 		else {
-			buffers.push_back(std::move(buffer));
+			spot_light_data.write(key, make_buffer);
+			spot_light_bounds.push_back(bounds);
 		}
-	});
+	}
 
-	// Update the buffers
-	directional_lights.updateData(device, device_context, buffers);
-	shadowed_directional_lights.updateData(device, device_context, shadow_buffers);
+	// Upload the changed light data
+	spot_light_data.upload(device, device_context, spot_lights);
+	shadowed_spot_light_data.upload(device, device_context, shadowed_spot_lights);
 }
 
 
-void XM_CALLCONV LightPass::updatePointLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection) {
+void XM_CALLCONV LightPass::updateLightClusters(FXMMATRIX world_to_camera,
+                                                CXMMATRIX camera_to_projection,
+                                                const f32_2& z_depth) {
+
+	light_clusters.update(world_to_camera, camera_to_projection, z_depth, point_light_bounds, spot_light_bounds);
+
+	light_cluster_buffer.updateData(device, device_context, light_clusters.getClusters());
+	light_index_buffer.updateData(device, device_context, light_clusters.getLightIndices());
+}
 
-	// Temporary buffers
-	std::vector<PointLightBuffer> buffers;
-	buffers.reserve(point_lights.size());
 
-	std::vector<ShadowedPointLightBuffer> shadow_buffers;
-	shadow_buffers.reserve(shadowed_point_lights.size());
+void LightPass::updateShadowCameras(const RenderSnapshot& snapshot) {
 
-	// Clear the point light cameras
 	point_light_cameras.clear();
+	spot_light_cameras.clear();
 
+	// Camera rotations for the cube map
+	static const XMMATRIX rotations[6] = {
+		XMMatrixRotationY(-XM_PIDIV2),
+		XMMatrixRotationY(XM_PIDIV2),
+		XMMatrixRotationX(XM_PIDIV2),
+		XMMatrixRotationX(-XM_PIDIV2),
+		XMMatrixIdentity(),
+		XMMatrixRotationY(XM_PI)
+	};
+
+	// Six cameras for each cube map, in the order of the cube maps
+	for (const u32 entry : cube_mapped_point_lights) {
+		const auto& [entity, index, bounds, shadowed] = point_light_entries[entry];
+		const auto& light = snapshot.point_lights[index];
+
+		for (size_t i = 0; i < 6; ++i) {
+			LightCamera cam;
+			cam.key            = ShadowMapKey{entity, static_cast<u32>(i)};
+			cam.world_to_light = light.world_to_light * rotations[i];
+			cam.light_to_proj  = light.light_to_projection;
 
-	ecs.forEach<Transform, PointLight>([&](handle64 entity) {
-		const auto& transform = ecs.get<Transform>(entity);
-		const auto& light     = ecs.get<PointLight>(entity);
+			point_light_cameras.push_back(std::move(cam));
+		}
+	}
 
-		if (not light.isActive())
-			return;
+	for (const auto& [entity, index, bounds, shadowed] : spot_light_entries) {
+		if (not shadowed)
+			continue;
 
-		const auto light_to_world      = transform.getObjectToWorldMatrix();
-		const auto light_to_projection = light_to_world * world_to_projection;
+		const auto& light = snapshot.spot_lights[index];
+		const ShadowMapKey key{entity, 0};
+
+		LightCamera cam;
+		cam.key            = key;
+		cam.world_to_light = light.world_to_light;
+		cam.light_to_proj  = light.light_to_projection;
+		cam.tile           = *smap_atlas_layout.getTile(key);
+
+		spot_light_cameras.push_back(std::move(cam));
+	}
+}
 
-		// Camera rotations for the cube map
-		static const XMMATRIX rotations[6] = {
-			XMMatrixRotationY(-XM_PIDIV2),
-			XMMatrixRotationY(XM_PIDIV2),
-			XMMatrixRotationX(XM_PIDIV2),
-			XMMatrixRotationX(-XM_PIDIV2),
-			XMMatrixIdentity(),
-			XMMatrixRotationY(XM_PI)
-		};
 
-		if (not Frustum(light_to_projection).contains(light.getBoundingSphere()))
-			return;
+void LightPass::updateShadowCasters(const RenderSnapshot& snapshot) {
 
-		PointLightBuffer light_buffer;
-		XMStore(&light_buffer.position, transform.getWorldOrigin());
-		light_buffer.intensity   = light.getBaseColor() * light.getIntensity();
-		light_buffer.attenuation = light.getAttenuation();
-		light_buffer.range       = light.getRange();
+	dirty_static_casters.clear();
+	dirty_dynamic_casters.clear();
 
-		if (light.castsShadows()) {
-			const auto world_to_light = transform.getWorldToObjectMatrix();
-			const auto light_to_lprojection = light.getLightToProjectionMatrix();
+	const auto mark_dirty = [this](const ShadowCasterState& state) {
+		if (state.is_static)
+			dirty_static_casters.push_back(state.bounds);
+		else
+			dirty_dynamic_casters.push_back(state.bounds);
+	};
 
-			// Create the cameras
-			for (size_t i = 0; i < 6; ++i) {
-				LightCamera cam;
-				cam.world_to_light = world_to_light * rotations[i];
-				cam.light_to_proj = light_to_lprojection;
+	// Stop tracking a caster. The last tracked caster is moved into its position.
+	const auto untrack = [this](ShadowCasterState& state) {
+		const u32 moved = tracked_casters.back();
+		tracked_casters[state.position] = moved;
+		shadow_casters[moved].position  = state.position;
+		tracked_casters.pop_back();
+		state.entity = handle64{};
+	};
 
-				point_light_cameras.push_back(std::move(cam));
+	// The states are indexed by entity index, so finding a caster's state doesn't need a
+	// lookup. The snapshot only holds active models, so inactive casters are treated as removed.
+	for (size_t i = 0; i < snapshot.models.size(); ++i) {
+		const auto& model = snapshot.models[i];
+		const u32   slot  = model.entity.index;
+
+		if (slot >= shadow_casters.size())
+			shadow_casters.resize(slot + 1);
+
+		auto& state = shadow_casters[slot];
+
+		// The slot belonged to an entity that was destroyed
+		if ((state.entity != handle64{}) and (state.entity != model.entity)) {
+			mark_dirty(state);
+			untrack(state);
+		}
+
+		if (not model.shadows) {
+			if (state.entity != handle64{}) {
+				mark_dirty(state);
+				untrack(state);
 			}
+			continue;
+		}
 
-			// Create the buffer
-			ShadowedPointLightBuffer buffer;
-			buffer.light_buffer   = light_buffer;
-			buffer.world_to_light = XMMatrixTranspose(world_to_light);
+		const bool tracked        = (state.entity != handle64{});
+		const u32  revision       = model.revision;
+		const u32  model_revision = model.getModelRevision();
+		const u32  lod            = snapshot.shadow_lods[i];
+		const bool is_static      = model.static_shadows;
 
-			const f32_2 proj_values = {
-				XMVectorGetZ(light_to_lprojection.r[2]),
-				XMVectorGetZ(light_to_lprojection.r[3])
-			};
-			buffer.projection_values = proj_values;
+		state.last_seen = frame;
 
-			shadow_buffers.push_back(std::move(buffer));
+		if (tracked
+		    and state.revision       == revision
+		    and state.model_revision == model_revision
+		    and state.lod            == lod
+		    and state.is_static      == is_static) {
+			continue;
+		}
+
+		// Both the volume the caster previously occupied and the volume it now occupies are dirty
+		if (tracked) {
+			mark_dirty(state);
 		}
 		else {
-			buffers.push_back(std::move(light_buffer));
+			state.entity   = model.entity;
+			state.position = static_cast<u32>(tracked_casters.size());
+			tracked_casters.push_back(slot);
 		}
-	});
 
-	// Update the buffers
-	point_lights.updateData(device, device_context, buffers);
-	shadowed_point_lights.updateData(device, device_context, shadow_buffers);
+		state.revision       = revision;
+		state.model_revision = model_revision;
+		state.lod            = lod;
+		state.is_static      = is_static;
+		state.bounds         = TransformBoundingSphere(model.object_to_world, model.getBoundingSphere());
+
+		mark_dirty(state);
+	}
+
+	// Casters that no longer exist dirty the volume they last occupied
+	for (size_t i = tracked_casters.size(); i-- > 0;) {
+		auto& state = shadow_casters[tracked_casters[i]];
+		if (state.last_seen == frame)
+			continue;
+
+		mark_dirty(state);
+		untrack(state);
+	}
+
+	// The bounds of every caster, used to extend the cascades toward the light
+	auto min_point = XMVectorReplicate(std::numeric_limits<f32>::max());
+	auto max_point = XMVectorReplicate(std::numeric_limits<f32>::lowest());
+
+	for (const u32 slot : tracked_casters) {
+		const auto& bounds = shadow_casters[slot].bounds;
+		const auto  radius = XMVectorReplicate(bounds.radius());
+
+		min_point = XMVectorMin(min_point, bounds.center() - radius);
+		max_point = XMVectorMax(max_point, bounds.center() + radius);
+	}
+
+	shadow_caster_bounds = AABB{min_point, max_point};
 }
 
 
-void XM_CALLCONV LightPass::updateSpotLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection) {
+LightPass::ShadowMapUpdate LightPass::getShadowMapUpdate(const LightCamera& camera, const ShadowMapState& state) const {
 
-	// Temporary buffer vectors
-	std::vector<SpotLightBuffer> buffers;
-	buffers.reserve(spot_lights.size());
+	// A shadow map is only valid if it was last rendered for the same light with the same
+	// camera, and no shadow caster within the camera's volume has changed since then.
+	if (not rendering_config.isShadowMapCachingEnabled()
+	    or not state.valid
+	    or state.key   != camera.key
+	    or state.tile  != camera.tile
+	    or not MatrixEqual(state.world_to_light, camera.world_to_light)
+	    or not MatrixEqual(state.light_to_proj, camera.light_to_proj)) {
+		return ShadowMapUpdate{};
+	}
 
-	std::vector<ShadowedSpotLightBuffer> shadow_buffers;
-	shadow_buffers.reserve(spot_lights.size());
+	const Frustum frustum{camera.world_to_light * camera.light_to_proj};
+	const auto intersects = [&frustum](const std::vector<BoundingSphere>& volumes) {
+		return std::ranges::any_of(volumes, [&frustum](const BoundingSphere& volume) {
+			return frustum.contains(volume);
+		});
+	};
 
-	// Clear the spot light cameras
-	spot_light_cameras.clear();
+	return ShadowMapUpdate{intersects(dirty_static_casters), intersects(dirty_dynamic_casters)};
+}
 
 
-	ecs.forEach<Transform, SpotLight>([&](handle64 entity) {
-		const auto& transform = ecs.get<Transform>(entity);
-		const auto& light     = ecs.get<SpotLight>(entity);
+void LightPass::renderShadowMaps(const RenderSnapshot& snapshot,
+                                 const IShadowMapBuffer& smaps,
+                                 const std::vector<LightCamera>& cameras,
+                                 std::vector<ShadowMapState>& states) {
 
-		if (not light.isActive())
-			return;
+	smaps.bindViewport(device_context);
+	smaps.bindRasterState(device_context);
 
-		const auto light_to_world      = transform.getObjectToWorldMatrix();
-		const auto light_to_projection = light_to_world * world_to_projection;
+	for (size_t i = 0; i < cameras.size(); ++i) {
+		const auto& camera = cameras[i];
+		auto& state        = states[i];
 
-		if (not Frustum(light_to_projection).contains(light.getAABB()))
-			return;
+		const auto [static_dirty, dynamic_dirty] = getShadowMapUpdate(camera, state);
+		if (not static_dirty and not dynamic_dirty)
+			continue;
 
-		SpotLightBuffer light_buffer;
-		XMStore(&light_buffer.position, transform.getWorldOrigin());
-		XMStore(&light_buffer.direction, transform.getWorldAxisZ());
-		light_buffer.intensity     = light.getBaseColor() * light.getIntensity();
-		light_buffer.attenuation   = light.getAttenuation();
-		light_buffer.cos_umbra     = light.getUmbra();
-		light_buffer.cos_penumbra  = light.getPenumbra();
-		light_buffer.range         = light.getRange();
+		if (smaps.hasStaticCache()) {
+			// Render the static casters into the static copy of the map if one of them changed
+			if (static_dirty) {
+				smaps.clearStatic(device_context, i);
+				smaps.bindStaticDSV(device_context, i);
+				depth_pass->renderShadows(snapshot, camera.world_to_light, camera.light_to_proj, ShadowCasters::Static);
+			}
 
-		if (light.castsShadows()) {
-			const auto world_to_light       = transform.getWorldToObjectMatrix();
-			const auto light_to_lprojection = light.getLightToProjectionMatrix();
-			const auto world_to_lprojection = world_to_light * light_to_lprojection;
+			// Composite the dynamic casters on top of the static copy
+			Pipeline::OM::bindRTVsAndDSV(device_context, {}, nullptr);
+			smaps.restoreStatic(device_context, i);
+			smaps.bindDSV(device_context, i);
+			depth_pass->renderShadows(snapshot, camera.world_to_light, camera.light_to_proj, ShadowCasters::Dynamic);
+		}
+		else {
+			smaps.clear(device_context, i);
+			smaps.bindDSV(device_context, i);
+			depth_pass->renderShadows(snapshot, camera.world_to_light, camera.light_to_proj);
+		}
+
+		state.key            = camera.key;
+		state.world_to_light = camera.world_to_light;
+		state.light_to_proj  = camera.light_to_proj;
+		state.valid          = rendering_config.isShadowMapCachingEnabled();
+	}
+}
 
-			// Create the camera
-			LightCamera cam;
-			cam.world_to_light = world_to_light;
-			cam.light_to_proj  = light_to_lprojection;
 
-			spot_light_cameras.push_back(std::move(cam));
+void LightPass::renderShadowAtlas(const RenderSnapshot& snapshot, const std::vector<LightCamera>& cameras) {
 
+	smap_atlas->bindRasterState(device_context);
 
-			// Create the buffer
-			ShadowedSpotLightBuffer buffer;
-			buffer.light_buffer        = light_buffer;
-			buffer.world_to_projection = XMMatrixTranspose(world_to_lprojection);
+	for (const auto& camera : cameras) {
+		auto& state = smap_atlas_states[camera.key];
 
-			shadow_buffers.push_back(std::move(buffer));
+		const auto [static_dirty, dynamic_dirty] = getShadowMapUpdate(camera, state);
+		if (not static_dirty and not dynamic_dirty)
+			continue;
+
+		if (smap_atlas->hasStaticCache()) {
+			// Render the static casters into the static copy of the tile if one of them changed
+			if (static_dirty) {
+				smap_atlas->bindStaticDSV(device_context, 0);
+				renderAtlasTile(snapshot, camera, ShadowCasters::Static);
+			}
+
+			// Restore the tile from its static copy, and composite the dynamic casters on top of it
+			smap_atlas->bindDSV(device_context, 0);
+			restoreAtlasTile(camera.tile);
+			renderAtlasTile(snapshot, camera, ShadowCasters::Dynamic, false);
 		}
 		else {
-			buffers.push_back(std::move(light_buffer));
+			smap_atlas->bindDSV(device_context, 0);
+			renderAtlasTile(snapshot, camera, ShadowCasters::All);
 		}
-	});
 
-	// Update buffers
-	spot_lights.updateData(device, device_context, buffers);
-	shadowed_spot_lights.updateData(device, device_context, shadow_buffers);
+		state.key            = camera.key;
+		state.world_to_light = camera.world_to_light;
+		state.light_to_proj  = camera.light_to_proj;
+		state.tile           = camera.tile;
+		state.valid          = rendering_config.isShadowMapCachingEnabled();
+	}
 }
 
 
-void LightPass::renderShadowMaps(const ecs::ECS& ecs) {
+void XM_CALLCONV LightPass::renderAtlasTile(const RenderSnapshot& snapshot,
+                                            const LightCamera& camera,
+                                            ShadowCasters casters,
+                                            bool clear) const {
 
+	if (clear)
+		clearAtlasTile(camera.tile);
+
+	// Restore the depth pass state after clearing or restoring the tile
 	depth_pass->bindState();
+	smap_atlas->bindRasterState(device_context);
 
-	// Directional Lights
-	directional_light_smaps->bindViewport(device_context);
-	directional_light_smaps->bindRasterState(device_context);
+	TileViewport(camera.tile, 0.0f, 1.0f).bind(device_context);
 
-	for (size_t i = 0; const auto& camera : directional_light_cameras) {
-		directional_light_smaps->bindDSV(device_context, i++);
-		depth_pass->renderShadows(ecs, camera.world_to_light, camera.light_to_proj);
-	}
+	depth_pass->renderShadows(snapshot, camera.world_to_light, camera.light_to_proj, casters);
+}
 
 
-	// Point Lights
-	point_light_smaps->bindViewport(device_context);
-	point_light_smaps->bindRasterState(device_context);
+void LightPass::clearAtlasTile(const ShadowAtlas::Tile& tile) const {
 
-	for (size_t i = 0; const auto& camera : point_light_cameras) {
-		point_light_smaps->bindDSV(device_context, i++);
-		depth_pass->renderShadows(ecs, camera.world_to_light, camera.light_to_proj);
-	}
+	// A DSV can only be cleared in its entirety, so the tile is cleared by drawing a quad over
+	// it. The viewport's depth range forces the quad's depth to the far plane, and the depth
+	// test always passes since no depth is greater than the far plane.
+	TileViewport(tile, 1.0f, 1.0f).bind(device_context);
 
+	Pipeline::IA::bindPrimitiveTopology(device_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	clear_vs->bind(device_context);
+	Pipeline::PS::bindShader(device_context, nullptr, {});
+	render_state_mgr.bind(device_context, DepthStencilStates::GreaterEqRW);
 
-	// Spot Lights
-	spot_light_smaps->bindViewport(device_context);
-	spot_light_smaps->bindRasterState(device_context);
+	Pipeline::draw(device_context, 6, 0);
+}
 
-	for (size_t i = 0; const auto& camera : spot_light_cameras) {
-		spot_light_smaps->bindDSV(device_context, i++);
-		depth_pass->renderShadows(ecs, camera.world_to_light, camera.light_to_proj);
-	}
+
+void LightPass::restoreAtlasTile(const ShadowAtlas::Tile& tile) const {
+
+	// Clear the tile, then draw a quad over it that writes the depth of the static copy. Every
+	// depth passes the test against the cleared far plane.
+	clearAtlasTile(tile);
+
+	TileViewport(tile, 0.0f, 1.0f).bind(device_context);
+
+	restore_ps->bind(device_context);
+	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_DEPTH, std::span{smap_atlas->getStaticSRVAddress(), 1});
+	render_state_mgr.bind(device_context, DepthStencilStates::LessEqRW);
+
+	Pipeline::draw(device_context, 6, 0);
+
+	ID3D11ShaderResourceView* const null_srv[1] = {};
+	Pipeline::PS::bindSRVs(device_context, SLOT_SRV_DEPTH, std::span{null_srv});
 }
 
-} //namespace render
\ No newline at end of file
+} //namespace render
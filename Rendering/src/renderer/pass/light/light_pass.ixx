@@ -1,23 +1,32 @@
 module;
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 #include <DirectXMath.h>
 
 #include "datatypes/types.h"
+#include "memory/handle/handle.h"
 #include "directx/d3d11.h"
 
 export module rendering:pass.light_pass;
 
-import ecs;
+import math.geometry;
 import :buffer_types;
 import :constant_buffer;
 import :pass.depth_pass;
 import :render_state_mgr;
+import :render_snapshot;
 import :rendering_config;
 import :resource_mgr;
+import :shader;
 import :shadow_map_buffer;
+import :pass.shadow_atlas;
+import :pass.light_clusters;
 import :structured_buffer;
 
 using namespace DirectX;
@@ -55,29 +64,188 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void XM_CALLCONV render(const ecs::ECS& ecs, FXMMATRIX world_to_projection);
+
+	// Find the shadow casters that changed, assign the shadow maps, and render the shadow
+	// maps that are shared by every camera. Called once per frame, before any view is rendered.
+	void beginFrame(const RenderSnapshot& snapshot);
+
+	// z_depth is the near and far plane distances of the camera, used to fit shadow cascades.
+	// If cluster_lights is true, the shaders only evaluate the point and spot lights in the
+	// cluster a pixel belongs to.
+	void XM_CALLCONV render(const RenderView& view,
+	                        FXMMATRIX world_to_camera,
+	                        CXMMATRIX camera_to_projection,
+	                        const f32_2& z_depth,
+	                        bool cluster_lights);
 
 private:
 
 	void bindBuffers();
+	void unbindShadowMaps();
 
 	void updateShadowMaps();
-	void renderShadowMaps(const ecs::ECS& ecs);
+	void updateShadowAllocations(const RenderSnapshot& snapshot);
+	void updateShadowCasters(const RenderSnapshot& snapshot);
+	void updateShadowCameras(const RenderSnapshot& snapshot);
 
-	void updateData(const ecs::ECS& ecs) const;
-	void XM_CALLCONV updateDirectionalLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection);
-	void XM_CALLCONV updatePointLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection);
-	void XM_CALLCONV updateSpotLightData(const ecs::ECS& ecs, FXMMATRIX world_to_projection);
+	void updateData(const RenderSnapshot& snapshot) const;
+	void updateLightBounds(const RenderSnapshot& snapshot);
+	void XM_CALLCONV updateLightVisibility(FXMMATRIX world_to_projection);
+	void XM_CALLCONV updateDirectionalLightData(const RenderView& view, FXMMATRIX world_to_projection, const f32_2& z_depth);
+	void updatePointLightData(const RenderSnapshot& snapshot);
+	void updateSpotLightData(const RenderSnapshot& snapshot);
+	void XM_CALLCONV updateLightClusters(FXMMATRIX world_to_camera, CXMMATRIX camera_to_projection, const f32_2& z_depth);
 
 	
+	//----------------------------------------------------------------------------------
+	// Light visibility
+	//----------------------------------------------------------------------------------
+
+	// The world-space bounds of a point or spot light. The bounds are only recomputed
+	// when the light's transform or parameters change.
+	struct LightBoundsState {
+		BoundingSphere bounds;
+		u32 revision       = 0;
+		u32 light_revision = 0;
+		u64 last_seen      = 0;
+	};
+
+	// A light, the index of its proxy in the snapshot, and its world-space bounds
+	struct LightEntry {
+		handle64 entity;
+		u32 index;
+		BoundingSphere bounds;
+		bool shadowed = false; //given a shadow map this frame
+	};
+
+	// Gather the lights of a type along with their world-space bounds
+	template<typename LightProxyT>
+	void gatherLights(const std::vector<LightProxyT>& proxies,
+	                  std::unordered_map<handle64, LightBoundsState>& states,
+	                  std::vector<LightEntry>& lights);
+
+
+	//----------------------------------------------------------------------------------
+	// Light data
+	//----------------------------------------------------------------------------------
+
+	// Identifies the state of a light that an element of a light buffer was built from
+	struct LightKey {
+		handle64 entity;
+		u32 revision       = 0;  //transform render revision
+		u32 light_revision = 0;  //light parameter revision
+		ShadowAtlas::Tile tile = {};
+
+		[[nodiscard]]
+		bool operator==(const LightKey&) const noexcept = default;
+	};
+
+	// The data of a light buffer, and the key of the light each element was built from. An
+	// element is only rebuilt when the light in its place changes, and only the range of
+	// elements that were rebuilt is uploaded.
+	template<typename DataT>
+	struct LightBufferData {
+		void begin() noexcept {
+			size  = 0;
+			first = std::numeric_limits<u32>::max();
+			last  = 0;
+		}
+
+		// Write the next element, calling make_data() to build it if the key changed
+		template<typename MakeDataT>
+		void write(const LightKey& key, MakeDataT&& make_data) {
+			if (size < data.size()) {
+				if (keys[size] == key) {
+					++size;
+					return;
+				}
+				data[size] = make_data();
+				keys[size] = key;
+			}
+			else {
+				data.push_back(make_data());
+				keys.push_back(key);
+			}
+
+			first = std::min(first, size);
+			last  = ++size;
+		}
+
+		void upload(ID3D11Device& device, ID3D11DeviceContext& device_context, StructuredBuffer<DataT>& buffer) const {
+			buffer.updateData(device, device_context, std::span{data.data(), size}, first, last);
+		}
+
+		std::vector<DataT>    data;
+		std::vector<LightKey> keys;
+		u32 size  = 0;
+		u32 first = 0;
+		u32 last  = 0;
+	};
+
+
 	//----------------------------------------------------------------------------------
 	// Camera definition for rendering from light's POV
 	//----------------------------------------------------------------------------------
 	struct LightCamera {
+		ShadowMapKey key;
 		XMMATRIX world_to_light;
 		XMMATRIX light_to_proj;
+		ShadowAtlas::Tile tile; //unused for cube maps
 	};
 
+
+	//----------------------------------------------------------------------------------
+	// Shadow caching
+	//----------------------------------------------------------------------------------
+
+	// The camera that a shadow map was last rendered with
+	struct ShadowMapState {
+		ShadowMapKey key;
+		XMMATRIX world_to_light;
+		XMMATRIX light_to_proj;
+		ShadowAtlas::Tile tile;
+		bool valid = false;
+	};
+
+	// Which shadow casters need to be re-rendered in a shadow map
+	struct ShadowMapUpdate {
+		bool static_dirty  = true;
+		bool dynamic_dirty = true;
+	};
+
+	// The state of a shadow caster when it was last seen. Only exists while the caster casts shadows.
+	struct ShadowCasterState {
+		handle64       entity;
+		BoundingSphere bounds;
+		u32  revision       = 0;  //transform render revision
+		u32  model_revision = 0;  //blueprint revision, changes when the model is reloaded
+		u32  lod            = 0;  //shadow level of detail
+		u32  position       = 0;  //index in tracked_casters
+		u64  last_seen      = 0;
+		bool is_static = false;
+	};
+
+	[[nodiscard]]
+	ShadowMapUpdate getShadowMapUpdate(const LightCamera& camera, const ShadowMapState& state) const;
+
+	void renderShadowMaps(const RenderSnapshot& snapshot,
+	                      const IShadowMapBuffer& smaps,
+	                      const std::vector<LightCamera>& cameras,
+	                      std::vector<ShadowMapState>& states);
+
+	void renderShadowAtlas(const RenderSnapshot& snapshot, const std::vector<LightCamera>& cameras);
+
+	// Render a tile of the atlas. The tile is cleared first unless clear is false.
+	void XM_CALLCONV renderAtlasTile(const RenderSnapshot& snapshot,
+	                                 const LightCamera& camera,
+	                                 ShadowCasters casters,
+	                                 bool clear = true) const;
+
+	void clearAtlasTile(const ShadowAtlas::Tile& tile) const;
+
+	// Overwrite a tile of the atlas with the tile's static copy. The atlas DSV must be bound.
+	void restoreAtlasTile(const ShadowAtlas::Tile& tile) const;
+
 	
 	//----------------------------------------------------------------------------------
 	// Member Variables
@@ -86,11 +254,16 @@ private:
 	// Dependency References
 	ID3D11Device&          device;
 	ID3D11DeviceContext&   device_context;
+	RenderStateMgr&        render_state_mgr;
 	const RenderingConfig& rendering_config;
 
 	// Depth rendering pass
 	std::unique_ptr<DepthPass> depth_pass;
 
+	// Shaders used to clear a tile of the shadow atlas, and to restore it from its static copy
+	std::shared_ptr<VertexShader> clear_vs;
+	std::shared_ptr<PixelShader>  restore_ps;
+
 	// Light info buffer
 	ConstantBuffer<LightBuffer> light_buffer;
 
@@ -100,19 +273,73 @@ private:
 	StructuredBuffer<SpotLightBuffer>        spot_lights;
 
 	// Shadowed light buffers
-	StructuredBuffer<DirectionalLightBuffer> shadowed_directional_lights;
+	StructuredBuffer<ShadowedDirectionalLightBuffer> shadowed_directional_lights;
 	StructuredBuffer<ShadowedPointLightBuffer> shadowed_point_lights;
 	StructuredBuffer<ShadowedSpotLightBuffer> shadowed_spot_lights;
 
-	// Light cameras
+	// Light data uploaded to the buffers. The directional lights are fitted to the view and
+	// rebuilt for each one, and the other lights are only rebuilt when they change.
+	std::vector<DirectionalLightBuffer>         directional_light_data;
+	std::vector<ShadowedDirectionalLightBuffer> shadowed_directional_light_data;
+	LightBufferData<PointLightBuffer>           point_light_data;
+	LightBufferData<SpotLightBuffer>            spot_light_data;
+	LightBufferData<ShadowedPointLightBuffer>   shadowed_point_light_data;
+	LightBufferData<ShadowedSpotLightBuffer>    shadowed_spot_light_data;
+
+	// The world-space bounds of each point and spot light, the lights of this frame, and
+	// the lights visible to the view being rendered
+	std::unordered_map<handle64, LightBoundsState> point_light_states;
+	std::unordered_map<handle64, LightBoundsState> spot_light_states;
+	std::vector<LightEntry> point_light_entries;
+	std::vector<LightEntry> spot_light_entries;
+	std::vector<LightEntry> visible_point_lights;
+	std::vector<LightEntry> visible_spot_lights;
+
+	// Light clusters. Only the point and spot lights without shadows are clustered, and the
+	// world-space bounds of those lights are kept in the same order as their buffers.
+	LightClusters light_clusters;
+	StructuredBuffer<LightClusters::Cluster> light_cluster_buffer;
+	StructuredBuffer<u32> light_index_buffer;
+	std::vector<BoundingSphere> point_light_bounds;
+	std::vector<BoundingSphere> spot_light_bounds;
+	bool lights_clustered = false;
+
+	// Light cameras. The directional light cameras are fitted to the view being rendered,
+	// and the others are shared by every view.
 	std::vector<LightCamera> directional_light_cameras;
 	std::vector<LightCamera> point_light_cameras;
 	std::vector<LightCamera> spot_light_cameras;
 
-	// Shadow maps
-	std::unique_ptr<ShadowMapBuffer>     directional_light_smaps;
+	// Shadow maps. Directional and spot lights share the atlas, and point lights use cube maps.
+	std::unique_ptr<ShadowAtlasBuffer>   smap_atlas;
 	std::unique_ptr<ShadowCubeMapBuffer> point_light_smaps;
-	std::unique_ptr<ShadowMapBuffer>     spot_light_smaps;
+
+	// Shadow atlas layout, and the tile requests made this frame
+	ShadowAtlas smap_atlas_layout;
+	std::vector<ShadowAtlas::Request> smap_requests;
+
+	// The largest screen coverage of each point and spot light in any view, the point light
+	// priorities, and the point lights given a cube map this frame (indices of their entries,
+	// in the order of their cube maps)
+	std::vector<f32> point_light_coverage;
+	std::vector<f32> spot_light_coverage;
+	std::vector<std::pair<f32, u32>> point_light_priorities;
+	std::vector<u32> cube_mapped_point_lights;
+
+	// Shadow map states
+	std::unordered_map<ShadowMapKey, ShadowMapState, ShadowMapKeyHash> smap_atlas_states;
+	std::vector<ShadowMapState> point_light_smap_states;
+
+	// Shadow caster states indexed by entity index, the entity indices of the casters that
+	// have a state, and the world-space bounds of casters that changed this frame
+	std::vector<ShadowCasterState> shadow_casters;
+	std::vector<u32> tracked_casters;
+	std::vector<BoundingSphere> dirty_static_casters;
+	std::vector<BoundingSphere> dirty_dynamic_casters;
+	u64 frame = 0;
+
+	// The world-space bounds of every shadow caster
+	AABB shadow_caster_bounds;
 };
 
 } //namespace render
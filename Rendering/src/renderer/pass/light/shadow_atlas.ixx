@@ -0,0 +1,246 @@
+module;
+
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "datatypes/types.h"
+#include "memory/atlas_allocator.h"
+#include "memory/handle/handle.h"
+
+export module rendering:pass.shadow_atlas;
+
+
+namespace render {
+
+// Identifies a single shadow map of a light (e.g. one cascade of a directional light)
+export struct ShadowMapKey {
+	[[nodiscard]]
+	bool operator==(const ShadowMapKey& other) const noexcept = default;
+
+	handle64 light;
+	u32      index = 0;
+
+	// The camera a view dependent shadow map (e.g. a cascade) was fitted to. Null for the
+	// shadow maps that are shared by every camera.
+	handle64 view;
+};
+
+export struct ShadowMapKeyHash {
+	[[nodiscard]]
+	size_t operator()(const ShadowMapKey& key) const noexcept {
+		return std::hash<handle64>{}(key.light) ^ (std::hash<u32>{}(key.index) << 1) ^ (std::hash<handle64>{}(key.view) << 2);
+	}
+};
+
+
+//----------------------------------------------------------------------------------
+// ShadowAtlas
+//----------------------------------------------------------------------------------
+//
+// Assigns each shadow map a tile in a shared shadow atlas. Lights request a tile
+// size along with a priority, and tiles are handed out in order of priority. If the
+// atlas is full, a light's tile is shrunk until it fits, and lower priority lights are
+// evicted if a tile of the minimum size still doesn't fit. A light keeps its tile until
+// its requested size shrinks to a quarter of it. A tile that's smaller than requested
+// is only replaced once a larger block is free, so shrunk tiles keep their contents
+// while the atlas is full.
+//
+// This class only manages the layout of the atlas and has no GPU resources.
+//
+//----------------------------------------------------------------------------------
+export class ShadowAtlas final {
+public:
+	using Tile = AtlasAllocator::Tile;
+
+	struct Request {
+		ShadowMapKey key;
+
+		// The desired width and height of the light's tile, in texels
+		u32 size = 0;
+
+		// Lights with a higher priority are allocated first
+		f32 priority = 0.0f;
+	};
+
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	ShadowAtlas(u32 atlas_size, u32 min_tile_size)
+		: allocator(atlas_size, min_tile_size) {
+	}
+
+	ShadowAtlas(const ShadowAtlas&) = default;
+	ShadowAtlas(ShadowAtlas&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~ShadowAtlas() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	ShadowAtlas& operator=(const ShadowAtlas&) = default;
+	ShadowAtlas& operator=(ShadowAtlas&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Release every tile and resize the atlas
+	void reset(u32 atlas_size, u32 min_tile_size) {
+		allocator.reset(atlas_size, min_tile_size);
+		entries.clear();
+	}
+
+	// Assign tiles to the requested lights. Lights that were not requested release their tiles.
+	void update(std::span<const Request> requests) {
+		++frame;
+
+		// Mark the lights that were requested this frame
+		for (const auto& request : requests) {
+			if (const auto it = entries.find(request.key); it != entries.end()) {
+				it->second.priority       = request.priority;
+				it->second.last_requested = frame;
+			}
+		}
+
+		// Release the tiles of lights that weren't requested
+		std::erase_if(entries, [this](const auto& pair) {
+			if (pair.second.last_requested == frame)
+				return false;
+			allocator.free(pair.second.tile);
+			return true;
+		});
+
+		// Release the tiles that are much larger than the requested size
+		for (const auto& request : requests) {
+			const auto it = entries.find(request.key);
+			if (it == entries.end())
+				continue;
+
+			const u32 desired = allocator.getTileSize(request.size);
+			if (it->second.tile.size >= (desired * 4)) {
+				allocator.free(it->second.tile);
+				entries.erase(it);
+			}
+		}
+
+		// Allocate the remaining lights, and grow the tiles that are too small, in order of priority
+		order.assign(requests.begin(), requests.end());
+		std::ranges::stable_sort(order, std::greater{}, &Request::priority);
+
+		for (const auto& request : order) {
+			if (const auto it = entries.find(request.key); it != entries.end())
+				grow(it->second, allocator.getTileSize(request.size));
+			else
+				allocate(request);
+		}
+	}
+
+	// Get the tile assigned to a shadow map, or nullptr if the shadow map has no tile
+	[[nodiscard]]
+	const Tile* getTile(const ShadowMapKey& key) const noexcept {
+		const auto it = entries.find(key);
+		return (it != entries.end()) ? &it->second.tile : nullptr;
+	}
+
+	// Get the uv offset (xy) and scale (zw) that maps a [0,1] uv to the tile
+	[[nodiscard]]
+	f32_4 getTileTransform(const Tile& tile) const noexcept {
+		const auto atlas_size = static_cast<f32>(allocator.getAtlasSize());
+		return f32_4{
+			static_cast<f32>(tile.position[0]) / atlas_size,
+			static_cast<f32>(tile.position[1]) / atlas_size,
+			static_cast<f32>(tile.size) / atlas_size,
+			static_cast<f32>(tile.size) / atlas_size
+		};
+	}
+
+	[[nodiscard]]
+	u32 getAtlasSize() const noexcept {
+		return allocator.getAtlasSize();
+	}
+
+	[[nodiscard]]
+	u32 getMinTileSize() const noexcept {
+		return allocator.getMinTileSize();
+	}
+
+	[[nodiscard]]
+	const AtlasAllocator& getAllocator() const noexcept {
+		return allocator;
+	}
+
+private:
+
+	struct Entry {
+		Tile tile;
+		f32  priority       = 0.0f;
+		u64  last_requested = 0;
+	};
+
+	// Move a tile into the largest free block that's larger than it, up to the desired size.
+	// Nothing is evicted, and the tile is kept if no larger block is free.
+	void grow(Entry& entry, u32 desired) {
+		for (u32 size = desired; size > entry.tile.size; size /= 2) {
+			if (const auto tile = allocator.allocate(size)) {
+				allocator.free(entry.tile);
+				entry.tile = *tile;
+				return;
+			}
+		}
+	}
+
+	void allocate(const Request& request) {
+		u32 size = allocator.getTileSize(request.size);
+
+		while (true) {
+			if (const auto tile = allocator.allocate(size)) {
+				entries[request.key] = Entry{*tile, request.priority, frame};
+				return;
+			}
+
+			// Try a smaller tile
+			if (size > allocator.getMinTileSize()) {
+				size /= 2;
+				continue;
+			}
+
+			// Evict the lowest priority light with a lower priority than this one, then try
+			// again at the requested size.
+			const auto lowest = std::ranges::min_element(entries, {}, [](const auto& pair) {
+				return pair.second.priority;
+			});
+			if ((lowest == entries.end()) or (lowest->second.priority >= request.priority))
+				return;
+
+			allocator.free(lowest->second.tile);
+			entries.erase(lowest);
+			size = allocator.getTileSize(request.size);
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	AtlasAllocator allocator;
+
+	// The tile assigned to each shadow map
+	std::unordered_map<ShadowMapKey, Entry, ShadowMapKeyHash> entries;
+
+	// Requests sorted by priority (kept to avoid reallocating every frame)
+	std::vector<Request> order;
+
+	u64 frame = 0;
+};
+
+} //namespace render
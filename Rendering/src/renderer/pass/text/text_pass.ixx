@@ -1,20 +1,29 @@
 module;
 
+#include <algorithm>
+#include <vector>
+
 #include "datatypes/types.h"
-#include "memory/handle/handle.h"
 
 #include "directx/d3d11.h"
 #include "directx/directxtk.h"
 
 export module rendering:pass.text_pass;
 
-import ecs;
-import :components.text;
-import :components.transform;
+import :render_snapshot;
 
 
 namespace render {
 
+//----------------------------------------------------------------------------------
+// TextPass
+//----------------------------------------------------------------------------------
+//
+// Draws the snapshot's text. The texts are grouped by font, and each font is drawn in
+// a single SpriteBatch Begin/End, so the batch only flushes once per font. The glyphs
+// were laid out when each text last changed, so a glyph is a single sprite here.
+//
+//----------------------------------------------------------------------------------
 export class TextPass final {
 public:
 	//----------------------------------------------------------------------------------
@@ -41,26 +50,47 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void render(const ecs::ECS& ecs) const {
-		ecs.forEach<Transform, Text>([&](handle64 entity) {
-			const auto& transform = ecs.get<Transform>(entity);
-			const auto& text = ecs.get<Text>(entity);
+	void render(const RenderSnapshot& snapshot) {
+		if (snapshot.texts.empty())
+			return;
+
+		// Group the texts by font. Texts with the same font are kept in order, so they
+		// overlap the same way they did before.
+		sorted_texts.clear();
+		for (const auto& text : snapshot.texts) {
+			sorted_texts.push_back(&text);
+		}
+
+		std::ranges::stable_sort(sorted_texts, {}, [](const TextProxy* text) {
+			return text->font.get();
+		});
 
-			if (not text.isActive())
-				return;
+		for (auto begin = sorted_texts.begin(); begin != sorted_texts.end();) {
+			const auto* font = (*begin)->font.get();
+			const auto  end  = std::find_if(begin, sorted_texts.end(), [font](const TextProxy* text) {
+				return text->font.get() != font;
+			});
 
-			const auto& font = text.getFont();
+			auto* sprite_sheet = font->getSpriteSheet();
 
 			sprite_batch->Begin();
-			font.DrawString(sprite_batch.get(),
-				text.getText().c_str(),
-				transform.getRelativePosition(),
-				text.getColor(),
-				XMVectorGetZ(transform.getRelativeRotation()),
-				XMVectorZero(),
-				transform.getRelativeScale());
+			for (auto it = begin; it != end; ++it) {
+				const auto& text = **it;
+
+				for (const auto& glyph : *text.layout) {
+					sprite_batch->Draw(sprite_sheet,
+					                   text.position,
+					                   &glyph.source,
+					                   text.color,
+					                   text.rotation,
+					                   glyph.origin,
+					                   text.scale);
+				}
+			}
 			sprite_batch->End();
-		});
+
+			begin = end;
+		}
 	}
 
 private:
@@ -69,6 +99,9 @@ private:
 	// Member Variables
 	//----------------------------------------------------------------------------------
 	std::unique_ptr<SpriteBatch> sprite_batch;
+
+	// The snapshot's texts, sorted by font
+	std::vector<const TextProxy*> sorted_texts;
 };
 
 } //namespace render
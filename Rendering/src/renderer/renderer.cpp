@@ -7,6 +7,7 @@ module;
 
 #include "datatypes/scalar_types.h"
 #include "datatypes/vector_types.h"
+#include "profiler/profiler.h"
 
 #include "hlsl.h"
 
@@ -18,15 +19,14 @@ module;
 
 module rendering;
 
-import :components.camera.perspective_camera;
-import :components.camera.orthographic_camera;
-import :components.transform;
 import :display_config;
 import :gpu_profiler;
+import :render_snapshot;
 import :scene;
 import :pass.bounding_volume_pass;
 import :pass.deferred_pass;
 import :pass.depth_pass;
+import :pass.hi_z_pass;
 import :pass.forward_pass;
 import :pass.light_pass;
 import :pass.sky_pass;
@@ -46,8 +46,14 @@ Renderer::Renderer(DisplayConfig& display_config,
 	: device(device)
 	, device_context(device_context)
 	, display_config(display_config)
+	, rendering_config(rendering_config)
 	, profiler(device, device_context)
-	, engine_buffer(device) {
+	, engine_buffer(device)
+	, lod_settings(rendering_config.getLODSettings()) {
+
+	// Filter the redundant binds made on the device context
+	state_cache = std::make_unique<PipelineStateCache>();
+	Pipeline::setStateCache(device_context, state_cache.get());
 
 	// Bind the engine buffer (stays bound for the engine's lifetime)
 	engine_buffer.bind<Pipeline>(device_context, SLOT_CBUFFER_ENGINE);
@@ -58,6 +64,8 @@ Renderer::Renderer(DisplayConfig& display_config,
 
 	// Create renderers
 	light_pass           = std::make_unique<LightPass>(rendering_config, device, device_context, *render_state_mgr, resource_mgr);
+	depth_pass           = std::make_unique<DepthPass>(device, device_context, *render_state_mgr, resource_mgr);
+	hi_z_pass            = std::make_unique<HiZPass>(device, device_context, resource_mgr);
 	forward_pass         = std::make_unique<ForwardPass>(device, device_context, *render_state_mgr, resource_mgr);
 	deferred_pass        = std::make_unique<DeferredPass>(device_context, *render_state_mgr, resource_mgr);
 	sky_pass             = std::make_unique<SkyPass>(device_context, *render_state_mgr, resource_mgr);
@@ -68,10 +76,22 @@ Renderer::Renderer(DisplayConfig& display_config,
 
 // This needs to be defined in this implementation file so that the unique_ptr's holding incomplete
 // types won't cause a compile error.
-Renderer::~Renderer() = default;
+Renderer::~Renderer() {
+	// A moved-from renderer doesn't have a cache
+	if (state_cache and (Pipeline::getStateCache(device_context) == state_cache.get()))
+		Pipeline::setStateCache(device_context, nullptr);
+}
+
+
+void Renderer::extract(Scene& scene) {
+	ExtractRenderSnapshot(scene.getECS(), lod_settings, snapshots.getWriteSlot());
+	snapshots.publish();
+}
 
 
-void Renderer::render(Scene& scene, std::chrono::duration<f32> delta_time) {
+void Renderer::render(std::chrono::duration<f32> delta_time) {
+
+	const auto& snapshot = snapshots.acquire();
 
 	//----------------------------------------------------------------------------------
 	// Update the engine buffer
@@ -84,8 +104,18 @@ void Renderer::render(Scene& scene, std::chrono::duration<f32> delta_time) {
 	profiler.beginFrame();
 
 
-	profiler.beginTimestamp("Render Scene");
 	{
+		PROFILE_GPU_ZONE(profiler, "Render Scene");
+
+		//----------------------------------------------------------------------------------
+		// Render the shadow maps that are shared by every camera
+		//----------------------------------------------------------------------------------
+		{
+			PROFILE_GPU_ZONE(profiler, "Shadow Maps");
+			light_pass->beginFrame(snapshot);
+		}
+
+
 		//----------------------------------------------------------------------------------
 		// Bind the initial output state
 		//----------------------------------------------------------------------------------
@@ -95,29 +125,14 @@ void Renderer::render(Scene& scene, std::chrono::duration<f32> delta_time) {
 		//----------------------------------------------------------------------------------
 		// Render the scene for each camera
 		//----------------------------------------------------------------------------------
-		scene.getECS().forEach<PerspectiveCamera>([&](const PerspectiveCamera& camera) {
-			if (not camera.isActive())
-				return;
-
+		for (const auto& camera : snapshot.cameras) {
 			// Bind the buffer and viewport
 			camera.bindBuffer(device_context, SLOT_CBUFFER_CAMERA);
 			camera.bindViewport(device_context);
 
 			// Render the scene
-			renderCamera(scene, camera);
-		});
-
-		scene.getECS().forEach<OrthographicCamera>([&](const OrthographicCamera& camera) {
-			if (not camera.isActive())
-				return;
-
-			// Bind the buffer and viewport
-			camera.bindBuffer(device_context, SLOT_CBUFFER_CAMERA);
-			camera.bindViewport(device_context);
-
-			// Render the scene
-			renderCamera(scene, camera);
-		});
+			renderCamera(RenderView{snapshot, camera});
+		}
 
 
 		//----------------------------------------------------------------------------------
@@ -129,20 +144,25 @@ void Renderer::render(Scene& scene, std::chrono::duration<f32> delta_time) {
 		//----------------------------------------------------------------------------------
 		// Render text objects
 		//----------------------------------------------------------------------------------
-		profiler.beginTimestamp("Text");
-		text_pass->render(scene.getECS());
-		profiler.endTimestamp("Text");
+		{
+			PROFILE_GPU_ZONE(profiler, "Text");
+			text_pass->render(snapshot);
+
+			// SpriteBatch binds its state directly
+			Pipeline::invalidateState(device_context);
+		}
 	}
-	profiler.endTimestamp("Render Scene");
 
 
 	//----------------------------------------------------------------------------------
 	// Render ImGui data
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("ImGui");
-	ImGui::Render();
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-	profiler.endTimestamp("ImGui");
+	{
+		PROFILE_GPU_ZONE(profiler, "ImGui");
+		ImGui::Render();
+		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+		Pipeline::invalidateState(device_context);
+	}
 
 	
 	//----------------------------------------------------------------------------------
@@ -150,6 +170,8 @@ void Renderer::render(Scene& scene, std::chrono::duration<f32> delta_time) {
 	//----------------------------------------------------------------------------------
 	profiler.endFrame();
 	profiler.update();
+
+	bind_stats = state_cache->resetStats();
 }
 
 
@@ -163,38 +185,30 @@ void Renderer::updateBuffers(std::chrono::duration<f32> delta_time) {
 }
 
 
-// This function template is only called from within this translation unit so it can be defined here as well
-template<typename CameraT>
-void Renderer::renderCamera(Scene& scene, const CameraT& camera) {
+void Renderer::renderCamera(const RenderView& view) {
 
 	// Camera variables
-	const auto& settings  = camera.getSettings();
-	const auto* transform = scene.getECS().tryGet<Transform>(camera.getOwner());
-	assert(transform != nullptr);
-
-	const auto  world_to_camera      = transform->getWorldToObjectMatrix();
-	const auto  camera_to_projection = camera.getCameraToProjectionMatrix();
-	const auto  world_to_projection  = world_to_camera * camera_to_projection;
-	const auto* skybox               = settings.getSkybox();
+	const auto& settings            = view.camera.settings;
+	const auto  world_to_projection = view.camera.getWorldToProjectionMatrix();
 
 	//----------------------------------------------------------------------------------
 	// Render the scene
 	//----------------------------------------------------------------------------------
 	switch (settings.getRenderMode()) {
 		case RenderMode::Forward: {
-			renderForward(scene, camera, world_to_projection);
+			renderForward(view, false);
 			break;
 		}
 		case RenderMode::ForwardPlus: {
-			//renderForwardPlus(scene, camera, world_to_projection);
+			renderForward(view, true);
 			break;
 		}
 		case RenderMode::Deferred: {
-			renderDeferred(scene, camera, world_to_projection);
+			renderDeferred(view);
 			break;
 		}
 		case RenderMode::FalseColor: {
-			renderFalseColor(scene, camera, world_to_projection);
+			renderFalseColor(view);
 			break;
 		}
 		default: break;
@@ -205,89 +219,116 @@ void Renderer::renderCamera(Scene& scene, const CameraT& camera) {
 
 	// Render wireframes
 	if (settings.hasRenderOption(RenderOptions::Wireframe))
-		forward_pass->renderWireframe(scene.getECS(), world_to_projection, camera.getSettings().getWireframeColor());
+		forward_pass->renderWireframe(view, world_to_projection, settings.getWireframeColor());
 
 	// Render bounding volumes
 	if (settings.hasRenderOption(RenderOptions::BoundingVolume))
-		bounding_volume_pass->render(scene.getECS(), world_to_projection, camera.getSettings().getBoundingVolumeColor());
+		bounding_volume_pass->render(view.snapshot, world_to_projection, settings.getBoundingVolumeColor());
 
 	// Clear the bound forward state
 	output_mgr->bindEndForward(device_context);
 }
 
 
-template<typename CameraT>
-void XM_CALLCONV Renderer::renderForward(Scene& scene,
-                                         CameraT& camera,
-                                         FXMMATRIX world_to_projection) {
+void Renderer::renderForward(const RenderView& view, bool cluster_lights) {
 
-	const auto& settings = camera.getSettings();
+	const auto& camera   = view.camera;
+	const auto& settings = camera.settings;
 	const auto* skybox   = settings.getSkybox();
+	const auto  prepass  = rendering_config.getDepthPrepass();
+
+	const auto world_to_projection = camera.getWorldToProjectionMatrix();
 
 	//----------------------------------------------------------------------------------
 	// Process the light buffers
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Shadow Maps");
-	light_pass->render(scene.getECS(), world_to_projection);
-	profiler.endTimestamp("Shadow Maps");
+	{
+		PROFILE_GPU_ZONE(profiler, "Shadow Maps");
+		light_pass->render(view, camera.world_to_camera, camera.camera_to_projection, camera.z_depth, cluster_lights);
+	}
 
 
 	//----------------------------------------------------------------------------------
-	// Bind the camera's viewport and the forward output state
+	// Bind the camera's viewport
 	//----------------------------------------------------------------------------------
 	camera.bindViewport(device_context);
 
 
+	//----------------------------------------------------------------------------------
+	// Render the depth of the opaque models, and build the Hi-Z mip chain from it
+	//----------------------------------------------------------------------------------
+	if (prepass != DepthPrepass::None) {
+		{
+			PROFILE_GPU_ZONE(profiler, "Depth Prepass");
+			output_mgr->bindBeginDepth(device_context);
+			depth_pass->bindState();
+			depth_pass->renderPrepass(view, camera.world_to_camera, camera.camera_to_projection);
+			output_mgr->bindEndDepth(device_context);
+		}
+
+		if (prepass == DepthPrepass::DepthHiZ) {
+			PROFILE_GPU_ZONE(profiler, "Hi-Z");
+			hi_z_pass->render(output_mgr->getDepthSRV(), display_config.getDisplayResolution());
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Bind the forward output state
+	//----------------------------------------------------------------------------------
 	output_mgr->bindBeginForward(device_context);
 
 	//----------------------------------------------------------------------------------
 	// Render the skybox
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Skybox");
-	sky_pass->render(skybox);
-	profiler.endTimestamp("Skybox");
+	{
+		PROFILE_GPU_ZONE(profiler, "Skybox");
+		sky_pass->render(skybox);
+	}
 
 
 	//----------------------------------------------------------------------------------
 	// Render the scene
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Forward");
-
-	profiler.beginTimestamp("Opaque");
-	forward_pass->renderOpaque(scene.getECS(), world_to_projection, skybox, settings.getBRDF());
-	profiler.endTimestamp("Opaque");
-
-
-	profiler.beginTimestamp("Overrided Shaders");
-	forward_pass->renderOverrided(scene.getECS(), world_to_projection, skybox);
-	profiler.endTimestamp("Overrided Shaders");
+	{
+		PROFILE_GPU_ZONE(profiler, "Forward");
 
+		{
+			PROFILE_GPU_ZONE(profiler, "Opaque");
+			forward_pass->renderOpaque(view, world_to_projection, skybox, settings.getBRDF(), prepass != DepthPrepass::None);
+		}
 
-	profiler.beginTimestamp("Transparent");
-	forward_pass->renderTransparent(scene.getECS(), world_to_projection, skybox, settings.getBRDF());
-	profiler.endTimestamp("Transparent");
+		{
+			PROFILE_GPU_ZONE(profiler, "Overrided Shaders");
+			forward_pass->renderOverrided(view, world_to_projection, skybox);
+		}
 
-	profiler.endTimestamp("Forward");
+		{
+			PROFILE_GPU_ZONE(profiler, "Transparent");
+			forward_pass->renderTransparent(view, world_to_projection, skybox, settings.getBRDF());
+		}
+	}
 
 
 	output_mgr->bindEndForward(device_context);
 }
 
 
-template<typename CameraT>
-void XM_CALLCONV Renderer::renderDeferred(Scene& scene,
-                                          CameraT& camera,
-                                          FXMMATRIX world_to_projection) {
+void Renderer::renderDeferred(const RenderView& view) {
+
+	const auto& camera   = view.camera;
+	const auto& settings = camera.settings;
+	const auto* skybox   = settings.getSkybox();
 
-	const auto& settings = camera.getSettings();
-	const auto* skybox = settings.getSkybox();
+	const auto world_to_projection = camera.getWorldToProjectionMatrix();
 
 	//----------------------------------------------------------------------------------
 	// Process the light buffers
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Shadow Maps");
-	light_pass->render(scene.getECS(), world_to_projection);
-	profiler.endTimestamp("Shadow Maps");
+	{
+		PROFILE_GPU_ZONE(profiler, "Shadow Maps");
+		light_pass->render(view, camera.world_to_camera, camera.camera_to_projection, camera.z_depth, true);
+	}
 
 
 	//----------------------------------------------------------------------------------
@@ -299,21 +340,23 @@ void XM_CALLCONV Renderer::renderDeferred(Scene& scene,
 	//----------------------------------------------------------------------------------
 	// Render the gbuffer
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("GBuffer");
-	output_mgr->bindBeginGBuffer(device_context);
-	forward_pass->renderGBuffer(scene.getECS(), world_to_projection);
-	output_mgr->bindEndGBuffer(device_context);
-	profiler.endTimestamp("GBuffer");
+	{
+		PROFILE_GPU_ZONE(profiler, "GBuffer");
+		output_mgr->bindBeginGBuffer(device_context);
+		forward_pass->renderGBuffer(view, world_to_projection);
+		output_mgr->bindEndGBuffer(device_context);
+	}
 
 
 	//----------------------------------------------------------------------------------
 	// Deferred Render (opaque objects)
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Deferred");
-	output_mgr->bindBeginDeferred(device_context);
-	deferred_pass->render(settings.getBRDF());
-	output_mgr->bindEndDeferred(device_context);
-	profiler.endTimestamp("Deferred");
+	{
+		PROFILE_GPU_ZONE(profiler, "Deferred");
+		output_mgr->bindBeginDeferred(device_context);
+		deferred_pass->render(settings.getBRDF());
+		output_mgr->bindEndDeferred(device_context);
+	}
 
 
 	output_mgr->bindBeginForward(device_context);
@@ -321,42 +364,41 @@ void XM_CALLCONV Renderer::renderDeferred(Scene& scene,
 	//----------------------------------------------------------------------------------
 	// Render the skybox
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Skybox");
-	sky_pass->render(skybox);
-	profiler.endTimestamp("Skybox");
+	{
+		PROFILE_GPU_ZONE(profiler, "Skybox");
+		sky_pass->render(skybox);
+	}
 
 	
 	//----------------------------------------------------------------------------------
 	// Forward Render (overrided shaders and transparent objects)
 	//----------------------------------------------------------------------------------
-	profiler.beginTimestamp("Forward");
-
-	profiler.beginTimestamp("Opaque");
-	forward_pass->renderOverrided(scene.getECS(), world_to_projection, skybox);
-	profiler.endTimestamp("Opaque");
+	{
+		PROFILE_GPU_ZONE(profiler, "Forward");
 
-	profiler.beginTimestamp("Transparent");
-	forward_pass->renderTransparent(scene.getECS(), world_to_projection, skybox, settings.getBRDF());
-	profiler.endTimestamp("Transparent");
+		{
+			PROFILE_GPU_ZONE(profiler, "Opaque");
+			forward_pass->renderOverrided(view, world_to_projection, skybox);
+		}
 
-	profiler.endTimestamp("Forward");
+		{
+			PROFILE_GPU_ZONE(profiler, "Transparent");
+			forward_pass->renderTransparent(view, world_to_projection, skybox, settings.getBRDF());
+		}
+	}
 
 	output_mgr->bindEndForward(device_context);
 }
 
 
-template<typename CameraT>
-void XM_CALLCONV Renderer::renderFalseColor(Scene& scene,
-                                            CameraT& camera,
-                                            FXMMATRIX world_to_projection) {
-	profiler.beginTimestamp("Forward");
+void Renderer::renderFalseColor(const RenderView& view) {
+	PROFILE_GPU_ZONE(profiler, "Forward");
 	output_mgr->bindBeginForward(device_context);
 
-	const auto& settings = camera.getSettings();
-	forward_pass->renderFalseColor(scene.getECS(), world_to_projection, settings.getFalseColorMode());
+	const auto& settings = view.camera.settings;
+	forward_pass->renderFalseColor(view, view.camera.getWorldToProjectionMatrix(), settings.getFalseColorMode());
 
 	output_mgr->bindEndForward(device_context);
-	profiler.endTimestamp("Forward");
 }
 
 } //namespace render
\ No newline at end of file
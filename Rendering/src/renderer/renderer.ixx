@@ -7,6 +7,7 @@ module;
 
 #include "datatypes/scalar_types.h"
 #include "datatypes/vector_types.h"
+#include "thread/triple_buffer.h"
 
 #include "hlsl.h"
 #include "directx/d3d11.h"
@@ -17,7 +18,10 @@ import :gpu_profiler;
 import :buffer_types;
 import :constant_buffer;
 import :display_config;
+import :mesh_lod;
 import :output_mgr;
+import :pipeline;
+import :render_snapshot;
 import :render_state_mgr;
 import :rendering_config;
 import :resource_mgr;
@@ -25,6 +29,7 @@ import :swapchain;
 
 import :pass.light_pass;
 import :pass.depth_pass;
+import :pass.hi_z_pass;
 import :pass.sky_pass;
 import :pass.deferred_pass;
 import :pass.forward_pass;
@@ -73,33 +78,34 @@ public:
 		return profiler;
 	}
 
+	// The binds issued and skipped by the pipeline state cache in the last frame
+	[[nodiscard]]
+	const PipelineBindStats& getBindStats() const noexcept {
+		return bind_stats;
+	}
+
 	void onResize() {
 		output_mgr->resizeBuffers();
 	}
 
-	void render(Scene& scene, std::chrono::duration<f32> delta_time);
+	// Extract a snapshot of the scene to be rendered. Must not run concurrently with the
+	// scene's simulation. Doesn't use the GPU.
+	void extract(Scene& scene);
+
+	// Render the most recently extracted snapshot. Reads nothing from the scene, so the
+	// simulation may run concurrently.
+	void render(std::chrono::duration<f32> delta_time);
 
 private:
 
 	void updateBuffers(std::chrono::duration<f32> delta_time);
 
-	template<typename CameraT>
-	void renderCamera(Scene& scene, const CameraT& camera);
-
-	template<typename CameraT>
-	void XM_CALLCONV renderForward(Scene& scene,
-	                               CameraT& camera,
-	                               FXMMATRIX world_to_projection);
+	void renderCamera(const RenderView& view);
 
-	template<typename CameraT>
-	void XM_CALLCONV renderDeferred(Scene& scene,
-	                                CameraT& camera,
-	                                FXMMATRIX world_to_projection);
-
-	template<typename CameraT>
-	void XM_CALLCONV renderFalseColor(Scene& scene,
-	                                  CameraT& camera,
-	                                  FXMMATRIX world_to_projection);
+	// If cluster_lights is true, the forward shaders only evaluate the lights in each pixel's cluster
+	void renderForward(const RenderView& view, bool cluster_lights);
+	void renderDeferred(const RenderView& view);
+	void renderFalseColor(const RenderView& view);
 
 
 	//----------------------------------------------------------------------------------
@@ -110,20 +116,34 @@ private:
 	ID3D11Device&        device;
 	ID3D11DeviceContext& device_context;
 
-	DisplayConfig& display_config;
+	DisplayConfig&         display_config;
+	const RenderingConfig& rendering_config;
 
 	// State Managers
 	std::unique_ptr<OutputMgr>      output_mgr;
 	std::unique_ptr<RenderStateMgr> render_state_mgr;
 
+	// Drops redundant binds on the device context. Held by pointer, since the Pipeline
+	// refers to it by address.
+	std::unique_ptr<PipelineStateCache> state_cache;
+	PipelineBindStats                   bind_stats;
+
 	// Profiles render times for different render stages
 	GPUProfiler profiler;
 
 	// Buffers
 	ConstantBuffer<EngineBuffer> engine_buffer;
 
+	// Level of detail selection settings
+	LODSettings lod_settings;
+
+	// Extracted snapshots. The extracting side writes one slot while another is rendered.
+	TripleBuffer<RenderSnapshot> snapshots;
+
 	// Renderers
 	std::unique_ptr<LightPass>          light_pass;
+	std::unique_ptr<DepthPass>          depth_pass;
+	std::unique_ptr<HiZPass>            hi_z_pass;
 	std::unique_ptr<ForwardPass>        forward_pass;
 	std::unique_ptr<DeferredPass>       deferred_pass;
 	std::unique_ptr<SkyPass>            sky_pass;
@@ -0,0 +1,251 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/types.h"
+#include "memory/handle/handle.h"
+#include "profiler/profiler.h"
+
+#include "directx/d3d11.h"
+
+module rendering;
+
+import ecs;
+import math.geometry;
+
+import :components.camera.perspective_camera;
+import :components.camera.orthographic_camera;
+import :components.light.ambient_light;
+import :components.light.directional_light;
+import :components.light.point_light;
+import :components.light.spot_light;
+import :components.model;
+import :components.text;
+import :components.transform;
+import :mesh_lod;
+
+using namespace DirectX;
+
+namespace render {
+
+void ExtractModels(ecs::ECS& ecs, RenderSnapshot& snapshot) {
+	PROFILE_ZONE("Models");
+
+	ecs.forEach<Model, Transform>([&](handle64 entity) {
+		const auto& model     = ecs.get<Model>(entity);
+		const auto& transform = ecs.get<Transform>(entity);
+
+		if (not model.isActive())
+			return;
+
+		snapshot.models.push_back(ModelProxy{
+			.object_to_world = transform.getRenderObjectToWorldMatrix(),
+			.entity          = entity,
+			.handle          = model.getMeshHandle(),
+			.buffer          = model.getBuffer(),
+			.revision        = transform.getRenderRevision(),
+			.shadows         = model.castsShadows(),
+			.static_shadows  = model.hasStaticShadows()
+		});
+	});
+}
+
+
+void ExtractLights(const ecs::ECS& ecs, RenderSnapshot& snapshot) {
+	PROFILE_ZONE("Lights");
+
+	ecs.forEach<AmbientLight>([&](const AmbientLight& light) {
+		if (light.isActive())
+			snapshot.ambient_light += light.getColor();
+	});
+
+	ecs.forEach<Transform, DirectionalLight>([&](handle64 entity) {
+		const auto& transform = ecs.get<Transform>(entity);
+		const auto& light     = ecs.get<DirectionalLight>(entity);
+
+		if (not light.isActive())
+			return;
+
+		snapshot.directional_lights.push_back(DirectionalLightProxy{
+			.light_to_world      = transform.getRenderObjectToWorldMatrix(),
+			.world_to_light      = transform.getRenderWorldToObjectMatrix(),
+			.light_to_projection = light.getLightToProjectionMatrix(),
+			.entity              = entity,
+			.aabb                = light.getAABB(),
+			.intensity           = light.getBaseColor() * light.getIntensity(),
+			.shadows             = light.castsShadows()
+		});
+	});
+
+	ecs.forEach<Transform, PointLight>([&](handle64 entity) {
+		const auto& transform = ecs.get<Transform>(entity);
+		const auto& light     = ecs.get<PointLight>(entity);
+
+		if (not light.isActive())
+			return;
+
+		snapshot.point_lights.push_back(PointLightProxy{
+			.light_to_world      = transform.getRenderObjectToWorldMatrix(),
+			.world_to_light      = transform.getRenderWorldToObjectMatrix(),
+			.light_to_projection = light.getLightToProjectionMatrix(),
+			.entity              = entity,
+			.aabb                = light.getAABB(),
+			.bounds              = light.getBoundingSphere(),
+			.intensity           = light.getBaseColor() * light.getIntensity(),
+			.attenuation         = light.getAttenuation(),
+			.range               = light.getRange(),
+			.revision            = transform.getRenderRevision(),
+			.light_revision      = light.getRevision(),
+			.shadows             = light.castsShadows()
+		});
+	});
+
+	ecs.forEach<Transform, SpotLight>([&](handle64 entity) {
+		const auto& transform = ecs.get<Transform>(entity);
+		const auto& light     = ecs.get<SpotLight>(entity);
+
+		if (not light.isActive())
+			return;
+
+		snapshot.spot_lights.push_back(SpotLightProxy{
+			.light_to_world      = transform.getRenderObjectToWorldMatrix(),
+			.world_to_light      = transform.getRenderWorldToObjectMatrix(),
+			.light_to_projection = light.getLightToProjectionMatrix(),
+			.entity              = entity,
+			.aabb                = light.getAABB(),
+			.bounds              = light.getBoundingSphere(),
+			.intensity           = light.getBaseColor() * light.getIntensity(),
+			.attenuation         = light.getAttenuation(),
+			.cos_umbra           = light.getUmbra(),
+			.cos_penumbra        = light.getPenumbra(),
+			.range               = light.getRange(),
+			.revision            = transform.getRenderRevision(),
+			.light_revision      = light.getRevision(),
+			.shadows             = light.castsShadows()
+		});
+	});
+}
+
+
+template<typename CameraT>
+void ExtractCameras(const ecs::ECS& ecs, RenderSnapshot& snapshot) {
+
+	ecs.forEach<CameraT>([&](const CameraT& camera) {
+		if (not camera.isActive())
+			return;
+
+		const auto* transform = ecs.tryGet<Transform>(camera.getOwner());
+		assert(transform != nullptr);
+
+		auto& proxy = snapshot.cameras.emplace_back();
+		proxy.world_to_camera      = transform->getRenderWorldToObjectMatrix();
+		proxy.camera_to_projection = camera.getCameraToProjectionMatrix();
+		proxy.entity               = camera.getOwner();
+		proxy.buffer               = camera.getBuffer();
+		proxy.viewport             = camera.getViewport();
+		proxy.z_depth              = camera.getZDepth();
+		proxy.settings             = camera.getSettings();
+	});
+}
+
+
+// Select the level of detail of each model from its projected size in each camera's viewport
+void SelectLODs(ecs::ECS& ecs, const LODSettings& lod_settings, RenderSnapshot& snapshot) {
+	PROFILE_ZONE("Select LODs");
+
+	std::vector<Model*> models;
+	models.reserve(snapshot.models.size());
+	for (const auto& proxy : snapshot.models) {
+		models.push_back(&ecs.get<Model>(proxy.entity));
+	}
+
+	// Each selection starts from the level the camera last rendered the model with, so the
+	// hysteresis carries across frames without one camera disturbing another
+	for (auto& camera : snapshot.cameras) {
+		const auto world_to_projection = camera.getWorldToProjectionMatrix();
+		const f32  viewport_height     = static_cast<f32>(camera.viewport.getSize()[1]);
+
+		camera.lods.clear();
+		for (size_t i = 0; i < snapshot.models.size(); ++i) {
+			const auto& proxy = snapshot.models[i];
+			const auto  lods  = proxy.getLODs();
+
+			u32 lod = 0;
+			if (lods.size() > 1) {
+				const f32 radius = ProjectedRadius(proxy.object_to_world, world_to_projection, proxy.getBoundingSphere(), viewport_height);
+				lod = SelectLOD(lods, radius, models[i]->getLOD(camera.entity), lod_settings);
+				models[i]->setLOD(camera.entity, lod);
+			}
+
+			camera.lods.push_back(lod);
+		}
+	}
+
+	// Forget the selections of cameras that are no longer active
+	std::vector<handle64> active_cameras;
+	active_cameras.reserve(snapshot.cameras.size());
+	for (const auto& camera : snapshot.cameras) {
+		active_cameras.push_back(camera.entity);
+	}
+
+	for (auto* model : models) {
+		model->retainLODs(active_cameras);
+	}
+
+	// Shadow casters are drawn with the most detailed level any camera selected, so a cached
+	// shadow map stays valid for every camera
+	snapshot.shadow_lods.assign(snapshot.models.size(), 0);
+	for (size_t c = 0; c < snapshot.cameras.size(); ++c) {
+		const auto& lods = snapshot.cameras[c].lods;
+		for (size_t i = 0; i < lods.size(); ++i) {
+			snapshot.shadow_lods[i] = (c == 0) ? lods[i] : std::min(snapshot.shadow_lods[i], lods[i]);
+		}
+	}
+}
+
+
+void ExtractTexts(ecs::ECS& ecs, RenderSnapshot& snapshot) {
+
+	ecs.forEach<Transform, Text>([&](handle64 entity) {
+		const auto& transform = ecs.get<Transform>(entity);
+		auto&       text      = ecs.get<Text>(entity);
+
+		if (not text.isActive() or text.getLayout()->empty())
+			return;
+
+		const auto& placement = text.getPlacement(transform);
+
+		snapshot.texts.push_back(TextProxy{
+			.position = placement.position,
+			.scale    = placement.scale,
+			.color    = text.getColor(),
+			.rotation = placement.rotation,
+			.font     = text.getFontResource(),
+			.layout   = text.getLayout()
+		});
+	});
+}
+
+
+void ExtractRenderSnapshot(ecs::ECS& ecs, const LODSettings& lod_settings, RenderSnapshot& snapshot) {
+	PROFILE_ZONE("Extract Snapshot");
+
+	snapshot.clear();
+
+	ExtractModels(ecs, snapshot);
+	ExtractLights(ecs, snapshot);
+
+	// Perspective cameras are rendered before orthographic cameras
+	ExtractCameras<PerspectiveCamera>(ecs, snapshot);
+	ExtractCameras<OrthographicCamera>(ecs, snapshot);
+
+	SelectLODs(ecs, lod_settings, snapshot);
+
+	ExtractTexts(ecs, snapshot);
+}
+
+} //namespace render
@@ -0,0 +1,274 @@
+module;
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/types.h"
+#include "memory/handle/handle.h"
+
+#include "directx/d3d11.h"
+
+export module rendering:render_snapshot;
+
+import ecs;
+import math.geometry;
+
+import :components.camera.camera_base;
+import :font;
+import :material;
+import :mesh_lod;
+import :model_blueprint;
+import :pipeline;
+import :viewport;
+
+using namespace DirectX;
+
+export namespace render {
+
+//----------------------------------------------------------------------------------
+// Render Proxies
+//----------------------------------------------------------------------------------
+//
+// The state needed to render an entity, copied out of the ECS. A proxy doesn't refer
+// to any component. GPU resources and blueprints are held by reference count, so a
+// proxy stays valid if the simulation destroys its entity while it's being rendered.
+//
+// Materials and meshes are read through the blueprint rather than copied. They are
+// only modified between frames (by the UI and by hot reloading), never by the
+// simulation.
+//
+//----------------------------------------------------------------------------------
+
+struct ModelProxy {
+	void bindMesh(ID3D11DeviceContext& device_context) const {
+		handle.getMesh().bind(device_context);
+	}
+
+	template<typename StageT>
+	void bindBuffer(ID3D11DeviceContext& device_context, u32 slot) const {
+		StageT::bindConstantBuffer(device_context, slot, buffer.Get());
+	}
+
+	[[nodiscard]]
+	const Material& getMaterial() const noexcept {
+		return handle.getMaterial();
+	}
+
+	[[nodiscard]]
+	const AABB& getAABB() const noexcept {
+		return handle.getAABB();
+	}
+
+	[[nodiscard]]
+	const BoundingSphere& getBoundingSphere() const noexcept {
+		return handle.getBoundingSphere();
+	}
+
+	[[nodiscard]]
+	bool hasQuantizedVertices() const noexcept {
+		return handle.getMesh().isQuantized();
+	}
+
+	[[nodiscard]]
+	std::span<const MeshLOD> getLODs() const noexcept {
+		return handle.getMesh().getLODs();
+	}
+
+	[[nodiscard]]
+	const MeshLOD& getLODRange(u32 lod) const noexcept {
+		return handle.getMesh().getLOD(lod);
+	}
+
+	// Changes when the model's blueprint is reloaded
+	[[nodiscard]]
+	u32 getModelRevision() const noexcept {
+		return handle.getRevision();
+	}
+
+
+	XMMATRIX             object_to_world;
+	handle64             entity;
+	MeshHandle           handle;
+	ComPtr<ID3D11Buffer> buffer;
+	u32                  revision = 0; //transform render revision
+	bool                 shadows        = true;
+	bool                 static_shadows = false;
+};
+
+
+struct DirectionalLightProxy {
+	XMMATRIX light_to_world;
+	XMMATRIX world_to_light;
+	XMMATRIX light_to_projection;
+	handle64 entity;
+	AABB     aabb;
+	f32_3    intensity = {}; //color * intensity
+	bool     shadows   = false;
+};
+
+
+struct PointLightProxy {
+	XMMATRIX       light_to_world;
+	XMMATRIX       world_to_light;
+	XMMATRIX       light_to_projection;
+	handle64       entity;
+	AABB           aabb;
+	BoundingSphere bounds;  //object space
+	f32_3          intensity   = {};
+	f32_3          attenuation = {};
+	f32            range          = 0.0f;
+	u32            revision       = 0;  //transform render revision
+	u32            light_revision = 0;  //light parameter revision
+	bool           shadows        = false;
+};
+
+
+struct SpotLightProxy {
+	XMMATRIX       light_to_world;
+	XMMATRIX       world_to_light;
+	XMMATRIX       light_to_projection;
+	handle64       entity;
+	AABB           aabb;
+	BoundingSphere bounds;  //object space
+	f32_3          intensity    = {};
+	f32_3          attenuation  = {};
+	f32            cos_umbra    = 0.0f;
+	f32            cos_penumbra = 0.0f;
+	f32            range          = 0.0f;
+	u32            revision       = 0;  //transform render revision
+	u32            light_revision = 0;  //light parameter revision
+	bool           shadows        = false;
+};
+
+
+struct CameraProxy {
+	void bindBuffer(ID3D11DeviceContext& device_context, u32 slot) const {
+		Pipeline::bindConstantBuffer(device_context, slot, buffer.Get());
+	}
+
+	void bindViewport(ID3D11DeviceContext& device_context) const {
+		viewport.bind(device_context);
+	}
+
+	[[nodiscard]]
+	XMMATRIX XM_CALLCONV getWorldToProjectionMatrix() const noexcept {
+		return world_to_camera * camera_to_projection;
+	}
+
+
+	XMMATRIX             world_to_camera;
+	XMMATRIX             camera_to_projection;
+	handle64             entity;
+	ComPtr<ID3D11Buffer> buffer;
+	Viewport             viewport;
+	f32_2                z_depth = {};
+	CameraSettings       settings;
+
+	// The level of detail selected for each of the snapshot's models, in the same order
+	std::vector<u32> lods;
+};
+
+
+// The glyphs are laid out once per change of the text, and shared with the component
+struct TextProxy {
+	XMFLOAT2                          position;
+	XMFLOAT2                          scale;
+	XMVECTORF32                       color;
+	f32                               rotation = 0.0f;
+	std::shared_ptr<Font>             font;
+	std::shared_ptr<const TextLayout> layout;
+};
+
+
+
+
+//----------------------------------------------------------------------------------
+// RenderSnapshot
+//----------------------------------------------------------------------------------
+//
+// Everything the renderer draws in a frame, extracted from the scene at a point where
+// the simulation is idle. Once extracted, a snapshot is immutable and the renderer
+// reads nothing else from the scene, so the simulation can run its next steps while
+// the snapshot is rendered.
+//
+// Snapshots are reused between frames, so clear() keeps the capacity of the arrays.
+//
+//----------------------------------------------------------------------------------
+struct RenderSnapshot {
+
+	void clear() noexcept {
+		models.clear();
+		directional_lights.clear();
+		point_lights.clear();
+		spot_lights.clear();
+		cameras.clear();
+		texts.clear();
+		shadow_lods.clear();
+		ambient_light = {};
+	}
+
+	// Call func(const ModelProxy&, u32 lod) for each model that casts shadows, with the
+	// level of detail its shadows are drawn with
+	template<typename FunctionT>
+	void forEachShadowCaster(FunctionT&& func) const {
+		for (size_t i = 0; i < models.size(); ++i) {
+			if (models[i].shadows)
+				func(models[i], shadow_lods[i]);
+		}
+	}
+
+	// Active models, cameras, lights, and text objects. Cameras are in render order.
+	std::vector<ModelProxy>            models;
+	std::vector<DirectionalLightProxy> directional_lights;
+	std::vector<PointLightProxy>       point_lights;
+	std::vector<SpotLightProxy>        spot_lights;
+	std::vector<CameraProxy>           cameras;
+	std::vector<TextProxy>             texts;
+
+	// The level of detail each model's shadows are drawn with, in the same order as the
+	// models. Shadow maps are shared by every camera, so this doesn't depend on a camera.
+	std::vector<u32> shadow_lods;
+
+	// The sum of the active ambient lights
+	f32_3 ambient_light = {};
+};
+
+
+//----------------------------------------------------------------------------------
+// RenderView
+//----------------------------------------------------------------------------------
+//
+// A snapshot as seen by one of its cameras
+//
+//----------------------------------------------------------------------------------
+struct RenderView {
+
+	// Call func(const ModelProxy&, u32 lod) for each model, with the level of detail
+	// selected for this view's camera
+	template<typename FunctionT>
+	void forEachModel(FunctionT&& func) const {
+		for (size_t i = 0; i < snapshot.models.size(); ++i) {
+			func(snapshot.models[i], camera.lods[i]);
+		}
+	}
+
+	const RenderSnapshot& snapshot;
+	const CameraProxy&    camera;
+};
+
+
+//----------------------------------------------------------------------------------
+// Extraction
+//----------------------------------------------------------------------------------
+
+// Copy the state needed to render the scene out of its ECS, and select the level of
+// detail of each model for each camera and for its shadows. Each camera's selection is
+// stored in the Model components, so the LOD hysteresis of each camera carries over to
+// the next frame. Must not run concurrently with the simulation. Doesn't use the GPU.
+void ExtractRenderSnapshot(ecs::ECS& ecs, const LODSettings& lod_settings, RenderSnapshot& snapshot);
+
+} //namespace render
@@ -69,13 +69,13 @@ HRESULT RenderStateMgr::createBlendState(ID3D11Device& device,
 HRESULT RenderStateMgr::createDepthStencilState(ID3D11Device& device,
                                                 bool enable,
                                                 bool write_enable,
-                                                bool depth_greater,
+                                                D3D11_COMPARISON_FUNC depth_func,
                                                 gsl::not_null<ID3D11DepthStencilState**> p_result) const {
 	D3D11_DEPTH_STENCIL_DESC desc = {};
 
 	desc.DepthEnable    = enable ? TRUE : FALSE;
 	desc.DepthWriteMask = write_enable ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
-	desc.DepthFunc      = depth_greater ? D3D11_COMPARISON_GREATER_EQUAL : D3D11_COMPARISON_LESS_EQUAL;
+	desc.DepthFunc      = depth_func;
 
 	desc.StencilEnable    = FALSE;
 	desc.StencilReadMask  = D3D11_DEFAULT_STENCIL_READ_MASK;
@@ -184,7 +184,7 @@ void RenderStateMgr::createDepthStencilStates(ID3D11Device& device) {
 	ThrowIfFailed(createDepthStencilState(device,
 	                                      false,
 	                                      false,
-	                                      false,
+	                                      D3D11_COMPARISON_LESS_EQUAL,
 	                                      getAddressOf(DepthStencilStates::None)),
 	              "Error creating None depth stencil state");
 
@@ -192,7 +192,7 @@ void RenderStateMgr::createDepthStencilStates(ID3D11Device& device) {
 	ThrowIfFailed(createDepthStencilState(device,
 	                                      true,
 	                                      false,
-	                                      false,
+	                                      D3D11_COMPARISON_LESS_EQUAL,
 	                                      getAddressOf(DepthStencilStates::LessEqR)),
 				  "Error creating LessEqR depth stencil state");
 
@@ -200,7 +200,7 @@ void RenderStateMgr::createDepthStencilStates(ID3D11Device& device) {
 	ThrowIfFailed(createDepthStencilState(device,
 	                                      true,
 	                                      true,
-	                                      false,
+	                                      D3D11_COMPARISON_LESS_EQUAL,
 	                                      getAddressOf(DepthStencilStates::LessEqRW)),
 	              "Error creating LessEqRW depth stencil state");
 
@@ -208,7 +208,7 @@ void RenderStateMgr::createDepthStencilStates(ID3D11Device& device) {
 	ThrowIfFailed(createDepthStencilState(device,
 	                                      true,
 	                                      false,
-	                                      true,
+	                                      D3D11_COMPARISON_GREATER_EQUAL,
 	                                      getAddressOf(DepthStencilStates::GreaterEqR)),
 				  "Error creating GreaterEqR depth stencil state");
 
@@ -216,9 +216,17 @@ void RenderStateMgr::createDepthStencilStates(ID3D11Device& device) {
 	ThrowIfFailed(createDepthStencilState(device,
 	                                      true,
 	                                      true,
-	                                      true,
+	                                      D3D11_COMPARISON_GREATER_EQUAL,
 	                                      getAddressOf(DepthStencilStates::GreaterEqRW)),
 				  "Error creating GreaterEqRW depth stencil state");
+
+	// Equal R
+	ThrowIfFailed(createDepthStencilState(device,
+	                                      true,
+	                                      false,
+	                                      D3D11_COMPARISON_EQUAL,
+	                                      getAddressOf(DepthStencilStates::EqualR)),
+	              "Error creating EqualR depth stencil state");
 }
 
 
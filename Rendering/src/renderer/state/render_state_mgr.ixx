@@ -71,7 +71,7 @@ private:
 	HRESULT createDepthStencilState(ID3D11Device& device,
 	                                bool enable,
 	                                bool write_enable,
-	                                bool depth_greater,
+	                                D3D11_COMPARISON_FUNC depth_func,
 	                                _Out_ gsl::not_null<ID3D11DepthStencilState**> p_result) const;
 
 	HRESULT createRasterizerState(ID3D11Device& device,
@@ -21,6 +21,7 @@ enum class DepthStencilStates : u8 {
 	LessEqRW,
 	GreaterEqR,
 	GreaterEqRW,
+	EqualR,
 	StateCount
 };
 
@@ -33,6 +33,7 @@ export import :swapchain;
 // rendering/directx
 export import :pipeline;
 export import :vertex_types;
+export import :vertex_compression;
 export import :gpu_profiler;
 
 // rendering/display
@@ -55,6 +56,10 @@ export import :exporter.texture_exporter;
 
 // rendering/importer
 export import :importer.assimp_importer;
+export import :importer.import_benchmark;
+export import :importer.mesh_optimizer;
+export import :importer.mesh_simplifier;
+export import :importer.model_cache;
 export import :importer.model_importer;
 export import :importer.texture_importer;
 
@@ -63,11 +68,15 @@ export import :renderer;
 export import :output_mgr;
 export import :render_state_mgr;
 export import :render_states;
+export import :render_snapshot;
 export import :pass.bounding_volume_pass;
 export import :pass.deferred_pass;
 export import :pass.depth_pass;
+export import :pass.hi_z_pass;
 export import :pass.forward_pass;
 export import :pass.light_pass;
+export import :pass.shadow_atlas;
+export import :pass.light_clusters;
 export import :pass.sky_pass;
 export import :pass.text_pass;
 
@@ -76,8 +85,10 @@ export import :resource;
 export import :resource_mgr;
 export import :font;
 export import :mesh;
+export import :mesh_lod;
 export import :material;
 export import :material_factory;
+export import :material_registry;
 export import :model_blueprint;
 export import :blueprint_factory;
 export import :model_config;
@@ -85,6 +96,8 @@ export import :model_output;
 export import :shader;
 export import :shader_bytecode;
 export import :shader_factory;
+export import :streaming_mgr;
+export import :resource_streaming_source;
 export import :texture;
 export import :texture_factory;
 
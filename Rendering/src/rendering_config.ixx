@@ -1,11 +1,16 @@
 module;
 
+#include <algorithm>
+
 #include "datatypes/scalar_types.h"
 #include "engine/config/config_tokens.h"
 #include "json/nlohmann_json.h"
 
+#include "hlsl.h"
+
 export module rendering:rendering_config;
 
+import :mesh_lod;
 import :rendering_options;
 
 
@@ -39,7 +44,8 @@ public:
 	//----------------------------------------------------------------------------------
 
 	// Shadow maps are square, so only one value is needed. The provided resolution must
-	// be greater than 0, or no change will occur.
+	// be greater than 0, or no change will occur. This is the maximum resolution of a
+	// single shadow map tile in the atlas, and the resolution of each shadow cube map face.
 	void setShadowMapRes(u32 res) noexcept {
 		if (res != 0) smap_res = res;
 	}
@@ -49,6 +55,59 @@ public:
 		return smap_res;
 	}
 
+	// Directional and spot light shadow maps are packed into a single square atlas. Each
+	// light is given a tile sized by its screen coverage, and lights that don't fit in
+	// the atlas are rendered without shadows.
+	void setShadowMapAtlasRes(u32 res) noexcept {
+		if (res != 0) smap_atlas_res = res;
+	}
+
+	[[nodiscard]]
+	u32 getShadowMapAtlasRes() const noexcept {
+		return smap_atlas_res;
+	}
+
+	// The maximum number of point lights that can cast shadows at once
+	void setShadowMapCubeMapCount(u32 count) noexcept {
+		smap_cube_map_count = count;
+	}
+
+	[[nodiscard]]
+	u32 getShadowMapCubeMapCount() const noexcept {
+		return smap_cube_map_count;
+	}
+
+	// Directional lights split the camera's view into cascades, each with its own shadow map
+	// tile. A count of 0 disables cascades, and the light's own projection is used instead.
+	void setShadowMapCascadeCount(u32 count) noexcept {
+		smap_cascade_count = std::min<u32>(count, MAX_SHADOW_CASCADES);
+	}
+
+	[[nodiscard]]
+	u32 getShadowMapCascadeCount() const noexcept {
+		return smap_cascade_count;
+	}
+
+	// Blend between uniform (0) and logarithmic (1) cascade splits
+	void setShadowMapCascadeLambda(f32 lambda) noexcept {
+		smap_cascade_lambda = std::clamp(lambda, 0.0f, 1.0f);
+	}
+
+	[[nodiscard]]
+	f32 getShadowMapCascadeLambda() const noexcept {
+		return smap_cascade_lambda;
+	}
+
+	// The distance from the camera covered by the cascades
+	void setShadowMapCascadeDistance(f32 distance) noexcept {
+		if (distance > 0.0f) smap_cascade_distance = distance;
+	}
+
+	[[nodiscard]]
+	f32 getShadowMapCascadeDistance() const noexcept {
+		return smap_cascade_distance;
+	}
+
 	void setShadowMapDepthBias(i32 depth_bias) noexcept {
 		smap_depth_bias = depth_bias;
 	}
@@ -76,15 +135,96 @@ public:
 		return smap_depth_bias_clamp;
 	}
 
+	// Shadow map caching prevents a shadow map from being re-rendered unless its light
+	// or a shadow caster within the light's volume has changed.
+	void setShadowMapCaching(bool state) noexcept {
+		smap_caching = state;
+	}
+
+	[[nodiscard]]
+	bool isShadowMapCachingEnabled() const noexcept {
+		return smap_caching;
+	}
+
+	// The static cache keeps a separate copy of each shadow map that contains only static
+	// shadow casters. Dynamic casters are then composited on top of the static copy.
+	void setShadowMapStaticCache(bool state) noexcept {
+		smap_static_cache = state;
+	}
+
+	[[nodiscard]]
+	bool isShadowMapStaticCacheEnabled() const noexcept {
+		return smap_static_cache;
+	}
+
+	// The largest acceptable simplification error of a model's level of detail, in pixels.
+	// Higher values select coarser levels.
+	void setLODPixelError(f32 error) noexcept {
+		if (error > 0.0f) lod_settings.pixel_error = error;
+	}
+
+	[[nodiscard]]
+	f32 getLODPixelError() const noexcept {
+		return lod_settings.pixel_error;
+	}
+
+	// The fraction the error must pass the threshold by before a model's level of detail
+	// changes. Prevents flickering between levels near a transition.
+	void setLODHysteresis(f32 hysteresis) noexcept {
+		lod_settings.hysteresis = std::clamp(hysteresis, 0.0f, 0.9f);
+	}
+
+	[[nodiscard]]
+	f32 getLODHysteresis() const noexcept {
+		return lod_settings.hysteresis;
+	}
+
+	[[nodiscard]]
+	const LODSettings& getLODSettings() const noexcept {
+		return lod_settings;
+	}
+
+	// The depth pre-pass of the forward path. The pre-pass renders the depth of the opaque
+	// models front to back, so the expensive shading pass only shades visible surfaces.
+	void setDepthPrepass(DepthPrepass mode) noexcept {
+		depth_prepass = mode;
+	}
+
+	[[nodiscard]]
+	DepthPrepass getDepthPrepass() const noexcept {
+		return depth_prepass;
+	}
+
+	// Reload textures and models when the files they were loaded from change
+	void setHotReload(bool state) noexcept {
+		hot_reload = state;
+	}
+
+	[[nodiscard]]
+	bool isHotReloadEnabled() const noexcept {
+		return hot_reload;
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Friend Functions - JSON Serialization
 	//----------------------------------------------------------------------------------
 	friend void to_json(nl::json& j, const RenderingConfig& cfg) {
 		j[ConfigTokens::smap_res]                     = cfg.smap_res;
+		j[ConfigTokens::smap_atlas_res]               = cfg.smap_atlas_res;
+		j[ConfigTokens::smap_cube_map_count]          = cfg.smap_cube_map_count;
+		j[ConfigTokens::smap_cascade_count]           = cfg.smap_cascade_count;
+		j[ConfigTokens::smap_cascade_lambda]          = cfg.smap_cascade_lambda;
+		j[ConfigTokens::smap_cascade_distance]        = cfg.smap_cascade_distance;
 		j[ConfigTokens::smap_depth_bias]              = cfg.smap_depth_bias;
 		j[ConfigTokens::smap_slope_scaled_depth_bias] = cfg.smap_slope_scaled_depth_bias;
 		j[ConfigTokens::smap_depth_bias_clamp]        = cfg.smap_depth_bias_clamp;
+		j[ConfigTokens::smap_caching]                 = cfg.smap_caching;
+		j[ConfigTokens::smap_static_cache]            = cfg.smap_static_cache;
+		j[ConfigTokens::lod_pixel_error]              = cfg.lod_settings.pixel_error;
+		j[ConfigTokens::lod_hysteresis]               = cfg.lod_settings.hysteresis;
+		j[ConfigTokens::depth_prepass]                = cfg.depth_prepass;
+		j[ConfigTokens::hot_reload]                   = cfg.hot_reload;
 	}
 
 	friend void from_json(const nl::json& j, RenderingConfig& cfg) {
@@ -93,6 +233,23 @@ public:
 			cfg.setShadowMapRes(res);
 		}
 
+		if (j.contains(ConfigTokens::smap_atlas_res)) {
+			const auto res = j.at(ConfigTokens::smap_atlas_res).get<u32>();
+			cfg.setShadowMapAtlasRes(res);
+		}
+
+		if (j.contains(ConfigTokens::smap_cube_map_count))
+			j.at(ConfigTokens::smap_cube_map_count).get_to(cfg.smap_cube_map_count);
+
+		if (j.contains(ConfigTokens::smap_cascade_count))
+			cfg.setShadowMapCascadeCount(j.at(ConfigTokens::smap_cascade_count).get<u32>());
+
+		if (j.contains(ConfigTokens::smap_cascade_lambda))
+			cfg.setShadowMapCascadeLambda(j.at(ConfigTokens::smap_cascade_lambda).get<f32>());
+
+		if (j.contains(ConfigTokens::smap_cascade_distance))
+			cfg.setShadowMapCascadeDistance(j.at(ConfigTokens::smap_cascade_distance).get<f32>());
+
 		if (j.contains(ConfigTokens::smap_depth_bias))
 			j.at(ConfigTokens::smap_depth_bias).get_to(cfg.smap_depth_bias);
 
@@ -101,6 +258,26 @@ public:
 
 		if (j.contains(ConfigTokens::smap_depth_bias_clamp))
 			j.at(ConfigTokens::smap_depth_bias_clamp).get_to(cfg.smap_depth_bias_clamp);
+
+		if (j.contains(ConfigTokens::smap_caching))
+			j.at(ConfigTokens::smap_caching).get_to(cfg.smap_caching);
+
+		if (j.contains(ConfigTokens::smap_static_cache))
+			j.at(ConfigTokens::smap_static_cache).get_to(cfg.smap_static_cache);
+
+		if (j.contains(ConfigTokens::lod_pixel_error))
+			cfg.setLODPixelError(j.at(ConfigTokens::lod_pixel_error).get<f32>());
+
+		if (j.contains(ConfigTokens::lod_hysteresis))
+			cfg.setLODHysteresis(j.at(ConfigTokens::lod_hysteresis).get<f32>());
+
+		if (j.contains(ConfigTokens::depth_prepass)) {
+			const auto mode = static_cast<DepthPrepass>(j.at(ConfigTokens::depth_prepass).get<u32>());
+			cfg.setDepthPrepass(mode);
+		}
+
+		if (j.contains(ConfigTokens::hot_reload))
+			j.at(ConfigTokens::hot_reload).get_to(cfg.hot_reload);
 	}
 
 
@@ -109,9 +286,19 @@ private:
 	// Member Variables
 	//----------------------------------------------------------------------------------
 	u32 smap_res                     = 512;
+	u32 smap_atlas_res               = 4096;
+	u32 smap_cube_map_count          = 4;
+	u32 smap_cascade_count           = 4;
+	f32 smap_cascade_lambda          = 0.75f;
+	f32 smap_cascade_distance        = 100.0f;
 	i32 smap_depth_bias              = 50;
 	f32 smap_slope_scaled_depth_bias = 1.0f;
 	f32 smap_depth_bias_clamp        = 0.0f;
+	bool smap_caching                = true;
+	bool smap_static_cache           = false;
+	LODSettings lod_settings;
+	DepthPrepass depth_prepass       = DepthPrepass::None;
+	bool hot_reload                  = true;
 };
 
 } //namespace render
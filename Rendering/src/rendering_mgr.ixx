@@ -11,6 +11,7 @@ export module rendering:rendering_mgr;
 
 import :display_config;
 import :gpu_profiler;
+import :pipeline;
 import :rendering_config;
 import :renderer;
 import :resource_mgr;
@@ -62,8 +63,12 @@ public:
 	// End the current frame
 	void endFrame() const;
 
-	// Render the current scene
-	void render(Scene& scene, std::chrono::duration<f32> delta_time) const;
+	// Extract the state of the scene to be rendered. Must not run concurrently with the
+	// scene's simulation.
+	void extract(Scene& scene) const;
+
+	// Render the most recently extracted state of the scene
+	void render(std::chrono::duration<f32> delta_time) const;
 
 
 	//----------------------------------------------------------------------------------
@@ -97,6 +102,10 @@ public:
 	[[nodiscard]]
 	const GPUProfiler& getProfiler() const;
 
+	// The binds issued and skipped by the pipeline state cache in the last frame
+	[[nodiscard]]
+	const PipelineBindStats& getBindStats() const;
+
 
 private:
 	//----------------------------------------------------------------------------------
@@ -27,6 +27,13 @@ enum class RenderOptions : u8 {
 	Wireframe      = 1 << 2,
 };
 
+// How the forward path uses a depth pre-pass
+enum class DepthPrepass : u8 {
+	None = 0,  //opaque models are shaded with a less-equal depth test
+	Depth,     //opaque depth is rendered first, and only the visible surfaces are shaded
+	DepthHiZ,  //also builds a Hi-Z mip chain from the pre-pass depth
+};
+
 enum class BRDF : u8 {
 	Lambert = 0,
 	BlinnPhong,
@@ -1,16 +1,23 @@
 module;
 
+#include <algorithm>
+#include <limits>
+#include <span>
 #include <typeinfo>
 #include <typeindex>
+#include <vector>
 
 #include "datatypes/scalar_types.h"
+#include "memory/memory_tracker.h"
 
 #include "directx/d3d11.h"
 
 export module rendering:mesh;
 
 import exception;
+import :mesh_lod;
 import :pipeline;
+import :vertex_compression;
 
 
 namespace render {
@@ -26,13 +33,44 @@ public:
 	     const std::string& name,
 	     const std::vector<VertexT>& vertices,
 	     const std::vector<u32>& indices)
+		: Mesh(device, name, std::span<const VertexT>{vertices}, std::span<const u32>{indices}) {
+	}
+
+	// The index buffer holds the indices of every level of detail. If no levels are given,
+	// the whole index buffer is the only level. The quantization maps the positions of a
+	// quantized vertex type back to object space. If compact_indices is true, 16-bit indices
+	// are used when the vertex count allows.
+	template<typename VertexT>
+	Mesh(ID3D11Device& device,
+	     const std::string& name,
+	     std::span<const VertexT> vertices,
+	     std::span<const u32> indices,
+	     std::span<const MeshLOD> lods = {},
+	     const VertexQuantization& quantization = {},
+	     bool compact_indices = true)
 		: name(name)
+		, quantization(quantization)
+		, quantized(VertexT::isQuantized())
 		, vertex_type(typeid(VertexT)) {
 
 		vertex_count = static_cast<u32>(vertices.size());
 		index_count  = static_cast<u32>(indices.size());
 		stride       = sizeof(VertexT);
 
+		// 0xFFFF is left out since it's the strip cut value
+		std::vector<u16> indices_16;
+		if (compact_indices and (vertex_count < std::numeric_limits<u16>::max())) {
+			index_format = DXGI_FORMAT_R16_UINT;
+			indices_16.reserve(indices.size());
+			for (const u32 index : indices)
+				indices_16.push_back(static_cast<u16>(index));
+		}
+
+		if (lods.empty())
+			this->lods.push_back(MeshLOD{0, index_count, 0.0f});
+		else
+			this->lods.assign(lods.begin(), lods.end());
+
 		D3D11_BUFFER_DESC vb_desc = {};
 		D3D11_BUFFER_DESC ib_desc = {};
 
@@ -49,7 +87,7 @@ public:
 		vb_desc.StructureByteStride = 0;
 
 		// Give the subresource structure a pointer to the vertex data
-		vb_data.pSysMem          = const_cast<VertexT*>(vertices.data());
+		vb_data.pSysMem          = vertices.data();
 		vb_data.SysMemPitch      = 0;
 		vb_data.SysMemSlicePitch = 0;
 
@@ -60,20 +98,22 @@ public:
 
 		// Index buffer description
 		ib_desc.Usage               = D3D11_USAGE_DEFAULT;
-		ib_desc.ByteWidth           = sizeof(u32) * index_count;
+		ib_desc.ByteWidth           = getIndexSize() * index_count;
 		ib_desc.BindFlags           = D3D11_BIND_INDEX_BUFFER;
 		ib_desc.CPUAccessFlags      = 0;
 		ib_desc.MiscFlags           = 0;
 		ib_desc.StructureByteStride = 0;
 
 		// Give the subresource structure a pointer to the index data
-		ib_data.pSysMem          = const_cast<u32*>(indices.data());
+		ib_data.pSysMem          = indices_16.empty() ? static_cast<const void*>(indices.data()) : indices_16.data();
 		ib_data.SysMemPitch      = 0;
 		ib_data.SysMemSlicePitch = 0;
 
 		// Create index buffer
 		ThrowIfFailed(device.CreateBuffer(&ib_desc, &ib_data, index_buffer.GetAddressOf()),
 					  "Failed to create mesh index buffer");
+
+		memory = TrackedMemory{MemoryTag::Meshes, getMemoryUsage()};
 	}
 
 	Mesh(const Mesh& mesh) = delete;
@@ -105,7 +145,7 @@ public:
 		Pipeline::IA::bindVertexBuffer(device_context, 0, vertex_buffer.Get(), stride, 0);
 
 		// Set index buffer to active in the input assembler so it can be rendered
-		Pipeline::IA::bindIndexBuffer(device_context, index_buffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		Pipeline::IA::bindIndexBuffer(device_context, index_buffer.Get(), index_format, 0);
 
 		// Set type of primitive that should be rendered from this vertex buffer, in this case triangles
 		Pipeline::IA::bindPrimitiveTopology(device_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -126,6 +166,51 @@ public:
 		return index_count;
 	}
 
+	// The GPU memory used by the vertex and index buffers, in bytes
+	[[nodiscard]]
+	u64 getMemoryUsage() const noexcept {
+		return (static_cast<u64>(stride) * vertex_count) + (static_cast<u64>(getIndexSize()) * index_count);
+	}
+
+	// DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	[[nodiscard]]
+	DXGI_FORMAT getIndexFormat() const noexcept {
+		return index_format;
+	}
+
+	// The size of an index, in bytes
+	[[nodiscard]]
+	u32 getIndexSize() const noexcept {
+		return (index_format == DXGI_FORMAT_R16_UINT) ? sizeof(u16) : sizeof(u32);
+	}
+
+	// True if the vertex positions are quantized. The position transform must then be
+	// applied before the object-to-world transform.
+	[[nodiscard]]
+	bool isQuantized() const noexcept {
+		return quantized;
+	}
+
+	[[nodiscard]]
+	const VertexQuantization& getQuantization() const noexcept {
+		return quantization;
+	}
+
+	[[nodiscard]]
+	u32 getLODCount() const noexcept {
+		return static_cast<u32>(lods.size());
+	}
+
+	[[nodiscard]]
+	const MeshLOD& getLOD(u32 lod) const noexcept {
+		return lods[std::min(lod, getLODCount() - 1)];
+	}
+
+	[[nodiscard]]
+	std::span<const MeshLOD> getLODs() const noexcept {
+		return lods;
+	}
+
 	[[nodiscard]]
 	ID3D11Buffer* getVertexBuffer() const noexcept {
 		return vertex_buffer.Get();
@@ -152,10 +237,22 @@ private:
 	ComPtr<ID3D11Buffer> vertex_buffer;
 	ComPtr<ID3D11Buffer> index_buffer;
 
+	// The GPU memory of the buffers, counted under MemoryTag::Meshes
+	TrackedMemory memory;
+
 	u32 vertex_count;
 	u32 index_count;
 	u32 stride;
 
+	DXGI_FORMAT index_format = DXGI_FORMAT_R32_UINT;
+
+	// Maps quantized positions back to object space
+	VertexQuantization quantization;
+	bool quantized;
+
+	// The index range of each level of detail
+	std::vector<MeshLOD> lods;
+
 	// The vertex type used in the mesh
 	std::type_index vertex_type;
 };
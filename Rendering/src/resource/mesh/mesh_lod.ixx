@@ -0,0 +1,105 @@
+module;
+
+#include <algorithm>
+#include <limits>
+#include <span>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+
+export module rendering:mesh_lod;
+
+import math.geometry;
+
+using namespace DirectX;
+
+
+//----------------------------------------------------------------------------------
+// Mesh LOD
+//----------------------------------------------------------------------------------
+//
+// The levels of detail of a mesh share its vertex buffer, and each level is a range
+// of its index buffer. Level 0 is the full detail mesh.
+//
+// Each level stores the error introduced by simplification, relative to the radius of
+// the mesh's bounding sphere. The projected size of the bounding sphere then gives the
+// error of a level in pixels, and the coarsest level with an acceptable error is used.
+//
+//----------------------------------------------------------------------------------
+export namespace render {
+
+struct MeshLOD {
+	u32 index_offset = 0;
+	u32 index_count  = 0;
+	f32 error        = 0.0f; //relative to the radius of the mesh's bounding sphere
+};
+
+struct LODSettings {
+	// The largest acceptable simplification error, in pixels
+	f32 pixel_error = 1.0f;
+
+	// The fraction the error must pass the threshold by before the level changes. Keeps the
+	// level from flickering when an object sits near a transition.
+	f32 hysteresis = 0.25f;
+};
+
+
+// The radius of a bounding sphere on screen, in pixels. Returns infinity if the camera is
+// inside the sphere.
+[[nodiscard]]
+inline f32 XM_CALLCONV ProjectedRadius(FXMMATRIX object_to_world,
+                                       CXMMATRIX world_to_projection,
+                                       const BoundingSphere& sphere,
+                                       f32 viewport_height) {
+
+	const auto center = XMVector3TransformCoord(sphere.center(), object_to_world);
+	const auto scale  = XMVectorMax(XMVectorMax(XMVector3LengthSq(object_to_world.r[0]),
+	                                            XMVector3LengthSq(object_to_world.r[1])),
+	                                XMVector3LengthSq(object_to_world.r[2]));
+	const f32  radius = sphere.radius() * XMVectorGetX(XMVectorSqrt(scale));
+
+	const f32 w = XMVectorGetW(XMVector3Transform(center, world_to_projection));
+	if (w <= radius)
+		return std::numeric_limits<f32>::infinity();
+
+	// The projection's y scale factor is the length of the y column of the world-to-projection matrix
+	const auto projection_to_world = XMMatrixTranspose(world_to_projection);
+	const f32  y_scale             = XMVectorGetX(XMVector3Length(projection_to_world.r[1]));
+
+	// NDC spans 2 units of the viewport's height
+	return (radius * y_scale / w) * (viewport_height * 0.5f);
+}
+
+
+// Select the level of detail to render. The current level is kept unless the error of a
+// neighbouring level passes the threshold by the hysteresis fraction. Use a current level of
+// 0 for views that don't keep a level between frames.
+[[nodiscard]]
+inline u32 SelectLOD(std::span<const MeshLOD> lods, f32 projected_radius, u32 current_lod, const LODSettings& settings) {
+	if (lods.size() <= 1)
+		return 0;
+
+	const auto pixel_error = [&](u32 lod) {
+		return lods[lod].error * projected_radius;
+	};
+
+	const f32 refine_limit  = settings.pixel_error * (1.0f + settings.hysteresis);
+	const f32 coarsen_limit = settings.pixel_error * (1.0f - settings.hysteresis);
+
+	u32 lod = std::min(current_lod, static_cast<u32>(lods.size() - 1));
+
+	// Move to a finer level while the current level's error is too large
+	while ((lod > 0) and (pixel_error(lod) > refine_limit)) {
+		--lod;
+	}
+
+	// Move to a coarser level while its error is small enough
+	while ((lod + 1 < lods.size()) and (pixel_error(lod + 1) <= coarsen_limit)) {
+		++lod;
+	}
+
+	return lod;
+}
+
+} //namespace render
@@ -1,14 +1,22 @@
 module;
 
+#include <exception>
+#include <functional>
+#include <future>
+
 #include "datatypes/types.h"
+#include "io/io.h"
 #include "directx/d3d11.h"
 
 export module rendering:blueprint_factory;
 
 import :model_config;
+import :model_output;
 import :resource_mgr;
+import :texture;
 import :material_factory;
 import :importer.model_importer;
+import :importer.texture_importer;
 
 import math.geometry;
 
@@ -22,6 +30,33 @@ std::shared_ptr<ModelBlueprint> LoadModelFile(ID3D11Device& device,
                                               const std::wstring& filename,
                                               const ModelConfig<VertexT>& config);
 
+// Load a model file, and store its blueprint in the resource manager under the given name.
+// The blueprint is reloaded when the file changes, if hot reloading is enabled.
+template<typename VertexT>
+[[nodiscard]]
+std::shared_ptr<ModelBlueprint> LoadModelFile(ResourceMgr& resource_mgr,
+                                              const std::wstring& name,
+                                              const fs::path& file,
+                                              const ModelConfig<VertexT>& config);
+
+// Load a model file on the resource manager's worker threads. Only the creation of the mesh
+// buffers runs on the device thread (during ResourceMgr::update()). The model's textures use
+// the default material's textures as placeholders until they're loaded. The blueprint is
+// reloaded when the file changes, if hot reloading is enabled.
+template<typename VertexT>
+[[nodiscard]]
+std::shared_future<std::shared_ptr<ModelBlueprint>> LoadModelFileAsync(ResourceMgr& resource_mgr,
+                                                                       const std::wstring& filename,
+                                                                       const ModelConfig<VertexT>& config);
+
+// Load a model file asynchronously, and call on_complete on the device thread with either the
+// blueprint or the exception that was thrown while loading it
+template<typename VertexT>
+void LoadModelFileAsync(ResourceMgr& resource_mgr,
+                        const std::wstring& filename,
+                        const ModelConfig<VertexT>& config,
+                        std::function<void(std::shared_ptr<ModelBlueprint>, std::exception_ptr)> on_complete);
+
 template<typename VertexT>
 [[nodiscard]]
 std::shared_ptr<ModelBlueprint> CreateCube(ResourceMgr& resource_mgr,
@@ -1,14 +1,110 @@
 export namespace render::BlueprintFactory {
 
+namespace detail {
+
+// Reimport a model when its file changes. Reimports run on a worker thread and load textures
+// asynchronously, like LoadModelFileAsync.
+template<typename VertexT>
+void WatchModelFile(ResourceMgr& resource_mgr,
+                    const std::wstring& name,
+                    const fs::path& file,
+                    const ModelConfig<VertexT>& config,
+                    Material default_material) {
+
+	resource_mgr.watchModel(name, file, config, [&resource_mgr, file, config, default_material = std::move(default_material)] {
+		const auto load_texture = [&resource_mgr](const fs::path& texture, TextureRole role, const std::shared_ptr<Texture>& placeholder) {
+			return resource_mgr.getOrCreateAsync<Texture>(texture.wstring(), placeholder, role);
+		};
+
+		auto out = importer::ImportModel(file, config, default_material, load_texture);
+		PackMeshes<VertexT>(out);
+		return out;
+	});
+}
+
+} //namespace detail
+
+
 template<typename VertexT>
 std::shared_ptr<ModelBlueprint> LoadModelFile(ID3D11Device& device,
                                               ResourceMgr& resource_mgr,
                                               const std::wstring& filename,
                                               const ModelConfig<VertexT>& config) {
 
-	const auto out = importer::ImportModel(resource_mgr, filename, config);
-	constructBlueprint<VertexT>(device, out);
-	return resource_mgr.getOrCreate<ModelBlueprint>(filename, device, out, config);
+	return LoadModelFile(resource_mgr, filename, fs::path{filename}, config);
+}
+
+template<typename VertexT>
+std::shared_ptr<ModelBlueprint> LoadModelFile(ResourceMgr& resource_mgr,
+                                              const std::wstring& name,
+                                              const fs::path& file,
+                                              const ModelConfig<VertexT>& config) {
+
+	const auto out = importer::ImportModel(resource_mgr, file, config);
+	auto blueprint = resource_mgr.getOrCreate<ModelBlueprint>(name, out, config);
+
+	if (resource_mgr.isHotReloadEnabled())
+		detail::WatchModelFile(resource_mgr, name, file, config, MaterialFactory::CreateDefaultMaterial(resource_mgr));
+
+	return blueprint;
+}
+
+template<typename VertexT>
+void LoadModelFileAsync(ResourceMgr& resource_mgr,
+                        const std::wstring& filename,
+                        const ModelConfig<VertexT>& config,
+                        std::function<void(std::shared_ptr<ModelBlueprint>, std::exception_ptr)> on_complete) {
+
+	// The default material's textures are created here, since they aren't loaded from a file
+	auto default_material = MaterialFactory::CreateDefaultMaterial(resource_mgr);
+
+	resource_mgr.enqueueWork([&resource_mgr, filename, config, default_material = std::move(default_material), on_complete = std::move(on_complete)] {
+		try {
+			const auto load_texture = [&resource_mgr](const fs::path& file, TextureRole role, const std::shared_ptr<Texture>& placeholder) {
+				return resource_mgr.getOrCreateAsync<Texture>(file.wstring(), placeholder, role);
+			};
+
+			// Parse the file and build the vertices on this thread
+			auto out = std::make_shared<ModelOutput>(importer::ImportModel(filename, config, default_material, load_texture));
+			PackMeshes<VertexT>(*out);
+
+			// Create the mesh buffers on the device thread
+			resource_mgr.enqueueDeviceWork([&resource_mgr, filename, config, out, default_material, on_complete] {
+				std::shared_ptr<ModelBlueprint> blueprint;
+				try {
+					blueprint = resource_mgr.getOrCreate<ModelBlueprint>(filename, *out, config);
+				}
+				catch (...) {
+					on_complete(nullptr, std::current_exception());
+					return;
+				}
+
+				detail::WatchModelFile(resource_mgr, filename, fs::path{filename}, config, default_material);
+				on_complete(std::move(blueprint), nullptr);
+			});
+		}
+		catch (...) {
+			on_complete(nullptr, std::current_exception());
+		}
+	});
+}
+
+template<typename VertexT>
+std::shared_future<std::shared_ptr<ModelBlueprint>> LoadModelFileAsync(ResourceMgr& resource_mgr,
+                                                                       const std::wstring& filename,
+                                                                       const ModelConfig<VertexT>& config) {
+
+	auto promise = std::make_shared<std::promise<std::shared_ptr<ModelBlueprint>>>();
+	auto future  = promise->get_future().share();
+
+	LoadModelFileAsync(resource_mgr, filename, config, [promise](std::shared_ptr<ModelBlueprint> blueprint, std::exception_ptr error) {
+		if (error)
+			promise->set_exception(error);
+		else
+			promise->set_value(std::move(blueprint));
+	});
+
+	return future;
 }
 
 template<typename VertexT>
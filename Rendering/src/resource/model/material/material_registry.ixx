@@ -0,0 +1,235 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "datatypes/types.h"
+
+export module rendering:material_registry;
+
+import :material;
+import :shader;
+import :texture;
+
+
+//----------------------------------------------------------------------------------
+// Material Registry
+//----------------------------------------------------------------------------------
+//
+// Interns materials so that identical materials are only stored once, no matter how
+// many blueprints use them. Each unique material is given a small integer ID, which
+// stays valid while any blueprint references the material. IDs of released materials
+// are reused.
+//
+// Two materials are identical if their names, parameters, textures and shaders are
+// equal. Textures and shaders are compared by identity, so this relies on the resource
+// manager handing out a single instance of each texture.
+//
+// Interned materials are shared, so editing one edits it for every model that uses it.
+//
+//----------------------------------------------------------------------------------
+export namespace render {
+
+using MaterialID = u32;
+
+inline constexpr MaterialID invalid_material_id = std::numeric_limits<MaterialID>::max();
+
+
+// A reference to an interned material
+struct MaterialRef {
+	[[nodiscard]]
+	Material& operator*() const noexcept {
+		return *material;
+	}
+
+	[[nodiscard]]
+	Material* operator->() const noexcept {
+		return material.get();
+	}
+
+	MaterialID id = invalid_material_id;
+	std::shared_ptr<Material> material;
+};
+
+
+struct MaterialRegistryStats {
+	u32 requests = 0;  //calls to intern()
+	u32 hits     = 0;  //requests that returned an existing material
+	u32 unique   = 0;  //materials currently alive
+};
+
+
+class MaterialRegistry final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	MaterialRegistry() = default;
+	MaterialRegistry(const MaterialRegistry&) = delete;
+	MaterialRegistry(MaterialRegistry&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~MaterialRegistry() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	MaterialRegistry& operator=(const MaterialRegistry&) = delete;
+	MaterialRegistry& operator=(MaterialRegistry&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Get the interned copy of a material, creating it if no identical material exists
+	[[nodiscard]]
+	MaterialRef intern(const Material& material) {
+		std::scoped_lock lock{mutex};
+		++stats.requests;
+
+		const size_t hash = Hash(material);
+
+		// Look for an identical live material. An entry whose material was edited after it was
+		// interned no longer matches its hash, and is only found if it's still identical.
+		const auto [first, last] = lookup.equal_range(hash);
+		for (auto it = first; it != last; ++it) {
+			if (auto existing = slots[it->second].lock(); existing and Equal(*existing, material)) {
+				++stats.hits;
+				return MaterialRef{it->second, std::move(existing)};
+			}
+		}
+
+		if (free_ids.empty() and (slots.size() >= collect_threshold))
+			collectExpired();
+
+		MaterialID id;
+		if (free_ids.empty()) {
+			id = static_cast<MaterialID>(slots.size());
+			slots.emplace_back();
+		}
+		else {
+			id = free_ids.back();
+			free_ids.pop_back();
+		}
+
+		auto interned = std::make_shared<Material>(material);
+		slots[id] = interned;
+		lookup.emplace(hash, id);
+
+		return MaterialRef{id, std::move(interned)};
+	}
+
+	// Get a material by its ID. Returns nullptr if the material was released.
+	[[nodiscard]]
+	std::shared_ptr<Material> get(MaterialID id) const {
+		std::scoped_lock lock{mutex};
+		return (id < slots.size()) ? slots[id].lock() : nullptr;
+	}
+
+	[[nodiscard]]
+	MaterialRegistryStats getStats() const {
+		std::scoped_lock lock{mutex};
+
+		MaterialRegistryStats out = stats;
+		for (const auto& slot : slots) {
+			if (not slot.expired())
+				++out.unique;
+		}
+		return out;
+	}
+
+private:
+
+	[[nodiscard]]
+	static size_t Hash(const Material& mat) noexcept {
+		size_t hash = std::hash<std::string>{}(mat.name);
+
+		const auto combine = [&hash](size_t value) {
+			hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+		};
+		const auto combine_f32 = [&combine](f32 value) {
+			combine(std::bit_cast<u32>(value));
+		};
+
+		for (u32 i = 0; i < 4; ++i) combine_f32(mat.params.base_color[i]);
+		for (u32 i = 0; i < 3; ++i) combine_f32(mat.params.emissive[i]);
+		combine_f32(mat.params.metalness);
+		combine_f32(mat.params.roughness);
+
+		combine(std::hash<const Texture*>{}(mat.maps.base_color.get()));
+		combine(std::hash<const Texture*>{}(mat.maps.material_params.get()));
+		combine(std::hash<const Texture*>{}(mat.maps.normal.get()));
+		combine(std::hash<const Texture*>{}(mat.maps.emissive.get()));
+		combine(std::hash<const PixelShader*>{}(mat.shader.get()));
+
+		return hash;
+	}
+
+	[[nodiscard]]
+	static bool Equal(const Material& a, const Material& b) noexcept {
+		for (u32 i = 0; i < 4; ++i) {
+			if (a.params.base_color[i] != b.params.base_color[i])
+				return false;
+		}
+		for (u32 i = 0; i < 3; ++i) {
+			if (a.params.emissive[i] != b.params.emissive[i])
+				return false;
+		}
+
+		return (a.name == b.name)
+		       and (a.params.metalness == b.params.metalness)
+		       and (a.params.roughness == b.params.roughness)
+		       and (a.maps.base_color == b.maps.base_color)
+		       and (a.maps.material_params == b.maps.material_params)
+		       and (a.maps.normal == b.maps.normal)
+		       and (a.maps.emissive == b.maps.emissive)
+		       and (a.shader == b.shader);
+	}
+
+	// Free the IDs of released materials. Only runs once the slot count doubles since the last
+	// collection, so interning stays amortized constant time.
+	void collectExpired() {
+		std::erase_if(lookup, [this](const auto& entry) {
+			return slots[entry.second].expired();
+		});
+
+		for (MaterialID id = 0; id < slots.size(); ++id) {
+			if (slots[id].expired())
+				free_ids.push_back(id);
+		}
+
+		collect_threshold = std::max<size_t>(64, slots.size() * 2);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	mutable std::mutex mutex;
+
+	// The interned materials, indexed by ID
+	std::vector<std::weak_ptr<Material>> slots;
+
+	// Maps the hash of a material to the IDs of the materials with that hash
+	std::unordered_multimap<size_t, MaterialID> lookup;
+
+	// IDs of released materials that can be reused
+	std::vector<MaterialID> free_ids;
+	size_t collect_threshold = 64;
+
+	MaterialRegistryStats stats;
+};
+
+} //namespace render
@@ -1,5 +1,8 @@
 module;
 
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -13,8 +16,12 @@ import math.geometry;
 
 import :resource;
 import :mesh;
+import :mesh_lod;
+import :material;
+import :material_registry;
 import :model_config;
 import :model_output;
+import :vertex_compression;
 import :vertex_types;
 
 
@@ -27,13 +34,15 @@ public:
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
+	// The output's materials are interned in the material registry
 	template<typename VertexT>
 	ModelBlueprint(ID3D11Device& device,
+	               MaterialRegistry& material_registry,
 	               const ModelOutput& output,
 	               const ModelConfig<VertexT>& config)
 		: Resource(output.file.empty() ? StrToWstr(output.name) : output.file.wstring()) {
 
-		constructBlueprint<VertexT>(device, output);
+		constructBlueprint<VertexT>(device, material_registry, output, config);
 	}
 
 	ModelBlueprint(const ModelBlueprint& blueprint) = delete;
@@ -55,17 +64,61 @@ public:
 	ModelBlueprint& operator=(ModelBlueprint&& blueprint) noexcept = default;
 
 
-private:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
+
+	// The GPU memory used by the meshes, in bytes. Material textures are separate resources
+	// and aren't included.
+	[[nodiscard]]
+	u64 getMemoryUsage() const noexcept {
+		u64 size = 0;
+		for (const auto& mesh : meshes) {
+			size += mesh.getMemoryUsage();
+		}
+		return size;
+	}
+
+	// Replace the blueprint's data with a reloaded version of the model. Anything that refers
+	// to the blueprint (e.g. a MeshHandle) uses the new data from then on.
+	void reload(ModelBlueprint&& replacement) noexcept {
+		const u32 next_revision = revision + 1;
+		*this = std::move(replacement);
+		revision = next_revision;
+	}
+
+	// Incremented each time the blueprint is reloaded
+	[[nodiscard]]
+	u32 getRevision() const noexcept {
+		return revision;
+	}
+
+private:
+
+	// Quantized positions are relative to the mesh's AABB (see BuildVertices)
+	template<typename VertexT>
+	[[nodiscard]]
+	static VertexQuantization GetQuantization(const AABB& aabb) noexcept {
+		if constexpr (VertexT::isQuantized())
+			return VertexQuantization::fromAABB(aabb);
+		else
+			return VertexQuantization{};
+	}
+
 	template<typename VertexT>
-	void constructBlueprint(ID3D11Device& device, const ModelOutput& out) {
+	void constructBlueprint(ID3D11Device& device,
+	                        MaterialRegistry& material_registry,
+	                        const ModelOutput& out,
+	                        const ModelConfig<VertexT>& config) {
 		name = out.name;
 
-		// Copy the nodes and materials
+		// Copy the nodes, and intern the materials
 		root = out.root;
-		materials = out.materials;
+
+		materials.reserve(out.materials.size());
+		for (const auto& material : out.materials) {
+			materials.push_back(material_registry.intern(material));
+		}
 
 		// Create the model data
 		for (const auto& mesh : out.meshes) {
@@ -73,32 +126,39 @@ private:
 			// Material index
 			mat_indices.push_back(mesh.material_index);
 
-			// Construct vertices
-			std::vector<VertexT> vertices;
-			for (size_t i = 0; i < mesh.positions.size(); ++i) {
-				VertexT vert;
-				vert.position = mesh.positions[i];
-				if constexpr (VertexT::hasNormal()) {
-					if (not mesh.normals.empty())
-						vert.normal = mesh.normals[i];
-				}
-				if constexpr (VertexT::hasTexture()) {
-					if (not mesh.texture_coords.empty())
-						vert.texCoord = mesh.texture_coords[i];
-				}
-				if constexpr (VertexT::hasColor()) {
-					if (not mesh.colors.empty())
-						vert.color = mesh.colors[i];
-				}
-				vertices.push_back(std::move(vert));
-			}
+			// Create the mesh directly from the packed data if it matches the vertex type
+			if (mesh.packed and (mesh.packed->vertex_stride == sizeof(VertexT))) {
+				const auto& packed = *mesh.packed;
+				const auto vertices = std::span{
+					reinterpret_cast<const VertexT*>(packed.vertices.data()),
+					packed.vertices.size() / sizeof(VertexT)
+				};
 
-			// Create the mesh
-			meshes.emplace_back(device, mesh.name, vertices, mesh.indices);
+				meshes.emplace_back(device,
+				                    mesh.name,
+				                    vertices,
+				                    packed.indices,
+				                    std::span<const MeshLOD>{mesh.lods},
+				                    GetQuantization<VertexT>(packed.aabb),
+				                    config.compact_indices);
+				aabbs.push_back(packed.aabb);
+				bounding_spheres.push_back(packed.sphere);
+				continue;
+			}
 
 			// Construct bounding volumes
 			aabbs.emplace_back(AABB::createFromVertices(mesh.positions));
 			bounding_spheres.emplace_back(BoundingSphere::createFromVertices(mesh.positions));
+
+			// Create the mesh
+			const auto vertices = BuildVertices<VertexT>(mesh);
+			meshes.emplace_back(device,
+			                    mesh.name,
+			                    std::span<const VertexT>{vertices},
+			                    std::span<const u32>{mesh.indices},
+			                    std::span<const MeshLOD>{mesh.lods},
+			                    GetQuantization<VertexT>(aabbs.back()),
+			                    config.compact_indices);
 		}
 	}
 
@@ -113,11 +173,101 @@ public:
 	std::vector<Mesh> meshes;
 	std::vector<AABB> aabbs;
 	std::vector<BoundingSphere> bounding_spheres;
-	std::vector<Material> materials;
+	std::vector<MaterialRef> materials;
 	std::vector<u32> mat_indices;
 
 	// A hierarchy of nodes that define models
 	Node root;
+
+private:
+	u32 revision = 0;
+};
+
+
+// A reference to one of a blueprint's meshes, and the material it uses. The data is looked up
+// through the blueprint on each access, so a handle follows the blueprint when it's reloaded.
+export class MeshHandle final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	MeshHandle(std::shared_ptr<ModelBlueprint> bp, u32 bp_index)
+		: blueprint(std::move(bp))
+		, index(bp_index) {
+
+		if ((index >= blueprint->meshes.size()) or (blueprint->mat_indices.at(index) >= blueprint->materials.size()))
+			throw std::out_of_range("Invalid blueprint mesh index");
+	}
+
+	MeshHandle(const MeshHandle&) = default;
+	MeshHandle(MeshHandle&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~MeshHandle() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	MeshHandle& operator=(const MeshHandle&) = default;
+	MeshHandle& operator=(MeshHandle&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	[[nodiscard]]
+	const Mesh& getMesh() const noexcept {
+		return blueprint->meshes[index];
+	}
+
+	[[nodiscard]]
+	Material& getMaterial() const noexcept {
+		return *getMaterialRef();
+	}
+
+	[[nodiscard]]
+	MaterialID getMaterialID() const noexcept {
+		return getMaterialRef().id;
+	}
+
+	[[nodiscard]]
+	const AABB& getAABB() const noexcept {
+		return blueprint->aabbs[index];
+	}
+
+	[[nodiscard]]
+	const BoundingSphere& getBoundingSphere() const noexcept {
+		return blueprint->bounding_spheres[index];
+	}
+
+	[[nodiscard]]
+	const ModelBlueprint& getBlueprint() const noexcept {
+		return *blueprint;
+	}
+
+	// The revision of the blueprint. Changes when the mesh or material is reloaded.
+	[[nodiscard]]
+	u32 getRevision() const noexcept {
+		return blueprint->getRevision();
+	}
+
+private:
+
+	[[nodiscard]]
+	const MaterialRef& getMaterialRef() const noexcept {
+		return blueprint->materials[blueprint->mat_indices[index]];
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::shared_ptr<ModelBlueprint> blueprint;
+	u32 index;
 };
 
 } //namespace render
@@ -1,10 +1,15 @@
+module;
+
+#include "datatypes/scalar_types.h"
+
 export module rendering:model_config;
 
 export namespace render {
 
 template <typename VertexT>
 struct ModelConfig {
-	// The vertex type to use for the model
+	// The vertex type to use for the model. A quantized vertex type (e.g.
+	// VertexPositionNormalTextureCompact) halves the size of the vertex buffers.
 	using vertex_t = VertexT;
 
 	// Flips the vertex winding order if true
@@ -12,6 +17,16 @@ struct ModelConfig {
 
 	// Flips UV coordinates if true
 	bool flip_uv = false;
+
+	// Reorders the triangles and vertices of each mesh for the vertex cache and overdraw
+	bool optimize_meshes = true;
+
+	// The number of levels of detail to generate for each mesh, including the full detail mesh.
+	// Each level has about half the triangles of the previous one. 1 disables LOD generation.
+	u32 lod_count = 4;
+
+	// Uses 16-bit index buffers for meshes with fewer than 65535 vertices
+	bool compact_indices = true;
 };
 
 } //namespace render
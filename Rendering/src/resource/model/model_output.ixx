@@ -1,17 +1,34 @@
 module;
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+
 #include "datatypes/scalar_types.h"
 #include "datatypes/vector_types.h"
 #include "io/io.h"
 
 export module rendering:model_output;
 
+import math.geometry;
 import :mesh;
+import :mesh_lod;
 import :material;
+import :importer.texture_importer;
+import :texture;
+import :vertex_compression;
 
 
 namespace render {
 
+// Returns the texture for a file referenced by a model. The role is the material map the file is
+// used as. The placeholder is the texture that would be used if the model didn't reference the file.
+export using TextureLoader = std::function<std::shared_ptr<Texture>(const fs::path& file,
+                                                                    TextureRole role,
+                                                                    const std::shared_ptr<Texture>& placeholder)>;
+
+
 //----------------------------------------------------------------------------------
 // ModelOutput
 //----------------------------------------------------------------------------------
@@ -31,6 +48,17 @@ export struct ModelOutput {
 		std::vector<Node> child_nodes;
 	};
 
+	// Vertex and index data that has already been interleaved into a vertex type, and the
+	// mesh's bounding volumes (e.g. when loaded from a model cache). The data is owned by
+	// the ModelOutput's storage.
+	struct PackedData {
+		std::span<const std::byte> vertices;
+		std::span<const u32> indices;
+		u32 vertex_stride = 0;
+		AABB aabb;
+		BoundingSphere sphere;
+	};
+
 	struct MeshData {
 		std::string name;
 		std::vector<u32> indices;
@@ -41,6 +69,13 @@ export struct ModelOutput {
 		std::vector<f32_2> texture_coords;
 		std::vector<f32_3> colors;
 		u32 material_index = 0;
+
+		// The index range of each level of detail, in order of decreasing detail. The indices
+		// of every level are stored one after another. Empty if the mesh has only one level.
+		std::vector<MeshLOD> lods;
+
+		// If present, the mesh is created directly from this data instead of the vectors above
+		std::optional<PackedData> packed;
 	};
 
 
@@ -62,6 +97,99 @@ export struct ModelOutput {
 
 	// The root node of the model hierarchy
 	Node root;
+
+	// Keeps the memory referenced by the meshes' packed data alive (optional)
+	std::shared_ptr<const void> storage;
 };
 
+
+// Interleave the vertex attributes of a mesh into the specified vertex type. The positions of
+// a quantized vertex type are relative to the AABB of the mesh's positions.
+export template<typename VertexT>
+[[nodiscard]]
+std::vector<VertexT> BuildVertices(const ModelOutput::MeshData& mesh) {
+	std::vector<VertexT> vertices;
+	vertices.reserve(mesh.positions.size());
+
+	if constexpr (VertexT::isQuantized()) {
+		if (mesh.positions.empty())
+			return vertices;
+
+		const auto quantization = VertexQuantization::fromAABB(AABB::createFromVertices(mesh.positions));
+
+		for (size_t i = 0; i < mesh.positions.size(); ++i) {
+			VertexT vert;
+			vert.position = quantization.encode(mesh.positions[i]);
+			if constexpr (VertexT::hasNormal()) {
+				if (not mesh.normals.empty())
+					vert.normal = EncodeOctahedral(mesh.normals[i]);
+			}
+			if constexpr (VertexT::hasTexture()) {
+				if (not mesh.texture_coords.empty())
+					vert.texCoord = EncodeHalf2(mesh.texture_coords[i]);
+			}
+			vertices.push_back(std::move(vert));
+		}
+	}
+	else {
+		for (size_t i = 0; i < mesh.positions.size(); ++i) {
+			VertexT vert;
+			vert.position = mesh.positions[i];
+			if constexpr (VertexT::hasNormal()) {
+				if (not mesh.normals.empty())
+					vert.normal = mesh.normals[i];
+			}
+			if constexpr (VertexT::hasTexture()) {
+				if (not mesh.texture_coords.empty())
+					vert.texCoord = mesh.texture_coords[i];
+			}
+			if constexpr (VertexT::hasColor()) {
+				if (not mesh.colors.empty())
+					vert.color = mesh.colors[i];
+			}
+			vertices.push_back(std::move(vert));
+		}
+	}
+
+	return vertices;
+}
+
+
+// Interleave the vertices of every mesh and compute their bounding volumes, so a ModelBlueprint
+// can be created from the output without any per-vertex work. Meshes that are already packed
+// are left as they are.
+export template<typename VertexT>
+void PackMeshes(ModelOutput& output) {
+	struct MeshStorage {
+		std::vector<VertexT> vertices;
+		std::vector<u32> indices;
+	};
+
+	auto storage = std::make_shared<std::vector<MeshStorage>>();
+	storage->reserve(output.meshes.size());
+
+	for (auto& mesh : output.meshes) {
+		if (mesh.packed or mesh.positions.empty())
+			continue;
+
+		auto& data = storage->emplace_back(BuildVertices<VertexT>(mesh), std::move(mesh.indices));
+
+		ModelOutput::PackedData packed;
+		packed.vertices      = std::as_bytes(std::span{data.vertices});
+		packed.indices       = data.indices;
+		packed.vertex_stride = sizeof(VertexT);
+		packed.aabb          = AABB::createFromVertices(mesh.positions);
+		packed.sphere        = BoundingSphere::createFromVertices(mesh.positions);
+		mesh.packed = packed;
+	}
+
+	if (output.storage) {
+		// Keep the existing storage alive along with the new storage
+		output.storage = std::make_shared<std::pair<std::shared_ptr<const void>, std::shared_ptr<const void>>>(std::move(output.storage), std::move(storage));
+	}
+	else {
+		output.storage = std::move(storage);
+	}
+}
+
 } //namespace render
\ No newline at end of file
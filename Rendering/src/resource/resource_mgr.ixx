@@ -1,22 +1,43 @@
 module;
 
+#include <atomic>
 #include <concepts>
+#include <exception>
+#include <format>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include <DirectXMath.h>
 
 #include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "io/file_watcher.h"
 #include "memory/managed_resource_map.h"
+#include "profiler/profiler.h"
+#include "string/string.h"
+#include "thread/thread_pool.h"
 
 #include "directx/d3d11.h"
 
+#include <DirectXTex.h>
+
+#include "shader/shader_cache.h"
+
 export module rendering:resource_mgr;
 
+import log;
+
 import :resource;
 import :font;
+import :importer.texture_importer;
+import :material_registry;
 import :mesh;
 import :model_blueprint;
 import :model_config;
@@ -28,6 +49,16 @@ import :texture;
 
 namespace render {
 
+// Counts of the texture and material requests that were resolved to an existing resource
+export struct ResourceDedupStats {
+	u32 texture_requests     = 0;  //requests for texture files
+	u32 texture_path_hits    = 0;  //requests resolved to a loaded texture by its canonical path
+	u32 texture_content_hits = 0;  //requests resolved to a texture loaded from an identical file
+
+	MaterialRegistryStats materials;
+};
+
+
 export class ResourceMgr final {
 	template<typename KeyT, typename ValueT>
 	using resource_map = ConcurrentWeakResourceMap<KeyT, ValueT>;
@@ -42,11 +73,15 @@ public:
 	//----------------------------------------------------------------------------------
 	ResourceMgr(ID3D11Device& device, ID3D11DeviceContext& device_context)
 		: device(device)
-		, device_context(device_context) {
+		, device_context(device_context)
+		, workers(std::make_unique<ThreadPool>()) {
+
+		importer::ImportErrorTexture(device, placeholder_srv.GetAddressOf());
 	}
 
+	// Queued work references the manager, so it can't be moved
 	ResourceMgr(const ResourceMgr& mgr) = delete;
-	ResourceMgr(ResourceMgr&& mgr) noexcept = default;
+	ResourceMgr(ResourceMgr&& mgr) = delete;
 
 
 	//----------------------------------------------------------------------------------
@@ -59,13 +94,122 @@ public:
 	// Operators
 	//----------------------------------------------------------------------------------
 	ResourceMgr& operator=(const ResourceMgr& mgr) = delete;
-	ResourceMgr& operator=(ResourceMgr&& mgr) noexcept = default;
+	ResourceMgr& operator=(ResourceMgr&& mgr) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Asynchronous Loading
+	//----------------------------------------------------------------------------------
+
+	// Queue CPU work (file parsing, decoding, etc...) on the worker threads
+	template<typename FunctionT>
+	auto enqueueWork(FunctionT&& func) {
+		return workers->enqueue(std::forward<FunctionT>(func));
+	}
+
+	// Queue work that uses the device to run on the device thread during the next update()
+	void enqueueDeviceWork(std::function<void()> func) {
+		std::scoped_lock lock{device_work_mutex};
+		device_work.push_back(std::move(func));
+	}
+
+	// Run the work queued for the device thread, and start reloading the resources whose files
+	// changed. Called once per frame by the thread that owns the device context.
+	void update() {
+		PROFILE_ZONE("Resource Update");
+
+		if (file_watcher)
+			processFileChanges();
+
+		{
+			std::scoped_lock lock{device_work_mutex};
+			device_work.swap(device_work_scratch);
+		}
+
+		for (auto& func : device_work_scratch) {
+			func();
+		}
+		device_work_scratch.clear();
+	}
+
+	// The number of asynchronous loads that haven't finished yet
+	[[nodiscard]]
+	u32 getPendingLoadCount() const noexcept {
+		return pending_loads.load();
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Deduplication
+	//----------------------------------------------------------------------------------
+
+	// The registry that blueprint materials are interned in
+	[[nodiscard]]
+	MaterialRegistry& getMaterialRegistry() noexcept {
+		return material_registry;
+	}
+
+	// The directory compressed textures are cached in. Should only be changed before any
+	// textures are loaded. An empty path disables the cache.
+	void setTextureCacheDirectory(const fs::path& directory) {
+		texture_cache_dir = directory;
+	}
+
+	[[nodiscard]]
+	const fs::path& getTextureCacheDirectory() const noexcept {
+		return texture_cache_dir;
+	}
+
+	// The directory compiled shader permutations are cached in. Should only be changed before
+	// any shaders are compiled. An empty path disables the cache.
+	void setShaderCacheDirectory(const fs::path& directory) {
+		shader_cache_dir = directory;
+	}
+
+	[[nodiscard]]
+	const fs::path& getShaderCacheDirectory() const noexcept {
+		return shader_cache_dir;
+	}
+
+	[[nodiscard]]
+	ResourceDedupStats getDedupStats() const {
+		ResourceDedupStats stats;
+		stats.texture_requests     = texture_requests.load();
+		stats.texture_path_hits    = texture_path_hits.load();
+		stats.texture_content_hits = texture_content_hits.load();
+		stats.materials            = material_registry.getStats();
+		return stats;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Hot Reloading
+	//----------------------------------------------------------------------------------
+
+	// Watch the files that textures and models are loaded from, and reload them when the files
+	// change. Reloads are decoded on the worker threads, and swapped in on the device thread
+	// during update(). Only resources loaded while hot reloading is enabled are watched, so this
+	// should be set before any resources are loaded.
+	void setHotReload(bool state) {
+		if (state and not file_watcher)
+			file_watcher = std::make_unique<FileWatcher>();
+		else if (not state)
+			file_watcher.reset();
+	}
+
+	[[nodiscard]]
+	bool isHotReloadEnabled() const noexcept {
+		return file_watcher != nullptr;
+	}
 
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - ModelBlueprint
 	//----------------------------------------------------------------------------------
 
+	// Reimports a model file. Called on a worker thread.
+	using ModelReimporter = std::function<ModelOutput()>;
+
 	template<typename ResourceT, typename VertexT>
 	requires std::same_as<ModelBlueprint, ResourceT>
 	[[nodiscard]]
@@ -84,6 +228,16 @@ public:
 	requires std::same_as<ModelBlueprint, ResourceT>
 	[[nodiscard]]
 	const resource_map<std::wstring, ModelBlueprint>& getResourceMap() const;
+
+	// Reload the blueprint with the given name when the file it was imported from changes. Does
+	// nothing if hot reloading is disabled. The blueprint is reloaded in place, so the models
+	// created from it are updated. A blueprint whose mesh count changes isn't reloaded, since
+	// its models refer to the meshes by index.
+	template<typename VertexT>
+	void watchModel(const std::wstring& name,
+	                const fs::path& file,
+	                const ModelConfig<VertexT>& config,
+	                ModelReimporter reimport);
 		
 
 
@@ -91,10 +245,12 @@ public:
 	// Member Functions - Texture
 	//----------------------------------------------------------------------------------
 
+	// Get a texture file, or load it if it doesn't exist. The role determines how the texture is
+	// compressed. A file used in different roles is loaded once for each role.
 	template<typename ResourceT>
 	requires std::same_as<Texture, ResourceT>
 	[[nodiscard]]
-	std::shared_ptr<Texture> getOrCreate(const std::wstring& filename);
+	std::shared_ptr<Texture> getOrCreate(const std::wstring& filename, TextureRole role = TextureRole::Generic);
 
 	template<typename ResourceT>
 	requires std::same_as<Texture, ResourceT>
@@ -103,10 +259,33 @@ public:
 	                                     const D3D11_TEXTURE2D_DESC& desc,
 	                                     const D3D11_SUBRESOURCE_DATA& init_data);
 
+	// Get a texture, or create it from an image decoded with importer::DecodeTexture. A
+	// texture that is still using a placeholder is finished with the image. If the hash of the
+	// file's contents (importer::HashTextureFile) is given, the texture shares the GPU resource
+	// of a texture loaded from an identical file instead of creating a new one. The role should match the role the image
+	// was decoded with.
 	template<typename ResourceT>
 	requires std::same_as<Texture, ResourceT>
 	[[nodiscard]]
-	std::shared_ptr<Texture> createOrReplace(const std::wstring& filename);
+	std::shared_ptr<Texture> getOrCreate(const std::wstring& filename,
+	                                     const std::optional<DirectX::ScratchImage>& image,
+	                                     u64 content_hash = 0,
+	                                     TextureRole role = TextureRole::Generic);
+
+	// Get a texture, or start loading it on the worker threads if it doesn't exist. The
+	// returned texture uses the placeholder (or an error texture if no placeholder is given)
+	// until it's loaded. Can be called from any thread.
+	template<typename ResourceT>
+	requires std::same_as<Texture, ResourceT>
+	[[nodiscard]]
+	std::shared_ptr<Texture> getOrCreateAsync(const std::wstring& filename,
+	                                          const std::shared_ptr<Texture>& placeholder = nullptr,
+	                                          TextureRole role = TextureRole::Generic);
+
+	template<typename ResourceT>
+	requires std::same_as<Texture, ResourceT>
+	[[nodiscard]]
+	std::shared_ptr<Texture> createOrReplace(const std::wstring& filename, TextureRole role = TextureRole::Generic);
 
 	template<typename ResourceT>
 	requires std::same_as<Texture, ResourceT>
@@ -264,8 +443,231 @@ public:
 	[[nodiscard]]
 	const shader_resource_map<std::wstring, VertexShader>& getResourceMap() const;
 
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Shader Permutations
+	//----------------------------------------------------------------------------------
+
+	// Get a shader permutation, or start compiling it on the worker threads if it doesn't
+	// exist. The bytecode is read from the shader cache if the permutation was compiled before.
+	// The returned shader uses the fallback until it's compiled, and keeps using it if the
+	// permutation fails to compile. The input elements are only used by vertex shaders. Can be
+	// called from any thread.
+	template<typename ResourceT>
+	requires ShaderResource<ResourceT>
+	[[nodiscard]]
+	std::shared_ptr<ResourceT> getOrCreateAsync(const ShaderPermutation& permutation,
+	                                            const std::shared_ptr<ResourceT>& fallback,
+	                                            std::span<const D3D11_INPUT_ELEMENT_DESC> input_element_descs = {});
+
 private:
 
+	template<typename ResourceT>
+	requires ShaderResource<ResourceT>
+	[[nodiscard]]
+	shader_resource_map<std::wstring, ResourceT>& getShaderMap() noexcept {
+		if constexpr (std::same_as<ComputeShader, ResourceT>)
+			return compute_shaders;
+		else if constexpr (std::same_as<DomainShader, ResourceT>)
+			return domain_shaders;
+		else if constexpr (std::same_as<GeometryShader, ResourceT>)
+			return geometry_shaders;
+		else if constexpr (std::same_as<HullShader, ResourceT>)
+			return hull_shaders;
+		else if constexpr (std::same_as<PixelShader, ResourceT>)
+			return pixel_shaders;
+		else
+			return vertex_shaders;
+	}
+
+	struct ModelSource {
+		std::wstring name;
+		std::function<void()> reload;
+	};
+
+	// Replace a blueprint's data with a reimported model. Runs on the device thread.
+	template<typename VertexT>
+	void reloadBlueprint(const std::wstring& name, const ModelOutput& model_data, const ModelConfig<VertexT>& config);
+
+	// Start reloading the resources whose files changed
+	void processFileChanges() {
+		for (const auto& file : file_watcher->takeChanges()) {
+			Logger::log(LogLevel::info, "File changed: {}", file.string());
+			reloadTextures(file);
+			reloadModels(file);
+		}
+	}
+
+	// Reload every texture loaded from a file, in each role it's used in. The textures are
+	// updated in place, so the materials that use them don't change.
+	void reloadTextures(const fs::path& file) {
+		const auto path_key = importer::GetCanonicalTexturePath(file);
+
+		std::vector<std::pair<std::shared_ptr<Texture>, TextureRole>> reloads;
+		{
+			std::scoped_lock lock{texture_mutex};
+
+			for (const auto& [key, texture] : textures) {
+				if (not texture or not key.starts_with(path_key))
+					continue;
+
+				// The role follows the path in the key (see GetTextureKey)
+				if (key.size() == path_key.size())
+					reloads.emplace_back(texture, TextureRole::Generic);
+				else if (key[path_key.size()] == L'|')
+					reloads.emplace_back(texture, static_cast<TextureRole>(std::stoul(key.substr(path_key.size() + 1))));
+			}
+		}
+
+		for (auto& [texture, role] : reloads) {
+			reloadTexture(file.wstring(), texture, role);
+		}
+	}
+
+	void reloadTexture(const std::wstring& filename, const std::shared_ptr<Texture>& texture, TextureRole role) {
+		++pending_loads;
+
+		enqueueWork([this, weak_texture = std::weak_ptr{texture}, filename, role] {
+			const u64 content_hash = importer::HashTextureFile(filename);
+
+			auto image = std::make_shared<std::optional<DirectX::ScratchImage>>(
+				importer::DecodeTexture(filename, role, texture_cache_dir, content_hash)
+			);
+
+			enqueueDeviceWork([this, weak_texture, image, content_hash, role, filename] {
+				// Keep the current texture if the file couldn't be decoded (e.g. it's incomplete)
+				const auto texture = weak_texture.lock();
+				if (texture and image->has_value()) {
+					texture->finishLoad(device, *image);
+
+					// The texture no longer matches the contents it was indexed by
+					std::scoped_lock lock{texture_mutex};
+					std::erase_if(texture_contents, [&texture](const auto& entry) {
+						return entry.second.lock() == texture;
+					});
+					if (content_hash != 0)
+						texture_contents[GetTextureContentKey(content_hash, role)] = texture;
+
+					Logger::log(LogLevel::info, "Reloaded texture: {}", WstrToStr(filename));
+				}
+				--pending_loads;
+			});
+		});
+	}
+
+	// Reimport the models loaded from a file, and forget the ones that were released
+	void reloadModels(const fs::path& file) {
+		std::vector<std::function<void()>> reloads;
+		{
+			std::scoped_lock lock{model_source_mutex};
+
+			const auto it = model_sources.find(FileWatcher::GetFileKey(file));
+			if (it == model_sources.end())
+				return;
+
+			std::erase_if(it->second, [this](const ModelSource& source) {
+				const auto model = models.find(source.name);
+				return (model == models.end()) or not (*model).second;
+			});
+
+			for (const auto& source : it->second) {
+				reloads.push_back(source.reload);
+			}
+
+			if (it->second.empty())
+				model_sources.erase(it);
+		}
+
+		for (const auto& reload : reloads) {
+			reload();
+		}
+	}
+
+	// Create a texture that shares the GPU resource of a texture loaded from an identical file.
+	// The textures are separate objects, so either can be reloaded without affecting the other.
+	// Requires the texture mutex.
+	[[nodiscard]]
+	std::shared_ptr<Texture> shareTexture(const std::wstring& key, const std::wstring& filename, const Texture& source) {
+		auto texture = textures.createOrReplace(key, filename, ComPtr<ID3D11ShaderResourceView>{source.get()});
+		texture->finishLoad(source);
+		return texture;
+	}
+
+	// Add a decoded texture to the texture maps. If the key already has a texture that's
+	// still loading (e.g. another thread added it while the image was decoded), the image
+	// finishes its load instead. Requires the texture mutex.
+	[[nodiscard]]
+	std::shared_ptr<Texture> addTexture(const std::wstring& key,
+	                                    const std::wstring& filename,
+	                                    const std::optional<DirectX::ScratchImage>& image,
+	                                    u64 content_hash,
+	                                    TextureRole role) {
+
+		std::shared_ptr<Texture> texture;
+		if (const auto it = textures.find(key); it != textures.end())
+			texture = (*it).second;
+
+		if (texture and texture->isLoaded()) {
+			++texture_path_hits;
+			return texture;
+		}
+
+		if (texture) {
+			texture->finishLoad(device, image);
+		}
+		else {
+			// Share the texture of an identical file at another path
+			if (auto existing = findTextureByContent(content_hash, role)) {
+				++texture_content_hits;
+				return shareTexture(key, filename, *existing);
+			}
+			texture = textures.createOrReplace(key, device, filename, image);
+		}
+
+		if ((content_hash != 0) and image.has_value())
+			texture_contents[GetTextureContentKey(content_hash, role)] = texture;
+
+		return texture;
+	}
+
+	// Watch a resource's file if hot reloading is enabled
+	void watchFile(const fs::path& file) {
+		if (file_watcher)
+			file_watcher->watch(file);
+	}
+
+	// The key of a texture file in the texture map. Textures in the generic role are keyed by
+	// their canonical path alone.
+	[[nodiscard]]
+	static std::wstring GetTextureKey(const std::wstring& filename, TextureRole role) {
+		auto key = importer::GetCanonicalTexturePath(filename);
+		if (role != TextureRole::Generic)
+			key += L"|" + std::to_wstring(static_cast<u32>(role));
+		return key;
+	}
+
+	// The key of a file's contents in the content map
+	[[nodiscard]]
+	static u64 GetTextureContentKey(u64 content_hash, TextureRole role) noexcept {
+		return content_hash ^ (static_cast<u64>(role) << 56);
+	}
+
+	// Find a live texture loaded from a file with the given content hash and role. Requires the
+	// texture mutex.
+	[[nodiscard]]
+	std::shared_ptr<Texture> findTextureByContent(u64 content_hash, TextureRole role) const {
+		if (content_hash == 0)
+			return nullptr;
+
+		const auto it = texture_contents.find(GetTextureContentKey(content_hash, role));
+		if (it == texture_contents.end())
+			return nullptr;
+
+		auto texture = it->second.lock();
+		return (texture and texture->isLoaded()) ? texture : nullptr;
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
@@ -285,6 +687,51 @@ private:
 	shader_resource_map<std::wstring, HullShader>     hull_shaders;
 	shader_resource_map<std::wstring, PixelShader>    pixel_shaders;
 	shader_resource_map<std::wstring, VertexShader>   vertex_shaders;
+
+	// Guards the texture maps, which are accessed by asynchronous loads
+	std::mutex texture_mutex;
+
+	// Texture files are keyed by their canonical path. Textures are also indexed by the hash
+	// of their file's contents, so identical files at different paths share a GPU resource.
+	std::unordered_map<u64, std::weak_ptr<Texture>> texture_contents;
+
+	// Compressed textures are cached here by the content hash of their source file
+	fs::path texture_cache_dir = fs::path{"./cache"} / "textures";
+
+	// Guards the shader maps during asynchronous shader compilation
+	std::mutex shader_mutex;
+
+	// Compiled shader permutations are cached here by their permutation key
+	fs::path shader_cache_dir = fs::path{"./cache"} / "shaders";
+
+	// Interned blueprint materials
+	MaterialRegistry material_registry;
+
+	// Deduplication stats
+	std::atomic<u32> texture_requests     = 0;
+	std::atomic<u32> texture_path_hits    = 0;
+	std::atomic<u32> texture_content_hits = 0;
+
+	// The texture used by asynchronous texture loads without a placeholder
+	ComPtr<ID3D11ShaderResourceView> placeholder_srv;
+
+	// Watches the files resources were loaded from. Null if hot reloading is disabled.
+	std::unique_ptr<FileWatcher> file_watcher;
+
+	// The blueprints to reload when a model file changes, keyed by FileWatcher::GetFileKey()
+	std::mutex model_source_mutex;
+	std::unordered_map<std::wstring, std::vector<ModelSource>> model_sources;
+
+	// Work queued for the device thread
+	std::mutex device_work_mutex;
+	std::vector<std::function<void()>> device_work;
+	std::vector<std::function<void()>> device_work_scratch;
+
+	std::atomic<u32> pending_loads = 0;
+
+	// Worker threads. Declared last so queued work finishes before the rest of the manager
+	// is destroyed.
+	std::unique_ptr<ThreadPool> workers;
 };
 
 } //namespace render
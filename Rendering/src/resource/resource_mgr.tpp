@@ -10,7 +10,7 @@ std::shared_ptr<ModelBlueprint> ResourceMgr::getOrCreate(const std::wstring& nam
 	                                                     const ModelOutput& model_data,
 	                                                     const ModelConfig<VertexT>& config) {
 
-	return models.getOrCreate(name, device, model_data, config);
+	return models.getOrCreate(name, device, material_registry, model_data, config);
 }
 
 template<typename ResourceT, typename VertexT>
@@ -19,7 +19,7 @@ std::shared_ptr<ModelBlueprint> ResourceMgr::createOrReplace(const std::wstring&
                                                              const ModelOutput& model_data,
                                                              const ModelConfig<VertexT>& config) {
 
-	return models.createOrReplace(name, device, model_data, config);
+	return models.createOrReplace(name, device, material_registry, model_data, config);
 }
 
 template<typename ResourceT>
@@ -28,6 +28,79 @@ const ResourceMgr::resource_map<std::wstring, ModelBlueprint>& ResourceMgr::getR
 	return models;
 }
 
+template<typename VertexT>
+void ResourceMgr::watchModel(const std::wstring& name,
+                             const fs::path& file,
+                             const ModelConfig<VertexT>& config,
+                             ModelReimporter reimport) {
+	if (not file_watcher)
+		return;
+
+	// Counts the reloads that were started, so an older reload that finishes late is discarded.
+	// Only used on the device thread.
+	auto generation = std::make_shared<u32>(0);
+
+	auto reload = [this, name, config, reimport = std::move(reimport), generation] {
+		const u32 current = ++(*generation);
+		++pending_loads;
+
+		enqueueWork([this, name, config, reimport, generation, current] {
+			std::shared_ptr<ModelOutput> out;
+			try {
+				out = std::make_shared<ModelOutput>(reimport());
+			}
+			catch (const std::exception& e) {
+				Logger::log(LogLevel::err, "Failed to reload model {}: {}", WstrToStr(name), e.what());
+				--pending_loads;
+				return;
+			}
+
+			enqueueDeviceWork([this, name, config, out, generation, current] {
+				if (*generation == current) {
+					try {
+						reloadBlueprint(name, *out, config);
+					}
+					catch (const std::exception& e) {
+						Logger::log(LogLevel::err, "Failed to reload model {}: {}", WstrToStr(name), e.what());
+					}
+				}
+				--pending_loads;
+			});
+		});
+	};
+
+	file_watcher->watch(file);
+
+	std::scoped_lock lock{model_source_mutex};
+
+	auto& sources = model_sources[FileWatcher::GetFileKey(file)];
+	std::erase_if(sources, [&name](const ModelSource& source) { return source.name == name; });
+	sources.push_back(ModelSource{name, std::move(reload)});
+}
+
+template<typename VertexT>
+void ResourceMgr::reloadBlueprint(const std::wstring& name, const ModelOutput& model_data, const ModelConfig<VertexT>& config) {
+	std::shared_ptr<ModelBlueprint> blueprint;
+	if (const auto it = models.find(name); it != models.end())
+		blueprint = (*it).second;
+
+	// The model was released while it was being reimported
+	if (not blueprint)
+		return;
+
+	ModelBlueprint replacement{device, material_registry, model_data, config};
+
+	if (replacement.meshes.size() != blueprint->meshes.size()) {
+		Logger::log(LogLevel::warn,
+		            "Model {} wasn't reloaded, since its mesh count changed from {} to {}. Import it again to use the new version.",
+		            WstrToStr(name), blueprint->meshes.size(), replacement.meshes.size());
+		return;
+	}
+
+	blueprint->reload(std::move(replacement));
+	Logger::log(LogLevel::info, "Reloaded model: {}", WstrToStr(name));
+}
+
 
 
 //----------------------------------------------------------------------------------
@@ -36,9 +109,50 @@ const ResourceMgr::resource_map<std::wstring, ModelBlueprint>& ResourceMgr::getR
 
 template<typename ResourceT>
 requires std::same_as<Texture, ResourceT>
-std::shared_ptr<Texture> ResourceMgr::getOrCreate(const std::wstring& filename) {
-
-	return textures.getOrCreate(filename, device, device_context, filename);
+std::shared_ptr<Texture> ResourceMgr::getOrCreate(const std::wstring& filename, TextureRole role) {
+
+	const auto key = GetTextureKey(filename, role);
+
+	{
+		std::scoped_lock lock{texture_mutex};
+		++texture_requests;
+
+		if (const auto it = textures.find(key); it != textures.end()) {
+			if (auto existing = (*it).second) {
+				++texture_path_hits;
+				return existing;
+			}
+		}
+	}
+
+	watchFile(filename);
+
+	// The file is hashed and decoded without holding the texture mutex, since converting a
+	// texture can take seconds and would block the asynchronous loads.
+	const u64 content_hash = importer::HashTextureFile(filename);
+
+	{
+		std::scoped_lock lock{texture_mutex};
+
+		if (const auto it = textures.find(key); it != textures.end()) {
+			if (auto existing = (*it).second) {
+				++texture_path_hits;
+				return existing;
+			}
+		}
+
+		// Share the texture of an identical file at another path
+		if (auto existing = findTextureByContent(content_hash, role)) {
+			++texture_content_hits;
+			return shareTexture(key, filename, *existing);
+		}
+	}
+
+	const auto image = importer::DecodeTexture(filename, role, texture_cache_dir, content_hash);
+
+	// Another thread may have added the texture while it was being decoded
+	std::scoped_lock lock{texture_mutex};
+	return addTexture(key, filename, image, content_hash, role);
 }
 
 template<typename ResourceT>
@@ -47,14 +161,119 @@ std::shared_ptr<Texture> ResourceMgr::getOrCreate(const std::wstring& name,
                                                   const D3D11_TEXTURE2D_DESC& desc, 
                                                   const D3D11_SUBRESOURCE_DATA& init_data) {
 
+	std::scoped_lock lock{texture_mutex};
 	return textures.getOrCreate(name, name, device, desc, init_data);
 }
 
 template<typename ResourceT>
 requires std::same_as<Texture, ResourceT>
-std::shared_ptr<Texture> ResourceMgr::createOrReplace(const std::wstring& filename) {
+std::shared_ptr<Texture> ResourceMgr::getOrCreate(const std::wstring& filename,
+                                                  const std::optional<DirectX::ScratchImage>& image,
+                                                  u64 content_hash,
+                                                  TextureRole role) {
+
+	const auto key = GetTextureKey(filename, role);
+
+	watchFile(filename);
+
+	std::scoped_lock lock{texture_mutex};
+	++texture_requests;
+	return addTexture(key, filename, image, content_hash, role);
+}
 
-	return textures.createOrReplace(filename, device, device_context, filename);
+template<typename ResourceT>
+requires std::same_as<Texture, ResourceT>
+std::shared_ptr<Texture> ResourceMgr::getOrCreateAsync(const std::wstring& filename,
+                                                       const std::shared_ptr<Texture>& placeholder,
+                                                       TextureRole role) {
+
+	const auto key = GetTextureKey(filename, role);
+
+	std::shared_ptr<Texture> texture;
+	{
+		std::scoped_lock lock{texture_mutex};
+		++texture_requests;
+
+		// Return the texture if it exists, whether or not it has finished loading
+		if (const auto it = textures.find(key); it != textures.end()) {
+			if (auto existing = (*it).second) {
+				++texture_path_hits;
+				return existing;
+			}
+		}
+
+		auto srv = placeholder ? ComPtr<ID3D11ShaderResourceView>{placeholder->get()} : placeholder_srv;
+		texture = textures.createOrReplace(key, filename, std::move(srv));
+	}
+
+	watchFile(filename);
+
+	// Decode the texture on a worker thread, then create it on the device thread
+	++pending_loads;
+
+	enqueueWork([this, weak_texture = std::weak_ptr{texture}, filename, role] {
+		// Skip the load if the texture was released before it started
+		if (weak_texture.expired()) {
+			--pending_loads;
+			return;
+		}
+
+		// Share the texture of an identical file at another path, instead of decoding it again
+		const u64 content_hash = importer::HashTextureFile(filename);
+
+		std::shared_ptr<Texture> existing;
+		{
+			std::scoped_lock lock{texture_mutex};
+			existing = findTextureByContent(content_hash, role);
+		}
+
+		if (existing) {
+			++texture_content_hits;
+			enqueueDeviceWork([this, weak_texture, existing] {
+				if (const auto texture = weak_texture.lock())
+					texture->finishLoad(*existing);
+				--pending_loads;
+			});
+			return;
+		}
+
+		auto image = std::make_shared<std::optional<DirectX::ScratchImage>>(
+			importer::DecodeTexture(filename, role, texture_cache_dir, content_hash)
+		);
+
+		enqueueDeviceWork([this, weak_texture, image, content_hash, role] {
+			if (const auto texture = weak_texture.lock()) {
+				texture->finishLoad(device, *image);
+
+				if ((content_hash != 0) and image->has_value()) {
+					std::scoped_lock lock{texture_mutex};
+					texture_contents[GetTextureContentKey(content_hash, role)] = texture;
+				}
+			}
+			--pending_loads;
+		});
+	});
+
+	return texture;
+}
+
+template<typename ResourceT>
+requires std::same_as<Texture, ResourceT>
+std::shared_ptr<Texture> ResourceMgr::createOrReplace(const std::wstring& filename, TextureRole role) {
+
+	const auto key          = GetTextureKey(filename, role);
+	const u64  content_hash = importer::HashTextureFile(filename);
+	const auto image        = importer::DecodeTexture(filename, role, texture_cache_dir, content_hash);
+
+	watchFile(filename);
+
+	std::scoped_lock lock{texture_mutex};
+
+	auto texture = textures.createOrReplace(key, device, filename, image);
+	if ((content_hash != 0) and image.has_value())
+		texture_contents[GetTextureContentKey(content_hash, role)] = texture;
+
+	return texture;
 }
 
 template<typename ResourceT>
@@ -63,6 +282,7 @@ std::shared_ptr<Texture> ResourceMgr::createOrReplace(const std::wstring& name,
                                                       const D3D11_TEXTURE2D_DESC& desc,
                                                       const D3D11_SUBRESOURCE_DATA& init_data) {
 
+	std::scoped_lock lock{texture_mutex};
 	return textures.createOrReplace(name, name, device, desc, init_data);
 }
 
@@ -252,4 +472,63 @@ const ResourceMgr::shader_resource_map<std::wstring, VertexShader>& ResourceMgr:
 	return vertex_shaders;
 }
 
+
+//----------------------------------------------------------------------------------
+// Shader Permutations
+//----------------------------------------------------------------------------------
+
+template<typename ResourceT>
+requires ShaderResource<ResourceT>
+std::shared_ptr<ResourceT> ResourceMgr::getOrCreateAsync(const ShaderPermutation& permutation,
+                                                         const std::shared_ptr<ResourceT>& fallback,
+                                                         std::span<const D3D11_INPUT_ELEMENT_DESC> input_element_descs) {
+
+	const auto guid = StrToWstr(std::format("shader_{:016x}", ShaderCache::GetPermutationKey(permutation)));
+	auto& shaders   = getShaderMap<ResourceT>();
+
+	std::shared_ptr<ResourceT> shader;
+	{
+		std::scoped_lock lock{shader_mutex};
+
+		// Return the shader if it exists, whether or not it has finished compiling
+		if (const auto it = shaders.find(guid); it != shaders.end())
+			return it->second;
+
+		shader = shaders.createOrReplace(guid, guid, *fallback);
+	}
+
+	// Compile the shader (or read it from the cache) on a worker thread, then create it on
+	// the device thread
+	++pending_loads;
+
+	enqueueWork([this, weak_shader = std::weak_ptr{shader}, permutation, descs = std::vector(input_element_descs.begin(), input_element_descs.end())] {
+		ComPtr<ID3DBlob> blob;
+		const HRESULT hr = CompileShaderPermutation(permutation, shader_cache_dir, gsl::make_not_null(blob.GetAddressOf()));
+
+		if (FAILED(hr)) {
+			Logger::log(LogLevel::err, "Failed to compile shader permutation (entry point: {}, target: {}). Using the fallback shader.",
+			            permutation.entry_point, permutation.target);
+			--pending_loads;
+			return;
+		}
+
+		enqueueDeviceWork([this, weak_shader, blob = std::move(blob), descs] {
+			if (const auto shader = weak_shader.lock()) {
+				try {
+					if constexpr (std::same_as<VertexShader, ResourceT>)
+						shader->finishLoad(device, ShaderBytecodeBlob(blob), descs.empty() ? std::span<const D3D11_INPUT_ELEMENT_DESC>{} : std::span{descs});
+					else
+						shader->finishLoad(device, ShaderBytecodeBlob(blob));
+				}
+				catch (const std::exception& e) {
+					Logger::log(LogLevel::err, "Failed to create shader permutation. Using the fallback shader. {}", e.what());
+				}
+			}
+			--pending_loads;
+		});
+	});
+
+	return shader;
+}
+
 } //namespace render
@@ -1,5 +1,8 @@
 module;
 
+#include <concepts>
+#include <utility>
+
 #include "directx/d3d11.h"
 
 export module rendering:shader;
@@ -26,6 +29,13 @@ public:
 		createShader(device, bytecode);
 	}
 
+	// Create a shader that uses the fallback's shader until finishLoad() is called
+	Shader(const std::wstring& guid, const Shader& fallback)
+		: Resource<Shader>(guid)
+		, shader(fallback.shader)
+		, loaded(false) {
+	}
+
 	Shader(const Shader& shader) = delete;
 	Shader(Shader&& shader) noexcept = default;
 
@@ -52,6 +62,26 @@ public:
 		StageT::bindShader(device_context, shader.Get(), {});
 	}
 
+	// Replace the fallback shader with the compiled shader. Called on the device thread. The
+	// fallback is kept if the shader can't be created.
+	void finishLoad(ID3D11Device& device, const ShaderBytecode& bytecode) {
+		auto fallback = std::exchange(shader, nullptr);
+		try {
+			createShader(device, bytecode);
+		}
+		catch (...) {
+			shader = std::move(fallback);
+			throw;
+		}
+		loaded = true;
+	}
+
+	// False while the shader is using a fallback
+	[[nodiscard]]
+	bool isLoaded() const noexcept {
+		return loaded;
+	}
+
 private:
 
 	void createShader(ID3D11Device& device, const ShaderBytecode& bytecode);
@@ -61,6 +91,7 @@ private:
 	// Member Variables
 	//----------------------------------------------------------------------------------
 	ComPtr<ShaderT> shader;
+	bool            loaded = true;
 };
 
 
@@ -79,6 +110,14 @@ public:
 		createShader(device, bytecode, input_element_descs);
 	}
 
+	// Create a shader that uses the fallback's shader and input layout until finishLoad() is called
+	Shader(const std::wstring& guid, const Shader& fallback)
+		: Resource(guid)
+		, shader(fallback.shader)
+		, layout(fallback.layout)
+		, loaded(false) {
+	}
+
 	Shader(const Shader& shader) = delete;
 	Shader(Shader&& shader) noexcept = default;
 
@@ -106,6 +145,30 @@ public:
 		Pipeline::VS::bindShader(device_context, shader.Get(), {});
 	}
 
+	// Replace the fallback shader and input layout with the compiled shader. Called on the
+	// device thread. The fallback is kept if the shader can't be created.
+	void finishLoad(ID3D11Device& device,
+	                const ShaderBytecode& bytecode,
+	                std::span<const D3D11_INPUT_ELEMENT_DESC> input_element_descs) {
+		auto fallback_shader = std::exchange(shader, nullptr);
+		auto fallback_layout = std::exchange(layout, nullptr);
+		try {
+			createShader(device, bytecode, input_element_descs);
+		}
+		catch (...) {
+			shader = std::move(fallback_shader);
+			layout = std::move(fallback_layout);
+			throw;
+		}
+		loaded = true;
+	}
+
+	// False while the shader is using a fallback
+	[[nodiscard]]
+	bool isLoaded() const noexcept {
+		return loaded;
+	}
+
 private:
 
 	void createShader(ID3D11Device& device,
@@ -135,6 +198,7 @@ private:
 	//----------------------------------------------------------------------------------
 	ComPtr<ID3D11VertexShader> shader;
 	ComPtr<ID3D11InputLayout>  layout;
+	bool                       loaded = true;
 };
 
 
@@ -145,6 +209,14 @@ using GeometryShader = Shader<ID3D11GeometryShader, Pipeline::GS>;
 using HullShader     = Shader<ID3D11HullShader, Pipeline::HS>;
 using PixelShader    = Shader<ID3D11PixelShader, Pipeline::PS>;
 
+template<typename T>
+concept ShaderResource = std::same_as<ComputeShader, T>
+                      or std::same_as<DomainShader, T>
+                      or std::same_as<GeometryShader, T>
+                      or std::same_as<HullShader, T>
+                      or std::same_as<PixelShader, T>
+                      or std::same_as<VertexShader, T>;
+
 
 template<>
 void ComputeShader::createShader(ID3D11Device& device, const ShaderBytecode& bytecode) {
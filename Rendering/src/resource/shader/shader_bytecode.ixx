@@ -1,20 +1,26 @@
 module;
 
+#include <cstring>
+#include <vector>
+
 #include "io/io.h"
 #include "directx/d3d11.h"
 
+#include "shader_cache.h"
+
 export module rendering:shader_bytecode;
 
 import log;
 
 export namespace render {
 
-// Compile a shader file
+using ShaderCache::ShaderDefine;
+using ShaderCache::ShaderPermutation;
+
+
+// The compiler flags used for shaders compiled at runtime
 [[nodiscard]]
-HRESULT CompileShaderToBytecode(const fs::path& file,
-                                const std::string& entry_point,
-                                const std::string& target_ver,
-                                gsl::not_null<ID3DBlob**> out) {
+u32 GetShaderCompileFlags() noexcept {
 	u32 flags = D3DCOMPILE_ENABLE_STRICTNESS;
 
 	#ifdef _DEBUG
@@ -22,6 +28,17 @@ HRESULT CompileShaderToBytecode(const fs::path& file,
 	flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
 	#endif
 
+	return flags;
+}
+
+// Compile a shader file
+[[nodiscard]]
+HRESULT CompileShaderToBytecode(const fs::path& file,
+                                const std::string& entry_point,
+                                const std::string& target_ver,
+                                gsl::not_null<ID3DBlob**> out) {
+	const u32 flags = GetShaderCompileFlags();
+
 	ComPtr<ID3DBlob> error_msgs;
 	const auto filename = file.wstring();
 	const HRESULT hr = D3DCompileFromFile(filename.c_str(),
@@ -53,12 +70,7 @@ HRESULT CompileShaderToBytecode(std::string_view data,
                                 const std::string& entry_point,
                                 const std::string& target_ver,
                                 gsl::not_null<ID3DBlob**> out){
-	u32 flags = D3DCOMPILE_ENABLE_STRICTNESS;
-
-	#ifdef _DEBUG
-	flags |= D3DCOMPILE_DEBUG;
-	flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-	#endif
+	const u32 flags = GetShaderCompileFlags();
 
 	ComPtr<ID3DBlob> error_msgs;
 	const HRESULT hr = D3DCompile(data.data(),
@@ -86,6 +98,68 @@ HRESULT CompileShaderToBytecode(std::string_view data,
 	return hr;
 }
 
+// Compile a shader permutation, or read its bytecode from the shader cache. Newly compiled
+// bytecode is written to the cache. An empty cache directory disables the cache. Doesn't use
+// the device, so this can be called from any thread.
+[[nodiscard]]
+HRESULT CompileShaderPermutation(const ShaderPermutation& permutation,
+                                 const fs::path& cache_dir,
+                                 gsl::not_null<ID3DBlob**> out) {
+
+	const u64 key = ShaderCache::GetPermutationKey(permutation);
+
+	if (not cache_dir.empty()) {
+		if (const auto bytecode = ShaderCache::ReadCache(cache_dir, key)) {
+			const HRESULT hr = D3DCreateBlob(bytecode->size(), out);
+			if (SUCCEEDED(hr))
+				std::memcpy((*out)->GetBufferPointer(), bytecode->data(), bytecode->size());
+			return hr;
+		}
+	}
+
+	// The defines are passed as a null terminated array
+	std::vector<D3D_SHADER_MACRO> macros;
+	macros.reserve(permutation.defines.size() + 1);
+	for (const auto& [name, value] : permutation.defines) {
+		macros.push_back(D3D_SHADER_MACRO{name.c_str(), value.c_str()});
+	}
+	macros.push_back(D3D_SHADER_MACRO{nullptr, nullptr});
+
+	// The source name is used to resolve includes relative to the source file
+	const auto source_name = permutation.source_file.string();
+
+	ComPtr<ID3DBlob> error_msgs;
+	const HRESULT hr = D3DCompile(permutation.source.data(),
+	                              permutation.source.size(),
+	                              source_name.empty() ? nullptr : source_name.c_str(),
+	                              macros.data(),
+	                              D3D_COMPILE_STANDARD_FILE_INCLUDE,
+	                              permutation.entry_point.c_str(),
+	                              permutation.target.c_str(),
+	                              permutation.flags,
+	                              NULL,
+	                              out,
+	                              error_msgs.GetAddressOf());
+
+	if (FAILED(hr)) {
+		if (error_msgs) {
+			const std::string_view error{static_cast<const char*>(error_msgs->GetBufferPointer()), error_msgs->GetBufferSize()};
+			Logger::log(LogLevel::err, "Shader compilation failed: {}", error);
+		}
+		return hr;
+	}
+
+	if (not cache_dir.empty()) {
+		const auto includes = ShaderCache::ResolveIncludes(permutation.source, permutation.source_file);
+		const std::span bytecode{static_cast<const std::byte*>((*out)->GetBufferPointer()), (*out)->GetBufferSize()};
+
+		if (not ShaderCache::WriteCache(cache_dir, key, includes, bytecode))
+			Logger::log(LogLevel::warn, "Failed to write shader cache entry: {}", ShaderCache::GetCachePath(cache_dir, key).string());
+	}
+
+	return hr;
+}
+
 
 class ShaderBytecode {
 public:
@@ -0,0 +1,336 @@
+#include "shader_cache.h"
+
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+
+
+//----------------------------------------------------------------------------------
+// File Layout
+//----------------------------------------------------------------------------------
+//
+// FileHeader
+// IncludeRecord[include_count]  (each record followed by its path)
+// std::byte[bytecode_size]
+//
+//----------------------------------------------------------------------------------
+namespace {
+
+constexpr u32 cache_magic   = 0x44485348; //"HSHD"
+constexpr u32 cache_version = 1;
+
+struct FileHeader {
+	u32 magic         = cache_magic;
+	u32 version       = cache_version;
+	u64 key           = 0;
+	u32 include_count = 0;
+	u32 padding       = 0;
+	u64 bytecode_size = 0;
+};
+
+struct IncludeRecord {
+	u64 hash      = 0;
+	u32 path_size = 0;
+	u32 padding   = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<IncludeRecord>);
+
+
+template<typename T>
+[[nodiscard]]
+bool Read(std::istream& stream, T& value) {
+	stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+	return static_cast<bool>(stream);
+}
+
+template<typename T>
+void Write(std::ostream& stream, const T& value) {
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+// Continue a hash with a value, prefixed by its size so adjacent values can't run together
+[[nodiscard]]
+u64 HashValue(std::string_view value, u64 hash) noexcept {
+	const u64 size = value.size();
+	hash = render::ShaderCache::HashBytes(std::string_view{reinterpret_cast<const char*>(&size), sizeof(size)}, hash);
+	return render::ShaderCache::HashBytes(value, hash);
+}
+
+// Replace the comments in HLSL source with spaces. Line breaks are kept, so each line of the
+// result matches a line of the source. String literals are skipped, so "//" in a string isn't
+// mistaken for a comment.
+[[nodiscard]]
+std::string StripComments(std::string_view source) {
+	std::string result{source};
+
+	for (size_t i = 0; i < result.size(); ++i) {
+		const char c    = result[i];
+		const char next = (i + 1 < result.size()) ? result[i + 1] : '\0';
+
+		if (c == '"') {
+			for (++i; (i < result.size()) and (result[i] != '"') and (result[i] != '\n'); ++i) {
+				if (result[i] == '\\')
+					++i;
+			}
+		}
+		else if ((c == '/') and (next == '/')) {
+			for (; (i < result.size()) and (result[i] != '\n'); ++i)
+				result[i] = ' ';
+		}
+		else if ((c == '/') and (next == '*')) {
+			result[i] = result[i + 1] = ' ';
+			for (i += 2; i < result.size(); ++i) {
+				if ((result[i] == '*') and (i + 1 < result.size()) and (result[i + 1] == '/')) {
+					result[i] = result[i + 1] = ' ';
+					++i;
+					break;
+				}
+				if (result[i] != '\n')
+					result[i] = ' ';
+			}
+		}
+	}
+
+	return result;
+}
+
+// Parse the file name of an #include directive. Returns an empty view if the line isn't one.
+[[nodiscard]]
+std::string_view ParseInclude(std::string_view line) noexcept {
+	constexpr std::string_view whitespace = " \t\r";
+	constexpr std::string_view directive  = "include";
+
+	auto pos = line.find_first_not_of(whitespace);
+	if ((pos == std::string_view::npos) or (line[pos] != '#'))
+		return {};
+
+	pos = line.find_first_not_of(whitespace, pos + 1);
+	if ((pos == std::string_view::npos) or (line.substr(pos, directive.size()) != directive))
+		return {};
+
+	pos = line.find_first_not_of(whitespace, pos + directive.size());
+	if (pos == std::string_view::npos)
+		return {};
+
+	const char close = (line[pos] == '"') ? '"' : (line[pos] == '<') ? '>' : '\0';
+	if (close == '\0')
+		return {};
+
+	const auto end = line.find(close, pos + 1);
+	if (end == std::string_view::npos)
+		return {};
+
+	return line.substr(pos + 1, end - pos - 1);
+}
+
+} //namespace
+
+
+namespace render::ShaderCache {
+
+u64 HashBytes(std::string_view data, u64 hash) noexcept {
+	for (const char c : data) {
+		hash ^= static_cast<u8>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+
+std::optional<std::string> ReadSource(const fs::path& file) {
+	std::ifstream stream(file, std::ios::binary);
+	if (not stream)
+		return std::nullopt;
+
+	return std::string{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+
+u64 HashFile(const fs::path& file) {
+	const auto contents = ReadSource(file);
+	if (not contents)
+		return 0;
+
+	const u64 hash = HashBytes(*contents);
+	return (hash == 0) ? 1 : hash;
+}
+
+
+u64 GetPermutationKey(const ShaderPermutation& permutation) noexcept {
+	u64 hash = HashBytes({});
+
+	hash = HashValue(permutation.source, hash);
+
+	// Includes are resolved relative to the source file, so the same source in another
+	// directory can include different files
+	hash = HashValue(permutation.source_file.parent_path().generic_string(), hash);
+
+	for (const auto& [name, value] : permutation.defines) {
+		hash = HashValue(name, hash);
+		hash = HashValue(value, hash);
+	}
+	hash = HashValue(std::to_string(permutation.defines.size()), hash);
+
+	hash = HashValue(permutation.entry_point, hash);
+	hash = HashValue(permutation.target, hash);
+	hash = HashValue(std::to_string(permutation.flags), hash);
+
+	return hash;
+}
+
+
+std::vector<std::string> ScanIncludes(std::string_view source) {
+	std::vector<std::string> includes;
+
+	const auto stripped = StripComments(source);
+	const std::string_view text{stripped};
+
+	for (size_t begin = 0; begin < text.size();) {
+		const auto end  = std::min(text.find('\n', begin), text.size());
+		const auto name = ParseInclude(text.substr(begin, end - begin));
+
+		if (not name.empty())
+			includes.emplace_back(name);
+
+		begin = end + 1;
+	}
+
+	return includes;
+}
+
+
+std::vector<IncludeDependency> ResolveIncludes(std::string_view source, const fs::path& source_file) {
+	std::vector<IncludeDependency> dependencies;
+	std::unordered_set<std::string> visited;
+
+	// Each file is scanned once, even if it's included more than once
+	std::function<void(std::string_view, const fs::path&)> resolve = [&](std::string_view text, const fs::path& dir) {
+		for (const auto& name : ScanIncludes(text)) {
+			std::error_code error;
+
+			fs::path file = dir / name;
+			if (not fs::is_regular_file(file, error))
+				file = name;
+			if (not fs::is_regular_file(file, error))
+				continue;
+
+			file = fs::weakly_canonical(file, error);
+			if (not visited.insert(file.generic_string()).second)
+				continue;
+
+			const auto contents = ReadSource(file);
+			if (not contents)
+				continue;
+
+			const u64 hash = HashBytes(*contents);
+			dependencies.push_back(IncludeDependency{file, (hash == 0) ? 1 : hash});
+
+			resolve(*contents, file.parent_path());
+		}
+	};
+
+	resolve(source, source_file.parent_path());
+	return dependencies;
+}
+
+
+fs::path GetCachePath(const fs::path& cache_dir, u64 key) {
+	return cache_dir / std::format("{:016x}_v{}.cso", key, cache_version);
+}
+
+
+std::optional<std::vector<std::byte>> ReadCache(const fs::path& cache_dir, u64 key) {
+	std::ifstream stream(GetCachePath(cache_dir, key), std::ios::binary);
+	if (not stream)
+		return std::nullopt;
+
+	FileHeader header;
+	if (not Read(stream, header))
+		return std::nullopt;
+	if ((header.magic != cache_magic) or (header.version != cache_version) or (header.key != key))
+		return std::nullopt;
+
+	// The entry is out of date if any of the files it included changed
+	for (u32 i = 0; i < header.include_count; ++i) {
+		IncludeRecord record;
+		if (not Read(stream, record))
+			return std::nullopt;
+
+		std::string path(record.path_size, '\0');
+		if (not stream.read(path.data(), static_cast<std::streamsize>(path.size())))
+			return std::nullopt;
+
+		if (HashFile(fs::path{path}) != record.hash)
+			return std::nullopt;
+	}
+
+	std::vector<std::byte> bytecode(header.bytecode_size);
+	if (not stream.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size())))
+		return std::nullopt;
+
+	return bytecode;
+}
+
+
+bool WriteCache(const fs::path& cache_dir,
+                u64 key,
+                std::span<const IncludeDependency> includes,
+                std::span<const std::byte> bytecode) {
+
+	std::error_code error;
+	fs::create_directories(cache_dir, error);
+	if (error)
+		return false;
+
+	const auto cache_file = GetCachePath(cache_dir, key);
+
+	auto temp_file = cache_file;
+	temp_file += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	{
+		std::ofstream stream(temp_file, std::ios::binary | std::ios::trunc);
+		if (not stream)
+			return false;
+
+		FileHeader header;
+		header.key           = key;
+		header.include_count = static_cast<u32>(includes.size());
+		header.bytecode_size = bytecode.size();
+		Write(stream, header);
+
+		for (const auto& [file, hash] : includes) {
+			const auto path = file.generic_string();
+
+			IncludeRecord record;
+			record.hash      = hash;
+			record.path_size = static_cast<u32>(path.size());
+			Write(stream, record);
+			stream.write(path.data(), static_cast<std::streamsize>(path.size()));
+		}
+
+		stream.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+
+		if (not stream) {
+			stream.close();
+			fs::remove(temp_file, error);
+			return false;
+		}
+	}
+
+	fs::rename(temp_file, cache_file, error);
+	if (error) {
+		fs::remove(temp_file, error);
+		return false;
+	}
+
+	return true;
+}
+
+} //namespace render::ShaderCache
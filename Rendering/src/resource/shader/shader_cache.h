@@ -0,0 +1,103 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+
+
+//----------------------------------------------------------------------------------
+// Shader Cache
+//----------------------------------------------------------------------------------
+//
+// A persistent store of compiled shader bytecode, keyed by shader permutation.
+//
+// A permutation is everything that determines a shader's bytecode: the source, the
+// preprocessor defines, the entry point, the target profile, and the compiler flags.
+// The key of a permutation is a hash of all of them. The files the source includes
+// aren't part of the key. Instead, each cache entry records the files that were
+// included when it was compiled along with the hash of their contents, and an entry
+// is only used if none of them changed since.
+//
+// This code only depends on the standard library, and isn't part of the rendering
+// module, so the keys, include scanning, and cache files can be used and verified
+// without a D3D device or compiler.
+//
+//----------------------------------------------------------------------------------
+namespace render::ShaderCache {
+
+struct ShaderDefine {
+	std::string name;
+	std::string value;
+};
+
+// The inputs that determine a shader's bytecode
+struct ShaderPermutation {
+	// The HLSL source, and the file it was read from. Includes are resolved relative to the
+	// file's directory. The file is empty for source that only exists in memory.
+	std::string source;
+	fs::path    source_file;
+
+	std::vector<ShaderDefine> defines;
+	std::string entry_point;
+	std::string target;
+	u32         flags = 0; //compiler flags
+};
+
+// A file included by a shader, and the hash of its contents
+struct IncludeDependency {
+	fs::path file;
+	u64      hash = 0;
+};
+
+// Hash a range of bytes (64-bit FNV-1a). The hash of one range can be continued with another.
+[[nodiscard]]
+u64 HashBytes(std::string_view data, u64 hash = 0xcbf29ce484222325ull) noexcept;
+
+// Hash the contents of a file. Returns 0 if the file can't be read.
+[[nodiscard]]
+u64 HashFile(const fs::path& file);
+
+// Read the source of a shader file. Returns nullopt if the file can't be read.
+[[nodiscard]]
+std::optional<std::string> ReadSource(const fs::path& file);
+
+// The key of a permutation. Permutations with the same key produce the same bytecode, as long
+// as the files they include are the same.
+[[nodiscard]]
+u64 GetPermutationKey(const ShaderPermutation& permutation) noexcept;
+
+// The names in the #include directives of HLSL source, in order. Directives in comments are
+// ignored. Conditional compilation isn't evaluated, so the includes of every branch are listed.
+[[nodiscard]]
+std::vector<std::string> ScanIncludes(std::string_view source);
+
+// Find the files a shader includes, directly or through other includes. An include is looked
+// up in the directory of the file that includes it, then in the working directory, which
+// matches the compiler's standard include handler. Includes that can't be found are skipped,
+// since the compiler will report them.
+[[nodiscard]]
+std::vector<IncludeDependency> ResolveIncludes(std::string_view source, const fs::path& source_file);
+
+// The path of a permutation's entry in the cache
+[[nodiscard]]
+fs::path GetCachePath(const fs::path& cache_dir, u64 key);
+
+// Read the bytecode of a permutation. Returns nullopt if the cache has no entry for the key,
+// the entry was written by a different version, or one of the files it included changed.
+[[nodiscard]]
+std::optional<std::vector<std::byte>> ReadCache(const fs::path& cache_dir, u64 key);
+
+// Write the bytecode of a permutation along with the files it included. The entry is written
+// through a temporary file, so a concurrent reader never sees a partial entry. Returns false
+// if the entry couldn't be written.
+bool WriteCache(const fs::path& cache_dir,
+                u64 key,
+                std::span<const IncludeDependency> includes,
+                std::span<const std::byte> bytecode);
+
+} //namespace render::ShaderCache
@@ -11,6 +11,7 @@ module rendering;
 
 // Forward
 #include "compiled_headers/forward_vs.h"
+#include "compiled_headers/forward_compact_vs.h"
 
 #include "compiled_headers/forward_lambert.h"
 #include "compiled_headers/forward_blinn_phong.h"
@@ -30,8 +31,10 @@ module rendering;
 
 // Depth
 #include "compiled_headers/depth_vs.h"
+#include "compiled_headers/depth_restore_ps.h"
 #include "compiled_headers/depth_transparent_ps.h"
 #include "compiled_headers/depth_transparent_vs.h"
+#include "compiled_headers/hi_z_cs.h"
 
 // Sky
 #include "compiled_headers/skybox_ps.h"
@@ -93,7 +96,14 @@ std::shared_ptr<PixelShader> CreateForwardPS(ResourceMgr& resource_mgr, BRDF brd
 	}
 }
 
-std::shared_ptr<VertexShader> CreateForwardVS(ResourceMgr& resource_mgr) {
+std::shared_ptr<VertexShader> CreateForwardVS(ResourceMgr& resource_mgr, bool quantized) {
+
+	if (quantized) {
+		return resource_mgr.getOrCreate<VertexShader>(L"shader_forward_compact_vs",
+		                                              BYTECODE(shader_forward_compact_vs),
+		                                              std::span{VertexPositionNormalTextureCompact::input_elements,
+		                                                        VertexPositionNormalTextureCompact::input_element_count});
+	}
 
 	return resource_mgr.getOrCreate<VertexShader>(L"shader_forward_vs",
 													BYTECODE(shader_forward_vs),
@@ -139,7 +149,16 @@ std::shared_ptr<PixelShader> CreateDeferredPS(ResourceMgr& resource_mgr, BRDF br
 // Depth
 //----------------------------------------------------------------------------------
 
-std::shared_ptr<VertexShader> CreateDepthVS(ResourceMgr& resource_mgr) {
+// The depth shaders don't read the normal, and the GPU converts the compact position and texture
+// coordinate formats on load, so the quantized variants only differ in their input layout.
+std::shared_ptr<VertexShader> CreateDepthVS(ResourceMgr& resource_mgr, bool quantized) {
+
+	if (quantized) {
+		return resource_mgr.getOrCreate<VertexShader>(L"shader_depth_compact_vs",
+		                                              BYTECODE(shader_depth_vs),
+		                                              std::span{VertexPositionNormalTextureCompact::input_elements,
+		                                                        VertexPositionNormalTextureCompact::input_element_count});
+	}
 
 	return resource_mgr.getOrCreate<VertexShader>(L"shader_depth_vs",
 													BYTECODE(shader_depth_vs),
@@ -152,7 +171,14 @@ std::shared_ptr<PixelShader> CreateDepthTransparentPS(ResourceMgr& resource_mgr)
 	return resource_mgr.getOrCreate<PixelShader>(L"shader_depth_transparent_ps", BYTECODE(shader_depth_transparent_ps));
 }
 
-std::shared_ptr<VertexShader> CreateDepthTransparentVS(ResourceMgr& resource_mgr) {
+std::shared_ptr<VertexShader> CreateDepthTransparentVS(ResourceMgr& resource_mgr, bool quantized) {
+
+	if (quantized) {
+		return resource_mgr.getOrCreate<VertexShader>(L"shader_depth_transparent_compact_vs",
+		                                              BYTECODE(shader_depth_transparent_vs),
+		                                              std::span{VertexPositionNormalTextureCompact::input_elements,
+		                                                        VertexPositionNormalTextureCompact::input_element_count});
+	}
 
 	return resource_mgr.getOrCreate<VertexShader>(L"shader_depth_transparent_vs",
 													BYTECODE(shader_depth_transparent_vs),
@@ -160,6 +186,16 @@ std::shared_ptr<VertexShader> CreateDepthTransparentVS(ResourceMgr& resource_mgr
 													          VertexPositionNormalTexture::input_element_count});
 }
 
+std::shared_ptr<PixelShader> CreateDepthRestorePS(ResourceMgr& resource_mgr) {
+
+	return resource_mgr.getOrCreate<PixelShader>(L"shader_depth_restore_ps", BYTECODE(shader_depth_restore_ps));
+}
+
+std::shared_ptr<ComputeShader> CreateHiZCS(ResourceMgr& resource_mgr) {
+
+	return resource_mgr.getOrCreate<ComputeShader>(L"shader_hi_z_cs", BYTECODE(shader_hi_z_cs));
+}
+
 
 //----------------------------------------------------------------------------------
 // Sky
@@ -1,13 +1,22 @@
 module;
 
+#include <span>
+#include <string>
+#include <vector>
+
 #include "datatypes/types.h"
 #include "io/io.h"
 
 #include "directx/d3d11.h"
 
+#include "shader_cache.h"
+
 export module rendering:shader_factory;
 
+import log;
+
 import :shader;
+import :shader_bytecode;
 import :rendering_options;
 import :resource_mgr;
 import :vertex_types;
@@ -16,6 +25,20 @@ import :vertex_types;
 export namespace render::ShaderFactory {
 
 namespace detail {
+template<typename ShaderT>
+[[nodiscard]]
+std::shared_ptr<ShaderT> CreateShader(ResourceMgr& resource_mgr, const std::wstring& shader_name, const ShaderPermutation& permutation) {
+	ComPtr<ID3DBlob> blob;
+	const HRESULT result = CompileShaderPermutation(permutation,
+	                                                resource_mgr.getShaderCacheDirectory(),
+	                                                gsl::make_not_null(blob.GetAddressOf()));
+
+	if (SUCCEEDED(result)) {
+		return CreateShader<ShaderT>(resource_mgr, shader_name, blob);
+	}
+	return {};
+}
+
 template<typename ShaderT>
 [[nodiscard]]
 std::shared_ptr<ShaderT> CreateShader(ResourceMgr& resource_mgr, const std::wstring& shader_name, const ComPtr<ID3DBlob>& blob) {
@@ -44,16 +67,14 @@ std::shared_ptr<ShaderT> CreateShaderFromMemory(ResourceMgr& resource_mgr,
                                                 const std::wstring& shader_name,
                                                 const std::string& entry_point,
                                                 const std::string& target_ver) {
-	ComPtr<ID3DBlob> blob;
-	const HRESULT result = CompileShaderToBytecode(data,
-	                                               entry_point,
-	                                               target_ver,
-	                                               gsl::make_not_null(blob.GetAddressOf()));
-
-	if (SUCCEEDED(result)) {
-		return detail::CreateShader<ShaderT>(resource_mgr, shader_name, blob);
-	}
-	return {};
+	const ShaderPermutation permutation{
+		.source      = std::string{data},
+		.entry_point = entry_point,
+		.target      = target_ver,
+		.flags       = GetShaderCompileFlags()
+	};
+
+	return detail::CreateShader<ShaderT>(resource_mgr, shader_name, permutation);
 }
 
 template<typename ShaderT>
@@ -62,16 +83,67 @@ std::shared_ptr<ShaderT> CreateShaderFromFile(ResourceMgr& resource_mgr,
                                               const fs::path& file,
                                               const std::string& entry_point,
                                               const std::string& target_ver) {
-	ComPtr<ID3DBlob> blob;
-	const HRESULT result = CompileShaderToBytecode(file,
-	                                               entry_point,
-	                                               target_ver,
-	                                               gsl::make_not_null(blob.GetAddressOf()));
+	auto source = ShaderCache::ReadSource(file);
+	if (not source) {
+		Logger::log(LogLevel::err, "Failed to read shader file: {}", file.string());
+		return {};
+	}
 
-	if (SUCCEEDED(result)) {
-		return detail::CreateShader<ShaderT>(resource_mgr, file.filename().wstring(), blob);
+	const ShaderPermutation permutation{
+		.source      = std::move(*source),
+		.source_file = file,
+		.entry_point = entry_point,
+		.target      = target_ver,
+		.flags       = GetShaderCompileFlags()
+	};
+
+	return detail::CreateShader<ShaderT>(resource_mgr, file.filename().wstring(), permutation);
+}
+
+// Compile a shader permutation on the worker threads, or read it from the shader cache. The
+// returned shader uses the fallback until it's ready, and keeps using it if the permutation
+// fails to compile. Vertex shaders use the VertexPositionNormalTexture input layout.
+template<typename ShaderT>
+[[nodiscard]]
+std::shared_ptr<ShaderT> CreateShaderAsync(ResourceMgr& resource_mgr,
+                                           const ShaderPermutation& permutation,
+                                           const std::shared_ptr<ShaderT>& fallback) {
+	if constexpr (std::is_same_v<VertexShader, ShaderT>) {
+		return resource_mgr.getOrCreateAsync<ShaderT>(permutation,
+		                                              fallback,
+		                                              std::span{VertexPositionNormalTexture::input_elements,
+		                                                        VertexPositionNormalTexture::input_element_count});
 	}
-	return {};
+	else {
+		return resource_mgr.getOrCreateAsync<ShaderT>(permutation, fallback);
+	}
+}
+
+// Compile a permutation of a shader file on the worker threads. See CreateShaderAsync().
+template<typename ShaderT>
+[[nodiscard]]
+std::shared_ptr<ShaderT> CreateShaderFromFileAsync(ResourceMgr& resource_mgr,
+                                                   const fs::path& file,
+                                                   const std::string& entry_point,
+                                                   const std::string& target_ver,
+                                                   std::vector<ShaderDefine> defines,
+                                                   const std::shared_ptr<ShaderT>& fallback) {
+	auto source = ShaderCache::ReadSource(file);
+	if (not source) {
+		Logger::log(LogLevel::err, "Failed to read shader file: {}", file.string());
+		return fallback;
+	}
+
+	const ShaderPermutation permutation{
+		.source      = std::move(*source),
+		.source_file = file,
+		.defines     = std::move(defines),
+		.entry_point = entry_point,
+		.target      = target_ver,
+		.flags       = GetShaderCompileFlags()
+	};
+
+	return CreateShaderAsync<ShaderT>(resource_mgr, permutation, fallback);
 }
 
 
@@ -81,8 +153,9 @@ std::shared_ptr<ShaderT> CreateShaderFromFile(ResourceMgr& resource_mgr,
 [[nodiscard]]
 std::shared_ptr<PixelShader> CreateForwardPS(ResourceMgr& resource_mgr, BRDF brdf, bool transparency);
 
+// If quantized is true, the shader's input layout matches VertexPositionNormalTextureCompact
 [[nodiscard]]
-std::shared_ptr<VertexShader> CreateForwardVS(ResourceMgr& resource_mgr);
+std::shared_ptr<VertexShader> CreateForwardVS(ResourceMgr& resource_mgr, bool quantized = false);
 
 
 //----------------------------------------------------------------------------------
@@ -103,13 +176,20 @@ std::shared_ptr<PixelShader> CreateDeferredPS(ResourceMgr& resource_mgr, BRDF br
 // Depth
 //----------------------------------------------------------------------------------
 [[nodiscard]]
-std::shared_ptr<VertexShader> CreateDepthVS(ResourceMgr& resource_mgr);
+std::shared_ptr<VertexShader> CreateDepthVS(ResourceMgr& resource_mgr, bool quantized = false);
 
 [[nodiscard]]
 std::shared_ptr<PixelShader> CreateDepthTransparentPS(ResourceMgr& resource_mgr);
 
 [[nodiscard]]
-std::shared_ptr<VertexShader> CreateDepthTransparentVS(ResourceMgr& resource_mgr);
+std::shared_ptr<VertexShader> CreateDepthTransparentVS(ResourceMgr& resource_mgr, bool quantized = false);
+
+// Writes the depth bound to SLOT_SRV_DEPTH into the bound depth stencil view
+[[nodiscard]]
+std::shared_ptr<PixelShader> CreateDepthRestorePS(ResourceMgr& resource_mgr);
+
+[[nodiscard]]
+std::shared_ptr<ComputeShader> CreateHiZCS(ResourceMgr& resource_mgr);
 
 
 //----------------------------------------------------------------------------------
@@ -0,0 +1,158 @@
+module;
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "string/string.h"
+
+#include <DirectXTex.h>
+
+export module rendering:resource_streaming_source;
+
+import log;
+import :blueprint_factory;
+import :importer.texture_importer;
+import :model_blueprint;
+import :model_config;
+import :resource_mgr;
+import :streaming_mgr;
+import :texture;
+
+
+//----------------------------------------------------------------------------------
+// ResourceStreamingSource
+//----------------------------------------------------------------------------------
+//
+// Streams textures and models through the ResourceMgr. Files are decoded and parsed
+// on the ResourceMgr's worker threads, and their GPU resources are created on the
+// device thread during ResourceMgr::update(). Loaded resources are also stored in the
+// ResourceMgr's maps, so they're shared with anything that loads the same file.
+//
+// Files with an image extension are loaded as textures, and every other file is
+// loaded as a model with the given config.
+//
+//----------------------------------------------------------------------------------
+export namespace render {
+
+template<typename VertexT>
+class ResourceStreamingSource final : public IStreamingSource {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	ResourceStreamingSource(ResourceMgr& resource_mgr, const ModelConfig<VertexT>& model_config)
+		: resource_mgr(resource_mgr)
+		, model_config(model_config) {
+	}
+
+	ResourceStreamingSource(const ResourceStreamingSource&) = delete;
+	ResourceStreamingSource(ResourceStreamingSource&&) = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~ResourceStreamingSource() override = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	ResourceStreamingSource& operator=(const ResourceStreamingSource&) = delete;
+	ResourceStreamingSource& operator=(ResourceStreamingSource&&) = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	void load(const std::wstring& name, Callback on_complete) override {
+		if (IsTextureFile(name))
+			loadTexture(name, std::move(on_complete));
+		else
+			loadModel(name, std::move(on_complete));
+	}
+
+	[[nodiscard]]
+	u64 estimateSize(const std::wstring& name) const override {
+		if (IsTextureFile(name)) {
+			if (const u64 size = importer::EstimateTextureMemoryUsage(name); size != 0)
+				return size;
+		}
+
+		// The size of a model's vertex data is close to the size of its file
+		std::error_code error;
+		const auto size = fs::file_size(name, error);
+		return error ? 0 : static_cast<u64>(size);
+	}
+
+private:
+
+	[[nodiscard]]
+	static bool IsTextureFile(const fs::path& file) {
+		static constexpr const wchar_t* extensions[] = {
+			L".dds", L".tga", L".png", L".jpg", L".jpeg", L".bmp", L".tif", L".tiff", L".gif"
+		};
+
+		const auto extension = file.extension().wstring();
+		for (const auto* ext : extensions) {
+			if (_wcsicmp(extension.c_str(), ext) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	void loadTexture(const std::wstring& filename, Callback on_complete) {
+		resource_mgr.get().enqueueWork([&mgr = resource_mgr.get(), filename, on_complete = std::move(on_complete)] {
+			auto image = std::make_shared<std::optional<DirectX::ScratchImage>>(importer::DecodeTexture(filename));
+			const u64 content_hash = importer::HashTextureFile(filename);
+
+			// Report the failure rather than streaming in an error texture
+			if (not image->has_value()) {
+				on_complete(LoadResult{});
+				return;
+			}
+
+			mgr.enqueueDeviceWork([&mgr, filename, image, content_hash, on_complete] {
+				const auto texture = mgr.getOrCreate<Texture>(filename, *image, content_hash);
+				on_complete(LoadResult{texture, texture->getMemoryUsage()});
+			});
+		});
+	}
+
+	void loadModel(const std::wstring& filename, Callback on_complete) {
+		const auto callback = [filename, on_complete = std::move(on_complete)](std::shared_ptr<ModelBlueprint> blueprint, std::exception_ptr error) {
+			if (error) {
+				try {
+					std::rethrow_exception(error);
+				}
+				catch (const std::exception& e) {
+					Logger::log(LogLevel::err, "Failed to stream model {}: {}", WstrToStr(filename), e.what());
+				}
+				catch (...) {
+				}
+				on_complete(LoadResult{});
+				return;
+			}
+
+			const u64 size = blueprint->getMemoryUsage();
+			on_complete(LoadResult{std::move(blueprint), size});
+		};
+
+		BlueprintFactory::LoadModelFileAsync(resource_mgr.get(), filename, model_config, callback);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::reference_wrapper<ResourceMgr> resource_mgr;
+	ModelConfig<VertexT> model_config;
+};
+
+} //namespace render
@@ -0,0 +1,260 @@
+module;
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "string/string.h"
+
+module rendering;
+
+import log;
+import math.geometry;
+import :streaming_mgr;
+
+using namespace DirectX;
+
+
+namespace render {
+
+StreamingMgr::StreamingMgr(std::shared_ptr<IStreamingSource> source, const Config& config)
+	: source(std::move(source))
+	, config(config)
+	, completion_queue(std::make_shared<CompletionQueue>()) {
+}
+
+
+void StreamingMgr::request(const std::wstring& name, f32 priority) {
+	auto [it, inserted] = entries.try_emplace(name);
+	auto& entry = it->second;
+
+	if (inserted or not entry.requested)
+		entry.priority = priority;
+	else
+		entry.priority = std::max(entry.priority, priority);
+
+	entry.requested      = true;
+	entry.last_requested = frame;
+}
+
+
+void StreamingMgr::release(const std::wstring& name) {
+	const auto it = entries.find(name);
+	if (it == entries.end())
+		return;
+
+	switch (it->second.state) {
+		case State::queued:
+		case State::failed:
+			entries.erase(it);
+			break;
+
+		// A load in flight completes as an unrequested resource
+		case State::loading:
+		case State::resident:
+			it->second.requested = false;
+			break;
+	}
+}
+
+
+void StreamingMgr::update() {
+	processCompletions();
+
+	// Evict unused resources if the budget was lowered or loads were larger than estimated
+	if ((resident_bytes + reserved_bytes) > config.memory_budget)
+		evict(config.memory_budget);
+
+	dispatch();
+	endRequests();
+
+	++frame;
+}
+
+
+bool StreamingMgr::isResident(const std::wstring& name) const {
+	const auto it = entries.find(name);
+	return (it != entries.end()) and (it->second.state == State::resident);
+}
+
+
+StreamingMgr::Stats StreamingMgr::getStats() const {
+	Stats stats;
+	stats.memory_budget = config.memory_budget;
+	stats.total_loaded  = total_loaded;
+	stats.total_evicted = total_evicted;
+	stats.total_failed  = total_failed;
+
+	for (const auto& [name, entry] : entries) {
+		switch (entry.state) {
+			case State::queued:
+				++stats.queued_count;
+				break;
+
+			case State::loading:
+				++stats.in_flight_count;
+				break;
+
+			case State::resident:
+				++stats.resident_count;
+				stats.resident_bytes += entry.size;
+				if (isEvictable(entry)) {
+					++stats.evictable_count;
+					stats.evictable_bytes += entry.size;
+				}
+				break;
+
+			case State::failed:
+				break;
+		}
+	}
+
+	return stats;
+}
+
+
+void StreamingMgr::processCompletions() {
+	{
+		std::scoped_lock lock{completion_queue->mutex};
+		completion_queue->completions.swap(completion_scratch);
+	}
+
+	for (auto& [name, result] : completion_scratch) {
+		const auto it = entries.find(name);
+		if ((it == entries.end()) or (it->second.state != State::loading))
+			continue;
+
+		auto& entry = it->second;
+		--in_flight;
+		reserved_bytes -= entry.size;
+
+		if (not result.resource) {
+			Logger::log(LogLevel::err, "Failed to stream resource: {}", WstrToStr(name));
+			entry.state = State::failed;
+			entry.size  = 0;
+			++total_failed;
+			continue;
+		}
+
+		entry.state    = State::resident;
+		entry.size     = result.size;
+		entry.resource = std::move(result.resource);
+		resident_bytes += entry.size;
+		++total_loaded;
+	}
+
+	completion_scratch.clear();
+}
+
+
+bool StreamingMgr::evict(u64 target) {
+	// Gather the evictable resources, least recently requested first
+	eviction_scratch.clear();
+	for (const auto& [name, entry] : entries) {
+		if (isEvictable(entry))
+			eviction_scratch.emplace_back(entry.last_requested, &name);
+	}
+
+	std::ranges::sort(eviction_scratch, [](const auto& lhs, const auto& rhs) {
+		return (lhs.first != rhs.first) ? (lhs.first < rhs.first) : (*lhs.second < *rhs.second);
+	});
+
+	for (const auto& [last_requested, name] : eviction_scratch) {
+		if ((resident_bytes + reserved_bytes) <= target)
+			break;
+
+		const auto it = entries.find(*name);
+		resident_bytes -= it->second.size;
+		entries.erase(it);
+		++total_evicted;
+	}
+
+	eviction_scratch.clear();
+	return (resident_bytes + reserved_bytes) <= target;
+}
+
+
+void StreamingMgr::dispatch() {
+	if (in_flight >= config.max_in_flight)
+		return;
+
+	// Sort the requested loads by priority. Ties are broken by name so the order is deterministic.
+	queue_scratch.clear();
+	for (const auto& [name, entry] : entries) {
+		if ((entry.state == State::queued) and entry.requested)
+			queue_scratch.emplace_back(entry.priority, &name);
+	}
+
+	std::ranges::sort(queue_scratch, [](const auto& lhs, const auto& rhs) {
+		return (lhs.first != rhs.first) ? (lhs.first > rhs.first) : (*lhs.second < *rhs.second);
+	});
+
+	for (const auto& [priority, name] : queue_scratch) {
+		if (in_flight >= config.max_in_flight)
+			break;
+
+		const u64 size = source->estimateSize(*name);
+
+		// Make room for the resource. A resource larger than the budget is still loaded if
+		// nothing else is using memory, so it can't block the queue forever. Loads stop at the
+		// first resource that doesn't fit so lower priority loads can't take its place.
+		const u64 committed = resident_bytes + reserved_bytes;
+		if ((committed + size) > config.memory_budget) {
+			const u64  target = (size < config.memory_budget) ? (config.memory_budget - size) : 0;
+			const bool fits   = evict(target);
+			if (not fits and ((resident_bytes + reserved_bytes) != 0))
+				break;
+		}
+
+		auto& entry = entries.at(*name);
+		entry.state = State::loading;
+		entry.size  = size;
+		reserved_bytes += size;
+		++in_flight;
+
+		source->load(*name, [queue = completion_queue, name = *name](IStreamingSource::LoadResult result) {
+			std::scoped_lock lock{queue->mutex};
+			queue->completions.push_back(Completion{name, std::move(result)});
+		});
+	}
+
+	queue_scratch.clear();
+}
+
+
+void StreamingMgr::endRequests() {
+	std::erase_if(entries, [](const auto& pair) {
+		const auto& entry = pair.second;
+		return ((entry.state == State::queued) or (entry.state == State::failed)) and not entry.requested;
+	});
+
+	for (auto& [name, entry] : entries) {
+		entry.requested = false;
+	}
+}
+
+
+f32 XM_CALLCONV ComputeStreamingPriority(FXMMATRIX world_to_projection, const BoundingSphere& sphere) {
+	const f32 w = XMVectorGetW(XMVector3Transform(sphere.center(), world_to_projection));
+	const f32 r = sphere.radius();
+
+	// The camera is inside the sphere
+	if (w <= r)
+		return 1.0f;
+
+	// The projection's scale factor is the length of the y column of the world-to-projection matrix
+	const auto projection_to_world = XMMatrixTranspose(world_to_projection);
+	const f32  scale               = XMVectorGetX(XMVector3Length(projection_to_world.r[1]));
+
+	return std::clamp((r * scale) / w, 0.0f, 1.0f);
+}
+
+} //namespace render
@@ -0,0 +1,243 @@
+module;
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+
+export module rendering:streaming_mgr;
+
+import math.geometry;
+
+using namespace DirectX;
+
+
+//----------------------------------------------------------------------------------
+// Streaming
+//----------------------------------------------------------------------------------
+//
+// The StreamingMgr decides which resources should be resident. Resources are
+// requested with a priority every frame they're needed, and loaded through an
+// IStreamingSource in priority order with a bounded number of loads in flight.
+//
+// Loaded resources are kept until the memory budget is exceeded. Resources that
+// weren't requested during the last update and aren't referenced outside of the
+// manager are then evicted, least recently requested first.
+//
+// The StreamingMgr itself does no I/O or GPU work, and all of its decisions are
+// made in update(), so it can be driven by any source (e.g. a fake file source).
+//
+//----------------------------------------------------------------------------------
+export namespace render {
+
+class IStreamingSource {
+public:
+	struct LoadResult {
+		std::shared_ptr<void> resource; //nullptr if the load failed
+		u64 size = 0;                   //the memory used by the resource, in bytes
+	};
+
+	using Callback = std::function<void(LoadResult)>;
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	virtual ~IStreamingSource() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Start loading a resource. The callback can be invoked from any thread, and may be
+	// invoked before load() returns.
+	virtual void load(const std::wstring& name, Callback on_complete) = 0;
+
+	// Estimate the memory a resource will use once it's loaded
+	[[nodiscard]]
+	virtual u64 estimateSize(const std::wstring& name) const = 0;
+};
+
+
+class StreamingMgr final {
+public:
+	struct Config {
+		u64 memory_budget = 512ull * 1024 * 1024;
+		u32 max_in_flight = 4;
+	};
+
+	struct Stats {
+		u32 resident_count  = 0;
+		u64 resident_bytes  = 0;
+		u32 evictable_count = 0; //resident, but unrequested and unreferenced
+		u64 evictable_bytes = 0;
+		u32 queued_count    = 0;
+		u32 in_flight_count = 0;
+		u64 memory_budget   = 0;
+
+		u64 total_loaded  = 0;
+		u64 total_evicted = 0;
+		u64 total_failed  = 0;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	StreamingMgr(std::shared_ptr<IStreamingSource> source, const Config& config);
+
+	StreamingMgr(const StreamingMgr&) = delete;
+	StreamingMgr(StreamingMgr&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~StreamingMgr() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	StreamingMgr& operator=(const StreamingMgr&) = delete;
+	StreamingMgr& operator=(StreamingMgr&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Requests
+	//----------------------------------------------------------------------------------
+
+	// Request a resource for the next update. A request only lasts for one update, so it
+	// should be made every frame the resource is needed. Higher priorities load first. If
+	// a resource is requested more than once, the highest priority is used.
+	void request(const std::wstring& name, f32 priority);
+
+	// Cancel a resource's request. A queued load is dropped, and a resident resource
+	// becomes evictable if it isn't referenced.
+	void release(const std::wstring& name);
+
+	// Process completed loads, evict resources to fit the budget, and start new loads
+	void update();
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Resources
+	//----------------------------------------------------------------------------------
+
+	// Get a resident resource, or nullptr if it isn't resident. The type must match the
+	// type the source created.
+	template<typename ResourceT>
+	[[nodiscard]]
+	std::shared_ptr<ResourceT> get(const std::wstring& name) const {
+		const auto it = entries.find(name);
+		if ((it == entries.end()) or (it->second.state != State::resident))
+			return nullptr;
+		return std::static_pointer_cast<ResourceT>(it->second.resource);
+	}
+
+	[[nodiscard]]
+	bool isResident(const std::wstring& name) const;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Budget
+	//----------------------------------------------------------------------------------
+	void setMemoryBudget(u64 bytes) noexcept {
+		config.memory_budget = bytes;
+	}
+
+	[[nodiscard]]
+	u64 getMemoryBudget() const noexcept {
+		return config.memory_budget;
+	}
+
+	[[nodiscard]]
+	Stats getStats() const;
+
+private:
+
+	enum class State : u8 {
+		queued,
+		loading,
+		resident,
+		failed,
+	};
+
+	struct Entry {
+		State state = State::queued;
+		f32   priority = 0.0f;
+		bool  requested = false;  //requested for the next update
+		u64   size = 0;           //the estimated size while queued or loading
+		u64   last_requested = 0; //the update the resource was last requested for
+		std::shared_ptr<void> resource;
+	};
+
+	// Loads are completed through a queue shared with the load callbacks, so a callback
+	// that runs after the manager is destroyed is harmless
+	struct Completion {
+		std::wstring name;
+		IStreamingSource::LoadResult result;
+	};
+
+	struct CompletionQueue {
+		std::mutex mutex;
+		std::vector<Completion> completions;
+	};
+
+	[[nodiscard]]
+	static bool isEvictable(const Entry& entry) noexcept {
+		return (entry.state == State::resident) and not entry.requested and (entry.resource.use_count() == 1);
+	}
+
+	void processCompletions();
+
+	// Evict resources until the committed memory is at most the target. Returns false if
+	// not enough resources could be evicted.
+	bool evict(u64 target);
+
+	void dispatch();
+
+	// Forget queued and failed entries that weren't requested, and reset the requests
+	void endRequests();
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::shared_ptr<IStreamingSource> source;
+	Config config;
+
+	std::unordered_map<std::wstring, Entry> entries;
+
+	std::shared_ptr<CompletionQueue> completion_queue;
+	std::vector<Completion> completion_scratch;
+
+	// Queued entries sorted by priority (kept to avoid reallocating every update)
+	std::vector<std::pair<f32, const std::wstring*>> queue_scratch;
+	std::vector<std::pair<u64, const std::wstring*>> eviction_scratch;
+
+	// The memory used by resident resources, and reserved by loads in flight
+	u64 resident_bytes = 0;
+	u64 reserved_bytes = 0;
+	u32 in_flight = 0;
+
+	u64 total_loaded  = 0;
+	u64 total_evicted = 0;
+	u64 total_failed  = 0;
+
+	u64 frame = 0;
+};
+
+
+// Compute a streaming priority from the fraction of the screen's height covered by a
+// world space bounding sphere. Nearby and large objects have higher priorities.
+[[nodiscard]]
+f32 XM_CALLCONV ComputeStreamingPriority(FXMMATRIX world_to_projection, const BoundingSphere& sphere);
+
+} //namespace render
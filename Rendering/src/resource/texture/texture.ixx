@@ -1,10 +1,16 @@
 module;
 
+#include <algorithm>
+#include <optional>
 #include <string>
 
 #include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "memory/memory_tracker.h"
 #include "directx/d3d11.h"
 
+#include <DirectXTex.h>
+
 export module rendering:texture;
 
 import :resource;
@@ -24,6 +30,17 @@ public:
 		: Resource(filename) {
 
 		importer::ImportTexture(device, device_context, filename, texture_srv.GetAddressOf());
+		memory = TrackedMemory{MemoryTag::Textures, ComputeMemoryUsage(texture_srv.Get())};
+	}
+
+	// Create a texture from an image decoded with importer::DecodeTexture
+	Texture(ID3D11Device& device,
+	        const std::wstring& filename,
+	        const std::optional<DirectX::ScratchImage>& image)
+		: Resource(filename) {
+
+		importer::ImportTexture(device, image, fs::path{filename}, texture_srv.GetAddressOf());
+		memory = TrackedMemory{MemoryTag::Textures, ComputeMemoryUsage(texture_srv.Get())};
 	}
 
 	Texture(const std::wstring& guid,
@@ -44,6 +61,15 @@ public:
 											 nullptr,
 											 texture_srv.ReleaseAndGetAddressOf());
 		ThrowIfFailed(hr, "Failed to create Texture SRV");
+
+		memory = TrackedMemory{MemoryTag::Textures, ComputeMemoryUsage(texture_srv.Get())};
+	}
+
+	// Create a texture that uses a placeholder until its data is provided with finishLoad()
+	Texture(const std::wstring& filename, ComPtr<ID3D11ShaderResourceView> placeholder)
+		: Resource(filename)
+		, texture_srv(std::move(placeholder))
+		, loaded(false) {
 	}
 
 	Texture(const Texture& texture) = delete;
@@ -71,6 +97,37 @@ public:
 		return texture_srv.Get();
 	}
 
+	// Replace the placeholder of a texture with the decoded image
+	void finishLoad(ID3D11Device& device, const std::optional<DirectX::ScratchImage>& image) {
+		ComPtr<ID3D11ShaderResourceView> srv;
+		importer::ImportTexture(device, image, fs::path{guid}, srv.GetAddressOf());
+
+		texture_srv = std::move(srv);
+		memory      = TrackedMemory{MemoryTag::Textures, ComputeMemoryUsage(texture_srv.Get())};
+		loaded = true;
+	}
+
+	// Replace the placeholder of a texture with another texture loaded from an identical file.
+	// The textures share the GPU resource, and its memory is counted by the source texture.
+	void finishLoad(const Texture& source) {
+		texture_srv = source.texture_srv;
+		memory.reset();
+		loaded = true;
+	}
+
+	// Returns false while the texture is using a placeholder
+	[[nodiscard]]
+	bool isLoaded() const noexcept {
+		return loaded;
+	}
+
+	// The GPU memory used by the texture, in bytes. A texture that uses a placeholder doesn't
+	// own any memory.
+	[[nodiscard]]
+	u64 getMemoryUsage() const noexcept {
+		return memory.size();
+	}
+
 	// Bind the texture to the specified pipeline stage
 	template<typename StageT>
 	void bind(ID3D11DeviceContext& device_context, u32 slot) const {
@@ -79,10 +136,47 @@ public:
 
 private:
 
+	[[nodiscard]]
+	static u64 ComputeMemoryUsage(ID3D11ShaderResourceView* srv) {
+		if (not srv)
+			return 0;
+
+		ComPtr<ID3D11Resource> resource;
+		srv->GetResource(resource.GetAddressOf());
+
+		ComPtr<ID3D11Texture2D> texture;
+		if (FAILED(resource.As(&texture)))
+			return 0;
+
+		D3D11_TEXTURE2D_DESC desc = {};
+		texture->GetDesc(&desc);
+
+		u64 size = 0;
+		for (u32 mip = 0; mip < desc.MipLevels; ++mip) {
+			size_t row_pitch   = 0;
+			size_t slice_pitch = 0;
+
+			const auto width  = std::max(desc.Width >> mip, 1u);
+			const auto height = std::max(desc.Height >> mip, 1u);
+			if (FAILED(DirectX::ComputePitch(desc.Format, width, height, row_pitch, slice_pitch)))
+				return 0;
+
+			size += slice_pitch;
+		}
+
+		return size * desc.ArraySize;
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
 	ComPtr<ID3D11ShaderResourceView> texture_srv;
+
+	// The GPU memory owned by the texture, counted under MemoryTag::Textures
+	TrackedMemory memory;
+
+	bool loaded = true;
 };
 
 } //namespace render
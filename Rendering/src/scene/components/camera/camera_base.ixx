@@ -278,6 +278,12 @@ public:
 		buffer.bind<Pipeline>(device_context, slot);
 	}
 
+	// The camera's constant buffer, for render proxies that outlive the component
+	[[nodiscard]]
+	ID3D11Buffer* getBuffer() const noexcept {
+		return buffer.get();
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - Viewport
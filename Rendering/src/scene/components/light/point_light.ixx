@@ -39,14 +39,10 @@ public:
 	// Member Functions - Base Color
 	//----------------------------------------------------------------------------------
 	void setBaseColor(f32_3 color) noexcept {
+		++revision;
 		base_color = std::move(color);
 	}
 
-	[[nodiscard]]
-	f32_3& getBaseColor() noexcept {
-		return base_color;
-	}
-
 	[[nodiscard]]
 	const f32_3& getBaseColor() const noexcept {
 		return base_color;
@@ -57,6 +53,7 @@ public:
 	// Member Functions - Intensity
 	//----------------------------------------------------------------------------------
 	void setIntensity(f32 value) noexcept {
+		++revision;
 		intensity = value;
 	}
 
@@ -69,6 +66,7 @@ public:
 	// Member Functions - Range
 	//----------------------------------------------------------------------------------
 	void setRange(f32 range) noexcept {
+		++revision;
 		this->range = std::max(0.01f, range);
 		updateBoundingVolumes();
 	}
@@ -83,14 +81,10 @@ public:
 	// Member Functions - Attenuation
 	//----------------------------------------------------------------------------------
 	void setAttenuation(f32_3 atten) noexcept {
+		++revision;
 		attenuation = std::move(atten);
 	}
 
-	[[nodiscard]]
-	f32_3& getAttenuation() noexcept {
-		return attenuation;
-	}
-
 	[[nodiscard]]
 	const f32_3& getAttenuation() const noexcept {
 		return attenuation;
@@ -101,6 +95,7 @@ public:
 	// Member Functions - Shadows
 	//----------------------------------------------------------------------------------
 	void setShadows(bool state) noexcept {
+		++revision;
 		this->shadows = state;
 	}
 
@@ -110,6 +105,13 @@ public:
 	}
 
 
+	// Incremented whenever one of the light's parameters changes
+	[[nodiscard]]
+	u32 getRevision() const noexcept {
+		return revision;
+	}
+
+
 	// Get the AABB of this light
 	[[nodiscard]]
 	const AABB& getAABB() const noexcept {
@@ -162,4 +164,7 @@ private:
 	// Bounding volumes
 	AABB aabb;
 	BoundingSphere sphere;
+
+	// Changes whenever a parameter changes
+	u32 revision = 0;
 };
\ No newline at end of file
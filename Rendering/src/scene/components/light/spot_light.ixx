@@ -41,14 +41,10 @@ public:
 	// Member Functions - Base Color
 	//----------------------------------------------------------------------------------
 	void setBaseColor(f32_3 color) noexcept {
+		++revision;
 		base_color = std::move(color);
 	}
 
-	[[nodiscard]]
-	f32_3& getBaseColor() noexcept {
-		return base_color;
-	}
-
 	[[nodiscard]]
 	const f32_3& getBaseColor() const noexcept {
 		return base_color;
@@ -59,6 +55,7 @@ public:
 	// Member Functions - Intensity
 	//----------------------------------------------------------------------------------
 	void setIntensity(f32 value) noexcept {
+		++revision;
 		intensity = value;
 	}
 
@@ -71,14 +68,10 @@ public:
 	// Member Functions - Attenuation
 	//----------------------------------------------------------------------------------
 	void setAttenuation(f32_3 atten) noexcept {
+		++revision;
 		attenuation = std::move(atten);
 	}
 
-	[[nodiscard]]
-	f32_3& getAttenuation() noexcept {
-		return attenuation;
-	}
-
 	[[nodiscard]]
 	const f32_3& getAttenuation() const noexcept {
 		return attenuation;
@@ -89,6 +82,7 @@ public:
 	// Member Functions - Umbra
 	//----------------------------------------------------------------------------------
 	void setUmbraCosAngle(f32 cos_angle) noexcept {
+		++revision;
 		cos_umbra = std::max(std::max(cos_angle, cos_penumbra + 0.001f), 0.001f);
 	}
 
@@ -111,6 +105,7 @@ public:
 	// Member Functions - Penumbra
 	//----------------------------------------------------------------------------------
 	void setPenumbraCosAngle(f32 cos_angle) noexcept {
+		++revision;
 		cos_penumbra = std::max(std::min(cos_angle, cos_umbra - 0.001f), 0.001f);
 		updateBoundingVolumes();
 	}
@@ -143,6 +138,7 @@ public:
 	// Member Functions - Range
 	//----------------------------------------------------------------------------------
 	void setRange(f32 range) noexcept {
+		++revision;
 		this->range = std::max(0.01f, range);
 		updateBoundingVolumes();
 	}
@@ -157,6 +153,7 @@ public:
 	// Member Functions - Shadows
 	//----------------------------------------------------------------------------------
 	void setShadows(bool state) noexcept {
+		++revision;
 		shadows = state;
 	}
 
@@ -166,6 +163,13 @@ public:
 	}
 
 
+	// Incremented whenever one of the light's parameters changes
+	[[nodiscard]]
+	u32 getRevision() const noexcept {
+		return revision;
+	}
+
+
 	// Get the AABB of this light
 	[[nodiscard]]
 	const AABB& getAABB() const noexcept {
@@ -217,4 +221,7 @@ private:
 	// Bounding volumes
 	AABB aabb;
 	BoundingSphere sphere;
+
+	// Changes whenever a parameter changes
+	u32 revision = 0;
 };
\ No newline at end of file
@@ -1,13 +1,17 @@
 module;
 
 #include <functional>
+#include <algorithm>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <DirectXMath.h>
 
 #include "datatypes/types.h"
 #include "io/io.h"
+#include "memory/handle/handle.h"
 
 #include "directx/d3d11.h"
 
@@ -19,7 +23,9 @@ import math.geometry;
 import :buffer_types;
 import :constant_buffer;
 import :mesh;
+import :mesh_lod;
 import :material;
+import :material_registry;
 import :model_blueprint;
 
 using namespace DirectX;
@@ -29,7 +35,8 @@ using namespace DirectX;
 //----------------------------------------------------------------------------------
 //
 // A model is a collection of a mesh, material, bounding volumes, and a shader
-// constant buffer. It is created from a ModelBlueprint.
+// constant buffer. It is created from a ModelBlueprint, and refers to the blueprint's
+// data through a MeshHandle, so it picks up changes when the blueprint is reloaded.
 //
 //----------------------------------------------------------------------------------
 export class Model final : public ecs::Component {
@@ -40,30 +47,10 @@ public:
 	Model(ID3D11Device& device,
 	      const std::shared_ptr<render::ModelBlueprint>& bp,
 	      u32 bp_index)
-		: Model(device,
-		        bp->meshes.at(bp_index).getName(),
-		        bp->meshes.at(bp_index),
-		        bp->materials.at(bp->mat_indices.at(bp_index)),
-		        bp->aabbs.at(bp_index),
-		        bp->bounding_spheres.at(bp_index),
-		        bp) {
-	}
-
-	Model(ID3D11Device& device,
-	      const std::string& name,
-	      const render::Mesh& mesh,
-	      render::Material& mat,
-	      const AABB& aabb,
-	      const BoundingSphere& sphere,
-	      const std::shared_ptr<render::ModelBlueprint>& bp)
-		: buffer(device)
-		, name(name)
-		, mesh(mesh)
-		, material(mat)
-		, aabb(aabb)
-		, bounding_sphere(sphere)
-		, shadows(true)
-		, blueprint(bp) {
+		: name(bp->meshes.at(bp_index).getName())
+		, buffer(device)
+		, handle(bp, bp_index)
+		, shadows(true) {
 	}
 
 
@@ -89,7 +76,7 @@ public:
 	//----------------------------------------------------------------------------------
 
 	void bindMesh(ID3D11DeviceContext& device_context) const {
-		mesh.get().bind(device_context);
+		handle.getMesh().bind(device_context);
 	}
 
 	template<typename StageT>
@@ -97,9 +84,19 @@ public:
 		buffer.bind<StageT>(device_context, slot);
 	}
 
+	// The shader constant buffer, for render proxies that outlive the component
+	[[nodiscard]]
+	ID3D11Buffer* getBuffer() const noexcept {
+		return buffer.get();
+	}
+
 	void XM_CALLCONV updateBuffer(ID3D11DeviceContext& device_context, FXMMATRIX object_to_world){
-		// The model-to-world matrix. Transposed for HLSL.
-		const auto world_t = XMMatrixTranspose(object_to_world);
+		// The model-to-world matrix. Transposed for HLSL. Quantized vertex positions are mapped
+		// back to object space first. Normals aren't quantized, so the inverse transpose below
+		// uses the unmodified matrix.
+		const auto& mesh    = handle.getMesh();
+		const auto  world_t = mesh.isQuantized() ? XMMatrixTranspose(mesh.getQuantization().getTransform() * object_to_world)
+		                                         : XMMatrixTranspose(object_to_world);
 
 		// Create the inverse transpose of the model-to-world matrix
 		const auto world_inv_t = XMMatrixInverse(nullptr, object_to_world);
@@ -110,10 +107,11 @@ public:
 		buffer_data.world_inv_transpose = world_inv_t;
 		buffer_data.tex_transform       = XMMatrixIdentity();
 
-		buffer_data.mat.base_color = material.get().params.base_color;
-		buffer_data.mat.metalness  = material.get().params.metalness;
-		buffer_data.mat.roughness  = material.get().params.roughness;
-		buffer_data.mat.emissive   = material.get().params.emissive;
+		const auto& material = handle.getMaterial();
+		buffer_data.mat.base_color = material.params.base_color;
+		buffer_data.mat.metalness  = material.params.metalness;
+		buffer_data.mat.roughness  = material.params.roughness;
+		buffer_data.mat.emissive   = material.params.emissive;
 
 		buffer.updateData(device_context, buffer_data);
 	}
@@ -135,12 +133,67 @@ public:
 
 	[[nodiscard]]
 	u32 getVertexCount() const noexcept {
-		return mesh.get().getVertexCount();
+		return handle.getMesh().getVertexCount();
 	}
 
+	// True if the model's vertices use a quantized vertex type
+	[[nodiscard]]
+	bool hasQuantizedVertices() const noexcept {
+		return handle.getMesh().isQuantized();
+	}
+
+	// The index count of the full detail mesh
 	[[nodiscard]]
 	u32 getIndexCount() const noexcept {
-		return mesh.get().getIndexCount();
+		return handle.getMesh().getLOD(0).index_count;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Level of Detail
+	//----------------------------------------------------------------------------------
+
+	[[nodiscard]]
+	u32 getLODCount() const noexcept {
+		return handle.getMesh().getLODCount();
+	}
+
+	[[nodiscard]]
+	std::span<const render::MeshLOD> getLODs() const noexcept {
+		return handle.getMesh().getLODs();
+	}
+
+	// The index range of a level of detail
+	[[nodiscard]]
+	const render::MeshLOD& getLODRange(u32 lod) const noexcept {
+		return handle.getMesh().getLOD(lod);
+	}
+
+	// The level of detail a camera last rendered the model with. Clamped, since a reloaded
+	// mesh may have fewer levels of detail. A camera that hasn't rendered the model yet gets
+	// the most detailed level.
+	[[nodiscard]]
+	u32 getLOD(handle64 camera) const noexcept {
+		const auto it = std::ranges::find(camera_lods, camera, &CameraLOD::camera);
+		return (it == camera_lods.end()) ? 0 : std::min(it->lod, getLODCount() - 1);
+	}
+
+	// Set the level of detail a camera renders the model with
+	void setLOD(handle64 camera, u32 level) {
+		level = std::min(level, getLODCount() - 1);
+
+		const auto it = std::ranges::find(camera_lods, camera, &CameraLOD::camera);
+		if (it == camera_lods.end())
+			camera_lods.push_back(CameraLOD{camera, level});
+		else
+			it->lod = level;
+	}
+
+	// Forget the levels of detail of the cameras that aren't in the list
+	void retainLODs(std::span<const handle64> cameras) {
+		std::erase_if(camera_lods, [cameras](const CameraLOD& entry) {
+			return std::ranges::find(cameras, entry.camera) == cameras.end();
+		});
 	}
 
 
@@ -150,12 +203,19 @@ public:
 
 	[[nodiscard]]
 	render::Material& getMaterial() noexcept {
-		return material;
+		return handle.getMaterial();
 	}
 
 	[[nodiscard]]
 	const render::Material& getMaterial() const noexcept {
-		return material;
+		return handle.getMaterial();
+	}
+
+	// The ID of the material in the material registry. Models with the same ID share the
+	// material.
+	[[nodiscard]]
+	render::MaterialID getMaterialID() const noexcept {
+		return handle.getMaterialID();
 	}
 
 
@@ -165,12 +225,12 @@ public:
 
 	[[nodiscard]]
 	const AABB& getAABB() const noexcept {
-		return aabb;
+		return handle.getAABB();
 	}
 
 	[[nodiscard]]
 	const BoundingSphere& getBoundingSphere() const noexcept {
-		return bounding_sphere;
+		return handle.getBoundingSphere();
 	}
 
 
@@ -187,10 +247,33 @@ public:
 		return shadows;
 	}
 
+	// A static shadow caster is expected to rarely move. Static casters are rendered
+	// into a cached shadow map, which dynamic casters are composited on top of.
+	void setStaticShadows(bool state) noexcept {
+		static_shadows = state;
+	}
+
+	[[nodiscard]]
+	bool hasStaticShadows() const noexcept {
+		return static_shadows;
+	}
+
+
+	// The blueprint mesh and material that the model refers to
+	[[nodiscard]]
+	const render::MeshHandle& getMeshHandle() const noexcept {
+		return handle;
+	}
 
 	[[nodiscard]]
 	const render::ModelBlueprint& getBlueprint() const noexcept {
-		return *blueprint;
+		return handle.getBlueprint();
+	}
+
+	// Changes when the model's blueprint is reloaded
+	[[nodiscard]]
+	u32 getRevision() const noexcept {
+		return handle.getRevision();
 	}
 
 
@@ -205,19 +288,20 @@ private:
 	// The shader constant buffer
 	render::ConstantBuffer<render::ModelBuffer> buffer;
 
-	// The mesh that the model refers to
-	std::reference_wrapper<const render::Mesh> mesh;
-
-	// The material that the model refers to
-	std::reference_wrapper<render::Material> material;
-
-	// The bounding volumes of the model
-	AABB aabb;
-	BoundingSphere bounding_sphere;
+	// The blueprint mesh and material that the model refers to
+	render::MeshHandle handle;
 
 	// A flag that determines if the model casts shadows
 	bool shadows;
 
-	// The blueprint whose data this model references
-	std::shared_ptr<render::ModelBlueprint> blueprint;
+	// A flag that determines if the model's shadows are static
+	bool static_shadows = false;
+
+	// The level of detail selected for each camera that renders the model. Each camera keeps
+	// its own selection, so the hysteresis of one camera isn't disturbed by another.
+	struct CameraLOD {
+		handle64 camera;
+		u32      lod = 0;
+	};
+	std::vector<CameraLOD> camera_lods;
 };
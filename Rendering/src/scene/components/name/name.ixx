@@ -2,6 +2,8 @@ module;
 
 #include <string>
 
+#include "memory/handle/handle.h"
+
 export module rendering:components.name;
 
 import ecs;
@@ -9,6 +11,17 @@ import ecs;
 
 export class Name : public ecs::Component {
 public:
+	//----------------------------------------------------------------------------------
+	// NameChanged event
+	//----------------------------------------------------------------------------------
+	// Sent when the name is changed after the component was added. Code that writes to
+	// the name directly should enqueue the event itself.
+	struct NameChangedEvent {
+		NameChangedEvent(handle64 entity) : entity(entity) {}
+		handle64 entity;
+	};
+
+
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
@@ -30,6 +43,16 @@ public:
 	Name& operator=(const Name&) = delete;
 	Name& operator=(Name&&) noexcept = default;
 
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	void setName(ecs::ECS& ecs, std::string new_name) {
+		if (name != new_name) {
+			name = std::move(new_name);
+			ecs.enqueue<NameChangedEvent>(getOwner());
+		}
+	}
+
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
@@ -1,20 +1,35 @@
 module;
 
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include <DirectXMath.h>
 
+#include "datatypes/scalar_types.h"
 #include "directx/directxtk.h"
 
 export module rendering:components.text;
 
 import ecs;
+import :components.transform;
 import :font;
 
 using namespace DirectX;
 
 export class Text final : public ecs::Component {
 public:
+	//----------------------------------------------------------------------------------
+	// Placement
+	//----------------------------------------------------------------------------------
+	// Where the text is drawn on screen
+	struct Placement {
+		XMFLOAT2 position = {0.0f, 0.0f};
+		XMFLOAT2 scale    = {1.0f, 1.0f};
+		f32      rotation = 0.0f;
+	};
+
+
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
@@ -23,6 +38,7 @@ public:
 		: font(std::move(font))
 		, text(L"Default Text")
 		, color(Colors::White) {
+		updateLayout();
 	}
 
 	Text(const Text& text) = delete;
@@ -53,6 +69,11 @@ public:
 		return font->getSpriteFont();
 	}
 
+	[[nodiscard]]
+	const std::shared_ptr<render::Font>& getFontResource() const noexcept {
+		return font;
+	}
+
 
 	//----------------------------------------------------------------------------------
 	// Member Functions - Text
@@ -64,15 +85,57 @@ public:
 	}
 
 	void setText(const std::wstring& new_text) {
-		text = new_text;
+		if (text != new_text) {
+			text = new_text;
+			updateLayout();
+		}
 	}
 
 	void setText(const std::wstring& new_text, XMVECTORF32 new_color) {
-		text  = new_text;
+		setText(new_text);
 		color = new_color;
 	}
 
 
+	//----------------------------------------------------------------------------------
+	// Member Functions - Layout
+	//----------------------------------------------------------------------------------
+
+	// The glyphs of the text, laid out in its font. Rebuilt when the text changes. A new
+	// layout is created rather than modifying the current one, so a renderer can hold it.
+	[[nodiscard]]
+	const std::shared_ptr<const render::TextLayout>& getLayout() const noexcept {
+		return layout;
+	}
+
+	// The placement of the text, from the render state of its transform. Only recalculated
+	// when the transform's render state changes.
+	[[nodiscard]]
+	const Placement& getPlacement(const Transform& transform) {
+		if (placement_revision != transform.getRenderRevision()) {
+			placement_revision = transform.getRenderRevision();
+
+			const XMMATRIX object_to_world = transform.getRenderObjectToWorldMatrix();
+
+			XMVECTOR scale, rotation, translation;
+			if (not XMMatrixDecompose(&scale, &rotation, &translation, object_to_world)) {
+				// Matrices with shear can't be decomposed. Only the translation is used.
+				scale       = XMVectorSplatOne();
+				rotation    = XMQuaternionIdentity();
+				translation = object_to_world.r[3];
+			}
+
+			XMStoreFloat2(&placement.position, translation);
+			XMStoreFloat2(&placement.scale, scale);
+
+			// Text is drawn in the screen plane, so only the rotation about the z-axis is used
+			placement.rotation = 2.0f * std::atan2(XMVectorGetZ(rotation), XMVectorGetW(rotation));
+		}
+
+		return placement;
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Functions - Color
 	//----------------------------------------------------------------------------------
@@ -89,6 +152,12 @@ public:
 
 
 private:
+
+	void updateLayout() {
+		layout = std::make_shared<const render::TextLayout>(font->layoutText(text));
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
@@ -97,4 +166,10 @@ private:
 
 	std::wstring text;
 	XMVECTORF32  color;
+
+	std::shared_ptr<const render::TextLayout> layout;
+
+	// The transform's render revision the placement was calculated at
+	Placement placement;
+	u32       placement_revision = std::numeric_limits<u32>::max();
 };
\ No newline at end of file
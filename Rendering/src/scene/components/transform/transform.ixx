@@ -2,6 +2,8 @@ module;
 
 #include <DirectXMath.h>
 
+#include "datatypes/scalar_types.h"
+
 export module rendering:components.transform;
 
 import ecs;
@@ -18,7 +20,11 @@ public:
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
-	Transform() = default;
+	Transform() {
+		prev_world   = XMMatrixIdentity();
+		render_world = XMMatrixIdentity();
+	}
+
 	Transform(const Transform& transform) = delete;
 	Transform(Transform&& transform) noexcept = default;
 
@@ -35,6 +41,50 @@ public:
 	Transform& operator=(const Transform& transform) = delete;
 	Transform& operator=(Transform&& transform) noexcept = default;
 
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Get the number of times the world matrix has been recalculated. Can be cached and
+	// compared against to determine if the transform has changed since it was last seen.
+	[[nodiscard]]
+	u32 getWorldRevision() const noexcept {
+		return world_revision;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Render State
+	//----------------------------------------------------------------------------------
+	//
+	// The simulation runs in fixed steps, and frames are rendered between them. The
+	// render state is the world matrix blended between the last two steps, and is what
+	// the renderer should draw. The world matrix is the state of the latest step.
+	//
+	//----------------------------------------------------------------------------------
+
+	[[nodiscard]]
+	XMMATRIX XM_CALLCONV getRenderObjectToWorldMatrix() const {
+		return interpolated ? render_world : getObjectToWorldMatrix();
+	}
+
+	[[nodiscard]]
+	XMMATRIX XM_CALLCONV getRenderWorldToObjectMatrix() const {
+		return interpolated ? XMMatrixInverse(nullptr, render_world) : getWorldToObjectMatrix();
+	}
+
+	// Like the world revision, but counts changes to the render state
+	[[nodiscard]]
+	u32 getRenderRevision() const noexcept {
+		return render_revision;
+	}
+
+	// Don't interpolate to the next change of the world matrix (e.g. after a teleport)
+	void resetInterpolation() noexcept {
+		snap = true;
+	}
+
 protected:
 	using Transform3D::clearNeedsUpdate;
 
@@ -46,13 +96,110 @@ private:
 		return;
 	}
 
-	// Called by TransformSystem
-	void update(const XMMATRIX* parent = nullptr) const {
+	// Called by TransformSystem. A change made between steps (e.g. by per-frame input) is
+	// also applied to the previous world matrix, so the blend shows it in full immediately.
+	void update(const XMMATRIX* parent = nullptr, bool between_steps = false) const {
 		if (needs_update) {
+			const XMMATRIX old_world   = world;
+			const bool     was_current = (prev_revision == world_revision);
+
 			Transform3D::updateMatrix();
 			if (parent)
 				world *= *parent;
 			needs_update = false;
+			++world_revision;
+
+			if (snap or (between_steps and was_current)) {
+				prev_world    = world;
+				prev_revision = world_revision;
+				snap          = false;
+			}
+			else if (between_steps) {
+				carryPrevious(old_world);
+			}
 		}
 	}
+
+	// Move the previous world matrix by the change from the old world matrix to the current one
+	void XM_CALLCONV carryPrevious(FXMMATRIX old_world) const {
+		XMVECTOR prev_scale, prev_rotation, prev_translation;
+		XMVECTOR old_scale, old_rotation, old_translation;
+		XMVECTOR scale, rotation, translation;
+
+		// Matrices with shear can't be decomposed. Snap to the current world matrix instead.
+		if (not XMMatrixDecompose(&prev_scale, &prev_rotation, &prev_translation, prev_world)
+		    or not XMMatrixDecompose(&old_scale, &old_rotation, &old_translation, old_world)
+		    or not XMMatrixDecompose(&scale, &rotation, &translation, world)
+		    or XMComparisonAnyTrue(XMVector3EqualR(old_scale, XMVectorZero()))) {
+			prev_world    = world;
+			prev_revision = world_revision;
+			return;
+		}
+
+		const XMVECTOR delta_rotation = XMQuaternionMultiply(XMQuaternionInverse(old_rotation), rotation);
+
+		prev_world = XMMatrixAffineTransformation(prev_scale * (scale / old_scale),
+		                                          XMVectorZero(),
+		                                          XMQuaternionNormalize(XMQuaternionMultiply(prev_rotation, delta_rotation)),
+		                                          prev_translation + (translation - old_translation));
+	}
+
+	// Called by TransformSystem before each step. Saves the world matrix the step starts from.
+	void storePrevious() const noexcept {
+		if (prev_revision != world_revision) {
+			prev_world    = world;
+			prev_revision = world_revision;
+		}
+	}
+
+	// Called by TransformSystem once per frame. Blends the world matrix of the last two steps.
+	void interpolate(f32 alpha) const {
+		const bool was_interpolated = interpolated;
+		interpolated = false;
+
+		if (prev_revision != world_revision) {
+			XMVECTOR prev_scale, prev_rotation, prev_translation;
+			XMVECTOR scale, rotation, translation;
+
+			// Matrices with shear can't be decomposed. They aren't interpolated.
+			if (XMMatrixDecompose(&prev_scale, &prev_rotation, &prev_translation, prev_world)
+			    and XMMatrixDecompose(&scale, &rotation, &translation, world)) {
+
+				render_world = XMMatrixAffineTransformation(XMVectorLerp(prev_scale, scale, alpha),
+				                                            XMVectorZero(),
+				                                            XMQuaternionSlerp(prev_rotation, rotation, alpha),
+				                                            XMVectorLerp(prev_translation, translation, alpha));
+				interpolated = true;
+			}
+		}
+
+		if (interpolated or was_interpolated or (render_source != world_revision))
+			++render_revision;
+		render_source = world_revision;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	// Incremented each time the world matrix is updated
+	mutable u32 world_revision = 0;
+
+	// The world matrix at the start of the last step, and the world revision it was saved at
+	mutable XMMATRIX prev_world;
+	mutable u32      prev_revision = 0;
+
+	// The blended world matrix. Only valid if interpolated is true, otherwise the world
+	// matrix is rendered as is.
+	mutable XMMATRIX render_world;
+	mutable bool     interpolated = false;
+
+	// Incremented each time the render state changes, and the world revision it last reflected
+	mutable u32 render_revision = 0;
+	mutable u32 render_source   = 0;
+
+	// Set if the next world matrix shouldn't be blended from the previous one. New transforms
+	// start at their first world matrix.
+	mutable bool snap = true;
 };
@@ -1,10 +1,13 @@
 module;
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
+#include "profiler/profiler.h"
 
 #include "directx/d3d11.h"
 
@@ -27,9 +30,19 @@ void Scene::load(Engine& engine) {
 	initialize(engine);
 }
 
-void Scene::tick(Engine& engine) {
-	ecs.update(engine.getTimer().deltaTime());
-	this->update(engine);
+void Scene::tick(Engine& engine, std::chrono::duration<f64> dt) {
+	PROFILE_ZONE("Scene Tick");
+
+	ecs.update(dt);
+	{
+		PROFILE_ZONE("Scene Update");
+		this->update(engine);
+	}
+}
+
+void Scene::frameUpdate(f32 alpha) {
+	PROFILE_ZONE("Scene Frame Update");
+	ecs.frameUpdate(alpha);
 }
 
 handle64 Scene::importModel(ID3D11Device& device, const std::shared_ptr<ModelBlueprint>& blueprint) {
@@ -76,7 +89,7 @@ void Scene::addCoreSystems(const Engine& engine) {
 	ecs.add<systems::CameraSystem>(engine.getRenderingMgr());
 
 	// Model system: updates the buffers of model components
-	ecs.add<systems::ModelSystem>(engine.getRenderingMgr());
+	ecs.add<systems::ModelSystem>(engine.getRenderingMgr().getDeviceContext());
 }
 
 } //namespace render
@@ -1,9 +1,11 @@
 module;
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
 
 #include "directx/d3d11.h"
@@ -45,8 +47,12 @@ public:
 	// Load the scene contents
 	void load(Engine& engine);
 
-	// Update the scene
-	void tick(Engine& engine);
+	// Advance the scene by one fixed step
+	void tick(Engine& engine, std::chrono::duration<f64> dt);
+
+	// Prepare the scene to be rendered. Called once per frame, after the frame's steps. alpha
+	// is how far the frame is between the last two steps.
+	void frameUpdate(f32 alpha);
 
 
 	//----------------------------------------------------------------------------------
@@ -125,7 +131,9 @@ protected:
 	// Overridden by the derived class and called by Scene::load()
 	virtual void initialize(Engine& engine) = 0;
 
-	// Update the scene per tick. Overridden by the derived class and called by Scene::tick()
+	// Update the scene per step. Overridden by the derived class and called by Scene::tick().
+	// Runs on the simulation thread while the previous frame is rendered, so it must not use
+	// the device context or the UI. Render resources can be created through the ResourceMgr.
 	virtual void update(Engine& engine) = 0;
 
 
@@ -1,5 +1,6 @@
 module;
 
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
 
 export module rendering:systems.camera_system;
@@ -11,6 +12,7 @@ import :components.camera.perspective_camera;
 import :components.camera.orthographic_camera;
 import :components.transform;
 import :rendering_mgr;
+import :systems.transform_system;
 
 namespace render::systems {
 
@@ -23,6 +25,7 @@ public:
 		: System(ecs)
 		, rendering_mgr(rendering_mgr)
 		, window_resize_connection(ecs.getDispatcher<events::WindowResizeEvent>().addCallback<&CameraSystem::onWindowResize>(this)) {
+		setPriority(TransformSystem::system_priority - 10);
 	}
 
 	CameraSystem(const CameraSystem&) = delete;
@@ -45,7 +48,8 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void update() override {
+	// Upload the render state of each camera's transform. Runs after the TransformSystem.
+	void frameUpdate(f32 alpha) override {
 		auto& ecs            = this->getECS();
 		auto& device_context = rendering_mgr.get().getDeviceContext();
 
@@ -55,8 +59,8 @@ public:
 
 			if (camera.isActive()) {
 				camera.updateBuffer(device_context,
-									transform.getObjectToWorldMatrix(),
-									transform.getWorldToObjectMatrix());
+									transform.getRenderObjectToWorldMatrix(),
+									transform.getRenderWorldToObjectMatrix());
 			}
 		});
 
@@ -66,8 +70,8 @@ public:
 
 			if (camera.isActive()) {
 				camera.updateBuffer(device_context,
-									transform.getObjectToWorldMatrix(),
-									transform.getWorldToObjectMatrix());
+									transform.getRenderObjectToWorldMatrix(),
+									transform.getRenderWorldToObjectMatrix());
 			}
 		});
 	}
@@ -2,14 +2,17 @@ module;
 
 #include <functional>
 
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
 
+#include "directx/d3d11.h"
+
 export module rendering:systems.model_system;
 
 import ecs;
 import :components.transform;
 import :components.model;
-import :rendering_mgr;
+import :systems.transform_system;
 
 
 namespace render::systems {
@@ -19,9 +22,10 @@ public:
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
-	ModelSystem(ecs::ECS& ecs, const RenderingMgr& rendering_mgr)
+	ModelSystem(ecs::ECS& ecs, ID3D11DeviceContext& device_context)
 		: System(ecs)
-		, rendering_mgr(rendering_mgr) {
+		, device_context(device_context) {
+		setPriority(TransformSystem::system_priority - 10);
 	}
 
 	ModelSystem(const ModelSystem&) = delete;
@@ -44,9 +48,9 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void update() override {
-		auto& ecs            = this->getECS();
-		auto& device_context = rendering_mgr.get().getDeviceContext();
+	// Upload the render state of each model's transform. Runs after the TransformSystem.
+	void frameUpdate(f32 alpha) override {
+		auto& ecs = this->getECS();
 
 		ecs.forEach<Transform, Model>([&](handle64 entity) {
 			const auto& transform = ecs.get<Transform>(entity);
@@ -54,7 +58,7 @@ public:
 
 			// Update the model's buffer
 			if (model.isActive()) {
-				model.updateBuffer(device_context, transform.getObjectToWorldMatrix());
+				model.updateBuffer(device_context.get(), transform.getRenderObjectToWorldMatrix());
 			}
 		});
 	}
@@ -64,7 +68,7 @@ private:
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
-	std::reference_wrapper<const RenderingMgr> rendering_mgr;
+	std::reference_wrapper<ID3D11DeviceContext> device_context;
 };
 
 } //namespace render::systems
@@ -59,7 +59,8 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void update() override {
+	// Runs once per frame, so each click is only seen once
+	void frameUpdate(f32 alpha) override {
 		const auto& input = engine.get().getInput();
 		const i32_2 mouse = input.getMousePosition();
 
@@ -1,5 +1,6 @@
 module;
 
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
 
 export module rendering:systems.transform_system;
@@ -14,12 +15,17 @@ namespace render::systems {
 
 export class TransformSystem final : public ecs::System {
 public:
+	// Runs after the default priority systems, so the transforms they modify are resolved
+	// in the same update, and before the systems that read the render state.
+	static constexpr u32 system_priority = default_priority - 10;
+
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
 	TransformSystem(ecs::ECS& ecs)
 		: System(ecs)
 		, parent_changed_connection(ecs.getDispatcher<Hierarchy::ParentChangedEvent>().addCallback<&TransformSystem::onParentChanged>(this)) {
+		setPriority(system_priority);
 	}
 
 	TransformSystem(const TransformSystem&) = delete;
@@ -41,7 +47,40 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
+
+	// Save the world matrices each step starts from
+	void preUpdate() override {
+		getECS().forEach<Transform>([](Transform& transform) {
+			transform.storePrevious();
+		});
+	}
+
 	void update() override {
+		updateTransforms(false);
+	}
+
+	// Resolve the transforms modified since the last step (e.g. by per-frame input), then
+	// blend the world matrices of the last two steps. Systems that modify transforms per
+	// frame must run before this one.
+	void frameUpdate(f32 alpha) override {
+		updateTransforms(true);
+
+		getECS().forEach<Transform>([alpha](Transform& transform) {
+			transform.interpolate(alpha);
+		});
+	}
+
+private:
+
+	void onParentChanged(const Hierarchy::ParentChangedEvent& event) {
+		if (auto* transform = this->getECS().tryGet<Transform>(event.entity)) {
+			transform->setNeedsUpdate();
+			transform->resetInterpolation(); //don't blend from the old parent's space
+		}
+	}
+
+	// Changes made between steps are carried over to the start of the blend
+	void updateTransforms(bool between_steps) {
 		auto& ecs = this->getECS();
 
 		// Set update flags of child transforms
@@ -59,37 +98,29 @@ public:
 		});
 
 		// Update all transforms
-		ecs.forEach<Transform>([this, &ecs](handle64 entity) {
+		ecs.forEach<Transform>([this, &ecs, between_steps](handle64 entity) {
 			auto& transform = ecs.get<Transform>(entity);
 			if (not transform.needsUpdate()) {
 				return;
 			}
 
-			const bool updated = updateWorld(transform);
+			const bool updated = updateWorld(transform, between_steps);
 			if (not updated) {
 				return;
 			}
 
 			// Update children if their parent doesn't need an update
 			if (auto* hierarchy = ecs.tryGet<Hierarchy>(entity)) {
-				hierarchy->forEachChildRecursive(ecs, [this, &ecs](handle64 child) {
+				hierarchy->forEachChildRecursive(ecs, [this, &ecs, between_steps](handle64 child) {
 					if (auto* transform = ecs.tryGet<Transform>(child)) {
-						updateWorld(*transform);
+						updateWorld(*transform, between_steps);
 					}
 				});
 			}
 		});
 	}
 
-private:
-
-	void onParentChanged(const Hierarchy::ParentChangedEvent& event) {
-		if (auto* transform = this->getECS().tryGet<Transform>(event.entity)) {
-			transform->setNeedsUpdate();
-		}
-	} 
-
-	bool updateWorld(Transform& transform) {
+	bool updateWorld(Transform& transform, bool between_steps) {
 		auto& ecs = this->getECS();
 
 		if (auto* hierarchy = ecs.tryGet<Hierarchy>(transform.getOwner());
@@ -102,10 +133,10 @@ private:
 			}
 
 			auto m = parent_transform.getObjectToWorldMatrix();
-			transform.update(&m);
+			transform.update(&m, between_steps);
 		}
 		else {
-			transform.update();
+			transform.update(nullptr, between_steps);
 		}
 
 		transform.clearNeedsUpdate();
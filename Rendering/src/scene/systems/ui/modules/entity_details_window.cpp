@@ -17,7 +17,7 @@ import log;
 import win_utils;
 
 import :engine;
-import :importer.model_importer;
+import :blueprint_factory;
 import :texture_factory;
 import :resource_mgr;
 import :components.hierarchy;
@@ -74,7 +74,9 @@ void EntityDetailsWindow::draw(Engine& engine, handle64 handle) {
 	// Name/Details
 	//----------------------------------------------------------------------------------
 	if (auto* name = ecs.tryGet<Name>(handle)) {
-		ImGui::InputText("##", &name->name);
+		if (ImGui::InputText("##", &name->name)) {
+			ecs.enqueue<Name::NameChangedEvent>(handle);
+		}
 		ImGui::Separator();
 	}
 
@@ -88,11 +90,6 @@ void EntityDetailsWindow::draw(Engine& engine, handle64 handle) {
 	//----------------------------------------------------------------------------------
 	auto* hierarchy = ecs.tryGet<Hierarchy>(handle);
 
-	entity_list.clear();
-	scene.getECS().forEach([&](handle64 other_entity) {
-		entity_list.push_back(other_entity);
-	});
-
 	const char* preview = "None";
 	if (hierarchy && ecs.valid(hierarchy->getParent())) {
 		if (auto* name = ecs.tryGet<Name>(hierarchy->getParent())) {
@@ -101,35 +98,53 @@ void EntityDetailsWindow::draw(Engine& engine, handle64 handle) {
 	}
 
 	if (ImGui::BeginCombo("Parent", preview)) {
+		// Gather the entities when the combo is opened, and only draw the ones scrolled into view
+		if (ImGui::IsWindowAppearing()) {
+			entity_list.clear();
+			scene.getECS().forEach([&](handle64 other_entity) {
+				entity_list.push_back(other_entity);
+			});
+		}
+
 		if ( ImGui::Selectable("None", !hierarchy || (hierarchy->getParent() == handle64::invalid_handle())) ) {
 			if (hierarchy)
 				hierarchy->removeParent(ecs);
 		}
 
-		for (size_t i = 0; i < entity_list.size(); ++i) {
-			const bool selected = (entity_names_idx == i);
-			bool set_parent = false;
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(entity_list.size()));
 
-			if (auto* name = ecs.tryGet<Name>(entity_list[i])) {
-				if (ImGui::Selectable(name->name.c_str(), selected)) {
-					set_parent = true;
+		while (clipper.Step()) {
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+				// The list isn't updated while the combo is open, so an entity in it can be destroyed
+				ImGui::BeginDisabled(not ecs.valid(entity_list[i]));
+
+				const bool selected = (entity_names_idx == i);
+				bool set_parent = false;
+
+				if (auto* name = ecs.tryGet<Name>(entity_list[i])) {
+					if (ImGui::Selectable(name->name.c_str(), selected)) {
+						set_parent = true;
+					}
 				}
-			}
-			else {
-				const std::string temp_name = "(Index: " + ToStr(entity_list[i].index).value_or("-1"s) +
-				                              ", Counter: " + ToStr(entity_list[i].counter).value_or("-1"s) + ")";
-				if (ImGui::Selectable(temp_name.c_str(), selected)) {
-					set_parent = true;
+				else {
+					const std::string temp_name = "(Index: " + ToStr(entity_list[i].index).value_or("-1"s) +
+					                              ", Counter: " + ToStr(entity_list[i].counter).value_or("-1"s) + ")";
+					if (ImGui::Selectable(temp_name.c_str(), selected)) {
+						set_parent = true;
+					}
 				}
-			}
 
-			if (set_parent) {
-				entity_names_idx = static_cast<int>(i);
+				if (set_parent) {
+					entity_names_idx = static_cast<int>(i);
 
-				if (not hierarchy) {
-					hierarchy = &ecs.add<Hierarchy>(handle);
+					if (not hierarchy) {
+						hierarchy = &ecs.add<Hierarchy>(handle);
+					}
+					hierarchy->setParent(ecs, entity_list[i]);
 				}
-				hierarchy->setParent(ecs, entity_list[i]);
+
+				ImGui::EndDisabled();
 			}
 		}
 
@@ -238,8 +253,19 @@ void EntityDetailsWindow::drawAddComponentMenu(Engine& engine, ecs::ECS& ecs, ha
 			if (ImGui::MenuItem("From file")) {
 				if (auto file = OpenFileDialog(); fs::exists(file)) {
 					ModelConfig<VertexPositionNormalTexture> config;
-					auto output = importer::ImportModel(resource_mgr, file, config);
-					auto bp = resource_mgr.getOrCreate<ModelBlueprint>(StrToWstr(output.name), output, config);
+					auto bp = BlueprintFactory::LoadModelFile(resource_mgr, file.wstring(), file, config);
+					if (valid_entity) {
+						scene.importModel(handle, device, bp);
+					}
+				}
+				else {
+					Logger::log(LogLevel::err, "Failed to open file dialog");
+				}
+			}
+			if (ImGui::MenuItem("From file (compact vertices)")) {
+				if (auto file = OpenFileDialog(); fs::exists(file)) {
+					ModelConfig<VertexPositionNormalTextureCompact> config;
+					auto bp = BlueprintFactory::LoadModelFile(resource_mgr, file.wstring() + L" (compact)", file, config);
 					if (valid_entity) {
 						scene.importModel(handle, device, bp);
 					}
@@ -594,6 +620,10 @@ void EntityDetailsWindow::drawDetails(Model& model, ResourceMgr& resource_mgr) {
 	bool shadows = model.castsShadows();
 	if (ImGui::Checkbox("Casts Shadows", &shadows))
 		model.setShadows(shadows);
+
+	bool static_shadows = model.hasStaticShadows();
+	if (ImGui::Checkbox("Static Shadows", &static_shadows))
+		model.setStaticShadows(static_shadows);
 }
 
 
@@ -782,7 +812,9 @@ template<>
 void EntityDetailsWindow::drawDetails(PointLight& light) {
 
 	// Base Color
-	ImGui::ColorEdit3("Base Color", light.getBaseColor().data());
+	auto color = light.getBaseColor();
+	if (ImGui::ColorEdit3("Base Color", color.data()))
+		light.setBaseColor(color);
 
 	// Intensity
 	auto intensity = light.getIntensity();
@@ -795,7 +827,9 @@ void EntityDetailsWindow::drawDetails(PointLight& light) {
 		light.setRange(range);
 
 	// Attenuation
-	ImGui::DragFloat3("Attenuation", light.getAttenuation().data(), 0.01f, 0.0f, 1.0f);
+	auto attenuation = light.getAttenuation();
+	if (ImGui::DragFloat3("Attenuation", attenuation.data(), 0.01f, 0.0f, 1.0f))
+		light.setAttenuation(attenuation);
 
 	// Shadows
 	auto shadows = light.castsShadows();
@@ -808,7 +842,9 @@ template<>
 void EntityDetailsWindow::drawDetails(SpotLight& light) {
 
 	// Base Color
-	ImGui::ColorEdit3("Base Color", light.getBaseColor().data());
+	auto color = light.getBaseColor();
+	if (ImGui::ColorEdit3("Base Color", color.data()))
+		light.setBaseColor(color);
 
 	// Intensity
 	auto intensity = light.getIntensity();
@@ -821,7 +857,9 @@ void EntityDetailsWindow::drawDetails(SpotLight& light) {
 		light.setRange(range);
 
 	// Attenuation
-	ImGui::DragFloat3("Attenuation", light.getAttenuation().data(), 0.01f, 0.0f, 1.0f);
+	auto attenuation = light.getAttenuation();
+	if (ImGui::DragFloat3("Attenuation", attenuation.data(), 0.01f, 0.0f, 1.0f))
+		light.setAttenuation(attenuation);
 
 	// Umbra Angle
 	auto umbra = light.getUmbraAngle();
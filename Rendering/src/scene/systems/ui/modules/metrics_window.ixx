@@ -1,12 +1,24 @@
 module;
 
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
 #include "imgui.h"
 #include "imgui_addons/metrics_gui/metrics_gui/metrics_gui.h"
 
+#include "datatypes/scalar_types.h"
+#include "memory/memory_tracker.h"
+#include "profiler/profiler.h"
+
 export module rendering:systems.user_interface.modules.metrics_window;
 
+import log;
+import system_monitor;
 import :engine;
 import :gpu_profiler;
+import :pipeline;
+import :resource_mgr;
 
 
 export class MetricsWindow final {
@@ -44,26 +56,18 @@ public:
 		ram_plot.AddMetric(&total_ram);
 		ram_plot.AddMetric(&process_ram);
 
+		// The GPU metrics are added as the profiler's zones are first measured
 		gpu_plot.mShowLegendMin     = false;
 		gpu_plot.mShowLegendMax     = false;
 		gpu_plot.mShowLegendAverage = true;
-		gpu_plot.AddMetric(&frame_gpu_time);
-		gpu_plot.AddMetric(&scene_render);
-		gpu_plot.AddMetric(&imgui_render);
 		gpu_plot.LinkLegends(&scene_gpu_plot);
 
 		scene_gpu_plot.mShowLegendMin     = false;
 		scene_gpu_plot.mShowLegendMax     = false;
 		scene_gpu_plot.mShowLegendAverage = true;
-		scene_gpu_plot.AddMetric(&skybox_render);
-		scene_gpu_plot.AddMetric(&shadow_maps);
-		scene_gpu_plot.AddMetric(&forward_render);
-		scene_gpu_plot.AddMetric(&gbuffer_render);
-		scene_gpu_plot.AddMetric(&deferred_render);
-		scene_gpu_plot.AddMetric(&text_render);
 	}
 
-	MetricsWindow(const MetricsWindow&) = default;
+	MetricsWindow(const MetricsWindow&) = delete;
 	MetricsWindow(MetricsWindow&&) noexcept = default;
 
 
@@ -76,7 +80,7 @@ public:
 	//----------------------------------------------------------------------------------
 	// Operators
 	//----------------------------------------------------------------------------------
-	MetricsWindow& operator=(const MetricsWindow&) = default;
+	MetricsWindow& operator=(const MetricsWindow&) = delete;
 	MetricsWindow& operator=(MetricsWindow&&) noexcept = default;
 
 
@@ -111,17 +115,20 @@ public:
 		// Update GPU time
 		//----------------------------------------------------------------------------------
 		const auto& profiler = engine.getRenderingMgr().getProfiler();
-		frame_gpu_time.AddNewValue(profiler.deltaTime("Frame"));
-		imgui_render.AddNewValue(profiler.deltaTime("ImGui"));
-		scene_render.AddNewValue(profiler.deltaTime("Render Scene"));
-		gpu_plot.UpdateAxes();
 
-		skybox_render.AddNewValue(profiler.deltaTime("Skybox"));
-		shadow_maps.AddNewValue(profiler.deltaTime("Shadow Maps"));
-		forward_render.AddNewValue(profiler.deltaTime("Forward"));
-		gbuffer_render.AddNewValue(profiler.deltaTime("GBuffer"));
-		deferred_render.AddNewValue(profiler.deltaTime("Deferred"));
-		text_render.AddNewValue(profiler.deltaTime("Text"));
+		// Zones with the same name (e.g. the same pass in different render paths) share a metric
+		std::unordered_map<std::string_view, float> gpu_times;
+		for (const auto& zone : profiler.getZones()) {
+			if (zone.depth > 2)
+				continue;
+			addGPUMetric(*zone.zone, zone.depth);
+			gpu_times[zone.zone->name] += zone.delta_time;
+		}
+		for (const auto& [name, metric] : gpu_metrics) {
+			metric->AddNewValue(gpu_times[name]);
+		}
+
+		gpu_plot.UpdateAxes();
 		scene_gpu_plot.UpdateAxes();
 
 
@@ -179,6 +186,22 @@ public:
 					ImGui::EndTabItem();
 				}
 
+				if (ImGui::BeginTabItem("Profiler")) {
+					drawProfiler(profiler);
+					drawBindStats(engine.getRenderingMgr().getBindStats());
+					ImGui::EndTabItem();
+				}
+
+				if (ImGui::BeginTabItem("Memory")) {
+					drawMemory(sys_mon);
+					ImGui::EndTabItem();
+				}
+
+				if (ImGui::BeginTabItem("Resources")) {
+					drawDedupStats(engine.getRenderingMgr().getResourceMgr().getDedupStats());
+					ImGui::EndTabItem();
+				}
+
 				ImGui::EndTabBar();
 			}
 		}
@@ -187,6 +210,141 @@ public:
 
 private:
 
+	// Create the metric of a GPU zone if it doesn't exist. The frame and its direct children
+	// are shown in the GPU plot, and their children in the scene breakdown.
+	void addGPUMetric(const ProfileZone& zone, u32 depth) {
+		if (gpu_metrics.contains(zone.name))
+			return;
+
+		auto& metric = gpu_metric_storage.emplace_back(zone.name, "s", si_prefix);
+		gpu_metrics.emplace(zone.name, &metric);
+
+		if (depth <= 1)
+			gpu_plot.AddMetric(&metric);
+		else
+			scene_gpu_plot.AddMetric(&metric);
+	}
+
+	static void drawProfiler(const render::GPUProfiler& gpu_profiler) {
+		static constexpr const char* trace_file = "trace.json";
+
+		if (Profiler::isCapturing()) {
+			if (ImGui::Button("Stop Capture")) {
+				Profiler::endCapture();
+				if (Profiler::writeChromeTrace(fs::path{trace_file}))
+					Logger::log(LogLevel::info, "Wrote profiler capture to {}", trace_file);
+				else
+					Logger::log(LogLevel::err, "Failed to write profiler capture to {}", trace_file);
+			}
+		}
+		else if (ImGui::Button("Start Capture")) {
+			Profiler::beginCapture();
+		}
+		ImGui::SameLine();
+		ImGui::Text("Dropped events: %llu", static_cast<unsigned long long>(Profiler::getDroppedCount()));
+
+		ImGui::Spacing();
+		ImGui::Text("CPU (last frame)");
+		ImGui::Separator();
+		for (const auto& zone : Profiler::getFrameStats()) {
+			ImGui::Text("%*s%s", static_cast<int>(zone.depth * 2), "", zone.zone->name);
+			ImGui::SameLine(300);
+			ImGui::Text("%.3f ms", zone.time);
+			if (zone.count > 1) {
+				ImGui::SameLine();
+				ImGui::Text("(x%u)", zone.count);
+			}
+		}
+
+		ImGui::Spacing();
+		ImGui::Text("GPU (average)");
+		ImGui::Separator();
+		for (const auto& zone : gpu_profiler.getZones()) {
+			ImGui::Text("%*s%s", static_cast<int>(zone.depth * 2), "", zone.zone->name);
+			ImGui::SameLine(300);
+			ImGui::Text("%.3f ms", zone.average_time * 1000.0f);
+		}
+	}
+
+	static void drawBindStats(const render::PipelineBindStats& stats) {
+		static constexpr auto draw_counts = [](const char* name, const render::BindCounts& counts) {
+			ImGui::Text("%s", name);
+			ImGui::SameLine(160);
+			ImGui::Text("%u", counts.issued);
+			ImGui::SameLine(260);
+			ImGui::Text("%u", counts.skipped);
+		};
+
+		ImGui::Spacing();
+		ImGui::Text("Binds (last frame)");
+		ImGui::Separator();
+		ImGui::Text("Type");
+		ImGui::SameLine(160);
+		ImGui::Text("Issued");
+		ImGui::SameLine(260);
+		ImGui::Text("Skipped");
+
+		draw_counts("Shaders", stats.shaders);
+		draw_counts("Constant Buffers", stats.constant_buffers);
+		draw_counts("SRVs", stats.srvs);
+		draw_counts("Samplers", stats.samplers);
+		draw_counts("States", stats.states);
+		draw_counts("Input Assembler", stats.input_assembler);
+		draw_counts("Output Merger", stats.output_merger);
+		draw_counts("Total", stats.getTotal());
+	}
+
+	static void drawMemory(const SystemMonitor& sys_mon) {
+		static constexpr f64 mib = 1024.0 * 1024.0;
+
+		const auto& memory = sys_mon.memory();
+		ImGui::Text("Process");
+		ImGui::Separator();
+		ImGui::Text("Working set: %.1f MiB (peak %.1f MiB)", memory.getProcessUsedPhysicalMem() / mib, memory.getProcessPeakPhysicalMem() / mib);
+		ImGui::Text("Private: %.1f MiB", memory.getProcessUsedVirtualMem() / mib);
+
+		ImGui::Spacing();
+		ImGui::Text("Subsystems");
+		ImGui::SameLine();
+		if (ImGui::SmallButton("Reset Peaks"))
+			MemoryTracker::resetPeaks();
+		ImGui::Separator();
+
+		ImGui::Text("Tag");
+		ImGui::SameLine(120);
+		ImGui::Text("Current");
+		ImGui::SameLine(220);
+		ImGui::Text("Peak");
+		ImGui::SameLine(320);
+		ImGui::Text("Allocations");
+
+		for (const auto& stats : MemoryTracker::getBreakdown()) {
+			ImGui::Text("%s", stats.name);
+			ImGui::SameLine(120);
+			ImGui::Text("%.2f MiB", stats.bytes / mib);
+			ImGui::SameLine(220);
+			ImGui::Text("%.2f MiB", stats.peak_bytes / mib);
+			ImGui::SameLine(320);
+			ImGui::Text("%llu", static_cast<unsigned long long>(stats.allocations));
+		}
+	}
+
+	static void drawDedupStats(const render::ResourceDedupStats& stats) {
+		ImGui::Text("Textures");
+		ImGui::Separator();
+		ImGui::Text("Requests: %u", stats.texture_requests);
+		ImGui::Text("Shared by path: %u", stats.texture_path_hits);
+		ImGui::Text("Shared by content: %u", stats.texture_content_hits);
+
+		ImGui::Spacing();
+		ImGui::Text("Materials");
+		ImGui::Separator();
+		ImGui::Text("Requests: %u", stats.materials.requests);
+		ImGui::Text("Shared: %u", stats.materials.hits);
+		ImGui::Text("Unique: %u", stats.materials.unique);
+	}
+
+
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
@@ -206,20 +364,12 @@ private:
 	MetricsGuiMetric total_ram{"Total Usage", "B", si_prefix | known_min_max};
 	MetricsGuiMetric process_ram{"Process Usage", "B", si_prefix | known_min_max};
 
-	// GPU Time
+	// GPU Time, and the scene render breakdown. One metric per GPU zone name. A deque is used
+	// so that the metrics don't move when more are added.
 	MetricsGuiPlot   gpu_plot;
-	MetricsGuiMetric frame_gpu_time{"Frame Time (GPU)", "s", si_prefix};
-	MetricsGuiMetric imgui_render{"ImGui Render", "s", si_prefix};
-
-	// Scene Render GPU Time
 	MetricsGuiPlot   scene_gpu_plot;
-	MetricsGuiMetric scene_render{"Scene Render", "s", si_prefix};
-	MetricsGuiMetric skybox_render{"Skybox Render", "s", si_prefix};
-	MetricsGuiMetric shadow_maps{"Shadow Maps Render", "s", si_prefix};
-	MetricsGuiMetric forward_render{"Forward Render", "s", si_prefix};
-	MetricsGuiMetric gbuffer_render{"GBuffer Render", "s", si_prefix};
-	MetricsGuiMetric deferred_render{"Deferred Render", "s", si_prefix};
-	MetricsGuiMetric text_render{"Text Render", "s", si_prefix};
+	std::deque<MetricsGuiMetric> gpu_metric_storage;
+	std::unordered_map<std::string_view, MetricsGuiMetric*> gpu_metrics;
 
 	static constexpr auto si_prefix     = MetricsGuiMetric::USE_SI_UNIT_PREFIX;
 	static constexpr auto known_min_max = MetricsGuiMetric::KNOWN_MIN_VALUE | MetricsGuiMetric::KNOWN_MAX_VALUE;
@@ -0,0 +1,356 @@
+module;
+
+#include <algorithm>
+#include <cctype>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "imgui.h"
+#include "misc/cpp/imgui_stdlib.h"
+#include "memory/handle/handle.h"
+#include "string/string.h"
+
+module rendering;
+
+
+namespace {
+
+[[nodiscard]]
+std::string ToLowerCase(std::string_view str) {
+	std::string result{str};
+	std::ranges::transform(result, result.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	return result;
+}
+
+[[nodiscard]]
+bool IsWordStart(std::string_view str, size_t pos) noexcept {
+	if (std::isspace(static_cast<unsigned char>(str[pos])))
+		return false;
+	if (pos == 0)
+		return true;
+
+	const auto prev = static_cast<unsigned char>(str[pos - 1]);
+	return std::isspace(prev) or (prev == '_') or (prev == '-') or (prev == '.');
+}
+
+} //namespace
+
+
+SceneTree::SceneTree(ecs::ECS& ecs)
+	: ecs(ecs)
+	, create_connection(ecs.getDispatcher<ecs::EntityCreated>().addCallback<&SceneTree::onEntityCreated>(this))
+	, destroy_connection(ecs.getDispatcher<ecs::EntityDestroyed>().addCallback<&SceneTree::onEntityDestroyed>(this))
+	, parent_connection(ecs.getDispatcher<Hierarchy::ParentChangedEvent>().addCallback<&SceneTree::onParentChanged>(this))
+	, name_added_connection(ecs.getDispatcher<ecs::ComponentAdded<Name>>().addCallback<&SceneTree::onNameAdded>(this))
+	, name_changed_connection(ecs.getDispatcher<Name::NameChangedEvent>().addCallback<&SceneTree::onNameChanged>(this)) {
+
+	// Build the model from the entities that already exist. It's kept up to date by the
+	// events from here on.
+	ecs.forEach([this, &ecs](handle64 entity) {
+		if (isRoot(entity))
+			addRoot(entity);
+		if (const auto* name = ecs.tryGet<Name>(entity))
+			indexName(entity, name->name);
+	});
+}
+
+
+void SceneTree::draw(render::Scene& scene) {
+	ImGui::SetNextWindowSize(ImVec2{ 275, 600 }, ImGuiCond_FirstUseEver);
+	if (ImGui::Begin("Scene", nullptr, ImGuiWindowFlags_MenuBar)) {
+		drawMenuBar(scene);
+		drawTree(scene);
+	}
+	ImGui::End();
+}
+
+
+//----------------------------------------------------------------------------------
+// Events
+//----------------------------------------------------------------------------------
+
+void SceneTree::onEntityCreated(const ecs::EntityCreated& event) {
+	if (isRoot(event.entity)) {
+		addRoot(event.entity);
+		rows_dirty = true;
+	}
+}
+
+
+void SceneTree::onEntityDestroyed(const ecs::EntityDestroyed& event) {
+	// The entity stays valid until the end of the ECS update, so it's tracked until then
+	destroyed.insert(event.entity);
+	expanded.erase(event.entity);
+
+	removeRoot(event.entity);
+	removeName(event.entity);
+
+	if (selected == event.entity)
+		selected = handle64{};
+
+	rows_dirty = true;
+}
+
+
+void SceneTree::onParentChanged(const Hierarchy::ParentChangedEvent& event) {
+	if (not ecs.get().valid(event.entity) or destroyed.contains(event.entity))
+		return;
+
+	if (isRoot(event.entity))
+		addRoot(event.entity);
+	else
+		removeRoot(event.entity);
+
+	rows_dirty = true;
+}
+
+
+void SceneTree::onNameAdded(const ecs::ComponentAdded<Name>& event) {
+	indexName(event.entity, event.component.name);
+}
+
+
+void SceneTree::onNameChanged(const Name::NameChangedEvent& event) {
+	if (destroyed.contains(event.entity))
+		return;
+
+	if (const auto* name = ecs.get().tryGet<Name>(event.entity))
+		indexName(event.entity, name->name);
+}
+
+
+//----------------------------------------------------------------------------------
+// Model
+//----------------------------------------------------------------------------------
+
+bool SceneTree::isRoot(handle64 entity) const {
+	if (const auto* hierarchy = ecs.get().tryGet<Hierarchy>(entity))
+		return not ecs.get().valid(hierarchy->getParent());
+	return true;
+}
+
+
+void SceneTree::addRoot(handle64 entity) {
+	if (root_indices.try_emplace(entity, roots.size()).second)
+		roots.push_back(entity);
+}
+
+
+void SceneTree::removeRoot(handle64 entity) {
+	const auto it = root_indices.find(entity);
+	if (it == root_indices.end())
+		return;
+
+	// Swap the last root into the removed root's place
+	const size_t index = it->second;
+	root_indices.erase(it);
+
+	if (index != roots.size() - 1) {
+		roots[index] = roots.back();
+		root_indices[roots[index]] = index;
+	}
+	roots.pop_back();
+}
+
+
+void SceneTree::indexName(handle64 entity, const std::string& name) {
+	removeName(entity);
+
+	const auto lower_name = ToLowerCase(name);
+	auto& entries = name_entries[entity];
+
+	for (size_t i = 0; i < lower_name.size(); ++i) {
+		if (IsWordStart(lower_name, i))
+			entries.push_back(name_index.emplace(lower_name.substr(i), entity));
+	}
+
+	search_dirty = true;
+}
+
+
+void SceneTree::removeName(handle64 entity) {
+	const auto it = name_entries.find(entity);
+	if (it == name_entries.end())
+		return;
+
+	for (const auto entry : it->second)
+		name_index.erase(entry);
+
+	name_entries.erase(it);
+	search_dirty = true;
+}
+
+
+void SceneTree::rebuildRows() {
+	auto& ecs = this->ecs.get();
+
+	// Forget the destroyed entities that have been removed from the ECS
+	std::erase_if(destroyed, [&ecs](handle64 entity) {
+		return not ecs.valid(entity);
+	});
+
+	rows.clear();
+	for (const auto root : roots) {
+		appendRows(root, 0);
+	}
+
+	rows_dirty = false;
+}
+
+
+void SceneTree::appendRows(handle64 entity, u32 depth) {
+	auto& ecs = this->ecs.get();
+
+	const auto* hierarchy    = ecs.tryGet<Hierarchy>(entity);
+	const bool  has_children = hierarchy and hierarchy->hasChildren();
+
+	rows.push_back(Row{entity, depth, has_children});
+
+	if (has_children and expanded.contains(entity)) {
+		hierarchy->forEachChild(ecs, [this, depth](handle64 child) {
+			if (not destroyed.contains(child))
+				appendRows(child, depth + 1);
+		});
+	}
+}
+
+
+void SceneTree::updateSearchResults() {
+	search_results.clear();
+	search_dirty = false;
+
+	const auto query = ToLowerCase(search_query);
+	if (query.empty())
+		return;
+
+	// A name can match the query at more than one word, but is only listed once
+	std::unordered_set<handle64> matches;
+
+	for (auto it = name_index.lower_bound(query); it != name_index.end() and it->first.starts_with(query); ++it) {
+		if (matches.insert(it->second).second)
+			search_results.push_back(Row{it->second, 0, false});
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+// Drawing
+//----------------------------------------------------------------------------------
+
+void SceneTree::drawTree(render::Scene& scene) {
+	ImGui::Text("%s (Entities: %llu)", scene.getName().c_str(), scene.getECS().count<handle64>());
+
+	ImGui::SetNextItemWidth(-FLT_MIN);
+	if (ImGui::InputTextWithHint("##Search", "Search", &search_query))
+		search_dirty = true;
+
+	ImGui::Separator();
+
+	if (ImGui::BeginChild("Object List")) {
+		if (search_query.empty()) {
+			if (rows_dirty)
+				rebuildRows();
+			drawRows(rows);
+		}
+		else {
+			if (search_dirty)
+				updateSearchResults();
+			drawRows(search_results);
+		}
+	}
+
+	ImGui::EndChild();
+}
+
+
+void SceneTree::drawRows(std::span<const Row> row_list) {
+	ImGuiListClipper clipper;
+	clipper.Begin(static_cast<int>(row_list.size()));
+
+	while (clipper.Step()) {
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+			drawRow(row_list[i]);
+		}
+	}
+}
+
+
+void SceneTree::drawRow(const Row& row) {
+	auto& ecs = this->ecs.get();
+
+	// Rows are positioned manually, so the nodes are never pushed onto ImGui's tree stack
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+	if (row.has_children) {
+		flags |= ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
+		ImGui::SetNextItemOpen(expanded.contains(row.entity));
+	}
+	else {
+		flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_Bullet;
+	}
+
+	if (selected == row.entity)
+		flags |= ImGuiTreeNodeFlags_Selected;
+
+	ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (static_cast<f32>(row.depth) * ImGui::GetStyle().IndentSpacing));
+
+	const auto* id = reinterpret_cast<void*>(static_cast<handle64::value_type>(row.entity));
+
+	bool node_open = false;
+	if (const auto* name_cmp = ecs.tryGet<Name>(row.entity)) {
+		node_open = ImGui::TreeNodeEx(id, flags, "%s", name_cmp->name.c_str());
+	}
+	else {
+		const std::string name = "(Index: " + ToStr(row.entity.index).value_or("-1"s) +
+		                         ", Counter: " + ToStr(row.entity.counter).value_or("-1"s) + ")";
+		node_open = ImGui::TreeNodeEx(id, flags, "%s", name.c_str());
+	}
+
+	if (ImGui::IsItemClicked()) {
+		selected = row.entity;
+	}
+
+	// The rows are being drawn, so they're rebuilt next frame
+	if (row.has_children and (node_open != expanded.contains(row.entity))) {
+		if (node_open)
+			expanded.insert(row.entity);
+		else
+			expanded.erase(row.entity);
+
+		rows_dirty = true;
+	}
+}
+
+
+void SceneTree::drawMenuBar(render::Scene& scene) {
+	if (ImGui::BeginMenuBar()) {
+		drawEntityMenu(scene);
+		ImGui::EndMenuBar();
+	}
+}
+
+
+void SceneTree::drawEntityMenu(render::Scene& scene) {
+	auto& ecs = scene.getECS();
+
+	if (ImGui::BeginMenu("Entity")) {
+
+		if (ImGui::MenuItem("New")) {
+			scene.createEntity();
+		}
+
+		if ( ImGui::BeginMenu("Selected", ecs.valid(selected)) ) {
+			ImGui::Separator();
+			if (ImGui::MenuItem("Delete")) {
+				ecs.destroy(selected);
+			}
+
+			ImGui::EndMenu(); //Selected
+		}
+
+		ImGui::EndMenu(); //Entity
+	}
+}
\ No newline at end of file
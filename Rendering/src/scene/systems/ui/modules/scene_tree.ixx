@@ -1,28 +1,47 @@
 module;
 
+#include <functional>
+#include <map>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include "imgui.h"
+#include "datatypes/scalar_types.h"
 #include "memory/handle/handle.h"
-#include "string/string.h"
 
 export module rendering:systems.user_interface.modules.scene_tree;
 
 import ecs;
-import :systems.user_interface.modules.selectable_tree;
 import :components.hierarchy;
 import :components.name;
 import :scene;
 
 
+//----------------------------------------------------------------------------------
+// SceneTree
+//----------------------------------------------------------------------------------
+//
+// Draws the scene's entity hierarchy. The tree isn't walked each frame. Instead, the
+// root entities and an index of entity names are kept up to date by the entity,
+// hierarchy, and name events, and the expanded part of the tree is flattened into a
+// list of rows that's only rebuilt when one of them changes. Only the rows that are
+// scrolled into view are drawn, so the cost of a frame doesn't depend on the number
+// of entities in the scene.
+//
+// Searching matches the start of any word in an entity's name, and shows the
+// matching entities as a flat list.
+//
+//----------------------------------------------------------------------------------
 export class SceneTree final {
 public:
 	//----------------------------------------------------------------------------------
 	// Constructors
 	//----------------------------------------------------------------------------------
-	SceneTree() = default;
-	SceneTree(const SceneTree&) = default;
-	SceneTree(SceneTree&&) = default;
+	SceneTree(ecs::ECS& ecs);
+	SceneTree(const SceneTree&) = delete;
+	SceneTree(SceneTree&&) noexcept = default;
 
 
 	//----------------------------------------------------------------------------------
@@ -34,125 +53,105 @@ public:
 	//----------------------------------------------------------------------------------
 	// Operators
 	//----------------------------------------------------------------------------------
-	SceneTree& operator=(const SceneTree&) = default;
-	SceneTree& operator=(SceneTree&&) = default;
+	SceneTree& operator=(const SceneTree&) = delete;
+	SceneTree& operator=(SceneTree&&) noexcept = default;
 
 
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void draw(render::Scene& scene) {
-		ImGui::SetNextWindowSize(ImVec2{ 275, 600 }, ImGuiCond_FirstUseEver);
-		if (ImGui::Begin("Scene", nullptr, ImGuiWindowFlags_MenuBar)) {
-			drawMenuBar(scene);
-			drawTree(scene);
-		}
-		ImGui::End();
-	}
+	void draw(render::Scene& scene);
 
 	[[nodiscard]]
 	handle64 getSelectedEntity() const noexcept {
-		return static_cast<handle64>(scene_tree.getSelected());
+		return selected;
 	}
 
-	[[nodiscard]]
 	void setSelectedEntity(handle64 entity) noexcept {
-		scene_tree.setSelected(entity);
+		selected = entity;
 	}
 
 private:
 
-	void drawTree(render::Scene& scene) {
-		auto& ecs = scene.getECS();
+	// A visible line of the tree
+	struct Row {
+		handle64 entity;
+		u32      depth = 0;
+		bool     has_children = false;
+	};
 
-		if (ImGui::BeginChild("Object List", {0, 0}, ImGuiChildFlags_AlwaysAutoResize | ImGuiChildFlags_AutoResizeX | ImGuiChildFlags_AutoResizeY)) {
+	//----------------------------------------------------------------------------------
+	// Member Functions - Events
+	//----------------------------------------------------------------------------------
+	void onEntityCreated(const ecs::EntityCreated& event);
+	void onEntityDestroyed(const ecs::EntityDestroyed& event);
+	void onParentChanged(const Hierarchy::ParentChangedEvent& event);
+	void onNameAdded(const ecs::ComponentAdded<Name>& event);
+	void onNameChanged(const Name::NameChangedEvent& event);
 
-			ImGui::Text("%s (Entities: %llu)", scene.getName().c_str(), scene.getECS().count<handle64>());
-			ImGui::Separator();
+	//----------------------------------------------------------------------------------
+	// Member Functions - Model
+	//----------------------------------------------------------------------------------
+	[[nodiscard]]
+	bool isRoot(handle64 entity) const;
 
-			// Draw a tree node for each root entity
-			ecs.forEach([&](handle64 entity) {
-				if (auto* hierarchy = ecs.tryGet<Hierarchy>(entity)) {
-					if (ecs.valid(hierarchy->getParent()))
-						return;
-				}
-				drawEntityNode(ecs, entity);
-			});
-		}
+	void addRoot(handle64 entity);
+	void removeRoot(handle64 entity);
 
-		ImGui::EndChild();
-	}
+	void indexName(handle64 entity, const std::string& name);
+	void removeName(handle64 entity);
 
-	void drawEntityNode(ecs::ECS& ecs, handle64 entity) {
-		bool node_open = true;
-		auto* hierarchy = ecs.tryGet<Hierarchy>(entity);
-
-		if (hierarchy && hierarchy->hasChildren()) {
-			if (auto* name_cmp = ecs.tryGet<Name>(entity)) {
-				node_open = scene_tree.newNode(entity, name_cmp->name.c_str());
-			}
-			else {
-				const std::string name = "(Index: " + ToStr(entity.index).value_or("-1"s) +
-										 ", Counter: " + ToStr(entity.counter).value_or("-1"s) + ")";
-				node_open = scene_tree.newNode(entity, name.c_str());
-			}
-		}
-		else {
-			if (auto* name_cmp = ecs.tryGet<Name>(entity)) {
-				node_open = scene_tree.newLeafNode(entity, name_cmp->name.c_str());
-			}
-			else {
-				const std::string name = "(Index: " + ToStr(entity.index).value_or("-1"s) +
-										 ", Counter: " + ToStr(entity.counter).value_or("-1"s) + ")";
-				node_open = scene_tree.newLeafNode(entity, name.c_str());
-			}
-		}
-
-		if (node_open) {
-			// Draw any child entities in this node
-			if (hierarchy && hierarchy->hasChildren()) {
-				hierarchy->forEachChild(ecs, [this, &ecs](handle64 child) {
-					drawEntityNode(ecs, child);
-				});
-			}
-
-			scene_tree.endNode();
-		}
-	}
+	void rebuildRows();
+	void appendRows(handle64 entity, u32 depth);
 
-	void drawMenuBar(render::Scene& scene) {
-		if (ImGui::BeginMenuBar()) {
-			drawEntityMenu(scene);
-			ImGui::EndMenuBar();
-		}
-	}
+	void updateSearchResults();
 
-	void drawEntityMenu(render::Scene& scene) {
-		auto& ecs = scene.getECS();
-		const auto handle = static_cast<handle64>(scene_tree.getSelected());
+	//----------------------------------------------------------------------------------
+	// Member Functions - Drawing
+	//----------------------------------------------------------------------------------
+	void drawTree(render::Scene& scene);
+	void drawRows(std::span<const Row> row_list);
+	void drawRow(const Row& row);
 
-		if (ImGui::BeginMenu("Entity")) {
+	void drawMenuBar(render::Scene& scene);
+	void drawEntityMenu(render::Scene& scene);
 
-			if (ImGui::MenuItem("New")) {
-				scene.createEntity();
-			}
 
-			if ( ImGui::BeginMenu("Selected", ecs.valid(handle)) ) {
-				ImGui::Separator();
-				if (ImGui::MenuItem("Delete")) {
-					ecs.destroy(handle);
-				}
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::reference_wrapper<ecs::ECS> ecs;
 
-				ImGui::EndMenu(); //Selected
-			}
+	ecs::UniqueDispatcherConnection create_connection;
+	ecs::UniqueDispatcherConnection destroy_connection;
+	ecs::UniqueDispatcherConnection parent_connection;
+	ecs::UniqueDispatcherConnection name_added_connection;
+	ecs::UniqueDispatcherConnection name_changed_connection;
 
-			ImGui::EndMenu(); //Entity
-		}
-	}
+	// Entities without a parent, and the position of each in the vector
+	std::vector<handle64>                roots;
+	std::unordered_map<handle64, size_t> root_indices;
 
+	// Entities that were destroyed but are valid until the end of the ECS update
+	std::unordered_set<handle64> destroyed;
 
-	//----------------------------------------------------------------------------------
-	// Member Variables
-	//----------------------------------------------------------------------------------
-	SelectableTree<handle64::value_type> scene_tree;
+	// Entities whose children are shown
+	std::unordered_set<handle64> expanded;
+
+	// The flattened tree. Rebuilt when dirty.
+	std::vector<Row> rows;
+	bool rows_dirty = true;
+
+	// Lowercase name -> entity. Each name is indexed from the start of each of its words,
+	// and each entity holds the entries of its name so they can be removed.
+	using name_index_type = std::multimap<std::string, handle64>;
+	name_index_type name_index;
+	std::unordered_map<handle64, std::vector<name_index_type::iterator>> name_entries;
+
+	// The current search, and a row for each entity that matches it. Updated when dirty.
+	std::string      search_query;
+	std::vector<Row> search_results;
+	bool             search_dirty = false;
+
+	handle64 selected;
 };
\ No newline at end of file
@@ -13,6 +13,7 @@ import win_utils;
 import :engine;
 import :rendering_mgr;
 import :rendering_config;
+import :rendering_options;
 import :display_config;
 import :model_blueprint;
 import :resource_mgr;
@@ -32,9 +33,19 @@ public:
 
 		// Get shadow map config
 		smap_res = rendering_config.getShadowMapRes();
+		smap_atlas_res = rendering_config.getShadowMapAtlasRes();
+		smap_cube_map_count = rendering_config.getShadowMapCubeMapCount();
+		smap_cascade_count = rendering_config.getShadowMapCascadeCount();
+		smap_cascade_lambda = rendering_config.getShadowMapCascadeLambda();
+		smap_cascade_distance = rendering_config.getShadowMapCascadeDistance();
 		smap_depth_bias = rendering_config.getShadowMapDepthBias();
 		smap_slope_scaled_depth_bias = rendering_config.getShadowMapSlopeScaledDepthBias();
 		smap_depth_bias_clamp = rendering_config.getShadowMapDepthBiasClamp();
+		smap_caching = rendering_config.isShadowMapCachingEnabled();
+		smap_static_cache = rendering_config.isShadowMapStaticCacheEnabled();
+
+		// Get forward rendering config
+		depth_prepass = static_cast<int>(rendering_config.getDepthPrepass());
 
 		// Create the display mode strings
 		for (const auto& desc : display_config.getDisplayDescList()) {
@@ -150,9 +161,23 @@ private:
 			ImGui::Separator();
 
 			ImGui::DragScalar("Resolution", ImGuiDataType_U32, &smap_res, 1);
+			ImGui::DragScalar("Atlas Resolution", ImGuiDataType_U32, &smap_atlas_res, 1);
+			ImGui::DragScalar("Cube Map Count", ImGuiDataType_U32, &smap_cube_map_count, 1);
+			ImGui::DragScalar("Cascades", ImGuiDataType_U32, &smap_cascade_count, 1);
+			ImGui::SliderFloat("Cascade Lambda", &smap_cascade_lambda, 0.0f, 1.0f);
+			ImGui::DragFloat("Cascade Distance", &smap_cascade_distance, 1.0f, 1.0f, FLT_MAX);
 			ImGui::DragScalar("Depth Bias", ImGuiDataType_S32, &smap_depth_bias, 1);
 			ImGui::DragFloat("Slope Scaled Depth Bias", &smap_slope_scaled_depth_bias, 0.01f);
 			ImGui::DragFloat("Depth Bias Clamp", &smap_depth_bias_clamp, 0.01f);
+			ImGui::Checkbox("Caching", &smap_caching);
+			ImGui::Checkbox("Static Cache", &smap_static_cache);
+
+			ImGui::Spacing();
+			ImGui::Text("Forward Rendering");
+			ImGui::Separator();
+
+			static constexpr const char* depth_prepass_modes[] = {"None", "Depth", "Depth + Hi-Z"};
+			ImGui::Combo("Depth Pre-pass", &depth_prepass, depth_prepass_modes, static_cast<int>(std::size(depth_prepass_modes)));
 
 			bool apply = false;
 			bool save = false;
@@ -166,9 +191,17 @@ private:
 
 			if (apply || save) {
 				rendering_config.setShadowMapRes(smap_res);
+				rendering_config.setShadowMapAtlasRes(smap_atlas_res);
+				rendering_config.setShadowMapCubeMapCount(smap_cube_map_count);
+				rendering_config.setShadowMapCascadeCount(smap_cascade_count);
+				rendering_config.setShadowMapCascadeLambda(smap_cascade_lambda);
+				rendering_config.setShadowMapCascadeDistance(smap_cascade_distance);
 				rendering_config.setShadowMapDepthBias(smap_depth_bias);
 				rendering_config.setShadowMapSlopeScaledDepthBias(smap_slope_scaled_depth_bias);
 				rendering_config.setShadowMapDepthBiasClamp(smap_depth_bias_clamp);
+				rendering_config.setShadowMapCaching(smap_caching);
+				rendering_config.setShadowMapStaticCache(smap_static_cache);
+				rendering_config.setDepthPrepass(static_cast<render::DepthPrepass>(depth_prepass));
 				engine.saveConfig();
 
 				if (save)
@@ -383,7 +416,17 @@ private:
 
 	// Shadow map variables
 	u32 smap_res = 0;
+	u32 smap_atlas_res = 0;
+	u32 smap_cube_map_count = 0;
+	u32 smap_cascade_count = 0;
+	f32 smap_cascade_lambda = 0;
+	f32 smap_cascade_distance = 0;
 	i32 smap_depth_bias = 0;
 	f32 smap_slope_scaled_depth_bias = 0;
 	f32 smap_depth_bias_clamp = 0;
+	bool smap_caching = true;
+	bool smap_static_cache = false;
+
+	// Forward rendering variables
+	int depth_prepass = 0;
 };
\ No newline at end of file
@@ -5,6 +5,8 @@ module;
 #include <imgui.h>
 #include <ImGuizmo.h>
 
+#include "datatypes/scalar_types.h"
+
 module rendering;
 
 namespace render::systems {
@@ -14,7 +16,7 @@ UserInterface::UserInterface(ecs::ECS& ecs, Engine& engine)
 	, engine(engine)
 	, entity_select_connection(ecs.getDispatcher<events::EntitySelectedEvent>().addCallback<&UserInterface::onEntitySelected>(this)) {
 	system_menu           = std::make_unique<SystemMenu>(engine);
-	scene_tree            = std::make_unique<SceneTree>();
+	scene_tree            = std::make_unique<SceneTree>(ecs);
 	entity_details        = std::make_unique<EntityDetailsWindow>();
 	metrics               = std::make_unique<MetricsWindow>(engine);
 	text_editor           = std::make_unique<TextEditWindow>();
@@ -34,7 +36,7 @@ UserInterface::~UserInterface() = default;
 
 UserInterface& UserInterface::operator=(UserInterface&&) noexcept = default;
 
-void UserInterface::update() {
+void UserInterface::frameUpdate(f32 alpha) {
 	//ImGui::ShowDemoWindow();
 	ImGuizmo::BeginFrame();
 
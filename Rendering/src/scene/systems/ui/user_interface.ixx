@@ -5,6 +5,8 @@ module;
 
 #include <imgui.h>
 
+#include "datatypes/scalar_types.h"
+
 export module rendering:systems.user_interface;
 
 import ecs;
@@ -49,7 +51,8 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void update() override;
+	// Draws the UI. Runs once per frame, between the start of the ImGui frame and rendering.
+	void frameUpdate(f32 alpha) override;
 
 	template<typename ComponentT>
 	void registerUserComponent(const UserComponent& component_def) {
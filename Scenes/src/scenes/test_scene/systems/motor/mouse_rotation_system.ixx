@@ -22,6 +22,8 @@ public:
 	MouseRotationSystem(ecs::ECS& ecs, const Input& input)
 		: System(ecs)
 		, input(input) {
+		// Run before the TransformSystem, so the rotation is rendered in the same frame
+		setPriority(render::systems::TransformSystem::system_priority + 10);
 	}
 
 	MouseRotationSystem(const MouseRotationSystem&) = delete;
@@ -44,7 +46,8 @@ public:
 	//----------------------------------------------------------------------------------
 	// Member Functions
 	//----------------------------------------------------------------------------------
-	void update() override {
+	// The mouse delta is per frame, so it's applied once per frame rather than per step
+	void frameUpdate(f32 alpha) override {
 		auto& ecs = this->getECS();
 		const i32_2 mouse_delta = input.get().getMouseDelta();
 
@@ -0,0 +1,20 @@
+#include "hlsl.h"
+#include "include/syntax.hlsli"
+
+
+//----------------------------------------------------------------------------------
+// Depth Restore
+//----------------------------------------------------------------------------------
+//
+// Copies a depth buffer into the bound depth stencil view. Depth resources can only
+// be copied in their entirety, so a region is copied by drawing a quad over it with
+// this shader. The source and destination must have the same size.
+//
+//----------------------------------------------------------------------------------
+
+Texture2D<float> g_depth : REG_T(SLOT_SRV_DEPTH);
+
+
+float PS(float4 position : SV_Position) : SV_Depth {
+	return g_depth[uint2(position.xy)];
+}
\ No newline at end of file
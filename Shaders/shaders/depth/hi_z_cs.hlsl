@@ -0,0 +1,44 @@
+#include "hlsl.h"
+#include "include/syntax.hlsli"
+
+
+//----------------------------------------------------------------------------------
+// Hi-Z Reduction
+//----------------------------------------------------------------------------------
+//
+// Reduces one level of the Hi-Z mip chain to the next. Each output texel holds the
+// farthest depth of the input texels it covers, so a surface behind that depth is
+// hidden. When an input dimension is odd, the output texels cover three input texels
+// on that axis so that none are skipped. The first level is a copy of the depth
+// buffer, where the input and output sizes are equal.
+//
+//----------------------------------------------------------------------------------
+
+cbuffer HiZ : REG_B(SLOT_CBUFFER_HI_Z) {
+	uint2 g_input_size;
+	uint2 g_output_size;
+};
+
+Texture2D<float>   g_input  : REG_T(SLOT_SRV_DEPTH);
+RWTexture2D<float> g_output : REG_U(SLOT_UAV_HI_Z);
+
+
+[numthreads(HI_Z_GROUP_SIZE, HI_Z_GROUP_SIZE, 1)]
+void CS(uint3 id : SV_DispatchThreadID) {
+
+	if (any(id.xy >= g_output_size))
+		return;
+
+	// The range of input texels covered by this texel
+	const uint2 begin = (id.xy * g_input_size) / g_output_size;
+	const uint2 end   = max(((id.xy + 1) * g_input_size + g_output_size - 1) / g_output_size, begin + 1);
+
+	float depth = 0.0f;
+	for (uint y = begin.y; y < end.y; ++y) {
+		for (uint x = begin.x; x < end.x; ++x) {
+			depth = max(depth, g_input.Load(uint3(x, y, 0)));
+		}
+	}
+
+	g_output[id.xy] = depth;
+}
\ No newline at end of file
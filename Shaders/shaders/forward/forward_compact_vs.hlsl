@@ -0,0 +1,19 @@
+#include "forward/forward_include.hlsli"
+#include "include/normal.hlsli"
+#include "include/transform.hlsli"
+
+
+PSPositionNormalTexture VS(VSPositionNormalTextureCompact vin) {
+
+	VSPositionNormalTexture decoded;
+	decoded.p  = vin.p;
+	decoded.n  = DecodeOctahedral(vin.n);
+	decoded.uv = vin.uv;
+
+	return Transform(decoded,
+					 g_model_to_world,
+					 g_world_to_camera,
+					 g_camera_to_projection,
+					 g_world_inv_transpose,
+					 g_tex_transform);
+}
\ No newline at end of file
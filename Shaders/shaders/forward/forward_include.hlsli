@@ -41,10 +41,10 @@ float2 GetMaterialParams(float2 uv) {
 
 
 float3 GetNormal(float3 position, float3 normal, float2 tex) {
-	const float3 sam = g_normal_map.Sample(g_linear_wrap, tex).xyz;
+	const float2 sam = g_normal_map.Sample(g_linear_wrap, tex).xy;
 	
 	// Simply normalize and return the input normal if there was no normal map
-	return sam != float3(0.0f, 0.0f, 0.0f)
+	return any(sam != float2(0.0f, 0.0f))
 		? TransformNormal(position, normal, tex, sam)
 		: normalize(normal);
 }
@@ -24,6 +24,15 @@ struct VSPositionNormalTexture {
 };
 
 
+// The position is quantized to [0, 1] within the mesh's AABB, and mapped back to object
+// space by the object-to-world matrix. The normal is octahedral encoded.
+struct VSPositionNormalTextureCompact {
+	float3 p  : POSITION0;
+	float2 n  : NORMAL0;
+	float2 uv : TEXCOORD0;
+};
+
+
 
 //----------------------------------------------------------------------------------
 //  Pixel Shader input structs
@@ -33,12 +33,31 @@ cbuffer LightBuffer : REG_B(SLOT_CBUFFER_LIGHT) {
 
 	float3 g_ambient_intensity;
 	float  g_lbpad0;
+
+	// Light clusters (disabled if the dimensions are 0)
+	uint3  g_cluster_dims;
+	float  g_lbpad1;
+	float  g_cluster_z_scale;
+	float  g_cluster_z_bias;
+	float2 g_lbpad2;
 };
 
 
 
 namespace detail {
 
+// Get the index of the light cluster that contains a point
+uint GetClusterIndex(float3 p_world) {
+	const float3 p_camera = mul(float4(p_world, 1.0f), g_world_to_camera).xyz;
+	const float4 p_clip   = mul(float4(p_camera, 1.0f), g_camera_to_projection);
+	const float2 uv       = float2(0.5f, -0.5f) * (p_clip.xy / p_clip.w) + 0.5f;
+
+	const uint2 tile  = min(uint2(saturate(uv) * g_cluster_dims.xy), g_cluster_dims.xy - 1);
+	const float slice = log(max(p_camera.z, 0.0001f)) * g_cluster_z_scale + g_cluster_z_bias;
+
+	return (uint(clamp(slice, 0.0f, g_cluster_dims.z - 1)) * g_cluster_dims.y + tile.y) * g_cluster_dims.x + tile.x;
+}
+
 // Calculate the radiance contributed by a light
 float3 CalculateLight(iLight light,
                       float3 p_world,
@@ -93,14 +112,32 @@ float3 CalculateLights(float3 p_world,
 		radiance += CalculateLight(g_directional_lights[i0], p_world, n, p_to_view, mat);
 	}
 
-	// Point Lights
-	for (uint i1 = 0; i1 < g_num_point_lights; ++i1) {
-		radiance += CalculateLight(g_point_lights[i1], p_world, n, p_to_view, mat);
+	// Only iterate over the point and spot lights in the point's cluster, if clustering is enabled
+	if (g_cluster_dims.x != 0) {
+		const uint2 cluster          = g_light_clusters[GetClusterIndex(p_world)];
+		const uint  num_point_lights = cluster.y & 0xFFFF;
+		const uint  num_spot_lights  = cluster.y >> 16;
+
+		// Point Lights
+		for (uint i1 = 0; i1 < num_point_lights; ++i1) {
+			radiance += CalculateLight(g_point_lights[g_light_indices[cluster.x + i1]], p_world, n, p_to_view, mat);
+		}
+
+		// Spot lights
+		for (uint i2 = 0; i2 < num_spot_lights; ++i2) {
+			radiance += CalculateLight(g_spot_lights[g_light_indices[cluster.x + num_point_lights + i2]], p_world, n, p_to_view, mat);
+		}
 	}
-
-	// Spot lights
-	for (uint i2 = 0; i2 < g_num_spot_lights; ++i2) {
-		radiance += CalculateLight(g_spot_lights[i2], p_world, n, p_to_view, mat);
+	else {
+		// Point Lights
+		for (uint i1 = 0; i1 < g_num_point_lights; ++i1) {
+			radiance += CalculateLight(g_point_lights[i1], p_world, n, p_to_view, mat);
+		}
+
+		// Spot lights
+		for (uint i2 = 0; i2 < g_num_spot_lights; ++i2) {
+			radiance += CalculateLight(g_spot_lights[i2], p_world, n, p_to_view, mat);
+		}
 	}
 
 	return radiance;
@@ -120,7 +157,7 @@ float3 CalculateShadowLights(float3 p_world,
 		#ifdef DISABLE_SHADOW_MAPPING
 			radiance += CalculateLight(g_shadow_directional_lights[i0], p_world, n, p_to_view, mat);
 		#else
-			const ShadowMap shadow_map = {g_pcf_sampler, g_directional_light_smaps, i0};
+			const ShadowMap shadow_map = {g_pcf_sampler, g_directional_light_smaps, float4(0.0f, 0.0f, 1.0f, 1.0f)};
 			radiance += CalculateLight(g_shadow_directional_lights[i0], shadow_map, p_world, n, p_to_view, mat);
 		#endif
 	}
@@ -140,7 +177,7 @@ float3 CalculateShadowLights(float3 p_world,
 		#ifdef DISABLE_SHADOW_MAPPING
 			radiance += CalculateLight(g_shadow_spot_lights[i2], p_world, n, p_to_view, mat);
 		#else
-			const ShadowMap shadow_map = {g_pcf_sampler, g_spot_light_smaps, i2};
+			const ShadowMap shadow_map = {g_pcf_sampler, g_spot_light_smaps, g_shadow_spot_lights[i2].smap_tile};
 			radiance += CalculateLight(g_shadow_spot_lights[i2], shadow_map, p_world, n, p_to_view, mat);
 		#endif
 	}
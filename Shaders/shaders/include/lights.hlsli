@@ -44,19 +44,30 @@ float SpotIntensity(float3 L, float3 D, float cos_theta, float cos_phi) {
 
 interface iShadowMap {
 	float ShadowFactor(float3 p_ndc);
+	float ShadowFactor(float3 p_ndc, float4 tile);
 	float ShadowFactor(float3 p_light, float2 projection_values);
 };
 
+// A tile within a shadow atlas. The tile is defined by its uv offset (xy) and scale (zw).
 struct ShadowMap : iShadowMap {
 	SamplerComparisonState sam_shadow;
-	Texture2DArray maps;
-	uint index;
+	Texture2D atlas;
+	float4 tile;
 
 	float ShadowFactor(float3 p_ndc) {
-		const float2 uv       = float2(0.5f, -0.5f) * p_ndc.xy + 0.5f;
-		const float3 location = {uv, index};
+		return ShadowFactor(p_ndc, tile);
+	}
+
+	float ShadowFactor(float3 p_ndc, float4 tile_override) {
+		float2 atlas_size;
+		atlas.GetDimensions(atlas_size.x, atlas_size.y);
 
-		return maps.SampleCmpLevelZero(sam_shadow, location, p_ndc.z);
+		// Keep the filter footprint inside the tile so neighboring tiles don't bleed in
+		const float2 half_texel = 0.5f / (atlas_size * tile_override.zw);
+		const float2 uv         = clamp(float2(0.5f, -0.5f) * p_ndc.xy + 0.5f, half_texel, 1.0f - half_texel);
+		const float2 location   = tile_override.xy + (uv * tile_override.zw);
+
+		return atlas.SampleCmpLevelZero(sam_shadow, location, p_ndc.z);
 	}
 
 	float ShadowFactor(float3 p_light, float2 projection_values) {
@@ -74,6 +85,10 @@ struct ShadowCubeMap : iShadowMap {
 		return 0.0f;
 	}
 
+	float ShadowFactor(float3 p_ndc, float4 tile) {
+		return 0.0f;
+	}
+
 	float ShadowFactor(float3 p_light, float2 projection_values) {
 		const float3 p_light_abs = abs(p_light);
 
@@ -107,7 +122,7 @@ interface iShadowLight {
 // Directional Light
 //----------------------------------------------------------------------------------
 
-struct DirectionalLight : iLight, iShadowLight {
+struct DirectionalLight : iLight {
 	float3 intensity;
 	float  pad0;
 	float3 direction;
@@ -139,16 +154,41 @@ struct DirectionalLight : iLight, iShadowLight {
 		irradiance = irradiance0;
 	}
 
+};
+
+
+struct ShadowDirectionalLight : DirectionalLight, iShadowLight {
+	uint   num_cascades;
+	float3 pad2;
+	matrix cascade_world_to_projection[MAX_SHADOW_CASCADES];
+	float4 smap_tiles[MAX_SHADOW_CASCADES];
+
+	void Calculate(float3 p_world, out float3 p_to_light, out float3 irradiance) {
+		DirectionalLight::Calculate(p_world, p_to_light, irradiance);
+	}
+
 	void Calculate(iShadowMap shadow_map, float3 p_world, out float3 p_to_light, out float3 irradiance) {
-		float3 p_ndc;
 		float3 p_to_l0;
 		float3 irradiance0;
 
-		Calculate(p_world, p_to_l0, irradiance0, p_ndc);
+		DirectionalLight::Calculate(p_world, p_to_l0, irradiance0);
 
 		p_to_light = p_to_l0;
 
-		const float shadow_factor = shadow_map.ShadowFactor(p_ndc);
+		// Use the first cascade that contains the point. Points outside of every cascade
+		// are beyond the shadow distance and aren't shadowed.
+		float shadow_factor = 1.0f;
+
+		for (uint i = 0; i < num_cascades; ++i) {
+			const float4 p_clip = mul(float4(p_world, 1.0f), cascade_world_to_projection[i]);
+			const float3 p_ndc  = PerspectiveDiv(p_clip);
+
+			if (all(abs(p_ndc.xy) <= 1.0f) && (p_ndc.z >= 0.0f) && (p_ndc.z <= 1.0f)) {
+				shadow_factor = shadow_map.ShadowFactor(p_ndc, smap_tiles[i]);
+				break;
+			}
+		}
+
 		irradiance = irradiance0 * shadow_factor;
 	}
 };
@@ -255,6 +295,7 @@ struct SpotLight : iLight {
 
 struct ShadowSpotLight : SpotLight, iShadowLight {
 	matrix world_to_projection;
+	float4 smap_tile;
 
 	void Calculate(float3 p_world, out float3 p_to_light, out float3 irradiance) {
 		SpotLight::Calculate(p_world, p_to_light, irradiance);
@@ -290,14 +331,20 @@ StructuredBuffer<SpotLight> g_spot_lights : REG_T(SLOT_SRV_SPOT_LIGHTS);
 
 
 // Shadow Lights
-StructuredBuffer<DirectionalLight> g_shadow_directional_lights : REG_T(SLOT_SRV_DIRECTIONAL_LIGHTS_SHADOW);
-Texture2DArray g_directional_light_smaps : REG_T(SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS);
+StructuredBuffer<ShadowDirectionalLight> g_shadow_directional_lights : REG_T(SLOT_SRV_DIRECTIONAL_LIGHTS_SHADOW);
+Texture2D g_directional_light_smaps : REG_T(SLOT_SRV_DIRECTIONAL_LIGHT_SHADOW_MAPS);
 
 StructuredBuffer<ShadowPointLight> g_shadow_point_lights : REG_T(SLOT_SRV_POINT_LIGHTS_SHADOW);
 TextureCubeArray g_point_light_smaps : REG_T(SLOT_SRV_POINT_LIGHT_SHADOW_MAPS);
 
 StructuredBuffer<ShadowSpotLight> g_shadow_spot_lights : REG_T(SLOT_SRV_SPOT_LIGHTS_SHADOW);
-Texture2DArray g_spot_light_smaps : REG_T(SLOT_SRV_SPOT_LIGHT_SHADOW_MAPS);
+Texture2D g_spot_light_smaps : REG_T(SLOT_SRV_SPOT_LIGHT_SHADOW_MAPS);
+
+
+// Light Clusters. Each cluster is an offset into the light index list, and the
+// number of point lights (low 16 bits) and spot lights (high 16 bits) it contains.
+StructuredBuffer<uint2> g_light_clusters : REG_T(SLOT_SRV_LIGHT_CLUSTERS);
+StructuredBuffer<uint> g_light_indices : REG_T(SLOT_SRV_LIGHT_INDICES);
 
 
 
@@ -24,15 +24,31 @@ float3x3 ComputeTBN(float3 position, float3 normal, float2 tex) {
 	return float3x3(T * invmax, B * invmax, normal);
 }
 
-float3 TransformNormal(float3x3 TBN, float3 normal_map_sample) {
-	const float3 tex_normal = UNormToSNorm(normal_map_sample);
+// Reconstruct a tangent space normal from the x and y components of a normal map. Normal maps
+// may be BC5 compressed, which only stores two channels.
+float3 UnpackNormalMapSample(float2 normal_map_sample) {
+	const float2 xy = UNormToSNorm(normal_map_sample);
+	return float3(xy, sqrt(saturate(1.0f - dot(xy, xy))));
+}
+
+float3 TransformNormal(float3x3 TBN, float2 normal_map_sample) {
+	const float3 tex_normal = UnpackNormalMapSample(normal_map_sample);
 	return normalize(mul(tex_normal, TBN));
 }
 
-float3 TransformNormal(float3 position, float3 normal, float2 tex, float3 normal_map_sample) {
+float3 TransformNormal(float3 position, float3 normal, float2 tex, float2 normal_map_sample) {
 	const float3x3 TBN = ComputeTBN(position, normal, tex);
 	return TransformNormal(TBN, normal_map_sample);
 }
 
 
+// Decode an octahedral encoded unit vector
+float3 DecodeOctahedral(float2 e) {
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	const float t = saturate(-n.z);
+	n.xy += (n.xy >= 0.0f) ? -t : t;
+	return normalize(n);
+}
+
+
 #endif //HLSL_NORMAL
\ No newline at end of file
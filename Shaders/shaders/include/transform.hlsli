@@ -10,15 +10,16 @@ float2 Transform(float2 tex, matrix tex_transform) {
 }
 
 
-// Transform a point from object space to projection space
+// Transform a point from object space to projection space. The result is precise, so the
+// depth pre-pass computes the same depth as the shading passes.
 float4 Transform(float3 position,
 				 matrix object_to_world,
 				 matrix world_to_view,
 				 matrix view_to_projection) {
 
-	const float3 world = mul(float4(position, 1.0f), object_to_world).xyz;
-	const float3 view  = mul(float4(world, 1.0f), world_to_view).xyz;
-	const float4 proj  = mul(float4(view, 1.0f), view_to_projection);
+	precise const float3 world = mul(float4(position, 1.0f), object_to_world).xyz;
+	precise const float3 view  = mul(float4(world, 1.0f), world_to_view).xyz;
+	precise const float4 proj  = mul(float4(view, 1.0f), view_to_projection);
 
 	return proj;
 }
@@ -46,14 +47,17 @@ PSPositionNormalTexture Transform(VSPositionNormalTexture vin,
 	PSPositionNormalTexture vout;
 
 	// Transform to world space
-	vout.p_world = mul(float4(vin.p, 1.0f), object_to_world).xyz;
+	precise const float3 p_world = mul(float4(vin.p, 1.0f), object_to_world).xyz;
+	vout.p_world = p_world;
 
 	// Normal
 	vout.n = normalize(mul(vin.n, (float3x3)world_inv_transpose));
 
-	// Transform to homogeneous clip space
-	const float3 p_view = mul(float4(vout.p_world, 1.0f), world_to_view).xyz;
-	vout.p = mul(float4(p_view, 1.0f), view_to_projection);
+	// Transform to homogeneous clip space. Precise, like the position-only transform, so an
+	// equal depth test against the depth pre-pass passes.
+	precise const float3 p_view = mul(float4(p_world, 1.0f), world_to_view).xyz;
+	precise const float4 p_proj = mul(float4(p_view, 1.0f), view_to_projection);
+	vout.p = p_proj;
 
 	// Output vertex attributes for interpolation across triangle
 	vout.uv = Transform(vin.uv, texture_transform);
@@ -14,6 +14,12 @@
 // 8/255
 #define ALPHA_SHADOW_THRESHOLD 0.03137254f
 
+// The maximum number of shadow cascades a directional light can have
+#define MAX_SHADOW_CASCADES 4
+
+// The width and height of a Hi-Z compute shader thread group
+#define HI_Z_GROUP_SIZE 8
+
 
 //----------------------------------------------------------------------------------
 // Constant Buffers
@@ -25,6 +31,7 @@
 #define SLOT_CBUFFER_COLOR      4
 #define SLOT_CBUFFER_MODEL      5
 #define SLOT_CBUFFER_LIGHT      6
+#define SLOT_CBUFFER_HI_Z       7
 
 
 //----------------------------------------------------------------------------------
@@ -70,6 +77,20 @@
 #define SLOT_SRV_POINT_LIGHT_SHADOW_MAPS       14
 #define SLOT_SRV_SPOT_LIGHT_SHADOW_MAPS        15
 
+// Light Clusters
+#define SLOT_SRV_LIGHT_CLUSTERS 16
+#define SLOT_SRV_LIGHT_INDICES  17
+
+// Hi-Z mip chain of the depth pre-pass
+#define SLOT_SRV_HI_Z 18
+
+
+//----------------------------------------------------------------------------------
+// UAVs
+//----------------------------------------------------------------------------------
+
+#define SLOT_UAV_HI_Z 0
+
 
 
 #endif //HLSL_DEFINES
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <d3d11.h>
+
+#include "datatypes/scalar_types.h"
+
+
+//----------------------------------------------------------------------------------
+// CountingDeviceContext
+//----------------------------------------------------------------------------------
+//
+// A device context that doesn't talk to a device. It counts the binds made on it and
+// records the slot range of the last multi-slot bind, so code that filters binds can
+// be tested without a GPU. Every other call is ignored.
+//
+// The objects bound to it are never dereferenced, so tests can bind fake addresses
+// (see FakeObject).
+//
+//----------------------------------------------------------------------------------
+class CountingDeviceContext final : public ID3D11DeviceContext {
+public:
+
+	// The number of Set calls of each kind
+	struct Counts {
+		u32 shaders           = 0;
+		u32 constant_buffers  = 0;
+		u32 srvs              = 0;
+		u32 samplers          = 0;
+		u32 uavs              = 0;
+		u32 vertex_buffers    = 0;
+		u32 index_buffers     = 0;
+		u32 input_layouts     = 0;
+		u32 topologies        = 0;
+		u32 blend_states      = 0;
+		u32 depth_states      = 0;
+		u32 rasterizer_states = 0;
+		u32 render_targets    = 0;
+	};
+
+	// The slots passed to the last multi-slot bind
+	struct SlotRange {
+		u32 start = 0;
+		u32 count = 0;
+	};
+
+	Counts    counts;
+	SlotRange last_range;
+
+	//----------------------------------------------------------------------------------
+	// IUnknown
+	//----------------------------------------------------------------------------------
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override {
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+	//----------------------------------------------------------------------------------
+	// ID3D11DeviceChild
+	//----------------------------------------------------------------------------------
+	void STDMETHODCALLTYPE GetDevice(ID3D11Device** device) override { *device = nullptr; }
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+
+	//----------------------------------------------------------------------------------
+	// Shader Stages
+	//----------------------------------------------------------------------------------
+#define COUNTING_CONTEXT_STAGE(prefix, ShaderT)                                                                         \
+	void STDMETHODCALLTYPE prefix##SetShader(ShaderT*, ID3D11ClassInstance* const*, UINT) override {                    \
+		++counts.shaders;                                                                                               \
+	}                                                                                                                   \
+	void STDMETHODCALLTYPE prefix##SetConstantBuffers(UINT start, UINT count, ID3D11Buffer* const*) override {          \
+		record(counts.constant_buffers, start, count);                                                                  \
+	}                                                                                                                   \
+	void STDMETHODCALLTYPE prefix##SetShaderResources(UINT start, UINT count, ID3D11ShaderResourceView* const*) override { \
+		record(counts.srvs, start, count);                                                                              \
+	}                                                                                                                   \
+	void STDMETHODCALLTYPE prefix##SetSamplers(UINT start, UINT count, ID3D11SamplerState* const*) override {           \
+		record(counts.samplers, start, count);                                                                          \
+	}                                                                                                                   \
+	void STDMETHODCALLTYPE prefix##GetShader(ShaderT**, ID3D11ClassInstance**, UINT*) override {}                       \
+	void STDMETHODCALLTYPE prefix##GetConstantBuffers(UINT, UINT, ID3D11Buffer**) override {}                           \
+	void STDMETHODCALLTYPE prefix##GetShaderResources(UINT, UINT, ID3D11ShaderResourceView**) override {}               \
+	void STDMETHODCALLTYPE prefix##GetSamplers(UINT, UINT, ID3D11SamplerState**) override {}
+
+	COUNTING_CONTEXT_STAGE(CS, ID3D11ComputeShader)
+	COUNTING_CONTEXT_STAGE(DS, ID3D11DomainShader)
+	COUNTING_CONTEXT_STAGE(GS, ID3D11GeometryShader)
+	COUNTING_CONTEXT_STAGE(HS, ID3D11HullShader)
+	COUNTING_CONTEXT_STAGE(PS, ID3D11PixelShader)
+	COUNTING_CONTEXT_STAGE(VS, ID3D11VertexShader)
+
+#undef COUNTING_CONTEXT_STAGE
+
+	void STDMETHODCALLTYPE CSSetUnorderedAccessViews(UINT start, UINT count, ID3D11UnorderedAccessView* const*, const UINT*) override {
+		record(counts.uavs, start, count);
+	}
+	void STDMETHODCALLTYPE CSGetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView**) override {}
+
+	//----------------------------------------------------------------------------------
+	// Input Assembler
+	//----------------------------------------------------------------------------------
+	void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*) override { ++counts.input_layouts; }
+	void STDMETHODCALLTYPE IASetVertexBuffers(UINT start, UINT count, ID3D11Buffer* const*, const UINT*, const UINT*) override {
+		record(counts.vertex_buffers, start, count);
+	}
+	void STDMETHODCALLTYPE IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT) override { ++counts.index_buffers; }
+	void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override { ++counts.topologies; }
+
+	void STDMETHODCALLTYPE IAGetInputLayout(ID3D11InputLayout**) override {}
+	void STDMETHODCALLTYPE IAGetVertexBuffers(UINT, UINT, ID3D11Buffer**, UINT*, UINT*) override {}
+	void STDMETHODCALLTYPE IAGetIndexBuffer(ID3D11Buffer**, DXGI_FORMAT*, UINT*) override {}
+	void STDMETHODCALLTYPE IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY*) override {}
+
+	//----------------------------------------------------------------------------------
+	// Rasterizer and Output Merger
+	//----------------------------------------------------------------------------------
+	void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*) override { ++counts.rasterizer_states; }
+	void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*) override {}
+	void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D11_RECT*) override {}
+	void STDMETHODCALLTYPE RSGetState(ID3D11RasterizerState**) override {}
+	void STDMETHODCALLTYPE RSGetViewports(UINT*, D3D11_VIEWPORT*) override {}
+	void STDMETHODCALLTYPE RSGetScissorRects(UINT*, D3D11_RECT*) override {}
+
+	void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override {
+		++counts.render_targets;
+	}
+	void STDMETHODCALLTYPE OMSetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*,
+	                                                                 UINT, UINT, ID3D11UnorderedAccessView* const*, const UINT*) override {
+		++counts.render_targets;
+	}
+	void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT) override { ++counts.blend_states; }
+	void STDMETHODCALLTYPE OMSetDepthStencilState(ID3D11DepthStencilState*, UINT) override { ++counts.depth_states; }
+
+	void STDMETHODCALLTYPE OMGetRenderTargets(UINT, ID3D11RenderTargetView**, ID3D11DepthStencilView**) override {}
+	void STDMETHODCALLTYPE OMGetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView**, ID3D11DepthStencilView**,
+	                                                                 UINT, UINT, ID3D11UnorderedAccessView**) override {}
+	void STDMETHODCALLTYPE OMGetBlendState(ID3D11BlendState**, FLOAT[4], UINT*) override {}
+	void STDMETHODCALLTYPE OMGetDepthStencilState(ID3D11DepthStencilState**, UINT*) override {}
+
+	//----------------------------------------------------------------------------------
+	// Ignored
+	//----------------------------------------------------------------------------------
+	void STDMETHODCALLTYPE Draw(UINT, UINT) override {}
+	void STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT) override {}
+	void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) override {}
+	void STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override {}
+	void STDMETHODCALLTYPE DrawAuto() override {}
+	void STDMETHODCALLTYPE DrawInstancedIndirect(ID3D11Buffer*, UINT) override {}
+	void STDMETHODCALLTYPE DrawIndexedInstancedIndirect(ID3D11Buffer*, UINT) override {}
+	void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) override {}
+	void STDMETHODCALLTYPE DispatchIndirect(ID3D11Buffer*, UINT) override {}
+
+	HRESULT STDMETHODCALLTYPE Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) override { return E_NOTIMPL; }
+	void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT) override {}
+
+	void STDMETHODCALLTYPE Begin(ID3D11Asynchronous*) override {}
+	void STDMETHODCALLTYPE End(ID3D11Asynchronous*) override {}
+	HRESULT STDMETHODCALLTYPE GetData(ID3D11Asynchronous*, void*, UINT, UINT) override { return E_NOTIMPL; }
+	void STDMETHODCALLTYPE SetPredication(ID3D11Predicate*, BOOL) override {}
+	void STDMETHODCALLTYPE GetPredication(ID3D11Predicate**, BOOL*) override {}
+
+	void STDMETHODCALLTYPE SOSetTargets(UINT, ID3D11Buffer* const*, const UINT*) override {}
+	void STDMETHODCALLTYPE SOGetTargets(UINT, ID3D11Buffer**) override {}
+
+	void STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX*) override {}
+	void STDMETHODCALLTYPE CopyResource(ID3D11Resource*, ID3D11Resource*) override {}
+	void STDMETHODCALLTYPE UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT) override {}
+	void STDMETHODCALLTYPE CopyStructureCount(ID3D11Buffer*, UINT, ID3D11UnorderedAccessView*) override {}
+	void STDMETHODCALLTYPE ResolveSubresource(ID3D11Resource*, UINT, ID3D11Resource*, UINT, DXGI_FORMAT) override {}
+
+	void STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override {}
+	void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView*, const UINT[4]) override {}
+	void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(ID3D11UnorderedAccessView*, const FLOAT[4]) override {}
+	void STDMETHODCALLTYPE ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8) override {}
+
+	void STDMETHODCALLTYPE GenerateMips(ID3D11ShaderResourceView*) override {}
+	void STDMETHODCALLTYPE SetResourceMinLOD(ID3D11Resource*, FLOAT) override {}
+	FLOAT STDMETHODCALLTYPE GetResourceMinLOD(ID3D11Resource*) override { return 0.0f; }
+
+	void STDMETHODCALLTYPE ExecuteCommandList(ID3D11CommandList*, BOOL) override {}
+	void STDMETHODCALLTYPE ClearState() override {}
+	void STDMETHODCALLTYPE Flush() override {}
+	D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE GetType() override { return D3D11_DEVICE_CONTEXT_IMMEDIATE; }
+	UINT STDMETHODCALLTYPE GetContextFlags() override { return 0; }
+	HRESULT STDMETHODCALLTYPE FinishCommandList(BOOL, ID3D11CommandList** command_list) override {
+		*command_list = nullptr;
+		return E_NOTIMPL;
+	}
+
+private:
+
+	void record(u32& count, UINT start, UINT slot_count) noexcept {
+		++count;
+		last_range = SlotRange{start, slot_count};
+	}
+};
+
+
+// A unique address to bind in place of a D3D object. Never dereferenced.
+template<typename T>
+[[nodiscard]]
+T* FakeObject(uintptr_t id) noexcept {
+	return reinterpret_cast<T*>(id * 0x100);
+}
\ No newline at end of file
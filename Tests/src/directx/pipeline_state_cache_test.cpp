@@ -0,0 +1,284 @@
+#include <d3d11.h>
+
+#include "datatypes/scalar_types.h"
+#include "counting_device_context.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+
+
+namespace {
+
+// Gives a device context a state cache for the duration of a test. The Pipeline's cache
+// is global, so it must not outlive the test.
+class ScopedStateCache {
+public:
+	explicit ScopedStateCache(ID3D11DeviceContext& device_context) : device_context(device_context) {
+		Pipeline::setStateCache(device_context, &cache);
+	}
+
+	ScopedStateCache(const ScopedStateCache&) = delete;
+
+	~ScopedStateCache() {
+		Pipeline::setStateCache(device_context, nullptr);
+	}
+
+	ScopedStateCache& operator=(const ScopedStateCache&) = delete;
+
+	[[nodiscard]]
+	PipelineStateCache& get() noexcept {
+		return cache;
+	}
+
+private:
+	ID3D11DeviceContext& device_context;
+	PipelineStateCache   cache;
+};
+
+}
+
+
+//----------------------------------------------------------------------------------
+// PipelineStateCache
+//----------------------------------------------------------------------------------
+
+TEST(PipelineIssuesEveryBindWithoutCache) {
+	CountingDeviceContext context;
+	CHECK(Pipeline::getStateCache(context) == nullptr);
+
+	auto* shader = FakeObject<ID3D11PixelShader>(1);
+	auto* srv    = FakeObject<ID3D11ShaderResourceView>(2);
+
+	for (u32 i = 0; i < 3; ++i) {
+		Pipeline::PS::bindShader(context, shader, {});
+		Pipeline::PS::bindSRV(context, 0, srv);
+		Pipeline::RS::bindState(context, nullptr);
+	}
+
+	CHECK(context.counts.shaders == 3);
+	CHECK(context.counts.srvs == 3);
+	CHECK(context.counts.rasterizer_states == 3);
+}
+
+
+TEST(PipelineSkipsRepeatedBinds) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* shader = FakeObject<ID3D11PixelShader>(1);
+	auto* buffer = FakeObject<ID3D11Buffer>(2);
+	auto* layout = FakeObject<ID3D11InputLayout>(3);
+
+	for (u32 i = 0; i < 3; ++i) {
+		Pipeline::PS::bindShader(context, shader, {});
+		Pipeline::PS::bindConstantBuffer(context, 1, buffer);
+		Pipeline::IA::bindInputLayout(context, layout);
+		Pipeline::IA::bindPrimitiveTopology(context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		Pipeline::OM::bindDepthStencilState(context, nullptr, 0);
+	}
+
+	CHECK(context.counts.shaders == 1);
+	CHECK(context.counts.constant_buffers == 1);
+	CHECK(context.counts.input_layouts == 1);
+	CHECK(context.counts.topologies == 1);
+	CHECK(context.counts.depth_states == 1);
+
+	const auto& stats = cache.get().getStats();
+	CHECK(stats.shaders.issued == 1);
+	CHECK(stats.shaders.skipped == 2);
+	CHECK(stats.constant_buffers.skipped == 2);
+	CHECK(stats.input_assembler.issued == 2);
+	CHECK(stats.input_assembler.skipped == 4);
+	CHECK(stats.states.skipped == 2);
+
+	const auto total = cache.get().resetStats().getTotal();
+	CHECK(total.issued == 5);
+	CHECK(total.skipped == 10);
+	CHECK(cache.get().getStats().getTotal().issued == 0);
+
+	// A different value is issued
+	Pipeline::OM::bindDepthStencilState(context, nullptr, 1);
+	CHECK(context.counts.depth_states == 2);
+}
+
+
+TEST(PipelineTracksStagesSeparately) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* srv = FakeObject<ID3D11ShaderResourceView>(1);
+
+	// Each stage has its own slots
+	Pipeline::bindSRV(context, 0, srv);
+	CHECK(context.counts.srvs == 6);
+
+	Pipeline::bindSRV(context, 0, srv);
+	Pipeline::PS::bindSRV(context, 0, srv);
+	CHECK(context.counts.srvs == 6);
+
+	Pipeline::VS::bindSRV(context, 1, srv);
+	CHECK(context.counts.srvs == 7);
+}
+
+
+TEST(PipelineTrimsSlotRanges) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	ID3D11ShaderResourceView* const first[4] = {
+		FakeObject<ID3D11ShaderResourceView>(1),
+		FakeObject<ID3D11ShaderResourceView>(2),
+		FakeObject<ID3D11ShaderResourceView>(3),
+		FakeObject<ID3D11ShaderResourceView>(4),
+	};
+	Pipeline::PS::bindSRVs(context, 2, first);
+	CHECK(context.counts.srvs == 1);
+	CHECK(context.last_range.start == 2);
+	CHECK(context.last_range.count == 4);
+
+	// Only the slots between the first and last changed slot are bound
+	ID3D11ShaderResourceView* const second[4] = {
+		first[0],
+		FakeObject<ID3D11ShaderResourceView>(5),
+		FakeObject<ID3D11ShaderResourceView>(6),
+		first[3],
+	};
+	Pipeline::PS::bindSRVs(context, 2, second);
+	CHECK(context.counts.srvs == 2);
+	CHECK(context.last_range.start == 3);
+	CHECK(context.last_range.count == 2);
+
+	// An unchanged range isn't bound at all
+	Pipeline::PS::bindSRVs(context, 2, second);
+	CHECK(context.counts.srvs == 2);
+}
+
+
+TEST(PipelineTrimsVertexBuffers) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	ID3D11Buffer* const buffers[3] = {
+		FakeObject<ID3D11Buffer>(1),
+		FakeObject<ID3D11Buffer>(2),
+		FakeObject<ID3D11Buffer>(3),
+	};
+	const u32 strides[3] = {12, 16, 8};
+	u32       offsets[3] = {0, 0, 0};
+
+	Pipeline::IA::bindVertexBuffers(context, 0, buffers, strides, offsets);
+	Pipeline::IA::bindVertexBuffers(context, 0, buffers, strides, offsets);
+	CHECK(context.counts.vertex_buffers == 1);
+
+	// A buffer is identified by its stride and offset too
+	offsets[1] = 64;
+	Pipeline::IA::bindVertexBuffers(context, 0, buffers, strides, offsets);
+	CHECK(context.counts.vertex_buffers == 2);
+	CHECK(context.last_range.start == 1);
+	CHECK(context.last_range.count == 1);
+
+	// Missing strides or offsets can't be tracked, so the bind is issued
+	Pipeline::IA::bindVertexBuffers(context, 0, buffers, nullptr, nullptr);
+	Pipeline::IA::bindVertexBuffers(context, 0, buffers, strides, offsets);
+	CHECK(context.counts.vertex_buffers == 4);
+}
+
+
+TEST(PipelineIssuesOutOfRangeSlots) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* sampler = FakeObject<ID3D11SamplerState>(1);
+
+	// The device context reports the error, so the cache must not swallow the bind
+	constexpr u32 slot = D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT;
+	Pipeline::PS::bindSampler(context, slot, sampler);
+	Pipeline::PS::bindSampler(context, slot, sampler);
+	CHECK(context.counts.samplers == 2);
+}
+
+
+TEST(PipelineRebindsSRVsAfterOutputBinds) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* srv    = FakeObject<ID3D11ShaderResourceView>(1);
+	auto* rtv    = FakeObject<ID3D11RenderTargetView>(2);
+	auto* shader = FakeObject<ID3D11PixelShader>(3);
+
+	Pipeline::PS::bindShader(context, shader, {});
+	Pipeline::PS::bindSRV(context, 0, srv);
+
+	// The context unbinds SRVs of a resource bound as a render target, so the cache
+	// forgets the bound SRVs. Other state is kept.
+	Pipeline::OM::bindRTVAndDSV(context, rtv, nullptr);
+	Pipeline::OM::bindRTVAndDSV(context, rtv, nullptr);
+	CHECK(context.counts.render_targets == 2);
+	CHECK(cache.get().getStats().output_merger.issued == 2);
+
+	Pipeline::PS::bindShader(context, shader, {});
+	Pipeline::PS::bindSRV(context, 0, srv);
+	CHECK(context.counts.shaders == 1);
+	CHECK(context.counts.srvs == 2);
+}
+
+
+TEST(PipelineRebindsAfterInvalidate) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* shader = FakeObject<ID3D11VertexShader>(1);
+	auto* state  = FakeObject<ID3D11RasterizerState>(2);
+
+	Pipeline::VS::bindShader(context, shader, {});
+	Pipeline::RS::bindState(context, state);
+
+	// e.g. after SpriteBatch binds its own state
+	Pipeline::invalidateState(context);
+
+	Pipeline::VS::bindShader(context, shader, {});
+	Pipeline::RS::bindState(context, state);
+	CHECK(context.counts.shaders == 2);
+	CHECK(context.counts.rasterizer_states == 2);
+}
+
+
+TEST(PipelineCachesOneContext) {
+	CountingDeviceContext context;
+	CountingDeviceContext other_context;
+	ScopedStateCache cache(context);
+
+	CHECK(Pipeline::getStateCache(context) == &cache.get());
+	CHECK(Pipeline::getStateCache(other_context) == nullptr);
+
+	auto* shader = FakeObject<ID3D11PixelShader>(1);
+	for (u32 i = 0; i < 2; ++i) {
+		Pipeline::PS::bindShader(context, shader, {});
+		Pipeline::PS::bindShader(other_context, shader, {});
+	}
+
+	CHECK(context.counts.shaders == 1);
+	CHECK(other_context.counts.shaders == 2);
+	CHECK(cache.get().getStats().shaders.issued == 1);
+}
+
+
+TEST(PipelineTreatsNullBlendFactorAsOne) {
+	CountingDeviceContext context;
+	ScopedStateCache cache(context);
+
+	auto* state = FakeObject<ID3D11BlendState>(1);
+	constexpr f32 ones[4]   = {1.0f, 1.0f, 1.0f, 1.0f};
+	constexpr f32 halves[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+
+	Pipeline::OM::bindBlendState(context, state, nullptr, 0xFFFFFFFF);
+	Pipeline::OM::bindBlendState(context, state, ones, 0xFFFFFFFF);
+	CHECK(context.counts.blend_states == 1);
+
+	Pipeline::OM::bindBlendState(context, state, halves, 0xFFFFFFFF);
+	Pipeline::OM::bindBlendState(context, state, halves, 0x0000FFFF);
+	CHECK(context.counts.blend_states == 3);
+}
\ No newline at end of file
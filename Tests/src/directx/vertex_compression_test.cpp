@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+#include "test.h"
+
+import math.geometry;
+import rendering;
+
+using namespace DirectX;
+using namespace render;
+
+
+namespace {
+
+// Directions spread evenly over the sphere, plus the axes and the diagonals of the
+// octahedron's folds
+[[nodiscard]]
+std::vector<f32_3> CreateTestDirections() {
+	std::vector<f32_3> directions = {
+		{ 1.0f,  0.0f,  0.0f}, {-1.0f,  0.0f,  0.0f},
+		{ 0.0f,  1.0f,  0.0f}, { 0.0f, -1.0f,  0.0f},
+		{ 0.0f,  0.0f,  1.0f}, { 0.0f,  0.0f, -1.0f},
+	};
+
+	for (f32 x : {-1.0f, 1.0f}) {
+		for (f32 y : {-1.0f, 1.0f}) {
+			for (f32 z : {-1.0f, 1.0f}) {
+				const f32 inv_length = 1.0f / std::sqrt(3.0f);
+				directions.push_back(f32_3{x * inv_length, y * inv_length, z * inv_length});
+			}
+		}
+	}
+
+	// Fibonacci sphere
+	constexpr u32 count = 1000;
+	const f32 golden_angle = XM_PI * (3.0f - std::sqrt(5.0f));
+	for (u32 i = 0; i < count; ++i) {
+		const f32 z      = 1.0f - ((2.0f * (static_cast<f32>(i) + 0.5f)) / static_cast<f32>(count));
+		const f32 radius = std::sqrt(1.0f - (z * z));
+		const f32 theta  = golden_angle * static_cast<f32>(i);
+		directions.push_back(f32_3{radius * std::cos(theta), radius * std::sin(theta), z});
+	}
+
+	return directions;
+}
+
+[[nodiscard]]
+f32 Dot(const f32_3& a, const f32_3& b) noexcept {
+	return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// Position Quantization
+//----------------------------------------------------------------------------------
+
+TEST(QuantizedPositionsRoundTrip) {
+	const std::vector<f32_3> positions = {
+		{-12.5f, 0.25f, 3.0f},
+		{ 40.0f, 8.0f, -7.75f},
+		{  1.0f, 2.0f,  3.0f},
+		{  0.0f, 0.0f,  0.0f},
+		{ 17.3f, 5.9f, -1.1f},
+	};
+
+	const auto aabb         = AABB::createFromVertices(positions);
+	const auto quantization = VertexQuantization::fromAABB(aabb);
+
+	for (const auto& position : positions) {
+		const auto encoded = quantization.encode(position);
+		const auto decoded = quantization.decode(encoded);
+
+		CHECK(encoded[3] == 65535);
+
+		// Rounding to the nearest step moves a position by at most half a step
+		for (u32 i = 0; i < 3; ++i) {
+			const f32 step = quantization.scale[i] / 65535.0f;
+			CHECK_NEAR(decoded[i], position[i], (0.5f * step) + 1e-5f);
+		}
+	}
+
+	// The corners of the AABB are encoded exactly
+	const auto min = quantization.encode(f32_3{-12.5f, 0.0f, -7.75f});
+	const auto max = quantization.encode(f32_3{40.0f, 8.0f, 3.0f});
+	for (u32 i = 0; i < 3; ++i) {
+		CHECK(min[i] == 0);
+		CHECK(max[i] == 65535);
+	}
+}
+
+
+TEST(QuantizedPositionsOfFlatMeshes) {
+	const std::vector<f32_3> positions = {
+		{0.0f, 2.0f, 0.0f},
+		{1.0f, 2.0f, 0.0f},
+		{1.0f, 2.0f, 1.0f},
+	};
+
+	const auto quantization = VertexQuantization::fromAABB(AABB::createFromVertices(positions));
+
+	// The flat axis keeps an invertible scale, and decodes to the plane's coordinate
+	CHECK(quantization.scale[1] == 1.0f);
+	for (const auto& position : positions) {
+		const auto decoded = quantization.decode(quantization.encode(position));
+		CHECK(decoded[1] == 2.0f);
+	}
+}
+
+
+TEST(QuantizationTransformMatchesDecode) {
+	const std::vector<f32_3> positions = {
+		{-3.0f, 1.0f, 4.0f},
+		{ 5.0f, 9.0f, -2.0f},
+		{ 0.5f, 2.5f,  1.5f},
+	};
+
+	const auto quantization = VertexQuantization::fromAABB(AABB::createFromVertices(positions));
+	const auto transform    = quantization.getTransform();
+
+	// The GPU reads the quantized position as a unorm value and applies the transform
+	for (const auto& position : positions) {
+		const auto encoded = quantization.encode(position);
+		const auto decoded = quantization.decode(encoded);
+
+		const auto unorm = XMVectorSet(encoded[0] / 65535.0f, encoded[1] / 65535.0f, encoded[2] / 65535.0f, 1.0f);
+		const auto gpu   = XMVector3TransformCoord(unorm, transform);
+
+		CHECK_NEAR(XMVectorGetX(gpu), decoded[0], 1e-4f);
+		CHECK_NEAR(XMVectorGetY(gpu), decoded[1], 1e-4f);
+		CHECK_NEAR(XMVectorGetZ(gpu), decoded[2], 1e-4f);
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+// Unit Vector Encoding
+//----------------------------------------------------------------------------------
+
+TEST(Snorm16RoundTrip) {
+	CHECK(EncodeSnorm16(1.0f) == 32767);
+	CHECK(EncodeSnorm16(-1.0f) == -32767);
+	CHECK(EncodeSnorm16(0.0f) == 0);
+
+	// Values outside of [-1, 1] are clamped
+	CHECK(EncodeSnorm16(2.0f) == 32767);
+	CHECK(EncodeSnorm16(-2.0f) == -32767);
+
+	CHECK(DecodeSnorm16(32767) == 1.0f);
+	CHECK(DecodeSnorm16(-32767) == -1.0f);
+	CHECK(DecodeSnorm16(-32768) == -1.0f);
+
+	for (f32 value = -1.0f; value <= 1.0f; value += 0.01f) {
+		CHECK_NEAR(DecodeSnorm16(EncodeSnorm16(value)), value, 0.5f / 32767.0f + 1e-6f);
+	}
+}
+
+
+TEST(OctahedralRoundTrip) {
+	for (const auto& direction : CreateTestDirections()) {
+		const auto decoded = DecodeOctahedral(EncodeOctahedral(direction));
+
+		// The decoded vector is normalized, and points within a small angle of the original
+		CHECK_NEAR(Dot(decoded, decoded), 1.0f, 1e-5f);
+		CHECK(Dot(decoded, direction) >= std::cos(0.001f));
+	}
+}
+
+
+TEST(OctahedralKeepsHemisphere) {
+	// The lower hemisphere is folded over the upper one, so the sign of z must survive
+	for (const auto& direction : CreateTestDirections()) {
+		if (std::abs(direction[2]) < 0.01f)
+			continue;
+
+		const auto decoded = DecodeOctahedral(EncodeOctahedral(direction));
+		CHECK((decoded[2] < 0.0f) == (direction[2] < 0.0f));
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+// Texture Coordinates
+//----------------------------------------------------------------------------------
+
+TEST(Half2RoundTrip) {
+	// Values exactly representable as half floats are unchanged
+	for (const f32_2 uv : {f32_2{0.0f, 1.0f}, f32_2{0.5f, 0.25f}, f32_2{-3.0f, 1024.0f}}) {
+		CHECK(DecodeHalf2(EncodeHalf2(uv)) == uv);
+	}
+
+	// Other values are within the precision of a half float
+	for (f32 u = 0.0f; u <= 1.0f; u += 0.0137f) {
+		const auto decoded = DecodeHalf2(EncodeHalf2(f32_2{u, 1.0f - u}));
+		CHECK_NEAR(decoded[0], u, 0.001f);
+		CHECK_NEAR(decoded[1], 1.0f - u, 0.001f);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+using namespace render::importer;
+
+
+namespace {
+
+// A flat grid of size x size quads, with the triangles in a random order
+[[nodiscard]]
+ModelOutput::MeshData CreateShuffledGrid(u32 size) {
+	ModelOutput::MeshData mesh;
+
+	for (u32 y = 0; y <= size; ++y) {
+		for (u32 x = 0; x <= size; ++x) {
+			mesh.positions.push_back(f32_3{static_cast<f32>(x), static_cast<f32>(y), 0.0f});
+		}
+	}
+
+	std::vector<std::array<u32, 3>> triangles;
+	for (u32 y = 0; y < size; ++y) {
+		for (u32 x = 0; x < size; ++x) {
+			const u32 v0 = (y * (size + 1)) + x;
+			const u32 v1 = v0 + 1;
+			const u32 v2 = v0 + size + 1;
+			const u32 v3 = v2 + 1;
+			triangles.push_back({v0, v2, v1});
+			triangles.push_back({v1, v2, v3});
+		}
+	}
+
+	std::mt19937 rng{1234};
+	std::ranges::shuffle(triangles, rng);
+
+	for (const auto& tri : triangles) {
+		mesh.indices.insert(mesh.indices.end(), tri.begin(), tri.end());
+	}
+
+	return mesh;
+}
+
+// The triangles of an index list, sorted. Each triangle keeps its vertex order.
+[[nodiscard]]
+std::vector<std::array<u32, 3>> GetSortedTriangles(const std::vector<u32>& indices) {
+	std::vector<std::array<u32, 3>> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+	}
+	std::ranges::sort(triangles);
+	return triangles;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// AnalyzeVertexCache
+//----------------------------------------------------------------------------------
+
+TEST(AnalyzeVertexCacheCountsUniqueVertices) {
+	// Every vertex fits in the cache, so each one is transformed once
+	const std::vector<u32> indices = {0, 1, 2, 2, 1, 3};
+	const auto stats = AnalyzeVertexCache(indices, 4);
+
+	CHECK(stats.transformed_vertices == 4);
+	CHECK_NEAR(stats.acmr, 2.0f, 1e-6f);
+	CHECK_NEAR(stats.atvr, 1.0f, 1e-6f);
+	CHECK_NEAR(stats.hit_rate, 1.0f / 3.0f, 1e-6f);
+
+	// Too few indices for a triangle
+	const std::vector<u32> line = {0, 1};
+	CHECK(AnalyzeVertexCache(line, 2).transformed_vertices == 0);
+	CHECK(AnalyzeVertexCache(line, 2).acmr == 0.0f);
+}
+
+
+TEST(AnalyzeVertexCacheSimulatesFIFO) {
+	// With a 3 entry cache, the hit on vertex 0 doesn't keep it in a FIFO cache, so it's
+	// evicted by vertex 4
+	const std::vector<u32> indices = {0, 1, 2, 0, 3, 4, 0, 1, 2};
+	const auto stats = AnalyzeVertexCache(indices, 5, 3, VertexCacheType::fifo);
+
+	CHECK(stats.transformed_vertices == 8);
+	CHECK_NEAR(stats.acmr, 8.0f / 3.0f, 1e-6f);
+	CHECK_NEAR(stats.atvr, 8.0f / 5.0f, 1e-6f);
+	CHECK_NEAR(stats.hit_rate, 1.0f / 9.0f, 1e-6f);
+}
+
+
+TEST(AnalyzeVertexCacheSimulatesLRU) {
+	// The hit on vertex 0 moves it to the front of an LRU cache, so it's still cached when
+	// the last triangle starts
+	const std::vector<u32> indices = {0, 1, 2, 0, 3, 4, 0, 1, 2};
+	const auto stats = AnalyzeVertexCache(indices, 5, 3, VertexCacheType::lru);
+
+	CHECK(stats.transformed_vertices == 7);
+	CHECK_NEAR(stats.acmr, 7.0f / 3.0f, 1e-6f);
+	CHECK_NEAR(stats.atvr, 7.0f / 5.0f, 1e-6f);
+	CHECK_NEAR(stats.hit_rate, 2.0f / 9.0f, 1e-6f);
+}
+
+
+//----------------------------------------------------------------------------------
+// OptimizeVertexCache
+//----------------------------------------------------------------------------------
+
+TEST(OptimizeVertexCacheLowersACMR) {
+	auto mesh = CreateShuffledGrid(32);
+	const u32 vertex_count = static_cast<u32>(mesh.positions.size());
+
+	const auto triangles = GetSortedTriangles(mesh.indices);
+	const auto before    = AnalyzeVertexCache(mesh.indices, vertex_count);
+
+	OptimizeVertexCache(mesh.indices, vertex_count);
+	const auto after = AnalyzeVertexCache(mesh.indices, vertex_count);
+
+	// A grid can't do better than about 0.5 vertices per triangle, while a random order
+	// misses on almost every vertex
+	CHECK(before.acmr > 2.0f);
+	CHECK(after.acmr < 1.0f);
+	CHECK(after.acmr < before.acmr);
+	CHECK(AnalyzeVertexCache(mesh.indices, vertex_count, 16, VertexCacheType::lru).acmr < 1.0f);
+
+	// The same triangles are drawn, with the same winding
+	CHECK(GetSortedTriangles(mesh.indices) == triangles);
+}
+
+
+//----------------------------------------------------------------------------------
+// OptimizeVertexFetch
+//----------------------------------------------------------------------------------
+
+TEST(OptimizeVertexFetchReordersVertices) {
+	ModelOutput::MeshData mesh;
+	mesh.positions = {
+		f32_3{0.0f, 0.0f, 0.0f},
+		f32_3{1.0f, 0.0f, 0.0f},
+		f32_3{2.0f, 0.0f, 0.0f}, //unused
+		f32_3{3.0f, 0.0f, 0.0f},
+		f32_3{4.0f, 0.0f, 0.0f},
+	};
+	mesh.normals = {
+		f32_3{0.0f, 0.0f, 1.0f},
+		f32_3{0.0f, 1.0f, 0.0f},
+		f32_3{0.0f, 1.0f, 1.0f},
+		f32_3{1.0f, 0.0f, 0.0f},
+		f32_3{1.0f, 0.0f, 1.0f},
+	};
+	mesh.indices = {3, 1, 4, 4, 1, 0};
+
+	OptimizeVertexFetch(mesh);
+
+	// The vertices are in the order they're first referenced, and the unused vertex is removed
+	CHECK((mesh.indices == std::vector<u32>{0, 1, 2, 2, 1, 3}));
+	CHECK(mesh.positions.size() == 4);
+	CHECK(mesh.normals.size() == 4);
+
+	if (mesh.positions.size() == 4) {
+		CHECK(mesh.positions[0][0] == 3.0f);
+		CHECK(mesh.positions[1][0] == 1.0f);
+		CHECK(mesh.positions[2][0] == 4.0f);
+		CHECK(mesh.positions[3][0] == 0.0f);
+	}
+
+	// Each attribute moves with its vertex
+	if (mesh.normals.size() == 4) {
+		CHECK(mesh.normals[0][0] == 1.0f);
+		CHECK(mesh.normals[0][2] == 0.0f);
+		CHECK(mesh.normals[2][2] == 1.0f);
+		CHECK(mesh.normals[3][2] == 1.0f);
+	}
+
+	// Missing attributes are left alone
+	CHECK(mesh.texture_coords.empty());
+
+	// The vertex order is now the order of first reference, so the indices are unchanged
+	OptimizeVertexFetch(mesh);
+	CHECK((mesh.indices == std::vector<u32>{0, 1, 2, 2, 1, 3}));
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+using namespace render::importer;
+
+
+namespace {
+
+struct TestMesh {
+	std::vector<u32>   indices;
+	std::vector<f32_3> positions;
+};
+
+// A closed cube from (0, 0, 0) to (1, 1, 1), with each face split into a grid of
+// divisions x divisions quads. Vertices are shared between faces, so the mesh has no
+// borders and only its corners and edges are curved.
+[[nodiscard]]
+TestMesh CreateGridCube(u32 divisions) {
+	TestMesh mesh;
+	std::map<std::array<u32, 3>, u32> vertices;
+
+	const auto vertex = [&](std::array<u32, 3> coords) {
+		const auto [it, inserted] = vertices.try_emplace(coords, static_cast<u32>(mesh.positions.size()));
+		if (inserted) {
+			const f32 scale = 1.0f / static_cast<f32>(divisions);
+			mesh.positions.push_back(f32_3{coords[0] * scale, coords[1] * scale, coords[2] * scale});
+		}
+		return it->second;
+	};
+
+	for (u32 axis = 0; axis < 3; ++axis) {
+		const u32 u_axis = (axis + 1) % 3;
+		const u32 v_axis = (axis + 2) % 3;
+
+		for (u32 side = 0; side < 2; ++side) {
+			for (u32 u = 0; u < divisions; ++u) {
+				for (u32 v = 0; v < divisions; ++v) {
+					const auto corner = [&](u32 du, u32 dv) {
+						std::array<u32, 3> coords = {};
+						coords[axis]   = side * divisions;
+						coords[u_axis] = u + du;
+						coords[v_axis] = v + dv;
+						return vertex(coords);
+					};
+
+					const u32 quad[4] = {corner(0, 0), corner(1, 0), corner(1, 1), corner(0, 1)};
+
+					// Wind the triangles so they face away from the cube's center
+					if (side == 1)
+						mesh.indices.insert(mesh.indices.end(), {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+					else
+						mesh.indices.insert(mesh.indices.end(), {quad[0], quad[2], quad[1], quad[0], quad[3], quad[2]});
+				}
+			}
+		}
+	}
+
+	return mesh;
+}
+
+// The grid cube with its vertices pushed onto the unit sphere around its center
+[[nodiscard]]
+TestMesh CreateGridSphere(u32 divisions) {
+	auto mesh = CreateGridCube(divisions);
+	for (auto& p : mesh.positions) {
+		const f32 x = p[0] - 0.5f;
+		const f32 y = p[1] - 0.5f;
+		const f32 z = p[2] - 0.5f;
+		const f32 length = std::sqrt((x * x) + (y * y) + (z * z));
+		p = f32_3{x / length, y / length, z / length};
+	}
+	return mesh;
+}
+
+[[nodiscard]]
+bool IsValidTriangleList(const std::vector<u32>& indices, size_t vertex_count) {
+	if ((indices.size() % 3) != 0)
+		return false;
+
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		if ((indices[i] == indices[i + 1]) or (indices[i + 1] == indices[i + 2]) or (indices[i + 2] == indices[i]))
+			return false;
+	}
+
+	return std::ranges::all_of(indices, [vertex_count](u32 index) { return index < vertex_count; });
+}
+
+// The largest distance of a triangle's centroid from the unit sphere
+[[nodiscard]]
+f32 MaxCentroidDeviation(const TestMesh& mesh, const std::vector<u32>& indices) {
+	f32 deviation = 0.0f;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		f32 centroid[3] = {};
+		for (u32 v = 0; v < 3; ++v) {
+			for (u32 c = 0; c < 3; ++c)
+				centroid[c] += mesh.positions[indices[i + v]][c] / 3.0f;
+		}
+
+		const f32 length = std::sqrt((centroid[0] * centroid[0]) + (centroid[1] * centroid[1]) + (centroid[2] * centroid[2]));
+		deviation = std::max(deviation, 1.0f - length);
+	}
+	return deviation;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// SimplifyMesh
+//----------------------------------------------------------------------------------
+
+TEST(SimplifyMeshMeetsIndexBudget) {
+	const auto mesh   = CreateGridCube(8);
+	const auto target = mesh.indices.size() / 4;
+
+	f32 error = -1.0f;
+	const auto result = SimplifyMesh(mesh.indices, mesh.positions, target, 1.0f, &error);
+
+	CHECK(result.size() <= target);
+	CHECK(not result.empty());
+	CHECK(IsValidTriangleList(result, mesh.positions.size()));
+	CHECK(error >= 0.0f);
+}
+
+
+TEST(SimplifyMeshKeepsFlatSurfacesWithoutError) {
+	const auto mesh = CreateGridCube(8);
+
+	// The faces are flat, so they collapse down to the cube's 12 triangles without moving
+	// the surface
+	f32 error = -1.0f;
+	const auto result = SimplifyMesh(mesh.indices, mesh.positions, 0, 0.0f, &error);
+
+	CHECK(result.size() == 36);
+	CHECK(IsValidTriangleList(result, mesh.positions.size()));
+	CHECK(error == 0.0f);
+
+	// The corners can't move without changing the shape of the cube
+	for (u32 corner = 0; corner < 8; ++corner) {
+		const f32_3 position{static_cast<f32>(corner & 1), static_cast<f32>((corner >> 1) & 1), static_cast<f32>((corner >> 2) & 1)};
+		CHECK(std::ranges::any_of(result, [&](u32 index) { return mesh.positions[index] == position; }));
+	}
+}
+
+
+TEST(SimplifyMeshStaysWithinErrorBound) {
+	const auto mesh = CreateGridSphere(12);
+
+	constexpr f32 target_error = 0.02f;
+
+	f32 error = -1.0f;
+	const auto result = SimplifyMesh(mesh.indices, mesh.positions, 0, target_error, &error);
+
+	CHECK(result.size() < mesh.indices.size());
+	CHECK(IsValidTriangleList(result, mesh.positions.size()));
+	CHECK(error > 0.0f);
+	CHECK(error <= target_error);
+
+	// The simplified surface stays close to the sphere. The error of each collapse is a
+	// distance to the planes of the triangles it merged, so the distance to the sphere
+	// itself may be a few times larger.
+	CHECK(MaxCentroidDeviation(mesh, result) <= 3.0f * target_error);
+}
+
+
+TEST(SimplifyMeshReturnsSmallMeshesUnchanged) {
+	const auto mesh = CreateGridCube(2);
+
+	f32 error = -1.0f;
+	const auto result = SimplifyMesh(mesh.indices, mesh.positions, mesh.indices.size(), 1.0f, &error);
+
+	CHECK(result == mesh.indices);
+	CHECK(error == 0.0f);
+}
+
+
+//----------------------------------------------------------------------------------
+// GenerateLODs
+//----------------------------------------------------------------------------------
+
+TEST(GenerateLODsReducesEachLevel) {
+	const auto sphere = CreateGridSphere(16);
+
+	ModelOutput::MeshData mesh;
+	mesh.indices   = sphere.indices;
+	mesh.positions = sphere.positions;
+
+	constexpr f32 max_error = 0.05f;
+	GenerateLODs(mesh, 4, 0.5f, max_error);
+
+	CHECK(mesh.lods.size() >= 2);
+	CHECK(mesh.lods.size() <= 4);
+	if (mesh.lods.empty())
+		return;
+
+	// The first level is the full mesh
+	CHECK(mesh.lods[0].index_offset == 0);
+	CHECK(mesh.lods[0].index_count == sphere.indices.size());
+	CHECK(mesh.lods[0].error == 0.0f);
+
+	for (size_t i = 1; i < mesh.lods.size(); ++i) {
+		const auto& lod      = mesh.lods[i];
+		const auto& previous = mesh.lods[i - 1];
+
+		// Each level has at most about half of the previous level's triangles, and no
+		// less error
+		CHECK(lod.index_count <= (previous.index_count / 2) + 3);
+		CHECK(lod.error >= previous.error);
+		CHECK(lod.error <= max_error);
+
+		CHECK(lod.index_offset == previous.index_offset + previous.index_count);
+		CHECK(lod.index_offset + lod.index_count <= mesh.indices.size());
+	}
+}
+
+
+TEST(GenerateLODsSkipsSingleLevel) {
+	const auto sphere = CreateGridSphere(4);
+
+	ModelOutput::MeshData mesh;
+	mesh.indices   = sphere.indices;
+	mesh.positions = sphere.positions;
+
+	GenerateLODs(mesh, 1);
+
+	CHECK(mesh.lods.empty());
+	CHECK(mesh.indices == sphere.indices);
+}
\ No newline at end of file
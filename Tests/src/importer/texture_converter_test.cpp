@@ -0,0 +1,308 @@
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "importer/texture_converter.h"
+
+#include "test.h"
+
+using namespace DirectX;
+using namespace render::TextureConverter;
+
+
+namespace {
+
+// A directory under the system's temp directory that's removed when the test ends
+class TempDirectory {
+public:
+	TempDirectory() {
+		static std::atomic<u32> counter = 0;
+		path = fs::temp_directory_path() / ("texture_converter_test_" + std::to_string(counter++));
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+
+	TempDirectory(const TempDirectory&) = delete;
+
+	~TempDirectory() {
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+
+	TempDirectory& operator=(const TempDirectory&) = delete;
+
+	[[nodiscard]]
+	const fs::path& get() const noexcept {
+		return path;
+	}
+
+private:
+	fs::path path;
+};
+
+template<typename T>
+void Append(std::vector<u8>& data, T value) {
+	const auto offset = data.size();
+	data.resize(offset + sizeof(T));
+	std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+// Build a bitmap file with a BITMAPINFOHEADER. The masks follow the header, and the rows
+// must already be padded to 4 bytes.
+[[nodiscard]]
+std::vector<u8> CreateBMP(i32 width, i32 height, u16 bit_count, u32 compression, std::span<const u32> masks, std::span<const u8> pixels) {
+	const u32 pixel_offset = static_cast<u32>(14 + 40 + (masks.size() * sizeof(u32)));
+
+	std::vector<u8> data = {'B', 'M'};
+	Append<u32>(data, pixel_offset + static_cast<u32>(pixels.size()));
+	Append<u32>(data, 0);
+	Append<u32>(data, pixel_offset);
+
+	Append<u32>(data, 40);
+	Append<i32>(data, width);
+	Append<i32>(data, height);
+	Append<u16>(data, 1);
+	Append<u16>(data, bit_count);
+	Append<u32>(data, compression);
+	Append<u32>(data, static_cast<u32>(pixels.size()));
+	Append<i32>(data, 2835);
+	Append<i32>(data, 2835);
+	Append<u32>(data, 0);
+	Append<u32>(data, 0);
+
+	for (const u32 mask : masks)
+		Append<u32>(data, mask);
+
+	data.insert(data.end(), pixels.begin(), pixels.end());
+	return data;
+}
+
+void WriteFile(const fs::path& file, std::span<const u8> data) {
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+// An opaque gray 24-bit bitmap
+[[nodiscard]]
+std::vector<u8> CreateGrayBMP(i32 size) {
+	const size_t row_pitch = ((static_cast<size_t>(size) * 3) + 3) & ~size_t{3};
+	const std::vector<u8> pixels(row_pitch * static_cast<size_t>(size), 0x80);
+	return CreateBMP(size, size, 24, 0, {}, pixels);
+}
+
+[[nodiscard]]
+bool CheckPixel(const ScratchImage& image, size_t x, size_t y, u8 r, u8 g, u8 b, u8 a) {
+	const Image* top   = image.GetImage(0, 0, 0);
+	const u8*    pixel = top->pixels + (y * top->rowPitch) + (x * 4);
+	return (pixel[0] == r) and (pixel[1] == g) and (pixel[2] == b) and (pixel[3] == a);
+}
+
+// An RGBA image with every pixel set to the same color
+[[nodiscard]]
+ScratchImage CreateImage(size_t width, size_t height, u8 alpha) {
+	ScratchImage image;
+	CHECK(SUCCEEDED(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1)));
+
+	const Image* top = image.GetImage(0, 0, 0);
+	for (size_t y = 0; y < height; ++y) {
+		u8* row = top->pixels + (y * top->rowPitch);
+		for (size_t x = 0; x < width; ++x) {
+			row[(x * 4) + 0] = 200;
+			row[(x * 4) + 1] = 100;
+			row[(x * 4) + 2] = 50;
+			row[(x * 4) + 3] = alpha;
+		}
+	}
+	return image;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// Formats
+//----------------------------------------------------------------------------------
+
+TEST(TextureConverterSelectsFormatByRole) {
+	CHECK(GetCompressedFormat(TextureRole::BaseColor, false)      == DXGI_FORMAT_BC1_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::BaseColor, true)       == DXGI_FORMAT_BC3_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::Normal, false)         == DXGI_FORMAT_BC5_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::MaterialParams, false) == DXGI_FORMAT_BC7_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::Emissive, false)       == DXGI_FORMAT_BC1_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::Generic, false)        == DXGI_FORMAT_UNKNOWN);
+
+	// Only the base color keeps its alpha
+	CHECK(GetCompressedFormat(TextureRole::Normal, true)          == DXGI_FORMAT_BC5_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::MaterialParams, true)  == DXGI_FORMAT_BC7_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::Emissive, true)        == DXGI_FORMAT_BC1_UNORM);
+	CHECK(GetCompressedFormat(TextureRole::Generic, true)         == DXGI_FORMAT_UNKNOWN);
+}
+
+
+TEST(TextureConverterCompressesByRole) {
+	auto opaque = CreateImage(8, 8, 255);
+	CHECK(SUCCEEDED(ConvertImage(opaque, TextureRole::BaseColor)));
+	CHECK(opaque.GetMetadata().format == DXGI_FORMAT_BC1_UNORM);
+	CHECK(opaque.GetMetadata().mipLevels == 4);
+
+	auto transparent = CreateImage(8, 8, 128);
+	CHECK(SUCCEEDED(ConvertImage(transparent, TextureRole::BaseColor)));
+	CHECK(transparent.GetMetadata().format == DXGI_FORMAT_BC3_UNORM);
+
+	auto normal = CreateImage(8, 8, 255);
+	CHECK(SUCCEEDED(ConvertImage(normal, TextureRole::Normal)));
+	CHECK(normal.GetMetadata().format == DXGI_FORMAT_BC5_UNORM);
+
+	// Generic textures only get a mip chain
+	auto generic = CreateImage(8, 8, 255);
+	CHECK(SUCCEEDED(ConvertImage(generic, TextureRole::Generic)));
+	CHECK(generic.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(generic.GetMetadata().mipLevels == 4);
+}
+
+
+TEST(TextureConverterKeepsPartialBlocksUncompressed) {
+	// 6x6 isn't a whole number of 4x4 blocks
+	auto image = CreateImage(6, 6, 255);
+	CHECK(SUCCEEDED(ConvertImage(image, TextureRole::BaseColor)));
+	CHECK(image.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(image.GetMetadata().mipLevels == 3);
+
+	auto wide = CreateImage(8, 6, 255);
+	CHECK(SUCCEEDED(ConvertImage(wide, TextureRole::Normal)));
+	CHECK(wide.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+}
+
+
+//----------------------------------------------------------------------------------
+// Cache
+//----------------------------------------------------------------------------------
+
+TEST(TextureConverterNamesCacheEntries) {
+	const fs::path cache_dir = "cache/textures";
+
+	const auto path = GetCachePath(cache_dir, 0xDEADBEEF, TextureRole::Normal);
+	CHECK(path.parent_path() == cache_dir);
+	CHECK(path.filename() == std::format("00000000deadbeef_2_v{}.dds", converter_version));
+
+	// The content, role and converter version each select a different entry
+	CHECK(GetCachePath(cache_dir, 0xDEADBEEF, TextureRole::Normal) == path);
+	CHECK(GetCachePath(cache_dir, 0xDEADBEEE, TextureRole::Normal) != path);
+	CHECK(GetCachePath(cache_dir, 0xDEADBEEF, TextureRole::BaseColor) != path);
+	CHECK(GetCachePath(cache_dir, 0xDEADBEEF, TextureRole::BaseColor).filename() == std::format("00000000deadbeef_1_v{}.dds", converter_version));
+}
+
+
+TEST(TextureConverterCachesConvertedTextures) {
+	TempDirectory dir;
+	const auto file      = dir.get() / "gray.bmp";
+	const auto cache_dir = dir.get() / "cache";
+	WriteFile(file, CreateGrayBMP(8));
+
+	const u64 hash = HashFile(file);
+	CHECK(hash != 0);
+
+	ScratchImage image;
+	CHECK(LoadConvertedTexture(file, TextureRole::BaseColor, cache_dir, image) == S_OK);
+	CHECK(image.GetMetadata().format == DXGI_FORMAT_BC1_UNORM);
+	CHECK(fs::exists(GetCachePath(cache_dir, hash, TextureRole::BaseColor)));
+
+	// The entry is read without the source file
+	fs::remove(file);
+
+	ScratchImage cached;
+	CHECK(LoadConvertedTexture(file, TextureRole::BaseColor, cache_dir, cached, hash) == S_OK);
+	CHECK(cached.GetMetadata().format == DXGI_FORMAT_BC1_UNORM);
+	CHECK(cached.GetMetadata().mipLevels == 4);
+
+	// Other roles have their own entries
+	ScratchImage normal;
+	CHECK(FAILED(LoadConvertedTexture(file, TextureRole::Normal, cache_dir, normal, hash)));
+}
+
+
+//----------------------------------------------------------------------------------
+// BMP Decoding
+//----------------------------------------------------------------------------------
+
+TEST(TextureConverterDecodesBMP) {
+	TempDirectory dir;
+	const auto file = dir.get() / "image.bmp";
+
+	// 2x2, 24-bit BGR, bottom row first, rows padded to 8 bytes
+	const u8 pixels[] = {
+		0xFF, 0x00, 0x00,  0x00, 0xFF, 0x00,  0, 0, //blue, green
+		0x00, 0x00, 0xFF,  0xFF, 0xFF, 0xFF,  0, 0, //red, white
+	};
+	WriteFile(file, CreateBMP(2, 2, 24, 0, {}, pixels));
+
+	ScratchImage image;
+	CHECK(SUCCEEDED(DecodeImage(file, image)));
+	CHECK(image.GetMetadata().width == 2);
+	CHECK(image.GetMetadata().height == 2);
+	CHECK(image.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+	if (image.GetImageCount() == 1) {
+		CHECK(CheckPixel(image, 0, 0, 255, 0,   0,   255));
+		CHECK(CheckPixel(image, 1, 0, 255, 255, 255, 255));
+		CHECK(CheckPixel(image, 0, 1, 0,   0,   255, 255));
+		CHECK(CheckPixel(image, 1, 1, 0,   255, 0,   255));
+	}
+}
+
+
+TEST(TextureConverterDecodesBMPWithMasks) {
+	TempDirectory dir;
+	const auto file = dir.get() / "masks.BMP";
+
+	// 1x2, 32-bit with an alpha mask (BI_ALPHABITFIELDS), top row first
+	const u32 argb_masks[] = {0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000};
+	const u8  argb_pixels[] = {
+		0x30, 0x20, 0x10, 0x80,
+		0x00, 0x00, 0xFF, 0x00,
+	};
+	WriteFile(file, CreateBMP(1, -2, 32, 6, argb_masks, argb_pixels));
+
+	ScratchImage image;
+	CHECK(SUCCEEDED(DecodeImage(file, image)));
+	if (image.GetImageCount() == 1) {
+		CHECK(CheckPixel(image, 0, 0, 0x10, 0x20, 0x30, 0x80));
+		CHECK(CheckPixel(image, 0, 1, 0xFF, 0x00, 0x00, 0x00));
+	}
+
+	// 2x1, 16-bit 565 (BI_BITFIELDS), which has no alpha
+	const u32 rgb565_masks[] = {0xF800, 0x07E0, 0x001F};
+	const u8  rgb565_pixels[] = {0x00, 0xF8, 0xE0, 0x07};
+	WriteFile(file, CreateBMP(2, 1, 16, 3, rgb565_masks, rgb565_pixels));
+
+	CHECK(SUCCEEDED(DecodeImage(file, image)));
+	if (image.GetImageCount() == 1) {
+		CHECK(CheckPixel(image, 0, 0, 255, 0,   0, 255));
+		CHECK(CheckPixel(image, 1, 0, 0,   255, 0, 255));
+	}
+}
+
+
+TEST(TextureConverterRejectsInvalidBMP) {
+	TempDirectory dir;
+	const auto file = dir.get() / "invalid.bmp";
+
+	// The pixel data is cut short
+	auto truncated = CreateGrayBMP(8);
+	truncated.resize(truncated.size() - 16);
+	WriteFile(file, truncated);
+
+	ScratchImage image;
+	CHECK(FAILED(DecodeImage(file, image)));
+
+	// Not a bitmap
+	const u8 text[] = {'n', 'o', 't', ' ', 'a', ' ', 'b', 'i', 't', 'm', 'a', 'p'};
+	WriteFile(file, text);
+	CHECK(FAILED(DecodeImage(file, image)));
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+#include "test.h"
+
+
+int main() {
+	size_t failed_tests = 0;
+
+	for (const auto& [name, func] : GetTests()) {
+		std::printf("%s\n", name);
+
+		const size_t failures = GetFailureCount();
+		try {
+			func();
+		}
+		catch (const std::exception& e) {
+			++GetFailureCount();
+			std::fprintf(stderr, "  threw an exception: %s\n", e.what());
+		}
+
+		if (GetFailureCount() != failures)
+			++failed_tests;
+	}
+
+	std::printf("\n%zu of %zu tests passed\n", GetTests().size() - failed_tests, GetTests().size());
+	return (failed_tests == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
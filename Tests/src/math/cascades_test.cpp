@@ -0,0 +1,172 @@
+#include <cmath>
+#include <span>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+#include "test.h"
+
+import math.geometry;
+
+using namespace DirectX;
+
+
+namespace {
+
+[[nodiscard]]
+XMMATRIX XM_CALLCONV CameraWorldToProjection(FXMMATRIX world_to_camera) {
+	return world_to_camera * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 100.0f);
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCascadeSplits
+//----------------------------------------------------------------------------------
+
+TEST(CascadeSplitsIncludeEndpoints) {
+	f32 splits[5] = {};
+	ComputeCascadeSplits(0.5f, 200.0f, 0.75f, splits);
+
+	CHECK(splits[0] == 0.5f);
+	CHECK(splits[4] == 200.0f);
+	for (size_t i = 1; i < 5; ++i) {
+		CHECK(splits[i] > splits[i - 1]);
+	}
+}
+
+TEST(CascadeSplitsUniform) {
+	f32 splits[5] = {};
+	ComputeCascadeSplits(1.0f, 101.0f, 0.0f, splits);
+
+	for (size_t i = 0; i < 5; ++i) {
+		CHECK_NEAR(splits[i], 1.0f + (25.0f * static_cast<f32>(i)), 1e-3f);
+	}
+}
+
+TEST(CascadeSplitsLogarithmic) {
+	f32 splits[4] = {};
+	ComputeCascadeSplits(1.0f, 1000.0f, 1.0f, splits);
+
+	// Each split is a constant factor farther than the last
+	for (size_t i = 1; i < 4; ++i) {
+		CHECK_NEAR(splits[i] / splits[i - 1], 10.0f, 1e-3f);
+	}
+}
+
+TEST(CascadeSplitsClampLambda) {
+	f32 clamped[4]  = {};
+	f32 expected[4] = {};
+	ComputeCascadeSplits(1.0f, 50.0f, 3.0f, clamped);
+	ComputeCascadeSplits(1.0f, 50.0f, 1.0f, expected);
+
+	for (size_t i = 0; i < 4; ++i) {
+		CHECK_NEAR(clamped[i], expected[i], 1e-5f);
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeFrustumSliceCorners / ComputeCascadeBounds
+//----------------------------------------------------------------------------------
+
+TEST(FrustumSliceCornersLieOnSlicePlanes) {
+	const auto world_to_camera     = XMMatrixLookToLH(XMVectorSet(3.0f, 2.0f, -4.0f, 1.0f), XMVectorSet(0.3f, -0.2f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const auto projection_to_world = XMMatrixInverse(nullptr, CameraWorldToProjection(world_to_camera));
+
+	const auto corners = ComputeFrustumSliceCorners(projection_to_world, f32_2{0.1f, 100.0f}, 2.0f, 15.0f);
+
+	for (size_t i = 0; i < 8; ++i) {
+		const f32 depth = XMVectorGetZ(XMVector3TransformCoord(corners[i], world_to_camera));
+		CHECK_NEAR(depth, (i < 4) ? 2.0f : 15.0f, 1e-3f);
+	}
+}
+
+TEST(CascadeBoundsEncloseCorners) {
+	const auto world_to_camera     = XMMatrixTranslation(-5.0f, 1.0f, 2.0f);
+	const auto projection_to_world = XMMatrixInverse(nullptr, CameraWorldToProjection(world_to_camera));
+
+	const auto corners = ComputeFrustumSliceCorners(projection_to_world, f32_2{0.1f, 100.0f}, 1.0f, 10.0f);
+	const auto bounds  = ComputeCascadeBounds(corners);
+
+	for (const auto& corner : corners) {
+		CHECK(XMVectorGetX(XMVector3Length(corner - bounds.center())) <= bounds.radius() + 1e-4f);
+	}
+
+	// The radius is rounded up to a multiple of 1/16
+	const f32 steps = bounds.radius() * 16.0f;
+	CHECK_NEAR(steps, std::round(steps), 1e-3f);
+}
+
+TEST(CascadeBoundsIgnoreCameraRotation) {
+	const auto eye = XMVectorSet(1.0f, 2.0f, 3.0f, 1.0f);
+	const auto up  = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+	const auto bounds_at = [&](FXMVECTOR direction) {
+		const auto world_to_camera     = XMMatrixLookToLH(eye, direction, up);
+		const auto projection_to_world = XMMatrixInverse(nullptr, CameraWorldToProjection(world_to_camera));
+		const auto corners             = ComputeFrustumSliceCorners(projection_to_world, f32_2{0.1f, 100.0f}, 5.0f, 30.0f);
+		return ComputeCascadeBounds(corners);
+	};
+
+	const auto a = bounds_at(XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f));
+	const auto b = bounds_at(XMVectorSet(0.7f, -0.1f, 0.4f, 0.0f));
+
+	CHECK(a.radius() == b.radius());
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCasterNear
+//----------------------------------------------------------------------------------
+
+TEST(CasterNearIsNearestCorner) {
+	const AABB bounds{f32_3{-1.0f, -2.0f, -5.0f}, f32_3{3.0f, 4.0f, 6.0f}};
+
+	CHECK_NEAR(ComputeCasterNear(XMMatrixIdentity(), bounds), -5.0f, 1e-5f);
+	CHECK_NEAR(ComputeCasterNear(XMMatrixTranslation(0.0f, 0.0f, 10.0f), bounds), 5.0f, 1e-5f);
+
+	// A light facing -z sees the far side of the box first
+	CHECK_NEAR(ComputeCasterNear(XMMatrixRotationY(XM_PI), bounds), -6.0f, 1e-4f);
+}
+
+
+//----------------------------------------------------------------------------------
+// ComputeCascadeProjection
+//----------------------------------------------------------------------------------
+
+TEST(CascadeProjectionSnapsToTexels) {
+	constexpr f32 radius     = 8.0f;
+	constexpr u32 resolution = 1024;
+	constexpr f32 texel_size = (2.0f * radius) / resolution;
+
+	const BoundingSphere bounds{f32_3{0.3f, 0.71f, 5.0f}, radius};
+	const auto projection = ComputeCascadeProjection(XMMatrixIdentity(), bounds, resolution, 0.0f);
+
+	// The projection is centered on (-m30 * r, -m31 * r), which is a multiple of the texel size
+	const f32 center_x = -XMVectorGetX(projection.r[3]) * radius;
+	const f32 center_y = -XMVectorGetY(projection.r[3]) * radius;
+	CHECK_NEAR(center_x / texel_size, std::round(center_x / texel_size), 1e-3f);
+	CHECK_NEAR(center_y / texel_size, std::round(center_y / texel_size), 1e-3f);
+
+	// Moving the bounds by less than a texel doesn't move the projection
+	const BoundingSphere moved{f32_3{0.305f, 0.715f, 5.0f}, radius};
+	const auto moved_projection = ComputeCascadeProjection(XMMatrixIdentity(), moved, resolution, 0.0f);
+	CHECK(XMVector4Equal(projection.r[3], moved_projection.r[3]));
+}
+
+TEST(CascadeProjectionIncludesCasters) {
+	const BoundingSphere bounds{f32_3{0.0f, 0.0f, 5.0f}, 8.0f};
+	const auto projection = ComputeCascadeProjection(XMMatrixIdentity(), bounds, 1024, -20.0f);
+
+	// The nearest caster is on the near plane, and the far side of the bounds is on the far plane
+	CHECK_NEAR(XMVectorGetZ(XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, -20.0f, 1.0f), projection)), 0.0f, 1e-5f);
+	CHECK_NEAR(XMVectorGetZ(XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 13.0f, 1.0f), projection)), 1.0f, 1e-5f);
+
+	// A caster behind the near side of the bounds doesn't move the near plane
+	const auto unchanged = ComputeCascadeProjection(XMMatrixIdentity(), bounds, 1024, 100.0f);
+	CHECK_NEAR(XMVectorGetZ(XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, -3.0f, 1.0f), unchanged)), 0.0f, 1e-5f);
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <optional>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "memory/atlas_allocator.h"
+
+#include "test.h"
+
+
+namespace {
+
+// Check that no two tiles overlap, and that every tile is inside the atlas
+[[nodiscard]]
+bool AreDisjoint(const std::vector<AtlasAllocator::Tile>& tiles, u32 atlas_size) {
+	for (size_t i = 0; i < tiles.size(); ++i) {
+		const auto& a = tiles[i];
+		if ((a.position[0] + a.size > atlas_size) or (a.position[1] + a.size > atlas_size))
+			return false;
+
+		for (size_t j = i + 1; j < tiles.size(); ++j) {
+			const auto& b = tiles[j];
+			const bool separate_x = (a.position[0] + a.size <= b.position[0]) or (b.position[0] + b.size <= a.position[0]);
+			const bool separate_y = (a.position[1] + a.size <= b.position[1]) or (b.position[1] + b.size <= a.position[1]);
+			if (not separate_x and not separate_y)
+				return false;
+		}
+	}
+	return true;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// AtlasAllocator
+//----------------------------------------------------------------------------------
+
+TEST(AtlasAllocatorRoundsSizes) {
+	const AtlasAllocator allocator(1000, 100);
+
+	// Sizes are rounded down to powers of two
+	CHECK(allocator.getAtlasSize() == 512);
+	CHECK(allocator.getMinTileSize() == 64);
+
+	// Tile sizes are rounded up, and clamped to the minimum and atlas sizes
+	CHECK(allocator.getTileSize(1) == 64);
+	CHECK(allocator.getTileSize(65) == 128);
+	CHECK(allocator.getTileSize(128) == 128);
+	CHECK(allocator.getTileSize(4096) == 512);
+}
+
+
+TEST(AtlasAllocatorAllocatesDisjointTiles) {
+	AtlasAllocator allocator(1024, 64);
+
+	std::vector<AtlasAllocator::Tile> tiles;
+	for (const u32 size : {512u, 256u, 256u, 100u, 64u, 64u, 128u}) {
+		const auto tile = allocator.allocate(size);
+		CHECK(tile.has_value());
+		if (tile) {
+			CHECK(tile->size == allocator.getTileSize(size));
+			CHECK((tile->position[0] % tile->size) == 0);
+			CHECK((tile->position[1] % tile->size) == 0);
+			tiles.push_back(*tile);
+		}
+	}
+
+	CHECK(AreDisjoint(tiles, 1024));
+
+	u64 area = 0;
+	for (const auto& tile : tiles)
+		area += u64{tile.size} * tile.size;
+	CHECK(allocator.getUsedArea() == area);
+	CHECK(allocator.getFreeArea() == (1024ull * 1024) - area);
+}
+
+
+TEST(AtlasAllocatorFailsWhenFull) {
+	AtlasAllocator allocator(256, 64);
+
+	// Sixteen tiles of the minimum size fill the atlas
+	std::vector<AtlasAllocator::Tile> tiles;
+	for (u32 i = 0; i < 16; ++i) {
+		const auto tile = allocator.allocate(64);
+		CHECK(tile.has_value());
+		if (tile)
+			tiles.push_back(*tile);
+	}
+
+	CHECK(AreDisjoint(tiles, 256));
+	CHECK(allocator.getFreeArea() == 0);
+	CHECK(not allocator.allocate(64).has_value());
+
+	// Requests larger than the atlas always fail
+	AtlasAllocator empty(256, 64);
+	CHECK(not empty.allocate(512).has_value());
+	CHECK(empty.allocate(256).has_value());
+	CHECK(not empty.allocate(64).has_value());
+}
+
+
+TEST(AtlasAllocatorFailsWithoutALargeEnoughBlock) {
+	AtlasAllocator allocator(256, 64);
+
+	std::vector<AtlasAllocator::Tile> tiles;
+	while (const auto tile = allocator.allocate(64))
+		tiles.push_back(*tile);
+
+	// Keep one tile in each 128 texel block. Most of the atlas is free, but fragmented.
+	for (const auto& tile : tiles) {
+		if (((tile.position[0] % 128) != 0) or ((tile.position[1] % 128) != 0))
+			allocator.free(tile);
+	}
+
+	CHECK(allocator.getFreeArea() == 12ull * 64 * 64);
+	CHECK(not allocator.allocate(128).has_value());
+	CHECK(allocator.allocate(64).has_value());
+}
+
+
+TEST(AtlasAllocatorMergesFreedTiles) {
+	AtlasAllocator allocator(512, 64);
+
+	// Split the atlas all the way down, then free everything
+	std::vector<AtlasAllocator::Tile> tiles;
+	while (const auto tile = allocator.allocate(64))
+		tiles.push_back(*tile);
+	CHECK(tiles.size() == 64);
+
+	// Free in an order that merges siblings at different times
+	for (size_t i = 0; i < tiles.size(); i += 2)
+		allocator.free(tiles[i]);
+	CHECK(not allocator.allocate(128).has_value());
+
+	for (size_t i = 1; i < tiles.size(); i += 2)
+		allocator.free(tiles[i]);
+
+	// The buddies merged back into the whole atlas
+	CHECK(allocator.getUsedArea() == 0);
+	const auto whole = allocator.allocate(512);
+	CHECK(whole.has_value());
+	if (whole)
+		CHECK((whole->position == u32_2{0, 0}));
+}
+
+
+TEST(AtlasAllocatorReusesFreedTiles) {
+	AtlasAllocator allocator(256, 64);
+
+	const auto a = allocator.allocate(128);
+	const auto b = allocator.allocate(128);
+	CHECK(a.has_value() and b.has_value());
+
+	if (a) {
+		allocator.free(*a);
+		const auto c = allocator.allocate(128);
+		CHECK(c.has_value());
+		if (c)
+			CHECK(*c == *a);
+	}
+
+	// Clearing frees everything
+	allocator.clear();
+	CHECK(allocator.getUsedArea() == 0);
+	CHECK(allocator.allocate(256).has_value());
+}
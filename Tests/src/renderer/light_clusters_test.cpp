@@ -0,0 +1,208 @@
+#include <set>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+#include "test.h"
+
+import math.geometry;
+import rendering;
+
+using namespace DirectX;
+using namespace render;
+
+
+//----------------------------------------------------------------------------------
+// LightClusters
+//----------------------------------------------------------------------------------
+//
+// The camera is at the origin looking down +z with a 90 degree field of view, so a
+// point at depth z is on screen for x and y in [-z, z]. The depth range [1, 100] is
+// split into 8 slices, each 10^(1/4) times deeper than the last (slice 4 starts at 10).
+//
+//----------------------------------------------------------------------------------
+
+namespace {
+
+constexpr f32_2 z_depth = {1.0f, 100.0f};
+
+[[nodiscard]]
+XMMATRIX GetProjection() {
+	return XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, z_depth[0], z_depth[1]);
+}
+
+void UpdateClusters(LightClusters& clusters,
+                    const std::vector<BoundingSphere>& point_lights,
+                    const std::vector<BoundingSphere>& spot_lights = {}) {
+	const auto projection = GetProjection();
+	clusters.update(XMMatrixIdentity(), projection, z_depth, point_lights, spot_lights);
+}
+
+[[nodiscard]]
+u32 GetPointCount(const LightClusters::Cluster& cluster) {
+	return cluster.counts & 0xFFFFu;
+}
+
+[[nodiscard]]
+u32 GetSpotCount(const LightClusters::Cluster& cluster) {
+	return cluster.counts >> 16;
+}
+
+// The indices of the clusters that contain at least one light
+[[nodiscard]]
+std::set<u32> GetOccupiedClusters(const LightClusters& clusters) {
+	std::set<u32> occupied;
+	for (u32 i = 0; i < clusters.getClusterCount(); ++i) {
+		if (clusters.getClusters()[i].counts != 0)
+			occupied.insert(i);
+	}
+	return occupied;
+}
+
+}
+
+
+TEST(LightClustersSlicesExponentially) {
+	LightClusters clusters(u32_3{4, 4, 8});
+	UpdateClusters(clusters, {});
+
+	CHECK_NEAR(clusters.getSliceDepth(0), 1.0f, 1e-4f);
+	CHECK_NEAR(clusters.getSliceDepth(4), 10.0f, 1e-3f);
+	CHECK_NEAR(clusters.getSliceDepth(8), 100.0f, 1e-2f);
+
+	CHECK(clusters.getSlice(0.5f) == 0);
+	CHECK(clusters.getSlice(1.5f) == 0);
+	CHECK(clusters.getSlice(13.0f) == 4);
+	CHECK(clusters.getSlice(99.0f) == 7);
+	CHECK(clusters.getSlice(500.0f) == 7);
+
+	// Without lights, every cluster is empty
+	CHECK(GetOccupiedClusters(clusters).empty());
+	CHECK(clusters.getLightIndices().empty());
+}
+
+
+TEST(LightClustersBinLightInsideOneCluster) {
+	LightClusters clusters(u32_3{4, 4, 8});
+
+	// Depth [12, 14] is within slice 4, and the light projects into the tile right of and
+	// above the center
+	UpdateClusters(clusters, {BoundingSphere{f32_3{3.25f, 3.25f, 13.0f}, 1.0f}});
+
+	const u32 index = clusters.getClusterIndex(2, 1, 4);
+	CHECK(GetOccupiedClusters(clusters) == std::set<u32>{index});
+
+	const auto& cluster = clusters.getClusters()[index];
+	CHECK(GetPointCount(cluster) == 1);
+	CHECK(GetSpotCount(cluster) == 0);
+	CHECK(clusters.getLightIndices().size() == 1);
+	CHECK(clusters.getLightIndices().at(cluster.offset) == 0);
+}
+
+
+TEST(LightClustersBinLightAcrossSlices) {
+	LightClusters clusters(u32_3{4, 4, 8});
+
+	// Depth [9, 11] straddles the start of slice 4
+	UpdateClusters(clusters, {BoundingSphere{f32_3{3.25f, -3.25f, 10.0f}, 1.0f}});
+
+	const std::set<u32> expected = {clusters.getClusterIndex(2, 2, 3), clusters.getClusterIndex(2, 2, 4)};
+	CHECK(GetOccupiedClusters(clusters) == expected);
+}
+
+
+TEST(LightClustersBinLightAcrossTiles) {
+	LightClusters clusters(u32_3{4, 4, 8});
+
+	// The light is centered on the boundary between the two middle columns
+	UpdateClusters(clusters, {BoundingSphere{f32_3{0.0f, 3.25f, 13.0f}, 1.0f}});
+
+	const std::set<u32> expected = {clusters.getClusterIndex(1, 1, 4), clusters.getClusterIndex(2, 1, 4)};
+	CHECK(GetOccupiedClusters(clusters) == expected);
+	CHECK(clusters.getLightIndices().size() == 2);
+}
+
+
+TEST(LightClustersSkipLightsOutsideOfTheView) {
+	LightClusters clusters(u32_3{4, 4, 8});
+
+	const std::vector<BoundingSphere> lights = {
+		BoundingSphere{f32_3{0.0f, 0.0f, -5.0f}, 1.0f},   //behind the camera
+		BoundingSphere{f32_3{0.0f, 0.0f, 150.0f}, 1.0f},  //beyond the far plane
+		BoundingSphere{f32_3{50.0f, 0.0f, 13.0f}, 1.0f},  //to the right of the view
+	};
+	UpdateClusters(clusters, lights, lights);
+
+	CHECK(GetOccupiedClusters(clusters).empty());
+	CHECK(clusters.getLightIndices().empty());
+
+	// A light crossing the far plane is only binned into the last slice
+	UpdateClusters(clusters, {BoundingSphere{f32_3{0.5f, 0.5f, 100.0f}, 2.0f}});
+
+	const auto occupied = GetOccupiedClusters(clusters);
+	CHECK(not occupied.empty());
+	for (const u32 index : occupied)
+		CHECK((index / 16) == 7);
+}
+
+
+TEST(LightClustersListPointLightsBeforeSpotLights) {
+	LightClusters clusters(u32_3{2, 1, 1});
+
+	const BoundingSphere left{f32_3{-5.0f, 0.0f, 13.0f}, 1.0f};
+	const BoundingSphere right{f32_3{5.0f, 0.0f, 13.0f}, 1.0f};
+
+	UpdateClusters(clusters, {left, right, left}, {right, left});
+
+	const auto& c0 = clusters.getClusters()[0];
+	const auto& c1 = clusters.getClusters()[1];
+	CHECK(GetPointCount(c0) == 2);
+	CHECK(GetSpotCount(c0) == 1);
+	CHECK(GetPointCount(c1) == 1);
+	CHECK(GetSpotCount(c1) == 1);
+
+	// The clusters' ranges are packed, and each lists point lights first
+	const auto& indices = clusters.getLightIndices();
+	CHECK(c0.offset == 0);
+	CHECK(c1.offset == 3);
+	CHECK((indices == std::vector<u32>{0, 2, 1, 1, 0}));
+}
+
+
+TEST(LightClustersClampCountsBeforeComputingOffsets) {
+	LightClusters clusters(u32_3{2, 1, 1});
+
+	const BoundingSphere left{f32_3{-5.0f, 0.0f, 13.0f}, 1.0f};
+	const BoundingSphere right{f32_3{5.0f, 0.0f, 13.0f}, 1.0f};
+
+	// The left cluster has more point lights than a 16-bit count can hold
+	constexpr u32 overflow_count = 0xFFFF + 2;
+	std::vector<BoundingSphere> point_lights(overflow_count, left);
+	point_lights.push_back(right);
+
+	UpdateClusters(clusters, point_lights, {left, left});
+
+	const auto& c0 = clusters.getClusters()[0];
+	const auto& c1 = clusters.getClusters()[1];
+	CHECK(GetPointCount(c0) == 0xFFFF);
+	CHECK(GetSpotCount(c0) == 2);
+
+	// The overflowing point lights are dropped, so the spot lights start right after the
+	// clamped point lights, and the next cluster starts right after those
+	const auto& indices = clusters.getLightIndices();
+	CHECK(c0.offset == 0);
+	CHECK(c1.offset == 0xFFFF + 2);
+	CHECK(indices.size() == 0xFFFF + 3);
+
+	if (indices.size() == 0xFFFF + 3) {
+		CHECK(indices[0xFFFE] == 0xFFFE);
+		CHECK(indices[0xFFFF] == 0);     //first spot light
+		CHECK(indices[0xFFFF + 1] == 1); //second spot light
+		CHECK(indices[c1.offset] == overflow_count);
+	}
+	CHECK(GetPointCount(c1) == 1);
+	CHECK(GetSpotCount(c1) == 0);
+}
\ No newline at end of file
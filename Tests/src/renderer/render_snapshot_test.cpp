@@ -0,0 +1,140 @@
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+#include "memory/handle/handle.h"
+
+#include "test.h"
+
+import ecs;
+import rendering;
+
+using namespace DirectX;
+using namespace render;
+
+
+//----------------------------------------------------------------------------------
+// ExtractRenderSnapshot
+//----------------------------------------------------------------------------------
+//
+// Models and cameras own GPU buffers, so these tests only extract the components
+// that can exist without a device.
+//
+//----------------------------------------------------------------------------------
+
+namespace {
+
+handle64 CreatePointLight(ecs::ECS& ecs, const f32_3& position) {
+	const auto entity = ecs.create();
+
+	auto& transform = ecs.add<Transform>(entity);
+	transform.setPosition(position);
+
+	auto& light = ecs.add<PointLight>(entity);
+	light.setBaseColor(f32_3{1.0f, 0.5f, 0.25f});
+	light.setIntensity(2.0f);
+	light.setRange(5.0f);
+
+	return entity;
+}
+
+}
+
+
+TEST(ExtractSnapshotCopiesActiveLights) {
+	ecs::ECS ecs;
+
+	ecs.add<AmbientLight>(ecs.create()).setColor(f32_3{0.1f, 0.2f, 0.3f});
+	ecs.add<AmbientLight>(ecs.create()).setColor(f32_3{0.1f, 0.1f, 0.1f});
+	ecs.add<AmbientLight>(ecs.create()).setActive(false);
+
+	const auto point = CreatePointLight(ecs, f32_3{1.0f, 2.0f, 3.0f});
+
+	const auto inactive = ecs.create();
+	ecs.add<Transform>(inactive);
+	ecs.add<SpotLight>(inactive).setActive(false);
+
+	const auto directional = ecs.create();
+	ecs.add<Transform>(directional);
+	ecs.add<DirectionalLight>(directional);
+
+	RenderSnapshot snapshot;
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+
+	CHECK_NEAR(snapshot.ambient_light[0], 0.2f, 1e-6f);
+	CHECK_NEAR(snapshot.ambient_light[1], 0.3f, 1e-6f);
+	CHECK_NEAR(snapshot.ambient_light[2], 0.4f, 1e-6f);
+
+	CHECK(snapshot.directional_lights.size() == 1);
+	CHECK(snapshot.point_lights.size() == 1);
+	CHECK(snapshot.spot_lights.empty());
+	CHECK(snapshot.models.empty());
+	CHECK(snapshot.cameras.empty());
+	CHECK(snapshot.shadow_lods.empty());
+
+	if (snapshot.directional_lights.size() == 1)
+		CHECK(snapshot.directional_lights[0].entity == directional);
+
+	if (snapshot.point_lights.size() == 1) {
+		const auto& proxy = snapshot.point_lights[0];
+		const auto& light = ecs.get<PointLight>(point);
+
+		CHECK(proxy.entity == point);
+		CHECK(proxy.range == 5.0f);
+		CHECK(proxy.light_revision == light.getRevision());
+
+		// The intensity is premultiplied by the base color
+		CHECK_NEAR(proxy.intensity[0], 2.0f, 1e-6f);
+		CHECK_NEAR(proxy.intensity[1], 1.0f, 1e-6f);
+		CHECK_NEAR(proxy.intensity[2], 0.5f, 1e-6f);
+
+		// The light's transform is copied
+		CHECK_NEAR(XMVectorGetX(proxy.light_to_world.r[3]), 1.0f, 1e-6f);
+		CHECK_NEAR(XMVectorGetY(proxy.light_to_world.r[3]), 2.0f, 1e-6f);
+		CHECK_NEAR(XMVectorGetZ(proxy.light_to_world.r[3]), 3.0f, 1e-6f);
+	}
+}
+
+
+TEST(ExtractSnapshotReplacesPreviousContents) {
+	ecs::ECS ecs;
+
+	const auto first  = CreatePointLight(ecs, f32_3{0.0f, 0.0f, 0.0f});
+	const auto second = CreatePointLight(ecs, f32_3{4.0f, 0.0f, 0.0f});
+	ecs.add<AmbientLight>(ecs.create()).setColor(f32_3{0.5f, 0.5f, 0.5f});
+
+	// The snapshot is reused between frames, like the slots of the renderer's triple buffer
+	RenderSnapshot snapshot;
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+	CHECK(snapshot.point_lights.size() == 2);
+
+	ecs.get<PointLight>(first).setActive(false);
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+
+	CHECK(snapshot.point_lights.size() == 1);
+	if (snapshot.point_lights.size() == 1)
+		CHECK(snapshot.point_lights[0].entity == second);
+
+	// The ambient light is summed from scratch
+	CHECK_NEAR(snapshot.ambient_light[0], 0.5f, 1e-6f);
+}
+
+
+TEST(ExtractSnapshotTracksLightRevisions) {
+	ecs::ECS ecs;
+	const auto entity = CreatePointLight(ecs, f32_3{0.0f, 0.0f, 0.0f});
+
+	RenderSnapshot snapshot;
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+	const u32 revision = snapshot.point_lights.at(0).light_revision;
+
+	// An unchanged light keeps its revision
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+	CHECK(snapshot.point_lights.at(0).light_revision == revision);
+
+	// Changing a parameter changes the revision, so the renderer rebuilds the light's data
+	ecs.get<PointLight>(entity).setIntensity(4.0f);
+	ExtractRenderSnapshot(ecs, LODSettings{}, snapshot);
+	CHECK(snapshot.point_lights.at(0).light_revision != revision);
+	CHECK_NEAR(snapshot.point_lights.at(0).intensity[0], 4.0f, 1e-6f);
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <optional>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "memory/handle/handle.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+
+
+namespace {
+
+[[nodiscard]]
+ShadowMapKey GetKey(u64 light) {
+	return ShadowMapKey{handle64{light, 0}, 0, handle64{}};
+}
+
+[[nodiscard]]
+ShadowAtlas::Request CreateRequest(u64 light, u32 size, f32 priority) {
+	return ShadowAtlas::Request{GetKey(light), size, priority};
+}
+
+[[nodiscard]]
+std::optional<ShadowAtlas::Tile> GetTile(const ShadowAtlas& atlas, u64 light) {
+	const auto* tile = atlas.getTile(GetKey(light));
+	return tile ? std::optional{*tile} : std::nullopt;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// ShadowAtlas
+//----------------------------------------------------------------------------------
+
+TEST(ShadowAtlasAllocatesRequestedSizes) {
+	ShadowAtlas atlas(1024, 64);
+
+	const std::vector<ShadowAtlas::Request> requests = {
+		CreateRequest(1, 512, 1.0f),
+		CreateRequest(2, 200, 1.0f),
+		CreateRequest(3, 10, 1.0f),
+	};
+	atlas.update(requests);
+
+	CHECK(GetTile(atlas, 1).value_or(ShadowAtlas::Tile{}).size == 512);
+	CHECK(GetTile(atlas, 2).value_or(ShadowAtlas::Tile{}).size == 256);
+	CHECK(GetTile(atlas, 3).value_or(ShadowAtlas::Tile{}).size == 64);
+
+	// Unrequested lights release their tiles
+	atlas.update({});
+	CHECK(not GetTile(atlas, 1).has_value());
+	CHECK(atlas.getAllocator().getUsedArea() == 0);
+}
+
+
+TEST(ShadowAtlasEvictsByPriority) {
+	ShadowAtlas atlas(256, 64);
+
+	// Four 128 texel tiles fill the atlas, so the lowest priority light gets nothing
+	std::vector<ShadowAtlas::Request> requests = {
+		CreateRequest(1, 128, 1.0f),
+		CreateRequest(2, 128, 2.0f),
+		CreateRequest(3, 128, 3.0f),
+		CreateRequest(4, 128, 4.0f),
+		CreateRequest(5, 128, 5.0f),
+	};
+	atlas.update(requests);
+
+	CHECK(not GetTile(atlas, 1).has_value());
+	for (u64 light = 2; light <= 5; ++light)
+		CHECK(GetTile(atlas, light).value_or(ShadowAtlas::Tile{}).size == 128);
+
+	// Raising a light's priority evicts the lowest priority light instead
+	requests[0].priority = 10.0f;
+	atlas.update(requests);
+
+	CHECK(GetTile(atlas, 1).value_or(ShadowAtlas::Tile{}).size == 128);
+	CHECK(not GetTile(atlas, 2).has_value());
+	for (u64 light = 3; light <= 5; ++light)
+		CHECK(GetTile(atlas, light).has_value());
+}
+
+
+TEST(ShadowAtlasKeepsShrunkTilesUntilSpaceIsFree) {
+	ShadowAtlas atlas(256, 64);
+
+	// Light 1 takes a 64 texel tile out of one quadrant, and lights 2-4 take the other three.
+	// Light 5 wants a quadrant too, but only gets a 64 texel tile.
+	std::vector<ShadowAtlas::Request> requests = {
+		CreateRequest(1, 64, 5.0f),
+		CreateRequest(2, 128, 4.0f),
+		CreateRequest(3, 128, 3.0f),
+		CreateRequest(4, 128, 2.0f),
+		CreateRequest(5, 128, 1.0f),
+	};
+	atlas.update(requests);
+
+	const auto shrunk = GetTile(atlas, 5);
+	CHECK(shrunk.has_value());
+	CHECK(shrunk.value_or(ShadowAtlas::Tile{}).size == 64);
+
+	// While the atlas is full, the shrunk tile stays where it is, so its shadow map is kept
+	for (u32 i = 0; i < 3; ++i) {
+		atlas.update(requests);
+		CHECK(GetTile(atlas, 5) == shrunk);
+	}
+
+	// Once a larger block is free, the tile grows into it
+	requests.erase(requests.begin() + 1);
+	atlas.update(requests);
+
+	const auto grown = GetTile(atlas, 5);
+	CHECK(grown.value_or(ShadowAtlas::Tile{}).size == 128);
+	CHECK(atlas.getAllocator().getUsedArea() == (64 * 64) + (3 * 128 * 128));
+}
+
+
+TEST(ShadowAtlasKeepsTilesWhenAnotherLightToggles) {
+	ShadowAtlas atlas(1024, 64);
+
+	const std::vector<ShadowAtlas::Request> all = {
+		CreateRequest(1, 256, 3.0f),
+		CreateRequest(2, 256, 2.0f),
+		CreateRequest(3, 256, 1.0f),
+	};
+	atlas.update(all);
+
+	const auto tile_1 = GetTile(atlas, 1);
+	const auto tile_3 = GetTile(atlas, 3);
+	CHECK(tile_1.has_value() and tile_3.has_value());
+
+	// Light 2 stops casting shadows, then starts again. The other lights keep their tiles.
+	const std::vector<ShadowAtlas::Request> without_2 = {all[0], all[2]};
+	atlas.update(without_2);
+	CHECK(not GetTile(atlas, 2).has_value());
+	CHECK(GetTile(atlas, 1) == tile_1);
+	CHECK(GetTile(atlas, 3) == tile_3);
+
+	atlas.update(all);
+	CHECK(GetTile(atlas, 2).has_value());
+	CHECK(GetTile(atlas, 1) == tile_1);
+	CHECK(GetTile(atlas, 3) == tile_3);
+}
+
+
+TEST(ShadowAtlasReleasesOversizedTiles) {
+	ShadowAtlas atlas(1024, 64);
+
+	atlas.update(std::vector{CreateRequest(1, 512, 1.0f)});
+	const auto large = GetTile(atlas, 1);
+
+	// A tile is kept while the requested size is above a quarter of it
+	atlas.update(std::vector{CreateRequest(1, 256, 1.0f)});
+	CHECK(GetTile(atlas, 1) == large);
+
+	atlas.update(std::vector{CreateRequest(1, 128, 1.0f)});
+	CHECK(GetTile(atlas, 1).value_or(ShadowAtlas::Tile{}).size == 128);
+}
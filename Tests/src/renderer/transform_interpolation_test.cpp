@@ -0,0 +1,130 @@
+#include <chrono>
+
+#include <DirectXMath.h>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+#include "memory/handle/handle.h"
+
+#include "test.h"
+
+import ecs;
+import rendering;
+
+using namespace DirectX;
+using namespace render;
+using namespace std::chrono_literals;
+
+
+namespace {
+
+// An ECS with only the TransformSystem, stepped like Engine::updateSimulation
+class TransformScene {
+public:
+	TransformScene() {
+		ecs.add<systems::TransformSystem>();
+		entity = ecs.create();
+		ecs.add<Transform>(entity);
+	}
+
+	void step() {
+		ecs.update(1.0s / 60.0);
+	}
+
+	void frame(f32 alpha) {
+		ecs.frameUpdate(alpha);
+	}
+
+	[[nodiscard]]
+	Transform& getTransform() {
+		return ecs.get<Transform>(entity);
+	}
+
+private:
+	ecs::ECS ecs;
+	handle64 entity;
+};
+
+void CheckNear(FXMVECTOR a, FXMVECTOR b) {
+	CHECK_NEAR(XMVectorGetX(a), XMVectorGetX(b), 1e-4f);
+	CHECK_NEAR(XMVectorGetY(a), XMVectorGetY(b), 1e-4f);
+	CHECK_NEAR(XMVectorGetZ(a), XMVectorGetZ(b), 1e-4f);
+}
+
+// The direction the render matrix faces
+[[nodiscard]]
+XMVECTOR XM_CALLCONV GetRenderForward(const Transform& transform) {
+	return XMVector3Normalize(transform.getRenderObjectToWorldMatrix().r[2]);
+}
+
+[[nodiscard]]
+XMVECTOR XM_CALLCONV GetRenderPosition(const Transform& transform) {
+	return transform.getRenderObjectToWorldMatrix().r[3];
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// Transform Interpolation
+//----------------------------------------------------------------------------------
+
+TEST(TransformBlendsBetweenSteps) {
+	TransformScene scene;
+	scene.step();
+
+	scene.getTransform().setPosition(f32_3{4.0f, 0.0f, 0.0f});
+	scene.step();
+
+	scene.frame(0.25f);
+	CheckNear(GetRenderPosition(scene.getTransform()), XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f));
+
+	scene.frame(1.0f);
+	CheckNear(GetRenderPosition(scene.getTransform()), XMVectorSet(4.0f, 0.0f, 0.0f, 1.0f));
+}
+
+
+TEST(TransformShowsPerFrameChangesImmediately) {
+	TransformScene scene;
+	scene.step();
+
+	// The transform moves during the step, so it's blended
+	scene.getTransform().setPosition(f32_3{4.0f, 0.0f, 0.0f});
+	scene.step();
+
+	// A rotation made between steps (e.g. mouse look) is shown in full in the same frame,
+	// while the step's movement is still blended
+	scene.getTransform().rotateY(XM_PIDIV2);
+	scene.frame(0.5f);
+
+	CheckNear(GetRenderForward(scene.getTransform()), scene.getTransform().getWorldAxisZ());
+	CheckNear(GetRenderPosition(scene.getTransform()), XMVectorSet(2.0f, 0.0f, 0.0f, 1.0f));
+
+	// The rotation doesn't jump back or forward over the following frames and steps
+	const XMVECTOR forward = scene.getTransform().getWorldAxisZ();
+
+	scene.frame(0.75f);
+	CheckNear(GetRenderForward(scene.getTransform()), forward);
+
+	scene.step();
+	scene.frame(0.0f);
+	CheckNear(GetRenderForward(scene.getTransform()), forward);
+	CheckNear(GetRenderPosition(scene.getTransform()), XMVectorSet(4.0f, 0.0f, 0.0f, 1.0f));
+}
+
+
+TEST(TransformShowsPerFrameChangesOfStillTransforms) {
+	TransformScene scene;
+	scene.step();
+	scene.step();
+
+	// Nothing moved during the step, so the rotation is rendered as is
+	scene.getTransform().rotateY(0.3f);
+	scene.frame(0.5f);
+
+	CheckNear(GetRenderForward(scene.getTransform()), scene.getTransform().getWorldAxisZ());
+
+	const u32 revision = scene.getTransform().getRenderRevision();
+	scene.frame(0.6f);
+	CHECK(scene.getTransform().getRenderRevision() == revision);
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <limits>
+#include <memory>
+#include <span>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+#include "memory/handle/handle.h"
+
+#include "directx/d3d11.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+
+
+namespace {
+
+// Each level's error is 4x the previous level's. With the default settings a level is
+// coarsened to when its error is at most 0.75 pixels, and refined from when its error is
+// over 1.25 pixels.
+constexpr MeshLOD lods[] = {
+	MeshLOD{0, 12, 0.0f},
+	MeshLOD{0, 6,  0.01f},
+	MeshLOD{0, 3,  0.04f},
+	MeshLOD{0, 3,  0.16f},
+};
+
+[[nodiscard]]
+u32 Select(f32 projected_radius, u32 current_lod, const LODSettings& settings = {}) {
+	return SelectLOD(std::span{lods}, projected_radius, current_lod, settings);
+}
+
+[[nodiscard]]
+ComPtr<ID3D11Device> CreateWARPDevice() {
+	ComPtr<ID3D11Device> device;
+	D3D11CreateDevice(nullptr,
+	                  D3D_DRIVER_TYPE_WARP,
+	                  nullptr,
+	                  0,
+	                  nullptr,
+	                  0,
+	                  D3D11_SDK_VERSION,
+	                  device.GetAddressOf(),
+	                  nullptr,
+	                  nullptr);
+	return device;
+}
+
+// A blueprint with one mesh that has 3 levels of detail: a quad, and one of its triangles twice
+[[nodiscard]]
+std::shared_ptr<ModelBlueprint> CreateLODBlueprint(ID3D11Device& device, MaterialRegistry& material_registry) {
+	ModelOutput::MeshData mesh;
+	mesh.name      = "LOD Quad";
+	mesh.positions = {f32_3{0.0f, 0.0f, 0.0f}, f32_3{1.0f, 0.0f, 0.0f}, f32_3{1.0f, 1.0f, 0.0f}, f32_3{0.0f, 1.0f, 0.0f}};
+	mesh.indices   = {0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 1, 2};
+	mesh.lods      = {MeshLOD{0, 6, 0.0f}, MeshLOD{6, 3, 0.1f}, MeshLOD{9, 3, 0.2f}};
+
+	ModelOutput out;
+	out.name = "LOD Quad";
+	out.root.name = out.name;
+	out.root.mesh_indices.push_back(0);
+	out.materials.push_back(Material{});
+	out.meshes.push_back(std::move(mesh));
+
+	return std::make_shared<ModelBlueprint>(device, material_registry, out, ModelConfig<VertexPositionNormalTexture>{});
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// SelectLOD
+//----------------------------------------------------------------------------------
+
+TEST(SelectLODUsesProjectedSize) {
+	// The coarsest level with an error of at most 0.75 pixels
+	CHECK(Select(200.0f, 0) == 0); //errors: 2, 8, 32
+	CHECK(Select(50.0f,  0) == 1); //errors: 0.5, 2, 8
+	CHECK(Select(10.0f,  0) == 2); //errors: 0.1, 0.4, 1.6
+	CHECK(Select(1.0f,   0) == 3); //errors: 0.01, 0.04, 0.16
+
+	// A larger pixel error allows coarser levels
+	CHECK(Select(10.0f, 0, LODSettings{4.0f, 0.25f}) == 3);
+
+	// The camera is inside the bounding sphere
+	CHECK(Select(std::numeric_limits<f32>::infinity(), 0) == 0);
+	CHECK(Select(std::numeric_limits<f32>::infinity(), 3) == 0);
+}
+
+
+TEST(SelectLODWithOneLevel) {
+	const MeshLOD single[] = {MeshLOD{0, 3, 0.0f}};
+	CHECK(SelectLOD(std::span{single}, 1.0f, 0, LODSettings{}) == 0);
+	CHECK(SelectLOD(std::span{single}, 1.0f, 5, LODSettings{}) == 0);
+	CHECK(SelectLOD(std::span<const MeshLOD>{}, 1.0f, 0, LODSettings{}) == 0);
+
+	// An out of range current level is clamped to the coarsest level
+	CHECK(Select(1.0f, 10) == 3);
+}
+
+
+TEST(SelectLODHoldsLevelWithinHysteresisBand) {
+	// Level 1 is coarsened to below a radius of 75 pixels, and refined from above 125 pixels
+	CHECK(Select(100.0f, 0) == 0);
+	CHECK(Select(100.0f, 1) == 1);
+
+	CHECK(Select(80.0f,  0) == 0);
+	CHECK(Select(120.0f, 1) == 1);
+
+	// Without hysteresis, both levels switch at 100 pixels
+	const LODSettings no_hysteresis{1.0f, 0.0f};
+	CHECK(Select(90.0f,  0, no_hysteresis) == 1);
+	CHECK(Select(110.0f, 1, no_hysteresis) == 0);
+}
+
+
+TEST(SelectLODTransitionsOutsideOfHysteresisBand) {
+	// Down in detail
+	CHECK(Select(70.0f, 0) == 1);
+	CHECK(Select(17.0f, 1) == 2); //0.68 pixels
+	CHECK(Select(4.0f,  2) == 3); //0.64 pixels
+
+	// Up in detail
+	CHECK(Select(130.0f, 1) == 0); //1.3 pixels
+	CHECK(Select(32.0f,  2) == 1); //1.28 pixels
+	CHECK(Select(8.0f,   3) == 2); //1.28 pixels
+
+	// Several levels at once. Refining stops at the first level within the band.
+	CHECK(Select(1.0f,   0) == 3);
+	CHECK(Select(100.0f, 3) == 1);
+	CHECK(Select(200.0f, 3) == 0);
+}
+
+
+//----------------------------------------------------------------------------------
+// Model LOD Selection
+//----------------------------------------------------------------------------------
+
+TEST(ModelKeepsLODPerCamera) {
+	const auto device = CreateWARPDevice();
+	CHECK(device != nullptr);
+	if (not device)
+		return;
+
+	MaterialRegistry material_registry;
+	const auto blueprint = CreateLODBlueprint(*device.Get(), material_registry);
+
+	Model model(*device.Get(), blueprint, 0);
+	CHECK(model.getLODCount() == 3);
+
+	const handle64 camera_a{1, 0};
+	const handle64 camera_b{2, 0};
+
+	// A camera that hasn't rendered the model uses full detail
+	CHECK(model.getLOD(camera_a) == 0);
+
+	// Each camera keeps its own level
+	model.setLOD(camera_a, 2);
+	model.setLOD(camera_b, 1);
+	CHECK(model.getLOD(camera_a) == 2);
+	CHECK(model.getLOD(camera_b) == 1);
+
+	model.setLOD(camera_b, 0);
+	CHECK(model.getLOD(camera_a) == 2);
+	CHECK(model.getLOD(camera_b) == 0);
+
+	// The level is clamped to the mesh's levels
+	model.setLOD(camera_b, 10);
+	CHECK(model.getLOD(camera_b) == 2);
+	CHECK(model.getLODRange(model.getLOD(camera_b)).index_offset == 9);
+
+	// The levels of removed cameras are forgotten
+	const handle64 active[] = {camera_b};
+	model.retainLODs(active);
+	CHECK(model.getLOD(camera_a) == 0);
+	CHECK(model.getLOD(camera_b) == 2);
+
+	model.retainLODs({});
+	CHECK(model.getLOD(camera_b) == 0);
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "resource/shader/shader_cache.h"
+
+#include "test.h"
+
+using namespace render::ShaderCache;
+
+
+namespace {
+
+// A directory under the system's temp directory that's removed when the test ends
+class TempDirectory {
+public:
+	TempDirectory() {
+		static std::atomic<u32> counter = 0;
+		path = fs::temp_directory_path() / ("shader_cache_test_" + std::to_string(counter++));
+		fs::remove_all(path);
+		fs::create_directories(path);
+	}
+
+	TempDirectory(const TempDirectory&) = delete;
+
+	~TempDirectory() {
+		std::error_code error;
+		fs::remove_all(path, error);
+	}
+
+	TempDirectory& operator=(const TempDirectory&) = delete;
+
+	[[nodiscard]]
+	const fs::path& get() const noexcept {
+		return path;
+	}
+
+private:
+	fs::path path;
+};
+
+void WriteFile(const fs::path& file, std::string_view contents) {
+	fs::create_directories(file.parent_path());
+	std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+	stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+[[nodiscard]]
+ShaderPermutation CreatePermutation() {
+	ShaderPermutation permutation;
+	permutation.source      = "float4 main() : SV_Target { return 1; }";
+	permutation.source_file = "shaders/forward/forward_ps.hlsl";
+	permutation.defines     = {ShaderDefine{"SHADOWS", "1"}, ShaderDefine{"CLUSTERED", "0"}};
+	permutation.entry_point = "main";
+	permutation.target      = "ps_5_0";
+	permutation.flags       = 0x800;
+	return permutation;
+}
+
+[[nodiscard]]
+std::vector<std::byte> CreateBytecode(size_t size) {
+	std::vector<std::byte> bytecode(size);
+	for (size_t i = 0; i < size; ++i)
+		bytecode[i] = static_cast<std::byte>((i * 31) & 0xFF);
+	return bytecode;
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// Permutation Keys
+//----------------------------------------------------------------------------------
+
+TEST(PermutationKeyIsDeterministic) {
+	CHECK(GetPermutationKey(CreatePermutation()) == GetPermutationKey(CreatePermutation()));
+}
+
+
+TEST(PermutationKeyDependsOnEveryInput) {
+	const u64 key = GetPermutationKey(CreatePermutation());
+
+	const auto changed_key = [](auto&& change) {
+		auto permutation = CreatePermutation();
+		change(permutation);
+		return GetPermutationKey(permutation);
+	};
+
+	CHECK(changed_key([](ShaderPermutation& p) { p.source += " "; }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.source_file = "shaders/other/forward_ps.hlsl"; }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.defines[0].value = "0"; }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.defines.pop_back(); }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.entry_point = "PS"; }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.target = "ps_5_1"; }) != key);
+	CHECK(changed_key([](ShaderPermutation& p) { p.flags = 0; }) != key);
+
+	// The file name itself doesn't matter, only the directory includes are resolved from
+	CHECK(changed_key([](ShaderPermutation& p) { p.source_file = "shaders/forward/copy.hlsl"; }) == key);
+}
+
+
+TEST(PermutationKeySeparatesAdjacentValues) {
+	// Values are hashed with their sizes, so moving characters between them changes the key
+	auto a = CreatePermutation();
+	a.defines = {ShaderDefine{"AB", "C"}};
+
+	auto b = CreatePermutation();
+	b.defines = {ShaderDefine{"A", "BC"}};
+
+	CHECK(GetPermutationKey(a) != GetPermutationKey(b));
+}
+
+
+//----------------------------------------------------------------------------------
+// Include Scanning
+//----------------------------------------------------------------------------------
+
+TEST(ScanIncludesFindsDirectives) {
+	constexpr std::string_view source =
+		"#include \"global.hlsl\"\n"
+		"  #  include <light/lights.hlsl>\r\n"
+		"#ifdef SHADOWS\n"
+		"\t#include \"shadows.hlsl\"\n"
+		"#endif\n"
+		"float4 main() : SV_Target { return 1; }";
+
+	const auto includes = ScanIncludes(source);
+
+	CHECK(includes.size() == 3);
+	if (includes.size() == 3) {
+		CHECK(includes[0] == "global.hlsl");
+		CHECK(includes[1] == "light/lights.hlsl");
+		CHECK(includes[2] == "shadows.hlsl");
+	}
+}
+
+
+TEST(ScanIncludesIgnoresComments) {
+	constexpr std::string_view source =
+		"// #include \"line_comment.hlsl\"\n"
+		"/* #include \"block_comment.hlsl\"\n"
+		"#include \"inside_block_comment.hlsl\" */\n"
+		"static const char* path = \"// not a comment\";\n"
+		"#include \"real.hlsl\" // trailing comment\n"
+		"#define NAME include\n";
+
+	const auto includes = ScanIncludes(source);
+
+	CHECK(includes.size() == 1);
+	if (includes.size() == 1)
+		CHECK(includes[0] == "real.hlsl");
+}
+
+
+TEST(ResolveIncludesFollowsNestedIncludes) {
+	const TempDirectory dir;
+
+	WriteFile(dir.get() / "a.hlsl", "#include \"sub/b.hlsl\"\n#include \"missing.hlsl\"\n");
+	WriteFile(dir.get() / "sub/b.hlsl", "#include \"c.hlsl\"\n");
+	WriteFile(dir.get() / "sub/c.hlsl", "#include \"../a.hlsl\"\nfloat c;\n");
+
+	const auto dependencies = ResolveIncludes("#include \"a.hlsl\"\n#include \"a.hlsl\"\n", dir.get() / "shader.hlsl");
+
+	// Each file is listed once, includes are resolved relative to the including file, and
+	// missing files are skipped
+	CHECK(dependencies.size() == 3);
+	if (dependencies.size() == 3) {
+		CHECK(dependencies[0].file.filename() == "a.hlsl");
+		CHECK(dependencies[1].file.filename() == "b.hlsl");
+		CHECK(dependencies[2].file.filename() == "c.hlsl");
+
+		for (const auto& [file, hash] : dependencies) {
+			CHECK(hash == HashFile(file));
+			CHECK(hash != 0);
+		}
+	}
+}
+
+
+//----------------------------------------------------------------------------------
+// Cache Files
+//----------------------------------------------------------------------------------
+
+TEST(CacheRoundTrip) {
+	const TempDirectory dir;
+
+	const auto include = dir.get() / "include.hlsl";
+	WriteFile(include, "float value;\n");
+
+	const u64  key      = GetPermutationKey(CreatePermutation());
+	const auto bytecode = CreateBytecode(1000);
+	const IncludeDependency dependency{include, HashFile(include)};
+
+	CHECK(not ReadCache(dir.get(), key).has_value());
+	CHECK(WriteCache(dir.get() / "cache", key, std::span{&dependency, 1}, bytecode));
+
+	const auto cached = ReadCache(dir.get() / "cache", key);
+	CHECK(cached.has_value());
+	if (cached)
+		CHECK(*cached == bytecode);
+
+	// No temporary files are left behind
+	size_t file_count = 0;
+	for ([[maybe_unused]] const auto& entry : fs::directory_iterator(dir.get() / "cache"))
+		++file_count;
+	CHECK(file_count == 1);
+
+	// Other keys don't match the entry
+	CHECK(not ReadCache(dir.get() / "cache", key + 1).has_value());
+}
+
+
+TEST(CacheEntryIsInvalidatedByIncludeChanges) {
+	const TempDirectory dir;
+
+	const auto include = dir.get() / "include.hlsl";
+	WriteFile(include, "float value;\n");
+
+	const u64 key = 0x1234;
+	const IncludeDependency dependency{include, HashFile(include)};
+	CHECK(WriteCache(dir.get(), key, std::span{&dependency, 1}, CreateBytecode(64)));
+	CHECK(ReadCache(dir.get(), key).has_value());
+
+	WriteFile(include, "float other_value;\n");
+	CHECK(not ReadCache(dir.get(), key).has_value());
+
+	// A deleted include also invalidates the entry
+	fs::remove(include);
+	CHECK(not ReadCache(dir.get(), key).has_value());
+}
+
+
+TEST(CacheRejectsTruncatedEntries) {
+	const TempDirectory dir;
+
+	const u64 key = 0x5678;
+	CHECK(WriteCache(dir.get(), key, {}, CreateBytecode(256)));
+
+	const auto file = GetCachePath(dir.get(), key);
+	fs::resize_file(file, fs::file_size(file) - 1);
+
+	CHECK(not ReadCache(dir.get(), key).has_value());
+}
\ No newline at end of file
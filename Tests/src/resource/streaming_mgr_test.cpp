@@ -0,0 +1,447 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+
+#include "test.h"
+
+import rendering;
+
+using namespace render;
+
+
+namespace {
+
+struct FakeResource {
+	std::wstring name;
+};
+
+// A file source with fixed file sizes. Loads complete when the test calls completeAll(),
+// or during load() if the source is synchronous.
+class FakeFileSource final : public IStreamingSource {
+public:
+	explicit FakeFileSource(bool synchronous = false) : synchronous(synchronous) {
+	}
+
+	void addFile(const std::wstring& name, u64 size, u64 estimated_size) {
+		files[name] = File{size, estimated_size};
+	}
+
+	void addFile(const std::wstring& name, u64 size) {
+		addFile(name, size, size);
+	}
+
+	void load(const std::wstring& name, Callback on_complete) override {
+		load_order.push_back(name);
+		pending.emplace_back(name, std::move(on_complete));
+		if (synchronous)
+			completeAll();
+	}
+
+	[[nodiscard]]
+	u64 estimateSize(const std::wstring& name) const override {
+		const auto it = files.find(name);
+		return (it != files.end()) ? it->second.estimated_size : 0;
+	}
+
+	// Complete the pending loads. Loads of unknown files fail.
+	void completeAll() {
+		auto loads = std::exchange(pending, {});
+		for (auto& [name, callback] : loads) {
+			const auto it = files.find(name);
+			if (it == files.end())
+				callback(LoadResult{});
+			else
+				callback(LoadResult{std::make_shared<FakeResource>(name), it->second.size});
+		}
+	}
+
+	[[nodiscard]]
+	size_t getPendingCount() const noexcept {
+		return pending.size();
+	}
+
+	// The names passed to load(), in order
+	std::vector<std::wstring> load_order;
+
+private:
+	struct File {
+		u64 size = 0;
+		u64 estimated_size = 0;
+	};
+
+	bool synchronous;
+	std::unordered_map<std::wstring, File> files;
+	std::vector<std::pair<std::wstring, Callback>> pending;
+};
+
+[[nodiscard]]
+StreamingMgr CreateStreamingMgr(std::shared_ptr<FakeFileSource> source, u64 budget, u32 max_in_flight = 4) {
+	return StreamingMgr{std::move(source), StreamingMgr::Config{budget, max_in_flight}};
+}
+
+}
+
+
+//----------------------------------------------------------------------------------
+// Loading
+//----------------------------------------------------------------------------------
+
+TEST(StreamingLoadsByPriority) {
+	auto source = std::make_shared<FakeFileSource>();
+	source->addFile(L"a", 10);
+	source->addFile(L"b", 10);
+	source->addFile(L"c", 10);
+	source->addFile(L"d", 10);
+
+	auto mgr = CreateStreamingMgr(source, 1000, 2);
+
+	const auto request_all = [&] {
+		mgr.request(L"a", 0.1f);
+		mgr.request(L"b", 0.3f);
+		mgr.request(L"c", 0.2f);
+		mgr.request(L"d", 0.3f);
+	};
+
+	// At most two loads are in flight. Ties are broken by name.
+	request_all();
+	mgr.update();
+	CHECK((source->load_order == std::vector<std::wstring>{L"b", L"d"}));
+	CHECK(mgr.getStats().in_flight_count == 2);
+	CHECK(mgr.getStats().queued_count == 2);
+
+	// Nothing else starts until a load completes
+	request_all();
+	mgr.update();
+	CHECK(source->load_order.size() == 2);
+
+	source->completeAll();
+	request_all();
+	mgr.update();
+	CHECK((source->load_order == std::vector<std::wstring>{L"b", L"d", L"c", L"a"}));
+	CHECK(mgr.isResident(L"b"));
+	CHECK(mgr.isResident(L"d"));
+	CHECK(not mgr.isResident(L"a"));
+}
+
+
+TEST(StreamingUsesHighestPriorityOfAFrame) {
+	auto source = std::make_shared<FakeFileSource>();
+	source->addFile(L"a", 10);
+	source->addFile(L"b", 10);
+
+	auto mgr = CreateStreamingMgr(source, 1000, 1);
+
+	mgr.request(L"a", 0.5f);
+	mgr.request(L"b", 0.2f);
+	mgr.request(L"b", 0.9f);
+	mgr.request(L"b", 0.1f);
+	mgr.update();
+
+	CHECK((source->load_order == std::vector<std::wstring>{L"b"}));
+}
+
+
+TEST(StreamingCompletesLoadsOnUpdate) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"texture", 64);
+
+	auto mgr = CreateStreamingMgr(source, 1000);
+
+	// The load completed inside load(), but is only processed by the next update
+	mgr.request(L"texture", 1.0f);
+	mgr.update();
+	CHECK(not mgr.isResident(L"texture"));
+	CHECK(mgr.get<FakeResource>(L"texture") == nullptr);
+
+	mgr.update();
+	CHECK(mgr.isResident(L"texture"));
+
+	const auto resource = mgr.get<FakeResource>(L"texture");
+	CHECK(resource != nullptr);
+	if (resource)
+		CHECK(resource->name == L"texture");
+
+	const auto stats = mgr.getStats();
+	CHECK(stats.resident_count == 1);
+	CHECK(stats.resident_bytes == 64);
+	CHECK(stats.total_loaded == 1);
+}
+
+
+TEST(StreamingDropsUnrequestedQueuedLoads) {
+	auto source = std::make_shared<FakeFileSource>();
+	source->addFile(L"a", 10);
+	source->addFile(L"b", 10);
+
+	auto mgr = CreateStreamingMgr(source, 1000, 1);
+
+	mgr.request(L"a", 1.0f);
+	mgr.request(L"b", 0.5f);
+	mgr.update();
+	CHECK(mgr.getStats().queued_count == 1);
+
+	// b is queued behind a, but isn't requested again
+	source->completeAll();
+	mgr.update();
+	CHECK(mgr.getStats().queued_count == 0);
+	CHECK((source->load_order == std::vector<std::wstring>{L"a"}));
+
+	// A released request is dropped immediately
+	mgr.request(L"b", 0.5f);
+	mgr.release(L"b");
+	mgr.update();
+	CHECK(source->load_order.size() == 1);
+}
+
+
+TEST(StreamingRetriesFailedLoadsOnceUnrequested) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	auto mgr    = CreateStreamingMgr(source, 1000);
+
+	mgr.request(L"missing", 1.0f);
+	mgr.update();
+	mgr.request(L"missing", 1.0f);
+	mgr.update();
+
+	CHECK(not mgr.isResident(L"missing"));
+	CHECK(mgr.getStats().total_failed == 1);
+
+	// A failed resource isn't reloaded while it's requested every frame
+	mgr.request(L"missing", 1.0f);
+	mgr.update();
+	CHECK(source->load_order.size() == 1);
+
+	// Once it's no longer requested, it's forgotten and the next request tries again
+	mgr.update();
+	source->addFile(L"missing", 10);
+	mgr.request(L"missing", 1.0f);
+	mgr.update();
+	mgr.update();
+
+	CHECK(source->load_order.size() == 2);
+	CHECK(mgr.isResident(L"missing"));
+}
+
+
+//----------------------------------------------------------------------------------
+// Memory Budget
+//----------------------------------------------------------------------------------
+
+TEST(StreamingKeepsWithinBudget) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"a", 40);
+	source->addFile(L"b", 40);
+	source->addFile(L"c", 40);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	// c doesn't fit while a and b are requested
+	for (u32 i = 0; i < 3; ++i) {
+		mgr.request(L"a", 0.3f);
+		mgr.request(L"b", 0.2f);
+		mgr.request(L"c", 0.1f);
+		mgr.update();
+	}
+
+	auto stats = mgr.getStats();
+	CHECK(stats.resident_count == 2);
+	CHECK(stats.resident_bytes == 80);
+	CHECK(stats.queued_count == 1);
+	CHECK(not mgr.isResident(L"c"));
+
+	// Once a is no longer requested, it's evicted to make room for c
+	for (u32 i = 0; i < 2; ++i) {
+		mgr.request(L"b", 0.2f);
+		mgr.request(L"c", 0.1f);
+		mgr.update();
+	}
+
+	stats = mgr.getStats();
+	CHECK(not mgr.isResident(L"a"));
+	CHECK(mgr.isResident(L"b"));
+	CHECK(mgr.isResident(L"c"));
+	CHECK(stats.resident_bytes == 80);
+	CHECK(stats.total_evicted == 1);
+}
+
+
+TEST(StreamingKeepsUnusedResourcesUntilOverBudget) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"a", 40);
+	source->addFile(L"b", 40);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	mgr.request(L"a", 1.0f);
+	mgr.update();
+	mgr.update();
+	mgr.update();
+
+	// a is unrequested but fits, so it stays resident
+	auto stats = mgr.getStats();
+	CHECK(mgr.isResident(L"a"));
+	CHECK(stats.evictable_count == 1);
+	CHECK(stats.evictable_bytes == 40);
+
+	mgr.request(L"b", 1.0f);
+	mgr.update();
+	mgr.update();
+	CHECK(mgr.isResident(L"a"));
+	CHECK(mgr.isResident(L"b"));
+	CHECK(mgr.getStats().total_evicted == 0);
+}
+
+
+TEST(StreamingEvictsLeastRecentlyRequested) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"a", 30);
+	source->addFile(L"b", 30);
+	source->addFile(L"c", 30);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	// Request a, then b, then c, each for one frame
+	for (const auto* name : {L"a", L"b", L"c"}) {
+		mgr.request(name, 1.0f);
+		mgr.update();
+	}
+	mgr.update();
+	CHECK(mgr.getStats().resident_count == 3);
+
+	// Lowering the budget evicts the oldest resources first
+	mgr.setMemoryBudget(60);
+	mgr.update();
+
+	CHECK(not mgr.isResident(L"a"));
+	CHECK(mgr.isResident(L"b"));
+	CHECK(mgr.isResident(L"c"));
+	CHECK(mgr.getStats().resident_bytes == 60);
+}
+
+
+TEST(StreamingNeverEvictsReferencedResources) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"a", 60);
+	source->addFile(L"b", 60);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	mgr.request(L"a", 1.0f);
+	mgr.update();
+	mgr.update();
+
+	// a is unrequested, but still used outside of the manager
+	auto reference = mgr.get<FakeResource>(L"a");
+	CHECK(reference != nullptr);
+
+	for (u32 i = 0; i < 2; ++i) {
+		mgr.request(L"b", 1.0f);
+		mgr.update();
+	}
+
+	CHECK(mgr.isResident(L"a"));
+	CHECK(not mgr.isResident(L"b"));
+	CHECK(mgr.getStats().evictable_count == 0);
+
+	// Dropping the reference lets b replace it
+	reference.reset();
+	for (u32 i = 0; i < 2; ++i) {
+		mgr.request(L"b", 1.0f);
+		mgr.update();
+	}
+
+	CHECK(not mgr.isResident(L"a"));
+	CHECK(mgr.isResident(L"b"));
+}
+
+
+TEST(StreamingReservesBudgetForLoadsInFlight) {
+	auto source = std::make_shared<FakeFileSource>();
+	source->addFile(L"a", 50);
+	source->addFile(L"b", 50);
+	source->addFile(L"c", 50);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	// Loads in flight count against the budget, so c isn't started
+	mgr.request(L"a", 0.3f);
+	mgr.request(L"b", 0.2f);
+	mgr.request(L"c", 0.1f);
+	mgr.update();
+
+	CHECK(source->getPendingCount() == 2);
+	CHECK(mgr.getStats().in_flight_count == 2);
+	CHECK(mgr.getStats().queued_count == 1);
+}
+
+
+TEST(StreamingLoadsOversizedResourcesAlone) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"small", 10);
+	source->addFile(L"huge", 500);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	// A resource larger than the budget waits until nothing else is resident
+	mgr.request(L"small", 1.0f);
+	mgr.update();
+	mgr.request(L"small", 1.0f);
+	mgr.request(L"huge", 0.5f);
+	mgr.update();
+	CHECK(not mgr.isResident(L"huge"));
+
+	mgr.request(L"huge", 0.5f);
+	mgr.update();
+	mgr.request(L"huge", 0.5f);
+	mgr.update();
+
+	CHECK(not mgr.isResident(L"small"));
+	CHECK(mgr.isResident(L"huge"));
+}
+
+
+TEST(StreamingUsesLoadedSize) {
+	auto source = std::make_shared<FakeFileSource>(true);
+	source->addFile(L"a", 80, 20);
+	source->addFile(L"b", 40);
+
+	auto mgr = CreateStreamingMgr(source, 100);
+
+	// The estimate reserves 20 bytes, but the loaded resource uses 80
+	mgr.request(L"a", 1.0f);
+	mgr.update();
+	mgr.update();
+	CHECK(mgr.getStats().resident_bytes == 80);
+
+	// The next update evicts it once it's unrequested, since b no longer fits
+	mgr.request(L"b", 1.0f);
+	mgr.update();
+	mgr.request(L"b", 1.0f);
+	mgr.update();
+
+	CHECK(not mgr.isResident(L"a"));
+	CHECK(mgr.isResident(L"b"));
+	CHECK(mgr.getStats().resident_bytes == 40);
+}
+
+
+TEST(StreamingIgnoresLoadsCompletedAfterDestruction) {
+	auto source = std::make_shared<FakeFileSource>();
+	source->addFile(L"a", 10);
+
+	{
+		auto mgr = CreateStreamingMgr(source, 100);
+		mgr.request(L"a", 1.0f);
+		mgr.update();
+	}
+
+	// The callback outlives the manager
+	CHECK(source->getPendingCount() == 1);
+	source->completeAll();
+	CHECK(source->getPendingCount() == 0);
+}
\ No newline at end of file
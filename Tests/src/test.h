@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+//----------------------------------------------------------------------------------
+// Test Registry
+//----------------------------------------------------------------------------------
+//
+// A minimal test runner. TEST(name) defines a test function and registers it, and
+// the CHECK macros record a failure without ending the test. main() runs every
+// registered test, and returns a non-zero exit code if any check failed or any test
+// threw an exception.
+//
+//----------------------------------------------------------------------------------
+struct TestCase {
+	const char* name;
+	void (*func)();
+};
+
+[[nodiscard]]
+inline std::vector<TestCase>& GetTests() {
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+[[nodiscard]]
+inline size_t& GetFailureCount() {
+	static size_t count = 0;
+	return count;
+}
+
+struct TestRegistrar {
+	TestRegistrar(const char* name, void (*func)()) {
+		GetTests().push_back(TestCase{name, func});
+	}
+};
+
+inline void ReportFailure(const char* file, int line, const char* expression) {
+	++GetFailureCount();
+	std::fprintf(stderr, "  %s(%d): CHECK(%s) failed\n", file, line, expression);
+}
+
+
+#define TEST(name)                                                  \
+	static void name();                                             \
+	static const TestRegistrar name##_registrar{#name, &name};      \
+	static void name()
+
+#define CHECK(expression)                                           \
+	do {                                                            \
+		if (not (expression))                                       \
+			ReportFailure(__FILE__, __LINE__, #expression);         \
+	} while (false)
+
+#define CHECK_NEAR(a, b, epsilon)                                   \
+	CHECK(std::abs(static_cast<double>(a) - static_cast<double>(b)) <= static_cast<double>(epsilon))
\ No newline at end of file
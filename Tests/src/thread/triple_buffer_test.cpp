@@ -0,0 +1,131 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "thread/triple_buffer.h"
+
+#include "test.h"
+
+
+namespace {
+
+// A slot with a value repeated through a vector, so a torn read would show up as a
+// mismatch between the elements
+struct Payload {
+	u32 sequence = 0;
+	std::vector<u32> values;
+};
+
+}
+
+
+//----------------------------------------------------------------------------------
+// TripleBuffer
+//----------------------------------------------------------------------------------
+
+TEST(TripleBufferStartsEmpty) {
+	TripleBuffer<u32> buffer;
+
+	CHECK(not buffer.hasPublished());
+	CHECK(buffer.acquire() == 0);
+}
+
+
+TEST(TripleBufferAcquiresLatestPublish) {
+	TripleBuffer<u32> buffer;
+
+	buffer.getWriteSlot() = 1;
+	buffer.publish();
+	CHECK(buffer.hasPublished());
+	CHECK(buffer.acquire() == 1);
+	CHECK(not buffer.hasPublished());
+
+	// Without a new publish, the same slot is acquired again
+	CHECK(buffer.acquire() == 1);
+
+	// Unread publishes are overwritten, and only the newest one is seen
+	buffer.getWriteSlot() = 2;
+	buffer.publish();
+	buffer.getWriteSlot() = 3;
+	buffer.publish();
+	CHECK(buffer.acquire() == 3);
+}
+
+
+TEST(TripleBufferNeverSharesSlots) {
+	TripleBuffer<u32> buffer;
+
+	// The acquired slot stays untouched while the producer keeps writing
+	buffer.getWriteSlot() = 1;
+	buffer.publish();
+	const u32& front = buffer.acquire();
+
+	for (u32 i = 2; i < 10; ++i) {
+		CHECK(&buffer.getWriteSlot() != &front);
+		buffer.getWriteSlot() = i;
+		buffer.publish();
+		CHECK(front == 1);
+	}
+
+	CHECK(buffer.acquire() == 9);
+}
+
+
+TEST(TripleBufferReusesSlots) {
+	TripleBuffer<Payload> buffer;
+
+	// The slots are cycled, so each write slot keeps the capacity of an earlier write
+	for (u32 i = 0; i < 3; ++i) {
+		buffer.getWriteSlot().values.assign(100, i);
+		buffer.publish();
+		[[maybe_unused]] const auto& payload = buffer.acquire();
+	}
+
+	CHECK(buffer.getWriteSlot().values.capacity() >= 100);
+}
+
+
+TEST(TripleBufferIsConsistentAcrossThreads) {
+	TripleBuffer<Payload> buffer;
+
+	constexpr u32 publish_count = 20000;
+	std::atomic<bool> done = false;
+
+	std::thread producer([&] {
+		for (u32 i = 1; i <= publish_count; ++i) {
+			auto& slot = buffer.getWriteSlot();
+			slot.sequence = i;
+			slot.values.assign(64, i);
+			buffer.publish();
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	// Each acquired slot is complete, and the sequence never goes backwards
+	u32  last_sequence = 0;
+	bool consistent    = true;
+
+	const auto consume = [&] {
+		const auto& payload = buffer.acquire();
+		if (payload.sequence < last_sequence)
+			consistent = false;
+
+		for (const u32 value : payload.values) {
+			if (value != payload.sequence)
+				consistent = false;
+		}
+
+		last_sequence = payload.sequence;
+	};
+
+	while (not done.load(std::memory_order_acquire)) {
+		consume();
+	}
+
+	producer.join();
+	consume();
+
+	CHECK(consistent);
+	CHECK(last_sequence == publish_count);
+}
\ No newline at end of file
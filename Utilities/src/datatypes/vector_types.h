@@ -197,6 +197,50 @@ constexpr auto operator/(const Vector<T, N>& lhs, U rhs) noexcept -> Vector<decl
 
 
 
+//----------------------------------------------------------------------------------
+// i16 Vectors
+//----------------------------------------------------------------------------------
+
+using i16_2 = Vector<int16_t, 2>;
+using i16_3 = Vector<int16_t, 3>;
+using i16_4 = Vector<int16_t, 4>;
+
+static_assert(sizeof(i16_2) == 4);
+static_assert(sizeof(i16_3) == 6);
+static_assert(sizeof(i16_4) == 8);
+
+static_assert(std::is_standard_layout_v<i16_2>);
+static_assert(std::is_standard_layout_v<i16_3>);
+static_assert(std::is_standard_layout_v<i16_4>);
+
+static_assert(std::is_trivially_copyable_v<i16_2>);
+static_assert(std::is_trivially_copyable_v<i16_3>);
+static_assert(std::is_trivially_copyable_v<i16_4>);
+
+
+
+//----------------------------------------------------------------------------------
+// u16 Vectors
+//----------------------------------------------------------------------------------
+
+using u16_2 = Vector<uint16_t, 2>;
+using u16_3 = Vector<uint16_t, 3>;
+using u16_4 = Vector<uint16_t, 4>;
+
+static_assert(sizeof(u16_2) == 4);
+static_assert(sizeof(u16_3) == 6);
+static_assert(sizeof(u16_4) == 8);
+
+static_assert(std::is_standard_layout_v<u16_2>);
+static_assert(std::is_standard_layout_v<u16_3>);
+static_assert(std::is_standard_layout_v<u16_4>);
+
+static_assert(std::is_trivially_copyable_v<u16_2>);
+static_assert(std::is_trivially_copyable_v<u16_3>);
+static_assert(std::is_trivially_copyable_v<u16_4>);
+
+
+
 //----------------------------------------------------------------------------------
 // i32 Vectors
 //----------------------------------------------------------------------------------
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cwctype>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "os/windows/windows.h"
+
+
+//----------------------------------------------------------------------------------
+// FileWatcher
+//----------------------------------------------------------------------------------
+//
+// Watches a set of files for changes. The directories that contain the files are
+// monitored by a background thread with ReadDirectoryChangesW, so unchanged files
+// cost nothing.
+//
+// Editors often save a file with several writes, or by writing a temporary file and
+// renaming it over the original. A file is only reported as changed once it hasn't
+// changed for the settle time, so each save is reported once, after it's complete.
+//
+//----------------------------------------------------------------------------------
+class FileWatcher final {
+	using clock = std::chrono::steady_clock;
+
+	// A directory being watched. Owned by the watcher thread.
+	struct Directory {
+		HANDLE     handle     = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped = {};
+		std::wstring path;
+
+		// Change notifications are written here. Must be DWORD aligned.
+		alignas(DWORD) std::byte buffer[16 * 1024];
+	};
+
+	// Completion keys of the packets that aren't directory notifications
+	static constexpr ULONG_PTR stop_key = 0;
+	static constexpr ULONG_PTR wake_key = 1;
+
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	explicit FileWatcher(std::chrono::milliseconds settle_time = std::chrono::milliseconds{250})
+		: settle_time(settle_time) {
+
+		port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		if (port)
+			thread = std::thread{[this] { watcherMain(); }};
+	}
+
+	// The watcher thread references the watcher, so it can't be moved
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher(FileWatcher&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~FileWatcher() {
+		if (not port)
+			return;
+
+		PostQueuedCompletionStatus(port, 0, stop_key, nullptr);
+		thread.join();
+		CloseHandle(port);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	FileWatcher& operator=(const FileWatcher&) = delete;
+	FileWatcher& operator=(FileWatcher&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Get the key a file is identified by. Different paths to the same file give the same key.
+	[[nodiscard]]
+	static std::wstring GetFileKey(const fs::path& file) {
+		std::error_code error;
+		auto path = fs::weakly_canonical(file, error);
+		if (error)
+			path = fs::absolute(file, error).lexically_normal();
+
+		auto key = path.make_preferred().wstring();
+		std::ranges::transform(key, key.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+		return key;
+	}
+
+	// Start watching a file. Does nothing if the file is already watched. Can be called from
+	// any thread.
+	void watch(const fs::path& file) {
+		auto key = GetFileKey(file);
+		auto directory = fs::path{key}.parent_path().wstring();
+
+		std::scoped_lock lock{mutex};
+
+		if (not files.try_emplace(std::move(key), file).second)
+			return;
+
+		if (port and requested_directories.insert(directory).second) {
+			pending_directories.push_back(std::move(directory));
+			PostQueuedCompletionStatus(port, 0, wake_key, nullptr);
+		}
+	}
+
+	// Stop watching a file. The file's directory stays watched.
+	void unwatch(const fs::path& file) {
+		const auto key = GetFileKey(file);
+
+		std::scoped_lock lock{mutex};
+		files.erase(key);
+		changes.erase(key);
+	}
+
+	// Get the files that changed and have since settled. Each change is only returned once.
+	// The paths are the ones the files were first watched with.
+	[[nodiscard]]
+	std::vector<fs::path> takeChanges() {
+		std::vector<fs::path> out;
+		const auto now = clock::now();
+
+		std::scoped_lock lock{mutex};
+
+		for (auto it = changes.begin(); it != changes.end();) {
+			if ((now - it->second) < settle_time) {
+				++it;
+				continue;
+			}
+
+			if (const auto file = files.find(it->first); file != files.end())
+				out.push_back(file->second);
+
+			it = changes.erase(it);
+		}
+
+		return out;
+	}
+
+private:
+
+	void watcherMain() {
+		while (true) {
+			DWORD       bytes      = 0;
+			ULONG_PTR   key        = 0;
+			OVERLAPPED* overlapped = nullptr;
+
+			const BOOL result = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+
+			if (key == stop_key)
+				break;
+
+			if (key == wake_key) {
+				openPendingDirectories();
+				continue;
+			}
+
+			auto* directory = reinterpret_cast<Directory*>(key);
+
+			// A successful read with no data means the buffer overflowed, and the changes
+			// were lost. Treat every file in the directory as changed.
+			if (result and (bytes != 0))
+				processNotifications(*directory);
+			else if (result)
+				markDirectoryChanged(*directory);
+
+			// Stop watching directories that can no longer be read (e.g. they were deleted)
+			if (not result or not BeginRead(*directory))
+				closeDirectory(directory);
+		}
+
+		// Cancel the outstanding reads, and wait for them to finish before releasing their buffers
+		for (auto& directory : directories) {
+			CancelIoEx(directory->handle, &directory->overlapped);
+
+			DWORD bytes = 0;
+			GetOverlappedResult(directory->handle, &directory->overlapped, &bytes, TRUE);
+			CloseHandle(directory->handle);
+		}
+		directories.clear();
+	}
+
+	void openPendingDirectories() {
+		std::vector<std::wstring> paths;
+		{
+			std::scoped_lock lock{mutex};
+			paths.swap(pending_directories);
+		}
+
+		for (auto& path : paths) {
+			auto directory = std::make_unique<Directory>();
+			directory->path = std::move(path);
+
+			directory->handle = CreateFileW(directory->path.c_str(),
+			                                FILE_LIST_DIRECTORY,
+			                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			                                nullptr,
+			                                OPEN_EXISTING,
+			                                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			                                nullptr);
+
+			if (directory->handle == INVALID_HANDLE_VALUE) {
+				forgetDirectory(directory->path);
+				continue;
+			}
+
+			const auto completion_key = reinterpret_cast<ULONG_PTR>(directory.get());
+			if (not CreateIoCompletionPort(directory->handle, port, completion_key, 0) or not BeginRead(*directory)) {
+				CloseHandle(directory->handle);
+				forgetDirectory(directory->path);
+				continue;
+			}
+
+			directories.push_back(std::move(directory));
+		}
+	}
+
+	void closeDirectory(Directory* directory) {
+		CloseHandle(directory->handle);
+		forgetDirectory(directory->path);
+
+		std::erase_if(directories, [directory](const auto& ptr) { return ptr.get() == directory; });
+	}
+
+	// Allow a directory to be watched again by a later call to watch()
+	void forgetDirectory(const std::wstring& path) {
+		std::scoped_lock lock{mutex};
+		requested_directories.erase(path);
+	}
+
+	void processNotifications(const Directory& directory) {
+		const auto now = clock::now();
+
+		std::scoped_lock lock{mutex};
+
+		const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(directory.buffer);
+		while (true) {
+			if ((info->Action == FILE_ACTION_ADDED)
+			    or (info->Action == FILE_ACTION_MODIFIED)
+			    or (info->Action == FILE_ACTION_RENAMED_NEW_NAME)) {
+
+				const std::wstring_view name{info->FileName, info->FileNameLength / sizeof(WCHAR)};
+
+				auto key = directory.path;
+				key += fs::path::preferred_separator;
+				std::ranges::transform(name, std::back_inserter(key), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+
+				if (files.contains(key))
+					changes[std::move(key)] = now;
+			}
+
+			if (info->NextEntryOffset == 0)
+				break;
+
+			info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const std::byte*>(info) + info->NextEntryOffset);
+		}
+	}
+
+	void markDirectoryChanged(const Directory& directory) {
+		const auto now = clock::now();
+
+		std::scoped_lock lock{mutex};
+
+		for (const auto& [key, file] : files) {
+			if (fs::path{key}.parent_path().native() == directory.path)
+				changes[key] = now;
+		}
+	}
+
+	[[nodiscard]]
+	static bool BeginRead(Directory& directory) {
+		directory.overlapped = {};
+
+		return ReadDirectoryChangesW(directory.handle,
+		                             directory.buffer,
+		                             static_cast<DWORD>(sizeof(directory.buffer)),
+		                             FALSE,
+		                             FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+		                             nullptr,
+		                             &directory.overlapped,
+		                             nullptr);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	std::chrono::milliseconds settle_time;
+
+	// Guards everything below except the directories, which only the watcher thread uses
+	std::mutex mutex;
+
+	// The watched files, keyed by GetFileKey(), and the time each changed file last changed
+	std::unordered_map<std::wstring, fs::path> files;
+	std::unordered_map<std::wstring, clock::time_point> changes;
+
+	// Directories that were requested, and the ones the watcher thread hasn't opened yet
+	std::unordered_set<std::wstring> requested_directories;
+	std::vector<std::wstring> pending_directories;
+
+	std::vector<std::unique_ptr<Directory>> directories;
+
+	HANDLE port = nullptr;
+	std::thread thread;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+#include "os/windows/windows.h"
+
+
+//----------------------------------------------------------------------------------
+// MappedFile
+//----------------------------------------------------------------------------------
+//
+// A read-only view of a file that is mapped into memory. Pages are loaded by the OS
+// as they're accessed, so nothing is read until the data is used.
+//
+//----------------------------------------------------------------------------------
+class MappedFile final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	MappedFile() noexcept = default;
+
+	explicit MappedFile(const fs::path& file) {
+		open(file);
+	}
+
+	MappedFile(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept {
+		swap(other);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~MappedFile() {
+		close();
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		MappedFile temp{std::move(other)};
+		swap(temp);
+		return *this;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Map a file into memory. Returns false if the file couldn't be mapped or is empty.
+	bool open(const fs::path& file) {
+		close();
+
+		// Deletion is shared so the file can be replaced (e.g. by a rewritten cache) while mapped
+		file_handle = CreateFileW(file.c_str(),
+		                          GENERIC_READ,
+		                          FILE_SHARE_READ | FILE_SHARE_DELETE,
+		                          nullptr,
+		                          OPEN_EXISTING,
+		                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		                          nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE) {
+			close();
+			return false;
+		}
+
+		LARGE_INTEGER file_size = {};
+		if (not GetFileSizeEx(file_handle, &file_size) or (file_size.QuadPart == 0)) {
+			close();
+			return false;
+		}
+
+		mapping = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (not mapping) {
+			close();
+			return false;
+		}
+
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (not view) {
+			close();
+			return false;
+		}
+
+		size = static_cast<size_t>(file_size.QuadPart);
+		return true;
+	}
+
+	// Unmap the file
+	void close() noexcept {
+		if (view)
+			UnmapViewOfFile(view);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file_handle != INVALID_HANDLE_VALUE)
+			CloseHandle(file_handle);
+
+		file_handle = INVALID_HANDLE_VALUE;
+		mapping     = nullptr;
+		view        = nullptr;
+		size        = 0;
+	}
+
+	[[nodiscard]]
+	bool isOpen() const noexcept {
+		return view != nullptr;
+	}
+
+	[[nodiscard]]
+	std::span<const std::byte> getData() const noexcept {
+		return {static_cast<const std::byte*>(view), size};
+	}
+
+	[[nodiscard]]
+	size_t getSize() const noexcept {
+		return size;
+	}
+
+private:
+
+	void swap(MappedFile& other) noexcept {
+		std::swap(file_handle, other.file_handle);
+		std::swap(mapping, other.mapping);
+		std::swap(view, other.view);
+		std::swap(size, other.size);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	HANDLE file_handle = INVALID_HANDLE_VALUE;
+	HANDLE mapping     = nullptr;
+	void*  view        = nullptr;
+	size_t size        = 0;
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "datatypes/vector_types.h"
+
+
+//----------------------------------------------------------------------------------
+// AtlasAllocator
+//----------------------------------------------------------------------------------
+//
+// Allocates square, power-of-two sized tiles from a square 2D atlas. The atlas is
+// managed as a quadtree: a free node is split into four children until a node of the
+// requested size is available, and four free siblings are merged back into their
+// parent when a tile is freed.
+//
+//----------------------------------------------------------------------------------
+class AtlasAllocator final {
+public:
+	struct Tile {
+		[[nodiscard]]
+		bool operator==(const Tile& other) const noexcept = default;
+
+		// The top left texel of the tile
+		u32_2 position = {};
+
+		// The width and height of the tile
+		u32 size = 0;
+	};
+
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	AtlasAllocator() = default;
+
+	// The atlas size and minimum tile size are rounded down to a power of two
+	AtlasAllocator(u32 atlas_size, u32 min_tile_size) {
+		reset(atlas_size, min_tile_size);
+	}
+
+	AtlasAllocator(const AtlasAllocator&) = default;
+	AtlasAllocator(AtlasAllocator&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~AtlasAllocator() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	AtlasAllocator& operator=(const AtlasAllocator&) = default;
+	AtlasAllocator& operator=(AtlasAllocator&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Allocation
+	//----------------------------------------------------------------------------------
+
+	// Free all tiles and resize the atlas
+	void reset(u32 new_atlas_size, u32 new_min_tile_size) {
+		atlas_size    = new_atlas_size ? std::bit_floor(new_atlas_size) : 0;
+		min_tile_size = std::clamp(new_min_tile_size ? std::bit_floor(new_min_tile_size) : 1u, 1u, std::max(atlas_size, 1u));
+		used_area     = 0;
+
+		free_nodes.clear();
+		if (atlas_size == 0)
+			return;
+
+		free_nodes.resize(getLevel(min_tile_size) + 1);
+		free_nodes[0].push_back(u32_2{0u, 0u});
+	}
+
+	// Free all tiles
+	void clear() {
+		reset(atlas_size, min_tile_size);
+	}
+
+	// Round a size up to the nearest valid tile size
+	[[nodiscard]]
+	u32 getTileSize(u32 size) const noexcept {
+		return std::clamp(std::bit_ceil(std::max(size, 1u)), min_tile_size, atlas_size);
+	}
+
+	// Allocate a tile of at least the requested size. Returns nullopt if there is no space.
+	[[nodiscard]]
+	std::optional<Tile> allocate(u32 size) {
+		if (atlas_size == 0 or size > atlas_size)
+			return std::nullopt;
+
+		const u32 tile_size = getTileSize(size);
+		const u32 level     = getLevel(tile_size);
+
+		// Find the smallest free node that can hold the tile
+		u32 source = level;
+		while (free_nodes[source].empty()) {
+			if (source == 0)
+				return std::nullopt;
+			--source;
+		}
+
+		// Split the node until a node of the requested level exists
+		for (; source < level; ++source) {
+			const u32_2 node = free_nodes[source].back();
+			free_nodes[source].pop_back();
+
+			const u32 child_size = atlas_size >> (source + 1);
+			auto& children = free_nodes[source + 1];
+			children.push_back(u32_2{node[0] + child_size, node[1] + child_size});
+			children.push_back(u32_2{node[0],              node[1] + child_size});
+			children.push_back(u32_2{node[0] + child_size, node[1]});
+			children.push_back(node);
+		}
+
+		const u32_2 position = free_nodes[level].back();
+		free_nodes[level].pop_back();
+
+		used_area += u64{tile_size} * tile_size;
+		return Tile{position, tile_size};
+	}
+
+	// Return a tile to the atlas. The tile must have been allocated by this allocator.
+	void free(const Tile& tile) {
+		if (tile.size == 0)
+			return;
+
+		used_area -= u64{tile.size} * tile.size;
+
+		u32_2 node  = tile.position;
+		u32   level = getLevel(tile.size);
+
+		// Merge the node with its siblings for as long as all of them are free
+		while (level > 0) {
+			const u32   parent_size = atlas_size >> (level - 1);
+			const u32   child_size  = parent_size >> 1;
+			const u32_2 parent      = {node[0] - (node[0] % parent_size), node[1] - (node[1] % parent_size)};
+
+			const u32_2 siblings[4] = {
+				parent,
+				u32_2{parent[0] + child_size, parent[1]},
+				u32_2{parent[0],              parent[1] + child_size},
+				u32_2{parent[0] + child_size, parent[1] + child_size}
+			};
+
+			auto& nodes = free_nodes[level];
+			const auto is_free = [&](const u32_2& sibling) {
+				return sibling == node or std::ranges::find(nodes, sibling) != nodes.end();
+			};
+			if (not std::ranges::all_of(siblings, is_free))
+				break;
+
+			std::erase_if(nodes, [&](const u32_2& n) {
+				return std::ranges::find(siblings, n) != std::end(siblings);
+			});
+
+			node = parent;
+			--level;
+		}
+
+		free_nodes[level].push_back(node);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Getters
+	//----------------------------------------------------------------------------------
+
+	[[nodiscard]]
+	u32 getAtlasSize() const noexcept {
+		return atlas_size;
+	}
+
+	[[nodiscard]]
+	u32 getMinTileSize() const noexcept {
+		return min_tile_size;
+	}
+
+	// The number of texels currently allocated
+	[[nodiscard]]
+	u64 getUsedArea() const noexcept {
+		return used_area;
+	}
+
+	// The number of texels not currently allocated
+	[[nodiscard]]
+	u64 getFreeArea() const noexcept {
+		return (u64{atlas_size} * atlas_size) - used_area;
+	}
+
+private:
+
+	// Get the quadtree level of a power-of-two tile size (level 0 is the whole atlas)
+	[[nodiscard]]
+	u32 getLevel(u32 tile_size) const noexcept {
+		return static_cast<u32>(std::countr_zero(atlas_size) - std::countr_zero(tile_size));
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+
+	u32 atlas_size    = 0;
+	u32 min_tile_size = 1;
+	u64 used_area     = 0;
+
+	// The free nodes at each level of the quadtree
+	std::vector<std::vector<u32_2>> free_nodes;
+};
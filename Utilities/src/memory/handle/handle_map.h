@@ -3,6 +3,7 @@
 #include "memory/handle/handle.h"
 #include "memory/handle/handle_table.h"
 #include "memory/resource_pool.h"
+#include <memory>
 
 
 //----------------------------------------------------------------------------------
@@ -12,12 +13,14 @@
 // The HandleMap stores resources in a ResourcePool and creates a handle which they
 // will be associated with. Handles are never invalidated for the lifetime of the
 // resource. Rules for iterator and reference invalidation follow those of the ResourcePool.
+// The handle table and the resource pool are allocated with AllocatorT.
 //
 //----------------------------------------------------------------------------------
 
-template<typename HandleT, typename ResourceT>
+template<typename HandleT, typename ResourceT, typename AllocatorT = std::allocator<ResourceT>>
 class HandleMap final {
-	using resource_pool_type     = ResourcePool<typename HandleT::value_type, ResourceT>;
+	using resource_pool_type     = ResourcePool<typename HandleT::value_type, ResourceT, AllocatorT>;
+	using handle_table_type      = HandleTable<HandleT, typename std::allocator_traits<AllocatorT>::template rebind_alloc<HandleT>>;
 
 public:
 
@@ -147,6 +150,6 @@ private:
 	//----------------------------------------------------------------------------------
 	// Member Variables
 	//----------------------------------------------------------------------------------
-	HandleTable<HandleT> handle_table;
-	resource_pool_type   resource_pool;
+	handle_table_type  handle_table;
+	resource_pool_type resource_pool;
 };
\ No newline at end of file
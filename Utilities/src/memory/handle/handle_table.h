@@ -3,6 +3,7 @@
 #include "handle.h"
 #include "datatypes/container_types.h"
 #include <assert.h>
+#include <memory>
 
 
 //----------------------------------------------------------------------------------
@@ -14,9 +15,9 @@
 //
 //----------------------------------------------------------------------------------
 
-template<typename HandleT>
+template<typename HandleT, typename AllocatorT = std::allocator<HandleT>>
 class HandleTable {
-	using container_type = std::vector<HandleT>;
+	using container_type = std::vector<HandleT, AllocatorT>;
 
 public:
 
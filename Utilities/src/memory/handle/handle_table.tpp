@@ -1,5 +1,5 @@
-template<typename HandleT>
-HandleT HandleTable<HandleT>::createHandle() {
+template<typename HandleT, typename AllocatorT>
+HandleT HandleTable<HandleT, AllocatorT>::createHandle() {
 	if (available > 0) {
 		// Remove the first free handle from the list
 		handle_type out{next, table[next].counter};
@@ -21,8 +21,8 @@ HandleT HandleTable<HandleT>::createHandle() {
 }
 
 
-template<typename HandleT>
-void HandleTable<HandleT>::releaseHandle(handle_type handle) {
+template<typename HandleT, typename AllocatorT>
+void HandleTable<HandleT, AllocatorT>::releaseHandle(handle_type handle) {
 	if (not valid(handle)) {
 		assert(false && "Invalid handle specified for release");
 		return;
@@ -39,8 +39,8 @@ void HandleTable<HandleT>::releaseHandle(handle_type handle) {
 }
 
 
-template<typename HandleT>
-bool HandleTable<HandleT>::valid(handle_type handle) const noexcept {
+template<typename HandleT, typename AllocatorT>
+bool HandleTable<HandleT, AllocatorT>::valid(handle_type handle) const noexcept {
 	if (handle != handle_type::invalid_handle() && handle.index < table.size()) {
 		return table[handle.index].counter == handle.counter;
 	}
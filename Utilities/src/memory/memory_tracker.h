@@ -0,0 +1,327 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "datatypes/scalar_types.h"
+
+
+//----------------------------------------------------------------------------------
+// Memory Tracker
+//----------------------------------------------------------------------------------
+//
+// Counts the memory held by each subsystem. Memory is attributed to a subsystem by
+// a tag, and each tag has a count of the bytes and allocations it currently holds,
+// a high-water mark, and a running total of its allocations.
+//
+// There are three ways of recording memory:
+//   - TrackedAllocator: a standard allocator for containers, e.g. ECS component pools
+//   - MemoryTracker::allocate/deallocate: a malloc-like pair, for C style hooks (ImGui)
+//   - TrackedMemory: a handle for memory that isn't allocated on the heap, such as
+//     the video memory used by a buffer or texture
+//
+// The counters are lock-free, and this code only depends on the standard library.
+//
+//----------------------------------------------------------------------------------
+
+enum class MemoryTag : u8 {
+	Untagged,
+	Components, //ECS component pools
+	Entities,   //ECS entity handles
+	Events,     //ECS event queues
+	Meshes,     //Vertex and index buffers (video memory)
+	Textures,   //Textures (video memory)
+	UI,         //ImGui
+	Count
+};
+
+
+// The memory held by a tag
+struct MemoryTagStats {
+	MemoryTag   tag               = MemoryTag::Untagged;
+	const char* name              = "";
+	u64         bytes             = 0;
+	u64         peak_bytes        = 0;
+	u64         allocations       = 0; //live allocations
+	u64         total_allocations = 0; //allocations since startup
+};
+
+
+class MemoryTracker final {
+
+	struct Counters {
+		std::atomic<u64> bytes             = 0;
+		std::atomic<u64> peak_bytes        = 0;
+		std::atomic<u64> allocations       = 0;
+		std::atomic<u64> total_allocations = 0;
+	};
+
+	static constexpr size_t tag_count = static_cast<size_t>(MemoryTag::Count);
+
+	// Size of the header that allocate() stores the size of an allocation in. Keeps the
+	// returned memory aligned for any fundamental type.
+	static constexpr size_t header_size = alignof(std::max_align_t);
+
+	constexpr MemoryTracker() noexcept = default;
+
+public:
+	MemoryTracker(const MemoryTracker&) = delete;
+	MemoryTracker(MemoryTracker&&) = delete;
+
+	~MemoryTracker() = default;
+
+	MemoryTracker& operator=(const MemoryTracker&) = delete;
+	MemoryTracker& operator=(MemoryTracker&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Recording
+	//----------------------------------------------------------------------------------
+
+	// Record memory that was acquired by a tag
+	static void recordAllocation(MemoryTag tag, size_t bytes) noexcept {
+		auto& counters = get().counters[static_cast<size_t>(tag)];
+
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+		counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+
+		const u64 current = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		u64 peak = counters.peak_bytes.load(std::memory_order_relaxed);
+		while ((current > peak) and not counters.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+		}
+	}
+
+	// Record memory that was released by a tag
+	static void recordDeallocation(MemoryTag tag, size_t bytes) noexcept {
+		auto& counters = get().counters[static_cast<size_t>(tag)];
+
+		counters.allocations.fetch_sub(1, std::memory_order_relaxed);
+		counters.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	// Allocate heap memory for a tag. The memory must be released with deallocate().
+	[[nodiscard]]
+	static void* allocate(MemoryTag tag, size_t bytes) noexcept {
+		auto* block = static_cast<std::byte*>(std::malloc(header_size + bytes));
+		if (not block)
+			return nullptr;
+
+		*reinterpret_cast<size_t*>(block) = bytes;
+		recordAllocation(tag, bytes);
+		return block + header_size;
+	}
+
+	// Release memory from allocate()
+	static void deallocate(MemoryTag tag, void* ptr) noexcept {
+		if (not ptr)
+			return;
+
+		auto* block = static_cast<std::byte*>(ptr) - header_size;
+		recordDeallocation(tag, *reinterpret_cast<const size_t*>(block));
+		std::free(block);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Stats
+	//----------------------------------------------------------------------------------
+
+	[[nodiscard]]
+	static MemoryTagStats getStats(MemoryTag tag) noexcept {
+		const auto& counters = get().counters[static_cast<size_t>(tag)];
+
+		MemoryTagStats stats;
+		stats.tag               = tag;
+		stats.name              = GetTagName(tag);
+		stats.bytes             = counters.bytes.load(std::memory_order_relaxed);
+		stats.peak_bytes        = counters.peak_bytes.load(std::memory_order_relaxed);
+		stats.allocations       = counters.allocations.load(std::memory_order_relaxed);
+		stats.total_allocations = counters.total_allocations.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	// Get the stats of every tag, in the order they're declared
+	[[nodiscard]]
+	static std::array<MemoryTagStats, tag_count> getBreakdown() noexcept {
+		std::array<MemoryTagStats, tag_count> out;
+		for (size_t i = 0; i < tag_count; ++i) {
+			out[i] = getStats(static_cast<MemoryTag>(i));
+		}
+		return out;
+	}
+
+	// Reset the high-water mark of each tag to its current size
+	static void resetPeaks() noexcept {
+		for (auto& counters : get().counters) {
+			counters.peak_bytes.store(counters.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+	}
+
+	[[nodiscard]]
+	static constexpr const char* GetTagName(MemoryTag tag) noexcept {
+		switch (tag) {
+			case MemoryTag::Untagged:   return "Untagged";
+			case MemoryTag::Components: return "Components";
+			case MemoryTag::Entities:   return "Entities";
+			case MemoryTag::Events:     return "Events";
+			case MemoryTag::Meshes:     return "Meshes";
+			case MemoryTag::Textures:   return "Textures";
+			case MemoryTag::UI:         return "UI";
+			default:                    return "Unknown";
+		}
+	}
+
+private:
+
+	// The tracker is constant initialized, so it can be used during static initialization
+	// and destruction.
+	[[nodiscard]]
+	static MemoryTracker& get() noexcept {
+		static constinit MemoryTracker instance;
+		return instance;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	std::array<Counters, tag_count> counters;
+};
+
+
+
+//----------------------------------------------------------------------------------
+// TrackedAllocator
+//----------------------------------------------------------------------------------
+//
+// A standard allocator that records its allocations under a tag
+//
+//----------------------------------------------------------------------------------
+template<typename T, MemoryTag Tag>
+class TrackedAllocator {
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind {
+		using other = TrackedAllocator<U, Tag>;
+	};
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	constexpr TrackedAllocator() noexcept = default;
+
+	template<typename U>
+	constexpr TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	[[nodiscard]]
+	T* allocate(size_t count) {
+		T* ptr = std::allocator<T>{}.allocate(count);
+		MemoryTracker::recordAllocation(Tag, count * sizeof(T));
+		return ptr;
+	}
+
+	void deallocate(T* ptr, size_t count) noexcept {
+		MemoryTracker::recordDeallocation(Tag, count * sizeof(T));
+		std::allocator<T>{}.deallocate(ptr, count);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	template<typename U>
+	[[nodiscard]]
+	constexpr bool operator==(const TrackedAllocator<U, Tag>&) const noexcept {
+		return true;
+	}
+};
+
+
+
+//----------------------------------------------------------------------------------
+// TrackedMemory
+//----------------------------------------------------------------------------------
+//
+// Records an amount of memory under a tag for as long as it exists. Used for memory
+// the tracker can't see being allocated, such as the video memory of a resource.
+//
+//----------------------------------------------------------------------------------
+class TrackedMemory final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	TrackedMemory() noexcept = default;
+
+	TrackedMemory(MemoryTag tag, size_t bytes) noexcept
+		: tag(tag)
+		, bytes(bytes) {
+		if (bytes != 0)
+			MemoryTracker::recordAllocation(tag, bytes);
+	}
+
+	TrackedMemory(const TrackedMemory&) = delete;
+
+	TrackedMemory(TrackedMemory&& other) noexcept
+		: tag(other.tag)
+		, bytes(std::exchange(other.bytes, 0)) {
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~TrackedMemory() {
+		reset();
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	TrackedMemory& operator=(const TrackedMemory&) = delete;
+
+	TrackedMemory& operator=(TrackedMemory&& other) noexcept {
+		if (this != &other) {
+			reset();
+			tag   = other.tag;
+			bytes = std::exchange(other.bytes, 0);
+		}
+		return *this;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+	void reset() noexcept {
+		if (bytes != 0)
+			MemoryTracker::recordDeallocation(tag, bytes);
+		bytes = 0;
+	}
+
+	[[nodiscard]]
+	size_t size() const noexcept {
+		return bytes;
+	}
+
+private:
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	MemoryTag tag   = MemoryTag::Untagged;
+	size_t    bytes = 0;
+};
@@ -2,6 +2,8 @@
 
 #include "memory/sparse_set.h"
 #include <concepts>
+#include <memory>
+#include <vector>
 
 //----------------------------------------------------------------------------------
 // ResourcePool
@@ -12,6 +14,9 @@
 // The current resource, and only the current, can be safely deleted while iterating. 
 // Pointers and references are invalidated upon modifying the container.
 //
+// The resources and the sparse set are allocated with AllocatorT (rebound for the
+// sparse set), so a pool's memory can be attributed with a TrackedAllocator.
+//
 //----------------------------------------------------------------------------------
 
 template<std::unsigned_integral HandleT>
@@ -42,10 +47,10 @@ public:
 };
 
 
-template<std::unsigned_integral HandleT, typename ResourceT>
+template<std::unsigned_integral HandleT, typename ResourceT, typename AllocatorT = std::allocator<ResourceT>>
 class ResourcePool final: public IResourcePool<HandleT> {
-	using sparse_set_type        = SparseSet<HandleT>;
-	using container_type         = std::vector<ResourceT>;
+	using sparse_set_type        = SparseSet<HandleT, typename std::allocator_traits<AllocatorT>::template rebind_alloc<HandleT>>;
+	using container_type         = std::vector<ResourceT, AllocatorT>;
 
 public:
 
@@ -64,12 +69,12 @@ public:
 	//----------------------------------------------------------------------------------
 	template<bool ConstIter>
 	class iterator_t {
-		friend class ResourcePool<HandleT, ResourceT>;
+		friend class ResourcePool<HandleT, ResourceT, AllocatorT>;
 
 		using container_type = std::conditional_t<
 			ConstIter,
-			const typename ResourcePool<HandleT, ResourceT>::container_type,
-			typename ResourcePool<HandleT, ResourceT>::container_type
+			const typename ResourcePool<HandleT, ResourceT, AllocatorT>::container_type,
+			typename ResourcePool<HandleT, ResourceT, AllocatorT>::container_type
 		>;
 
 		//----------------------------------------------------------------------------------
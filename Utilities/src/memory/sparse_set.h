@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <type_traits>
 #include <assert.h>
@@ -25,11 +26,13 @@
 // operation, as is deleting the current element during iteration. However, pointers
 // and references are invalidated upon adding elements or resizing the container.
 //
+// Both arrays are allocated with AllocatorT.
+//
 //----------------------------------------------------------------------------------
 
-template<std::unsigned_integral T>
+template<std::unsigned_integral T, typename AllocatorT = std::allocator<T>>
 class SparseSet final {
-	using container_type         = std::vector<T>;
+	using container_type         = std::vector<T, AllocatorT>;
 
 public:
 
@@ -47,8 +50,8 @@ public:
 	// can be deleted while iterating and no other elements will be skipped.
 	// However, elements added while iterating will not be covered.
 	class const_iterator {
-		friend class SparseSet<T>;
-		using container_type = SparseSet<T>::container_type;
+		friend class SparseSet<T, AllocatorT>;
+		using container_type = SparseSet<T, AllocatorT>::container_type;
 
 		//----------------------------------------------------------------------------------
 		// Constructors
@@ -62,10 +65,10 @@ public:
 
 		using difference_type   = ptrdiff_t;
 		using size_type         = size_t;
-		using value_type        = SparseSet<T>::value_type;
-		using const_pointer     = SparseSet<T>::const_pointer;
-		using reference         = SparseSet<T>::reference;
-		using const_reference   = SparseSet<T>::const_reference;
+		using value_type        = SparseSet<T, AllocatorT>::value_type;
+		using const_pointer     = SparseSet<T, AllocatorT>::const_pointer;
+		using reference         = SparseSet<T, AllocatorT>::reference;
+		using const_reference   = SparseSet<T, AllocatorT>::const_reference;
 		using iterator_category = std::random_access_iterator_tag;
 
 		//----------------------------------------------------------------------------------
@@ -0,0 +1,528 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "io/io.h"
+
+
+//----------------------------------------------------------------------------------
+// Profiler
+//----------------------------------------------------------------------------------
+//
+// A low overhead, scoped zone profiler. Zones are declared with the PROFILE_ZONE
+// macro, which creates a static ProfileZone for the string literal. The zone's
+// address is its ID, so recording a zone never hashes or copies its name.
+//
+// Each thread writes its completed zones into its own lock-free ring buffer. The
+// buffers are drained once per frame by Profiler::endFrame(), which builds the zone
+// tree of the thread that calls it, and appends every event to the capture if one is
+// in progress. GPU zones are submitted by the GPU profiler once their timestamps are
+// read back, and are placed on their own track.
+//
+// Captures are exported in the Chrome trace event format, which can be opened in
+// chrome://tracing or Perfetto. This code only depends on the standard library, so
+// it works the same way in headless builds on any platform.
+//
+//----------------------------------------------------------------------------------
+
+// A profiled region of code
+struct ProfileZone {
+	const char* name = "";
+	const char* file = "";
+	u32         line = 0;
+};
+
+// A completed zone. Times are in nanoseconds since the profiler was created.
+struct ProfileEvent {
+	const ProfileZone* zone  = nullptr;
+	u64                begin = 0;
+	u64                end   = 0;
+	u32                depth = 0;
+};
+
+// The time spent in a zone during the last frame. Zones that were entered more than
+// once with the same parent are merged.
+struct ProfileZoneStats {
+	const ProfileZone* zone  = nullptr;
+	u32                depth = 0;
+	u32                count = 0;
+	f64                time  = 0.0; //milliseconds
+};
+
+
+class Profiler final {
+	// The number of events each thread can record between calls to endFrame(). Events
+	// recorded while a thread's buffer is full are dropped.
+	static constexpr u32 ring_capacity = 8192;
+
+	// The maximum number of events a capture holds
+	static constexpr size_t max_capture_events = size_t{1} << 22;
+
+	// Single producer, single consumer ring buffer of completed zones
+	struct ThreadState {
+		u32         id = 0;
+		std::string name;
+		u32         depth = 0; //only used by the owning thread
+
+		alignas(64) std::atomic<u64> write_pos = 0;
+		alignas(64) std::atomic<u64> read_pos  = 0;
+		std::atomic<u64> dropped = 0;
+
+		std::array<ProfileEvent, ring_capacity> events;
+	};
+
+	// The events of one thread in a capture
+	struct Track {
+		u32         id = 0;
+		std::string name;
+		std::vector<ProfileEvent> events;
+	};
+
+	static constexpr u32 gpu_track_id = std::numeric_limits<u32>::max();
+
+	Profiler() : epoch(std::chrono::steady_clock::now()) {}
+
+public:
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) = delete;
+
+	~Profiler() = default;
+
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler& operator=(Profiler&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Recording
+	//----------------------------------------------------------------------------------
+
+	// Zones are recorded while the profiler is enabled (the default)
+	static void setEnabled(bool state) noexcept {
+		get().enabled.store(state, std::memory_order_relaxed);
+	}
+
+	[[nodiscard]]
+	static bool isEnabled() noexcept {
+		return get().enabled.load(std::memory_order_relaxed);
+	}
+
+	// Set the name of the calling thread's track
+	static void setThreadName(std::string name) {
+		auto& state = getThreadState();
+
+		std::scoped_lock lock{get().mutex};
+		state.name = std::move(name);
+	}
+
+	// The current time in nanoseconds since the profiler was created
+	[[nodiscard]]
+	static u64 now() noexcept {
+		const auto elapsed = std::chrono::steady_clock::now() - get().epoch;
+		return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	}
+
+	// Enter a zone on the calling thread. Returns the zone's depth.
+	[[nodiscard]]
+	static u32 enterZone() noexcept {
+		return getThreadState().depth++;
+	}
+
+	// Exit a zone on the calling thread, and record it
+	static void exitZone(const ProfileEvent& event) noexcept {
+		auto& state = getThreadState();
+		--state.depth;
+
+		const u64 head = state.write_pos.load(std::memory_order_relaxed);
+		if ((head - state.read_pos.load(std::memory_order_acquire)) >= ring_capacity) {
+			state.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		state.events[head % ring_capacity] = event;
+		state.write_pos.store(head + 1, std::memory_order_release);
+	}
+
+	// Submit zones that were measured on the GPU. Their times must already be mapped to the
+	// CPU timeline.
+	static void submitGPUZones(std::span<const ProfileEvent> events) {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+		if (profiler.capturing)
+			profiler.appendToCapture(gpu_track_id, "GPU", events);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Frames
+	//----------------------------------------------------------------------------------
+
+	// Drain every thread's events. The zones of the calling thread make up the frame stats.
+	static void endFrame() {
+		auto& profiler = get();
+		const auto& caller = getThreadState();
+
+		std::scoped_lock lock{profiler.mutex};
+
+		std::vector<ProfileEvent> frame_events;
+
+		for (auto& state : profiler.threads) {
+			const u64 tail = state->read_pos.load(std::memory_order_relaxed);
+			const u64 head = state->write_pos.load(std::memory_order_acquire);
+
+			std::vector<ProfileEvent> events;
+			events.reserve(static_cast<size_t>(head - tail));
+			for (u64 i = tail; i != head; ++i) {
+				events.push_back(state->events[i % ring_capacity]);
+			}
+			state->read_pos.store(head, std::memory_order_release);
+
+			if (profiler.capturing)
+				profiler.appendToCapture(state->id, state->name, events);
+
+			if (state.get() == &caller)
+				frame_events = std::move(events);
+		}
+
+		// Forget threads that have exited. Their buffers were just drained.
+		std::erase_if(profiler.threads, [](const auto& state) { return state.use_count() == 1; });
+
+		profiler.frame_stats = BuildStats(std::move(frame_events));
+	}
+
+	// The zone tree of the last frame, in depth first order
+	[[nodiscard]]
+	static std::vector<ProfileZoneStats> getFrameStats() {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+		return profiler.frame_stats;
+	}
+
+	// The number of events that were dropped because a thread's buffer was full
+	[[nodiscard]]
+	static u64 getDroppedCount() {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+
+		u64 count = profiler.capture_dropped;
+		for (const auto& state : profiler.threads) {
+			count += state->dropped.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Capture
+	//----------------------------------------------------------------------------------
+
+	// Start recording every event. Discards the previous capture.
+	static void beginCapture() {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+		profiler.tracks.clear();
+		profiler.capture_size    = 0;
+		profiler.capture_dropped = 0;
+		profiler.capturing       = true;
+	}
+
+	static void endCapture() {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+		profiler.capturing = false;
+	}
+
+	[[nodiscard]]
+	static bool isCapturing() {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+		return profiler.capturing;
+	}
+
+	// Write the capture in the Chrome trace event format
+	static void writeChromeTrace(std::ostream& stream) {
+		auto& profiler = get();
+
+		std::scoped_lock lock{profiler.mutex};
+
+		const auto flags     = stream.flags();
+		const auto precision = stream.precision();
+		stream << std::fixed << std::setprecision(3);
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		bool first = true;
+		const auto separator = [&] {
+			if (not first)
+				stream << ",\n";
+			first = false;
+		};
+
+		for (const auto& track : profiler.tracks) {
+			const u32 tid = (track.id == gpu_track_id) ? 0 : track.id;
+
+			separator();
+			stream << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid << R"(,"args":{"name":")";
+			WriteEscaped(stream, track.name.empty() ? ("Thread " + std::to_string(tid)) : track.name);
+			stream << "\"}}";
+
+			for (const auto& event : track.events) {
+				separator();
+				stream << "{\"name\":\"";
+				WriteEscaped(stream, event.zone->name);
+				stream << "\",\"cat\":\"" << ((track.id == gpu_track_id) ? "gpu" : "cpu") << '"'
+				       << R"(,"ph":"X","pid":1,"tid":)" << tid
+				       << ",\"ts\":" << (static_cast<f64>(event.begin) / 1000.0)
+				       << ",\"dur\":" << (static_cast<f64>(event.end - event.begin) / 1000.0)
+				       << ",\"args\":{\"file\":\"";
+				WriteEscaped(stream, event.zone->file);
+				stream << "\",\"line\":" << event.zone->line << "}}";
+			}
+		}
+
+		stream << "]}\n";
+
+		stream.flags(flags);
+		stream.precision(precision);
+	}
+
+	// Write the capture to a file in the Chrome trace event format
+	static bool writeChromeTrace(const fs::path& file) {
+		std::ofstream stream{file, std::ios::trunc};
+		if (not stream)
+			return false;
+
+		writeChromeTrace(stream);
+		return static_cast<bool>(stream);
+	}
+
+private:
+
+	[[nodiscard]]
+	static Profiler& get() {
+		static Profiler instance;
+		return instance;
+	}
+
+	// The calling thread's state. Registered on the thread's first use of the profiler.
+	[[nodiscard]]
+	static ThreadState& getThreadState() {
+		thread_local const std::shared_ptr<ThreadState> state = get().registerThread();
+		return *state;
+	}
+
+	[[nodiscard]]
+	std::shared_ptr<ThreadState> registerThread() {
+		auto state = std::make_shared<ThreadState>();
+
+		std::scoped_lock lock{mutex};
+		state->id = next_thread_id++;
+		threads.push_back(state);
+
+		return state;
+	}
+
+	void appendToCapture(u32 track_id, const std::string& name, std::span<const ProfileEvent> events) {
+		if (events.empty())
+			return;
+
+		auto it = std::ranges::find(tracks, track_id, &Track::id);
+		if (it == tracks.end())
+			it = tracks.insert(tracks.end(), Track{track_id, name, {}});
+		else
+			it->name = name;
+
+		const size_t count = std::min(events.size(), max_capture_events - capture_size);
+		it->events.insert(it->events.end(), events.begin(), events.begin() + count);
+
+		capture_size    += count;
+		capture_dropped += events.size() - count;
+	}
+
+	// Merge the events of a frame into a tree of zones
+	[[nodiscard]]
+	static std::vector<ProfileZoneStats> BuildStats(std::vector<ProfileEvent> events) {
+		static constexpr size_t no_parent = std::numeric_limits<size_t>::max();
+
+		struct Node {
+			ProfileZoneStats stats;
+			size_t parent = no_parent;
+			std::vector<size_t> children;
+		};
+
+		// Events are recorded when they end, so children come before their parents
+		std::ranges::sort(events, [](const ProfileEvent& a, const ProfileEvent& b) {
+			return (a.begin < b.begin) or ((a.begin == b.begin) and (a.depth < b.depth));
+		});
+
+		std::vector<Node>   nodes;
+		std::vector<size_t> roots;
+		std::vector<size_t> stack; //the open node at each depth
+
+		for (const auto& event : events) {
+			// The parent may be missing if its event was dropped
+			stack.resize(std::min<size_t>(event.depth, stack.size()));
+			const size_t parent = stack.empty() ? no_parent : stack.back();
+
+			auto& siblings = (parent == no_parent) ? roots : nodes[parent].children;
+			auto  it       = std::ranges::find_if(siblings, [&](size_t index) { return nodes[index].stats.zone == event.zone; });
+
+			size_t index;
+			if (it != siblings.end()) {
+				index = *it;
+			}
+			else {
+				index = nodes.size();
+				siblings.push_back(index);
+				nodes.push_back(Node{ProfileZoneStats{event.zone, static_cast<u32>(stack.size())}, parent, {}});
+			}
+
+			auto& stats = nodes[index].stats;
+			stats.count += 1;
+			stats.time  += static_cast<f64>(event.end - event.begin) / 1'000'000.0;
+
+			stack.push_back(index);
+		}
+
+		std::vector<ProfileZoneStats> out;
+		out.reserve(nodes.size());
+
+		const auto visit = [&](const auto& self, size_t index) -> void {
+			out.push_back(nodes[index].stats);
+			for (const size_t child : nodes[index].children) {
+				self(self, child);
+			}
+		};
+		for (const size_t root : roots) {
+			visit(visit, root);
+		}
+
+		return out;
+	}
+
+	static void WriteEscaped(std::ostream& stream, std::string_view str) {
+		for (const char c : str) {
+			switch (c) {
+				case '"':  stream << "\\\""; break;
+				case '\\': stream << "\\\\"; break;
+				case '\n': stream << "\\n";  break;
+				case '\t': stream << "\\t";  break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						stream << ' ';
+					else
+						stream << c;
+			}
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	const std::chrono::steady_clock::time_point epoch;
+	std::atomic<bool> enabled = true;
+
+	// Guards everything below
+	mutable std::mutex mutex;
+
+	std::vector<std::shared_ptr<ThreadState>> threads;
+	u32 next_thread_id = 1;
+
+	std::vector<ProfileZoneStats> frame_stats;
+
+	bool               capturing = false;
+	std::vector<Track> tracks;
+	size_t             capture_size    = 0;
+	u64                capture_dropped = 0;
+};
+
+
+
+
+//----------------------------------------------------------------------------------
+// ProfileScope
+//----------------------------------------------------------------------------------
+//
+// Records a zone on the calling thread for the lifetime of the scope
+//
+//----------------------------------------------------------------------------------
+class ProfileScope final {
+public:
+	explicit ProfileScope(const ProfileZone& zone) noexcept {
+		if (Profiler::isEnabled()) {
+			this->zone = &zone;
+			depth = Profiler::enterZone();
+			begin = Profiler::now();
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope(ProfileScope&&) = delete;
+
+	~ProfileScope() {
+		if (zone)
+			Profiler::exitZone(ProfileEvent{zone, begin, Profiler::now(), depth});
+	}
+
+	ProfileScope& operator=(const ProfileScope&) = delete;
+	ProfileScope& operator=(ProfileScope&&) = delete;
+
+private:
+	const ProfileZone* zone  = nullptr;
+	u64                begin = 0;
+	u32                depth = 0;
+};
+
+
+
+
+//----------------------------------------------------------------------------------
+// Macros
+//----------------------------------------------------------------------------------
+//
+// PROFILE_ZONE(name)               - profile the rest of the scope on the CPU
+// PROFILE_GPU_ZONE(profiler, name) - profile the rest of the scope on the CPU, and on
+//                                    the GPU with a profiler that provides scope(zone)
+//
+// Define DISABLE_PROFILER to compile the zones out.
+//
+//----------------------------------------------------------------------------------
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef DISABLE_PROFILER
+
+#define PROFILE_ZONE(name)                                                                              \
+	static constexpr ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__){name, __FILE__, __LINE__};     \
+	const ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__){PROFILE_CONCAT(profile_zone_, __LINE__)}
+
+#define PROFILE_GPU_ZONE(profiler, name)                                                                \
+	PROFILE_ZONE(name);                                                                                 \
+	const auto PROFILE_CONCAT(profile_gpu_scope_, __LINE__) = (profiler).scope(PROFILE_CONCAT(profile_zone_, __LINE__))
+
+#else
+
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_GPU_ZONE(profiler, name) static_cast<void>(0)
+
+#endif
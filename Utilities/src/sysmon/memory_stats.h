@@ -0,0 +1,127 @@
+#pragma once
+
+#include "datatypes/scalar_types.h"
+
+#ifdef _WIN32
+#include "os/windows/windows.h"
+#include <Psapi.h>
+#else
+#include <fstream>
+#include <string>
+#include <string_view>
+#endif
+
+
+//----------------------------------------------------------------------------------
+// Memory Stats
+//----------------------------------------------------------------------------------
+//
+// The memory usage of the system and of the current process, in bytes.
+//
+// On Windows, the stats come from GlobalMemoryStatusEx and GetProcessMemoryInfo. On
+// Linux, they're read from /proc/meminfo and /proc/self/status:
+//
+//   physical        - MemTotal, MemTotal - MemAvailable
+//   commit          - CommitLimit, Committed_AS
+//   process         - VmRSS, VmHWM (peak)
+//   process private - RssAnon + VmSwap (the closest match to Windows' private bytes)
+//
+//----------------------------------------------------------------------------------
+struct MemoryStats {
+	u64 physical_total = 0;
+	u64 physical_used  = 0;
+
+	// The commit limit (physical memory + page file/swap) and the memory committed against it
+	u64 commit_total = 0;
+	u64 commit_used  = 0;
+
+	u64 process_physical      = 0; //working set/resident set
+	u64 process_physical_peak = 0;
+	u64 process_private       = 0; //private committed memory
+};
+
+
+#ifndef _WIN32
+namespace detail {
+
+// Read "Key:   value kB" entries from a /proc file. Returns false if the file can't be read.
+template<typename FunctionT>
+bool ReadProcEntries(const char* path, FunctionT&& func) {
+	std::ifstream file{path};
+	if (not file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		const auto colon = line.find(':');
+		if (colon == std::string::npos)
+			continue;
+
+		const std::string_view key{line.data(), colon};
+		u64 value = 0;
+		try {
+			value = std::stoull(line.substr(colon + 1));
+		}
+		catch (...) {
+			continue;
+		}
+
+		// Sizes are in kB
+		if (line.ends_with("kB"))
+			value *= 1024;
+
+		func(key, value);
+	}
+
+	return true;
+}
+
+} //namespace detail
+#endif
+
+
+// Query the current memory stats. Returns false if they couldn't be read.
+[[nodiscard]]
+inline bool QueryMemoryStats(MemoryStats& stats) {
+#ifdef _WIN32
+	MEMORYSTATUSEX mem_info = {};
+	mem_info.dwLength = sizeof(MEMORYSTATUSEX);
+
+	PROCESS_MEMORY_COUNTERS_EX pmc = {};
+
+	if (not GlobalMemoryStatusEx(&mem_info)
+	    or not GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc))) {
+		return false;
+	}
+
+	stats.physical_total        = mem_info.ullTotalPhys;
+	stats.physical_used         = mem_info.ullTotalPhys - mem_info.ullAvailPhys;
+	stats.commit_total          = mem_info.ullTotalPageFile;
+	stats.commit_used           = mem_info.ullTotalPageFile - mem_info.ullAvailPageFile;
+	stats.process_physical      = pmc.WorkingSetSize;
+	stats.process_physical_peak = pmc.PeakWorkingSetSize;
+	stats.process_private       = pmc.PrivateUsage;
+	return true;
+#else
+	u64 mem_available = 0;
+	const bool system = detail::ReadProcEntries("/proc/meminfo", [&](std::string_view key, u64 value) {
+		if      (key == "MemTotal")     stats.physical_total = value;
+		else if (key == "MemAvailable") mem_available        = value;
+		else if (key == "CommitLimit")  stats.commit_total   = value;
+		else if (key == "Committed_AS") stats.commit_used    = value;
+	});
+
+	u64 rss_anon = 0;
+	u64 swap     = 0;
+	const bool process = detail::ReadProcEntries("/proc/self/status", [&](std::string_view key, u64 value) {
+		if      (key == "VmRSS")   stats.process_physical      = value;
+		else if (key == "VmHWM")   stats.process_physical_peak = value;
+		else if (key == "RssAnon") rss_anon                    = value;
+		else if (key == "VmSwap")  swap                        = value;
+	});
+
+	stats.physical_used   = (stats.physical_total > mem_available) ? (stats.physical_total - mem_available) : 0;
+	stats.process_private = rss_anon + swap;
+	return system and process;
+#endif
+}
@@ -1,10 +1,10 @@
 module;
 
 #include "datatypes/scalar_types.h"
+#include "sysmon/memory_stats.h"
 #include "time/stopwatch.h"
 #include "os/windows/windows.h"
 
-#include <Psapi.h>
 #include <thread> //std::thread::hardware_concurrency()
 
 export module system_monitor;
@@ -147,10 +147,7 @@ class SystemMonitor final {
 		//----------------------------------------------------------------------------------
 		// Constructors
 		//----------------------------------------------------------------------------------
-		MemoryMonitor() noexcept
-			: mem_info{}
-			, pmc{} {
-			mem_info.dwLength = sizeof(MEMORYSTATUSEX);
+		MemoryMonitor() {
 			tick();
 		}
 
@@ -174,8 +171,9 @@ class SystemMonitor final {
 
 		// Update the memory stats
 		void tick() {
-			GlobalMemoryStatusEx(&mem_info); //Total memory
-			GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&pmc), sizeof(pmc)); //Process memory
+			MemoryStats new_stats;
+			if (QueryMemoryStats(new_stats))
+				stats = new_stats;
 		}
 
 	public:
@@ -185,17 +183,22 @@ class SystemMonitor final {
 		//----------------------------------------------------------------------------------
 		[[nodiscard]]
 		u64 getPhysicalMemSize() const noexcept {
-			return mem_info.ullTotalPhys;
+			return stats.physical_total;
 		}
 
 		[[nodiscard]]
 		u64 getTotalUsedPhysicalMem() const noexcept {
-			return mem_info.ullTotalPhys - mem_info.ullAvailPhys;
+			return stats.physical_used;
 		}
 
 		[[nodiscard]]
 		u64 getProcessUsedPhysicalMem() const noexcept {
-			return pmc.WorkingSetSize;
+			return stats.process_physical;
+		}
+
+		[[nodiscard]]
+		u64 getProcessPeakPhysicalMem() const noexcept {
+			return stats.process_physical_peak;
 		}
 
 
@@ -204,17 +207,17 @@ class SystemMonitor final {
 		//----------------------------------------------------------------------------------
 		[[nodiscard]]
 		u64 getVirtualMemSize() const noexcept {
-			return mem_info.ullTotalPageFile;
+			return stats.commit_total;
 		}
 
 		[[nodiscard]]
 		u64 getTotalUsedVirtualMem() const noexcept {
-			return mem_info.ullTotalPageFile - mem_info.ullAvailPageFile;
+			return stats.commit_used;
 		}
 
 		[[nodiscard]]
 		u64 getProcessUsedVirtualMem() const noexcept {
-			return pmc.PrivateUsage;
+			return stats.process_private;
 		}
 
 	private:
@@ -222,8 +225,7 @@ class SystemMonitor final {
 		//----------------------------------------------------------------------------------
 		// Member Variables
 		//----------------------------------------------------------------------------------
-		MEMORYSTATUSEX mem_info;
-		PROCESS_MEMORY_COUNTERS_EX pmc;
+		MemoryStats stats;
 	};
 
 
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "datatypes/scalar_types.h"
+#include "profiler/profiler.h"
+
+
+//----------------------------------------------------------------------------------
+// ThreadPool
+//----------------------------------------------------------------------------------
+//
+// A fixed number of worker threads that execute tasks in the order they're
+// submitted. The destructor finishes every queued task before joining the threads.
+//
+//----------------------------------------------------------------------------------
+class ThreadPool final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+
+	// Create a pool with one thread per core, minus one for the calling thread
+	ThreadPool()
+		: ThreadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1) {
+	}
+
+	// The threads are named "<name> <index>" in the profiler
+	explicit ThreadPool(u32 thread_count, const std::string& name = "Worker") {
+		threads.reserve(std::max(thread_count, 1u));
+		for (u32 i = 0; i < std::max(thread_count, 1u); ++i) {
+			threads.emplace_back([this, i, name] {
+				Profiler::setThreadName(name + ' ' + std::to_string(i));
+				workerMain();
+			});
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~ThreadPool() {
+		{
+			std::scoped_lock lock{mutex};
+			stopping = true;
+		}
+		condition.notify_all();
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool& operator=(ThreadPool&&) = delete;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Queue a task. The returned future holds the task's result, or the exception it threw.
+	template<typename FunctionT>
+	auto enqueue(FunctionT&& func) -> std::future<std::invoke_result_t<std::decay_t<FunctionT>>> {
+		using result_type = std::invoke_result_t<std::decay_t<FunctionT>>;
+
+		// packaged_task is move-only, so it's shared to fit in a std::function
+		auto task   = std::make_shared<std::packaged_task<result_type()>>(std::forward<FunctionT>(func));
+		auto future = task->get_future();
+
+		{
+			std::scoped_lock lock{mutex};
+			tasks.emplace_back([task] { (*task)(); });
+		}
+		condition.notify_one();
+
+		return future;
+	}
+
+	[[nodiscard]]
+	u32 getThreadCount() const noexcept {
+		return static_cast<u32>(threads.size());
+	}
+
+	// The number of tasks that haven't been started yet
+	[[nodiscard]]
+	size_t getPendingCount() const {
+		std::scoped_lock lock{mutex};
+		return tasks.size();
+	}
+
+private:
+
+	void workerMain() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock{mutex};
+				condition.wait(lock, [this] { return stopping or not tasks.empty(); });
+
+				if (tasks.empty())
+					return; //stopping, and every task has been run
+
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+
+			PROFILE_ZONE("Task");
+			task();
+		}
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::function<void()>> tasks;
+	bool stopping = false;
+
+	std::vector<std::thread> threads;
+};
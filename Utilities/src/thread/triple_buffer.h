@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "datatypes/scalar_types.h"
+
+
+//----------------------------------------------------------------------------------
+// TripleBuffer
+//----------------------------------------------------------------------------------
+//
+// Three slots of T, shared by one producer and one consumer without a lock:
+//   - back:   the slot the producer is writing
+//   - middle: the most recently published slot
+//   - front:  the slot the consumer is reading
+//
+// Publishing swaps the back and middle slots, and acquiring swaps the middle and
+// front slots if a newer slot was published. Neither side ever waits on the other,
+// and each always has a slot that the other won't touch. If the producer publishes
+// faster than the consumer acquires, the unread slots are overwritten and the
+// consumer only sees the newest one.
+//
+// The slots are reused, so a T that holds containers keeps their capacity between
+// writes.
+//
+//----------------------------------------------------------------------------------
+template<typename T>
+class TripleBuffer final {
+public:
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	TripleBuffer() = default;
+
+	TripleBuffer(const TripleBuffer&) = delete;
+
+	// Not thread safe. Neither buffer may be in use while moving.
+	TripleBuffer(TripleBuffer&& other) noexcept
+		: slots(std::move(other.slots))
+		, back(other.back)
+		, middle(other.middle.load(std::memory_order_relaxed))
+		, front(other.front) {
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~TripleBuffer() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Not thread safe. Neither buffer may be in use while moving.
+	TripleBuffer& operator=(TripleBuffer&& other) noexcept {
+		slots  = std::move(other.slots);
+		back   = other.back;
+		front  = other.front;
+		middle.store(other.middle.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Producer
+	//----------------------------------------------------------------------------------
+
+	// The slot to write. It still holds an older write, which should be overwritten in full.
+	[[nodiscard]]
+	T& getWriteSlot() noexcept {
+		return slots[back];
+	}
+
+	// Make the write slot available to the consumer, and take a new write slot
+	void publish() noexcept {
+		back = middle.exchange(static_cast<u8>(back | fresh_bit), std::memory_order_acq_rel) & index_mask;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Consumer
+	//----------------------------------------------------------------------------------
+
+	// Take the most recently published slot. Returns the previously acquired slot if
+	// nothing was published since, or a default constructed T if nothing was ever
+	// published. The slot stays valid until the next call.
+	[[nodiscard]]
+	const T& acquire() noexcept {
+		if (middle.load(std::memory_order_relaxed) & fresh_bit)
+			front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+
+		return slots[front];
+	}
+
+	// True if a slot was published that hasn't been acquired yet
+	[[nodiscard]]
+	bool hasPublished() const noexcept {
+		return middle.load(std::memory_order_relaxed) & fresh_bit;
+	}
+
+private:
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	static constexpr u8 index_mask = 0x3;
+	static constexpr u8 fresh_bit  = 0x4;
+
+	std::array<T, 3> slots = {};
+
+	// The index of each slot. The middle index also holds the fresh bit, which is set
+	// when a slot is published and cleared when it's acquired.
+	u8              back   = 0;
+	std::atomic<u8> middle = 1;
+	u8              front  = 2;
+};
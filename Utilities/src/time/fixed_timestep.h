@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "time/time.h"
+
+
+//----------------------------------------------------------------------------------
+// FixedTimestep
+//----------------------------------------------------------------------------------
+//
+// Converts variable frame times into a whole number of fixed-length steps. The time
+// left over after the last step is carried into the next frame, and the fraction of
+// a step that it represents (alpha) is used to interpolate between the last two
+// steps when rendering.
+//
+// Two limits keep a slow frame from causing a "spiral of death":
+//   - The time added per frame is clamped (e.g. after a breakpoint or a hitch)
+//   - The number of steps run per frame is capped. The time that would have needed
+//     more steps is dropped, so the simulation runs slower instead of falling
+//     further behind.
+//
+//----------------------------------------------------------------------------------
+class FixedTimestep final {
+public:
+	using duration = std::chrono::duration<f64>;
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	FixedTimestep() noexcept = default;
+
+	FixedTimestep(duration timestep, u32 max_steps, duration max_frame_time) noexcept
+		: timestep(timestep)
+		, max_steps(std::max(max_steps, 1u))
+		, max_frame_time(max_frame_time) {
+	}
+
+	FixedTimestep(const FixedTimestep&) noexcept = default;
+	FixedTimestep(FixedTimestep&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~FixedTimestep() = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	FixedTimestep& operator=(const FixedTimestep&) noexcept = default;
+	FixedTimestep& operator=(FixedTimestep&&) noexcept = default;
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Update
+	//----------------------------------------------------------------------------------
+
+	// Add the time elapsed since the last frame. Returns the number of steps to run.
+	[[nodiscard]]
+	u32 advance(duration frame_time) noexcept {
+		accumulator += std::clamp(frame_time, duration::zero(), max_frame_time);
+
+		auto steps = static_cast<u64>(accumulator / timestep);
+		if (steps > max_steps) {
+			dropped_steps += steps - max_steps;
+			steps = max_steps;
+
+			// Keep the phase of the leftover time, but drop the whole steps
+			accumulator = duration{std::fmod(accumulator.count(), timestep.count())} + (max_steps * timestep);
+		}
+
+		accumulator -= static_cast<f64>(steps) * timestep;
+		total_steps += steps;
+
+		return static_cast<u32>(steps);
+	}
+
+	// Discard the accumulated time, e.g. after loading a scene
+	void reset() noexcept {
+		accumulator = duration::zero();
+	}
+
+	// How far the current time is between the last step and the next, in [0, 1)
+	[[nodiscard]]
+	f32 getAlpha() const noexcept {
+		return static_cast<f32>(std::clamp(accumulator / timestep, 0.0, 1.0));
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Settings
+	//----------------------------------------------------------------------------------
+
+	void setTimestep(duration value) noexcept {
+		if (value > duration::zero())
+			timestep = value;
+	}
+
+	[[nodiscard]]
+	duration getTimestep() const noexcept {
+		return timestep;
+	}
+
+	void setMaxSteps(u32 value) noexcept {
+		max_steps = std::max(value, 1u);
+	}
+
+	[[nodiscard]]
+	u32 getMaxSteps() const noexcept {
+		return max_steps;
+	}
+
+	void setMaxFrameTime(duration value) noexcept {
+		max_frame_time = value;
+	}
+
+	[[nodiscard]]
+	duration getMaxFrameTime() const noexcept {
+		return max_frame_time;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions - Stats
+	//----------------------------------------------------------------------------------
+
+	// The number of steps run since creation
+	[[nodiscard]]
+	u64 getTotalSteps() const noexcept {
+		return total_steps;
+	}
+
+	// The number of steps skipped because a frame needed more than the max steps
+	[[nodiscard]]
+	u64 getDroppedSteps() const noexcept {
+		return dropped_steps;
+	}
+
+private:
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	duration timestep       = duration{1.0 / 60.0};
+	u32      max_steps      = 5;
+	duration max_frame_time = 250ms;
+
+	duration accumulator = duration::zero();
+
+	u64 total_steps   = 0;
+	u64 dropped_steps = 0;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "time/time.h"
+
+#ifdef _WIN32
+#include "os/windows/windows.h"
+
+// Windows 10 1803+. Older versions fail to create the timer, and the pacer falls back to sleep_for.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+
+//----------------------------------------------------------------------------------
+// FramePacer
+//----------------------------------------------------------------------------------
+//
+// Limits a loop to a target frame rate without burning a core. The wait before each
+// frame is split in two:
+//   - Sleep: most of the wait is spent sleeping. On Windows this uses a high
+//     resolution waitable timer, which wakes within a fraction of a millisecond
+//     instead of the default ~15.6ms scheduler tick.
+//   - Spin: the last part of the wait yields in a loop until the deadline, to absorb
+//     the sleep's wake-up latency. The length of this part adapts to the observed
+//     oversleep.
+//
+// Deadlines are spaced by the target frame time rather than measured from the end of
+// the wait, so the frame rate doesn't drift. If a frame runs late by more than a
+// whole frame, the schedule is reset instead of rushing to catch up.
+//
+//----------------------------------------------------------------------------------
+class FramePacer final {
+public:
+	using clock_t  = std::chrono::steady_clock;
+	using duration = std::chrono::duration<f64>;
+
+	//----------------------------------------------------------------------------------
+	// Constructors
+	//----------------------------------------------------------------------------------
+	FramePacer() {
+	#ifdef _WIN32
+		timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	#endif
+	}
+
+	FramePacer(const FramePacer&) = delete;
+
+	FramePacer(FramePacer&& other) noexcept {
+		*this = std::move(other);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Destructor
+	//----------------------------------------------------------------------------------
+	~FramePacer() {
+		close();
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Operators
+	//----------------------------------------------------------------------------------
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	FramePacer& operator=(FramePacer&& other) noexcept {
+		if (this != &other) {
+			close();
+			target         = other.target;
+			spin_threshold = other.spin_threshold;
+			deadline       = other.deadline;
+		#ifdef _WIN32
+			timer = std::exchange(other.timer, nullptr);
+		#endif
+		}
+		return *this;
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Functions
+	//----------------------------------------------------------------------------------
+
+	// Set the target frame rate. 0 disables pacing.
+	void setTargetFrameRate(u32 fps) noexcept {
+		const auto new_target = (fps == 0) ? duration::zero() : duration{1.0 / fps};
+		if (new_target != target) {
+			target   = new_target;
+			deadline = clock_t::now();
+		}
+	}
+
+	[[nodiscard]]
+	duration getTargetFrameTime() const noexcept {
+		return target;
+	}
+
+	// Wait until the next frame should begin
+	void wait() {
+		if (target == duration::zero())
+			return;
+
+		deadline += std::chrono::duration_cast<clock_t::duration>(target);
+
+		auto now = clock_t::now();
+		if (now >= deadline) {
+			// Running behind. Restart the schedule if the frame is late by more than a frame.
+			if (now - deadline > target)
+				deadline = now;
+			return;
+		}
+
+		// Sleep for the part of the wait that's longer than the spin threshold
+		if (const auto sleep_time = (deadline - now) - spin_threshold; sleep_time > duration::zero()) {
+			const auto sleep_begin = now;
+			sleep(sleep_time);
+			now = clock_t::now();
+
+			// Adapt the spin threshold to the oversleep. Grows quickly, shrinks slowly.
+			const duration oversleep = (now - sleep_begin) - sleep_time;
+			if (oversleep > spin_threshold)
+				spin_threshold = std::min(oversleep, max_spin_threshold);
+			else
+				spin_threshold = std::max(spin_threshold * 0.99, min_spin_threshold);
+		}
+
+		// Spin for the remainder
+		while (clock_t::now() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
+private:
+
+	void close() noexcept {
+	#ifdef _WIN32
+		if (timer)
+			CloseHandle(timer);
+		timer = nullptr;
+	#endif
+	}
+
+	void sleep(duration time) const {
+	#ifdef _WIN32
+		if (timer) {
+			// Relative due time, in 100ns units
+			LARGE_INTEGER due_time;
+			due_time.QuadPart = -static_cast<LONGLONG>(time.count() * 1e7);
+			if (SetWaitableTimerEx(timer, &due_time, 0, nullptr, nullptr, nullptr, 0)) {
+				WaitForSingleObject(timer, INFINITE);
+				return;
+			}
+		}
+	#endif
+		std::this_thread::sleep_for(time);
+	}
+
+
+	//----------------------------------------------------------------------------------
+	// Member Variables
+	//----------------------------------------------------------------------------------
+	static constexpr duration min_spin_threshold = 500us;
+	static constexpr duration max_spin_threshold = 4ms;
+
+	duration target         = duration::zero();
+	duration spin_threshold = 1ms;
+
+	clock_t::time_point deadline = clock_t::now();
+
+#ifdef _WIN32
+	HANDLE timer = nullptr;
+#endif
+};